@@ -73,7 +73,8 @@ void create_ground_plane(rpe_engine_t* engine, rpe_scene_t* scene)
     rpe_transform_manager_t* tm = rpe_engine_get_transform_manager(engine);
 
     rpe_valloc_handle vbuffer_handle = rpe_rend_manager_alloc_vertex_buffer(rm, 4);
-    rpe_valloc_handle ibuffer_handle = rpe_rend_manager_alloc_index_buffer(rm, 6);
+    rpe_valloc_handle ibuffer_handle =
+        rpe_rend_manager_alloc_index_buffer(rm, 6, RPE_RENDERABLE_INDICES_U32);
 
     rpe_mesh_t* mesh = rpe_rend_manager_create_static_mesh(
         rm,
@@ -70,7 +70,8 @@ int main()
     int32_t indices[] = {0, 1, 2};
 
     rpe_valloc_handle vbuffer_handle = rpe_rend_manager_alloc_vertex_buffer(r_manager, 3);
-    rpe_valloc_handle ibuffer_handle = rpe_rend_manager_alloc_index_buffer(r_manager, 3);
+    rpe_valloc_handle ibuffer_handle =
+        rpe_rend_manager_alloc_index_buffer(r_manager, 3, RPE_RENDERABLE_INDICES_U32);
 
     rpe_mesh_t* mesh = rpe_rend_manager_create_static_mesh(
         r_manager,
@@ -184,8 +184,8 @@ nk_instance_t* nk_helper_init(
 
     nk->vbuffer_handle =
         rpe_rend_manager_alloc_vertex_buffer(rm, RPE_NK_HELPER_MAX_VERTEX_BUFFER_COUNT);
-    nk->ibuffer_handle =
-        rpe_rend_manager_alloc_index_buffer(rm, RPE_NK_HELPER_MAX_INDEX_BUFFER_COUNT);
+    nk->ibuffer_handle = rpe_rend_manager_alloc_index_buffer(
+        rm, RPE_NK_HELPER_MAX_INDEX_BUFFER_COUNT, RPE_RENDERABLE_INDICES_U16);
 
     set_ui_style(&nk->ctx);
     return nk;
@@ -462,8 +462,8 @@ bool create_mesh_instance(
 
         rpe_valloc_handle v_handle =
             rpe_rend_manager_alloc_vertex_buffer(asset->rend_manager, vert_count);
-        rpe_valloc_handle i_handle =
-            rpe_rend_manager_alloc_index_buffer(asset->rend_manager, indices_count);
+        rpe_valloc_handle i_handle = rpe_rend_manager_alloc_index_buffer(
+            asset->rend_manager, indices_count, indices_type);
         rpe_mesh_t* new_mesh = rpe_rend_manager_create_mesh_interleaved(
             asset->rend_manager,
             v_handle,
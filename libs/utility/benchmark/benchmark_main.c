@@ -0,0 +1,3 @@
+#include <utility/benchmark.h>
+
+BENCHMARK_MAIN()
@@ -0,0 +1,80 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/job_queue.h>
+
+// The number of small allocations made by each job per iteration.
+#define BM_ARENA_ALLOC_COUNT 4096
+#define BM_ARENA_ALLOC_SIZE 32
+
+struct ArenaBenchmarkEntry
+{
+    job_queue_t* jq;
+    arena_t* arena;
+};
+
+static void locked_alloc_job(void* arg)
+{
+    struct ArenaBenchmarkEntry* entry = arg;
+    for (int i = 0; i < BM_ARENA_ALLOC_COUNT; ++i)
+    {
+        void* ptr = arena_alloc_with_lock(entry->arena, BM_ARENA_ALLOC_SIZE, 8, 1, 0);
+        BM_DONT_OPTIMISE(ptr);
+    }
+}
+
+static void thread_alloc_job(void* arg)
+{
+    struct ArenaBenchmarkEntry* entry = arg;
+    thread_arena_t* arena = job_queue_get_thread_arena(entry->jq);
+    for (int i = 0; i < BM_ARENA_ALLOC_COUNT; ++i)
+    {
+        void* ptr = thread_arena_alloc(arena, BM_ARENA_ALLOC_SIZE, 8, 1, 0);
+        BM_DONT_OPTIMISE(ptr);
+    }
+}
+
+// One job per thread, each making many small allocations concurrently.
+static void run_alloc_benchmark(bm_run_state_t* state, job_func_t func)
+{
+    arena_t arena;
+    int res = arena_new(1 << 26, &arena);
+    assert(res == ARENA_SUCCESS);
+    arena_t alloc_arena;
+    res = arena_new(1 << 26, &alloc_arena);
+    assert(res == ARENA_SUCCESS);
+
+    uint32_t thread_count = (uint32_t)state->arg;
+    job_queue_t* jq = job_queue_init(&arena, thread_count);
+    job_queue_adopt_thread(jq);
+    struct ArenaBenchmarkEntry entry = {.jq = jq, .arena = &alloc_arena};
+
+    while (bm_state_set_running(state))
+    {
+        job_t* parent = job_queue_create_parent_job(jq);
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            job_t* job = job_queue_create_job(jq, func, &entry, parent);
+            job_queue_run_job(jq, job);
+        }
+        job_queue_run_and_wait(jq, parent);
+        arena_reset(&alloc_arena);
+        job_queue_reset_thread_arenas(jq);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&alloc_arena);
+    arena_release(&arena);
+}
+
+void BM_test_arena_alloc_locked(bm_run_state_t* state)
+{
+    run_alloc_benchmark(state, locked_alloc_job);
+}
+
+void BM_test_arena_alloc_thread_local(bm_run_state_t* state)
+{
+    run_alloc_benchmark(state, thread_alloc_job);
+}
+
+BENCHMARK_ARG3(BM_test_arena_alloc_locked, 1, 4, 8);
+BENCHMARK_ARG3(BM_test_arena_alloc_thread_local, 1, 4, 8);
@@ -0,0 +1,142 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/hash.h>
+#include <utility/hash_map.h>
+#include <utility/hash_set.h>
+#include <utility/random.h>
+
+#include <stdlib.h>
+
+#define BM_HASH_ARENA_SIZE (1ULL << 31)
+
+// Note: hash_set_t can hold at most HASH_SET_MAX_SIZE entries, so the comparisons against it are
+// run at smaller sizes - the larger sizes are only run for the hash map.
+
+static uint64_t* generate_keys(int64_t count)
+{
+    uint64_t* keys = malloc(sizeof(uint64_t) * count);
+    assert(keys);
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        keys[i] = xoro_rand_next(&rand);
+    }
+    return keys;
+}
+
+void BM_test_hash_map_insert(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* keys = generate_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_HASH_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    while (bm_state_set_running(state))
+    {
+        hash_map_t map = HASH_MAP_CREATE(uint64_t, uint64_t, &arena);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            HASH_MAP_INSERT(&map, &keys[i], &keys[i]);
+        }
+        BM_DONT_OPTIMISE(map.size)
+        arena_reset(&arena);
+    }
+
+    arena_release(&arena);
+    free(keys);
+}
+
+void BM_test_hash_set_insert(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* keys = generate_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_HASH_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    while (bm_state_set_running(state))
+    {
+        hash_set_t set = HASH_SET_CREATE(uint64_t, uint64_t, &arena);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            HASH_SET_INSERT(&set, &keys[i], &keys[i]);
+        }
+        BM_DONT_OPTIMISE(set.size)
+        arena_reset(&arena);
+    }
+
+    arena_release(&arena);
+    free(keys);
+}
+
+void BM_test_hash_map_lookup(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* keys = generate_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_HASH_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    hash_map_t map = HASH_MAP_CREATE(uint64_t, uint64_t, &arena);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        HASH_MAP_INSERT(&map, &keys[i], &keys[i]);
+    }
+
+    while (bm_state_set_running(state))
+    {
+        uint64_t sum = 0;
+        for (int64_t i = 0; i < count; ++i)
+        {
+            uint64_t* val = HASH_MAP_GET(&map, &keys[i]);
+            sum += *val;
+        }
+        BM_DONT_OPTIMISE(sum)
+    }
+
+    arena_release(&arena);
+    free(keys);
+}
+
+void BM_test_hash_set_lookup(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* keys = generate_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_HASH_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    hash_set_t set = HASH_SET_CREATE(uint64_t, uint64_t, &arena);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        HASH_SET_INSERT(&set, &keys[i], &keys[i]);
+    }
+
+    while (bm_state_set_running(state))
+    {
+        uint64_t sum = 0;
+        for (int64_t i = 0; i < count; ++i)
+        {
+            // Hash collisions can result in keys missing from the set - the hash set only stores
+            // the hash.
+            uint64_t* val = HASH_SET_GET(&set, &keys[i]);
+            sum += val ? *val : 0;
+        }
+        BM_DONT_OPTIMISE(sum)
+    }
+
+    arena_release(&arena);
+    free(keys);
+}
+
+void BM_test_hash_map_insert_large(bm_run_state_t* state) { BM_test_hash_map_insert(state); }
+
+void BM_test_hash_map_lookup_large(bm_run_state_t* state) { BM_test_hash_map_lookup(state); }
+
+BENCHMARK_ARG3(BM_test_hash_map_insert, 1000, 10000, 50000);
+BENCHMARK_ARG3(BM_test_hash_set_insert, 1000, 10000, 50000);
+BENCHMARK_ARG3(BM_test_hash_map_lookup, 1000, 10000, 50000);
+BENCHMARK_ARG3(BM_test_hash_set_lookup, 1000, 10000, 50000);
+BENCHMARK_ARG2(BM_test_hash_map_insert_large, 100000, 1000000);
+BENCHMARK_ARG2(BM_test_hash_map_lookup_large, 100000, 1000000);
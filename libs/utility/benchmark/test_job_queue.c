@@ -0,0 +1,39 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/job_queue.h>
+
+// The number of empty jobs pushed per iteration - jobs/sec is this divided by the mean time.
+#define BM_JOB_FAN_OUT_COUNT 2048
+
+static void empty_job(void* arg) { RPE_UNUSED(arg); }
+
+void BM_test_job_queue_fan_out(bm_run_state_t* state)
+{
+    arena_t arena;
+    int res = arena_new(1 << 25, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    job_queue_t* jq = job_queue_init(&arena, (uint32_t)state->arg);
+    job_queue_adopt_thread(jq);
+
+    while (bm_state_set_running(state))
+    {
+        job_t* parent = job_queue_create_parent_job(jq);
+        for (int i = 0; i < BM_JOB_FAN_OUT_COUNT; ++i)
+        {
+            job_t* job = job_queue_create_job(jq, empty_job, NULL, parent);
+            job_queue_run_job(jq, job);
+        }
+        job_queue_run_and_wait(jq, parent);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
+
+void BM_test_job_queue_fan_out_wide(bm_run_state_t* state) { BM_test_job_queue_fan_out(state); }
+
+BENCHMARK_ARG3(BM_test_job_queue_fan_out, 1, 2, 4);
+// Note: The maximum is one less than JOB_QUEUE_MAX_THREAD_COUNT to leave room for the adopted
+// thread.
+BENCHMARK_ARG3(BM_test_job_queue_fan_out_wide, 8, 16, 31);
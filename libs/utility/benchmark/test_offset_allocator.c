@@ -0,0 +1,236 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/offset_allocator.h>
+#include <utility/random.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BM_OFFSET_ALLOC_ARENA_SIZE (1ULL << 28)
+// Mesh sizes (in vertices) are between 64 and 4096, with three indices per vertex.
+#define BM_OFFSET_ALLOC_MIN_MESH_SIZE 64
+#define BM_OFFSET_ALLOC_MAX_MESH_SIZE 4096
+
+struct BmMesh
+{
+    uint32_t vertex_count;
+    uint32_t index_count;
+};
+
+struct BmRange
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+// The meshes and the order they are unloaded in.
+static struct BmMesh* generate_meshes(int64_t count, uint32_t** unload_order)
+{
+    struct BmMesh* meshes = malloc(sizeof(struct BmMesh) * count);
+    uint32_t* order = malloc(sizeof(uint32_t) * count);
+    assert(meshes && order);
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        uint32_t range = BM_OFFSET_ALLOC_MAX_MESH_SIZE - BM_OFFSET_ALLOC_MIN_MESH_SIZE;
+        meshes[i].vertex_count =
+            BM_OFFSET_ALLOC_MIN_MESH_SIZE + (uint32_t)(xoro_rand_next(&rand) % range);
+        meshes[i].index_count = meshes[i].vertex_count * 3;
+        order[i] = (uint32_t)i;
+    }
+    for (int64_t i = count - 1; i > 0; --i)
+    {
+        uint32_t j = (uint32_t)(xoro_rand_next(&rand) % (i + 1));
+        uint32_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    *unload_order = order;
+    return meshes;
+}
+
+// A first-fit allocator over a list of free ranges sorted by offset, kept here as a baseline.
+typedef struct BmFirstFit
+{
+    struct BmRange* ranges;
+    uint32_t count;
+} bm_first_fit_t;
+
+static void first_fit_init(bm_first_fit_t* ff, uint32_t capacity, uint32_t max_ranges)
+{
+    ff->ranges = malloc(sizeof(struct BmRange) * max_ranges);
+    assert(ff->ranges);
+    ff->ranges[0] = (struct BmRange){.offset = 0, .size = capacity};
+    ff->count = 1;
+}
+
+static uint32_t first_fit_alloc(bm_first_fit_t* ff, uint32_t size)
+{
+    for (uint32_t i = 0; i < ff->count; ++i)
+    {
+        struct BmRange* r = &ff->ranges[i];
+        if (r->size < size)
+        {
+            continue;
+        }
+        uint32_t offset = r->offset;
+        r->offset += size;
+        r->size -= size;
+        if (!r->size)
+        {
+            memmove(r, r + 1, sizeof(struct BmRange) * (ff->count - i - 1));
+            --ff->count;
+        }
+        return offset;
+    }
+    return OFFSET_ALLOC_INVALID;
+}
+
+static void first_fit_free(bm_first_fit_t* ff, uint32_t offset, uint32_t size)
+{
+    uint32_t i = 0;
+    while (i < ff->count && ff->ranges[i].offset < offset)
+    {
+        ++i;
+    }
+    bool merge_prev = i > 0 && ff->ranges[i - 1].offset + ff->ranges[i - 1].size == offset;
+    bool merge_next = i < ff->count && offset + size == ff->ranges[i].offset;
+    if (merge_prev && merge_next)
+    {
+        ff->ranges[i - 1].size += size + ff->ranges[i].size;
+        memmove(&ff->ranges[i], &ff->ranges[i + 1], sizeof(struct BmRange) * (ff->count - i - 1));
+        --ff->count;
+    }
+    else if (merge_prev)
+    {
+        ff->ranges[i - 1].size += size;
+    }
+    else if (merge_next)
+    {
+        ff->ranges[i].offset = offset;
+        ff->ranges[i].size += size;
+    }
+    else
+    {
+        memmove(&ff->ranges[i + 1], &ff->ranges[i], sizeof(struct BmRange) * (ff->count - i));
+        ff->ranges[i] = (struct BmRange){.offset = offset, .size = size};
+        ++ff->count;
+    }
+}
+
+void BM_test_first_fit_load_unload(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint32_t* order;
+    struct BmMesh* meshes = generate_meshes(count, &order);
+    uint32_t capacity = (uint32_t)count * BM_OFFSET_ALLOC_MAX_MESH_SIZE * 3;
+    uint32_t* offsets = malloc(sizeof(uint32_t) * count * 2);
+    assert(offsets);
+
+    while (bm_state_set_running(state))
+    {
+        bm_first_fit_t vertices;
+        bm_first_fit_t indices;
+        first_fit_init(&vertices, capacity, (uint32_t)count + 1);
+        first_fit_init(&indices, capacity, (uint32_t)count + 1);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            offsets[i * 2] = first_fit_alloc(&vertices, meshes[i].vertex_count);
+            offsets[i * 2 + 1] = first_fit_alloc(&indices, meshes[i].index_count);
+        }
+        for (int64_t i = 0; i < count; ++i)
+        {
+            uint32_t idx = order[i];
+            first_fit_free(&vertices, offsets[idx * 2], meshes[idx].vertex_count);
+            first_fit_free(&indices, offsets[idx * 2 + 1], meshes[idx].index_count);
+        }
+        BM_DONT_OPTIMISE(vertices.count);
+        free(vertices.ranges);
+        free(indices.ranges);
+    }
+
+    free(offsets);
+    free(meshes);
+    free(order);
+}
+
+void BM_test_offset_alloc_load_unload(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint32_t* order;
+    struct BmMesh* meshes = generate_meshes(count, &order);
+    uint32_t capacity = (uint32_t)count * BM_OFFSET_ALLOC_MAX_MESH_SIZE * 3;
+    arena_t arena;
+    int res = arena_new(BM_OFFSET_ALLOC_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+    offset_alloc_t* allocs = ARENA_MAKE_ARRAY(&arena, offset_alloc_t, count * 2, 0);
+
+    offset_allocator_t vertices;
+    offset_allocator_t indices;
+    offset_alloc_init(&vertices, capacity, &arena);
+    offset_alloc_init(&indices, capacity, &arena);
+
+    while (bm_state_set_running(state))
+    {
+        for (int64_t i = 0; i < count; ++i)
+        {
+            allocs[i * 2] = offset_alloc_allocate(&vertices, meshes[i].vertex_count);
+            allocs[i * 2 + 1] = offset_alloc_allocate(&indices, meshes[i].index_count);
+        }
+        for (int64_t i = 0; i < count; ++i)
+        {
+            uint32_t idx = order[i];
+            offset_alloc_free(&vertices, allocs[idx * 2]);
+            offset_alloc_free(&indices, allocs[idx * 2 + 1]);
+        }
+        BM_DONT_OPTIMISE(vertices.free_space);
+    }
+
+    arena_release(&arena);
+    free(meshes);
+    free(order);
+}
+
+// Meshes are streamed in and out with the allocator kept half full, so the free ranges become
+// fragmented.
+void BM_test_offset_alloc_churn(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint32_t* order;
+    struct BmMesh* meshes = generate_meshes(count, &order);
+    uint32_t capacity = (uint32_t)count * BM_OFFSET_ALLOC_MAX_MESH_SIZE / 2;
+    arena_t arena;
+    int res = arena_new(BM_OFFSET_ALLOC_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+    offset_alloc_t* allocs = ARENA_MAKE_ARRAY(&arena, offset_alloc_t, count, 0);
+
+    offset_allocator_t vertices;
+    offset_alloc_init(&vertices, capacity, &arena);
+    int64_t resident = count / 4;
+    for (int64_t i = 0; i < resident; ++i)
+    {
+        allocs[i] = offset_alloc_allocate(&vertices, meshes[i].vertex_count);
+    }
+
+    while (bm_state_set_running(state))
+    {
+        for (int64_t i = 0; i < count; ++i)
+        {
+            uint32_t slot = order[i] % resident;
+            if (allocs[slot].offset != OFFSET_ALLOC_INVALID)
+            {
+                offset_alloc_free(&vertices, allocs[slot]);
+            }
+            allocs[slot] = offset_alloc_allocate(&vertices, meshes[i].vertex_count);
+        }
+        BM_DONT_OPTIMISE(vertices.free_space);
+    }
+
+    arena_release(&arena);
+    free(meshes);
+    free(order);
+}
+
+BENCHMARK_ARG3(BM_test_first_fit_load_unload, 1000, 5000, 20000);
+BENCHMARK_ARG3(BM_test_offset_alloc_load_unload, 1000, 5000, 20000);
+BENCHMARK_ARG3(BM_test_offset_alloc_churn, 1000, 5000, 20000);
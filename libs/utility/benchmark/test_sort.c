@@ -0,0 +1,192 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/job_queue.h>
+#include <utility/random.h>
+#include <utility/sort.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BM_SORT_ARENA_SIZE (1ULL << 30)
+#define BM_SORT_THREAD_COUNT 4
+
+struct SortPair
+{
+    uint64_t key;
+    uint32_t index;
+};
+
+static uint64_t* generate_sort_keys(int64_t count)
+{
+    uint64_t* keys = malloc(sizeof(uint64_t) * count);
+    assert(keys);
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    for (int64_t i = 0; i < count; ++i)
+    {
+        keys[i] = xoro_rand_next(&rand);
+    }
+    return keys;
+}
+
+// The previous base-10 implementation, kept here as a baseline.
+static void decimal_count_sort(
+    uint64_t* arr, size_t sz, uint64_t pos, arena_t* arena, uint64_t* output)
+{
+    uint64_t bucket[10];
+    memset(bucket, 0, sizeof(uint64_t) * 10);
+
+    uint64_t* sorted = ARENA_MAKE_ARRAY(arena, uint64_t, sz, 0);
+    uint64_t* tmp = ARENA_MAKE_ARRAY(arena, uint64_t, sz, 0);
+
+    for (size_t i = 0; i < sz; ++i)
+    {
+        ++bucket[(arr[i] / pos) % 10];
+    }
+    for (int i = 1; i < 10; ++i)
+    {
+        bucket[i] += bucket[i - 1];
+    }
+    for (int64_t i = (int64_t)sz - 1; i >= 0; i--)
+    {
+        uint64_t index = (arr[i] / pos) % 10;
+        tmp[bucket[index] - 1] = output[i];
+        sorted[bucket[index] - 1] = arr[i];
+        --bucket[index];
+    }
+    memcpy(arr, sorted, sizeof(uint64_t) * sz);
+    memcpy(output, tmp, sizeof(uint64_t) * sz);
+}
+
+static void decimal_radix_sort(uint64_t* arr, size_t sz, arena_t* arena, uint64_t* output)
+{
+    uint64_t max = 0;
+    for (size_t i = 0; i < sz; ++i)
+    {
+        max = arr[i] > max ? arr[i] : max;
+    }
+    for (uint64_t i = 0; i < sz; ++i)
+    {
+        output[i] = i;
+    }
+    // Note: the position overflows after 19 digits, so limit the passes to keep the baseline sane.
+    uint64_t pos = 1;
+    for (int digit = 0; digit < 20 && max / pos > 0; ++digit, pos *= 10)
+    {
+        decimal_count_sort(arr, sz, pos, arena, output);
+    }
+}
+
+#ifdef __linux__
+static int compare_pairs(const void* a, const void* b, void*)
+#elif WIN32
+static int compare_pairs(void*, const void* a, const void* b)
+#endif
+{
+    const struct SortPair* pa = a;
+    const struct SortPair* pb = b;
+    return pa->key > pb->key ? 1 : (pa->key < pb->key ? -1 : 0);
+}
+
+void BM_test_sort_decimal_radix(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* src = generate_sort_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_SORT_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+    arena_t scratch;
+    res = arena_new(BM_SORT_ARENA_SIZE, &scratch);
+    assert(res == ARENA_SUCCESS);
+    uint64_t* keys = ARENA_MAKE_ARRAY(&arena, uint64_t, count * 2, 0);
+    uint64_t* output = keys + count;
+
+    while (bm_state_set_running(state))
+    {
+        memcpy(keys, src, sizeof(uint64_t) * count);
+        decimal_radix_sort(keys, count, &scratch, output);
+        BM_DONT_OPTIMISE(output[0]);
+        arena_reset(&scratch);
+    }
+
+    arena_release(&scratch);
+    arena_release(&arena);
+    free(src);
+}
+
+void BM_test_sort_qsort(bm_run_state_t* state)
+{
+    int64_t count = state->arg;
+    uint64_t* src = generate_sort_keys(count);
+    struct SortPair* pairs = malloc(sizeof(struct SortPair) * count);
+    assert(pairs);
+
+    while (bm_state_set_running(state))
+    {
+        for (int64_t i = 0; i < count; ++i)
+        {
+            pairs[i] = (struct SortPair){.key = src[i], .index = (uint32_t)i};
+        }
+        QSORT_RS(pairs, count, sizeof(struct SortPair), compare_pairs, NULL);
+        BM_DONT_OPTIMISE(pairs[0].index);
+    }
+
+    free(pairs);
+    free(src);
+}
+
+static void run_radix_benchmark(bm_run_state_t* state, bool use_jq)
+{
+    int64_t count = state->arg;
+    uint64_t* src = generate_sort_keys(count);
+    arena_t arena;
+    int res = arena_new(BM_SORT_ARENA_SIZE, &arena);
+    assert(res == ARENA_SUCCESS);
+    arena_t scratch;
+    res = arena_new(1 << 20, &scratch);
+    assert(res == ARENA_SUCCESS);
+    uint64_t* keys = ARENA_MAKE_ARRAY(&arena, uint64_t, count * 2, 0);
+    uint32_t* indices = ARENA_MAKE_ARRAY(&arena, uint32_t, count * 2, 0);
+
+    job_queue_t* jq = NULL;
+    if (use_jq)
+    {
+        jq = job_queue_init(&arena, BM_SORT_THREAD_COUNT);
+        job_queue_adopt_thread(jq);
+    }
+
+    while (bm_state_set_running(state))
+    {
+        memcpy(keys, src, sizeof(uint64_t) * count);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            indices[i] = (uint32_t)i;
+        }
+        if (jq)
+        {
+            radix_sort_keys_mt(jq, keys, indices, count, keys + count, indices + count, &scratch);
+            arena_reset(&scratch);
+        }
+        else
+        {
+            radix_sort_keys(keys, indices, count, keys + count, indices + count);
+        }
+        BM_DONT_OPTIMISE(indices[0]);
+    }
+
+    if (jq)
+    {
+        job_queue_destroy(jq);
+    }
+    arena_release(&scratch);
+    arena_release(&arena);
+    free(src);
+}
+
+void BM_test_sort_radix_keys(bm_run_state_t* state) { run_radix_benchmark(state, false); }
+
+void BM_test_sort_radix_keys_mt(bm_run_state_t* state) { run_radix_benchmark(state, true); }
+
+BENCHMARK_ARG3(BM_test_sort_decimal_radix, 1000, 100000, 1000000);
+BENCHMARK_ARG3(BM_test_sort_qsort, 1000, 100000, 1000000);
+BENCHMARK_ARG3(BM_test_sort_radix_keys, 1000, 100000, 1000000);
+BENCHMARK_ARG3(BM_test_sort_radix_keys_mt, 1000, 100000, 1000000);
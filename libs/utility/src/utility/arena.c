@@ -23,6 +23,7 @@
 #include "arena.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <log.h>
 #include <string.h>
 
@@ -83,10 +84,11 @@ void* arena_alloc(arena_t* arena, ptrdiff_t type_size, ptrdiff_t align, ptrdiff_
     arena->offset += ((uint8_t*)aligned_ptr - offset_ptr) + count * type_size;
 #if ENABLE_DEBUG_ARENA
     log_info(
-        "[Arena Allocation Log] Alloc Size: %lu; Current Size: %lu; Available: %lu",
-        count * type_size,
-        arena->offset,
-        available);
+        "[Arena Allocation Log] Alloc Size: %" PRIu64 "; Current Size: %" PRIu64
+        "; Available: %" PRIu64,
+        (uint64_t)(count * type_size),
+        (uint64_t)arena->offset,
+        (uint64_t)available);
 #endif
     return flags & ARENA_ZERO_MEMORY ? memset((void*)aligned_ptr, 0, count * type_size)
                                      : (void*)aligned_ptr;
@@ -133,6 +135,116 @@ void arena_release(arena_t* arena)
 #endif
 }
 
+/* Thread arena allocator functions */
+
+void thread_arena_pool_init(
+    thread_arena_pool_t* pool, arena_t* parent, uint64_t capacity, uint32_t chunk_size)
+{
+    assert(pool);
+    assert(parent);
+    assert(chunk_size > 0);
+    pool->begin = arena_alloc(parent, sizeof(uint8_t), 64, (ptrdiff_t)capacity, 0);
+    pool->end = pool->begin + capacity;
+    pool->chunk_size = chunk_size;
+    atomic_init(&pool->offset, 0);
+    atomic_init(&pool->epoch, 0);
+}
+
+void thread_arena_pool_reset(thread_arena_pool_t* pool)
+{
+    assert(pool);
+    atomic_store_explicit(&pool->offset, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pool->epoch, 1, memory_order_release);
+}
+
+uint64_t thread_arena_pool_current_size(thread_arena_pool_t* pool)
+{
+    uint64_t offset = atomic_load_explicit(&pool->offset, memory_order_relaxed);
+    uint64_t capacity = pool->end - pool->begin;
+    // Failed allocations may leave the offset beyond the end of the pool.
+    return offset < capacity ? offset : capacity;
+}
+
+void thread_arena_init(thread_arena_t* arena, thread_arena_pool_t* pool)
+{
+    assert(arena);
+    assert(pool);
+    arena->pool = pool;
+    arena->curr = NULL;
+    arena->end = NULL;
+    arena->epoch = atomic_load_explicit(&pool->epoch, memory_order_acquire);
+}
+
+uint8_t* _thread_arena_pool_alloc(thread_arena_pool_t* pool, ptrdiff_t size, int flags)
+{
+    // Lock-free - the offset may be bumped past the end by concurrent failures, but a reset
+    // rewinds it.
+    int64_t offset = atomic_fetch_add_explicit(&pool->offset, size, memory_order_relaxed);
+    if (offset + size > pool->end - pool->begin)
+    {
+        // A soft fail is expected by the caller (e.g. to fall back to serial execution), so isn't
+        // an error.
+        if (flags & ARENA_OUT_OF_MEM_SOFT_FAIL)
+        {
+            return NULL;
+        }
+        log_error(
+            "Thread arena pool out of memory - capacity = %" PRIu64
+            "; Required allocation size: %" PRIu64,
+            (uint64_t)(pool->end - pool->begin),
+            (uint64_t)size);
+        abort();
+    }
+    return pool->begin + offset;
+}
+
+void* thread_arena_alloc(
+    thread_arena_t* arena, ptrdiff_t type_size, ptrdiff_t align, ptrdiff_t count, int flags)
+{
+    assert(arena && arena->pool);
+    thread_arena_pool_t* pool = arena->pool;
+
+    // Discard the current chunk if the pool has been reset since it was taken.
+    uint32_t epoch = atomic_load_explicit(&pool->epoch, memory_order_acquire);
+    if (epoch != arena->epoch)
+    {
+        arena->curr = NULL;
+        arena->end = NULL;
+        arena->epoch = epoch;
+    }
+
+    ptrdiff_t size = count * type_size;
+    uint8_t* out = NULL;
+    if (size + align > pool->chunk_size / 4)
+    {
+        // Large allocations are taken from the pool directly so the current chunk isn't wasted.
+        uint8_t* ptr = _thread_arena_pool_alloc(pool, size + align - 1, flags);
+        if (!ptr)
+        {
+            return NULL;
+        }
+        out = (uint8_t*)(((uintptr_t)ptr + (align - 1)) & ~(align - 1));
+    }
+    else
+    {
+        uintptr_t aligned_ptr = ((uintptr_t)arena->curr + (align - 1)) & ~(align - 1);
+        if (!arena->curr || aligned_ptr + size > (uintptr_t)arena->end)
+        {
+            uint8_t* chunk = _thread_arena_pool_alloc(pool, pool->chunk_size, flags);
+            if (!chunk)
+            {
+                return NULL;
+            }
+            arena->curr = chunk;
+            arena->end = chunk + pool->chunk_size;
+            aligned_ptr = ((uintptr_t)arena->curr + (align - 1)) & ~(align - 1);
+        }
+        out = (uint8_t*)aligned_ptr;
+        arena->curr = out + size;
+    }
+    return flags & ARENA_ZERO_MEMORY ? memset(out, 0, size) : out;
+}
+
 /* Dynamic array allocator functions */
 
 void* _offset_ptr(void* ptr, size_t offset, size_t type_size)
@@ -166,6 +166,83 @@ void arena_reset(arena_t* arena);
  */
 void arena_release(arena_t* arena);
 
+/* ====================== Thread arena allocator ========================== */
+
+#define ARENA_THREAD_CHUNK_SIZE (64 * 1024)
+
+/**
+ A pool of memory shared between thread arenas. Each thread arena carves chunks from the pool via
+ an atomic bump of the pool offset, so allocations never take a lock.
+ */
+typedef struct ThreadArenaPool
+{
+    uint8_t* begin;
+    uint8_t* end;
+    atomic_int_fast64_t offset;
+    /// Incremented on each reset - thread arenas holding a chunk from an older epoch discard it.
+    atomic_uint epoch;
+    uint32_t chunk_size;
+} thread_arena_pool_t;
+
+/**
+ An arena owned by a single thread. Not thread-safe - only the owning thread may allocate from it.
+ */
+typedef struct ThreadArena
+{
+    thread_arena_pool_t* pool;
+    uint8_t* curr;
+    uint8_t* end;
+    uint32_t epoch;
+} thread_arena_t;
+
+#define THREAD_ARENA_MAKE_ARRAY(arena, type, size, flags)                                          \
+    (type*)thread_arena_alloc(arena, sizeof(type), _Alignof(type), size, flags)
+
+#define THREAD_ARENA_MAKE_ZERO_ARRAY(arena, type, size)                                            \
+    (type*)thread_arena_alloc(arena, sizeof(type), _Alignof(type), size, ARENA_ZERO_MEMORY)
+
+#define THREAD_ARENA_MAKE_ZERO_STRUCT(arena, type)                                                 \
+    (type*)thread_arena_alloc(arena, sizeof(type), _Alignof(type), 1, ARENA_ZERO_MEMORY)
+
+/**
+ Initialise a thread arena pool.
+ @param pool A pointer to the pool to initialise.
+ @param parent The arena which the pool memory is allocated from.
+ @param capacity The size of the pool in bytes.
+ @param chunk_size The size of the chunks handed to each thread arena. Allocations larger than a
+ quarter of this are taken from the pool directly.
+ */
+void thread_arena_pool_init(
+    thread_arena_pool_t* pool, arena_t* parent, uint64_t capacity, uint32_t chunk_size);
+
+/**
+ Rewind all thread arenas which allocate from this pool.
+ @note Must only be called when no threads are allocating from the pool - all previous
+ allocations are invalidated.
+ @param pool A pointer to the pool.
+ */
+void thread_arena_pool_reset(thread_arena_pool_t* pool);
+
+/**
+ @return The number of bytes carved from the pool since the last reset.
+ */
+uint64_t thread_arena_pool_current_size(thread_arena_pool_t* pool);
+
+void thread_arena_init(thread_arena_t* arena, thread_arena_pool_t* pool);
+
+/**
+ Allocate a new space from a thread arena. If the current chunk is exhausted, a new chunk is taken
+ from the pool. Out of memory behaviour is the same as @sa arena_alloc.
+ @param arena A pointer to an initialised thread arena, owned by the calling thread.
+ @param type_size The size of the type this space will hold in bytes.
+ @param align The alignment of the type.
+ @param count The number of elements.
+ @param flags See flags above.
+ @return A pointer to the allocated space, or NULL if out of memory and the soft fail flag is set.
+ */
+void* thread_arena_alloc(
+    thread_arena_t* arena, ptrdiff_t type_size, ptrdiff_t align, ptrdiff_t count, int flags);
+
 /* ====================== Dynamic array allocator ========================== */
 
 #define MAKE_DYN_ARRAY(type, arena, size, new_dyn_array)                                           \
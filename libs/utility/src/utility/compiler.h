@@ -70,3 +70,9 @@
 #elif WIN32
 #define RPE_ALIGNAS(sz) __declspec(align(sz))
 #endif
+
+#ifdef _MSC_VER
+#define RPE_THREAD_LOCAL __declspec(thread)
+#else
+#define RPE_THREAD_LOCAL _Thread_local
+#endif
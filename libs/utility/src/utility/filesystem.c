@@ -29,6 +29,18 @@
 #include <log.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <string.h>
+
+#if __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif WIN32
+#include <windows.h>
+#endif
+
+#define FS_TEMP_FILE_EXT ".tmp"
 
 typedef struct FsBuffer
 {
@@ -123,3 +135,128 @@ inline char* fs_get_buffer(fs_buffer_t* fs)
     assert(fs);
     return fs->buffer;
 }
+
+bool fs_write_file_atomic(const char* path, const void* data, size_t size)
+{
+    assert(path);
+    assert(data || !size);
+
+    size_t path_len = strlen(path);
+    char* tmp_path = malloc(path_len + sizeof(FS_TEMP_FILE_EXT));
+    assert(tmp_path);
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, FS_TEMP_FILE_EXT, sizeof(FS_TEMP_FILE_EXT));
+
+    FILE* fp = fopen(tmp_path, "wb");
+    if (!fp)
+    {
+        log_error("Error opening file for writing: %s", tmp_path);
+        free(tmp_path);
+        return false;
+    }
+    bool success = fwrite(data, 1, size, fp) == size;
+    success &= fflush(fp) == 0;
+    success &= fclose(fp) == 0;
+    if (!success)
+    {
+        log_error("Error writing file: %s", tmp_path);
+        remove(tmp_path);
+        free(tmp_path);
+        return false;
+    }
+
+#if WIN32
+    success = MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#elif __unix__ || __APPLE__
+    // POSIX rename atomically replaces an existing file.
+    success = rename(tmp_path, path) == 0;
+#else
+    log_error("Atomic file replacement is not supported on this platform.");
+    success = false;
+#endif
+    if (!success)
+    {
+        log_error("Error replacing file: %s", path);
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    return success;
+}
+
+bool fs_map_file(const char* path, fs_mapped_file_t* out)
+{
+    assert(path);
+    assert(out);
+    memset(out, 0, sizeof(fs_mapped_file_t));
+
+#if __linux__
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file.
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        log_error("Error mapping file: %s", path);
+        return false;
+    }
+    out->data = data;
+    out->size = st.st_size;
+#elif WIN32
+    HANDLE file = CreateFileA(
+        path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* data = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!data)
+    {
+        log_error("Error mapping file: %s", path);
+        if (map)
+        {
+            CloseHandle(map);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    out->data = data;
+    out->size = size.QuadPart;
+    out->file_handle = file;
+    out->map_handle = map;
+#endif
+    return true;
+}
+
+void fs_unmap_file(fs_mapped_file_t* m)
+{
+    assert(m);
+    if (!m->data)
+    {
+        return;
+    }
+#if __linux__
+    munmap((void*)m->data, m->size);
+#elif WIN32
+    UnmapViewOfFile(m->data);
+    CloseHandle(m->map_handle);
+    CloseHandle(m->file_handle);
+#endif
+    memset(m, 0, sizeof(fs_mapped_file_t));
+}
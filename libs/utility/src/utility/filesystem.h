@@ -32,6 +32,19 @@ typedef struct Arena arena_t;
 typedef struct String string_t;
 typedef struct FsBuffer fs_buffer_t;
 
+/**
+ A read-only memory mapping of a file.
+ */
+typedef struct FsMappedFile
+{
+    const void* data;
+    size_t size;
+#if WIN32
+    void* file_handle;
+    void* map_handle;
+#endif
+} fs_mapped_file_t;
+
 char fs_get_platform_seperator();
 
 size_t fs_get_file_size(FILE* fp);
@@ -46,4 +59,26 @@ char* fs_get_buffer(fs_buffer_t* fs);
 
 string_t fs_remove_filename(string_t* path, arena_t* arena);
 
+/**
+ Write a buffer to file atomically. The data is written to a temporary file alongside the
+ destination, which then replaces the destination in a single rename - so if the write fails or the
+ process exits part way through, the previous file (if any) is left intact.
+ @param path The destination file path.
+ @param data The data to write.
+ @param size The size of the data in bytes.
+ @return true if the file was written successfully.
+ */
+bool fs_write_file_atomic(const char* path, const void* data, size_t size);
+
+/**
+ Map a file into memory for reading. Pages are only read from disk when touched, so this avoids
+ copying the whole file when only part of it is used.
+ @param path The file to map.
+ @param [out] out The mapping - only valid if successful.
+ @return true if the file was mapped successfully. Empty files are not mapped.
+ */
+bool fs_map_file(const char* path, fs_mapped_file_t* out);
+
+void fs_unmap_file(fs_mapped_file_t* m);
+
 #endif
\ No newline at end of file
@@ -26,6 +26,11 @@
 #include <string.h>
 
 uint32_t murmur2_hash(void* data, uint32_t len, uint32_t seed)
+{
+    return (uint32_t)murmur2_hash64(data, len, seed);
+}
+
+uint64_t murmur2_hash64(const void* data, uint64_t len, uint64_t seed)
 {
     assert(len > 0);
 
@@ -34,7 +39,7 @@ uint32_t murmur2_hash(void* data, uint32_t len, uint32_t seed)
 
     uint64_t h1 = seed ^ (len * Constant);
 
-    const uint64_t* dataPtr = (uint64_t*)data;
+    const uint64_t* dataPtr = (const uint64_t*)data;
     const uint64_t* endPtr = dataPtr + (len / 8);
 
     // Process the "body" - 8bytes processed per loop.
@@ -49,7 +54,7 @@ uint32_t murmur2_hash(void* data, uint32_t len, uint32_t seed)
     }
 
     // Process any remaining bytes - max of 7bytes.
-    const uint8_t* tail = (uint8_t*)dataPtr;
+    const uint8_t* tail = (const uint8_t*)dataPtr;
 
     switch (len & 7)
     {
@@ -33,6 +33,12 @@
  */
 uint32_t murmur2_hash(void* data, uint32_t len, uint32_t seed);
 
+/**
+ The full 64-bit result of the murmur2 hasher - for use where collisions must be avoided, such as
+ content-addressed keys. @sa murmur2_hash is the lower 32-bits of this result.
+ */
+uint64_t murmur2_hash64(const void* data, uint64_t len, uint64_t seed);
+
 // Specialised murmur hash for strings.
 uint32_t murmur2_hash_string(void* key, uint32_t, uint32_t);
 
@@ -0,0 +1,455 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "hash_map.h"
+
+#include "compiler.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HASH_MAP_USE_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define HASH_MAP_NOT_FOUND UINT32_MAX
+
+static RPE_FORCE_INLINE uint32_t _ctz32(uint32_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static RPE_FORCE_INLINE uint32_t _h1(uint32_t hash) { return hash >> 7; }
+
+static RPE_FORCE_INLINE int8_t _h2(uint32_t hash) { return (int8_t)(hash & 0x7f); }
+
+static RPE_FORCE_INLINE uint32_t _max_load(uint32_t capacity) { return capacity - capacity / 8; }
+
+/** Group functions - each returns a bitmask with a bit set for each matching slot. **/
+
+static RPE_FORCE_INLINE uint32_t _group_match(const int8_t* group, int8_t h2)
+{
+#ifdef HASH_MAP_USE_SSE2
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (uint32_t)(group[i] == h2) << i;
+    }
+    return mask;
+#endif
+}
+
+static RPE_FORCE_INLINE uint32_t _group_match_empty(const int8_t* group)
+{
+    return _group_match(group, HASH_MAP_CTRL_EMPTY);
+}
+
+static RPE_FORCE_INLINE uint32_t _group_match_empty_or_deleted(const int8_t* group)
+{
+#ifdef HASH_MAP_USE_SSE2
+    // Empty and deleted are the only states with the sign bit set.
+    __m128i ctrl = _mm_load_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(ctrl);
+#else
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
+    {
+        mask |= (uint32_t)(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+static RPE_FORCE_INLINE void* _key_at(hash_map_t* map, uint32_t idx)
+{
+    return map->keys + (size_t)idx * map->key_type_size;
+}
+
+static RPE_FORCE_INLINE void* _value_at(hash_map_t* map, uint32_t idx)
+{
+    return map->values + (size_t)idx * map->value_type_size;
+}
+
+static RPE_FORCE_INLINE uint32_t _hash_key(hash_map_t* map, void* key)
+{
+    return map->hash_func(key, map->key_type_size, 0);
+}
+
+static void _alloc_slots(hash_map_t* map, uint32_t capacity)
+{
+    assert(capacity >= HASH_MAP_GROUP_WIDTH);
+    assert((capacity & (capacity - 1)) == 0);
+    map->capacity = capacity;
+    map->ctrl = arena_alloc(
+        map->arena, sizeof(int8_t), HASH_MAP_GROUP_WIDTH, capacity, ARENA_NONZERO_MEMORY);
+    map->keys = arena_alloc(map->arena, map->key_type_size, 16, capacity, ARENA_NONZERO_MEMORY);
+    map->values =
+        arena_alloc(map->arena, map->value_type_size, 16, capacity, ARENA_NONZERO_MEMORY);
+    memset(map->ctrl, HASH_MAP_CTRL_EMPTY, capacity);
+}
+
+static uint32_t _capacity_for(uint32_t count)
+{
+    uint32_t capacity = HASH_MAP_GROUP_WIDTH;
+    while (_max_load(capacity) < count)
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Groups are probed using a triangular sequence, which visits every group when the group count
+// is a power of two.
+static uint32_t _find_idx(hash_map_t* map, void* key, uint32_t hash)
+{
+    uint32_t group_mask = map->capacity / HASH_MAP_GROUP_WIDTH - 1;
+    uint32_t group_idx = _h1(hash) & group_mask;
+    int8_t h2 = _h2(hash);
+
+    for (uint32_t step = 1; step <= group_mask + 1; ++step)
+    {
+        uint32_t base = group_idx * HASH_MAP_GROUP_WIDTH;
+        const int8_t* group = map->ctrl + base;
+
+        uint32_t match = _group_match(group, h2);
+        while (match)
+        {
+            uint32_t idx = base + _ctz32(match);
+            if (memcmp(_key_at(map, idx), key, map->key_type_size) == 0)
+            {
+                return idx;
+            }
+            match &= match - 1;
+        }
+        // An empty slot terminates the probe sequence - the key would have been placed here.
+        if (_group_match_empty(group))
+        {
+            return HASH_MAP_NOT_FOUND;
+        }
+        group_idx = (group_idx + step) & group_mask;
+    }
+    return HASH_MAP_NOT_FOUND;
+}
+
+static uint32_t _find_insert_idx(hash_map_t* map, uint32_t hash)
+{
+    uint32_t group_mask = map->capacity / HASH_MAP_GROUP_WIDTH - 1;
+    uint32_t group_idx = _h1(hash) & group_mask;
+
+    for (uint32_t step = 1;; ++step)
+    {
+        assert(step <= group_mask + 1);
+        uint32_t base = group_idx * HASH_MAP_GROUP_WIDTH;
+        uint32_t mask = _group_match_empty_or_deleted(map->ctrl + base);
+        if (mask)
+        {
+            return base + _ctz32(mask);
+        }
+        group_idx = (group_idx + step) & group_mask;
+    }
+}
+
+static void _resize(hash_map_t* map, uint32_t new_capacity)
+{
+    int8_t* old_ctrl = map->ctrl;
+    uint8_t* old_keys = map->keys;
+    uint8_t* old_values = map->values;
+    uint32_t old_capacity = map->capacity;
+
+    // Note: The old slots can't be returned to the arena.
+    _alloc_slots(map, new_capacity);
+    map->tombstones = 0;
+
+    for (uint32_t i = 0; i < old_capacity; ++i)
+    {
+        if (old_ctrl[i] < 0)
+        {
+            continue;
+        }
+        void* key = old_keys + (size_t)i * map->key_type_size;
+        uint32_t hash = _hash_key(map, key);
+        uint32_t idx = _find_insert_idx(map, hash);
+        map->ctrl[idx] = _h2(hash);
+        memcpy(_key_at(map, idx), key, map->key_type_size);
+        memcpy(
+            _value_at(map, idx),
+            old_values + (size_t)i * map->value_type_size,
+            map->value_type_size);
+    }
+}
+
+// Removes all tombstones without allocating. Adapted from the abseil implementation:
+// https://github.com/abseil/abseil-cpp/blob/master/absl/container/internal/raw_hash_set.cc
+static void _rehash_in_place(hash_map_t* map)
+{
+    // Mark all full slots as deleted (needing placement) and all deleted slots as empty.
+    for (uint32_t i = 0; i < map->capacity; ++i)
+    {
+        map->ctrl[i] = map->ctrl[i] < 0 ? HASH_MAP_CTRL_EMPTY : HASH_MAP_CTRL_DELETED;
+    }
+
+    uint32_t i = 0;
+    while (i < map->capacity)
+    {
+        if (map->ctrl[i] != HASH_MAP_CTRL_DELETED)
+        {
+            ++i;
+            continue;
+        }
+        uint32_t hash = _hash_key(map, _key_at(map, i));
+        uint32_t new_idx = _find_insert_idx(map, hash);
+        int8_t h2 = _h2(hash);
+
+        // If the slot is within the first group that would be probed, it can stay put.
+        if (new_idx / HASH_MAP_GROUP_WIDTH == i / HASH_MAP_GROUP_WIDTH)
+        {
+            map->ctrl[i] = h2;
+            ++i;
+            continue;
+        }
+
+        if (map->ctrl[new_idx] == HASH_MAP_CTRL_EMPTY)
+        {
+            map->ctrl[new_idx] = h2;
+            memcpy(_key_at(map, new_idx), _key_at(map, i), map->key_type_size);
+            memcpy(_value_at(map, new_idx), _value_at(map, i), map->value_type_size);
+            map->ctrl[i] = HASH_MAP_CTRL_EMPTY;
+            ++i;
+        }
+        else
+        {
+            // The destination holds an entry yet to be placed - swap and process the current
+            // slot again.
+            uint8_t* swap_key = map->_swap_space;
+            uint8_t* swap_val = map->_swap_space + map->key_type_size;
+            map->ctrl[new_idx] = h2;
+            memcpy(swap_key, _key_at(map, new_idx), map->key_type_size);
+            memcpy(swap_val, _value_at(map, new_idx), map->value_type_size);
+            memcpy(_key_at(map, new_idx), _key_at(map, i), map->key_type_size);
+            memcpy(_value_at(map, new_idx), _value_at(map, i), map->value_type_size);
+            memcpy(_key_at(map, i), swap_key, map->key_type_size);
+            memcpy(_value_at(map, i), swap_val, map->value_type_size);
+        }
+    }
+    map->tombstones = 0;
+}
+
+static void _prepare_insert(hash_map_t* map)
+{
+    if (map->size + map->tombstones + 1 <= _max_load(map->capacity))
+    {
+        return;
+    }
+    // If the majority of the used slots are tombstones, compact rather than grow.
+    if (map->size + 1 <= _max_load(map->capacity) / 2)
+    {
+        _rehash_in_place(map);
+    }
+    else
+    {
+        _resize(map, map->capacity * 2);
+    }
+}
+
+static void* _insert(hash_map_t* map, void* key, void* value, bool overwrite)
+{
+    assert(map);
+    assert(key);
+    assert(value);
+
+    uint32_t hash = _hash_key(map, key);
+    uint32_t idx = _find_idx(map, key, hash);
+    if (idx != HASH_MAP_NOT_FOUND)
+    {
+        if (!overwrite)
+        {
+            return NULL;
+        }
+        void* out = _value_at(map, idx);
+        memcpy(out, value, map->value_type_size);
+        return out;
+    }
+
+    _prepare_insert(map);
+    idx = _find_insert_idx(map, hash);
+    if (map->ctrl[idx] == HASH_MAP_CTRL_DELETED)
+    {
+        --map->tombstones;
+    }
+    map->ctrl[idx] = _h2(hash);
+    memcpy(_key_at(map, idx), key, map->key_type_size);
+    void* out = _value_at(map, idx);
+    memcpy(out, value, map->value_type_size);
+    ++map->size;
+    return out;
+}
+
+static void _erase_idx(hash_map_t* map, uint32_t idx)
+{
+    assert(map->ctrl[idx] >= 0);
+    // If the group has an empty slot, no probe sequence can have continued past this group, so
+    // the slot can be marked as empty rather than requiring a tombstone.
+    const int8_t* group = map->ctrl + (idx & ~(HASH_MAP_GROUP_WIDTH - 1));
+    if (_group_match_empty(group))
+    {
+        map->ctrl[idx] = HASH_MAP_CTRL_EMPTY;
+    }
+    else
+    {
+        map->ctrl[idx] = HASH_MAP_CTRL_DELETED;
+        ++map->tombstones;
+    }
+    --map->size;
+}
+
+/** Public functions **/
+
+hash_map_t hash_map_create(
+    arena_t* arena,
+    hash_map_func_t* hash_func,
+    uint32_t key_type_size,
+    uint32_t value_type_size,
+    uint32_t capacity)
+{
+    assert(arena);
+    assert(hash_func);
+    assert(key_type_size > 0);
+    assert(value_type_size > 0);
+
+    hash_map_t map;
+    map.size = 0;
+    map.tombstones = 0;
+    map.arena = arena;
+    map.hash_func = hash_func;
+    map.key_type_size = key_type_size;
+    map.value_type_size = value_type_size;
+    map._swap_space =
+        arena_alloc(arena, key_type_size + value_type_size, 16, 1, ARENA_NONZERO_MEMORY);
+
+    _alloc_slots(&map, _capacity_for(capacity ? capacity : HASH_MAP_INIT_CAPACITY));
+    return map;
+}
+
+void* hash_map_insert(hash_map_t* map, void* key, void* value)
+{
+    return _insert(map, key, value, false);
+}
+
+void* hash_map_set(hash_map_t* map, void* key, void* value)
+{
+    return _insert(map, key, value, true);
+}
+
+void* hash_map_get(hash_map_t* map, void* key)
+{
+    assert(map);
+    assert(key);
+    uint32_t idx = _find_idx(map, key, _hash_key(map, key));
+    return idx != HASH_MAP_NOT_FOUND ? _value_at(map, idx) : NULL;
+}
+
+bool hash_map_find(hash_map_t* map, void* key)
+{
+    assert(map);
+    assert(key);
+    return _find_idx(map, key, _hash_key(map, key)) != HASH_MAP_NOT_FOUND;
+}
+
+bool hash_map_erase(hash_map_t* map, void* key)
+{
+    assert(map);
+    assert(key);
+    uint32_t idx = _find_idx(map, key, _hash_key(map, key));
+    if (idx == HASH_MAP_NOT_FOUND)
+    {
+        return false;
+    }
+    _erase_idx(map, idx);
+    return true;
+}
+
+void hash_map_reserve(hash_map_t* map, uint32_t count)
+{
+    assert(map);
+    uint32_t capacity = _capacity_for(count);
+    if (capacity > map->capacity)
+    {
+        _resize(map, capacity);
+    }
+}
+
+void hash_map_clear(hash_map_t* map)
+{
+    assert(map);
+    memset(map->ctrl, HASH_MAP_CTRL_EMPTY, map->capacity);
+    map->size = 0;
+    map->tombstones = 0;
+}
+
+hash_map_iterator_t hash_map_iter_create(hash_map_t* map)
+{
+    assert(map);
+    hash_map_iterator_t it = {.map = map, .curr_idx = 0};
+    return it;
+}
+
+void* hash_map_iter_next(hash_map_iterator_t* it)
+{
+    assert(it);
+    hash_map_t* map = it->map;
+    while (it->curr_idx < map->capacity)
+    {
+        uint32_t idx = it->curr_idx++;
+        if (map->ctrl[idx] >= 0)
+        {
+            return _value_at(map, idx);
+        }
+    }
+    return NULL;
+}
+
+void* hash_map_iter_key(hash_map_iterator_t* it)
+{
+    assert(it);
+    assert(it->curr_idx > 0);
+    return _key_at(it->map, it->curr_idx - 1);
+}
+
+void hash_map_iter_erase(hash_map_iterator_t* it)
+{
+    assert(it);
+    assert(it->curr_idx > 0);
+    _erase_idx(it->map, it->curr_idx - 1);
+}
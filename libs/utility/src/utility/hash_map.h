@@ -0,0 +1,202 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __UTILITY_HASH_MAP_H__
+#define __UTILITY_HASH_MAP_H__
+
+#include "arena.h"
+#include "hash.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ An open-addressing hash map based on the "Swiss table" design. Each slot has a control byte
+ which holds either the state of the slot (empty/deleted) or the lower 7-bits of the hash. The
+ control bytes are probed a group at a time using SIMD, and keys are only compared on a control
+ byte match.
+ Keys and values are stored inline in flat arrays, so keys must be POD types (compared with
+ memcmp - zero any padding). Pointers returned by the map are invalidated by any insertion.
+ */
+
+#define HASH_MAP_GROUP_WIDTH 16
+#define HASH_MAP_INIT_CAPACITY 64
+
+#define HASH_MAP_CTRL_EMPTY (int8_t)0x80
+#define HASH_MAP_CTRL_DELETED (int8_t)0xfe
+
+typedef uint32_t(hash_map_func_t)(void*, uint32_t, uint32_t);
+
+typedef struct HashMap
+{
+    /// The number of slots - always a power of two and a multiple of the group width.
+    uint32_t capacity;
+    uint32_t size;
+    /// The number of deleted slots which can't be used for inserting without a rehash.
+    uint32_t tombstones;
+    int8_t* ctrl;
+    uint8_t* keys;
+    uint8_t* values;
+    uint32_t key_type_size;
+    uint32_t value_type_size;
+    hash_map_func_t* hash_func;
+    arena_t* arena;
+
+    /** Private **/
+    // Scratch space for a single key/value pair used when rehashing.
+    uint8_t* _swap_space;
+} hash_map_t;
+
+typedef struct HashMapIterator
+{
+    hash_map_t* map;
+    uint32_t curr_idx;
+} hash_map_iterator_t;
+
+/**
+ Create a new hash map.
+ @param capacity The number of entries to pre-size the map for. If zero, the default capacity is
+ used.
+ */
+hash_map_t hash_map_create(
+    arena_t* arena,
+    hash_map_func_t* hash_func,
+    uint32_t key_type_size,
+    uint32_t value_type_size,
+    uint32_t capacity);
+
+/**
+ Insert a key/value pair into the map.
+ @return A pointer to the value stored in the map, or NULL if the key already exists.
+ */
+void* hash_map_insert(hash_map_t* map, void* key, void* value);
+
+/**
+ Insert a key/value pair, overwriting the value if the key already exists.
+ @return A pointer to the value stored in the map.
+ */
+void* hash_map_set(hash_map_t* map, void* key, void* value);
+
+/**
+ @return A pointer to the value associated with the key, or NULL if the key isn't present.
+ */
+void* hash_map_get(hash_map_t* map, void* key);
+
+bool hash_map_find(hash_map_t* map, void* key);
+
+/**
+ Remove the key from the map.
+ @return true if the key was present.
+ */
+bool hash_map_erase(hash_map_t* map, void* key);
+
+/**
+ Ensure the map can hold at least @sa count entries without needing to grow.
+ */
+void hash_map_reserve(hash_map_t* map, uint32_t count);
+
+void hash_map_clear(hash_map_t* map);
+
+#ifndef WIN32
+#define HASH_MAP_CREATE(key_type, val_type, arena)                                                 \
+    hash_map_create(arena, murmur2_hash, sizeof(key_type), sizeof(val_type), 0)
+
+#define HASH_MAP_CREATE_WITH_CAPACITY(key_type, val_type, arena, capacity)                         \
+    hash_map_create(arena, murmur2_hash, sizeof(key_type), sizeof(val_type), capacity)
+
+#define HASH_MAP_FIND(map, key)                                                                    \
+    ({                                                                                             \
+        __auto_type _key = (key);                                                                  \
+        assert((map)->key_type_size == sizeof(*_key));                                             \
+        hash_map_find(map, _key);                                                                  \
+    })
+
+#define HASH_MAP_INSERT(map, key, value)                                                           \
+    ({                                                                                             \
+        __auto_type _key = (key);                                                                  \
+        __auto_type _val = (value);                                                                \
+        assert((map)->key_type_size == sizeof(*_key));                                             \
+        assert((map)->value_type_size == sizeof(*_val));                                           \
+        hash_map_insert(map, _key, _val);                                                          \
+    })
+
+#define HASH_MAP_SET(map, key, value)                                                              \
+    ({                                                                                             \
+        __auto_type _key = (key);                                                                  \
+        __auto_type _val = (value);                                                                \
+        assert((map)->key_type_size == sizeof(*_key));                                             \
+        assert((map)->value_type_size == sizeof(*_val));                                           \
+        hash_map_set(map, _key, _val);                                                             \
+    })
+
+#define HASH_MAP_GET(map, key)                                                                     \
+    ({                                                                                             \
+        __auto_type _key = (key);                                                                  \
+        __auto_type _map = (map);                                                                  \
+        assert((_map)->key_type_size == sizeof(*_key));                                            \
+        hash_map_get(_map, _key);                                                                  \
+    })
+
+#define HASH_MAP_ERASE(map, key)                                                                   \
+    ({                                                                                             \
+        __auto_type _key = (key);                                                                  \
+        assert((map)->key_type_size == sizeof(*_key));                                             \
+        hash_map_erase(map, _key);                                                                 \
+    })
+#else
+#define HASH_MAP_CREATE(key_type, val_type, arena)                                                 \
+    hash_map_create(arena, murmur2_hash, sizeof(key_type), sizeof(val_type), 0)
+
+#define HASH_MAP_CREATE_WITH_CAPACITY(key_type, val_type, arena, capacity)                         \
+    hash_map_create(arena, murmur2_hash, sizeof(key_type), sizeof(val_type), capacity)
+
+#define HASH_MAP_FIND(map, key) hash_map_find(map, key)
+
+#define HASH_MAP_INSERT(map, key, value) hash_map_insert(map, key, value)
+
+#define HASH_MAP_SET(map, key, value) hash_map_set(map, key, value)
+
+#define HASH_MAP_GET(map, key) hash_map_get(map, key)
+
+#define HASH_MAP_ERASE(map, key) hash_map_erase(map, key)
+#endif
+
+hash_map_iterator_t hash_map_iter_create(hash_map_t* map);
+
+/**
+ @return A pointer to the next value in the map, or NULL if the end has been reached.
+ */
+void* hash_map_iter_next(hash_map_iterator_t* it);
+
+/**
+ @return A pointer to the key of the value last returned by @sa hash_map_iter_next.
+ */
+void* hash_map_iter_key(hash_map_iterator_t* it);
+
+/**
+ Erase the value last returned by @sa hash_map_iter_next. Erasing never moves other entries, so
+ iteration can continue with the same iterator.
+ */
+void hash_map_iter_erase(hash_map_iterator_t* it);
+
+#endif
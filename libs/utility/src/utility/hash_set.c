@@ -206,7 +206,14 @@ void* hash_set_get(hash_set_t* set, void* key)
 {
     assert(key);
     uint64_t hash = set->hash_func(key, set->key_type_size, 0);
-    _find(set, key, hash);
+    return hash_set_get_with_hash(set, hash);
+}
+
+void* hash_set_get_with_hash(hash_set_t* set, uint64_t hash)
+{
+    assert(set);
+    assert(hash != HASH_NULL && hash != HASH_DELETED);
+    _find(set, NULL, hash);
     return !set->_curr_node ? NULL : set->_curr_node->value;
 }
 
@@ -250,10 +257,17 @@ void* hash_set_set(hash_set_t* set, void* key, void* value)
 
 void* hash_set_insert(hash_set_t* set, void* key, void* value)
 {
-    assert(value);
     assert(key);
-
     uint64_t hash = set->hash_func(key, set->key_type_size, 0);
+    return hash_set_insert_with_hash(set, hash, value);
+}
+
+void* hash_set_insert_with_hash(hash_set_t* set, uint64_t hash, void* value)
+{
+    assert(set);
+    assert(value);
+    assert(hash != HASH_NULL && hash != HASH_DELETED);
+
     void* out = NULL;
     for (;;)
     {
@@ -76,8 +76,22 @@ void* hash_set_set(hash_set_t* set, void* key, void* value);
 
 void* hash_set_get(hash_set_t* set, void* key);
 
+/**
+ Get a value using a hash computed by the caller, for keys whose hash is maintained incrementally
+ rather than recomputed from the whole key on each lookup.
+ @param hash Must not be @sa HASH_NULL or @sa HASH_DELETED.
+ @return A pointer to the value, or NULL if no value with this hash exists.
+ */
+void* hash_set_get_with_hash(hash_set_t* set, uint64_t hash);
+
 void* hash_set_insert(hash_set_t* set, void* key, void* value);
 
+/**
+ Insert a value using a hash computed by the caller - see @sa hash_set_get_with_hash.
+ @return A pointer to the value stored in the set, or NULL if the hash already exists.
+ */
+void* hash_set_insert_with_hash(hash_set_t* set, uint64_t hash, void* value);
+
 bool hash_set_find(hash_set_t* set, void* key);
 
 void* hash_set_erase(hash_set_t* set, void* key);
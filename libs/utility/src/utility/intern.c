@@ -0,0 +1,236 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "intern.h"
+
+#include "hash.h"
+
+#include <assert.h>
+#include <log.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_HASH_SEED 0
+
+static intern_entry_t g_intern_entries[INTERN_MAX_STRINGS];
+// Twice the number of strings, keeping the load factor at or below a half.
+static atomic_uint g_intern_slots[INTERN_MAX_STRINGS * 2];
+static char g_intern_chars[INTERN_MAX_CHARS];
+
+static intern_table_t g_intern_table = {
+    .entries = g_intern_entries,
+    .capacity = INTERN_MAX_STRINGS,
+    .slots = g_intern_slots,
+    .slot_mask = INTERN_MAX_STRINGS * 2 - 1,
+    .chars = g_intern_chars,
+    .char_capacity = INTERN_MAX_CHARS,
+    .char_offset = 0,
+    .count = 0,
+    .lock = ATOMIC_FLAG_INIT};
+
+void intern_table_init(
+    intern_table_t* t, uint32_t capacity, uint32_t char_capacity, arena_t* arena)
+{
+    assert(t);
+    assert(capacity > 0 && capacity < INTERN_ID_INVALID);
+
+    uint32_t slot_count = 1;
+    while (slot_count < capacity * 2)
+    {
+        slot_count <<= 1;
+    }
+
+    t->entries = ARENA_MAKE_ZERO_ARRAY(arena, intern_entry_t, capacity);
+    t->capacity = capacity;
+    t->slots = ARENA_MAKE_ARRAY(arena, atomic_uint, slot_count, 0);
+    for (uint32_t i = 0; i < slot_count; ++i)
+    {
+        atomic_init(&t->slots[i], 0);
+    }
+    t->slot_mask = slot_count - 1;
+    t->chars = ARENA_MAKE_ARRAY(arena, char, char_capacity, 0);
+    t->char_capacity = char_capacity;
+    t->char_offset = 0;
+    atomic_init(&t->count, 0);
+    atomic_flag_clear(&t->lock);
+}
+
+uint64_t intern_hash(const char* str, uint32_t len)
+{
+    // The hasher doesn't accept empty keys.
+    return len ? murmur2_hash64(str, len, INTERN_HASH_SEED) : INTERN_HASH_SEED;
+}
+
+// Returns the slot which holds the string, or the empty slot which ends its probe sequence.
+uint32_t _intern_table_probe(
+    intern_table_t* t, const char* str, uint32_t len, uint64_t hash, intern_id_t* out_id)
+{
+    uint32_t idx = (uint32_t)hash & t->slot_mask;
+    for (;;)
+    {
+        // Pairs with the release store in @sa intern_table_add_with_hash, so the entry is
+        // visible once the slot is.
+        uint32_t value = atomic_load_explicit(&t->slots[idx], memory_order_acquire);
+        if (!value)
+        {
+            *out_id = INTERN_ID_INVALID;
+            return idx;
+        }
+        intern_entry_t* e = &t->entries[value - 1];
+        if (e->hash == hash && e->len == len && memcmp(e->str, str, len) == 0)
+        {
+            *out_id = value - 1;
+            return idx;
+        }
+        idx = (idx + 1) & t->slot_mask;
+    }
+}
+
+intern_id_t
+intern_table_find_with_hash(intern_table_t* t, const char* str, uint32_t len, uint64_t hash)
+{
+    assert(t);
+    assert(str);
+    intern_id_t id;
+    _intern_table_probe(t, str, len, hash, &id);
+    return id;
+}
+
+intern_id_t intern_table_find(intern_table_t* t, const char* str)
+{
+    assert(str);
+    uint32_t len = strlen(str);
+    return intern_table_find_with_hash(t, str, len, intern_hash(str, len));
+}
+
+intern_id_t
+intern_table_add_with_hash(intern_table_t* t, const char* str, uint32_t len, uint64_t hash)
+{
+    assert(t);
+    assert(str);
+
+    intern_id_t id = intern_table_find_with_hash(t, str, len, hash);
+    if (id != INTERN_ID_INVALID)
+    {
+        return id;
+    }
+
+    while (atomic_flag_test_and_set_explicit(&t->lock, memory_order_acquire))
+        ;
+
+    // Another thread may have added the string while waiting for the lock - as slots are only
+    // ever written under the lock, the probe also gives the slot to insert into.
+    uint32_t idx = _intern_table_probe(t, str, len, hash, &id);
+    if (id == INTERN_ID_INVALID)
+    {
+        uint32_t count = atomic_load_explicit(&t->count, memory_order_relaxed);
+        if (count < t->capacity && t->char_offset + len + 1 <= t->char_capacity)
+        {
+            char* chars = t->chars + t->char_offset;
+            memcpy(chars, str, len);
+            chars[len] = '\0';
+            t->char_offset += len + 1;
+
+            id = count;
+            t->entries[id] = (intern_entry_t){.str = chars, .len = len, .hash = hash};
+            atomic_store_explicit(&t->count, count + 1, memory_order_release);
+            atomic_store_explicit(&t->slots[idx], id + 1, memory_order_release);
+        }
+    }
+
+    atomic_flag_clear_explicit(&t->lock, memory_order_release);
+
+    // Ids are used to index other tables, so there is no sensible way to carry on.
+    if (id == INTERN_ID_INVALID)
+    {
+        log_error(
+            "Intern table full - capacity = %u strings, %u chars; Required string length: %u",
+            t->capacity,
+            t->char_capacity,
+            len);
+        abort();
+    }
+    return id;
+}
+
+intern_id_t intern_table_add(intern_table_t* t, const char* str)
+{
+    assert(str);
+    uint32_t len = strlen(str);
+    return intern_table_add_with_hash(t, str, len, intern_hash(str, len));
+}
+
+const char* intern_table_get_string(intern_table_t* t, intern_id_t id)
+{
+    assert(t);
+    assert(id < atomic_load_explicit(&t->count, memory_order_acquire));
+    return t->entries[id].str;
+}
+
+uint64_t intern_table_get_hash(intern_table_t* t, intern_id_t id)
+{
+    assert(t);
+    assert(id < atomic_load_explicit(&t->count, memory_order_acquire));
+    return t->entries[id].hash;
+}
+
+uint32_t intern_table_get_length(intern_table_t* t, intern_id_t id)
+{
+    assert(t);
+    assert(id < atomic_load_explicit(&t->count, memory_order_acquire));
+    return t->entries[id].len;
+}
+
+uint32_t intern_table_size(intern_table_t* t)
+{
+    assert(t);
+    return atomic_load_explicit(&t->count, memory_order_acquire);
+}
+
+intern_id_t intern_string(const char* str) { return intern_table_add(&g_intern_table, str); }
+
+intern_id_t intern_find(const char* str) { return intern_table_find(&g_intern_table, str); }
+
+const char* intern_get_string(intern_id_t id)
+{
+    return intern_table_get_string(&g_intern_table, id);
+}
+
+uint64_t intern_get_hash(intern_id_t id) { return intern_table_get_hash(&g_intern_table, id); }
+
+uint32_t intern_get_length(intern_id_t id)
+{
+    return intern_table_get_length(&g_intern_table, id);
+}
+
+intern_id_t intern_string_cached(atomic_uint* cache, const char* str)
+{
+    assert(cache);
+    intern_id_t id = atomic_load_explicit(cache, memory_order_acquire);
+    if (id == INTERN_ID_INVALID)
+    {
+        // Racing threads will intern the same string, so both store the same id.
+        id = intern_string(str);
+        atomic_store_explicit(cache, id, memory_order_release);
+    }
+    return id;
+}
@@ -0,0 +1,153 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __UTILITY_INTERN_H__
+#define __UTILITY_INTERN_H__
+
+#include "arena.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ A string interning table - each unique string is stored once and given a stable 32-bit id,
+ so strings can be compared and used as keys without touching the characters. The hash of the
+ string is computed once when it is interned.
+
+ Lookups are lock-free. Adding a string takes a spin lock, though strings are only added the
+ first time they are seen. Strings are never removed, so ids and string pointers remain valid for
+ the lifetime of the table.
+ */
+
+#define INTERN_ID_INVALID UINT32_MAX
+
+// The limits of the global table.
+#define INTERN_MAX_STRINGS 4096
+#define INTERN_MAX_CHARS (1 << 16)
+
+typedef uint32_t intern_id_t;
+
+typedef struct InternEntry
+{
+    const char* str;
+    uint32_t len;
+    uint64_t hash;
+} intern_entry_t;
+
+typedef struct InternTable
+{
+    intern_entry_t* entries;
+    uint32_t capacity;
+    /// Open addressed slots holding the id + 1 of an entry - zero denotes an empty slot.
+    atomic_uint* slots;
+    uint32_t slot_mask;
+    /// The storage for the interned characters, including the NULL terminators.
+    char* chars;
+    uint32_t char_capacity;
+    uint32_t char_offset;
+    atomic_uint count;
+    atomic_flag lock;
+} intern_table_t;
+
+/**
+ Initialise an intern table.
+ @param t A pointer to the table to initialise.
+ @param capacity The maximum number of strings the table can hold.
+ @param char_capacity The maximum number of characters the table can hold.
+ @param arena The arena used for the table storage.
+ */
+void intern_table_init(
+    intern_table_t* t, uint32_t capacity, uint32_t char_capacity, arena_t* arena);
+
+/**
+ Intern a string. If the string has already been interned, the existing id is returned. Aborts
+ if the table is full, so the returned id is always valid.
+ @param t A pointer to the table.
+ @param str The string to intern. The characters are copied into the table.
+ @returns The id of the string.
+ */
+intern_id_t intern_table_add(intern_table_t* t, const char* str);
+
+/**
+ Intern a string using a hash computed by the caller. Strings with the same hash are still given
+ different ids.
+ */
+intern_id_t
+intern_table_add_with_hash(intern_table_t* t, const char* str, uint32_t len, uint64_t hash);
+
+/**
+ Find a string without interning it.
+ @returns The id of the string, or INTERN_ID_INVALID if the string has not been interned.
+ */
+intern_id_t intern_table_find(intern_table_t* t, const char* str);
+
+intern_id_t
+intern_table_find_with_hash(intern_table_t* t, const char* str, uint32_t len, uint64_t hash);
+
+const char* intern_table_get_string(intern_table_t* t, intern_id_t id);
+
+uint64_t intern_table_get_hash(intern_table_t* t, intern_id_t id);
+
+uint32_t intern_table_get_length(intern_table_t* t, intern_id_t id);
+
+uint32_t intern_table_size(intern_table_t* t);
+
+/**
+ The hash used by the table - a 64-bit murmur2 hash of the characters.
+ */
+uint64_t intern_hash(const char* str, uint32_t len);
+
+// The global intern table - this requires no initialisation and is safe to use from any thread.
+
+intern_id_t intern_string(const char* str);
+
+intern_id_t intern_find(const char* str);
+
+const char* intern_get_string(intern_id_t id);
+
+uint64_t intern_get_hash(intern_id_t id);
+
+uint32_t intern_get_length(intern_id_t id);
+
+/**
+ Intern a string into the global table, caching the id so the string is only looked up on the
+ first call. Use @sa INTERN_LITERAL rather than calling this directly.
+ @param cache A pointer to the cached id - must be initialised to INTERN_ID_INVALID.
+ @param str The string to intern.
+ @returns The id of the string.
+ */
+intern_id_t intern_string_cached(atomic_uint* cache, const char* str);
+
+#ifndef _WIN32
+// Intern a string literal - the id is cached at the call site, so the string is only hashed and
+// looked up on the first call.
+#define INTERN_LITERAL(str)                                                                        \
+    ({                                                                                             \
+        static atomic_uint _intern_cache = INTERN_ID_INVALID;                                      \
+        intern_string_cached(&_intern_cache, str);                                                 \
+    })
+#else
+#define INTERN_LITERAL(str) intern_string(str)
+#endif
+
+#endif
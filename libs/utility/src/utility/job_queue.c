@@ -26,7 +26,6 @@
 
 #include <log.h>
 #include <utility/arena.h>
-#include <utility/hash.h>
 
 #define _GNU_SOURCE
 #include <assert.h>
@@ -37,6 +36,31 @@
 #include <processthreadsapi.h>
 #endif
 #include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The thread state of the calling thread, bound when a queue thread starts or a thread is adopted.
+// This allows jobs to be pushed and popped without any locking. The job queue is stored
+// separately so the binding can be checked without dereferencing a destroyed queue.
+static RPE_THREAD_LOCAL thread_info_t* tls_thread_info = NULL;
+static RPE_THREAD_LOCAL job_queue_t* tls_job_queue = NULL;
+
+void _bind_thread_info(job_queue_t* jq, thread_info_t* info)
+{
+    tls_thread_info = info;
+    tls_job_queue = jq;
+}
+
+thread_info_t* _get_thread_info(job_queue_t* jq)
+{
+    assert(tls_job_queue == jq && "Trying to run on a thread that hasn't been adopted?");
+    return tls_thread_info;
+}
 
 uint32_t _get_cpu_count()
 {
@@ -81,6 +105,56 @@ uint32_t _get_thread_id()
     return 0;
 }
 
+uint64_t _time_now_ns()
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#elif WIN32
+    LARGE_INTEGER counter;
+    LARGE_INTEGER freq;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&freq);
+    uint64_t q = counter.QuadPart / freq.QuadPart;
+    uint64_t r = counter.QuadPart % freq.QuadPart;
+    return q * 1000000000 + r * 1000000000 / freq.QuadPart;
+#else
+    // Not monotonic, but only used for measuring short intervals.
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void _cpu_relax()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#endif
+}
+
+void _thread_yield()
+{
+#ifdef __linux__
+    sched_yield();
+#elif WIN32
+    SwitchToThread();
+#endif
+}
+
+uint32_t _lowest_bit_idx(uint32_t mask)
+{
+    assert(mask);
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
 bool _active_jobs(job_queue_t* jq)
 {
     int active_count = atomic_load_explicit(&jq->active_job_count, memory_order_relaxed);
@@ -89,9 +163,8 @@ bool _active_jobs(job_queue_t* jq)
 
 bool _job_completed(job_t* job)
 {
-    int count = atomic_load_explicit(&job->child_run_count, memory_order_acquire) &
-        JOB_QUEUE_JOB_COUNT_MASK;
-    return count <= 0;
+    // Sequentially consistent so this is ordered with registering as a waiter on the job.
+    return atomic_load(&job->child_run_count) <= 0;
 }
 
 bool _exit_requested(thread_info_t* info)
@@ -99,53 +172,224 @@ bool _exit_requested(thread_info_t* info)
     return atomic_load_explicit(&info->job_queue->exit_thread, memory_order_relaxed);
 }
 
+#define JOB_QUEUE_FREE_LIST_END UINT32_MAX
+
+job_t* _get_job_by_idx(job_queue_t* jq, uint32_t idx)
+{
+    job_t* segment = atomic_load_explicit(
+        &jq->job_segments[idx >> JOB_QUEUE_SEGMENT_SHIFT], memory_order_acquire);
+    assert(segment);
+    return &segment[idx & JOB_QUEUE_SEGMENT_MASK];
+}
+
+uint64_t _free_list_next(uint64_t head, uint32_t idx)
+{
+    // Increment the tag on every update so a head which has been popped and pushed again between
+    // a load and compare-exchange is detected.
+    return (((head >> 32) + 1) << 32) | idx;
+}
+
+job_t* _alloc_job(job_queue_t* jq)
+{
+    // Try recycling a job from the free list first.
+    uint64_t head = atomic_load_explicit(&jq->free_list_head, memory_order_acquire);
+    while ((uint32_t)head != JOB_QUEUE_FREE_LIST_END)
+    {
+        job_t* job = _get_job_by_idx(jq, (uint32_t)head);
+        uint32_t next = atomic_load_explicit(&job->next_free, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(
+                &jq->free_list_head,
+                &head,
+                _free_list_next(head, next),
+                memory_order_acquire,
+                memory_order_acquire))
+        {
+            return job;
+        }
+    }
+
+    // Otherwise take a new slot, allocating a new segment if required.
+    uint32_t idx = atomic_fetch_add_explicit(&jq->job_count, 1, memory_order_relaxed);
+    assert(idx < JOB_QUEUE_MAX_JOB_COUNT && "Job pool exhausted.");
+    _Atomic(job_t*)* segment = &jq->job_segments[idx >> JOB_QUEUE_SEGMENT_SHIFT];
+    if (!atomic_load_explicit(segment, memory_order_acquire))
+    {
+        mutex_lock(&jq->segment_mutex);
+        if (!atomic_load_explicit(segment, memory_order_relaxed))
+        {
+            job_t* jobs = arena_alloc_with_lock(
+                &jq->arena,
+                sizeof(job_t),
+                _Alignof(job_t),
+                JOB_QUEUE_SEGMENT_SIZE,
+                ARENA_ZERO_MEMORY);
+            atomic_store_explicit(segment, jobs, memory_order_release);
+        }
+        mutex_unlock(&jq->segment_mutex);
+    }
+    job_t* job = _get_job_by_idx(jq, idx);
+    job->idx = idx;
+    return job;
+}
+
+void _free_job(job_queue_t* jq, job_t* job)
+{
+    // Invalidate any outstanding handles.
+    atomic_fetch_add_explicit(&job->generation, 1, memory_order_release);
+
+    uint64_t head = atomic_load_explicit(&jq->free_list_head, memory_order_relaxed);
+    do
+    {
+        atomic_store_explicit(&job->next_free, (uint32_t)head, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(
+        &jq->free_list_head,
+        &head,
+        _free_list_next(head, job->idx),
+        memory_order_release,
+        memory_order_relaxed));
+}
+
 void _decrement_ref(job_queue_t* jq, job_t* job)
 {
     assert(job);
-    atomic_int_fast16_t count = atomic_fetch_sub_explicit(&job->ref_count, 1, memory_order_acq_rel);
+    int count = atomic_fetch_sub_explicit(&job->ref_count, 1, memory_order_acq_rel);
     assert(count > 0);
     if (count == 1)
     {
-        job = NULL;
+        _free_job(jq, job);
     }
 }
 
-void _wake(job_queue_t* jq, int count)
+void _wake_thread(job_queue_t* jq, thread_info_t* info)
 {
-    mutex_lock(&jq->wait_mutex);
-    mutex_unlock(&jq->wait_mutex);
-    if (count == 1)
+    atomic_store_explicit(&info->wake_time_ns, _time_now_ns(), memory_order_relaxed);
+    atomic_store(&info->sleep_state, THREAD_STATE_AWAKE);
+    futex_wake_one(&info->sleep_state);
+    atomic_fetch_add_explicit(&jq->stats.wake_count, 1, memory_order_relaxed);
+}
+
+void _wake_one(job_queue_t* jq)
+{
+    // Claim a single parked worker by removing it from the idle mask - only the claiming thread
+    // will wake it.
+    uint32_t mask = atomic_load(&jq->idle_mask);
+    while (mask)
+    {
+        uint32_t bit = mask & (~mask + 1);
+        if (atomic_compare_exchange_weak(&jq->idle_mask, &mask, mask & ~bit))
+        {
+            _wake_thread(jq, &jq->thread_states[_lowest_bit_idx(bit)]);
+            return;
+        }
+    }
+}
+
+void _record_wake_latency(job_queue_t* jq, thread_info_t* info)
+{
+    uint64_t wake_time = atomic_load_explicit(&info->wake_time_ns, memory_order_relaxed);
+    if (!wake_time)
     {
-        condition_signal(&jq->wait_cond);
+        return;
     }
-    else
+    uint64_t now = _time_now_ns();
+    uint64_t latency = now > wake_time ? now - wake_time : 0;
+    atomic_fetch_add_explicit(&jq->stats.total_wake_latency_ns, latency, memory_order_relaxed);
+    uint64_t curr_max = atomic_load_explicit(&jq->stats.max_wake_latency_ns, memory_order_relaxed);
+    while (latency > curr_max &&
+           !atomic_compare_exchange_weak_explicit(
+               &jq->stats.max_wake_latency_ns,
+               &curr_max,
+               latency,
+               memory_order_relaxed,
+               memory_order_relaxed))
+        ;
+    atomic_store_explicit(&info->wake_time_ns, 0, memory_order_relaxed);
+}
+
+void _wait_while_sleeping(job_queue_t* jq, thread_info_t* info)
+{
+    while (atomic_load(&info->sleep_state) == THREAD_STATE_SLEEPING)
     {
-        condition_brdcast(&jq->wait_cond);
+        atomic_fetch_add_explicit(&jq->stats.park_count, 1, memory_order_relaxed);
+        futex_wait(&info->sleep_state, THREAD_STATE_SLEEPING);
     }
+    _record_wake_latency(jq, info);
 }
 
-void _wake_all(job_queue_t* jq)
+void _park_worker(thread_info_t* info)
 {
-    mutex_lock(&jq->wait_mutex);
-    mutex_unlock(&jq->wait_mutex);
-    condition_brdcast(&jq->wait_cond);
+    job_queue_t* jq = info->job_queue;
+    uint32_t bit = 1u << info->idx;
+
+    atomic_store(&info->sleep_state, THREAD_STATE_SLEEPING);
+    atomic_fetch_or(&jq->idle_mask, bit);
+
+    // A job pushed before the idle bit was visible won't have woken this thread, so check again
+    // before parking. Sequentially consistent ordering with @sa _push guarantees that at least one
+    // side observes the other.
+    if (atomic_load(&jq->active_job_count) > 0 || atomic_load(&jq->exit_thread))
+    {
+        uint32_t prev_mask = atomic_fetch_and(&jq->idle_mask, ~bit);
+        if (prev_mask & bit)
+        {
+            atomic_store(&info->sleep_state, THREAD_STATE_AWAKE);
+            return;
+        }
+        // Otherwise another thread has already claimed this worker and will wake it.
+    }
+    _wait_while_sleeping(jq, info);
+
+    // A stale wake from a job waiter may leave the idle bit set.
+    atomic_fetch_and(&jq->idle_mask, ~bit);
 }
 
-void _wait(job_queue_t* jq) { condition_wait(&jq->wait_cond, &jq->wait_mutex); }
+bool _spin_for_work(thread_info_t* info)
+{
+    job_queue_t* jq = info->job_queue;
+    for (uint32_t i = 0; i < JOB_QUEUE_SPIN_COUNT + JOB_QUEUE_YIELD_COUNT; ++i)
+    {
+        if (_exit_requested(info))
+        {
+            return true;
+        }
+        if (_active_jobs(jq))
+        {
+            atomic_fetch_add_explicit(&jq->stats.spin_hit_count, 1, memory_order_relaxed);
+            return true;
+        }
+        if (i < JOB_QUEUE_SPIN_COUNT)
+        {
+            _cpu_relax();
+        }
+        else
+        {
+            _thread_yield();
+        }
+    }
+    return false;
+}
 
 job_t* _pop(job_queue_t* jq, thread_info_t* info)
 {
+    // The active job count is decremented before popping, so a concurrent push sees a negative
+    // count and knows a thread is about to take a job.
+    atomic_fetch_sub(&jq->active_job_count, 1);
     int idx = work_stealing_queue_pop(&info->work_queue);
     job_t* job = NULL;
     if (idx != INT32_MAX)
     {
         assert(idx > 0);
-        job = &jq->job_cache[idx - 1];
+        job = _get_job_by_idx(jq, idx - 1);
     }
 
     if (!job)
     {
-        atomic_fetch_sub_explicit(&jq->active_job_count, 1, memory_order_relaxed);
+        // Nothing to pop - restore the count and, if jobs are still pending elsewhere, make sure
+        // a worker is awake to take them.
+        if (atomic_fetch_add(&jq->active_job_count, 1) >= 0)
+        {
+            _wake_one(jq);
+        }
     }
     return job;
 }
@@ -158,29 +402,32 @@ void _push(job_queue_t* jq, thread_info_t* info, job_t* job)
     assert(job_idx >= 0);
     work_stealing_queue_push(&info->work_queue, job_idx);
 
-    atomic_int old_job_count =
-        atomic_fetch_add_explicit(&jq->active_job_count, 1, memory_order_relaxed);
-    // If another thread has taken this job (job count will be negative) then don't wake the thread
-    // as we no longer have any work.
+    atomic_int old_job_count = atomic_fetch_add(&jq->active_job_count, 1);
+    // If another thread is about to take this job (job count will be negative) then don't wake a
+    // thread as we no longer have any work.
     if (old_job_count >= 0)
     {
-        _wake(jq, old_job_count + 1);
+        _wake_one(jq);
     }
 }
 
 job_t* _steal_from_queue(job_queue_t* jq, work_stealing_queue_t* queue)
 {
+    atomic_fetch_sub(&jq->active_job_count, 1);
     int idx = work_stealing_queue_steal(queue);
     job_t* job = NULL;
     if (idx != INT32_MAX)
     {
         assert(idx > 0);
-        job = &jq->job_cache[idx - 1];
+        job = _get_job_by_idx(jq, idx - 1);
     }
 
     if (!job)
     {
-        atomic_fetch_sub_explicit(&jq->active_job_count, 1, memory_order_relaxed);
+        if (atomic_fetch_add(&jq->active_job_count, 1) >= 0)
+        {
+            _wake_one(jq);
+        }
     }
     return job;
 }
@@ -188,14 +435,13 @@ job_t* _steal_from_queue(job_queue_t* jq, work_stealing_queue_t* queue)
 job_t* _steal_from_state(job_queue_t* jq, thread_info_t* info)
 {
     job_t* job = NULL;
-    if (jq->thread_count > 1)
+    int adopted_count = atomic_load_explicit(&jq->adopted_thread_count, memory_order_acquire);
+    uint32_t thread_count = jq->thread_count + adopted_count;
+    if (thread_count > 1)
     {
         do
         {
             thread_info_t* steal_info = NULL;
-            int adopted_count =
-                atomic_load_explicit(&jq->adopted_thread_count, memory_order_relaxed);
-            uint32_t thread_count = jq->thread_count + adopted_count;
             // Randomly get another thread to steal from.
             do
             {
@@ -214,36 +460,59 @@ job_t* _steal_from_state(job_queue_t* jq, thread_info_t* info)
     return job;
 }
 
+void _release_dependency(job_queue_t* jq, thread_info_t* info, job_t* job)
+{
+    // Whichever thread releases the last dependency schedules the job.
+    int count = atomic_fetch_sub(&job->dependency_count, 1);
+    assert(count > 0);
+    if (count == 1)
+    {
+        _push(jq, info, job);
+    }
+}
+
+void _schedule_continuations(thread_info_t* info, job_t* job)
+{
+    int count = atomic_load_explicit(&job->continuation_count, memory_order_relaxed);
+    for (int i = 0; i < count; ++i)
+    {
+        job_t* dependent = _get_job_by_idx(info->job_queue, job->continuations[i]);
+        _release_dependency(info->job_queue, info, dependent);
+    }
+}
+
 void _thread_finish(thread_info_t* info, job_t* job)
 {
-    bool wake_threads = false;
     do
     {
-        // We need to see the child run count from other threads, hence the acquire barrier. We
-        // also want to publish the new count to other threads, so we also use a release
-        // barrier.
-        atomic_int_fast16_t count =
-            atomic_fetch_sub_explicit(&job->child_run_count, 1, memory_order_acq_rel) &
-            JOB_QUEUE_JOB_COUNT_MASK;
+        // We need to see the child run count from other threads and publish the new count. This
+        // is sequentially consistent so it is ordered with the waiter check below.
+        int count = atomic_fetch_sub(&job->child_run_count, 1);
         assert(count > 0);
         if (count == 1)
         {
-            job_t* parent_job =
-                job->parent == UINT16_MAX ? NULL : &info->job_queue->job_cache[job->parent];
+            // Only the thread waiting on this specific job needs to be woken.
+            thread_info_t* waiter = atomic_load(&job->waiter);
+            if (waiter)
+            {
+                _wake_thread(info->job_queue, waiter);
+            }
+            _schedule_continuations(info, job);
+            job_t* parent_job = NULL;
+            if (job->parent != JOB_QUEUE_NULL_HANDLE)
+            {
+                // The parent can't complete before its children, so the handle must be valid.
+                parent_job = job_queue_get_job(info->job_queue, job->parent);
+                assert(parent_job && "Parent job released before its children completed.");
+            }
             _decrement_ref(info->job_queue, job);
             job = parent_job;
-            wake_threads = true;
         }
         else
         {
             break;
         }
     } while (job);
-
-    if (wake_threads)
-    {
-        _wake_all(info->job_queue);
-    }
 }
 
 bool _thread_execute(thread_info_t* info)
@@ -271,23 +540,15 @@ void* _thread_loop(void* arg)
     _set_thread_name("RPE_JOB_QUEUE_THREAD_LOOP");
 
     thread_info_t* info = (thread_info_t*)arg;
-    uint32_t id = _get_thread_id();
-    mutex_lock(&info->job_queue->thread_map_mutex);
-    HASH_SET_INSERT(&info->job_queue->thread_map, &id, &info); // NOLINT
-    mutex_unlock(&info->job_queue->thread_map_mutex);
+    _bind_thread_info(info->job_queue, info);
 
     do
     {
-        if (!_thread_execute(info))
+        // If there is no work, spin for a short while before parking until either a new job is
+        // pushed or an exit from the thread is requested.
+        if (!_thread_execute(info) && !_spin_for_work(info))
         {
-            mutex_lock(&info->job_queue->wait_mutex);
-            // Keep waiting until either an exit from the thread is requested or a new job is
-            // pushed.
-            while (!_exit_requested(info) && !_active_jobs(info->job_queue))
-            {
-                _wait(info->job_queue);
-            }
-            mutex_unlock(&info->job_queue->wait_mutex);
+            _park_worker(info);
         }
     } while (!_exit_requested(info));
 
@@ -304,8 +565,8 @@ job_queue_t* job_queue_init(arena_t* arena, uint32_t num_threads)
     jq->active_job_count = 0;
     jq->adopted_thread_count = 0;
     jq->exit_thread = false;
-    jq->thread_map = HASH_SET_CREATE(uint32_t, thread_info_t*, arena);
-    jq->arena = arena;
+    int res = arena_new(JOB_QUEUE_ARENA_SIZE, &jq->arena);
+    assert(res == ARENA_SUCCESS);
 
     if (!num_threads)
     {
@@ -313,19 +574,26 @@ job_queue_t* job_queue_init(arena_t* arena, uint32_t num_threads)
     }
     jq->thread_count = MAX(1, fmin(JOB_QUEUE_MAX_THREAD_COUNT, jq->thread_count));
 
-    mutex_init(&jq->thread_map_mutex);
-    mutex_init(&jq->wait_mutex);
-    condition_init(&jq->wait_cond);
-
-    jq->job_cache = ARENA_MAKE_ZERO_ARRAY(arena, job_t, JOB_QUEUE_MAX_JOB_COUNT);
+    jq->free_list_head = JOB_QUEUE_FREE_LIST_END;
+    mutex_init(&jq->segment_mutex);
+    thread_arena_pool_init(
+        &jq->thread_arena_pool, arena, JOB_QUEUE_THREAD_ARENA_POOL_SIZE, ARENA_THREAD_CHUNK_SIZE);
 
     for (uint32_t i = 0; i < jq->thread_count; ++i)
     {
         thread_info_t* info = &jq->thread_states[i];
         info->job_queue = jq;
         info->is_joinable = true;
-        info->work_queue = work_stealing_queue_init(arena, JOB_QUEUE_MAX_JOB_COUNT);
+        info->idx = i;
+        info->work_queue = work_stealing_queue_init(&jq->arena, JOB_QUEUE_INIT_WORK_QUEUE_SIZE);
         info->rand_gen = xoro_rand_init(_get_thread_id(), 0x1234);
+        thread_arena_init(&info->thread_arena, &jq->thread_arena_pool);
+    }
+    // All thread states must be initialised before starting the threads, as any thread may try
+    // to steal from another's queue.
+    for (uint32_t i = 0; i < jq->thread_count; ++i)
+    {
+        thread_info_t* info = &jq->thread_states[i];
         info->thread = thread_create(&_thread_loop, info, arena);
     }
     return jq;
@@ -335,26 +603,69 @@ job_t* job_queue_create_job(job_queue_t* jq, job_func_t func, void* args, job_t*
 {
     assert(jq);
 
-    size_t job_idx = atomic_fetch_add_explicit(&jq->job_count, 1, memory_order_relaxed) &
-        JOB_QUEUE_JOB_COUNT_MASK;
-
-    job_t* job = &jq->job_cache[job_idx];
+    job_t* job = _alloc_job(jq);
     job->func = func;
     job->args = args;
     job->ref_count = 1;
     job->child_run_count = 1;
-    job->idx = job_idx;
-    job->parent = UINT16_MAX;
+    job->parent = JOB_QUEUE_NULL_HANDLE;
+    job->waiter = NULL;
+    job->dependency_count = 1;
+    job->continuation_count = 0;
     if (parent)
     {
-        atomic_uint_fast16_t count =
-            atomic_fetch_add_explicit(&parent->child_run_count, 1, memory_order_relaxed);
-        assert((count & JOB_QUEUE_JOB_COUNT_MASK) > 0);
-        job->parent = parent->idx;
+        int count = atomic_fetch_add_explicit(&parent->child_run_count, 1, memory_order_relaxed);
+        assert(count > 0);
+        job->parent = job_queue_get_handle(parent);
     }
     return job;
 }
 
+job_handle_t job_queue_get_handle(job_t* job)
+{
+    assert(job);
+    uint32_t gen = atomic_load_explicit(&job->generation, memory_order_acquire);
+    return ((uint64_t)gen << 32) | job->idx;
+}
+
+job_t* job_queue_get_job(job_queue_t* jq, job_handle_t handle)
+{
+    assert(jq);
+    if (handle == JOB_QUEUE_NULL_HANDLE)
+    {
+        return NULL;
+    }
+    uint32_t idx = (uint32_t)handle;
+    if (idx >= atomic_load_explicit(&jq->job_count, memory_order_relaxed))
+    {
+        return NULL;
+    }
+    job_t* job = _get_job_by_idx(jq, idx);
+    uint32_t gen = atomic_load_explicit(&job->generation, memory_order_acquire);
+    return gen == (uint32_t)(handle >> 32) ? job : NULL;
+}
+
+void job_queue_add_dependency(job_queue_t* jq, job_t* job, job_t* dependent)
+{
+    assert(jq);
+    assert(job);
+    assert(dependent);
+    assert(job != dependent);
+
+    int idx = atomic_fetch_add_explicit(&job->continuation_count, 1, memory_order_relaxed);
+    assert(idx < JOB_QUEUE_MAX_CONTINUATION_COUNT && "Too many jobs depend on this job.");
+    job->continuations[idx] = dependent->idx;
+    atomic_fetch_add_explicit(&dependent->dependency_count, 1, memory_order_relaxed);
+}
+
+job_t* job_queue_create_continuation(
+    job_queue_t* jq, job_t* job, job_func_t func, void* args, job_t* parent)
+{
+    job_t* continuation = job_queue_create_job(jq, func, args, parent);
+    job_queue_add_dependency(jq, job, continuation);
+    return continuation;
+}
+
 job_t* job_queue_create_parent_job(job_queue_t* jq)
 {
     assert(jq);
@@ -364,9 +675,13 @@ job_t* job_queue_create_parent_job(job_queue_t* jq)
 void job_queue_destroy(job_queue_t* jq)
 {
     atomic_store(&jq->exit_thread, true);
-    mutex_lock(&jq->wait_mutex);
-    condition_brdcast(&jq->wait_cond);
-    mutex_unlock(&jq->wait_mutex);
+    atomic_store(&jq->idle_mask, 0);
+    for (uint32_t i = 0; i < jq->thread_count; ++i)
+    {
+        thread_info_t* info = &jq->thread_states[i];
+        atomic_store(&info->sleep_state, THREAD_STATE_AWAKE);
+        futex_wake_all(&info->sleep_state);
+    }
 
     for (uint32_t i = 0; i < jq->thread_count; ++i)
     {
@@ -376,23 +691,21 @@ void job_queue_destroy(job_queue_t* jq)
             thread_join(info->thread);
         }
     }
+    mutex_destroy(&jq->segment_mutex);
+    arena_release(&jq->arena);
 
-    mutex_destroy(&jq->wait_mutex);
-    condition_destroy(&jq->wait_cond);
-    mutex_destroy(&jq->thread_map_mutex);
+    if (tls_job_queue == jq)
+    {
+        _bind_thread_info(NULL, NULL);
+    }
 }
 
 void job_queue_run_job(job_queue_t* jq, job_t* job)
 {
     assert(job);
-
-    mutex_lock(&jq->thread_map_mutex);
-    uint32_t id = _get_thread_id();
-    thread_info_t** info = HASH_SET_GET(&jq->thread_map, &id);
-    assert(*info && "Trying to run on a thread that hasn't been adopted?");
-    mutex_unlock(&jq->thread_map_mutex);
-
-    _push(jq, *info, job);
+    // Release the implicit dependency held until the job is run - the job is only pushed if there
+    // are no other outstanding dependencies.
+    _release_dependency(jq, _get_thread_info(jq), job);
 }
 
 void job_queue_run_ref_job(job_queue_t* jq, job_t* job)
@@ -414,56 +727,82 @@ void job_queue_wait_and_release(job_queue_t* jq, job_t* job)
     assert(job);
     assert(atomic_load_explicit(&job->ref_count, memory_order_relaxed) > 0);
 
-    uint32_t id = _get_thread_id();
-    mutex_lock(&jq->thread_map_mutex);
-    thread_info_t** info = HASH_SET_GET(&jq->thread_map, &id);
-    mutex_unlock(&jq->thread_map_mutex);
-    assert(*info);
+    thread_info_t* info = _get_thread_info(jq);
 
     do
     {
-        if (!_thread_execute(*info))
+        if (!_thread_execute(info))
         {
             if (_job_completed(job))
             {
                 break;
             }
-            mutex_lock(&jq->wait_mutex);
-            if (!_job_completed(job) && !_exit_requested(*info) && !_active_jobs(jq))
+            // Park until this job completes - new jobs are left to the worker threads.
+            atomic_store(&info->sleep_state, THREAD_STATE_SLEEPING);
+            atomic_store(&job->waiter, info);
+            if (!_job_completed(job) && !_exit_requested(info))
             {
-                _wait(jq);
+                _wait_while_sleeping(jq, info);
             }
-            mutex_unlock(&jq->wait_mutex);
+            atomic_store(&job->waiter, NULL);
+            atomic_store(&info->sleep_state, THREAD_STATE_AWAKE);
         }
-    } while (!_job_completed(job) && !_exit_requested(*info));
+    } while (!_job_completed(job) && !_exit_requested(info));
 
     _decrement_ref(jq, job);
 }
 
 void job_queue_adopt_thread(job_queue_t* jq)
 {
-    uint32_t id = _get_thread_id();
-    mutex_lock(&jq->thread_map_mutex);
-    thread_info_t** info = HASH_SET_GET(&jq->thread_map, &id);
-    mutex_unlock(&jq->thread_map_mutex);
-
-    if (info && (*info)->job_queue == jq)
+    if (tls_job_queue == jq)
     {
         log_warn("This thread has already been adopted by this job queue.");
         return;
     }
 
-    atomic_int adopted_count =
-        atomic_fetch_add_explicit(&jq->adopted_thread_count, 1, memory_order_relaxed);
+    // The adopted thread count is only incremented once the state is initialised, as workers
+    // will then start stealing from the new queue.
+    int adopted_count = atomic_load_explicit(&jq->adopted_thread_count, memory_order_relaxed);
     assert(adopted_count + jq->thread_count < JOB_QUEUE_MAX_THREAD_COUNT);
 
     thread_info_t* adopted_info = &jq->thread_states[adopted_count + jq->thread_count];
     adopted_info->job_queue = jq;
     adopted_info->is_joinable = false;
-    adopted_info->work_queue = work_stealing_queue_init(jq->arena, JOB_QUEUE_MAX_JOB_COUNT);
+    adopted_info->idx = adopted_count + jq->thread_count;
+    adopted_info->sleep_state = THREAD_STATE_AWAKE;
+    adopted_info->work_queue =
+        work_stealing_queue_init(&jq->arena, JOB_QUEUE_INIT_WORK_QUEUE_SIZE);
     adopted_info->rand_gen = xoro_rand_init(_get_thread_id(), 0x1234);
+    thread_arena_init(&adopted_info->thread_arena, &jq->thread_arena_pool);
+    _bind_thread_info(jq, adopted_info);
+    atomic_fetch_add_explicit(&jq->adopted_thread_count, 1, memory_order_release);
+}
+
+void job_queue_reset_stats(job_queue_t* jq)
+{
+    assert(jq);
+    atomic_store_explicit(&jq->stats.park_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&jq->stats.wake_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&jq->stats.spin_hit_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&jq->stats.total_wake_latency_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&jq->stats.max_wake_latency_ns, 0, memory_order_relaxed);
+}
 
-    mutex_lock(&jq->thread_map_mutex);
-    HASH_SET_INSERT(&jq->thread_map, &id, &adopted_info); // NOLINT
-    mutex_unlock(&jq->thread_map_mutex);
+thread_arena_t* job_queue_get_thread_arena(job_queue_t* jq)
+{
+    assert(jq);
+    return &_get_thread_info(jq)->thread_arena;
+}
+
+uint32_t job_queue_get_thread_index(job_queue_t* jq)
+{
+    assert(jq);
+    return _get_thread_info(jq)->idx;
+}
+
+void job_queue_reset_thread_arenas(job_queue_t* jq)
+{
+    assert(jq);
+    // Each thread arena discards its current chunk on the next allocation.
+    thread_arena_pool_reset(&jq->thread_arena_pool);
 }
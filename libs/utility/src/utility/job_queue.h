@@ -24,8 +24,8 @@
 #define __UTILITY_JOB_QUEUE_H__
 
 #define _GNU_SOURCE
+#include "arena.h"
 #include "compiler.h"
-#include "hash_set.h"
 #include "random.h"
 #include "thread.h"
 #include "work_stealing_queue.h"
@@ -34,16 +34,47 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#define JOB_QUEUE_MAX_JOB_COUNT 4096
-#define JOB_QUEUE_JOB_COUNT_MASK (JOB_QUEUE_MAX_JOB_COUNT - 1)
+// Jobs are allocated in segments which are never moved, so job pointers remain valid.
+#define JOB_QUEUE_SEGMENT_SHIFT 12
+#define JOB_QUEUE_SEGMENT_SIZE (1 << JOB_QUEUE_SEGMENT_SHIFT)
+#define JOB_QUEUE_SEGMENT_MASK (JOB_QUEUE_SEGMENT_SIZE - 1)
+#define JOB_QUEUE_MAX_SEGMENT_COUNT 4096
+#define JOB_QUEUE_MAX_JOB_COUNT (JOB_QUEUE_SEGMENT_SIZE * JOB_QUEUE_MAX_SEGMENT_COUNT)
+// The initial capacity of each thread's work queue - these grow as required.
+#define JOB_QUEUE_INIT_WORK_QUEUE_SIZE 4096
+#define JOB_QUEUE_NULL_HANDLE UINT64_MAX
+// The maximum number of jobs which can depend on a single job. Wider fan-outs can be built by
+// adding a dependency on an empty job which the dependent jobs then depend on.
+#define JOB_QUEUE_MAX_CONTINUATION_COUNT 8
 #define JOB_QUEUE_MAX_THREAD_COUNT 32
+// The size of the pool which the thread arenas of the queue allocate from.
+#define JOB_QUEUE_THREAD_ARENA_POOL_SIZE (1 << 22)
+// The size of the arena owned by the queue, for the job segments and work queue buffers.
+#define JOB_QUEUE_ARENA_SIZE (1 << 28)
 #define JOB_QUEUE_CACHELINE_SIZE 64
+// The number of times an idle worker checks for new jobs before yielding, and then parking.
+#define JOB_QUEUE_SPIN_COUNT 64
+#define JOB_QUEUE_YIELD_COUNT 8
 
 // Forward declarations.
 typedef struct JobQueue job_queue_t;
+typedef struct ThreadInfo thread_info_t;
+
+enum ThreadSleepState
+{
+    THREAD_STATE_AWAKE,
+    THREAD_STATE_SLEEPING
+};
 
 typedef void (*job_func_t)(void*);
 
+/**
+ A handle to a job. The lower 32-bits are the index of the job in the pool, the upper 32-bits the
+ generation of the job slot when the handle was created. A handle becomes stale once the job has
+ been released back to the pool.
+ */
+typedef uint64_t job_handle_t;
+
 /**
  Information on each job created.
  */
@@ -54,19 +85,34 @@ typedef struct RPE_ALIGNAS(JOB_QUEUE_CACHELINE_SIZE) Job
     /// Arguments to pass to the function.
     void* args;
     /// The number of references to this job.
-    atomic_int_fast16_t ref_count;
+    atomic_int ref_count;
     /// The number of jobs running for this particular job.
-    atomic_int_fast16_t child_run_count;
-    /// A index into the job cache which points to the parent of this job. Used for linking jobs to
-    /// each other, so multiple jobs can be executed via one job.
-    atomic_uint_fast16_t parent;
+    atomic_int child_run_count;
+    /// A handle to the parent of this job. Used for linking jobs to each other, so multiple jobs
+    /// can be executed via one job.
+    job_handle_t parent;
+    /// The index of this job in the pool.
     uint32_t idx;
+    /// Incremented each time the job is released back to the pool.
+    atomic_uint generation;
+    /// The index of the next job in the free list - only valid when this job is free.
+    atomic_uint next_free;
+    /// The thread waiting on this job to complete, if any.
+    _Atomic(thread_info_t*) waiter;
+    /// The number of jobs which must complete before this job is scheduled, plus one until the
+    /// job has been run by the user.
+    atomic_int dependency_count;
+    /// The number of jobs which depend on this job.
+    atomic_int continuation_count;
+    /// Indices of the jobs which depend on this job. These are scheduled once this job (and its
+    /// children) has completed.
+    uint32_t continuations[JOB_QUEUE_MAX_CONTINUATION_COUNT];
 } job_t;
 
 /**
  Per thread state.
  */
-typedef struct RPE_ALIGNAS(JOB_QUEUE_CACHELINE_SIZE) ThreadInfo
+struct RPE_ALIGNAS(JOB_QUEUE_CACHELINE_SIZE) ThreadInfo
 {
     /// The work stealing queue for this thread.
     work_stealing_queue_t work_queue;
@@ -78,40 +124,71 @@ typedef struct RPE_ALIGNAS(JOB_QUEUE_CACHELINE_SIZE) ThreadInfo
     job_queue_t* job_queue;
     /// Random number generator used for generating random thread ids when stealing.
     xoro_rand_t rand_gen;
-} thread_info_t;
+    /// The index of this thread in the thread state array.
+    uint32_t idx;
+    /// The futex word which a parked thread waits on - one of @sa ThreadSleepState.
+    atomic_uint sleep_state;
+    /// The time at which this thread was last signalled to wake - used for latency stats.
+    atomic_uint_fast64_t wake_time_ns;
+    /// Scratch memory for jobs running on this thread - see @sa job_queue_get_thread_arena.
+    thread_arena_t thread_arena;
+};
+
+/**
+ Statistics on worker parking. All counters are cumulative since initialisation or the last call
+ to @sa job_queue_reset_stats.
+ */
+typedef struct JobQueueStats
+{
+    /// The number of times a thread has parked - each is a voluntary context switch.
+    atomic_uint_fast64_t park_count;
+    /// The number of times a parked thread has been signalled to wake.
+    atomic_uint_fast64_t wake_count;
+    /// The number of times an idle worker found work while spinning, avoiding a park.
+    atomic_uint_fast64_t spin_hit_count;
+    /// The total time, in nanoseconds, between a thread being signalled and resuming.
+    atomic_uint_fast64_t total_wake_latency_ns;
+    /// The longest time, in nanoseconds, between a thread being signalled and resuming.
+    atomic_uint_fast64_t max_wake_latency_ns;
+} job_queue_stats_t;
 
 typedef struct JobQueue
 {
-    /// An array of jobs which are assigned when creating a job.
-    job_t* job_cache;
-    /// The number of jobs currently allocated. Used job indices are found in the `free_job_list`
-    atomic_int job_count;
+    /// Segments of jobs which are assigned when creating a job. Segments are allocated on demand.
+    _Atomic(job_t*) job_segments[JOB_QUEUE_MAX_SEGMENT_COUNT];
+    /// The number of job slots which have been taken from the segments.
+    atomic_uint job_count;
+    /// The head of the free job list - the lower 32-bits are the job index, the upper 32-bits a
+    /// tag which is incremented on each update to prevent ABA issues.
+    atomic_uint_fast64_t free_list_head;
+    /// Guards the allocation of new segments.
+    mutex_t segment_mutex;
     /// Main thread state cache array.
     thread_info_t thread_states[JOB_QUEUE_MAX_THREAD_COUNT];
     /// The number of threads this job queue is running. Doesn't include adopted threads.
     uint32_t thread_count;
-    /// Condition for waiting on for jobs to finish or the threads exiting on destruction.
-    cond_wait_t wait_cond;
+    /// A bit mask of worker threads which are parked and waiting for a job to be pushed.
+    atomic_uint idle_mask;
     /// The number of active jobs.
     atomic_int active_job_count;
     /// State used to determine if the threads should be terminated.
     atomic_bool exit_thread;
     /// The number of adopted threads.
     atomic_int adopted_thread_count;
-    /// A map of thread ids and their index in the thread state buffer.
-    hash_set_t thread_map;
-    /// A mutex used for accessing the thread map.
-    mutex_t thread_map_mutex;
-    /// A mutex used for the wait condition.
-    mutex_t wait_mutex;
-    /// The arena used for allocations for this job queue.
-    arena_t* arena;
+    /// Parking statistics.
+    job_queue_stats_t stats;
+    /// The pool which each thread's arena allocates from.
+    thread_arena_pool_t thread_arena_pool;
+    /// The job segments and work queue buffers are allocated from any thread, so they have an arena
+    /// of their own - all allocations from it take the lock.
+    arena_t arena;
 } job_queue_t;
 
 /**
  Initialise a new job queue instance. This will create the stated number of threads, which will be
  ready to accept jobs.
- @param arena The arena to use for allocations.
+ @param arena The arena which the queue and its threads are allocated from. Only used during
+ initialisation - the queue allocates jobs from an arena of its own.
  @param num_threads The number of thread pools to initialise. If zero, the number of threads will be
  the maximum that can be created on the running system.
  @return A pointer to a new job queue instance.
@@ -119,16 +196,56 @@ typedef struct JobQueue
 job_queue_t* job_queue_init(arena_t* arena, uint32_t num_threads);
 
 /**
- Creates a new job instance.
+ Creates a new job instance. The job is released back to the pool once it has completed and all
+ references have been dropped, after which the pointer must not be used.
  @param jq A pointer to the job queue.
  @param func A function pointer to execute for this job.
  @param args A void pointer which contains the argument to pass to the function.
  @param parent A pointer to a job which will be a parent to this one. This can be used to link jobs
  and runAndWait can be called on one job.
- @return
+ @return A pointer to the new job.
  */
 job_t* job_queue_create_job(job_queue_t* jq, job_func_t func, void* args, job_t* parent);
 
+/**
+ @return A generation checked handle to the job.
+ */
+job_handle_t job_queue_get_handle(job_t* job);
+
+/**
+ Get the job referenced by a handle.
+ @param jq A pointer to the job queue.
+ @param handle A handle obtained from @sa job_queue_get_handle.
+ @return A pointer to the job, or NULL if the job has since been released back to the pool.
+ */
+job_t* job_queue_get_job(job_queue_t* jq, job_handle_t handle);
+
+/**
+ Add a dependency between two jobs - @sa dependent will not be scheduled until @sa job, and all of
+ its children, have completed. A job with dependencies is still run via @sa job_queue_run_job, but
+ is deferred until the last of its dependencies completes. Jobs can form any acyclic graph, and
+ by using a common parent, the whole graph can be waited on once.
+ Note: Must be called before either job is run.
+ @param jq A pointer to the job queue.
+ @param job The job which must complete first.
+ @param dependent The job to schedule once @sa job has completed.
+ */
+void job_queue_add_dependency(job_queue_t* jq, job_t* job, job_t* dependent);
+
+/**
+ Create a job which is scheduled once @sa job has completed. This is a convenience function for
+ creating a job and then calling @sa job_queue_add_dependency. The continuation still needs to be
+ run via @sa job_queue_run_job.
+ @param jq A pointer to the job queue.
+ @param job The job which must complete before the continuation is scheduled.
+ @param func A function pointer to execute for the continuation.
+ @param args A void pointer which contains the argument to pass to the function.
+ @param parent An optional parent for the continuation.
+ @return A pointer to the new job.
+ */
+job_t* job_queue_create_continuation(
+    job_queue_t* jq, job_t* job, job_func_t func, void* args, job_t* parent);
+
 /**
   Create a parent job.
   Note: Don't use the same parent job for subsequent runs. Instead create a new parent each time.
@@ -142,7 +259,8 @@ job_t* job_queue_create_parent_job(job_queue_t* jq);
 void job_queue_destroy(job_queue_t* jq);
 
 /**
- Run a specified job on the job queue.
+ Run a specified job on the job queue. If the job has outstanding dependencies, it will be
+ scheduled once these have completed.
  @param jq A pointer to the job queue.
  @param job The job to run.
  */
@@ -166,9 +284,38 @@ void job_queue_wait_and_release(job_queue_t* jq, job_t* job);
 
 /**
  Add a thread to the job queue. Must be a thread which isn't already owned by the queue - usually
- used to adopt the main thread.
+ used to adopt the main thread. A thread can only be bound to one job queue at a time - adopting
+ a thread replaces any previous binding.
  @param jq A pointer to the job queue.
  */
 void job_queue_adopt_thread(job_queue_t* jq);
 
+/**
+ Get the arena of the calling thread. This allows jobs to allocate scratch memory without locking.
+ Allocations remain valid until @sa job_queue_reset_thread_arenas is called.
+ @param jq A pointer to the job queue. The calling thread must be a queue thread, or adopted.
+ @return A pointer to the thread arena of the calling thread.
+ */
+thread_arena_t* job_queue_get_thread_arena(job_queue_t* jq);
+
+/**
+ Get the index of the calling thread, allowing jobs to use per-thread state without locking.
+ @param jq A pointer to the job queue. The calling thread must be a queue thread, or adopted.
+ @return The index of the calling thread - less than JOB_QUEUE_MAX_THREAD_COUNT.
+ */
+uint32_t job_queue_get_thread_index(job_queue_t* jq);
+
+/**
+ Rewind the arenas of all threads. Must only be called when no jobs are allocating from the thread
+ arenas - usually once per frame.
+ @param jq A pointer to the job queue.
+ */
+void job_queue_reset_thread_arenas(job_queue_t* jq);
+
+/**
+ Reset all counters in the job queue stats.
+ @param jq A pointer to the job queue.
+ */
+void job_queue_reset_stats(job_queue_t* jq);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,368 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "offset_allocator.h"
+
+#include "compiler.h"
+
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static RPE_FORCE_INLINE uint32_t _ctz32(uint32_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static RPE_FORCE_INLINE uint32_t _highest_bit32(uint32_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse(&idx, v);
+    return (uint32_t)idx;
+#else
+    return 31 - (uint32_t)__builtin_clz(v);
+#endif
+}
+
+// The bin a free range is placed in is rounded down, so every range in a bin is at least the bin
+// size. Requests are rounded up, so any range in the bin found is large enough.
+uint32_t _offset_alloc_bin_round_down(uint32_t size)
+{
+    if (size < OFFSET_ALLOC_MANTISSA_VALUE)
+    {
+        return size;
+    }
+    uint32_t mantissa_start = _highest_bit32(size) - OFFSET_ALLOC_MANTISSA_BITS;
+    uint32_t mantissa = (size >> mantissa_start) & OFFSET_ALLOC_MANTISSA_MASK;
+    return ((mantissa_start + 1) << OFFSET_ALLOC_MANTISSA_BITS) + mantissa;
+}
+
+uint32_t _offset_alloc_bin_round_up(uint32_t size)
+{
+    if (size < OFFSET_ALLOC_MANTISSA_VALUE)
+    {
+        return size;
+    }
+    uint32_t mantissa_start = _highest_bit32(size) - OFFSET_ALLOC_MANTISSA_BITS;
+    uint32_t mantissa = (size >> mantissa_start) & OFFSET_ALLOC_MANTISSA_MASK;
+    uint32_t low_mask = (1u << mantissa_start) - 1;
+    // An overflowing mantissa carries into the exponent, which is the next bin up.
+    mantissa += (size & low_mask) ? 1 : 0;
+    return ((mantissa_start + 1) << OFFSET_ALLOC_MANTISSA_BITS) + mantissa;
+}
+
+offset_alloc_node_t* _offset_alloc_get_node(offset_allocator_t* a, uint32_t idx)
+{
+    return DYN_ARRAY_GET_PTR(offset_alloc_node_t, &a->nodes, idx);
+}
+
+uint32_t _offset_alloc_create_node(offset_allocator_t* a, uint32_t offset, uint32_t size)
+{
+    offset_alloc_node_t node = {
+        .offset = offset,
+        .size = size,
+        .bin_prev = OFFSET_ALLOC_INVALID,
+        .bin_next = OFFSET_ALLOC_INVALID,
+        .neighbour_prev = OFFSET_ALLOC_INVALID,
+        .neighbour_next = OFFSET_ALLOC_INVALID,
+        .is_used = false};
+    if (a->free_nodes.size > 0)
+    {
+        uint32_t idx = DYN_ARRAY_POP_BACK(uint32_t, &a->free_nodes);
+        DYN_ARRAY_SET(&a->nodes, idx, &node);
+        return idx;
+    }
+    uint32_t idx = a->nodes.size;
+    DYN_ARRAY_APPEND(&a->nodes, &node);
+    return idx;
+}
+
+void _offset_alloc_release_node(offset_allocator_t* a, uint32_t idx)
+{
+    DYN_ARRAY_APPEND(&a->free_nodes, &idx);
+}
+
+void _offset_alloc_insert_free(offset_allocator_t* a, uint32_t idx)
+{
+    offset_alloc_node_t* node = _offset_alloc_get_node(a, idx);
+    uint32_t bin = _offset_alloc_bin_round_down(node->size);
+    uint32_t head = a->bin_heads[bin];
+    if (head == OFFSET_ALLOC_INVALID)
+    {
+        uint32_t top = bin >> OFFSET_ALLOC_MANTISSA_BITS;
+        a->used_leaf_bins[top] |= 1u << (bin & OFFSET_ALLOC_MANTISSA_MASK);
+        a->used_top_bins |= 1u << top;
+    }
+    else
+    {
+        _offset_alloc_get_node(a, head)->bin_prev = idx;
+    }
+    node->bin_prev = OFFSET_ALLOC_INVALID;
+    node->bin_next = head;
+    a->bin_heads[bin] = idx;
+    a->free_space += node->size;
+}
+
+void _offset_alloc_remove_free(offset_allocator_t* a, uint32_t idx)
+{
+    offset_alloc_node_t* node = _offset_alloc_get_node(a, idx);
+    if (node->bin_prev != OFFSET_ALLOC_INVALID)
+    {
+        _offset_alloc_get_node(a, node->bin_prev)->bin_next = node->bin_next;
+    }
+    else
+    {
+        // The head of the bin list - the bin may now be empty.
+        uint32_t bin = _offset_alloc_bin_round_down(node->size);
+        a->bin_heads[bin] = node->bin_next;
+        if (node->bin_next == OFFSET_ALLOC_INVALID)
+        {
+            uint32_t top = bin >> OFFSET_ALLOC_MANTISSA_BITS;
+            a->used_leaf_bins[top] &= ~(1u << (bin & OFFSET_ALLOC_MANTISSA_MASK));
+            if (!a->used_leaf_bins[top])
+            {
+                a->used_top_bins &= ~(1u << top);
+            }
+        }
+    }
+    if (node->bin_next != OFFSET_ALLOC_INVALID)
+    {
+        _offset_alloc_get_node(a, node->bin_next)->bin_prev = node->bin_prev;
+    }
+    a->free_space -= node->size;
+}
+
+void offset_alloc_init(offset_allocator_t* a, uint32_t capacity, arena_t* arena)
+{
+    assert(a);
+    memset(a, 0, sizeof(offset_allocator_t));
+    MAKE_DYN_ARRAY(offset_alloc_node_t, arena, 128, &a->nodes);
+    MAKE_DYN_ARRAY(uint32_t, arena, 128, &a->free_nodes);
+    a->capacity = capacity;
+    offset_alloc_reset(a);
+}
+
+void offset_alloc_reset(offset_allocator_t* a)
+{
+    assert(a);
+    uint32_t capacity = a->capacity;
+    dyn_array_clear(&a->nodes);
+    dyn_array_clear(&a->free_nodes);
+    memset(a->bin_heads, 0xff, sizeof(a->bin_heads));
+    memset(a->used_leaf_bins, 0, sizeof(a->used_leaf_bins));
+    a->used_top_bins = 0;
+    a->free_space = 0;
+    a->alloc_count = 0;
+    a->capacity = 0;
+    a->tail_node = OFFSET_ALLOC_INVALID;
+    if (capacity)
+    {
+        offset_alloc_grow(a, capacity);
+    }
+}
+
+offset_alloc_t offset_alloc_allocate(offset_allocator_t* a, uint32_t size)
+{
+    assert(a);
+    assert(size > 0);
+    offset_alloc_t out = {.offset = OFFSET_ALLOC_INVALID, .node = OFFSET_ALLOC_INVALID};
+    if (size > a->free_space)
+    {
+        return out;
+    }
+
+    // Search the leaf bins of the rounded up top bin first, then the smallest non-empty top bin
+    // above it - every range held there is larger than the request.
+    uint32_t min_bin = _offset_alloc_bin_round_up(size);
+    uint32_t top = min_bin >> OFFSET_ALLOC_MANTISSA_BITS;
+    uint32_t leaf = min_bin & OFFSET_ALLOC_MANTISSA_MASK;
+    uint32_t bin = OFFSET_ALLOC_INVALID;
+    uint32_t leaf_mask = a->used_leaf_bins[top] & (0xffu << leaf);
+    if (leaf_mask)
+    {
+        bin = (top << OFFSET_ALLOC_MANTISSA_BITS) + _ctz32(leaf_mask);
+    }
+    else
+    {
+        uint32_t top_mask = top + 1 < OFFSET_ALLOC_TOP_BIN_COUNT
+            ? a->used_top_bins & (UINT32_MAX << (top + 1))
+            : 0;
+        if (top_mask)
+        {
+            top = _ctz32(top_mask);
+            bin = (top << OFFSET_ALLOC_MANTISSA_BITS) + _ctz32(a->used_leaf_bins[top]);
+        }
+    }
+
+    uint32_t idx = bin != OFFSET_ALLOC_INVALID ? a->bin_heads[bin] : OFFSET_ALLOC_INVALID;
+    if (idx == OFFSET_ALLOC_INVALID)
+    {
+        // The bin the request rounds down to may still hold a range which fits - without this a
+        // request for the whole of a free range could fail.
+        idx = a->bin_heads[_offset_alloc_bin_round_down(size)];
+        while (idx != OFFSET_ALLOC_INVALID && _offset_alloc_get_node(a, idx)->size < size)
+        {
+            idx = _offset_alloc_get_node(a, idx)->bin_next;
+        }
+        if (idx == OFFSET_ALLOC_INVALID)
+        {
+            return out;
+        }
+    }
+    _offset_alloc_remove_free(a, idx);
+
+    offset_alloc_node_t* node = _offset_alloc_get_node(a, idx);
+    assert(node->size >= size);
+    node->is_used = true;
+    uint32_t remainder = node->size - size;
+    node->size = size;
+    out.offset = node->offset;
+    out.node = idx;
+
+    if (remainder)
+    {
+        // Split the unused end of the range into a new free node.
+        uint32_t next = node->neighbour_next;
+        uint32_t split = _offset_alloc_create_node(a, out.offset + size, remainder);
+        // The node array may have been reallocated.
+        node = _offset_alloc_get_node(a, idx);
+        offset_alloc_node_t* split_node = _offset_alloc_get_node(a, split);
+        split_node->neighbour_prev = idx;
+        split_node->neighbour_next = next;
+        node->neighbour_next = split;
+        if (next != OFFSET_ALLOC_INVALID)
+        {
+            _offset_alloc_get_node(a, next)->neighbour_prev = split;
+        }
+        if (a->tail_node == idx)
+        {
+            a->tail_node = split;
+        }
+        _offset_alloc_insert_free(a, split);
+    }
+    ++a->alloc_count;
+    return out;
+}
+
+void offset_alloc_free(offset_allocator_t* a, offset_alloc_t alloc)
+{
+    assert(a);
+    assert(alloc.node < a->nodes.size);
+    offset_alloc_node_t* node = _offset_alloc_get_node(a, alloc.node);
+    assert(node->is_used);
+    assert(node->offset == alloc.offset);
+    node->is_used = false;
+
+    uint32_t prev = node->neighbour_prev;
+    if (prev != OFFSET_ALLOC_INVALID && !_offset_alloc_get_node(a, prev)->is_used)
+    {
+        _offset_alloc_remove_free(a, prev);
+        offset_alloc_node_t* prev_node = _offset_alloc_get_node(a, prev);
+        node->offset = prev_node->offset;
+        node->size += prev_node->size;
+        node->neighbour_prev = prev_node->neighbour_prev;
+        if (node->neighbour_prev != OFFSET_ALLOC_INVALID)
+        {
+            _offset_alloc_get_node(a, node->neighbour_prev)->neighbour_next = alloc.node;
+        }
+        _offset_alloc_release_node(a, prev);
+    }
+
+    uint32_t next = node->neighbour_next;
+    if (next != OFFSET_ALLOC_INVALID && !_offset_alloc_get_node(a, next)->is_used)
+    {
+        _offset_alloc_remove_free(a, next);
+        offset_alloc_node_t* next_node = _offset_alloc_get_node(a, next);
+        node->size += next_node->size;
+        node->neighbour_next = next_node->neighbour_next;
+        if (node->neighbour_next != OFFSET_ALLOC_INVALID)
+        {
+            _offset_alloc_get_node(a, node->neighbour_next)->neighbour_prev = alloc.node;
+        }
+        if (a->tail_node == next)
+        {
+            a->tail_node = alloc.node;
+        }
+        _offset_alloc_release_node(a, next);
+    }
+
+    _offset_alloc_insert_free(a, alloc.node);
+    --a->alloc_count;
+}
+
+void offset_alloc_grow(offset_allocator_t* a, uint32_t new_capacity)
+{
+    assert(a);
+    assert(new_capacity > a->capacity);
+    uint32_t extra = new_capacity - a->capacity;
+
+    uint32_t tail = a->tail_node;
+    if (tail != OFFSET_ALLOC_INVALID && !_offset_alloc_get_node(a, tail)->is_used)
+    {
+        // Extend the free range at the end rather than adding a neighbouring free node.
+        _offset_alloc_remove_free(a, tail);
+        _offset_alloc_get_node(a, tail)->size += extra;
+        _offset_alloc_insert_free(a, tail);
+    }
+    else
+    {
+        uint32_t idx = _offset_alloc_create_node(a, a->capacity, extra);
+        if (tail != OFFSET_ALLOC_INVALID)
+        {
+            _offset_alloc_get_node(a, idx)->neighbour_prev = tail;
+            _offset_alloc_get_node(a, tail)->neighbour_next = idx;
+        }
+        a->tail_node = idx;
+        _offset_alloc_insert_free(a, idx);
+    }
+    a->capacity = new_capacity;
+}
+
+uint32_t offset_alloc_largest_free(offset_allocator_t* a)
+{
+    assert(a);
+    if (!a->used_top_bins)
+    {
+        return 0;
+    }
+    uint32_t top = _highest_bit32(a->used_top_bins);
+    uint32_t bin = (top << OFFSET_ALLOC_MANTISSA_BITS) + _highest_bit32(a->used_leaf_bins[top]);
+
+    // Ranges in a bin may be up to the size of the next bin, so check each of them.
+    uint32_t largest = 0;
+    for (uint32_t idx = a->bin_heads[bin]; idx != OFFSET_ALLOC_INVALID;)
+    {
+        offset_alloc_node_t* node = _offset_alloc_get_node(a, idx);
+        largest = node->size > largest ? node->size : largest;
+        idx = node->bin_next;
+    }
+    return largest;
+}
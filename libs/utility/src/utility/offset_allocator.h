@@ -0,0 +1,132 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __UTILITY_OFFSET_ALLOCATOR_H__
+#define __UTILITY_OFFSET_ALLOCATOR_H__
+
+#include "arena.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ A TLSF style allocator which hands out ranges from a linear space, such as a GPU buffer. Only
+ offsets are returned - the allocator never touches the memory it manages.
+
+ Free ranges are held in bins arranged as a small float - a 5-bit exponent and 3-bit mantissa -
+ so a bin which is guaranteed to fit a request is found with two bit scans. Freed ranges are merged
+ with their free neighbours straight away, so allocating and freeing is O(1).
+ */
+
+#define OFFSET_ALLOC_MANTISSA_BITS 3
+#define OFFSET_ALLOC_MANTISSA_VALUE (1 << OFFSET_ALLOC_MANTISSA_BITS)
+#define OFFSET_ALLOC_MANTISSA_MASK (OFFSET_ALLOC_MANTISSA_VALUE - 1)
+#define OFFSET_ALLOC_TOP_BIN_COUNT 32
+#define OFFSET_ALLOC_LEAF_BIN_COUNT OFFSET_ALLOC_MANTISSA_VALUE
+#define OFFSET_ALLOC_BIN_COUNT (OFFSET_ALLOC_TOP_BIN_COUNT * OFFSET_ALLOC_LEAF_BIN_COUNT)
+
+#define OFFSET_ALLOC_INVALID UINT32_MAX
+
+typedef struct OffsetAllocNode
+{
+    uint32_t offset;
+    uint32_t size;
+    /// Links to the other free nodes in the same bin.
+    uint32_t bin_prev;
+    uint32_t bin_next;
+    /// Links to the adjacent nodes in address order.
+    uint32_t neighbour_prev;
+    uint32_t neighbour_next;
+    bool is_used;
+} offset_alloc_node_t;
+
+typedef struct OffsetAllocation
+{
+    /// The start of the range, or OFFSET_ALLOC_INVALID if the allocation failed.
+    uint32_t offset;
+    /// The node which tracks this range - required when freeing.
+    uint32_t node;
+} offset_alloc_t;
+
+typedef struct OffsetAllocator
+{
+    uint32_t capacity;
+    uint32_t free_space;
+    uint32_t alloc_count;
+
+    /// A bit is set for each top level bin which has a non-empty leaf bin.
+    uint32_t used_top_bins;
+    uint8_t used_leaf_bins[OFFSET_ALLOC_TOP_BIN_COUNT];
+    /// The first free node in each bin.
+    uint32_t bin_heads[OFFSET_ALLOC_BIN_COUNT];
+
+    arena_dyn_array_t nodes;
+    /// Nodes which can be reused.
+    arena_dyn_array_t free_nodes;
+    /// The node at the end of the space in address order - extended when the allocator grows.
+    uint32_t tail_node;
+} offset_allocator_t;
+
+/**
+ Initialise an allocator which manages the range [0, capacity).
+ @param a A pointer to the allocator to initialise.
+ @param capacity The size of the space. May be zero, in which case all allocations fail until
+ the allocator is grown.
+ @param arena The arena used for the node storage.
+ */
+void offset_alloc_init(offset_allocator_t* a, uint32_t capacity, arena_t* arena);
+
+/**
+ Allocate a range from the space.
+ @param a A pointer to the allocator.
+ @param size The size of the range. Must be greater than zero.
+ @returns The allocation. The offset is OFFSET_ALLOC_INVALID if no free range is large enough.
+ */
+offset_alloc_t offset_alloc_allocate(offset_allocator_t* a, uint32_t size);
+
+/**
+ Return a range to the allocator. It is merged with any adjacent free ranges.
+ @param a A pointer to the allocator.
+ @param alloc An allocation returned by @sa offset_alloc_allocate.
+ */
+void offset_alloc_free(offset_allocator_t* a, offset_alloc_t alloc);
+
+/**
+ Extend the space to [0, new_capacity). Existing allocations are not moved.
+ @param a A pointer to the allocator.
+ @param new_capacity The new size of the space. Must be greater than the current capacity.
+ */
+void offset_alloc_grow(offset_allocator_t* a, uint32_t new_capacity);
+
+/**
+ The size of the largest range that can currently be allocated.
+ @param a A pointer to the allocator.
+ */
+uint32_t offset_alloc_largest_free(offset_allocator_t* a);
+
+/**
+ Free all allocations, leaving a single free range covering the whole space.
+ @param a A pointer to the allocator.
+ */
+void offset_alloc_reset(offset_allocator_t* a);
+
+#endif
@@ -22,7 +22,10 @@
 
 #include "parallel_for.h"
 
+#include "maths.h"
+
 #include <stdio.h>
+#include <string.h>
 
 #define MAX_SPLITS 12
 #define MIN_COUNT 64
@@ -39,6 +42,19 @@ void parallel_for_impl(
     struct SplitConfig* cfg,
     arena_t* arena);
 
+struct ParallelForData* _alloc_split_data(job_queue_t* jq, arena_t* arena)
+{
+    // Splits are allocated from the arena of the calling thread to avoid contention on the shared
+    // arena, which is only used if the thread arena is exhausted.
+    struct ParallelForData* d = thread_arena_alloc(
+        job_queue_get_thread_arena(jq),
+        sizeof(struct ParallelForData),
+        _Alignof(struct ParallelForData),
+        1,
+        ARENA_ZERO_MEMORY | ARENA_OUT_OF_MEM_SOFT_FAIL);
+    return d ? d : ARENA_MAKE_ZERO_STRUCT_WITH_LOCK(arena, struct ParallelForData);
+}
+
 bool should_split(uint32_t splits, uint32_t count, uint32_t max_split, uint32_t min_count)
 {
     return splits < max_split && count >= min_count * 2;
@@ -71,8 +87,7 @@ void parallel_for_impl(
         // left side
         uint32_t left_count = count / 2;
 
-        struct ParallelForData* l_data =
-            ARENA_MAKE_ZERO_STRUCT_WITH_LOCK(arena, struct ParallelForData);
+        struct ParallelForData* l_data = _alloc_split_data(jq, arena);
         l_data->func = func;
         l_data->count = left_count;
         l_data->start = start;
@@ -88,8 +103,7 @@ void parallel_for_impl(
         // right side
         uint32_t right_count = count - left_count;
 
-        struct ParallelForData* r_data =
-            ARENA_MAKE_ZERO_STRUCT_WITH_LOCK(arena, struct ParallelForData);
+        struct ParallelForData* r_data = _alloc_split_data(jq, arena);
         r_data->func = func;
         r_data->count = right_count;
         r_data->start = start + left_count;
@@ -131,4 +145,183 @@ job_t* parallel_for(
     p_data->arena = arena;
 
     return job_queue_create_job(jq, parallel_for_runner, p_data, parent);
-}
\ No newline at end of file
+}
+
+uint32_t _align_up(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void _run_chunks(struct ParallelChunkData* d, void* partial)
+{
+    uint32_t end = d->start + d->count;
+    uint32_t chunk = atomic_fetch_add_explicit(&d->next_chunk, 1, memory_order_relaxed);
+    while (chunk < d->chunk_count)
+    {
+        uint32_t chunk_start = d->start + chunk * d->chunk_size;
+        uint32_t chunk_count = MIN(d->chunk_size, end - chunk_start);
+        if (d->reduce_func)
+        {
+            d->reduce_func(chunk_start, chunk_count, d->data, partial);
+        }
+        else
+        {
+            d->func(chunk_start, chunk_count, d->data);
+        }
+        chunk = atomic_fetch_add_explicit(&d->next_chunk, 1, memory_order_relaxed);
+    }
+}
+
+void parallel_chunk_worker(void* data)
+{
+    assert(data);
+    struct ParallelChunkData* d = (struct ParallelChunkData*)data;
+
+    uint32_t worker_idx = atomic_fetch_add_explicit(&d->next_worker, 1, memory_order_relaxed);
+    assert(worker_idx < d->worker_count);
+    void* partial = d->partials ? d->partials + worker_idx * d->partial_stride : NULL;
+
+    _run_chunks(d, partial);
+
+    if (d->join_func)
+    {
+        // The last worker to finish sees all the partial results and joins them.
+        uint32_t finished = atomic_fetch_add_explicit(&d->finished_count, 1, memory_order_acq_rel);
+        if (finished == d->worker_count - 1)
+        {
+            for (uint32_t i = 0; i < d->worker_count; ++i)
+            {
+                d->join_func(d->result, d->partials + i * d->partial_stride, d->data);
+            }
+        }
+    }
+}
+
+void parallel_chunk_runner(void* data)
+{
+    assert(data);
+    struct ParallelChunkData* d = (struct ParallelChunkData*)data;
+
+    // The remaining workers are children of this job, so the job doesn't complete until all
+    // chunks have been processed.
+    for (uint32_t i = 1; i < d->worker_count; ++i)
+    {
+        job_t* worker = job_queue_create_job(d->jq, parallel_chunk_worker, d, d->job);
+        job_queue_run_job(d->jq, worker);
+    }
+    parallel_chunk_worker(d);
+}
+
+job_t* _parallel_chunk_init(
+    job_queue_t* jq,
+    job_t* parent,
+    uint32_t start,
+    uint32_t count,
+    uint32_t result_size,
+    struct ChunkConfig* cfg,
+    arena_t* arena,
+    struct ParallelChunkData** out_data)
+{
+    assert(jq);
+    assert(arena);
+
+    uint32_t chunks_per_worker = PARALLEL_FOR_CHUNKS_PER_WORKER;
+    uint32_t min_chunk_size = PARALLEL_FOR_MIN_CHUNK_SIZE;
+    uint32_t item_size = 0;
+    if (cfg)
+    {
+        chunks_per_worker = cfg->chunks_per_worker ? cfg->chunks_per_worker : chunks_per_worker;
+        min_chunk_size = cfg->min_chunk_size ? cfg->min_chunk_size : min_chunk_size;
+        item_size = cfg->item_size;
+    }
+
+    uint32_t thread_count =
+        jq->thread_count + atomic_load_explicit(&jq->adopted_thread_count, memory_order_relaxed);
+    uint32_t target_chunk_count = thread_count * chunks_per_worker;
+    uint32_t chunk_size = (count + target_chunk_count - 1) / target_chunk_count;
+    chunk_size = MAX(chunk_size, min_chunk_size);
+    if (item_size && item_size < PARALLEL_FOR_CACHELINE_SIZE)
+    {
+        chunk_size = _align_up(chunk_size, PARALLEL_FOR_CACHELINE_SIZE / item_size);
+    }
+    uint32_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    uint32_t worker_count = MIN(thread_count, chunk_count);
+    worker_count = MAX(worker_count, 1);
+
+    // The shared state and the partial results, each on their own cache line, are allocated as
+    // one block.
+    uint32_t header_size = _align_up(sizeof(struct ParallelChunkData), PARALLEL_FOR_CACHELINE_SIZE);
+    uint32_t partial_stride =
+        result_size ? _align_up(result_size, PARALLEL_FOR_CACHELINE_SIZE) : 0;
+    uint8_t* block = arena_alloc(
+        arena,
+        header_size + partial_stride * worker_count,
+        PARALLEL_FOR_CACHELINE_SIZE,
+        1,
+        ARENA_ZERO_MEMORY);
+
+    struct ParallelChunkData* d = (struct ParallelChunkData*)block;
+    d->jq = jq;
+    d->start = start;
+    d->count = count;
+    d->chunk_size = chunk_size;
+    d->chunk_count = chunk_count;
+    d->worker_count = worker_count;
+    d->result_size = result_size;
+    d->partial_stride = partial_stride;
+    d->partials = result_size ? block + header_size : NULL;
+    d->job = job_queue_create_job(jq, parallel_chunk_runner, d, parent);
+
+    *out_data = d;
+    return d->job;
+}
+
+job_t* parallel_for_chunked(
+    job_queue_t* jq,
+    job_t* parent,
+    uint32_t start,
+    uint32_t count,
+    parallel_for_func_t func,
+    void* data,
+    struct ChunkConfig* cfg,
+    arena_t* arena)
+{
+    assert(func);
+    struct ParallelChunkData* d;
+    job_t* job = _parallel_chunk_init(jq, parent, start, count, 0, cfg, arena, &d);
+    d->func = func;
+    d->data = data;
+    return job;
+}
+
+job_t* parallel_reduce(
+    job_queue_t* jq,
+    job_t* parent,
+    uint32_t start,
+    uint32_t count,
+    parallel_reduce_func_t func,
+    parallel_reduce_join_func_t join_func,
+    void* data,
+    void* result,
+    uint32_t result_size,
+    struct ChunkConfig* cfg,
+    arena_t* arena)
+{
+    assert(func);
+    assert(join_func);
+    assert(result);
+    assert(result_size > 0);
+
+    struct ParallelChunkData* d;
+    job_t* job = _parallel_chunk_init(jq, parent, start, count, result_size, cfg, arena, &d);
+    d->reduce_func = func;
+    d->join_func = join_func;
+    d->data = data;
+    d->result = result;
+    // Each partial result starts from the identity value.
+    for (uint32_t i = 0; i < d->worker_count; ++i)
+    {
+        memcpy(d->partials + i * d->partial_stride, result, result_size);
+    }
+    return job;
+}
@@ -24,12 +24,38 @@
 #define __UTILITY_PARALLEL_FOR_H__
 
 #include "arena.h"
+#include "compiler.h"
 #include "job_queue.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 
+// The default number of chunks per worker for the chunked variants. More chunks give better load
+// balancing when the cost per item varies, at the expense of more claims on the chunk counter.
+#define PARALLEL_FOR_CHUNKS_PER_WORKER 4
+#define PARALLEL_FOR_MIN_CHUNK_SIZE 64
+#define PARALLEL_FOR_CACHELINE_SIZE 64
+
 typedef void (*parallel_for_func_t)(uint32_t, uint32_t, void*);
 
+/**
+ Called for each chunk of a reduction.
+ @param start The first item of the chunk.
+ @param count The number of items in the chunk.
+ @param data The user data.
+ @param result The partial result for the worker processing the chunk, which the chunk should be
+ accumulated into.
+ */
+typedef void (*parallel_reduce_func_t)(uint32_t start, uint32_t count, void* data, void* result);
+
+/**
+ Called to combine the partial results of a reduction.
+ @param result The final result to accumulate into.
+ @param partial A partial result from one worker.
+ @param data The user data.
+ */
+typedef void (*parallel_reduce_join_func_t)(void* result, void* partial, void* data);
+
 struct SplitConfig
 {
     uint32_t max_split;
@@ -59,4 +85,93 @@ job_t* parallel_for(
     struct SplitConfig* cfg,
     arena_t* arena);
 
+struct ChunkConfig
+{
+    /// The number of chunks per worker. If zero, @sa PARALLEL_FOR_CHUNKS_PER_WORKER is used.
+    uint32_t chunks_per_worker;
+    /// The minimum number of items per chunk. If zero, @sa PARALLEL_FOR_MIN_CHUNK_SIZE is used.
+    uint32_t min_chunk_size;
+    /// The size in bytes of each item written by the function. If non-zero, chunks are sized so
+    /// their boundaries fall on cache lines, avoiding false sharing between workers.
+    uint32_t item_size;
+};
+
+/**
+ State shared by all workers of a chunked parallel for/reduce. This and the per-worker partial
+ results are allocated as one contiguous block.
+ */
+struct ParallelChunkData
+{
+    job_queue_t* jq;
+    job_t* job;
+    parallel_for_func_t func;
+    parallel_reduce_func_t reduce_func;
+    parallel_reduce_join_func_t join_func;
+    void* data;
+    void* result;
+    uint8_t* partials;
+    uint32_t partial_stride;
+    uint32_t result_size;
+    uint32_t start;
+    uint32_t count;
+    uint32_t chunk_size;
+    uint32_t chunk_count;
+    uint32_t worker_count;
+    /// The index of the next chunk to be claimed by a worker.
+    RPE_ALIGNAS(PARALLEL_FOR_CACHELINE_SIZE) atomic_uint next_chunk;
+    /// Used to assign each worker a partial result slot.
+    RPE_ALIGNAS(PARALLEL_FOR_CACHELINE_SIZE) atomic_uint next_worker;
+    /// The number of workers which have finished - the last to finish joins the partial results.
+    RPE_ALIGNAS(PARALLEL_FOR_CACHELINE_SIZE) atomic_uint finished_count;
+};
+
+/**
+ A parallel for which splits the range into chunks up front, based on the worker count of the job
+ queue. A job is created per worker, and each claims chunks via an atomic counter until all chunks
+ have been processed. Only a single allocation is made for the shared state.
+ @param jq A pointer to the job queue.
+ @param parent An optional parent of the returned job.
+ @param start The first item of the range.
+ @param count The number of items in the range.
+ @param func The function to call for each chunk.
+ @param data User data passed to @sa func.
+ @param cfg Optional chunk config - if NULL, the defaults are used.
+ @param arena The arena to allocate the shared state from. Must remain valid until the job
+ completes.
+ @return The job to run. The job completes once all chunks have been processed.
+ */
+job_t* parallel_for_chunked(
+    job_queue_t* jq,
+    job_t* parent,
+    uint32_t start,
+    uint32_t count,
+    parallel_for_func_t func,
+    void* data,
+    struct ChunkConfig* cfg,
+    arena_t* arena);
+
+/**
+ A chunked parallel for (see @sa parallel_for_chunked) which reduces the range to a single
+ result. Each worker accumulates into its own partial result, initialised with the value of
+ @sa result, and the partial results are joined into @sa result by the last worker to finish.
+ @param func The function to call for each chunk.
+ @param join_func The function to combine a partial result into the final result.
+ @param result On entry, the identity value of the reduction. On completion of the job, the
+ result of the reduction.
+ @param result_size The size of the result in bytes.
+ @return The job to run. The result is valid once the job completes.
+ */
+job_t* parallel_reduce(
+    job_queue_t* jq,
+    job_t* parent,
+    uint32_t start,
+    uint32_t count,
+    parallel_reduce_func_t func,
+    parallel_reduce_join_func_t join_func,
+    void* data,
+    void* result,
+    uint32_t result_size,
+    struct ChunkConfig* cfg,
+    arena_t* arena);
+
 #endif
\ No newline at end of file
@@ -22,37 +22,259 @@
 
 #include "sort.h"
 
-#include "array_utility.h"
+#include "job_queue.h"
 
 #include <assert.h>
-#include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 
-void count_sort(uint64_t* arr, size_t sz, int pos, arena_t* arena, uint64_t* output)
+#define RADIX_SORT_DIGIT_MASK (RADIX_SORT_BUCKET_COUNT - 1)
+
+typedef uint32_t radix_histogram_t[RADIX_SORT_BUCKET_COUNT];
+
+struct RadixSortData
 {
-    uint64_t bucket[10];
-    memset(bucket, 0, sizeof(uint64_t) * 10);
+    uint64_t* src_keys;
+    uint32_t* src_indices;
+    uint64_t* dst_keys;
+    uint32_t* dst_indices;
+    uint32_t shift;
+};
 
-    uint64_t* sorted = ARENA_MAKE_ARRAY(arena, uint64_t, sz, 0);
-    uint64_t* tmp = ARENA_MAKE_ARRAY(arena, uint64_t, sz, 0);
+struct RadixSortBlock
+{
+    struct RadixSortData* data;
+    size_t start;
+    size_t count;
+    /// The histograms of this block - for all passes on the first sweep, otherwise only the first
+    /// entry is used.
+    radix_histogram_t hist[RADIX_SORT_PASS_COUNT];
+    /// The destination offsets of each bucket for this block.
+    radix_histogram_t offsets;
+};
 
-    for (size_t i = 0; i < sz; ++i)
+void _radix_histogram_all(const uint64_t* keys, size_t count, radix_histogram_t* hist)
+{
+    for (size_t i = 0; i < count; ++i)
     {
-        ++bucket[(arr[i] / pos) % 10];
+        uint64_t key = keys[i];
+        for (int p = 0; p < RADIX_SORT_PASS_COUNT; ++p)
+        {
+            ++hist[p][(key >> (p * RADIX_SORT_DIGIT_BITS)) & RADIX_SORT_DIGIT_MASK];
+        }
     }
-    for (int i = 1; i < 10; ++i)
+}
+
+void _radix_histogram(const uint64_t* keys, size_t count, uint32_t shift, uint32_t* hist)
+{
+    for (size_t i = 0; i < count; ++i)
     {
-        bucket[i] += bucket[i - 1];
+        ++hist[(keys[i] >> shift) & RADIX_SORT_DIGIT_MASK];
     }
-    for (int i = (int)sz - 1; i >= 0; i--)
+}
+
+void _radix_scatter(struct RadixSortData* data, size_t start, size_t count, uint32_t* offsets)
+{
+    const uint64_t* src_keys = data->src_keys + start;
+    const uint32_t* src_indices = data->src_indices + start;
+    for (size_t i = 0; i < count; ++i)
     {
-        uint64_t index = (arr[i] / pos) % 10;
-        tmp[bucket[index] - 1] = output[i];
-        sorted[bucket[index] - 1] = arr[i];
-        --bucket[index];
+        uint64_t key = src_keys[i];
+        uint32_t dst = offsets[(key >> data->shift) & RADIX_SORT_DIGIT_MASK]++;
+        data->dst_keys[dst] = key;
+        data->dst_indices[dst] = src_indices[i];
     }
-    memcpy(arr, sorted, sizeof(uint64_t) * sz);
-    memcpy(output, tmp, sizeof(uint64_t) * sz);
+}
+
+// A pass is only required if the keys don't all share the same digit.
+bool _radix_pass_required(const uint32_t* hist, uint64_t first_key, uint32_t shift, size_t sz)
+{
+    return hist[(first_key >> shift) & RADIX_SORT_DIGIT_MASK] != sz;
+}
+
+void _radix_swap_buffers(struct RadixSortData* data)
+{
+    uint64_t* keys = data->src_keys;
+    uint32_t* indices = data->src_indices;
+    data->src_keys = data->dst_keys;
+    data->src_indices = data->dst_indices;
+    data->dst_keys = keys;
+    data->dst_indices = indices;
+}
+
+void _radix_copy_result(struct RadixSortData* data, uint64_t* keys, uint32_t* indices, size_t sz)
+{
+    if (data->src_keys != keys)
+    {
+        memcpy(keys, data->src_keys, sizeof(uint64_t) * sz);
+        memcpy(indices, data->src_indices, sizeof(uint32_t) * sz);
+    }
+}
+
+void radix_sort_keys(
+    uint64_t* keys, uint32_t* indices, size_t sz, uint64_t* tmp_keys, uint32_t* tmp_indices)
+{
+    assert(keys);
+    assert(indices);
+    assert(tmp_keys);
+    assert(tmp_indices);
+    assert(sz <= UINT32_MAX);
+    if (sz < 2)
+    {
+        return;
+    }
+
+    radix_histogram_t hist[RADIX_SORT_PASS_COUNT];
+    memset(hist, 0, sizeof(hist));
+    _radix_histogram_all(keys, sz, hist);
+
+    struct RadixSortData data = {
+        .src_keys = keys,
+        .src_indices = indices,
+        .dst_keys = tmp_keys,
+        .dst_indices = tmp_indices};
+
+    for (uint32_t p = 0; p < RADIX_SORT_PASS_COUNT; ++p)
+    {
+        data.shift = p * RADIX_SORT_DIGIT_BITS;
+        if (!_radix_pass_required(hist[p], keys[0], data.shift, sz))
+        {
+            continue;
+        }
+        // Convert the counts to an exclusive prefix sum giving the first slot of each bucket.
+        uint32_t sum = 0;
+        for (int i = 0; i < RADIX_SORT_BUCKET_COUNT; ++i)
+        {
+            uint32_t c = hist[p][i];
+            hist[p][i] = sum;
+            sum += c;
+        }
+        _radix_scatter(&data, 0, sz, hist[p]);
+        _radix_swap_buffers(&data);
+    }
+    _radix_copy_result(&data, keys, indices, sz);
+}
+
+void _radix_histogram_all_job(void* arg)
+{
+    struct RadixSortBlock* block = arg;
+    _radix_histogram_all(block->data->src_keys + block->start, block->count, block->hist);
+}
+
+void _radix_histogram_job(void* arg)
+{
+    struct RadixSortBlock* block = arg;
+    memset(block->hist[0], 0, sizeof(radix_histogram_t));
+    _radix_histogram(
+        block->data->src_keys + block->start, block->count, block->data->shift, block->hist[0]);
+}
+
+void _radix_scatter_job(void* arg)
+{
+    struct RadixSortBlock* block = arg;
+    _radix_scatter(block->data, block->start, block->count, block->offsets);
+}
+
+void _radix_run_blocks(
+    job_queue_t* jq, struct RadixSortBlock* blocks, uint32_t block_count, job_func_t func)
+{
+    job_t* parent = job_queue_create_parent_job(jq);
+    for (uint32_t i = 0; i < block_count; ++i)
+    {
+        job_t* job = job_queue_create_job(jq, func, &blocks[i], parent);
+        job_queue_run_job(jq, job);
+    }
+    job_queue_run_and_wait(jq, parent);
+}
+
+void radix_sort_keys_mt(
+    job_queue_t* jq,
+    uint64_t* keys,
+    uint32_t* indices,
+    size_t sz,
+    uint64_t* tmp_keys,
+    uint32_t* tmp_indices,
+    arena_t* arena)
+{
+    assert(jq);
+    assert(arena);
+    assert(sz <= UINT32_MAX);
+
+    size_t block_count = sz / RADIX_SORT_MIN_BLOCK_SIZE;
+    if (block_count > jq->thread_count + 1)
+    {
+        block_count = jq->thread_count + 1;
+    }
+    if (block_count < 2)
+    {
+        radix_sort_keys(keys, indices, sz, tmp_keys, tmp_indices);
+        return;
+    }
+
+    struct RadixSortData data = {
+        .src_keys = keys,
+        .src_indices = indices,
+        .dst_keys = tmp_keys,
+        .dst_indices = tmp_indices};
+
+    struct RadixSortBlock* blocks =
+        ARENA_MAKE_ZERO_ARRAY(arena, struct RadixSortBlock, block_count);
+    size_t block_size = (sz + block_count - 1) / block_count;
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        blocks[i].data = &data;
+        blocks[i].start = i * block_size;
+        blocks[i].count = i == block_count - 1 ? sz - blocks[i].start : block_size;
+    }
+
+    // The first sweep gathers the histograms for every pass - used to find the passes which can be
+    // skipped and for the offsets of the first pass, as the keys are still in their original order.
+    _radix_run_blocks(jq, blocks, block_count, _radix_histogram_all_job);
+    radix_histogram_t totals[RADIX_SORT_PASS_COUNT];
+    memset(totals, 0, sizeof(totals));
+    for (size_t i = 0; i < block_count; ++i)
+    {
+        for (int p = 0; p < RADIX_SORT_PASS_COUNT; ++p)
+        {
+            for (int d = 0; d < RADIX_SORT_BUCKET_COUNT; ++d)
+            {
+                totals[p][d] += blocks[i].hist[p][d];
+            }
+        }
+    }
+
+    bool first_pass = true;
+    for (uint32_t p = 0; p < RADIX_SORT_PASS_COUNT; ++p)
+    {
+        data.shift = p * RADIX_SORT_DIGIT_BITS;
+        if (!_radix_pass_required(totals[p], keys[0], data.shift, sz))
+        {
+            continue;
+        }
+        // After a scatter the blocks hold a different set of keys, so their histograms need
+        // rebuilding for this digit.
+        uint32_t hist_idx = p;
+        if (!first_pass)
+        {
+            _radix_run_blocks(jq, blocks, block_count, _radix_histogram_job);
+            hist_idx = 0;
+        }
+        first_pass = false;
+
+        // Keys are placed by digit and then by block, which keeps the sort stable.
+        uint32_t sum = 0;
+        for (int d = 0; d < RADIX_SORT_BUCKET_COUNT; ++d)
+        {
+            for (size_t i = 0; i < block_count; ++i)
+            {
+                blocks[i].offsets[d] = sum;
+                sum += blocks[i].hist[hist_idx][d];
+            }
+        }
+        _radix_run_blocks(jq, blocks, block_count, _radix_scatter_job);
+        _radix_swap_buffers(&data);
+    }
+    _radix_copy_result(&data, keys, indices, sz);
 }
 
 void radix_sort(uint64_t* arr, size_t sz, arena_t* arena, uint64_t* output)
@@ -62,17 +284,17 @@ void radix_sort(uint64_t* arr, size_t sz, arena_t* arena, uint64_t* output)
     {
         return;
     }
-    uint64_t max = array_max_value(arr, sz);
 
-    // Keep looping based upon the number of digits of the max value in the array.
-    uint64_t* temp_arr = ARENA_MAKE_ARRAY(arena, uint64_t, sz, 0);
-    for (uint64_t i = 0; i < sz; ++i)
+    uint64_t* keys = ARENA_MAKE_ARRAY(arena, uint64_t, sz * 2, 0);
+    uint32_t* indices = ARENA_MAKE_ARRAY(arena, uint32_t, sz * 2, 0);
+    memcpy(keys, arr, sz * sizeof(uint64_t));
+    for (uint32_t i = 0; i < sz; ++i)
     {
-        output[i] = i;
+        indices[i] = i;
     }
-    memcpy(temp_arr, arr, sz * sizeof(uint64_t));
-    for (int pos = 1; max / pos > 0; pos *= 10)
+    radix_sort_keys(keys, indices, sz, keys + sz, indices + sz);
+    for (size_t i = 0; i < sz; ++i)
     {
-        count_sort(temp_arr, sz, pos, arena, output);
+        output[i] = indices[i];
     }
-}
\ No newline at end of file
+}
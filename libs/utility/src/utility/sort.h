@@ -34,6 +34,58 @@
 #define QSORT_RS qsort_s
 #endif
 
+/**
+ An LSD radix sort over 64-bit keys, one byte per pass. The histograms for all passes are built
+ in a single sweep over the keys, and any pass where every key has the same digit is skipped -
+ sort keys generally only use a few of their bytes, so most passes are never run.
+ */
+
+#define RADIX_SORT_DIGIT_BITS 8
+#define RADIX_SORT_BUCKET_COUNT (1 << RADIX_SORT_DIGIT_BITS)
+#define RADIX_SORT_PASS_COUNT (64 / RADIX_SORT_DIGIT_BITS)
+// The minimum number of keys each job is given when sorting on the job queue. Below this, the
+// cost of dispatching the jobs outweighs the gain.
+#define RADIX_SORT_MIN_BLOCK_SIZE 16384
+
+typedef struct JobQueue job_queue_t;
+
+/**
+ Sort the keys in ascending order, moving the indices along with their keys. The sort is stable.
+ The sorted result is always returned in @sa keys and @sa indices - the temporary buffers are only
+ used for ping-ponging between passes.
+ @param keys The keys to sort.
+ @param indices The payload which is reordered alongside the keys.
+ @param sz The number of keys. Must be no greater than UINT32_MAX.
+ @param tmp_keys A buffer of at least @sa sz keys.
+ @param tmp_indices A buffer of at least @sa sz indices.
+ */
+void radix_sort_keys(
+    uint64_t* keys, uint32_t* indices, size_t sz, uint64_t* tmp_keys, uint32_t* tmp_indices);
+
+/**
+ Sort the keys as @sa radix_sort_keys, but with the histogram and scatter stages of each pass
+ split into blocks which are run across the job queue. Falls back to the single threaded sort if
+ there are too few keys to split.
+ @param jq A pointer to the job queue. This must be called from a thread known to the job queue.
+ @param arena The arena used for the per-block histograms.
+ */
+void radix_sort_keys_mt(
+    job_queue_t* jq,
+    uint64_t* keys,
+    uint32_t* indices,
+    size_t sz,
+    uint64_t* tmp_keys,
+    uint32_t* tmp_indices,
+    arena_t* arena);
+
+/**
+ Compute the sorted order of an array of keys. The keys themselves are left unchanged.
+ @param arr The keys to sort.
+ @param sz The number of keys.
+ @param arena The arena used for the temporary buffers.
+ @param output An array of at least @sa sz which will hold the indices of the keys in ascending
+ order.
+ */
 void radix_sort(uint64_t* arr, size_t sz, arena_t* arena, uint64_t* output);
 
 #endif
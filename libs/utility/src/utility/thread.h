@@ -23,7 +23,9 @@
 #ifndef __UTILITY_THREAD_H__
 #define __UTILITY_THREAD_H__
 
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct Thread thread_t;
 typedef struct Arena arena_t;
@@ -39,7 +41,7 @@ thread_t thread_current();
 #include <threads.h>
 typedef mtx_t mutex_t;
 typedef cnd_t cond_wait_t;
-#elif __linux__
+#else
 #include <pthread.h>
 typedef pthread_mutex_t mutex_t;
 typedef pthread_cond_t cond_wait_t;
@@ -63,4 +65,20 @@ bool condition_brdcast(cond_wait_t* c);
 
 void condition_destroy(cond_wait_t* c);
 
+/**
+ Block the calling thread while the value at @sa addr equals @sa expected. The thread may be
+ woken spuriously, so the caller must re-check the value.
+ */
+void futex_wait(atomic_uint* addr, uint32_t expected);
+
+/**
+ Wake a single thread blocked on @sa addr.
+ */
+void futex_wake_one(atomic_uint* addr);
+
+/**
+ Wake all threads blocked on @sa addr.
+ */
+void futex_wake_all(atomic_uint* addr);
+
 #endif
@@ -23,8 +23,14 @@
 #include "arena.h"
 #include "thread.h"
 
+#include <limits.h>
 #include <pthread.h>
 #include <string.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 typedef struct Thread
 {
@@ -117,3 +123,79 @@ bool condition_brdcast(cond_wait_t* c)
 void condition_destroy(cond_wait_t* c) { pthread_cond_destroy(c); }
 
 void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+
+#ifdef __linux__
+
+void futex_wait(atomic_uint* addr, uint32_t expected)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void futex_wake_one(atomic_uint* addr)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void futex_wake_all(atomic_uint* addr)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+#else
+
+// Without a futex, waiters park on a condition variable chosen by hashing the address. Buckets
+// are shared between addresses, so all waiters on a bucket are woken and left to re-check their
+// value - this is allowed as futex_wait may wake spuriously.
+#define FUTEX_BUCKET_COUNT 64
+
+typedef struct FutexBucket
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} futex_bucket_t;
+
+static futex_bucket_t futex_buckets[FUTEX_BUCKET_COUNT];
+static pthread_once_t futex_buckets_once = PTHREAD_ONCE_INIT;
+
+void _futex_buckets_init()
+{
+    for (int i = 0; i < FUTEX_BUCKET_COUNT; ++i)
+    {
+        pthread_mutex_init(&futex_buckets[i].mutex, NULL);
+        pthread_cond_init(&futex_buckets[i].cond, NULL);
+    }
+}
+
+futex_bucket_t* _futex_get_bucket(atomic_uint* addr)
+{
+    pthread_once(&futex_buckets_once, _futex_buckets_init);
+    uintptr_t key = (uintptr_t)addr >> 2;
+    return &futex_buckets[(key ^ (key >> 6)) % FUTEX_BUCKET_COUNT];
+}
+
+void futex_wait(atomic_uint* addr, uint32_t expected)
+{
+    futex_bucket_t* b = _futex_get_bucket(addr);
+    pthread_mutex_lock(&b->mutex);
+    // The value is checked under the bucket lock, which the waker also takes after updating the
+    // value, so a wake can't be missed between the check and the wait.
+    if (atomic_load(addr) == expected)
+    {
+        pthread_cond_wait(&b->cond, &b->mutex);
+    }
+    pthread_mutex_unlock(&b->mutex);
+}
+
+void _futex_wake(atomic_uint* addr)
+{
+    futex_bucket_t* b = _futex_get_bucket(addr);
+    pthread_mutex_lock(&b->mutex);
+    pthread_cond_broadcast(&b->cond);
+    pthread_mutex_unlock(&b->mutex);
+}
+
+void futex_wake_one(atomic_uint* addr) { _futex_wake(addr); }
+
+void futex_wake_all(atomic_uint* addr) { _futex_wake(addr); }
+
+#endif
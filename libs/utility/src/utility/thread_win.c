@@ -23,8 +23,11 @@
 #include "arena.h"
 #include "thread.h"
 
+#include <Windows.h>
 #include <threads.h>
 
+#pragma comment(lib, "Synchronization.lib")
+
 typedef struct Thread
 {
     thrd_t handle;
@@ -107,4 +110,13 @@ bool condition_brdcast(cond_wait_t* c)
 
 void condition_destroy(cond_wait_t* c) {}
 
-void mutex_destroy(mutex_t* m) {}
\ No newline at end of file
+void mutex_destroy(mutex_t* m) {}
+
+void futex_wait(atomic_uint* addr, uint32_t expected)
+{
+    WaitOnAddress((volatile VOID*)addr, &expected, sizeof(uint32_t), INFINITE);
+}
+
+void futex_wake_one(atomic_uint* addr) { WakeByAddressSingle((PVOID)addr); }
+
+void futex_wake_all(atomic_uint* addr) { WakeByAddressAll((PVOID)addr); }
@@ -30,16 +30,44 @@
 #include <stdlib.h>
 #include <string.h>
 
-void _set_item(work_stealing_queue_t* queue, int idx, int item)
+// Adapted from: "Correct and Efficient Work-Stealing for Weak Memory Models" - Le et al. 2013.
+
+work_stealing_buffer_t* _alloc_buffer(arena_t* arena, int64_t capacity)
+{
+    assert(capacity > 0);
+    assert((capacity & (capacity - 1)) == 0);
+    // Queue buffers may be allocated by any thread which owns a queue, so lock the arena.
+    work_stealing_buffer_t* buffer = arena_alloc_with_lock(
+        arena,
+        sizeof(work_stealing_buffer_t) + sizeof(atomic_int) * capacity,
+        _Alignof(work_stealing_buffer_t),
+        1,
+        ARENA_ZERO_MEMORY);
+    buffer->capacity = capacity;
+    buffer->idx_mask = capacity - 1;
+    return buffer;
+}
+
+void _set_item(work_stealing_buffer_t* buffer, int64_t idx, int item)
 {
-    int mask_idx = idx & queue->idx_mask;
-    queue->items[mask_idx] = item;
+    atomic_store_explicit(&buffer->items[idx & buffer->idx_mask], item, memory_order_relaxed);
 }
 
-int _get_item(work_stealing_queue_t* queue, int idx)
+int _get_item(work_stealing_buffer_t* buffer, int64_t idx)
 {
-    int mask_idx = idx & queue->idx_mask;
-    return queue->items[mask_idx];
+    return atomic_load_explicit(&buffer->items[idx & buffer->idx_mask], memory_order_relaxed);
+}
+
+work_stealing_buffer_t*
+_grow(work_stealing_queue_t* queue, work_stealing_buffer_t* buffer, int64_t top, int64_t bottom)
+{
+    work_stealing_buffer_t* new_buffer = _alloc_buffer(queue->arena, buffer->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i)
+    {
+        _set_item(new_buffer, i, _get_item(buffer, i));
+    }
+    atomic_store_explicit(&queue->buffer, new_buffer, memory_order_release);
+    return new_buffer;
 }
 
 work_stealing_queue_t work_stealing_queue_init(arena_t* arena, uint32_t queue_count)
@@ -48,51 +76,55 @@ work_stealing_queue_t work_stealing_queue_init(arena_t* arena, uint32_t queue_co
     assert(arena);
 
     work_stealing_queue_t q = {0};
-    q.idx_mask = queue_count - 1;
+    q.arena = arena;
+    q.buffer = _alloc_buffer(arena, queue_count);
     return q;
 }
 
 void work_stealing_queue_push(work_stealing_queue_t* queue, int item)
 {
-    int bottom = atomic_load_explicit(&queue->bottom_idx, memory_order_relaxed);
-    _set_item(queue, bottom, item);
-    atomic_store_explicit(&queue->bottom_idx, bottom + 1, memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&queue->bottom_idx, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&queue->top_idx, memory_order_acquire);
+    work_stealing_buffer_t* buffer = atomic_load_explicit(&queue->buffer, memory_order_relaxed);
+
+    if (bottom - top > buffer->capacity - 1)
+    {
+        buffer = _grow(queue, buffer, top, bottom);
+    }
+    _set_item(buffer, bottom, item);
+    // Publish the item (and the job it refers to) to thieves which acquire the bottom index.
+    atomic_store_explicit(&queue->bottom_idx, bottom + 1, memory_order_release);
 }
 
 int work_stealing_queue_pop(work_stealing_queue_t* queue)
 {
-    atomic_int bottom = atomic_fetch_sub_explicit(&queue->bottom_idx, 1, memory_order_seq_cst) - 1;
-
-    // Trying to pop from an empty queue?
-    assert(bottom >= -1);
-
-    // Store the top index - used to check for concurrent "steals" in case the queue is empty after
-    // a pop.
-    int top = atomic_load_explicit(&queue->top_idx, memory_order_seq_cst);
-
-    if (top < bottom)
-    {
-        return _get_item(queue, bottom);
-    }
+    int64_t bottom = atomic_load_explicit(&queue->bottom_idx, memory_order_relaxed) - 1;
+    work_stealing_buffer_t* buffer = atomic_load_explicit(&queue->buffer, memory_order_relaxed);
+    atomic_store_explicit(&queue->bottom_idx, bottom, memory_order_relaxed);
+    // The bottom index must be visible to thieves before reading the top index.
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&queue->top_idx, memory_order_relaxed);
 
     int item = INT32_MAX;
-    if (top == bottom)
+    if (top <= bottom)
     {
-        item = _get_item(queue, bottom);
-
-        if (atomic_compare_exchange_strong_explicit(
-                &queue->top_idx, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
-        {
-            top++;
-        }
-        else
+        item = _get_item(buffer, bottom);
+        if (top == bottom)
         {
-            item = INT32_MAX;
+            // The last item - race against any thieves for it.
+            if (!atomic_compare_exchange_strong_explicit(
+                    &queue->top_idx, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+            {
+                item = INT32_MAX;
+            }
+            atomic_store_explicit(&queue->bottom_idx, bottom + 1, memory_order_relaxed);
         }
     }
-    // Note: Was using relaxed memory ordering but Helgrind reports a potential issue when using
-    // this, using seq_cst instead.
-    atomic_store_explicit(&queue->bottom_idx, top, memory_order_seq_cst);
+    else
+    {
+        // The queue is empty.
+        atomic_store_explicit(&queue->bottom_idx, bottom + 1, memory_order_relaxed);
+    }
     return item;
 }
 
@@ -101,8 +133,9 @@ int work_stealing_queue_steal(work_stealing_queue_t* queue)
     // Keep spinning until we successfully manage to steal a job.
     while (true)
     {
-        int top = atomic_load_explicit(&queue->top_idx, memory_order_seq_cst);
-        int bottom = atomic_load_explicit(&queue->bottom_idx, memory_order_seq_cst);
+        int64_t top = atomic_load_explicit(&queue->top_idx, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t bottom = atomic_load_explicit(&queue->bottom_idx, memory_order_acquire);
 
         // The queue is empty.
         if (top >= bottom)
@@ -110,7 +143,8 @@ int work_stealing_queue_steal(work_stealing_queue_t* queue)
             return INT32_MAX;
         }
 
-        int item = _get_item(queue, top);
+        work_stealing_buffer_t* buffer = atomic_load_explicit(&queue->buffer, memory_order_acquire);
+        int item = _get_item(buffer, top);
         if (atomic_compare_exchange_strong_explicit(
                 &queue->top_idx, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
         {
@@ -25,25 +25,55 @@
 #include <stdatomic.h>
 #include <stdint.h>
 
-#define WORK_STEALING_QUEUE_MAX_JOB_COUNT 4096
-
 // Forward declarations.
 typedef struct Arena arena_t;
 
+/**
+ The circular buffer which holds the items of a queue. When full, a buffer of double the size
+ is allocated - old buffers are left in the arena as a thief may still be reading from them.
+ */
+typedef struct WorkStealingBuffer
+{
+    int64_t capacity;
+    int64_t idx_mask;
+    atomic_int items[];
+} work_stealing_buffer_t;
+
+/**
+ A Chase-Lev work-stealing deque. The owning thread pushes and pops from the bottom, other threads
+ steal from the top.
+ */
 typedef struct WorkStealingDeque
 {
-    atomic_int top_idx;
-    atomic_int bottom_idx;
-    int idx_mask;
-    int items[WORK_STEALING_QUEUE_MAX_JOB_COUNT];
+    atomic_int_fast64_t top_idx;
+    atomic_int_fast64_t bottom_idx;
+    _Atomic(work_stealing_buffer_t*) buffer;
+    arena_t* arena;
 } work_stealing_queue_t;
 
+/**
+ Create a new work-stealing queue.
+ @param arena The arena used for allocating the queue buffers. Must outlive the queue.
+ @param queue_count The initial capacity of the queue - must be a power of two. The queue will
+ grow when this is exceeded.
+ */
 work_stealing_queue_t work_stealing_queue_init(arena_t* arena, uint32_t queue_count);
 
+/**
+ Push an item onto the bottom of the queue. Must only be called by the owning thread.
+ */
 void work_stealing_queue_push(work_stealing_queue_t* queue, int item);
 
+/**
+ Pop an item from the bottom of the queue. Must only be called by the owning thread.
+ @return The item, or INT32_MAX if the queue is empty.
+ */
 int work_stealing_queue_pop(work_stealing_queue_t* queue);
 
+/**
+ Steal an item from the top of the queue. Can be called from any thread.
+ @return The item, or INT32_MAX if the queue is empty.
+ */
 int work_stealing_queue_steal(work_stealing_queue_t* queue);
 
-#endif
\ No newline at end of file
+#endif
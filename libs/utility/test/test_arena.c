@@ -136,4 +136,59 @@ TEST(ArenaGroup, ArenaTests_DynamicArrayRemove)
     TEST_ASSERT_EQUAL_UINT(2, array.size);
     TEST_ASSERT_EQUAL_UINT(1, DYN_ARRAY_GET(int, &array, 0));
     TEST_ASSERT_EQUAL_UINT(6, DYN_ARRAY_GET(int, &array, 1));
-}
\ No newline at end of file
+}
+TEST(ArenaGroup, ArenaTests_ThreadArena)
+{
+    arena_t arena;
+    int err = arena_new(1 << 20, &arena);
+    TEST_ASSERT_EQUAL(ARENA_SUCCESS, err);
+
+    thread_arena_pool_t pool;
+    uint32_t chunk_size = 1024;
+    thread_arena_pool_init(&pool, &arena, 1 << 16, chunk_size);
+    TEST_ASSERT_EQUAL_UINT64(0, thread_arena_pool_current_size(&pool));
+
+    thread_arena_t ta1, ta2;
+    thread_arena_init(&ta1, &pool);
+    thread_arena_init(&ta2, &pool);
+
+    // Each thread arena takes its own chunk from the pool.
+    int* a = THREAD_ARENA_MAKE_ZERO_ARRAY(&ta1, int, 10);
+    int* b = THREAD_ARENA_MAKE_ZERO_ARRAY(&ta2, int, 10);
+    TEST_ASSERT_TRUE(a && b);
+    TEST_ASSERT_EQUAL_UINT64(2 * chunk_size, thread_arena_pool_current_size(&pool));
+    TEST_ASSERT_TRUE((uint8_t*)b >= (uint8_t*)a + chunk_size);
+
+    // Subsequent allocations come from the current chunk, suitably aligned.
+    uint8_t* c = THREAD_ARENA_MAKE_ARRAY(&ta1, uint8_t, 3, 0);
+    double* d = THREAD_ARENA_MAKE_ZERO_STRUCT(&ta1, double);
+    TEST_ASSERT_EQUAL_PTR((uint8_t*)a + 10 * sizeof(int), c);
+    TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)d % _Alignof(double));
+    TEST_ASSERT_EQUAL_UINT64(2 * chunk_size, thread_arena_pool_current_size(&pool));
+
+    // Filling the chunk takes a new one.
+    for (int i = 0; i < 6; ++i)
+    {
+        TEST_ASSERT_TRUE(thread_arena_alloc(&ta1, 1, 1, 200, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT64(3 * chunk_size, thread_arena_pool_current_size(&pool));
+
+    // Large allocations are taken from the pool directly.
+    uint8_t* large = thread_arena_alloc(&ta2, 1, 16, chunk_size * 2, ARENA_ZERO_MEMORY);
+    TEST_ASSERT_TRUE(large);
+    TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)large % 16);
+    TEST_ASSERT_EQUAL_UINT64(5 * chunk_size + 15, thread_arena_pool_current_size(&pool));
+
+    // A reset rewinds all thread arenas at once.
+    thread_arena_pool_reset(&pool);
+    TEST_ASSERT_EQUAL_UINT64(0, thread_arena_pool_current_size(&pool));
+    int* e = THREAD_ARENA_MAKE_ZERO_ARRAY(&ta2, int, 10);
+    TEST_ASSERT_EQUAL_PTR(pool.begin, e);
+    int* f = THREAD_ARENA_MAKE_ZERO_ARRAY(&ta1, int, 10);
+    TEST_ASSERT_EQUAL_PTR(pool.begin + chunk_size, f);
+
+    // Out of memory with the soft fail flag returns NULL.
+    TEST_ASSERT_NULL(thread_arena_alloc(&ta1, 1, 1, 1 << 17, ARENA_OUT_OF_MEM_SOFT_FAIL));
+
+    arena_release(&arena);
+}
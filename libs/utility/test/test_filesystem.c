@@ -29,4 +29,53 @@ TEST(FilesystemGroup, Filesystem_Extension)
     r = fs_get_extension(&path, &ext, &arena);
     TEST_ASSERT(r == true);
     TEST_ASSERT_EQUAL_STRING("h", ext.data);
-}
\ No newline at end of file
+}
+TEST(FilesystemGroup, Filesystem_WriteAtomic)
+{
+    const char* path = "fs_write_atomic_test.bin";
+    const char data1[] = "first version";
+    const char data2[] = "second";
+
+    TEST_ASSERT_TRUE(fs_write_file_atomic(path, data1, sizeof(data1)));
+    FILE* fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL_UINT(sizeof(data1), fs_get_file_size(fp));
+    fclose(fp);
+
+    // Overwriting replaces the whole file and leaves no temporary file behind.
+    TEST_ASSERT_TRUE(fs_write_file_atomic(path, data2, sizeof(data2)));
+    fp = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    char buffer[sizeof(data1)];
+    size_t sz = fread(buffer, 1, sizeof(buffer), fp);
+    fclose(fp);
+    TEST_ASSERT_EQUAL_UINT(sizeof(data2), sz);
+    TEST_ASSERT_EQUAL_STRING(data2, buffer);
+    TEST_ASSERT_NULL(fopen("fs_write_atomic_test.bin.tmp", "rb"));
+
+    // A directory that doesn't exist fails without touching anything.
+    TEST_ASSERT_FALSE(fs_write_file_atomic("no_such_dir/file.bin", data1, sizeof(data1)));
+
+    remove(path);
+}
+
+TEST(FilesystemGroup, Filesystem_MapFile)
+{
+    const char* path = "fs_map_test.bin";
+    const char data[] = "mapped file contents";
+    TEST_ASSERT_TRUE(fs_write_file_atomic(path, data, sizeof(data)));
+
+    fs_mapped_file_t m;
+    TEST_ASSERT_TRUE(fs_map_file(path, &m));
+    TEST_ASSERT_EQUAL_UINT(sizeof(data), m.size);
+    TEST_ASSERT_EQUAL_STRING(data, (const char*)m.data);
+    fs_unmap_file(&m);
+    TEST_ASSERT_NULL(m.data);
+
+    // Missing and empty files aren't mapped.
+    TEST_ASSERT_FALSE(fs_map_file("no_such_file.bin", &m));
+    TEST_ASSERT_TRUE(fs_write_file_atomic(path, data, 0));
+    TEST_ASSERT_FALSE(fs_map_file(path, &m));
+
+    remove(path);
+}
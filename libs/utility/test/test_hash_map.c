@@ -0,0 +1,206 @@
+#include "unity.h"
+#include "unity_fixture.h"
+#include "utility/arena.h"
+#include "utility/hash.h"
+#include "utility/hash_map.h"
+#include "utility/random.h"
+
+TEST_GROUP(HashMapGroup);
+
+TEST_SETUP(HashMapGroup) {}
+
+TEST_TEAR_DOWN(HashMapGroup) {}
+
+TEST(HashMapGroup, HashMap_GeneralTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 15;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    hash_map_t map = HASH_MAP_CREATE(int, float, &arena);
+    TEST_ASSERT(map.size == 0);
+
+    float vals[] = {1.0f, 2.0f, 4.0f, 10.0f};
+    int keys[] = {10, 20, 40, 100};
+    float* ret = HASH_MAP_INSERT(&map, &keys[0], &vals[0]);
+    TEST_ASSERT_NOT_NULL(ret);
+    TEST_ASSERT(map.size == 1);
+
+    ret = HASH_MAP_GET(&map, &keys[0]);
+    TEST_ASSERT_NOT_NULL(ret);
+    TEST_ASSERT(vals[0] == *ret);
+
+    HASH_MAP_INSERT(&map, &keys[1], &vals[1]);
+    HASH_MAP_INSERT(&map, &keys[2], &vals[2]);
+    HASH_MAP_INSERT(&map, &keys[3], &vals[3]);
+
+    // Inserting an existing key fails and leaves the value untouched.
+    TEST_ASSERT_NULL(HASH_MAP_INSERT(&map, &keys[1], &vals[3]));
+    ret = HASH_MAP_GET(&map, &keys[1]);
+    TEST_ASSERT(vals[1] == *ret);
+
+    TEST_ASSERT(HASH_MAP_FIND(&map, &keys[2]));
+    TEST_ASSERT(HASH_MAP_ERASE(&map, &keys[2]));
+    TEST_ASSERT_FALSE(HASH_MAP_FIND(&map, &keys[2]));
+    TEST_ASSERT_FALSE(HASH_MAP_ERASE(&map, &keys[2]));
+    TEST_ASSERT_NULL(HASH_MAP_GET(&map, &keys[2]));
+    TEST_ASSERT(map.size == 3);
+
+    HASH_MAP_INSERT(&map, &keys[2], &vals[2]);
+    TEST_ASSERT_TRUE(HASH_MAP_FIND(&map, &keys[2]));
+    TEST_ASSERT(map.size == 4);
+
+    float new_val = 88.8f;
+    HASH_MAP_SET(&map, &keys[2], &new_val);
+    ret = HASH_MAP_GET(&map, &keys[2]);
+    TEST_ASSERT_NOT_NULL(ret);
+    TEST_ASSERT(*ret == new_val);
+    TEST_ASSERT(map.size == 4);
+
+    hash_map_clear(&map);
+    TEST_ASSERT(map.size == 0);
+    for (int i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_FALSE(HASH_MAP_FIND(&map, &keys[i]));
+    }
+
+    arena_release(&arena);
+}
+
+TEST(HashMapGroup, HashMap_ResizeTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    hash_map_t map = HASH_MAP_CREATE(uint64_t, int, &arena);
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    uint64_t keys[10000];
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        keys[i] = xoro_rand_next(&rand);
+        HASH_MAP_INSERT(&map, &keys[i], &i);
+        int* res = HASH_MAP_GET(&map, &keys[i]);
+        TEST_ASSERT_NOT_NULL(res);
+        TEST_ASSERT_EQUAL(i, *res);
+    }
+    TEST_ASSERT_EQUAL_UINT(10000, map.size);
+    TEST_ASSERT(map.capacity - map.capacity / 8 >= map.size);
+
+    // All entries must still be reachable after multiple resizes.
+    for (int i = 0; i < 10000; ++i)
+    {
+        int* res = HASH_MAP_GET(&map, &keys[i]);
+        TEST_ASSERT_NOT_NULL(res);
+        TEST_ASSERT_EQUAL(i, *res);
+    }
+
+    // Reserving up-front should prevent any further growth.
+    hash_map_t map2 = HASH_MAP_CREATE_WITH_CAPACITY(uint64_t, int, &arena, 5000);
+    uint32_t capacity = map2.capacity;
+    for (int i = 0; i < 5000; ++i)
+    {
+        HASH_MAP_INSERT(&map2, &keys[i], &i);
+    }
+    TEST_ASSERT_EQUAL_UINT(capacity, map2.capacity);
+    hash_map_reserve(&map2, 10000);
+    TEST_ASSERT(map2.capacity > capacity);
+    for (int i = 0; i < 5000; ++i)
+    {
+        int* res = HASH_MAP_GET(&map2, &keys[i]);
+        TEST_ASSERT_NOT_NULL(res);
+        TEST_ASSERT_EQUAL(i, *res);
+    }
+
+    arena_release(&arena);
+}
+
+TEST(HashMapGroup, HashMap_EraseTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 20;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    hash_map_t map = HASH_MAP_CREATE(int, int, &arena);
+    uint32_t capacity = map.capacity;
+
+    // Continually inserting and erasing keys produces tombstones - these should be cleared by
+    // rehashing in place, rather than growing the map.
+    for (int i = 0; i < 100000; ++i)
+    {
+        int val = i * 2;
+        HASH_MAP_INSERT(&map, &i, &val);
+        if (i >= 8)
+        {
+            int old_key = i - 8;
+            TEST_ASSERT_TRUE(HASH_MAP_ERASE(&map, &old_key));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT(8, map.size);
+    TEST_ASSERT_EQUAL_UINT(capacity, map.capacity);
+    for (int i = 100000 - 8; i < 100000; ++i)
+    {
+        int* res = HASH_MAP_GET(&map, &i);
+        TEST_ASSERT_NOT_NULL(res);
+        TEST_ASSERT_EQUAL(i * 2, *res);
+    }
+    int key = 100000 - 9;
+    TEST_ASSERT_FALSE(HASH_MAP_FIND(&map, &key));
+
+    arena_release(&arena);
+}
+
+TEST(HashMapGroup, HashMap_IteratorTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 20;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    hash_map_t map = HASH_MAP_CREATE(int, int, &arena);
+    hash_map_iterator_t it = hash_map_iter_create(&map);
+    int* ret = hash_map_iter_next(&it);
+    TEST_ASSERT(ret == NULL);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        int val = i + 1000;
+        HASH_MAP_INSERT(&map, &i, &val);
+    }
+
+    // NOTE: unordered map so when iterating not necessarily in order.
+    int sum = 0;
+    uint32_t count = 0;
+    it = hash_map_iter_create(&map);
+    while ((ret = hash_map_iter_next(&it)))
+    {
+        int* key = hash_map_iter_key(&it);
+        TEST_ASSERT_EQUAL_INT(*key + 1000, *ret);
+        sum += *key;
+        ++count;
+    }
+    TEST_ASSERT_EQUAL_UINT(100, count);
+    TEST_ASSERT_EQUAL_INT(4950, sum);
+
+    // Erase all the odd keys using the iterator.
+    it = hash_map_iter_create(&map);
+    while ((ret = hash_map_iter_next(&it)))
+    {
+        int* key = hash_map_iter_key(&it);
+        if (*key & 1)
+        {
+            hash_map_iter_erase(&it);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT(50, map.size);
+    for (int i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT_EQUAL(!(i & 1), HASH_MAP_FIND(&map, &i));
+    }
+
+    arena_release(&arena);
+}
@@ -48,6 +48,16 @@ TEST(HashSetGroup, HashSet_GeneralTests)
     ret = HASH_SET_GET(&set, &keys[2]);
     TEST_ASSERT_NOT_NULL(ret);
     TEST_ASSERT(*ret == new_val);
+
+    // Values inserted with a precomputed hash.
+    uint64_t hash = 0xdeadbeefcafe;
+    TEST_ASSERT_NULL(hash_set_get_with_hash(&set, hash));
+    TEST_ASSERT_NOT_NULL(hash_set_insert_with_hash(&set, hash, &vals[3]));
+    TEST_ASSERT_NULL(hash_set_insert_with_hash(&set, hash, &vals[3]));
+    ret = hash_set_get_with_hash(&set, hash);
+    TEST_ASSERT_NOT_NULL(ret);
+    TEST_ASSERT(*ret == vals[3]);
+    TEST_ASSERT(set.size == 5);
 }
 
 TEST(HashSetGroup, HashSet_ResizeTests)
@@ -0,0 +1,111 @@
+#include "unity.h"
+#include "unity_fixture.h"
+#include "utility/arena.h"
+#include "utility/intern.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TEST_GROUP(InternGroup);
+
+TEST_SETUP(InternGroup) {}
+
+TEST_TEAR_DOWN(InternGroup) {}
+
+TEST(InternGroup, Intern_UniqueTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    intern_table_t t;
+    intern_table_init(&t, 2048, 1 << 16, &arena);
+    TEST_ASSERT_EQUAL_UINT(INTERN_ID_INVALID, intern_table_find(&t, "string0"));
+
+    char str[32];
+    for (int i = 0; i < 2000; ++i)
+    {
+        snprintf(str, sizeof(str), "string%i", i);
+        intern_id_t id = intern_table_add(&t, str);
+        TEST_ASSERT_EQUAL_UINT(i, id);
+        // The table holds its own copy of the string.
+        TEST_ASSERT(intern_table_get_string(&t, id) != str);
+    }
+    TEST_ASSERT_EQUAL_UINT(2000, intern_table_size(&t));
+
+    // Interning the same strings again gives the same ids.
+    for (int i = 0; i < 2000; ++i)
+    {
+        snprintf(str, sizeof(str), "string%i", i);
+        TEST_ASSERT_EQUAL_UINT(i, intern_table_add(&t, str));
+        TEST_ASSERT_EQUAL_UINT(i, intern_table_find(&t, str));
+        TEST_ASSERT_EQUAL_STRING(str, intern_table_get_string(&t, i));
+        TEST_ASSERT_EQUAL_UINT(strlen(str), intern_table_get_length(&t, i));
+        TEST_ASSERT(intern_hash(str, strlen(str)) == intern_table_get_hash(&t, i));
+    }
+    TEST_ASSERT_EQUAL_UINT(2000, intern_table_size(&t));
+
+    // Prefixes of an interned string are different strings.
+    intern_id_t id = intern_table_add(&t, "string1");
+    TEST_ASSERT(intern_table_add(&t, "string") != id);
+    TEST_ASSERT(intern_table_add(&t, "") != id);
+    TEST_ASSERT_EQUAL_UINT(2002, intern_table_size(&t));
+
+    arena_release(&arena);
+}
+
+TEST(InternGroup, Intern_CollisionTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 16, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    // A small table, so the probe sequences of the strings overlap.
+    intern_table_t t;
+    intern_table_init(&t, 8, 256, &arena);
+
+    // Strings with the same hash are still unique.
+    const char* strs[] = {"albedo", "normal", "depth", "colour"};
+    for (int i = 0; i < 4; ++i)
+    {
+        intern_id_t id = intern_table_add_with_hash(&t, strs[i], strlen(strs[i]), 0x1234);
+        TEST_ASSERT_EQUAL_UINT(i, id);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(
+            i, intern_table_find_with_hash(&t, strs[i], strlen(strs[i]), 0x1234));
+        TEST_ASSERT_EQUAL_STRING(strs[i], intern_table_get_string(&t, i));
+    }
+    TEST_ASSERT_EQUAL_UINT(
+        INTERN_ID_INVALID, intern_table_find_with_hash(&t, "shadow", 6, 0x1234));
+
+    // The same string with a different hash only matches on its own hash.
+    TEST_ASSERT_EQUAL_UINT(INTERN_ID_INVALID, intern_table_find(&t, "albedo"));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(i + 4, intern_table_add(&t, strs[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT(8, intern_table_size(&t));
+
+    arena_release(&arena);
+}
+
+TEST(InternGroup, Intern_GlobalTests)
+{
+    intern_id_t id = intern_string("intern_global_test");
+    TEST_ASSERT(id != INTERN_ID_INVALID);
+    TEST_ASSERT_EQUAL_UINT(id, intern_find("intern_global_test"));
+    TEST_ASSERT_EQUAL_STRING("intern_global_test", intern_get_string(id));
+    TEST_ASSERT_EQUAL_UINT(strlen("intern_global_test"), intern_get_length(id));
+    TEST_ASSERT(intern_hash("intern_global_test", 18) == intern_get_hash(id));
+    TEST_ASSERT_EQUAL_UINT(INTERN_ID_INVALID, intern_find("intern_global_missing"));
+
+    // The id is cached at the call site.
+    for (int i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(id, INTERN_LITERAL("intern_global_test"));
+    }
+    TEST_ASSERT(INTERN_LITERAL("intern_global_other") != id);
+}
@@ -5,6 +5,7 @@
 #include "utility/parallel_for.h"
 
 #include <stdatomic.h>
+#include <string.h>
 
 TEST_GROUP(JobQueueGroup);
 
@@ -130,4 +131,381 @@ TEST(JobQueueGroup, ParallelFor)
     }
 
     TEST_ASSERT_TRUE(success);
-}
\ No newline at end of file
+}
+
+TEST(JobQueueGroup, ParallelForChunked)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 8);
+    job_queue_adopt_thread(jq);
+
+    uint32_t* thread_res = calloc(100000, sizeof(uint32_t));
+    uint32_t counts[] = {0, 1, 63, 1000, 10007, 100000};
+    struct ChunkConfig configs[] = {
+        {0}, {.chunks_per_worker = 1, .min_chunk_size = 1}, {.item_size = sizeof(uint32_t)}};
+
+    for (uint32_t c = 0; c < sizeof(configs) / sizeof(struct ChunkConfig); ++c)
+    {
+        for (uint32_t i = 0; i < sizeof(counts) / sizeof(uint32_t); ++i)
+        {
+            uint32_t count = counts[i];
+            memset(thread_res, 0, 100000 * sizeof(uint32_t));
+
+            job_t* parent = job_queue_create_parent_job(jq);
+            job_t* job = parallel_for_chunked(
+                jq, parent, 0, count, test_parallel_for, thread_res, &configs[c], &arena);
+            job_queue_run_job(jq, job);
+            job_queue_run_and_wait(jq, parent);
+
+            bool success = true;
+            for (uint32_t j = 0; j < 100000; ++j)
+            {
+                success &= thread_res[j] == (j < count ? 1 : 0);
+            }
+            TEST_ASSERT_TRUE(success);
+        }
+    }
+
+    // Each worker only claims whole chunks, so a range not starting at zero must be respected.
+    memset(thread_res, 0, 100000 * sizeof(uint32_t));
+    job_t* job =
+        parallel_for_chunked(jq, NULL, 500, 5000, test_parallel_for, thread_res, NULL, &arena);
+    job_queue_run_and_wait(jq, job);
+    for (uint32_t j = 0; j < 6000; ++j)
+    {
+        TEST_ASSERT_EQUAL_UINT32(j >= 500 && j < 5500 ? 1 : 0, thread_res[j]);
+    }
+
+    job_queue_destroy(jq);
+    free(thread_res);
+    arena_release(&arena);
+}
+
+void test_reduce_sum(uint32_t start, uint32_t count, void* data, void* result)
+{
+    uint64_t* sum = result;
+    for (uint32_t i = start; i < start + count; ++i)
+    {
+        *sum += i;
+    }
+}
+
+void test_reduce_join(void* result, void* partial, void* data)
+{
+    *(uint64_t*)result += *(uint64_t*)partial;
+}
+
+TEST(JobQueueGroup, ParallelReduce)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 8);
+    job_queue_adopt_thread(jq);
+
+    uint32_t counts[] = {0, 1, 1000, 99999, 1000000};
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(uint32_t); ++i)
+    {
+        uint64_t count = counts[i];
+        uint64_t sum = 0;
+        job_t* job = parallel_reduce(
+            jq,
+            NULL,
+            0,
+            count,
+            test_reduce_sum,
+            test_reduce_join,
+            NULL,
+            &sum,
+            sizeof(uint64_t),
+            NULL,
+            &arena);
+        job_queue_run_and_wait(jq, job);
+
+        uint64_t expected = count ? count * (count - 1) / 2 : 0;
+        TEST_ASSERT_EQUAL_UINT64(expected, sum);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
+
+#define STRESS_SPAWNER_COUNT 1024
+#define STRESS_LEAF_COUNT 1024
+
+struct StressSpawner
+{
+    job_queue_t* jq;
+    job_t* job;
+    atomic_int* counter;
+};
+
+void stress_leaf_func(void* arg)
+{
+    atomic_int* counter = arg;
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
+void stress_spawner_func(void* arg)
+{
+    // Each spawner is the parent of its own leaf jobs, which are pushed from within the job.
+    struct StressSpawner* s = arg;
+    for (int i = 0; i < STRESS_LEAF_COUNT; ++i)
+    {
+        job_t* leaf = job_queue_create_job(s->jq, stress_leaf_func, s->counter, s->job);
+        job_queue_run_job(s->jq, leaf);
+    }
+}
+
+TEST(JobQueueGroup, JobQueue_StressTest)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 28;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 4);
+    job_queue_adopt_thread(jq);
+
+    struct StressSpawner* spawners = malloc(STRESS_SPAWNER_COUNT * sizeof(struct StressSpawner));
+    atomic_int counter;
+
+    // Run multiple "frames" - jobs from the previous frames must be recycled.
+    uint32_t job_slot_count = 0;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        atomic_store(&counter, 0);
+        job_t* root = job_queue_create_parent_job(jq);
+        for (int i = 0; i < STRESS_SPAWNER_COUNT; ++i)
+        {
+            spawners[i].jq = jq;
+            spawners[i].counter = &counter;
+            spawners[i].job = job_queue_create_job(jq, stress_spawner_func, &spawners[i], root);
+            job_queue_run_job(jq, spawners[i].job);
+        }
+        job_queue_run_and_wait(jq, root);
+
+        TEST_ASSERT_EQUAL_INT(STRESS_SPAWNER_COUNT * STRESS_LEAF_COUNT, atomic_load(&counter));
+
+        uint32_t slot_count = atomic_load(&jq->job_count);
+        if (frame > 0)
+        {
+            // Recycling should keep the pool from growing in proportion to the jobs run.
+            TEST_ASSERT(slot_count < job_slot_count * 2);
+        }
+        job_slot_count = slot_count;
+    }
+
+    job_queue_destroy(jq);
+    free(spawners);
+    arena_release(&arena);
+}
+
+TEST(JobQueueGroup, JobQueue_HandleTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 2);
+    job_queue_adopt_thread(jq);
+
+    counter = 0;
+    job_t* job = job_queue_create_job(jq, &thread_func2, NULL, NULL);
+    job_handle_t handle = job_queue_get_handle(job);
+    TEST_ASSERT(job_queue_get_job(jq, handle) == job);
+    TEST_ASSERT_NULL(job_queue_get_job(jq, JOB_QUEUE_NULL_HANDLE));
+
+    job_queue_run_and_wait(jq, job);
+    TEST_ASSERT_EQUAL_INT(1, counter);
+
+    // The job has been released to the pool, so the handle is now stale...
+    TEST_ASSERT_NULL(job_queue_get_job(jq, handle));
+
+    // ...even once the slot has been reused.
+    job_t* new_job = job_queue_create_job(jq, &thread_func2, NULL, NULL);
+    TEST_ASSERT(new_job == job);
+    TEST_ASSERT_NULL(job_queue_get_job(jq, handle));
+    TEST_ASSERT(job_queue_get_job(jq, job_queue_get_handle(new_job)) == new_job);
+    job_queue_run_and_wait(jq, new_job);
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
+
+struct GraphNode
+{
+    atomic_int* seq;
+    int order;
+};
+
+void graph_node_func(void* arg)
+{
+    struct GraphNode* node = arg;
+    node->order = atomic_fetch_add(node->seq, 1);
+}
+
+TEST(JobQueueGroup, JobQueue_DependencyDiamondTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 4);
+    job_queue_adopt_thread(jq);
+
+    for (int iter = 0; iter < 100; ++iter)
+    {
+        atomic_int seq = 0;
+        struct GraphNode nodes[4];
+        job_t* root = job_queue_create_parent_job(jq);
+        job_t* jobs[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            nodes[i].seq = &seq;
+            nodes[i].order = -1;
+            jobs[i] = job_queue_create_job(jq, graph_node_func, &nodes[i], root);
+        }
+        //     -> 1 -
+        // 0 -|      |-> 3
+        //     -> 2 -
+        job_queue_add_dependency(jq, jobs[0], jobs[1]);
+        job_queue_add_dependency(jq, jobs[0], jobs[2]);
+        job_queue_add_dependency(jq, jobs[1], jobs[3]);
+        job_queue_add_dependency(jq, jobs[2], jobs[3]);
+
+        // Run in reverse order - jobs with outstanding dependencies must be deferred.
+        for (int i = 3; i >= 0; --i)
+        {
+            job_queue_run_job(jq, jobs[i]);
+        }
+        job_queue_run_and_wait(jq, root);
+
+        TEST_ASSERT_EQUAL_INT(4, atomic_load(&seq));
+        TEST_ASSERT_EQUAL_INT(0, nodes[0].order);
+        TEST_ASSERT(nodes[1].order > nodes[0].order);
+        TEST_ASSERT(nodes[2].order > nodes[0].order);
+        TEST_ASSERT_EQUAL_INT(3, nodes[3].order);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
+
+#define FAN_IN_COUNT 256
+
+struct FanInSink
+{
+    atomic_int* counter;
+    int observed;
+};
+
+void fan_in_producer_func(void* arg)
+{
+    atomic_int* counter = arg;
+    atomic_fetch_add(counter, 1);
+}
+
+void fan_in_sink_func(void* arg)
+{
+    struct FanInSink* sink = arg;
+    sink->observed = atomic_load(sink->counter);
+}
+
+TEST(JobQueueGroup, JobQueue_DependencyFanInTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 25;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 4);
+    job_queue_adopt_thread(jq);
+
+    for (int iter = 0; iter < 20; ++iter)
+    {
+        // Many independent jobs feeding a single job, which is waited on directly.
+        atomic_int counter = 0;
+        struct FanInSink sink = {.counter = &counter, .observed = -1};
+        job_t* sink_job = job_queue_create_job(jq, fan_in_sink_func, &sink, NULL);
+        for (int i = 0; i < FAN_IN_COUNT; ++i)
+        {
+            job_t* job = job_queue_create_job(jq, fan_in_producer_func, &counter, NULL);
+            job_queue_add_dependency(jq, job, sink_job);
+            job_queue_run_job(jq, job);
+        }
+        job_queue_run_and_wait(jq, sink_job);
+        TEST_ASSERT_EQUAL_INT(FAN_IN_COUNT, sink.observed);
+
+        // A continuation of a parent job is only scheduled once all of its children complete.
+        atomic_store(&counter, 0);
+        sink.observed = -1;
+        job_t* group = job_queue_create_parent_job(jq);
+        job_t* cont = job_queue_create_continuation(jq, group, fan_in_sink_func, &sink, NULL);
+        for (int i = 0; i < FAN_IN_COUNT; ++i)
+        {
+            job_t* job = job_queue_create_job(jq, fan_in_producer_func, &counter, group);
+            job_queue_run_job(jq, job);
+        }
+        job_queue_run_job(jq, group);
+        job_queue_run_and_wait(jq, cont);
+        TEST_ASSERT_EQUAL_INT(FAN_IN_COUNT, sink.observed);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
+
+struct ThreadIndexParams
+{
+    job_queue_t* jq;
+    uint32_t* indices;
+    uint32_t index;
+};
+
+void thread_index_func(void* arg)
+{
+    struct ThreadIndexParams* params = arg;
+    params->indices[params->index] = job_queue_get_thread_index(params->jq);
+}
+
+TEST(JobQueueGroup, JobQueue_ThreadIndexTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 25, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 3);
+    job_queue_adopt_thread(jq);
+    uint32_t main_idx = job_queue_get_thread_index(jq);
+    TEST_ASSERT_TRUE(main_idx < JOB_QUEUE_MAX_THREAD_COUNT);
+
+    const uint32_t job_count = 256;
+    uint32_t indices[256];
+    struct ThreadIndexParams params[256];
+    job_t* parent = job_queue_create_parent_job(jq);
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        params[i] = (struct ThreadIndexParams){.jq = jq, .indices = indices, .index = i};
+        job_queue_run_job(jq, job_queue_create_job(jq, thread_index_func, &params[i], parent));
+    }
+    job_queue_run_and_wait(jq, parent);
+
+    // Indices are unique per thread, so only the workers and the adopted thread can appear.
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        TEST_ASSERT_TRUE(indices[i] < JOB_QUEUE_MAX_THREAD_COUNT);
+        TEST_ASSERT_TRUE(indices[i] < jq->thread_count || indices[i] == main_idx);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
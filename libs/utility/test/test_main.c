@@ -17,6 +17,7 @@ TEST_GROUP_RUNNER(ArenaGroup)
     RUN_TEST_CASE(ArenaGroup, ArenaTests_DynamicArray)
     RUN_TEST_CASE(ArenaGroup, ArenaTests_DynamicArrayWithChar)
     RUN_TEST_CASE(ArenaGroup, ArenaTests_DynamicArrayRemove)
+    RUN_TEST_CASE(ArenaGroup, ArenaTests_ThreadArena)
 }
 
 TEST_GROUP_RUNNER(HashSetGroup)
@@ -26,16 +27,32 @@ TEST_GROUP_RUNNER(HashSetGroup)
     RUN_TEST_CASE(HashSetGroup, HashSet_IteratorTests)
 }
 
+TEST_GROUP_RUNNER(HashMapGroup)
+{
+    RUN_TEST_CASE(HashMapGroup, HashMap_GeneralTests)
+    RUN_TEST_CASE(HashMapGroup, HashMap_ResizeTests)
+    RUN_TEST_CASE(HashMapGroup, HashMap_EraseTests)
+    RUN_TEST_CASE(HashMapGroup, HashMap_IteratorTests)
+}
+
 TEST_GROUP_RUNNER(JobQueueGroup)
 {
     RUN_TEST_CASE(JobQueueGroup, JobQueue_GeneralTests)
     RUN_TEST_CASE(JobQueueGroup, JobQueue_JobWithChildrenTests)
     RUN_TEST_CASE(JobQueueGroup, ParallelFor)
+    RUN_TEST_CASE(JobQueueGroup, ParallelForChunked)
+    RUN_TEST_CASE(JobQueueGroup, ParallelReduce)
+    RUN_TEST_CASE(JobQueueGroup, JobQueue_StressTest)
+    RUN_TEST_CASE(JobQueueGroup, JobQueue_HandleTests)
+    RUN_TEST_CASE(JobQueueGroup, JobQueue_DependencyDiamondTests)
+    RUN_TEST_CASE(JobQueueGroup, JobQueue_DependencyFanInTests)
+    RUN_TEST_CASE(JobQueueGroup, JobQueue_ThreadIndexTests)
 }
 
 TEST_GROUP_RUNNER(WorkStealingQueueGroup)
 {
     RUN_TEST_CASE(WorkStealingQueueGroup, WorkStealingQueue_GeneralTests)
+    RUN_TEST_CASE(WorkStealingQueueGroup, WorkStealingQueue_GrowTests)
 }
 
 TEST_GROUP_RUNNER(MathGroup)
@@ -55,11 +72,30 @@ TEST_GROUP_RUNNER(StringGroup)
 TEST_GROUP_RUNNER(FilesystemGroup)
 {
     RUN_TEST_CASE(FilesystemGroup, Filesystem_Extension)
+    RUN_TEST_CASE(FilesystemGroup, Filesystem_WriteAtomic)
+    RUN_TEST_CASE(FilesystemGroup, Filesystem_MapFile)
 }
 
 TEST_GROUP_RUNNER(SortGroup)
 {
     RUN_TEST_CASE(SortGroup, RadixSortTest)
+    RUN_TEST_CASE(SortGroup, RadixSortKeysTest)
+    RUN_TEST_CASE(SortGroup, RadixSortKeysMtTest)
+}
+
+TEST_GROUP_RUNNER(OffsetAllocGroup)
+{
+    RUN_TEST_CASE(OffsetAllocGroup, OffsetAlloc_GeneralTests)
+    RUN_TEST_CASE(OffsetAllocGroup, OffsetAlloc_FragmentationTests)
+    RUN_TEST_CASE(OffsetAllocGroup, OffsetAlloc_GrowTests)
+    RUN_TEST_CASE(OffsetAllocGroup, OffsetAlloc_RandomTests)
+}
+
+TEST_GROUP_RUNNER(InternGroup)
+{
+    RUN_TEST_CASE(InternGroup, Intern_UniqueTests)
+    RUN_TEST_CASE(InternGroup, Intern_CollisionTests)
+    RUN_TEST_CASE(InternGroup, Intern_GlobalTests)
 }
 
 static void run_all_tests()
@@ -68,12 +104,15 @@ static void run_all_tests()
     RUN_TEST_GROUP(ArenaGroup)
     RUN_TEST_GROUP(VectorGroup)
     RUN_TEST_GROUP(HashSetGroup)
+    RUN_TEST_GROUP(HashMapGroup)
     RUN_TEST_GROUP(JobQueueGroup)
     RUN_TEST_GROUP(WorkStealingQueueGroup)
     RUN_TEST_GROUP(MathGroup)
     RUN_TEST_GROUP(StringGroup)
     RUN_TEST_GROUP(FilesystemGroup)
     RUN_TEST_GROUP(SortGroup)
+    RUN_TEST_GROUP(OffsetAllocGroup)
+    RUN_TEST_GROUP(InternGroup)
 }
 // clang-format on
 
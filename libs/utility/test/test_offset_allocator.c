@@ -0,0 +1,196 @@
+#include "unity.h"
+#include "unity_fixture.h"
+#include "utility/arena.h"
+#include "utility/offset_allocator.h"
+#include "utility/random.h"
+
+#include <string.h>
+
+TEST_GROUP(OffsetAllocGroup);
+
+TEST_SETUP(OffsetAllocGroup) {}
+
+TEST_TEAR_DOWN(OffsetAllocGroup) {}
+
+TEST(OffsetAllocGroup, OffsetAlloc_GeneralTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    offset_allocator_t a;
+    offset_alloc_init(&a, 1000, &arena);
+    TEST_ASSERT_EQUAL_UINT32(1000, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(1000, offset_alloc_largest_free(&a));
+
+    offset_alloc_t a0 = offset_alloc_allocate(&a, 100);
+    offset_alloc_t a1 = offset_alloc_allocate(&a, 1);
+    offset_alloc_t a2 = offset_alloc_allocate(&a, 333);
+    TEST_ASSERT_EQUAL_UINT32(0, a0.offset);
+    TEST_ASSERT_EQUAL_UINT32(100, a1.offset);
+    TEST_ASSERT_EQUAL_UINT32(101, a2.offset);
+    TEST_ASSERT_EQUAL_UINT32(566, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(3, a.alloc_count);
+
+    // Too large for the remaining space.
+    offset_alloc_t fail = offset_alloc_allocate(&a, 567);
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_INVALID, fail.offset);
+
+    // Freeing everything merges the ranges back into one.
+    offset_alloc_free(&a, a1);
+    offset_alloc_free(&a, a0);
+    offset_alloc_free(&a, a2);
+    TEST_ASSERT_EQUAL_UINT32(1000, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(1000, offset_alloc_largest_free(&a));
+    TEST_ASSERT_EQUAL_UINT32(0, a.alloc_count);
+
+    offset_alloc_t all = offset_alloc_allocate(&a, 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, all.offset);
+    TEST_ASSERT_EQUAL_UINT32(0, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_INVALID, offset_alloc_allocate(&a, 1).offset);
+
+    offset_alloc_reset(&a);
+    TEST_ASSERT_EQUAL_UINT32(1000, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(0, a.alloc_count);
+
+    arena_release(&arena);
+}
+
+TEST(OffsetAllocGroup, OffsetAlloc_FragmentationTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    offset_allocator_t a;
+    offset_alloc_init(&a, 1024, &arena);
+    offset_alloc_t allocs[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        allocs[i] = offset_alloc_allocate(&a, 64);
+        TEST_ASSERT_EQUAL_UINT32(i * 64, allocs[i].offset);
+    }
+
+    // Free every other range - half the space is free but no range larger than 64 exists.
+    for (int i = 0; i < 16; i += 2)
+    {
+        offset_alloc_free(&a, allocs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(512, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(64, offset_alloc_largest_free(&a));
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_INVALID, offset_alloc_allocate(&a, 65).offset);
+
+    // A freed range is reused.
+    offset_alloc_t reuse = offset_alloc_allocate(&a, 64);
+    TEST_ASSERT(reuse.offset % 128 == 0);
+    offset_alloc_free(&a, reuse);
+
+    // Freeing the ranges in between merges neighbours on both sides.
+    offset_alloc_free(&a, allocs[1]);
+    offset_alloc_free(&a, allocs[3]);
+    TEST_ASSERT_EQUAL_UINT32(64 * 5, offset_alloc_largest_free(&a));
+    offset_alloc_t merged = offset_alloc_allocate(&a, 64 * 5);
+    TEST_ASSERT_EQUAL_UINT32(0, merged.offset);
+
+    // Smaller requests are taken from the smallest bin which fits, splitting the range.
+    offset_alloc_free(&a, allocs[7]);
+    offset_alloc_t small = offset_alloc_allocate(&a, 10);
+    TEST_ASSERT(small.offset >= 10 * 64 && small.offset % 64 == 0);
+    TEST_ASSERT_EQUAL_UINT32(64 * 3 - 10 + 64 * 3, a.free_space);
+
+    arena_release(&arena);
+}
+
+TEST(OffsetAllocGroup, OffsetAlloc_GrowTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    offset_allocator_t a;
+    offset_alloc_init(&a, 0, &arena);
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_INVALID, offset_alloc_allocate(&a, 1).offset);
+
+    offset_alloc_grow(&a, 100);
+    offset_alloc_t a0 = offset_alloc_allocate(&a, 60);
+    TEST_ASSERT_EQUAL_UINT32(0, a0.offset);
+
+    // The free range at the end is extended.
+    offset_alloc_grow(&a, 200);
+    TEST_ASSERT_EQUAL_UINT32(140, offset_alloc_largest_free(&a));
+    offset_alloc_t a1 = offset_alloc_allocate(&a, 140);
+    TEST_ASSERT_EQUAL_UINT32(60, a1.offset);
+
+    // The end of the space is in use, so a new range is added after it.
+    offset_alloc_grow(&a, 300);
+    offset_alloc_t a2 = offset_alloc_allocate(&a, 100);
+    TEST_ASSERT_EQUAL_UINT32(200, a2.offset);
+
+    offset_alloc_free(&a, a1);
+    offset_alloc_free(&a, a2);
+    offset_alloc_free(&a, a0);
+    TEST_ASSERT_EQUAL_UINT32(300, offset_alloc_largest_free(&a));
+    offset_alloc_grow(&a, 400);
+    TEST_ASSERT_EQUAL_UINT32(400, offset_alloc_largest_free(&a));
+
+    arena_release(&arena);
+}
+
+TEST(OffsetAllocGroup, OffsetAlloc_RandomTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 22, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+#define OFFSET_ALLOC_TEST_SPACE (1 << 16)
+#define OFFSET_ALLOC_TEST_SLOTS 256
+
+    offset_allocator_t a;
+    offset_alloc_init(&a, OFFSET_ALLOC_TEST_SPACE, &arena);
+    uint8_t* owners = ARENA_MAKE_ZERO_ARRAY(&arena, uint8_t, OFFSET_ALLOC_TEST_SPACE);
+    offset_alloc_t allocs[OFFSET_ALLOC_TEST_SLOTS];
+    uint32_t sizes[OFFSET_ALLOC_TEST_SLOTS] = {0};
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint32_t slot = (uint32_t)(xoro_rand_next(&rand) % OFFSET_ALLOC_TEST_SLOTS);
+        if (sizes[slot])
+        {
+            offset_alloc_free(&a, allocs[slot]);
+            memset(owners + allocs[slot].offset, 0, sizes[slot]);
+            sizes[slot] = 0;
+            continue;
+        }
+        uint32_t size = 1 + (uint32_t)(xoro_rand_next(&rand) % 1024);
+        offset_alloc_t alloc = offset_alloc_allocate(&a, size);
+        if (alloc.offset == OFFSET_ALLOC_INVALID)
+        {
+            continue;
+        }
+        // No range is ever handed out twice.
+        TEST_ASSERT(alloc.offset + size <= OFFSET_ALLOC_TEST_SPACE);
+        for (uint32_t j = 0; j < size; ++j)
+        {
+            TEST_ASSERT_EQUAL_UINT(0, owners[alloc.offset + j]);
+        }
+        memset(owners + alloc.offset, 1, size);
+        allocs[slot] = alloc;
+        sizes[slot] = size;
+    }
+
+    uint32_t used = 0;
+    for (int i = 0; i < OFFSET_ALLOC_TEST_SLOTS; ++i)
+    {
+        used += sizes[i];
+        if (sizes[i])
+        {
+            offset_alloc_free(&a, allocs[i]);
+        }
+    }
+    TEST_ASSERT(used > 0);
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_TEST_SPACE, a.free_space);
+    TEST_ASSERT_EQUAL_UINT32(OFFSET_ALLOC_TEST_SPACE, offset_alloc_largest_free(&a));
+
+    arena_release(&arena);
+}
@@ -1,5 +1,7 @@
 #include "unity.h"
 #include "unity_fixture.h"
+#include "utility/job_queue.h"
+#include "utility/random.h"
 #include "utility/sort.h"
 
 TEST_GROUP(SortGroup);
@@ -51,4 +53,99 @@ TEST(SortGroup, RadixSortTest)
     {
         TEST_ASSERT_EQUAL_UINT(expected4[i], out4[i]);
     }
-}
\ No newline at end of file
+}
+static bool keys_sorted_and_stable(uint64_t* keys, uint32_t* indices, uint64_t* orig, size_t sz)
+{
+    for (size_t i = 0; i < sz; ++i)
+    {
+        if (orig[indices[i]] != keys[i])
+        {
+            return false;
+        }
+        if (i > 0 &&
+            (keys[i - 1] > keys[i] || (keys[i - 1] == keys[i] && indices[i - 1] > indices[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fill_keys(uint64_t* keys, uint64_t* orig, uint32_t* indices, size_t sz, uint64_t mask)
+{
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    for (size_t i = 0; i < sz; ++i)
+    {
+        keys[i] = xoro_rand_next(&rand) & mask;
+        orig[i] = keys[i];
+        indices[i] = (uint32_t)i;
+    }
+}
+
+TEST(SortGroup, RadixSortKeysTest)
+{
+    arena_t arena;
+    int res = arena_new(1 << 24, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    const size_t sz = 10000;
+    uint64_t* keys = ARENA_MAKE_ARRAY(&arena, uint64_t, sz * 3, 0);
+    uint32_t* indices = ARENA_MAKE_ARRAY(&arena, uint32_t, sz * 2, 0);
+    uint64_t* orig = keys + sz * 2;
+
+    // Full width keys - every pass is required.
+    fill_keys(keys, orig, indices, sz, UINT64_MAX);
+    radix_sort_keys(keys, indices, sz, keys + sz, indices + sz);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, sz));
+
+    // Only a few bits set, so most passes are skipped and there are many duplicates to check
+    // the sort is stable. An odd number of passes checks the result is copied back.
+    fill_keys(keys, orig, indices, sz, 0x00ff0000ff00000fULL);
+    radix_sort_keys(keys, indices, sz, keys + sz, indices + sz);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, sz));
+
+    fill_keys(keys, orig, indices, sz, 0xff00ff0000000000ULL);
+    radix_sort_keys(keys, indices, sz, keys + sz, indices + sz);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, sz));
+
+    // All keys equal - no passes run and the order is unchanged.
+    fill_keys(keys, orig, indices, sz, 0);
+    radix_sort_keys(keys, indices, sz, keys + sz, indices + sz);
+    for (uint32_t i = 0; i < sz; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT32(i, indices[i]);
+    }
+
+    arena_release(&arena);
+}
+
+TEST(SortGroup, RadixSortKeysMtTest)
+{
+    arena_t arena;
+    int res = arena_new(1 << 26, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    job_queue_t* jq = job_queue_init(&arena, 4);
+    job_queue_adopt_thread(jq);
+
+    const size_t sz = RADIX_SORT_MIN_BLOCK_SIZE * 8 + 123;
+    uint64_t* keys = ARENA_MAKE_ARRAY(&arena, uint64_t, sz * 3, 0);
+    uint32_t* indices = ARENA_MAKE_ARRAY(&arena, uint32_t, sz * 2, 0);
+    uint64_t* orig = keys + sz * 2;
+
+    fill_keys(keys, orig, indices, sz, UINT64_MAX);
+    radix_sort_keys_mt(jq, keys, indices, sz, keys + sz, indices + sz, &arena);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, sz));
+
+    fill_keys(keys, orig, indices, sz, 0x00ff00000000000fULL);
+    radix_sort_keys_mt(jq, keys, indices, sz, keys + sz, indices + sz, &arena);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, sz));
+
+    // Too few keys to split - falls back to the single threaded sort.
+    fill_keys(keys, orig, indices, 100, UINT64_MAX);
+    radix_sort_keys_mt(jq, keys, indices, 100, keys + sz, indices + sz, &arena);
+    TEST_ASSERT_TRUE(keys_sorted_and_stable(keys, indices, orig, 100));
+
+    job_queue_destroy(jq);
+    arena_release(&arena);
+}
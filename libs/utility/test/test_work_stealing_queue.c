@@ -40,4 +40,57 @@ TEST(WorkStealingQueueGroup, WorkStealingQueue_GeneralTests)
         res = work_stealing_queue_steal(&queue);
         TEST_ASSERT_EQUAL_INT(i, res);
     }
-}
\ No newline at end of file
+}
+
+TEST(WorkStealingQueueGroup, WorkStealingQueue_GrowTests)
+{
+    arena_t arena;
+    uint64_t arena_cap = 1 << 20;
+    int res = arena_new(arena_cap, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    // Start with a small queue so it has to grow multiple times.
+    int work_size = 10000;
+    work_stealing_queue_t queue = work_stealing_queue_init(&arena, 16);
+
+    for (int i = 0; i < work_size; ++i)
+    {
+        work_stealing_queue_push(&queue, i);
+    }
+    TEST_ASSERT(queue.buffer->capacity >= work_size);
+
+    // Steal half, pop the rest - the order must be preserved across the grown buffers.
+    for (int i = 0; i < work_size / 2; ++i)
+    {
+        res = work_stealing_queue_steal(&queue);
+        TEST_ASSERT_EQUAL_INT(i, res);
+    }
+    for (int i = work_size - 1; i >= work_size / 2; --i)
+    {
+        res = work_stealing_queue_pop(&queue);
+        TEST_ASSERT_EQUAL_INT(i, res);
+    }
+    TEST_ASSERT_EQUAL_INT(INT32_MAX, work_stealing_queue_pop(&queue));
+    TEST_ASSERT_EQUAL_INT(INT32_MAX, work_stealing_queue_steal(&queue));
+
+    // Growing with items wrapped around the buffer.
+    work_stealing_queue_t queue2 = work_stealing_queue_init(&arena, 16);
+    for (int i = 0; i < 12; ++i)
+    {
+        work_stealing_queue_push(&queue2, i);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT_EQUAL_INT(i, work_stealing_queue_steal(&queue2));
+    }
+    for (int i = 12; i < 40; ++i)
+    {
+        work_stealing_queue_push(&queue2, i);
+    }
+    for (int i = 10; i < 40; ++i)
+    {
+        TEST_ASSERT_EQUAL_INT(i, work_stealing_queue_steal(&queue2));
+    }
+
+    arena_release(&arena);
+}
@@ -0,0 +1,104 @@
+#include <render_graph/backboard.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/hash.h>
+#include <utility/hash_set.h>
+#include <utility/intern.h>
+
+#include <assert.h>
+#include <stdio.h>
+
+// The number of times each entry is read per frame - most resources are read by a couple of passes.
+#define BM_BACKBOARD_READ_COUNT 2
+#define BM_BACKBOARD_MAX_NAME_LENGTH 32
+
+struct BackboardName
+{
+    char str[BM_BACKBOARD_MAX_NAME_LENGTH];
+};
+
+struct BackboardBenchmark
+{
+    arena_t arena;
+    uint32_t count;
+    struct BackboardName* names;
+    intern_id_t* ids;
+};
+
+void setup_backboard_benchmark(struct BackboardBenchmark* bm, uint32_t count)
+{
+    int res = arena_new(1 << 24, &bm->arena);
+    assert(res == ARENA_SUCCESS);
+    bm->count = count;
+    bm->names = ARENA_MAKE_ARRAY(&bm->arena, struct BackboardName, count, 0);
+    bm->ids = ARENA_MAKE_ARRAY(&bm->arena, intern_id_t, count, 0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        snprintf(bm->names[i].str, BM_BACKBOARD_MAX_NAME_LENGTH, "BackboardResource%u", i);
+        // Interned once, as with the call site cache of INTERN_LITERAL.
+        bm->ids[i] = intern_string(bm->names[i].str);
+    }
+}
+
+// The backboard as it was before interning - keyed by the string, which is hashed on every add
+// and get.
+void BM_test_backboard_string(bm_run_state_t* state)
+{
+    struct BackboardBenchmark bm;
+    setup_backboard_benchmark(&bm, state->arg);
+    hash_set_t set =
+        hash_set_create(&bm.arena, murmur2_hash_string, sizeof(const char*), sizeof(rg_handle_t));
+
+    while (bm_state_set_running(state))
+    {
+        // A single frame of setup.
+        hash_set_clear(&set);
+        for (uint32_t i = 0; i < bm.count; ++i)
+        {
+            rg_handle_t h = {.id = i};
+            hash_set_insert(&set, bm.names[i].str, &h);
+        }
+        uint32_t sum = 0;
+        for (uint32_t r = 0; r < BM_BACKBOARD_READ_COUNT; ++r)
+        {
+            for (uint32_t i = 0; i < bm.count; ++i)
+            {
+                rg_handle_t* h = hash_set_get(&set, bm.names[i].str);
+                sum += h->id;
+            }
+        }
+        BM_DONT_OPTIMISE(sum);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_backboard_string, 32, 512);
+
+void BM_test_backboard_interned(bm_run_state_t* state)
+{
+    struct BackboardBenchmark bm;
+    setup_backboard_benchmark(&bm, state->arg);
+    rg_backboard_t bb = rg_backboard_init(&bm.arena);
+
+    while (bm_state_set_running(state))
+    {
+        rg_backboard_reset(&bb);
+        for (uint32_t i = 0; i < bm.count; ++i)
+        {
+            rg_handle_t h = {.id = i};
+            rg_backboard_add(&bb, bm.ids[i], h);
+        }
+        uint32_t sum = 0;
+        for (uint32_t r = 0; r < BM_BACKBOARD_READ_COUNT; ++r)
+        {
+            for (uint32_t i = 0; i < bm.count; ++i)
+            {
+                sum += rg_backboard_get(&bb, bm.ids[i]).id;
+            }
+        }
+        BM_DONT_OPTIMISE(sum);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_backboard_interned, 32, 512);
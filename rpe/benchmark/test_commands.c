@@ -0,0 +1,167 @@
+#include <commands.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/job_queue.h>
+#include <utility/parallel_for.h>
+#include <utility/random.h>
+
+#include <assert.h>
+
+#define BM_COMMANDS_POOL_SIZE (1 << 26)
+#define BM_COMMANDS_THREAD_COUNT 4
+#define BM_COMMANDS_RECORD_COST 256
+
+struct CommandsBenchmark
+{
+    arena_t arena;
+    arena_t scratch_arena;
+    job_queue_t* jq;
+    rpe_cmd_bucket_t* bucket;
+    uint64_t* keys;
+    uint32_t count;
+    DispatchFunction dispatch_func;
+};
+
+// Only the cost of the bucket is measured - nothing is recorded.
+void bm_null_dispatch(vkapi_driver_t* driver, void* data) {}
+
+// Stands in for the driver cost of recording a draw, which the parallel submit spreads over the
+// workers.
+void bm_record_dispatch(vkapi_driver_t* driver, void* data)
+{
+    struct DrawCommand* cmd = (struct DrawCommand*)data;
+    uint32_t hash = cmd->start_vertex;
+    for (uint32_t i = 0; i < BM_COMMANDS_RECORD_COST; ++i)
+    {
+        hash = hash * 31 + cmd->vertex_count;
+    }
+    BM_DONT_OPTIMISE(hash);
+}
+
+VkCommandBuffer bm_recorder_begin(vkapi_driver_t* driver, uint32_t worker_idx, void* data)
+{
+    return VK_NULL_HANDLE;
+}
+
+void bm_recorder_end(vkapi_driver_t* driver, VkCommandBuffer cmds, void* data) {}
+
+void bm_recorder_execute(vkapi_driver_t* driver, VkCommandBuffer* cmds, uint32_t count, void* data)
+{
+}
+
+void setup_commands_benchmark(struct CommandsBenchmark* bm, uint32_t count)
+{
+    int res = arena_new(1 << 30, &bm->arena);
+    assert(res == ARENA_SUCCESS);
+    res = arena_new(1 << 20, &bm->scratch_arena);
+    assert(res == ARENA_SUCCESS);
+    bm->count = count;
+    bm->dispatch_func = bm_null_dispatch;
+    bm->jq = job_queue_init(&bm->arena, BM_COMMANDS_THREAD_COUNT);
+    job_queue_adopt_thread(bm->jq);
+    bm->bucket = rpe_command_bucket_init(BM_COMMANDS_POOL_SIZE, bm->jq, &bm->arena);
+
+    // Keys are not in draw order, so the bucket has to be sorted before submitting.
+    bm->keys = ARENA_MAKE_ARRAY(&bm->arena, uint64_t, count, 0);
+    xoro_rand_t r = xoro_rand_init(0xff, 0x1234);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        bm->keys[i] = xoro_rand_next(&r);
+    }
+}
+
+void destroy_commands_benchmark(struct CommandsBenchmark* bm)
+{
+    job_queue_destroy(bm->jq);
+    arena_release(&bm->scratch_arena);
+    arena_release(&bm->arena);
+}
+
+void record_draw_packets(uint32_t start, uint32_t count, void* data)
+{
+    struct CommandsBenchmark* bm = (struct CommandsBenchmark*)data;
+    for (uint32_t i = start; i < start + count; ++i)
+    {
+        rpe_cmd_packet_t* pkt = rpe_command_bucket_add_command(
+            bm->bucket, bm->keys[i], 0, sizeof(struct DrawCommand), bm->dispatch_func);
+        struct DrawCommand* cmd = pkt->cmds;
+        cmd->vertex_count = 3;
+        cmd->start_vertex = i;
+    }
+}
+
+void BM_test_cmd_bucket_record_submit(bm_run_state_t* state)
+{
+    struct CommandsBenchmark bm;
+    setup_commands_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        record_draw_packets(0, bm.count, &bm);
+        rpe_command_bucket_submit(bm.bucket, NULL);
+        BM_DONT_OPTIMISE(bm.bucket->packet_offsets);
+        rpe_command_bucket_reset(bm.bucket);
+    }
+    destroy_commands_benchmark(&bm);
+}
+
+BENCHMARK_ARG2(BM_test_cmd_bucket_record_submit, 10000, 100000);
+
+// The packets are written from all job queue threads, each into its own stream of the bucket.
+void BM_test_cmd_bucket_record_submit_mt(bm_run_state_t* state)
+{
+    struct CommandsBenchmark bm;
+    setup_commands_benchmark(&bm, state->arg);
+    struct ChunkConfig cfg = {.min_chunk_size = 256};
+    while (bm_state_set_running(state))
+    {
+        job_t* job = parallel_for_chunked(
+            bm.jq, NULL, 0, bm.count, record_draw_packets, &bm, &cfg, &bm.scratch_arena);
+        job_queue_run_and_wait(bm.jq, job);
+        rpe_command_bucket_submit(bm.bucket, NULL);
+        BM_DONT_OPTIMISE(bm.bucket->packet_offsets);
+        rpe_command_bucket_reset(bm.bucket);
+        arena_reset(&bm.scratch_arena);
+    }
+    destroy_commands_benchmark(&bm);
+}
+
+BENCHMARK_ARG2(BM_test_cmd_bucket_record_submit_mt, 10000, 100000);
+
+// Packets are recorded on the calling thread, so only the submit differs between the serial and
+// parallel benchmarks.
+void BM_test_cmd_bucket_submit_serial(bm_run_state_t* state)
+{
+    struct CommandsBenchmark bm;
+    setup_commands_benchmark(&bm, state->arg);
+    bm.dispatch_func = bm_record_dispatch;
+    while (bm_state_set_running(state))
+    {
+        record_draw_packets(0, bm.count, &bm);
+        rpe_command_bucket_submit(bm.bucket, NULL);
+        BM_DONT_OPTIMISE(bm.bucket->packet_offsets);
+        rpe_command_bucket_reset(bm.bucket);
+    }
+    destroy_commands_benchmark(&bm);
+}
+
+BENCHMARK_ARG2(BM_test_cmd_bucket_submit_serial, 1000, 10000);
+
+void BM_test_cmd_bucket_submit_parallel(bm_run_state_t* state)
+{
+    struct CommandsBenchmark bm;
+    setup_commands_benchmark(&bm, state->arg);
+    bm.dispatch_func = bm_record_dispatch;
+    rpe_cmd_recorder_t rec = {
+        .begin = bm_recorder_begin, .end = bm_recorder_end, .execute = bm_recorder_execute};
+    while (bm_state_set_running(state))
+    {
+        record_draw_packets(0, bm.count, &bm);
+        rpe_command_bucket_submit_mt(bm.bucket, NULL, bm.jq, &rec, &bm.scratch_arena);
+        BM_DONT_OPTIMISE(bm.bucket->packet_offsets);
+        rpe_command_bucket_reset(bm.bucket);
+        arena_reset(&bm.scratch_arena);
+    }
+    destroy_commands_benchmark(&bm);
+}
+
+BENCHMARK_ARG2(BM_test_cmd_bucket_submit_parallel, 1000, 10000);
@@ -0,0 +1,172 @@
+#include <render_graph/dependency_graph.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+
+#include <assert.h>
+
+// The resources each synthetic pass reads from the previous passes.
+#define BM_DEP_GRAPH_READ_COUNT 2
+
+struct DepGraphBenchmark
+{
+    arena_t arena;
+    arena_t frame_arena;
+    rg_dep_graph_t* dg;
+    size_t pass_count;
+};
+
+void setup_dep_graph_benchmark(struct DepGraphBenchmark* bm, size_t pass_count)
+{
+    int res = arena_new(1 << 26, &bm->arena);
+    assert(res == ARENA_SUCCESS);
+    res = arena_new(1 << 28, &bm->frame_arena);
+    assert(res == ARENA_SUCCESS);
+    bm->dg = rg_dep_graph_init(&bm->arena);
+    bm->pass_count = pass_count;
+}
+
+// Each pass reads from resources written by earlier passes and writes a resource of its own. Only
+// the final pass has a side effect, so passes whose resources are never read are culled.
+void build_synthetic_graph(struct DepGraphBenchmark* bm)
+{
+    rg_dep_graph_t* dg = bm->dg;
+    arena_t* arena = &bm->frame_arena;
+    arena_reset(arena);
+    rg_dep_graph_clear(dg);
+
+    rg_node_t** resources = ARENA_MAKE_ARRAY(arena, rg_node_t*, bm->pass_count, 0);
+    for (size_t i = 0; i < bm->pass_count; ++i)
+    {
+        rg_node_t* pass = rg_node_init(dg, INTERN_LITERAL("pass"), arena);
+        for (size_t j = 1; j <= BM_DEP_GRAPH_READ_COUNT && j <= i; ++j)
+        {
+            // Read from the previous pass and one further back.
+            size_t src = j == 1 ? i - 1 : (i * 7) % i;
+            rg_edge_init(dg, resources[src], pass, arena);
+        }
+        resources[i] = rg_node_init(dg, INTERN_LITERAL("resource"), arena);
+        rg_edge_init(dg, pass, resources[i], arena);
+        if (i == bm->pass_count - 1)
+        {
+            rg_node_declare_side_effect(pass);
+        }
+    }
+}
+
+// The compile traversal - visit the resources read and written by each pass which isn't culled.
+size_t compile_synthetic_graph(struct DepGraphBenchmark* bm)
+{
+    rg_dep_graph_t* dg = bm->dg;
+    rg_dep_graph_cull(dg);
+
+    size_t resource_count = 0;
+    for (size_t i = 0; i < dg->nodes.size; i += 2)
+    {
+        rg_node_t* pass = rg_dep_graph_get_node(dg, i);
+        if (rg_node_is_culled(pass))
+        {
+            continue;
+        }
+        resource_count += rg_dep_graph_get_reader_edges(dg, pass).count;
+        resource_count += rg_dep_graph_get_writer_edges(dg, pass).count;
+    }
+    return resource_count;
+}
+
+// The compile traversal as it was before the adjacency lists - each query scans all edges and
+// allocates a new array for the result.
+arena_dyn_array_t scan_edges(rg_dep_graph_t* dg, rg_node_t* node, bool readers, arena_t* arena)
+{
+    arena_dyn_array_t out;
+    MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &out);
+    for (size_t i = 0; i < dg->edges.size; ++i)
+    {
+        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
+        if ((readers ? edge->to_id : edge->from_id) == node->id)
+        {
+            DYN_ARRAY_APPEND(&out, &edge);
+        }
+    }
+    return out;
+}
+
+size_t compile_synthetic_graph_scan(struct DepGraphBenchmark* bm)
+{
+    rg_dep_graph_t* dg = bm->dg;
+    arena_t* arena = &bm->frame_arena;
+
+    for (size_t i = 0; i < dg->edges.size; ++i)
+    {
+        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
+        rg_dep_graph_get_node(dg, edge->from_id)->ref_count++;
+    }
+    arena_dyn_array_t nodes_to_cull;
+    MAKE_DYN_ARRAY(rg_node_t*, arena, 30, &nodes_to_cull);
+    for (size_t i = 0; i < dg->nodes.size; ++i)
+    {
+        rg_node_t* node = rg_dep_graph_get_node(dg, i);
+        if (!node->ref_count)
+        {
+            DYN_ARRAY_APPEND(&nodes_to_cull, &node);
+        }
+    }
+    while (nodes_to_cull.size > 0)
+    {
+        rg_node_t* node = DYN_ARRAY_POP_BACK(rg_node_t*, &nodes_to_cull);
+        arena_dyn_array_t reader_edges = scan_edges(dg, node, true, arena);
+        for (size_t i = 0; i < reader_edges.size; ++i)
+        {
+            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &reader_edges, i);
+            rg_node_t* child_node = rg_dep_graph_get_node(dg, edge->from_id);
+            if (!--child_node->ref_count)
+            {
+                DYN_ARRAY_APPEND(&nodes_to_cull, &child_node);
+            }
+        }
+    }
+
+    size_t resource_count = 0;
+    for (size_t i = 0; i < dg->nodes.size; i += 2)
+    {
+        rg_node_t* pass = rg_dep_graph_get_node(dg, i);
+        if (rg_node_is_culled(pass))
+        {
+            continue;
+        }
+        resource_count += scan_edges(dg, pass, true, arena).size;
+        resource_count += scan_edges(dg, pass, false, arena).size;
+    }
+    return resource_count;
+}
+
+void BM_test_dep_graph_compile_scan(bm_run_state_t* state)
+{
+    struct DepGraphBenchmark bm;
+    setup_dep_graph_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        build_synthetic_graph(&bm);
+        size_t count = compile_synthetic_graph_scan(&bm);
+        BM_DONT_OPTIMISE(count);
+    }
+    arena_release(&bm.arena);
+    arena_release(&bm.frame_arena);
+}
+
+BENCHMARK_ARG3(BM_test_dep_graph_compile_scan, 50, 500, 5000);
+
+void BM_test_dep_graph_compile_adjacency(bm_run_state_t* state)
+{
+    struct DepGraphBenchmark bm;
+    setup_dep_graph_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        build_synthetic_graph(&bm);
+        size_t count = compile_synthetic_graph(&bm);
+        BM_DONT_OPTIMISE(count);
+    }
+    arena_release(&bm.arena);
+    arena_release(&bm.frame_arena);
+}
+
+BENCHMARK_ARG3(BM_test_dep_graph_compile_adjacency, 50, 500, 5000);
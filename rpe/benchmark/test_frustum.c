@@ -0,0 +1,106 @@
+#include <frustum.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/maths.h>
+#include <utility/random.h>
+
+#include <assert.h>
+
+struct FrustumBenchmark
+{
+    arena_t arena;
+    size_t count;
+    rpe_frustum_t frustum;
+    // AoS boxes for the scalar reference.
+    math_vec3f* centers;
+    math_vec3f* extents;
+    rpe_frustum_boxes_t boxes;
+    uint8_t* results;
+    uint32_t* visible;
+};
+
+void setup_frustum_benchmark(struct FrustumBenchmark* bm, size_t count)
+{
+    int res = arena_new(1 << 30, &bm->arena);
+    assert(res == ARENA_SUCCESS);
+    bm->count = count;
+
+    math_mat4f proj = math_mat4f_frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f);
+    rpe_frustum_projection(&bm->frustum, &proj);
+
+    bm->centers = ARENA_MAKE_ARRAY(&bm->arena, math_vec3f, count, 0);
+    bm->extents = ARENA_MAKE_ARRAY(&bm->arena, math_vec3f, count, 0);
+    bm->boxes.center_x = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->boxes.center_y = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->boxes.center_z = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->boxes.extent_x = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->boxes.extent_y = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->boxes.extent_z = ARENA_MAKE_ARRAY(&bm->arena, float, count, 0);
+    bm->results = ARENA_MAKE_ARRAY(&bm->arena, uint8_t, count, 0);
+    bm->visible = ARENA_MAKE_ARRAY(&bm->arena, uint32_t, count, 0);
+
+    xoro_rand_t r = xoro_rand_init(0xff, 0x1234);
+    for (size_t i = 0; i < count; ++i)
+    {
+        math_vec3f c = {
+            (float)(xoro_rand_next(&r) % 240) - 120.0f,
+            (float)(xoro_rand_next(&r) % 240) - 120.0f,
+            (float)(xoro_rand_next(&r) % 140) - 20.0f};
+        math_vec3f e = {
+            (float)(xoro_rand_next(&r) % 5),
+            (float)(xoro_rand_next(&r) % 5),
+            (float)(xoro_rand_next(&r) % 5)};
+        bm->centers[i] = c;
+        bm->extents[i] = e;
+        bm->boxes.center_x[i] = c.x;
+        bm->boxes.center_y[i] = c.y;
+        bm->boxes.center_z[i] = c.z;
+        bm->boxes.extent_x[i] = e.x;
+        bm->boxes.extent_y[i] = e.y;
+        bm->boxes.extent_z[i] = e.z;
+    }
+}
+
+void BM_test_frustum_cull_scalar(bm_run_state_t* state)
+{
+    struct FrustumBenchmark bm;
+    setup_frustum_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        rpe_frustum_check_intersection(&bm.frustum, bm.centers, bm.extents, bm.count, bm.results);
+        BM_DONT_OPTIMISE(bm.results);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG3(BM_test_frustum_cull_scalar, 10000, 100000, 1000000);
+
+void BM_test_frustum_cull_simd(bm_run_state_t* state)
+{
+    struct FrustumBenchmark bm;
+    setup_frustum_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        rpe_frustum_cull_boxes(&bm.frustum, &bm.boxes, 0, bm.count, bm.results);
+        BM_DONT_OPTIMISE(bm.results);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG3(BM_test_frustum_cull_simd, 10000, 100000, 1000000);
+
+// The kernel along with the compaction into a visible list, as used by the scene.
+void BM_test_frustum_cull_compact(bm_run_state_t* state)
+{
+    struct FrustumBenchmark bm;
+    setup_frustum_benchmark(&bm, state->arg);
+    while (bm_state_set_running(state))
+    {
+        rpe_frustum_cull_boxes(&bm.frustum, &bm.boxes, 0, bm.count, bm.results);
+        size_t visible_count = rpe_frustum_compact_visible(bm.results, bm.count, 0, bm.visible);
+        BM_DONT_OPTIMISE(visible_count);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG3(BM_test_frustum_cull_compact, 10000, 100000, 1000000);
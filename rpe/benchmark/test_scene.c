@@ -1,21 +1,43 @@
+#include <camera.h>
 #include <engine.h>
+#include <managers/light_manager.h>
 #include <managers/renderable_manager.h>
 #include <managers/transform_manager.h>
+#include <render_queue.h>
+#include <rpe/camera.h>
 #include <rpe/engine.h>
+#include <rpe/light_manager.h>
 #include <rpe/material.h>
 #include <rpe/object.h>
 #include <rpe/object_manager.h>
 #include <rpe/renderable_manager.h>
 #include <rpe/transform_manager.h>
 #include <scene.h>
+#include <shadow_manager.h>
 #include <utility/benchmark.h>
+#include <utility/hash.h>
+#include <utility/job_queue.h>
 #include <utility/parallel_for.h>
+#include <utility/random.h>
+#include <utility/sort.h>
 #include <vulkan-api/error_codes.h>
 
-void BM_test_upload_extents(bm_run_state_t* state)
+#include <string.h>
+
+struct SceneBenchmark
+{
+    rpe_engine_t* engine;
+    rpe_scene_t* scene;
+    rpe_camera_t* camera;
+    math_mat4f world_transform;
+    struct RenderableInstance* instances;
+    struct UploadExtentsEntry extents_entry;
+    struct IndirectDrawEntry draw_entry;
+};
+
+void setup_scene_benchmark(struct SceneBenchmark* bm, int64_t model_count)
 {
     log_set_quiet(true);
-    int64_t model_count = state->arg;
 
     vkapi_driver_t* driver;
     int error_code;
@@ -26,14 +48,17 @@ void BM_test_upload_extents(bm_run_state_t* state)
 
     rpe_settings_t settings = {0};
     rpe_engine_t* engine = rpe_engine_create(driver, &settings);
+    bm->engine = engine;
 
     rpe_scene_t* scene = rpe_engine_create_scene(engine);
+    bm->scene = scene;
     rpe_rend_manager_t* rm = rpe_engine_get_rend_manager(engine);
     rpe_transform_manager_t* tm = rpe_engine_get_transform_manager(engine);
 
     // Create a very simple mesh - just enough so we can run the benchmark...
     rpe_valloc_handle v_handle = rpe_rend_manager_alloc_vertex_buffer(rm, 1);
-    rpe_valloc_handle i_handle = rpe_rend_manager_alloc_index_buffer(rm, 1);
+    rpe_valloc_handle i_handle =
+        rpe_rend_manager_alloc_index_buffer(rm, 1, RPE_RENDERABLE_INDICES_U16);
     math_mat3f pos_data = {0.0f, 0.0f, 0.0f};
     uint16_t i_data = 0;
     rpe_mesh_t* mesh = rpe_rend_manager_create_static_mesh(
@@ -53,10 +78,9 @@ void BM_test_upload_extents(bm_run_state_t* state)
     rpe_object_t transform_obj = rpe_obj_manager_create_obj(rpe_engine_get_obj_manager(engine));
     rpe_transform_manager_add_local_transform(
         rpe_engine_get_transform_manager(engine), &mt, &transform_obj);
-    rpe_transform_node_t node = {
-        .world_transform = math_mat4f_identity(), .local_transform = math_mat4f_identity()};
+    bm->world_transform = math_mat4f_identity();
 
-    struct RenderableInstance* instances = malloc(sizeof(struct RenderableInstance) * model_count);
+    bm->instances = malloc(sizeof(struct RenderableInstance) * model_count);
     for (int64_t i = 0; i < model_count; ++i)
     {
         rpe_object_t obj = rpe_obj_manager_create_obj(rpe_engine_get_obj_manager(engine));
@@ -64,25 +88,346 @@ void BM_test_upload_extents(bm_run_state_t* state)
         rpe_renderable_t* rend = rpe_engine_create_renderable(engine, mat, mesh);
         rpe_rend_manager_add(rm, rend, obj, transform_obj);
         rpe_scene_add_object(scene, obj);
-        instances[i].rend = rend;
-        instances[i].transform = &node;
+        bm->instances[i].rend = rend;
+        bm->instances[i].world_transform = &bm->world_transform;
     }
+    rpe_rend_manager_sort_renderables(
+        scene->sort_cache, bm->instances, model_count, true, &engine->frame_arena);
+    rpe_rend_manager_batch_renderables(
+        rm,
+        bm->instances,
+        scene->sort_cache->sorted_keys,
+        model_count,
+        &scene->batched_draw_cache);
+
+    // A directional light and camera are required for the shadow cascade projections.
+    rpe_light_create_info_t ci = {.position = {0.0f, -5.0f, 1.0f}};
+    rpe_object_t light_obj = rpe_obj_manager_create_obj(rpe_engine_get_obj_manager(engine));
+    rpe_light_manager_create_light(
+        engine->light_manager, &ci, light_obj, RPE_LIGHTING_TYPE_DIRECTIONAL);
+    bm->camera = rpe_engine_create_camera(engine);
+    rpe_camera_set_projection(
+        bm->camera, 45.0f, 1920, 1080, 0.1f, 100.0f, RPE_PROJECTION_TYPE_PERSPECTIVE);
+    rpe_scene_set_current_camera(scene, engine, bm->camera);
 
-    struct UploadExtentsEntry entry = {
+    bm->extents_entry = (struct UploadExtentsEntry){
         .scene = scene,
         .engine = engine,
         .tm = tm,
         .rm = rm,
-        .instances = instances,
+        .instances = bm->instances,
         .count = model_count};
-    struct SplitConfig cfg = {.min_count = 64, .max_split = 12};
+    bm->draw_entry = (struct IndirectDrawEntry){
+        .scene = scene,
+        .engine = engine,
+        .tm = tm,
+        .instances = bm->instances,
+        .count = model_count,
+        .batched_draws = &scene->batched_draw_cache,
+        .draws = malloc(sizeof(struct IndirectDraw) * model_count)};
+}
+
+void BM_test_upload_extents(bm_run_state_t* state)
+{
+    struct SceneBenchmark bm;
+    setup_scene_benchmark(&bm, state->arg);
+    struct ChunkConfig cfg = {.item_size = sizeof(rpe_rend_extents_t)};
+
+    while (bm_state_set_running(state))
+    {
+        job_t* parent = job_queue_create_parent_job(bm.engine->job_queue);
+        rpe_scene_compute_model_extents(&bm.extents_entry, parent, &cfg);
+        rpe_scene_sync_update(bm.engine, parent);
+    }
+}
+
+BENCHMARK_ARG3(BM_test_upload_extents, 100, 500, RPE_SCENE_MAX_STATIC_MODEL_COUNT);
+
+// The scene update jobs with a blocking sync point after each stage.
+void BM_test_scene_update_sync(bm_run_state_t* state)
+{
+    struct SceneBenchmark bm;
+    setup_scene_benchmark(&bm, state->arg);
+    job_queue_t* jq = bm.engine->job_queue;
+    rpe_light_manager_t* lm = bm.engine->light_manager;
+    struct ChunkConfig cfg = {.min_chunk_size = 32, .item_size = sizeof(rpe_rend_extents_t)};
+
+    while (bm_state_set_running(state))
+    {
+        job_t* shadow_parent = job_queue_create_parent_job(jq);
+        rpe_shadow_manager_update_projections(
+            bm.engine->shadow_manager, bm.camera, bm.scene, bm.engine, lm, shadow_parent);
+        rpe_scene_sync_update(bm.engine, shadow_parent);
+
+        job_t* extents_parent = job_queue_create_parent_job(jq);
+        rpe_scene_compute_model_extents(&bm.extents_entry, extents_parent, &cfg);
+        rpe_scene_sync_update(bm.engine, extents_parent);
+
+        job_t* draw_parent = job_queue_create_parent_job(jq);
+        rpe_scene_build_indirect_draws(&bm.draw_entry, draw_parent);
+        rpe_scene_sync_update(bm.engine, draw_parent);
+    }
+}
+
+BENCHMARK_ARG3(BM_test_scene_update_sync, 100, 500, RPE_SCENE_MAX_STATIC_MODEL_COUNT);
+
+// The scene update jobs as a single dependency graph, waited on once.
+void BM_test_scene_update_graph(bm_run_state_t* state)
+{
+    struct SceneBenchmark bm;
+    setup_scene_benchmark(&bm, state->arg);
+    job_queue_t* jq = bm.engine->job_queue;
+    rpe_light_manager_t* lm = bm.engine->light_manager;
+    struct ChunkConfig cfg = {.min_chunk_size = 32, .item_size = sizeof(rpe_rend_extents_t)};
 
     while (bm_state_set_running(state))
     {
-        job_t* parent = job_queue_create_parent_job(engine->job_queue);
-        rpe_scene_compute_model_extents(&entry, parent, &cfg);
-        job_queue_run_and_wait(engine->job_queue, parent);
+        job_t* parent = job_queue_create_parent_job(jq);
+        rpe_shadow_manager_update_projections(
+            bm.engine->shadow_manager, bm.camera, bm.scene, bm.engine, lm, parent);
+        rpe_scene_compute_model_extents(&bm.extents_entry, parent, &cfg);
+        rpe_scene_build_indirect_draws(&bm.draw_entry, parent);
+        rpe_scene_sync_update(bm.engine, parent);
     }
 }
 
-BENCHMARK_ARG3(BM_test_upload_extents, 100, 1000, 5000);
\ No newline at end of file
+BENCHMARK_ARG3(BM_test_scene_update_graph, 100, 500, RPE_SCENE_MAX_STATIC_MODEL_COUNT);
+
+// The model extents on their own, comparing the recursive splitter and the chunked parallel for.
+// The renderables are set up directly as the counts exceed the scene's static model limit.
+struct ExtentsBenchmark
+{
+    rpe_engine_t* engine;
+    rpe_scene_t scene;
+    rpe_renderable_t* rends;
+    math_mat4f world_transform;
+    struct RenderableInstance* instances;
+    struct UploadExtentsEntry entry;
+};
+
+void setup_extents_benchmark(struct ExtentsBenchmark* bm, int64_t model_count)
+{
+    log_set_quiet(true);
+
+    vkapi_driver_t* driver;
+    int error_code;
+    driver = vkapi_driver_init(NULL, 0, &error_code);
+    assert(error_code == VKAPI_SUCCESS);
+    error_code = vkapi_driver_create_device(driver, NULL);
+    assert(error_code == VKAPI_SUCCESS);
+
+    rpe_settings_t settings = {0};
+    bm->engine = rpe_engine_create(driver, &settings);
+
+    // Only the extents of the scene are written to by the runner.
+    bm->scene = *rpe_engine_create_scene(bm->engine);
+    bm->scene.rend_extents = malloc(sizeof(rpe_rend_extents_t) * model_count);
+
+    bm->world_transform = math_mat4f_identity();
+    bm->rends = calloc(model_count, sizeof(rpe_renderable_t));
+    bm->instances = malloc(sizeof(struct RenderableInstance) * model_count);
+    for (int64_t i = 0; i < model_count; ++i)
+    {
+        bm->rends[i].perform_cull_test = true;
+        bm->rends[i].box.min = (math_vec3f){-1.0f, -1.0f, -1.0f};
+        bm->rends[i].box.max = (math_vec3f){1.0f, 1.0f, 1.0f};
+        bm->instances[i].rend = &bm->rends[i];
+        bm->instances[i].world_transform = &bm->world_transform;
+    }
+
+    bm->entry = (struct UploadExtentsEntry){
+        .scene = &bm->scene,
+        .engine = bm->engine,
+        .tm = rpe_engine_get_transform_manager(bm->engine),
+        .rm = rpe_engine_get_rend_manager(bm->engine),
+        .instances = bm->instances,
+        .count = model_count};
+}
+
+void BM_test_model_extents_split(bm_run_state_t* state)
+{
+    struct ExtentsBenchmark bm;
+    setup_extents_benchmark(&bm, state->arg);
+    job_queue_t* jq = bm.engine->job_queue;
+    struct SplitConfig cfg = {.min_count = 32, .max_split = 12};
+
+    while (bm_state_set_running(state))
+    {
+        job_t* parent = job_queue_create_parent_job(jq);
+        job_t* job = parallel_for(
+            jq,
+            parent,
+            0,
+            bm.entry.count,
+            rpe_scene_compute_model_extents_runner,
+            &bm.entry,
+            &cfg,
+            &bm.engine->scratch_arena);
+        job_queue_run_job(jq, job);
+        rpe_scene_sync_update(bm.engine, parent);
+    }
+}
+
+BENCHMARK_ARG3(BM_test_model_extents_split, 1000, 10000, 100000);
+
+void BM_test_model_extents_chunked(bm_run_state_t* state)
+{
+    struct ExtentsBenchmark bm;
+    setup_extents_benchmark(&bm, state->arg);
+    job_queue_t* jq = bm.engine->job_queue;
+    struct ChunkConfig cfg = {.min_chunk_size = 32, .item_size = sizeof(rpe_rend_extents_t)};
+
+    while (bm_state_set_running(state))
+    {
+        job_t* parent = job_queue_create_parent_job(jq);
+        job_t* job = parallel_for_chunked(
+            jq,
+            parent,
+            0,
+            bm.entry.count,
+            rpe_scene_compute_model_extents_runner,
+            &bm.entry,
+            &cfg,
+            &bm.engine->scratch_arena);
+        job_queue_run_job(jq, job);
+        rpe_scene_sync_update(bm.engine, parent);
+    }
+}
+
+BENCHMARK_ARG3(BM_test_model_extents_chunked, 1000, 10000, 100000);
+
+// Batch building - sorting the renderables by their sort key and splitting into batches. The
+// renderables are set up directly as the counts exceed the scene's static model limit, and the
+// argument is the number of unique materials (and so batches).
+#define BM_BATCH_CHANGED_COUNT 8
+
+enum BatchBenchmarkMode
+{
+    BM_BATCH_QSORT,
+    BM_BATCH_RADIX_FULL,
+    BM_BATCH_RADIX_INCREMENTAL
+};
+
+#ifdef __linux__
+int bm_sort_instances(const void* a, const void* b, void*)
+#elif WIN32
+int bm_sort_instances(void*, const void* a, const void* b)
+#endif
+{
+    uint64_t a_key = ((struct RenderableInstance*)a)->rend->sort_key;
+    uint64_t b_key = ((struct RenderableInstance*)b)->rend->sort_key;
+    return a_key > b_key ? 1 : (a_key < b_key ? -1 : 0);
+}
+
+void run_batch_benchmark(bm_run_state_t* state, uint32_t model_count, enum BatchBenchmarkMode mode)
+{
+    arena_t arena;
+    int res = arena_new(1 << 28, &arena);
+    assert(res == ARENA_SUCCESS);
+    arena_t frame_arena;
+    res = arena_new(1 << 26, &frame_arena);
+    assert(res == ARENA_SUCCESS);
+
+    uint32_t material_count = (uint32_t)state->arg;
+    rpe_rend_manager_t rm = {0};
+    rpe_renderable_t* rends = ARENA_MAKE_ZERO_ARRAY(&arena, rpe_renderable_t, model_count);
+    struct RenderableInstance* src =
+        ARENA_MAKE_ARRAY(&arena, struct RenderableInstance, model_count, 0);
+    struct RenderableInstance* instances =
+        ARENA_MAKE_ARRAY(&arena, struct RenderableInstance, model_count, 0);
+    xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+    for (uint32_t i = 0; i < model_count; ++i)
+    {
+        uint32_t material = (uint32_t)(xoro_rand_next(&rand) % material_count);
+        material_sort_key_t key = {
+            .program_id = murmur2_hash(&material, sizeof(uint32_t), 0), .view_layer = 0x2};
+        rends[i].sort_key = rpe_render_queue_create_sort_key(key, RPE_MATERIAL_KEY_SORT_PROGRAM);
+        src[i].rend = &rends[i];
+    }
+
+    rpe_rend_sort_cache_t* cache = rpe_rend_sort_cache_init(model_count, &arena);
+    arena_dyn_array_t batches;
+    MAKE_DYN_ARRAY(rpe_batch_renderable_t, &arena, 100, &batches);
+
+    // The incremental case swaps the keys of a few renderables each iteration.
+    memcpy(instances, src, sizeof(struct RenderableInstance) * model_count);
+    rpe_rend_manager_sort_renderables(cache, instances, model_count, true, &frame_arena);
+
+    while (bm_state_set_running(state))
+    {
+        memcpy(instances, src, sizeof(struct RenderableInstance) * model_count);
+        if (mode == BM_BATCH_QSORT)
+        {
+            QSORT_RS(
+                instances,
+                model_count,
+                sizeof(struct RenderableInstance),
+                bm_sort_instances,
+                NULL);
+            for (uint32_t i = 0; i < model_count; ++i)
+            {
+                cache->sorted_keys[i] = instances[i].rend->sort_key;
+            }
+        }
+        else
+        {
+            if (mode == BM_BATCH_RADIX_INCREMENTAL)
+            {
+                for (int i = 0; i < BM_BATCH_CHANGED_COUNT; ++i)
+                {
+                    uint64_t* a = &rends[xoro_rand_next(&rand) % model_count].sort_key;
+                    uint64_t* b = &rends[xoro_rand_next(&rand) % model_count].sort_key;
+                    uint64_t tmp = *a;
+                    *a = *b;
+                    *b = tmp;
+                }
+            }
+            rpe_rend_manager_sort_renderables(
+                cache, instances, model_count, mode == BM_BATCH_RADIX_FULL, &frame_arena);
+        }
+        rpe_rend_manager_batch_renderables(
+            &rm, instances, cache->sorted_keys, model_count, &batches);
+        BM_DONT_OPTIMISE(batches.size);
+        arena_reset(&frame_arena);
+    }
+
+    arena_release(&frame_arena);
+    arena_release(&arena);
+}
+
+void BM_test_batch_renderables_qsort_10k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 10000, BM_BATCH_QSORT);
+}
+
+void BM_test_batch_renderables_radix_10k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 10000, BM_BATCH_RADIX_FULL);
+}
+
+void BM_test_batch_renderables_incremental_10k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 10000, BM_BATCH_RADIX_INCREMENTAL);
+}
+
+void BM_test_batch_renderables_qsort_100k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 100000, BM_BATCH_QSORT);
+}
+
+void BM_test_batch_renderables_radix_100k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 100000, BM_BATCH_RADIX_FULL);
+}
+
+void BM_test_batch_renderables_incremental_100k(bm_run_state_t* state)
+{
+    run_batch_benchmark(state, 100000, BM_BATCH_RADIX_INCREMENTAL);
+}
+
+BENCHMARK_ARG3(BM_test_batch_renderables_qsort_10k, 16, 256, 4096);
+BENCHMARK_ARG3(BM_test_batch_renderables_radix_10k, 16, 256, 4096);
+BENCHMARK_ARG3(BM_test_batch_renderables_incremental_10k, 16, 256, 4096);
+BENCHMARK_ARG3(BM_test_batch_renderables_qsort_100k, 16, 256, 4096);
+BENCHMARK_ARG3(BM_test_batch_renderables_radix_100k, 16, 256, 4096);
+BENCHMARK_ARG3(BM_test_batch_renderables_incremental_100k, 16, 256, 4096);
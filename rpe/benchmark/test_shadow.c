@@ -60,8 +60,9 @@ BENCHMARK_ARG3(BM_test_shadow_cascade_gen, 2, 5, 8)
 
     while (bm_state_set_running(state))
     {
-        rpe_shadow_manager_update_projections(sm, &camera, &scene, engine, lm);
-        rpe_shadow_manager_sync_update(sm, engine);
+        job_t* parent = job_queue_create_parent_job(engine->job_queue);
+        rpe_shadow_manager_update_projections(sm, &camera, &scene, engine, lm, parent);
+        job_queue_run_and_wait(engine->job_queue, parent);
     }
 }
 
@@ -0,0 +1,203 @@
+#include <managers/component_manager.h>
+#include <managers/transform_manager.h>
+#include <rpe/object.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/maths.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+// The length of each chain in the "deep" hierarchies - kept at a depth that the recursive
+// update can walk without exhausting the stack.
+#define BM_TRANSFORM_CHAIN_LENGTH 256
+
+// The recursive update as it was before the flattened hierarchy - linked nodes with each parent
+// and child looked up through the component manager.
+struct RecursiveNode
+{
+    math_mat4f local_transform;
+    math_mat4f world_transform;
+    rpe_object_t* parent;
+    rpe_object_t* first_child;
+    rpe_object_t* next;
+};
+
+struct TransformBenchmark
+{
+    arena_t arena;
+    uint32_t count;
+    uint32_t* parents;
+    // Recursive.
+    rpe_component_manager_t* comp_manager;
+    rpe_object_t* objects;
+    struct RecursiveNode* nodes;
+    // Flattened.
+    rpe_transform_hierarchy_t hierarchy;
+};
+
+static uint32_t deep_parent(uint32_t i)
+{
+    return i % BM_TRANSFORM_CHAIN_LENGTH == 0 ? RPE_TRANSFORM_NODE_INVALID : i - 1;
+}
+
+static uint32_t wide_parent(uint32_t i) { return i == 0 ? RPE_TRANSFORM_NODE_INVALID : 0; }
+
+void setup_transform_benchmark(
+    struct TransformBenchmark* bm, uint32_t count, uint32_t (*get_parent)(uint32_t))
+{
+    int res = arena_new(1 << 30, &bm->arena);
+    assert(res == ARENA_SUCCESS);
+    bm->count = count;
+    bm->parents = ARENA_MAKE_ARRAY(&bm->arena, uint32_t, count, 0);
+    bm->comp_manager = rpe_comp_manager_init(&bm->arena);
+    bm->objects = ARENA_MAKE_ARRAY(&bm->arena, rpe_object_t, count, 0);
+    bm->nodes = ARENA_MAKE_ZERO_ARRAY(&bm->arena, struct RecursiveNode, count);
+    rpe_transform_hierarchy_init(&bm->hierarchy, count, &bm->arena);
+
+    math_mat4f local = math_mat4f_identity();
+    math_mat4f_translate(math_vec3f_init(0.1f, 0.2f, 0.3f), &local);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t parent = get_parent(i);
+        bm->parents[i] = parent;
+        bm->objects[i].id = i;
+        uint64_t idx = rpe_comp_manager_add_obj(bm->comp_manager, bm->objects[i]);
+        assert(idx == i);
+
+        struct RecursiveNode* node = &bm->nodes[i];
+        node->local_transform = local;
+        node->world_transform = local;
+        if (parent != RPE_TRANSFORM_NODE_INVALID)
+        {
+            struct RecursiveNode* parent_node = &bm->nodes[parent];
+            node->parent = &bm->objects[parent];
+            node->next = parent_node->first_child;
+            parent_node->first_child = &bm->objects[i];
+        }
+
+        rpe_transform_hierarchy_add(&bm->hierarchy, i, &local, parent);
+    }
+    rpe_transform_hierarchy_update(&bm->hierarchy, NULL, 0);
+}
+
+static void update_recursive_children(struct TransformBenchmark* bm, rpe_object_t* child)
+{
+    while (child)
+    {
+        uint64_t child_idx = rpe_comp_manager_get_obj_idx(bm->comp_manager, *child);
+        struct RecursiveNode* child_node = &bm->nodes[child_idx];
+        uint64_t parent_idx = rpe_comp_manager_get_obj_idx(bm->comp_manager, *child_node->parent);
+        struct RecursiveNode* parent_node = &bm->nodes[parent_idx];
+
+        child_node->world_transform =
+            math_mat4f_mul(parent_node->world_transform, child_node->local_transform);
+        if (child_node->first_child)
+        {
+            update_recursive_children(bm, child_node->first_child);
+        }
+        child = child_node->next;
+    }
+}
+
+static void update_recursive(struct TransformBenchmark* bm)
+{
+    for (uint32_t i = 0; i < bm->count; ++i)
+    {
+        if (bm->parents[i] != RPE_TRANSFORM_NODE_INVALID)
+        {
+            continue;
+        }
+        uint64_t idx = rpe_comp_manager_get_obj_idx(bm->comp_manager, bm->objects[i]);
+        struct RecursiveNode* node = &bm->nodes[idx];
+        node->world_transform = node->local_transform;
+        update_recursive_children(bm, node->first_child);
+    }
+}
+
+static void update_flattened(struct TransformBenchmark* bm)
+{
+    for (uint32_t i = 0; i < bm->count; ++i)
+    {
+        if (bm->parents[i] == RPE_TRANSFORM_NODE_INVALID)
+        {
+            rpe_transform_hierarchy_mark_dirty(&bm->hierarchy, i);
+        }
+    }
+    rpe_transform_hierarchy_update(&bm->hierarchy, NULL, 0);
+}
+
+void BM_test_transform_recursive_deep(bm_run_state_t* state)
+{
+    struct TransformBenchmark bm;
+    setup_transform_benchmark(&bm, state->arg, deep_parent);
+    while (bm_state_set_running(state))
+    {
+        update_recursive(&bm);
+        BM_DONT_OPTIMISE(bm.nodes[bm.count - 1].world_transform);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_transform_recursive_deep, 10000, 100000);
+
+void BM_test_transform_flattened_deep(bm_run_state_t* state)
+{
+    struct TransformBenchmark bm;
+    setup_transform_benchmark(&bm, state->arg, deep_parent);
+    while (bm_state_set_running(state))
+    {
+        update_flattened(&bm);
+        BM_DONT_OPTIMISE(bm.hierarchy.world_transforms.data);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_transform_flattened_deep, 10000, 100000);
+
+void BM_test_transform_recursive_wide(bm_run_state_t* state)
+{
+    struct TransformBenchmark bm;
+    setup_transform_benchmark(&bm, state->arg, wide_parent);
+    while (bm_state_set_running(state))
+    {
+        update_recursive(&bm);
+        BM_DONT_OPTIMISE(bm.nodes[bm.count - 1].world_transform);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_transform_recursive_wide, 10000, 100000);
+
+void BM_test_transform_flattened_wide(bm_run_state_t* state)
+{
+    struct TransformBenchmark bm;
+    setup_transform_benchmark(&bm, state->arg, wide_parent);
+    while (bm_state_set_running(state))
+    {
+        update_flattened(&bm);
+        BM_DONT_OPTIMISE(bm.hierarchy.world_transforms.data);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_transform_flattened_wide, 10000, 100000);
+
+// Only a single subtree of a deep hierarchy has changed - the recursive update has no dirty
+// tracking, so this is compared against the full recursive update above.
+void BM_test_transform_flattened_partial(bm_run_state_t* state)
+{
+    struct TransformBenchmark bm;
+    setup_transform_benchmark(&bm, state->arg, deep_parent);
+    uint32_t node = bm.count - BM_TRANSFORM_CHAIN_LENGTH / 2;
+    while (bm_state_set_running(state))
+    {
+        rpe_transform_hierarchy_mark_dirty(&bm.hierarchy, node);
+        rpe_transform_hierarchy_update(&bm.hierarchy, NULL, 0);
+        BM_DONT_OPTIMISE(bm.hierarchy.world_transforms.data);
+    }
+    arena_release(&bm.arena);
+}
+
+BENCHMARK_ARG2(BM_test_transform_flattened_partial, 10000, 100000);
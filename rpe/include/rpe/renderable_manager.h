@@ -169,7 +169,30 @@ void rpe_rend_manager_copy(
     rpe_object_t* transform_obj);
 
 rpe_valloc_handle rpe_rend_manager_alloc_vertex_buffer(rpe_rend_manager_t* m, uint32_t vertex_size);
-rpe_valloc_handle rpe_rend_manager_alloc_index_buffer(rpe_rend_manager_t* m, uint32_t index_size);
+
+/**
+ Allocate space for indices. The indices are stored at their native width, so the type must match
+ the indices later passed to @sa rpe_rend_manager_create_mesh.
+ @param m
+ @param index_size The number of indices.
+ @param indices_type The width of the indices.
+ */
+rpe_valloc_handle rpe_rend_manager_alloc_index_buffer(
+    rpe_rend_manager_t* m, uint32_t index_size, enum IndicesType indices_type);
+
+/**
+ Return a vertex or index allocation to the pool it was allocated from. Frames in flight may still
+ be reading from it, so the space isn't reused until they have completed. This must not be called
+ while any mesh using it is still in a scene.
+ */
+void rpe_rend_manager_free_buffer(rpe_rend_manager_t* m, rpe_valloc_handle h);
+
+/**
+ Free the vertex and index allocations used by the mesh. Meshes created with
+ @sa rpe_rend_manager_offset_indices share the allocations of their parent mesh, so only one of
+ them should be destroyed.
+ */
+void rpe_rend_manager_destroy_mesh(rpe_rend_manager_t* m, rpe_mesh_t* mesh);
 
 bool rpe_rend_manager_has_obj(rpe_rend_manager_t* m, rpe_object_t* obj);
 
@@ -24,6 +24,8 @@
 
 #include "object.h"
 
+#include <stdbool.h>
+
 typedef struct Scene rpe_scene_t;
 typedef struct Engine rpe_engine_t;
 typedef struct Camera rpe_camera_t;
@@ -63,4 +65,12 @@ void rpe_scene_set_shadow_status(rpe_scene_t* scene, enum ShadowStatus status);
  */
 void rpe_scene_skip_lighting_pass(rpe_scene_t* scene);
 
+/**
+ Cull the renderables against the camera frustum on the CPU, so that draws are only built and
+ uploaded for those which are visible. Otherwise, all renderables are culled by the compute shader.
+ @param scene
+ @param enabled
+ */
+void rpe_scene_set_cpu_culling(rpe_scene_t* scene, bool enabled);
+
 #endif
\ No newline at end of file
@@ -30,6 +30,10 @@ typedef struct Settings
 {
     uint32_t gbuffer_dims;
     bool draw_shadows;
+    /// Record the draws of the gbuffer and shadow passes on the job queue workers, into secondary
+    /// command buffers, rather than on the main thread. Off by default - this only wins when the
+    /// cost of recording outweighs the job overhead, see BM_test_cmd_bucket_submit_parallel.
+    bool parallel_draw_recording;
 
     struct ShadowSettings
     {
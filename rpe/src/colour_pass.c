@@ -22,6 +22,7 @@
 
 #include "colour_pass.h"
 
+#include "commands.h"
 #include "engine.h"
 #include "render_graph/render_graph.h"
 #include "render_graph/render_pass_node.h"
@@ -47,42 +48,57 @@ void setup_gbuffer(render_graph_t* rg, rg_pass_node_t* node, void* data, void* l
     d->colour = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Colour", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Colour"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->pos = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Position", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Position"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->normal = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Normal", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Normal"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16_SFLOAT;
     d->pbr = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Pbr", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Pbr"), VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->emissive = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Emissive", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Emissive"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = local_d->depth_format;
     d->depth = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Depth", VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Depth"),
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     d->colour = rg_add_write(rg, d->colour, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
@@ -102,17 +118,18 @@ void setup_gbuffer(render_graph_t* rg, rg_pass_node_t* node, void* data, void* l
     desc.ds_load_clear_flags[0] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
     desc.ds_load_clear_flags[1] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
 
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "GBufferPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("GBufferPass"), desc);
     rg_node_declare_side_effect((rg_node_t*)node);
 
     rg_backboard_t* bb = rg_get_backboard(rg);
 
-    rg_backboard_add(bb, "colour", d->colour);
-    rg_backboard_add(bb, "position", d->pos);
-    rg_backboard_add(bb, "normal", d->normal);
-    rg_backboard_add(bb, "emissive", d->emissive);
-    rg_backboard_add(bb, "pbr", d->pbr);
-    rg_backboard_add(bb, "gbufferDepth", d->depth);
+    rg_backboard_add(bb, INTERN_LITERAL("colour"), d->colour);
+    rg_backboard_add(bb, INTERN_LITERAL("position"), d->pos);
+    rg_backboard_add(bb, INTERN_LITERAL("normal"), d->normal);
+    rg_backboard_add(bb, INTERN_LITERAL("emissive"), d->emissive);
+    rg_backboard_add(bb, INTERN_LITERAL("pbr"), d->pbr);
+    rg_backboard_add(bb, INTERN_LITERAL("gbufferDepth"), d->depth);
 
     d->scene = local_d->scene;
 }
@@ -126,7 +143,6 @@ void execute_gbuffer(
     assert(scene);
 
     vkapi_cmdbuffer_t* cmd_buffer = vkapi_driver_get_gfx_cmds(driver);
-    rpe_vertex_buffer_upload_to_gpu(engine->vbuffer, driver);
 
     // Make sure the compute shaders have finished before commiting draw commands.
     vkapi_driver_acquire_buffer_barrier(
@@ -137,15 +153,33 @@ void execute_gbuffer(
     vkapi_driver_acquire_buffer_barrier(
         driver, cmd_buffer, scene->draw_count_handle, VKAPI_BARRIER_COMPUTE_TO_INDIRECT_CMD_READ);
 
-    vkapi_driver_begin_rpass(driver, cmd_buffer->instance, &info.data, &info.handle);
-
-    // Bind the uber vertex/index buffers - only one bind call required as all draw calls offset
-    // into this buffer.
-    vkapi_driver_bind_vertex_buffer(driver, engine->vbuffer->vertex_buffer, 0);
-    vkapi_driver_bind_vertex_buffer(driver, scene->model_draw_data_handle, 1);
-    vkapi_driver_bind_index_buffer(driver, engine->vbuffer->index_buffer);
-
-    rpe_render_queue_submit_one(scene->render_queue, driver, RPE_RENDER_QUEUE_GBUFFER);
+    // Bind the uber vertex buffer - only one bind call required as all draw calls offset into
+    // this buffer. The index buffer depends on the index width so is bound by each batch.
+    buffer_handle_t vertex_buffers[2] = {
+        engine->vbuffer->pools[RPE_VERTEX_POOL_VERTEX].buffer, scene->model_draw_data_handle};
+    if (engine->settings.parallel_draw_recording)
+    {
+        vkapi_driver_begin_rpass_secondary(driver, cmd_buffer->instance, &info.data, &info.handle);
+        rpe_cmd_secondary_data_t rec_data = {
+            .primary = cmd_buffer->instance,
+            .vertex_buffers = {vertex_buffers[0], vertex_buffers[1]},
+            .vertex_buffer_count = 2};
+        rpe_cmd_recorder_t rec = rpe_cmd_secondary_recorder_init(&rec_data);
+        rpe_render_queue_submit_one_mt(
+            scene->render_queue,
+            driver,
+            RPE_RENDER_QUEUE_GBUFFER,
+            engine->job_queue,
+            &rec,
+            &engine->frame_arena);
+    }
+    else
+    {
+        vkapi_driver_begin_rpass(driver, cmd_buffer->instance, &info.data, &info.handle);
+        vkapi_driver_bind_vertex_buffer(driver, vertex_buffers[0], 0);
+        vkapi_driver_bind_vertex_buffer(driver, vertex_buffers[1], 1);
+        rpe_render_queue_submit_one(scene->render_queue, driver, RPE_RENDER_QUEUE_GBUFFER);
+    }
 
     vkapi_driver_end_rpass(cmd_buffer->instance);
 
@@ -165,7 +199,12 @@ rg_handle_t rpe_colour_pass_render(
         .width = dimensions, .height = dimensions, .depth_format = depth_format, .scene = scene};
 
     rg_pass_t* p = rg_add_pass(
-        rg, "ColourPass", setup_gbuffer, execute_gbuffer, sizeof(struct DataGBuffer), &local_d);
+        rg,
+        INTERN_LITERAL("ColourPass"),
+        setup_gbuffer,
+        execute_gbuffer,
+        sizeof(struct DataGBuffer),
+        &local_d);
     struct DataGBuffer* d = (struct DataGBuffer*)p->data;
     return d->colour;
 }
\ No newline at end of file
@@ -25,6 +25,9 @@
 #include <assert.h>
 #include <string.h>
 #include <utility/arena.h>
+#include <utility/job_queue.h>
+#include <utility/parallel_for.h>
+#include <utility/sort.h>
 #include <vulkan-api/driver.h>
 #include <vulkan-api/shader.h>
 
@@ -76,6 +79,12 @@ void rpe_cmd_dispatch_pline_bind(vkapi_driver_t* driver, void* data)
     vkapi_driver_bind_gfx_pipeline(driver, cmd->bundle, false);
 }
 
+void rpe_cmd_dispatch_index_buffer_bind(vkapi_driver_t* driver, void* data)
+{
+    struct IndexBufferBindCommand* cmd = (struct IndexBufferBindCommand*)data;
+    vkapi_driver_bind_index_buffer(driver, cmd->handle, cmd->type);
+}
+
 void rpe_cmd_dispatch_scissor_cmd(vkapi_driver_t* driver, void* data)
 {
     struct ScissorCommand* cmd = (struct ScissorCommand*)data;
@@ -101,27 +110,63 @@ void rpe_cmd_dispatch_viewport_cmd(vkapi_driver_t* driver, void* data)
     vkapi_driver_set_viewport(driver, vp);
 }
 
-rpe_cmd_bucket_t* rpe_command_bucket_init(size_t size, arena_t* arena)
+rpe_cmd_bucket_t* rpe_command_bucket_init(uint64_t pool_size, job_queue_t* jq, arena_t* arena)
 {
+    // Packet offsets are stored as 32-bit values.
+    assert(pool_size <= UINT32_MAX);
     rpe_cmd_bucket_t* bkt = ARENA_MAKE_ZERO_STRUCT(arena, rpe_cmd_bucket_t);
-    bkt->packets = ARENA_MAKE_ZERO_ARRAY(arena, rpe_cmd_packet_t*, size);
-    bkt->curr_index = 0;
+    thread_arena_pool_init(&bkt->pool, arena, pool_size, ARENA_THREAD_CHUNK_SIZE);
+    for (uint32_t i = 0; i < RPE_CMD_BUCKET_MAX_STREAM_COUNT; ++i)
+    {
+        thread_arena_init(&bkt->streams[i].arena, &bkt->pool);
+    }
+    thread_arena_init(&bkt->sort_arena, &bkt->pool);
+    bkt->jq = jq;
     return bkt;
 }
 
+rpe_cmd_stream_t* _command_bucket_get_stream(rpe_cmd_bucket_t* bucket)
+{
+    uint32_t idx = bucket->jq ? job_queue_get_thread_index(bucket->jq) : 0;
+    assert(idx < RPE_CMD_BUCKET_MAX_STREAM_COUNT);
+    return &bucket->streams[idx];
+}
+
+void _command_stream_push(
+    rpe_cmd_stream_t* stream, uint64_t key, rpe_cmd_packet_t* pkt, thread_arena_pool_t* pool)
+{
+    if (stream->count == stream->capacity)
+    {
+        // The old arrays are left in the pool until the bucket is reset.
+        uint32_t capacity =
+            stream->capacity ? stream->capacity * 2 : RPE_CMD_STREAM_INITIAL_CAPACITY;
+        uint64_t* keys = THREAD_ARENA_MAKE_ARRAY(&stream->arena, uint64_t, capacity, 0);
+        uint32_t* offsets = THREAD_ARENA_MAKE_ARRAY(&stream->arena, uint32_t, capacity, 0);
+        if (stream->count)
+        {
+            memcpy(keys, stream->keys, stream->count * sizeof(uint64_t));
+            memcpy(offsets, stream->offsets, stream->count * sizeof(uint32_t));
+        }
+        stream->keys = keys;
+        stream->offsets = offsets;
+        stream->capacity = capacity;
+    }
+    stream->keys[stream->count] = key;
+    stream->offsets[stream->count] = (uint32_t)((uint8_t*)pkt - pool->begin);
+    ++stream->count;
+}
+
 rpe_cmd_packet_t* rpe_command_bucket_add_command(
     rpe_cmd_bucket_t* bucket,
+    uint64_t key,
     size_t aux_mem_size,
     size_t cmd_size,
-    arena_t* arena,
     DispatchFunction func)
 {
     assert(bucket);
-    rpe_cmd_packet_t* packet = rpe_cmd_packet_create(aux_mem_size, cmd_size, arena);
-
-    // store key and pointer to the data
-    uint32_t idx = bucket->curr_index++;
-    bucket->packets[idx] = packet;
+    rpe_cmd_stream_t* stream = _command_bucket_get_stream(bucket);
+    rpe_cmd_packet_t* packet = rpe_cmd_packet_create(aux_mem_size, cmd_size, &stream->arena);
+    _command_stream_push(stream, key, packet, &bucket->pool);
 
     packet->next = NULL;
     packet->dispatch_func = func;
@@ -134,11 +179,11 @@ rpe_cmd_packet_t* rpe_command_bucket_append_command(
     rpe_cmd_packet_t* prev_pkt,
     size_t data_size,
     size_t cmd_size,
-    arena_t* arena,
     DispatchFunction func)
 {
     assert(bucket);
-    rpe_cmd_packet_t* packet = rpe_cmd_packet_create(data_size, cmd_size, arena);
+    rpe_cmd_stream_t* stream = _command_bucket_get_stream(bucket);
+    rpe_cmd_packet_t* packet = rpe_cmd_packet_create(data_size, cmd_size, &stream->arena);
 
     prev_pkt->next = packet;
     packet->next = NULL;
@@ -155,32 +200,248 @@ void rpe_cmd_packet_submit(rpe_cmd_packet_t* pkt, vkapi_driver_t* driver)
     func(driver, cmd);
 }
 
+void rpe_command_bucket_sort(rpe_cmd_bucket_t* bucket)
+{
+    assert(bucket);
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < RPE_CMD_BUCKET_MAX_STREAM_COUNT; ++i)
+    {
+        count += bucket->streams[i].count;
+    }
+    bucket->packet_count = count;
+    if (!count)
+    {
+        return;
+    }
+
+    thread_arena_t* arena = &bucket->sort_arena;
+    uint64_t* keys = THREAD_ARENA_MAKE_ARRAY(arena, uint64_t, count, 0);
+    uint64_t* tmp_keys = THREAD_ARENA_MAKE_ARRAY(arena, uint64_t, count, 0);
+    uint32_t* offsets = THREAD_ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    uint32_t* tmp_offsets = THREAD_ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+
+    // Streams are gathered in index order - as the sort is stable, packets with the same key keep
+    // the order they were added in.
+    uint32_t idx = 0;
+    for (uint32_t i = 0; i < RPE_CMD_BUCKET_MAX_STREAM_COUNT; ++i)
+    {
+        rpe_cmd_stream_t* stream = &bucket->streams[i];
+        if (stream->count)
+        {
+            memcpy(keys + idx, stream->keys, stream->count * sizeof(uint64_t));
+            memcpy(offsets + idx, stream->offsets, stream->count * sizeof(uint32_t));
+            idx += stream->count;
+        }
+    }
+    radix_sort_keys(keys, offsets, count, tmp_keys, tmp_offsets);
+    bucket->packet_offsets = offsets;
+}
+
 void rpe_command_bucket_submit(rpe_cmd_bucket_t* bucket, vkapi_driver_t* driver)
 {
     assert(bucket);
+    rpe_command_bucket_sort(bucket);
+    rpe_cmd_range_t range = {.start = 0, .end = bucket->packet_count};
+    rpe_command_bucket_submit_range(bucket, driver, range);
+}
+
+void rpe_command_bucket_submit_range(
+    rpe_cmd_bucket_t* bucket, vkapi_driver_t* driver, rpe_cmd_range_t range)
+{
+    assert(bucket);
+    assert(range.start <= range.end && range.end <= bucket->packet_count);
 
-    for (size_t i = 0; i < bucket->curr_index; ++i)
+    // Each top-level packet starts with the full viewport and scissor, as it would at the start of
+    // a secondary command buffer, so the result doesn't depend on how the bucket is split.
+    bool reset_viewport = false;
+    for (uint32_t i = range.start; i < range.end; ++i)
     {
-        rpe_cmd_packet_t* pkt = bucket->packets[i];
+        if (reset_viewport)
+        {
+            vkapi_driver_reset_viewport(driver);
+            reset_viewport = false;
+        }
+        rpe_cmd_packet_t* pkt = (rpe_cmd_packet_t*)(bucket->pool.begin + bucket->packet_offsets[i]);
         do
         {
+            reset_viewport |= pkt->dispatch_func == rpe_cmd_dispatch_viewport_cmd ||
+                pkt->dispatch_func == rpe_cmd_dispatch_scissor_cmd;
             rpe_cmd_packet_submit(pkt, driver);
             pkt = pkt->next;
         } while (pkt);
     }
 }
 
+uint32_t rpe_command_bucket_split(
+    rpe_cmd_bucket_t* bucket,
+    uint32_t max_ranges,
+    uint32_t min_range_size,
+    rpe_cmd_range_t* out_ranges)
+{
+    assert(bucket);
+    assert(out_ranges);
+    assert(max_ranges > 0);
+
+    uint32_t count = bucket->packet_count;
+    if (!count)
+    {
+        return 0;
+    }
+    uint32_t range_count = min_range_size > 0 ? count / min_range_size : count;
+    range_count = range_count > max_ranges ? max_ranges : range_count;
+    range_count = range_count > 0 ? range_count : 1;
+
+    // The remainder is spread over the first ranges, so sizes differ by no more than one.
+    uint32_t size = count / range_count;
+    uint32_t remainder = count % range_count;
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < range_count; ++i)
+    {
+        uint32_t end = start + size + (i < remainder ? 1 : 0);
+        out_ranges[i] = (rpe_cmd_range_t){.start = start, .end = end};
+        start = end;
+    }
+    assert(start == count);
+    return range_count;
+}
+
+struct BucketRecordData
+{
+    rpe_cmd_bucket_t* bucket;
+    vkapi_driver_t* driver;
+    job_queue_t* jq;
+    rpe_cmd_recorder_t* rec;
+    rpe_cmd_range_t* ranges;
+    /// The command buffer each range was recorded into.
+    VkCommandBuffer* cmds;
+};
+
+void rpe_command_bucket_record_ranges(uint32_t start, uint32_t count, void* data)
+{
+    struct BucketRecordData* d = (struct BucketRecordData*)data;
+    rpe_cmd_recorder_t* rec = d->rec;
+    uint32_t worker_idx = job_queue_get_thread_index(d->jq);
+
+    for (uint32_t i = start; i < start + count; ++i)
+    {
+        VkCommandBuffer cmds = rec->begin(d->driver, worker_idx, rec->user_data);
+        rpe_command_bucket_submit_range(d->bucket, d->driver, d->ranges[i]);
+        rec->end(d->driver, cmds, rec->user_data);
+        d->cmds[i] = cmds;
+    }
+}
+
+void rpe_command_bucket_submit_mt(
+    rpe_cmd_bucket_t* bucket,
+    vkapi_driver_t* driver,
+    job_queue_t* jq,
+    rpe_cmd_recorder_t* rec,
+    arena_t* arena)
+{
+    assert(bucket);
+    assert(jq);
+    assert(rec);
+
+    rpe_command_bucket_sort(bucket);
+
+    // The calling thread also records whilst waiting on the workers.
+    uint32_t max_ranges = (jq->thread_count + 1) * RPE_CMD_BUCKET_RANGES_PER_WORKER;
+    max_ranges =
+        max_ranges > RPE_CMD_BUCKET_MAX_RANGE_COUNT ? RPE_CMD_BUCKET_MAX_RANGE_COUNT : max_ranges;
+
+    rpe_cmd_range_t ranges[RPE_CMD_BUCKET_MAX_RANGE_COUNT];
+    VkCommandBuffer cmds[RPE_CMD_BUCKET_MAX_RANGE_COUNT];
+    uint32_t range_count =
+        rpe_command_bucket_split(bucket, max_ranges, RPE_CMD_BUCKET_MIN_PACKETS_PER_RANGE, ranges);
+    if (!range_count)
+    {
+        return;
+    }
+
+    struct BucketRecordData d = {
+        .bucket = bucket, .driver = driver, .jq = jq, .rec = rec, .ranges = ranges, .cmds = cmds};
+    if (range_count == 1)
+    {
+        // Not worth the overhead of a job.
+        rpe_command_bucket_record_ranges(0, 1, &d);
+    }
+    else
+    {
+        // Each chunk is a single range, so a worker claims ranges one at a time.
+        struct ChunkConfig cfg = {
+            .chunks_per_worker = RPE_CMD_BUCKET_RANGES_PER_WORKER, .min_chunk_size = 1};
+        job_t* job = parallel_for_chunked(
+            jq, NULL, 0, range_count, rpe_command_bucket_record_ranges, &d, &cfg, arena);
+        job_queue_run_and_wait(jq, job);
+    }
+
+    // Executed in range order regardless of the order the ranges were recorded in.
+    rec->execute(driver, cmds, range_count, rec->user_data);
+}
+
+VkCommandBuffer rpe_cmd_secondary_begin(vkapi_driver_t* driver, uint32_t worker_idx, void* data)
+{
+    rpe_cmd_secondary_data_t* d = (rpe_cmd_secondary_data_t*)data;
+    VkCommandBuffer cmds = vkapi_driver_begin_secondary(driver, worker_idx);
+    for (uint32_t i = 0; i < d->vertex_buffer_count; ++i)
+    {
+        vkapi_driver_bind_vertex_buffer(driver, d->vertex_buffers[i], i);
+    }
+    return cmds;
+}
+
+void rpe_cmd_secondary_end(vkapi_driver_t* driver, VkCommandBuffer cmds, void* data)
+{
+    vkapi_driver_end_secondary(driver, cmds);
+}
+
+void rpe_cmd_secondary_execute(
+    vkapi_driver_t* driver, VkCommandBuffer* cmds, uint32_t count, void* data)
+{
+    rpe_cmd_secondary_data_t* d = (rpe_cmd_secondary_data_t*)data;
+    vkapi_driver_execute_secondary(driver, d->primary, cmds, count);
+}
+
+rpe_cmd_recorder_t rpe_cmd_secondary_recorder_init(rpe_cmd_secondary_data_t* data)
+{
+    assert(data);
+    assert(data->vertex_buffer_count <= RPE_CMD_RECORDER_MAX_VERTEX_BINDINGS);
+    rpe_cmd_recorder_t rec = {
+        .begin = rpe_cmd_secondary_begin,
+        .end = rpe_cmd_secondary_end,
+        .execute = rpe_cmd_secondary_execute,
+        .user_data = data};
+    return rec;
+}
+
 void rpe_command_bucket_reset(rpe_cmd_bucket_t* bucket)
 {
     assert(bucket);
-    bucket->curr_index = 0;
+    // The thread arenas discard their chunks on their next allocation.
+    thread_arena_pool_reset(&bucket->pool);
+    for (uint32_t i = 0; i < RPE_CMD_BUCKET_MAX_STREAM_COUNT; ++i)
+    {
+        rpe_cmd_stream_t* stream = &bucket->streams[i];
+        stream->keys = NULL;
+        stream->offsets = NULL;
+        stream->count = 0;
+        stream->capacity = 0;
+    }
+    bucket->packet_offsets = NULL;
+    bucket->packet_count = 0;
 }
 
-rpe_cmd_packet_t* rpe_cmd_packet_create(size_t data_size, size_t cmd_size, arena_t* arena)
+rpe_cmd_packet_t* rpe_cmd_packet_create(size_t data_size, size_t cmd_size, thread_arena_t* arena)
 {
-    size_t pkt_size = sizeof(struct CommandPacket) + data_size * sizeof(uint8_t);
-    uint8_t* bytes = ARENA_MAKE_ZERO_ARRAY(arena, uint8_t, pkt_size);
+    // The command data follows the auxiliary data, aligned so the packet can be cast to any
+    // command type.
+    size_t cmd_offset = sizeof(struct CommandPacket) + data_size;
+    cmd_offset = (cmd_offset + RPE_CMD_PACKET_ALIGNMENT - 1) & ~(RPE_CMD_PACKET_ALIGNMENT - 1);
+    uint8_t* bytes = (uint8_t*)thread_arena_alloc(
+        arena, 1, RPE_CMD_PACKET_ALIGNMENT, (ptrdiff_t)(cmd_offset + cmd_size), ARENA_ZERO_MEMORY);
     rpe_cmd_packet_t* pkt = (rpe_cmd_packet_t*)bytes;
-    pkt->cmds = ARENA_MAKE_ZERO_ARRAY(arena, uint8_t, cmd_size);
+    pkt->cmds = bytes + cmd_offset;
+    pkt->data_size = data_size;
     return pkt;
 }
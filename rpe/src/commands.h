@@ -29,22 +29,110 @@
 #include <backend/enums.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <utility/arena.h>
+#include <utility/compiler.h>
+#include <utility/job_queue.h>
 #include <vulkan-api/resource_cache.h>
 
+/// The fewest top-level packets recorded into a secondary command buffer - below this, the cost
+/// of beginning and executing the command buffer outweighs recording in parallel.
+#define RPE_CMD_BUCKET_MIN_PACKETS_PER_RANGE 32
+/// The number of ranges per worker a bucket is split into, so the workers remain balanced when
+/// the cost of recording varies between packets.
+#define RPE_CMD_BUCKET_RANGES_PER_WORKER 2
+#define RPE_CMD_BUCKET_MAX_RANGE_COUNT 32
+#define RPE_CMD_RECORDER_MAX_VERTEX_BINDINGS 2
+/// Each thread which records into a bucket writes to its own stream, indexed by the job queue
+/// thread index.
+#define RPE_CMD_BUCKET_MAX_STREAM_COUNT JOB_QUEUE_MAX_THREAD_COUNT
+/// The number of top-level packets a stream has space for on first use - doubled when full.
+#define RPE_CMD_STREAM_INITIAL_CAPACITY 256
+/// All packets (and the command data they hold) are aligned to this.
+#define RPE_CMD_PACKET_ALIGNMENT 16
+
 // Forward declarations
-typedef struct Arena arena_t;
 typedef struct VkApiDriver vkapi_driver_t;
 typedef struct CommandPacket rpe_cmd_packet_t;
 typedef struct ShaderProgramBundle shader_prog_bundle_t;
 
 typedef void (*DispatchFunction)(vkapi_driver_t*, void*);
 
+/**
+ The packets recorded into a bucket by a single thread. Packets are written linearly into chunks
+ carved from the bucket pool, and the key and offset of each top-level packet are stored in
+ parallel arrays, so only the owning thread ever writes to a stream.
+ */
+typedef struct RPE_ALIGNAS(JOB_QUEUE_CACHELINE_SIZE) CommandStream
+{
+    thread_arena_t arena;
+    uint64_t* keys;
+    /// The byte offset of each top-level packet from the start of the bucket pool.
+    uint32_t* offsets;
+    uint32_t count;
+    uint32_t capacity;
+} rpe_cmd_stream_t;
+
 typedef struct CommandBucket
 {
-    rpe_cmd_packet_t** packets;
-    uint32_t curr_index;
+    /// The memory all streams and the sorted packet list are allocated from.
+    thread_arena_pool_t pool;
+    rpe_cmd_stream_t streams[RPE_CMD_BUCKET_MAX_STREAM_COUNT];
+    /// Used to select the stream of the calling thread - if NULL, all packets must be added from
+    /// the same thread.
+    job_queue_t* jq;
+    /// Used by the thread which sorts the bucket.
+    thread_arena_t sort_arena;
+    /// The offsets of the top-level packets of all streams in key order - only valid once the
+    /// bucket has been sorted.
+    uint32_t* packet_offsets;
+    uint32_t packet_count;
 } rpe_cmd_bucket_t;
 
+/// A range of top-level packets in a bucket - [start, end).
+typedef struct CommandRange
+{
+    uint32_t start;
+    uint32_t end;
+} rpe_cmd_range_t;
+
+/**
+ The calls made to record ranges of a bucket into separate command buffers. These are separated
+ out so the splitting and ordering of the ranges can be tested without a device.
+ */
+typedef struct CommandRecorder
+{
+    /**
+     Begin recording on the calling thread. All packets dispatched on this thread until @sa end is
+     called are recorded into the returned command buffer.
+     @param worker_idx The job queue index of the calling thread.
+     */
+    VkCommandBuffer (*begin)(vkapi_driver_t* driver, uint32_t worker_idx, void* user_data);
+    void (*end)(vkapi_driver_t* driver, VkCommandBuffer cmds, void* user_data);
+    /**
+     Execute the recorded command buffers, which are given in bucket order.
+     */
+    void (*execute)(vkapi_driver_t* driver, VkCommandBuffer* cmds, uint32_t count, void* user_data);
+    void* user_data;
+} rpe_cmd_recorder_t;
+
+/**
+ The state for recording into secondary command buffers with the driver - see
+ @sa rpe_cmd_secondary_recorder_init.
+ */
+typedef struct SecondaryRecorderData
+{
+    /// The primary the secondary command buffers are executed on.
+    VkCommandBuffer primary;
+    /// Bound at the start of each secondary command buffer, as bound state isn't inherited from
+    /// the primary.
+    buffer_handle_t vertex_buffers[RPE_CMD_RECORDER_MAX_VERTEX_BINDINGS];
+    uint32_t vertex_buffer_count;
+} rpe_cmd_secondary_data_t;
+
+/**
+ A packet is a single allocation - the header, followed by the auxiliary data and then the
+ command data.
+ */
 typedef struct CommandPacket
 {
     void* cmds;
@@ -102,6 +190,12 @@ struct PipelineBindCommand
     shader_prog_bundle_t* bundle;
 };
 
+struct IndexBufferBindCommand
+{
+    buffer_handle_t handle;
+    VkIndexType type;
+};
+
 struct ScissorCommand
 {
     rpe_rect2d_t scissor;
@@ -112,30 +206,92 @@ struct ViewportCommand
     rpe_viewport_t vp;
 };
 
-rpe_cmd_bucket_t* rpe_command_bucket_init(size_t size, arena_t* arena);
+/**
+ Create a command bucket.
+ @param pool_size The size in bytes of the memory reserved for the packets of the bucket. There
+ is no limit on the packet count other than this.
+ @param jq If not NULL, packets can be added from any thread of the job queue without locking.
+ @param arena The arena the bucket and its pool are allocated from.
+ */
+rpe_cmd_bucket_t* rpe_command_bucket_init(uint64_t pool_size, job_queue_t* jq, arena_t* arena);
 
+/**
+ Add a top-level packet to the stream of the calling thread.
+ @param key The sort key - packets are submitted in ascending key order. Packets with the same key
+ which are added from the same thread keep the order they were added in.
+ */
 rpe_cmd_packet_t* rpe_command_bucket_add_command(
     rpe_cmd_bucket_t* bucket,
+    uint64_t key,
     size_t aux_mem_size,
     size_t cmd_size,
-    arena_t* arena,
     DispatchFunction func);
 
+/**
+ Add a packet which is dispatched after @p cmd. Must be called from the thread which added @p cmd.
+ */
 rpe_cmd_packet_t* rpe_command_bucket_append_command(
     rpe_cmd_bucket_t* bucket,
     rpe_cmd_packet_t* cmd,
     size_t aux_mem_size,
     size_t cmd_size,
-    arena_t* arena,
     DispatchFunction func);
 
+/**
+ Create a recorder which records into driver secondary command buffers. The render pass the
+ packets are recorded for must be begun with @sa vkapi_driver_begin_rpass_secondary.
+ @param data Must remain valid until the bucket has been submitted.
+ */
+rpe_cmd_recorder_t rpe_cmd_secondary_recorder_init(rpe_cmd_secondary_data_t* data);
+
 /* ** Private functions. ** */
 
+/**
+ Gather the top-level packets of all streams and sort them by key. This must be called once all
+ packets have been added, and before the bucket is split or a range submitted.
+ */
+void rpe_command_bucket_sort(rpe_cmd_bucket_t* bucket);
+
+/**
+ Sort and then submit all packets of the bucket.
+ */
 void rpe_command_bucket_submit(rpe_cmd_bucket_t* bucket, vkapi_driver_t* driver);
 
+/**
+ Split the sorted top-level packets of a bucket into contiguous ranges of near equal size. A
+ packet and the packets appended to it are never split across ranges.
+ @param max_ranges The most ranges to split into.
+ @param min_range_size The fewest packets in a range - the bucket is split into fewer ranges
+ rather than creating smaller ranges.
+ @param out_ranges Filled with the ranges in bucket order - must hold at least @p max_ranges.
+ @returns The number of ranges - zero if the bucket is empty.
+ */
+uint32_t rpe_command_bucket_split(
+    rpe_cmd_bucket_t* bucket,
+    uint32_t max_ranges,
+    uint32_t min_range_size,
+    rpe_cmd_range_t* out_ranges);
+
+void rpe_command_bucket_submit_range(
+    rpe_cmd_bucket_t* bucket, vkapi_driver_t* driver, rpe_cmd_range_t range);
+
+/**
+ Sort and submit a bucket by recording ranges of the packets in parallel on the job queue
+ workers. Each range is recorded into its own command buffer via @p rec, and the command buffers
+ are executed in key order so the result is the same as @sa rpe_command_bucket_submit.
+ @param arena Used for the job state - only needs to be valid until this returns.
+ */
+void rpe_command_bucket_submit_mt(
+    rpe_cmd_bucket_t* bucket,
+    vkapi_driver_t* driver,
+    job_queue_t* jq,
+    rpe_cmd_recorder_t* rec,
+    arena_t* arena);
+
 void rpe_command_bucket_reset(rpe_cmd_bucket_t* bucket);
 
-rpe_cmd_packet_t* rpe_cmd_packet_create(size_t aux_mem_size, size_t cmd_size, arena_t* arena);
+rpe_cmd_packet_t* rpe_cmd_packet_create(
+    size_t aux_mem_size, size_t cmd_size, thread_arena_t* arena);
 
 void rpe_cmd_dispatch_draw(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_index_draw(vkapi_driver_t* driver, void* data);
@@ -144,6 +300,7 @@ void rpe_cmd_dispatch_push_constant(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_map_buffer(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_cond_render(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_pline_bind(vkapi_driver_t* driver, void* data);
+void rpe_cmd_dispatch_index_buffer_bind(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_scissor_cmd(vkapi_driver_t* driver, void* data);
 void rpe_cmd_dispatch_viewport_cmd(vkapi_driver_t* driver, void* data);
 
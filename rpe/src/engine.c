@@ -64,18 +64,23 @@ rpe_engine_t* rpe_engine_create(vkapi_driver_t* driver, rpe_settings_t* settings
     MAKE_DYN_ARRAY(rpe_camera_t*, &instance->perm_arena, 10, &instance->cameras);
     MAKE_DYN_ARRAY(rpe_skybox_t*, &instance->perm_arena, 5, &instance->skyboxes);
 
+    // Start the job queue now, some managers and the shader loading have a dependency on this.
+    instance->job_queue = job_queue_init(&instance->perm_arena, 10);
+    job_queue_adopt_thread(instance->job_queue);
+    // Each worker, and the adopted main thread, records into its own secondary command pools.
+    vkapi_driver_init_secondary_cmds(driver, instance->job_queue->thread_count + 1);
+
     // Load the material shaders. Held by the engine as the most logical place.
-    instance->mat_shaders[RPE_BACKEND_SHADER_STAGE_VERTEX] = program_cache_from_spirv(
+    shader_compile_request_t mat_requests[2] = {
+        {.filename = "material.vert.spv", .stage = RPE_BACKEND_SHADER_STAGE_VERTEX},
+        {.filename = "material.frag.spv", .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT}};
+    program_cache_compile_batch(
         driver->prog_manager,
         driver->context,
-        "material.vert.spv",
-        RPE_BACKEND_SHADER_STAGE_VERTEX,
-        &instance->perm_arena);
-    instance->mat_shaders[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = program_cache_from_spirv(
-        driver->prog_manager,
-        driver->context,
-        "material.frag.spv",
-        RPE_BACKEND_SHADER_STAGE_FRAGMENT,
+        instance->job_queue,
+        mat_requests,
+        2,
+        instance->mat_shaders,
         &instance->perm_arena);
 
     if ((!vkapi_is_valid_shader_handle(instance->mat_shaders[RPE_BACKEND_SHADER_STAGE_VERTEX]) ||
@@ -84,10 +89,6 @@ rpe_engine_t* rpe_engine_create(vkapi_driver_t* driver, rpe_settings_t* settings
         return NULL;
     }
 
-    // Start the job queue now, some managers may have a dependency on this.
-    instance->job_queue = job_queue_init(&instance->perm_arena, 10);
-    job_queue_adopt_thread(instance->job_queue);
-
     instance->obj_manager = rpe_obj_manager_init(&instance->perm_arena);
     instance->transform_manager = rpe_transform_manager_init(instance, &instance->perm_arena);
     instance->rend_manager = rpe_rend_manager_init(instance, &instance->perm_arena);
@@ -237,6 +238,7 @@ rpe_engine_create_renderable(rpe_engine_t* engine, rpe_material_t* mat, rpe_mesh
     rpe_renderable_t* rend = rpe_renderable_init(&engine->perm_arena);
     rend->mesh_data = mesh;
     rend->material = mat;
+    rend->key.index_type = mesh->index_type;
     rpe_material_update_vertex_constants(mat, mesh);
     DYN_ARRAY_APPEND(&engine->renderables, &rend);
     return rend;
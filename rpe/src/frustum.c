@@ -24,6 +24,46 @@
 
 #include "rpe/aabox.h"
 
+#include <utility/compiler.h>
+
+#if __AVX2__
+#define RPE_FRUSTUM_USE_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define RPE_FRUSTUM_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static RPE_FORCE_INLINE uint32_t _frustum_ctz32(uint32_t v)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return (uint32_t)idx;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static RPE_FORCE_INLINE bool _frustum_check_box(
+    rpe_frustum_t* f, float cx, float cy, float cz, float ex, float ey, float ez)
+{
+    bool visible = true;
+    for (size_t j = 0; j < 6; ++j)
+    {
+        // The distance of the box corner furthest along the plane normal, which faces inwards.
+        const float dot = f->planes[j].x * cx + fabsf(f->planes[j].x) * ex +
+            f->planes[j].y * cy + fabsf(f->planes[j].y) * ey + f->planes[j].z * cz +
+            fabsf(f->planes[j].z) * ez + f->planes[j].w;
+        visible &= dot >= 0.0f;
+    }
+    return visible;
+}
+
 void rpe_frustum_projection(rpe_frustum_t* f, math_mat4f* view_proj)
 {
     assert(f);
@@ -37,15 +77,25 @@ void rpe_frustum_projection(rpe_frustum_t* f, math_mat4f* view_proj)
         Front
     };
 
-    math_mat4f m = *view_proj;
-    // m.cols[3] = math_vec4f_mul_sca(m.cols[3], -1.0f);
+    // The planes are combinations of the matrix rows - the matrix is column major, so gather them.
+    math_vec4f rows[4];
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        rows[i] = math_vec4f_init(
+            view_proj->data[0][i],
+            view_proj->data[1][i],
+            view_proj->data[2][i],
+            view_proj->data[3][i]);
+    }
 
-    f->planes[Left] = math_vec4f_sub(m.cols[3], m.cols[0]);
-    f->planes[Right] = math_vec4f_add(m.cols[3], m.cols[0]);
-    f->planes[Bottom] = math_vec4f_sub(m.cols[3], m.cols[1]);
-    f->planes[Top] = math_vec4f_add(m.cols[3], m.cols[1]);
-    f->planes[Back] = math_vec4f_add(m.cols[3], m.cols[2]);
-    f->planes[Front] = math_vec4f_sub(m.cols[3], m.cols[2]);
+    // The normals face into the frustum. Clip space depth is zero to one, so the near plane is the
+    // depth row alone.
+    f->planes[Left] = math_vec4f_add(rows[3], rows[0]);
+    f->planes[Right] = math_vec4f_sub(rows[3], rows[0]);
+    f->planes[Bottom] = math_vec4f_add(rows[3], rows[1]);
+    f->planes[Top] = math_vec4f_sub(rows[3], rows[1]);
+    f->planes[Back] = math_vec4f_sub(rows[3], rows[2]);
+    f->planes[Front] = rows[2];
 
     for (uint8_t i = 0; i < 6; ++i)
     {
@@ -66,20 +116,181 @@ void rpe_frustum_check_intersection(
     assert(f);
     for (size_t i = 0; i < count; ++i)
     {
-        bool visible = true;
+        results[i] = (uint8_t)_frustum_check_box(
+            f, centers[i].x, centers[i].y, centers[i].z, extents[i].x, extents[i].y, extents[i].z);
+    }
+}
 
-#pragma unroll
+#if RPE_FRUSTUM_USE_AVX2
+static size_t _frustum_cull_boxes_avx2(
+    rpe_frustum_t* f, rpe_frustum_boxes_t* b, size_t start, size_t count, uint8_t* results)
+{
+    // The planes are broadcast once, with the absolute values of the normals precomputed.
+    __m256 p[6][4];
+    __m256 abs_p[6][3];
+    for (size_t j = 0; j < 6; ++j)
+    {
+        for (size_t k = 0; k < 4; ++k)
+        {
+            p[j][k] = _mm256_set1_ps(f->planes[j].data[k]);
+        }
+        for (size_t k = 0; k < 3; ++k)
+        {
+            abs_p[j][k] = _mm256_set1_ps(fabsf(f->planes[j].data[k]));
+        }
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        size_t idx = start + i;
+        __m256 cx = _mm256_loadu_ps(b->center_x + idx);
+        __m256 cy = _mm256_loadu_ps(b->center_y + idx);
+        __m256 cz = _mm256_loadu_ps(b->center_z + idx);
+        __m256 ex = _mm256_loadu_ps(b->extent_x + idx);
+        __m256 ey = _mm256_loadu_ps(b->extent_y + idx);
+        __m256 ez = _mm256_loadu_ps(b->extent_z + idx);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
         for (size_t j = 0; j < 6; ++j)
         {
-            const float dot = f->planes[j].x * centers[i].x - fabsf(f->planes[j].x) * extents[i].x +
-                f->planes[j].y * centers[i].y - fabsf(f->planes[j].y) * extents[i].y +
-                f->planes[j].z * centers[i].z - fabsf(f->planes[j].z) * extents[i].z +
-                f->planes[j].w;
+            __m256 dot = _mm256_add_ps(_mm256_mul_ps(p[j][0], cx), _mm256_mul_ps(abs_p[j][0], ex));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(p[j][1], cy));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(abs_p[j][1], ey));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(p[j][2], cz));
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(abs_p[j][2], ez));
+            dot = _mm256_add_ps(dot, p[j][3]);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(dot, zero, _CMP_GE_OQ));
+        }
 
-            visible &= dot <= 0.0f;
+        uint32_t mask = (uint32_t)_mm256_movemask_ps(visible);
+        for (size_t k = 0; k < 8; ++k)
+        {
+            results[i + k] = (uint8_t)((mask >> k) & 1);
+        }
+    }
+    return i;
+}
+#elif RPE_FRUSTUM_USE_SSE2
+static size_t _frustum_cull_boxes_sse2(
+    rpe_frustum_t* f, rpe_frustum_boxes_t* b, size_t start, size_t count, uint8_t* results)
+{
+    __m128 p[6][4];
+    __m128 abs_p[6][3];
+    for (size_t j = 0; j < 6; ++j)
+    {
+        for (size_t k = 0; k < 4; ++k)
+        {
+            p[j][k] = _mm_set1_ps(f->planes[j].data[k]);
+        }
+        for (size_t k = 0; k < 3; ++k)
+        {
+            abs_p[j][k] = _mm_set1_ps(fabsf(f->planes[j].data[k]));
+        }
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        size_t idx = start + i;
+        __m128 cx = _mm_loadu_ps(b->center_x + idx);
+        __m128 cy = _mm_loadu_ps(b->center_y + idx);
+        __m128 cz = _mm_loadu_ps(b->center_z + idx);
+        __m128 ex = _mm_loadu_ps(b->extent_x + idx);
+        __m128 ey = _mm_loadu_ps(b->extent_y + idx);
+        __m128 ez = _mm_loadu_ps(b->extent_z + idx);
+
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t j = 0; j < 6; ++j)
+        {
+            __m128 dot = _mm_add_ps(_mm_mul_ps(p[j][0], cx), _mm_mul_ps(abs_p[j][0], ex));
+            dot = _mm_add_ps(dot, _mm_mul_ps(p[j][1], cy));
+            dot = _mm_add_ps(dot, _mm_mul_ps(abs_p[j][1], ey));
+            dot = _mm_add_ps(dot, _mm_mul_ps(p[j][2], cz));
+            dot = _mm_add_ps(dot, _mm_mul_ps(abs_p[j][2], ez));
+            dot = _mm_add_ps(dot, p[j][3]);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(dot, zero));
+        }
+
+        uint32_t mask = (uint32_t)_mm_movemask_ps(visible);
+        for (size_t k = 0; k < 4; ++k)
+        {
+            results[i + k] = (uint8_t)((mask >> k) & 1);
+        }
+    }
+    return i;
+}
+#endif
+
+void rpe_frustum_cull_boxes(
+    rpe_frustum_t* f,
+    rpe_frustum_boxes_t* boxes,
+    size_t start,
+    size_t count,
+    uint8_t* __restrict results)
+{
+    assert(f);
+    assert(boxes);
+    size_t i = 0;
+#if RPE_FRUSTUM_USE_AVX2
+    i = _frustum_cull_boxes_avx2(f, boxes, start, count, results);
+#elif RPE_FRUSTUM_USE_SSE2
+    i = _frustum_cull_boxes_sse2(f, boxes, start, count, results);
+#endif
+    for (; i < count; ++i)
+    {
+        size_t idx = start + i;
+        results[i] = (uint8_t)_frustum_check_box(
+            f,
+            boxes->center_x[idx],
+            boxes->center_y[idx],
+            boxes->center_z[idx],
+            boxes->extent_x[idx],
+            boxes->extent_y[idx],
+            boxes->extent_z[idx]);
+    }
+}
+
+size_t rpe_frustum_compact_visible(
+    uint8_t* __restrict results, size_t count, uint32_t offset, uint32_t* __restrict visible)
+{
+    size_t visible_count = 0;
+    size_t i = 0;
+#if RPE_FRUSTUM_USE_AVX2
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(results + i));
+        uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r, zero));
+        while (mask)
+        {
+            visible[visible_count++] = offset + (uint32_t)i + _frustum_ctz32(mask);
+            mask &= mask - 1;
+        }
+    }
+#elif RPE_FRUSTUM_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i r = _mm_loadu_si128((const __m128i*)(results + i));
+        uint32_t mask = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(r, zero)) & 0xffff;
+        while (mask)
+        {
+            visible[visible_count++] = offset + (uint32_t)i + _frustum_ctz32(mask);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if (results[i])
+        {
+            visible[visible_count++] = offset + (uint32_t)i;
         }
-        results[i] = (uint8_t)visible;
     }
+    return visible_count;
 }
 
 bool rpe_frustum_check_intersection_aabox(rpe_frustum_t* f, rpe_aabox_t* box)
@@ -97,9 +308,10 @@ bool rpe_frustum_check_sphere_intersect(rpe_frustum_t* f, math_vec3f* center, fl
     assert(f);
     for (size_t i = 0; i < 6; ++i)
     {
-        const float dot = f->planes[i].x * center->x + f->planes[i].y * center->y * f->planes[i].z +
-            center->z + f->planes[i].w;
-        if (dot <= -radius)
+        const float dot = f->planes[i].x * center->x + f->planes[i].y * center->y +
+            f->planes[i].z * center->z + f->planes[i].w;
+        // The plane normals face into the frustum, as with the box test.
+        if (dot < -radius)
         {
             return false;
         }
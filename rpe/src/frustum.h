@@ -22,6 +22,7 @@
 #ifndef __RPE_FRUSTUM_H__
 #define __RPE_FRUSTUM_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #include <utility/maths.h>
 
@@ -33,8 +34,29 @@ typedef struct Frustum
     math_vec4f planes[6];
 } rpe_frustum_t;
 
+/**
+ World-space boxes stored as a structure of arrays, so that the culling kernel can load the same
+ component of several boxes with a single load.
+ */
+typedef struct FrustumBoxes
+{
+    float* center_x;
+    float* center_y;
+    float* center_z;
+    float* extent_x;
+    float* extent_y;
+    float* extent_z;
+} rpe_frustum_boxes_t;
+
+/**
+ Extract the world-space frustum planes from a view-projection matrix, with the normals facing into
+ the frustum. The projection is expected to map depth to the zero to one range.
+ */
 void rpe_frustum_projection(rpe_frustum_t* f, math_mat4f* view_proj);
 
+/**
+ The scalar reference for the box visibility test, matching @sa rpe_frustum_cull_boxes.
+ */
 void rpe_frustum_check_intersection(
     rpe_frustum_t* f,
     math_vec3f* __restrict centers,
@@ -42,6 +64,34 @@ void rpe_frustum_check_intersection(
     size_t count,
     uint8_t* __restrict results);
 
+/**
+ Test a range of boxes against the frustum planes. With AVX2, eight boxes are tested per iteration
+ (four with SSE), with any remainder tested by the scalar path.
+ @param f The frustum to test against.
+ @param boxes The world-space boxes.
+ @param start The index of the first box to test.
+ @param count The number of boxes to test.
+ @param results For each box of the range, set to one if visible, otherwise zero. Indexed from
+ zero, not @sa start.
+ */
+void rpe_frustum_cull_boxes(
+    rpe_frustum_t* f,
+    rpe_frustum_boxes_t* boxes,
+    size_t start,
+    size_t count,
+    uint8_t* __restrict results);
+
+/**
+ Compact the visibility results into a list of the indices of the visible boxes.
+ @param results The visibility results as set by @sa rpe_frustum_cull_boxes.
+ @param count The number of results.
+ @param offset Added to the index of each visible result.
+ @param visible The compacted indices, in order. Must be able to hold @sa count indices.
+ @returns The number of visible indices written.
+ */
+size_t rpe_frustum_compact_visible(
+    uint8_t* __restrict results, size_t count, uint32_t offset, uint32_t* __restrict visible);
+
 bool rpe_frustum_check_intersection_aabox(rpe_frustum_t* f, rpe_aabox_t* box);
 
 bool rpe_frustum_check_sphere_intersect(rpe_frustum_t* f, math_vec3f* center, float radius);
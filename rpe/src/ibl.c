@@ -420,17 +420,16 @@ bool rpe_ibl_eqirect_to_cubemap(
         program_cache_create_program_bundle(driver->prog_manager, &engine->perm_arena);
     shader_handle_t handles[2];
 
-    handles[0] = program_cache_from_spirv(
+    shader_compile_request_t requests[2] = {
+        {.filename = "eqirect_to_cubemap.vert.spv", .stage = RPE_BACKEND_SHADER_STAGE_VERTEX},
+        {.filename = "eqirect_to_cubemap.frag.spv", .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT}};
+    program_cache_compile_batch(
         driver->prog_manager,
         driver->context,
-        "eqirect_to_cubemap.vert.spv",
-        RPE_BACKEND_SHADER_STAGE_VERTEX,
-        &engine->perm_arena);
-    handles[1] = program_cache_from_spirv(
-        driver->prog_manager,
-        driver->context,
-        "eqirect_to_cubemap.frag.spv",
-        RPE_BACKEND_SHADER_STAGE_FRAGMENT,
+        engine->job_queue,
+        requests,
+        2,
+        handles,
         &engine->perm_arena);
 
     if ((!vkapi_is_valid_shader_handle(handles[0]) || (!vkapi_is_valid_shader_handle(handles[1]))))
@@ -467,20 +466,29 @@ bool rpe_ibl_create_env_maps(ibl_t* ibl, rpe_engine_t* engine)
         "brdf.frag.spv", "specular_prefilter.frag.spv", "irradiance_envmap.frag.spv"};
     struct IblBundle* bundles[3] = {&ibl->brdf, &ibl->specular, &ibl->irradiance_envmap};
 
+    // All the shaders are loaded in a single batch - vertex and fragment pairs for each bundle.
+    shader_compile_request_t requests[6];
+    shader_handle_t handles[6];
     for (int i = 0; i < 3; ++i)
     {
-        bundles[i]->handles[RPE_BACKEND_SHADER_STAGE_VERTEX] = program_cache_from_spirv(
-            driver->prog_manager,
-            driver->context,
-            vert_shader_filenames[i],
-            RPE_BACKEND_SHADER_STAGE_VERTEX,
-            &engine->perm_arena);
-        bundles[i]->handles[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = program_cache_from_spirv(
-            driver->prog_manager,
-            driver->context,
-            frag_shader_filenames[i],
-            RPE_BACKEND_SHADER_STAGE_FRAGMENT,
-            &engine->perm_arena);
+        requests[i * 2] = (shader_compile_request_t){
+            .filename = vert_shader_filenames[i], .stage = RPE_BACKEND_SHADER_STAGE_VERTEX};
+        requests[i * 2 + 1] = (shader_compile_request_t){
+            .filename = frag_shader_filenames[i], .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT};
+    }
+    program_cache_compile_batch(
+        driver->prog_manager,
+        driver->context,
+        engine->job_queue,
+        requests,
+        6,
+        handles,
+        &engine->perm_arena);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        bundles[i]->handles[RPE_BACKEND_SHADER_STAGE_VERTEX] = handles[i * 2];
+        bundles[i]->handles[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = handles[i * 2 + 1];
 
         if ((!vkapi_is_valid_shader_handle(bundles[i]->handles[RPE_BACKEND_SHADER_STAGE_VERTEX]) ||
              (!vkapi_is_valid_shader_handle(
@@ -604,14 +612,10 @@ ibl_t* rpe_ibl_init(rpe_engine_t* engine, rpe_scene_t* scene, struct PreFilterOp
     ibl->cubemap_indices =
         vkapi_res_cache_create_index_buffer(driver->res_cache, driver, sizeof(uint32_t) * 36);
 
-    vkapi_driver_map_gpu_vertex(
-        driver,
-        ibl->cubemap_vertices,
-        cube_vertices,
-        8 * sizeof(math_vec3f),
-        ibl->cubemap_indices,
-        cube_indices,
-        36 * sizeof(uint32_t));
+    vkapi_driver_upload_vertex_data(
+        driver, ibl->cubemap_vertices, cube_vertices, 8 * sizeof(math_vec3f), 0);
+    vkapi_driver_upload_index_data(
+        driver, ibl->cubemap_indices, cube_indices, 36 * sizeof(uint32_t), 0);
 
     // The face views UBO - generate and upload to the device.
     struct FaceviewUBO ubo;
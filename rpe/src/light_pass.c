@@ -44,16 +44,16 @@ void setup_light_pass(render_graph_t* rg, rg_pass_node_t* node, void* data, void
     rpe_scene_t* scene = local_d->scene;
 
     // Get the resources from the colour pass
-    rg_handle_t position = rg_backboard_get(bb, "position");
-    rg_handle_t colour = rg_backboard_get(bb, "colour");
-    rg_handle_t normal = rg_backboard_get(bb, "normal");
-    rg_handle_t emissive = rg_backboard_get(bb, "emissive");
-    rg_handle_t pbr = rg_backboard_get(bb, "pbr");
+    rg_handle_t position = rg_backboard_get(bb, INTERN_LITERAL("position"));
+    rg_handle_t colour = rg_backboard_get(bb, INTERN_LITERAL("colour"));
+    rg_handle_t normal = rg_backboard_get(bb, INTERN_LITERAL("normal"));
+    rg_handle_t emissive = rg_backboard_get(bb, INTERN_LITERAL("emissive"));
+    rg_handle_t pbr = rg_backboard_get(bb, INTERN_LITERAL("pbr"));
 
     rg_handle_t cascade_shadow_map;
     if (scene->shadow_status == RPE_SCENE_SHADOW_STATUS_ENABLED)
     {
-        cascade_shadow_map = rg_backboard_get(bb, "CascadeShadowDepth");
+        cascade_shadow_map = rg_backboard_get(bb, INTERN_LITERAL("CascadeShadowDepth"));
     }
 
     rg_texture_desc_t t_desc = {
@@ -66,14 +66,17 @@ void setup_light_pass(render_graph_t* rg, rg_pass_node_t* node, void* data, void
     d->light = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Light", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Light"), VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
         NULL);
 
     t_desc.format = local_d->depth_format;
     d->depth = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "LightDepth", VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("LightDepth"),
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     d->light = rg_add_write(rg, d->light, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
@@ -89,15 +92,16 @@ void setup_light_pass(render_graph_t* rg, rg_pass_node_t* node, void* data, void
         ? rg_add_read(rg, cascade_shadow_map, node, VK_IMAGE_USAGE_SAMPLED_BIT).id
         : UINT32_MAX;
 
-    rg_backboard_add(bb, "light", d->light);
-    rg_backboard_add(bb, "lightDepth", d->depth);
+    rg_backboard_add(bb, INTERN_LITERAL("light"), d->light);
+    rg_backboard_add(bb, INTERN_LITERAL("lightDepth"), d->depth);
 
     rg_pass_desc_t desc = rg_pass_desc_init();
     desc.attachments.attach.colour[0] = d->light;
     desc.attachments.attach.depth = d->depth;
     desc.ds_load_clear_flags[0] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
     desc.ds_store_clear_flags[0] = RPE_BACKEND_RENDERPASS_STORE_CLEAR_FLAG_STORE;
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "LightingPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("LightingPass"), desc);
 
     d->prog_bundle = local_d->prog_bundle;
     d->scene = local_d->scene;
@@ -195,7 +199,7 @@ rg_handle_t rpe_light_pass_render(
         .scene = scene};
     rg_pass_t* p = rg_add_pass(
         rg,
-        "LightingPass",
+        INTERN_LITERAL("LightingPass"),
         setup_light_pass,
         execute_light_pass,
         sizeof(struct LightPassData),
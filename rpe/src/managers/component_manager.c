@@ -29,7 +29,7 @@
 rpe_component_manager_t* rpe_comp_manager_init(arena_t* arena)
 {
     rpe_component_manager_t* m = ARENA_MAKE_ZERO_STRUCT(arena, rpe_component_manager_t);
-    m->objects = HASH_SET_CREATE(uint64_t, uint64_t, arena);
+    m->objects = HASH_MAP_CREATE(uint64_t, uint64_t, arena);
     MAKE_DYN_ARRAY(uint64_t, arena, RPE_COMPONENT_MANAGER_MAX_FREE_ID_COUNT, &m->free_slots);
     m->index = 0;
     return m;
@@ -45,12 +45,12 @@ uint64_t rpe_comp_manager_add_obj(rpe_component_manager_t* m, rpe_object_t obj)
     if (m->free_slots.size && m->free_slots.size > RPE_OBJ_MANAGER_MIN_FREE_IDS)
     {
         ret_idx = DYN_ARRAY_POP_BACK(uint64_t, &m->free_slots);
-        void* res = hash_set_insert(&m->objects, &obj.id, &ret_idx);
+        void* res = hash_map_insert(&m->objects, &obj.id, &ret_idx);
         assert(res && "Object already exists in the map - you probably forgot to remove.");
     }
     else
     {
-        void* res = hash_set_insert(&m->objects, &obj.id, &m->index);
+        void* res = hash_map_insert(&m->objects, &obj.id, &m->index);
         assert(res && "Object already exists in the map - you probably forgot to remove.");
         ret_idx = m->index++;
     }
@@ -59,7 +59,7 @@ uint64_t rpe_comp_manager_add_obj(rpe_component_manager_t* m, rpe_object_t obj)
 
 uint64_t rpe_comp_manager_get_obj_idx(rpe_component_manager_t* m, rpe_object_t obj)
 {
-    uint64_t* obj_idx = HASH_SET_GET(&m->objects, &obj.id);
+    uint64_t* obj_idx = HASH_MAP_GET(&m->objects, &obj.id);
     if (!obj_idx)
     {
         return RPE_INVALID_OBJECT;
@@ -69,7 +69,7 @@ uint64_t rpe_comp_manager_get_obj_idx(rpe_component_manager_t* m, rpe_object_t o
 
 bool rpe_comp_manager_has_obj(rpe_component_manager_t* m, rpe_object_t obj)
 {
-    if (HASH_SET_FIND(&m->objects, &obj.id))
+    if (HASH_MAP_FIND(&m->objects, &obj.id))
     {
         return true;
     }
@@ -78,16 +78,11 @@ bool rpe_comp_manager_has_obj(rpe_component_manager_t* m, rpe_object_t obj)
 
 bool rpe_comp_manager_remove(rpe_component_manager_t* m, rpe_object_t obj)
 {
-    uint64_t* obj_idx = HASH_SET_GET(&m->objects, &obj.id);
+    uint64_t* obj_idx = HASH_MAP_GET(&m->objects, &obj.id);
     if (!obj_idx)
     {
         return false;
     }
     DYN_ARRAY_APPEND(&m->free_slots, obj_idx);
-    void* res = hash_set_erase(&m->objects, &obj.id);
-    if (!res)
-    {
-        return false;
-    }
-    return true;
+    return hash_map_erase(&m->objects, &obj.id);
 }
\ No newline at end of file
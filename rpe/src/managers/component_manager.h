@@ -26,7 +26,7 @@
 #include "rpe/object.h"
 
 #include <utility/arena.h>
-#include <utility/hash_set.h>
+#include <utility/hash_map.h>
 
 #define RPE_COMPONENT_MANAGER_MAX_FREE_ID_COUNT 1024
 
@@ -69,7 +69,7 @@
 typedef struct ComponentManager
 {
     // the Objects which contain this component and their index location
-    hash_set_t objects;
+    hash_map_t objects;
 
     // free buffer indices from destroyed Objects.
     // rather than resize buffers which will be slow, empty slots in manager
@@ -49,17 +49,16 @@ rpe_light_manager_t* rpe_light_manager_init(rpe_engine_t* engine)
         0,
         VKAPI_BUFFER_HOST_TO_GPU);
 
-    lm->shaders[RPE_BACKEND_SHADER_STAGE_VERTEX] = program_cache_from_spirv(
+    shader_compile_request_t requests[2] = {
+        {.filename = "fullscreen_quad.vert.spv", .stage = RPE_BACKEND_SHADER_STAGE_VERTEX},
+        {.filename = "lighting.frag.spv", .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT}};
+    program_cache_compile_batch(
         driver->prog_manager,
         driver->context,
-        "fullscreen_quad.vert.spv",
-        RPE_BACKEND_SHADER_STAGE_VERTEX,
-        &engine->perm_arena);
-    lm->shaders[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = program_cache_from_spirv(
-        driver->prog_manager,
-        driver->context,
-        "lighting.frag.spv",
-        RPE_BACKEND_SHADER_STAGE_FRAGMENT,
+        engine->job_queue,
+        requests,
+        2,
+        lm->shaders,
         &engine->perm_arena);
 
     if ((!vkapi_is_valid_shader_handle(lm->shaders[RPE_BACKEND_SHADER_STAGE_VERTEX]) ||
@@ -36,6 +36,7 @@
 #include <tracy/TracyC.h>
 #include <utility/hash.h>
 #include <utility/sort.h>
+#include <vulkan-api/driver.h>
 
 
 rpe_renderable_t* rpe_renderable_init(arena_t* arena)
@@ -123,6 +124,7 @@ rpe_rend_manager_t* rpe_rend_manager_init(rpe_engine_t* engine, arena_t* arena)
     MAKE_DYN_ARRAY(rpe_material_t, arena, 100, &m->materials);
     MAKE_DYN_ARRAY(rpe_mesh_t, arena, 100, &m->meshes);
     MAKE_DYN_ARRAY(rpe_vertex_alloc_info_t, arena, 100, &m->vertex_allocations);
+    MAKE_DYN_ARRAY(rpe_valloc_handle, arena, 20, &m->free_valloc_slots);
 
     m->engine = engine;
     return m;
@@ -186,22 +188,58 @@ void rpe_rend_manager_copy(
     ADD_OBJECT_TO_MANAGER(&rm->renderables, idx, &rend);
 }
 
+rpe_valloc_handle _rend_manager_add_alloc(rpe_rend_manager_t* m, rpe_vertex_alloc_info_t* info)
+{
+    rpe_valloc_handle h;
+    if (m->free_valloc_slots.size)
+    {
+        h = DYN_ARRAY_POP_BACK(rpe_valloc_handle, &m->free_valloc_slots);
+        DYN_ARRAY_SET(&m->vertex_allocations, h.id, info);
+        return h;
+    }
+    h.id = m->vertex_allocations.size;
+    DYN_ARRAY_APPEND(&m->vertex_allocations, info);
+    return h;
+}
+
 rpe_valloc_handle rpe_rend_manager_alloc_vertex_buffer(rpe_rend_manager_t* m, uint32_t vertex_size)
 {
+    assert(m);
     rpe_vertex_alloc_info_t v_info =
-        rpe_vertex_buffer_alloc_vertex_buffer(m->engine->vbuffer, vertex_size);
-    rpe_valloc_handle h = {.id = m->vertex_allocations.size};
-    DYN_ARRAY_APPEND(&m->vertex_allocations, &v_info);
-    return h;
+        rpe_vertex_buffer_alloc(m->engine->vbuffer, RPE_VERTEX_POOL_VERTEX, vertex_size);
+    return _rend_manager_add_alloc(m, &v_info);
 }
 
-rpe_valloc_handle rpe_rend_manager_alloc_index_buffer(rpe_rend_manager_t* m, uint32_t index_size)
+rpe_valloc_handle rpe_rend_manager_alloc_index_buffer(
+    rpe_rend_manager_t* m, uint32_t index_size, enum IndicesType indices_type)
 {
-    rpe_vertex_alloc_info_t i_info =
-        rpe_vertex_buffer_alloc_index_buffer(m->engine->vbuffer, index_size);
-    rpe_valloc_handle h = {.id = m->vertex_allocations.size};
-    DYN_ARRAY_APPEND(&m->vertex_allocations, &i_info);
-    return h;
+    assert(m);
+    rpe_vertex_alloc_info_t i_info = rpe_vertex_buffer_alloc(
+        m->engine->vbuffer, rpe_vertex_buffer_index_pool(indices_type), index_size);
+    return _rend_manager_add_alloc(m, &i_info);
+}
+
+void rpe_rend_manager_free_buffer(rpe_rend_manager_t* m, rpe_valloc_handle h)
+{
+    assert(m);
+    assert(h.id < m->vertex_allocations.size);
+    rpe_vertex_alloc_info_t* info =
+        DYN_ARRAY_GET_PTR(rpe_vertex_alloc_info_t, &m->vertex_allocations, h.id);
+    if (info->node == OFFSET_ALLOC_INVALID)
+    {
+        // Already freed.
+        return;
+    }
+    rpe_vertex_buffer_free(m->engine->vbuffer, info, m->engine->driver->current_frame);
+    DYN_ARRAY_APPEND(&m->free_valloc_slots, &h);
+}
+
+void rpe_rend_manager_destroy_mesh(rpe_rend_manager_t* m, rpe_mesh_t* mesh)
+{
+    assert(m);
+    assert(mesh);
+    rpe_rend_manager_free_buffer(m, mesh->v_handle);
+    rpe_rend_manager_free_buffer(m, mesh->i_handle);
 }
 
 rpe_vertex_alloc_info_t get_alloc_info(rpe_rend_manager_t* m, rpe_valloc_handle h)
@@ -225,21 +263,24 @@ rpe_mesh_t* rpe_rend_manager_create_mesh(
     rpe_vertex_alloc_info_t v_info = get_alloc_info(m, v_handle);
     rpe_vertex_alloc_info_t i_info = get_alloc_info(m, i_handle);
 
+    assert(v_info.pool == RPE_VERTEX_POOL_VERTEX);
+    assert(i_info.pool == rpe_vertex_buffer_index_pool(indices_type) &&
+        "Index allocation is not of the same type as the indices.");
     assert(vertex_size <= v_info.size);
     assert(indices_size <= i_info.size);
 
-    rpe_mesh_t mesh = {.index_offset = i_info.offset, .vertex_offset = v_info.offset};
-    rpe_vertex_buffer_copy_vert_data(engine->vbuffer, v_info, vertex_data);
-    if (indices_type == RPE_RENDERABLE_INDICES_U32)
-    {
-        rpe_vertex_buffer_copy_index_data_u32(engine->vbuffer, i_info, (int32_t*)indices);
-    }
-    else
-    {
-        rpe_vertex_buffer_copy_index_data_u16(engine->vbuffer, i_info, (int16_t*)indices);
-    }
-    mesh.index_count = indices_size;
-    mesh.mesh_flags = mesh_flags;
+    // Indices are stored in their native width, so 16-bit meshes are drawn from the 16-bit pool.
+    rpe_vertex_buffer_copy_data(engine->vbuffer, &v_info, vertex_data, vertex_size);
+    rpe_vertex_buffer_copy_data(engine->vbuffer, &i_info, indices, indices_size);
+
+    rpe_mesh_t mesh = {
+        .index_offset = i_info.offset,
+        .vertex_offset = v_info.offset,
+        .index_count = indices_size,
+        .index_type = indices_type,
+        .mesh_flags = mesh_flags,
+        .v_handle = v_handle,
+        .i_handle = i_handle};
     return DYN_ARRAY_APPEND(&m->meshes, &mesh);
 }
 
@@ -388,32 +429,134 @@ rpe_renderable_t* rpe_rend_manager_get_mesh(rpe_rend_manager_t* m, rpe_object_t*
     return DYN_ARRAY_GET_PTR(rpe_renderable_t, &m->renderables, idx);
 }
 
-#ifdef __linux__
-int sort_renderables(const void* a, const void* b, void*)
-#elif WIN32
-int sort_renderables(void* rend_manager, const void* a, const void* b)
-#endif
+rpe_rend_sort_cache_t* rpe_rend_sort_cache_init(uint32_t capacity, arena_t* arena)
+{
+    rpe_rend_sort_cache_t* c = ARENA_MAKE_ZERO_STRUCT(arena, rpe_rend_sort_cache_t);
+    c->keys = ARENA_MAKE_ARRAY(arena, uint64_t, capacity, 0);
+    c->sorted_keys = ARENA_MAKE_ARRAY(arena, uint64_t, capacity, 0);
+    c->order = ARENA_MAKE_ARRAY(arena, uint32_t, capacity, 0);
+    c->capacity = capacity;
+    return c;
+}
+
+// Re-sort when only a few keys have changed. The sorted keys still hold the previous keys, so
+// the entries whose key has changed are pulled out, sorted and then merged back in with the
+// unchanged entries, which are still in order.
+void _rend_sort_incremental(rpe_rend_sort_cache_t* cache, size_t count, arena_t* arena)
 {
-    struct RenderableInstance* a_instance = (struct RenderableInstance*)a;
-    struct RenderableInstance* b_instance = (struct RenderableInstance*)b;
-    rpe_renderable_t* a_rend = a_instance->rend;
-    rpe_renderable_t* b_rend = b_instance->rend;
-    assert(a_rend->sort_key != UINT64_MAX);
-    assert(b_rend->sort_key != UINT64_MAX);
-    if (a_rend->sort_key > b_rend->sort_key)
+    uint64_t* keys = ARENA_MAKE_ARRAY(arena, uint64_t, count, 0);
+    uint32_t* order = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    uint64_t changed_keys[RPE_REND_MANAGER_INCREMENTAL_SORT_LIMIT];
+    uint32_t changed_order[RPE_REND_MANAGER_INCREMENTAL_SORT_LIMIT];
+    size_t keep_count = 0;
+    size_t changed_count = 0;
+
+    for (size_t i = 0; i < count; ++i)
     {
-        return 1;
+        uint32_t idx = cache->order[i];
+        uint64_t key = cache->keys[idx];
+        if (key == cache->sorted_keys[i])
+        {
+            keys[keep_count] = key;
+            order[keep_count++] = idx;
+            continue;
+        }
+        assert(changed_count < RPE_REND_MANAGER_INCREMENTAL_SORT_LIMIT);
+        size_t j = changed_count++;
+        for (; j > 0 && changed_keys[j - 1] > key; --j)
+        {
+            changed_keys[j] = changed_keys[j - 1];
+            changed_order[j] = changed_order[j - 1];
+        }
+        changed_keys[j] = key;
+        changed_order[j] = idx;
     }
-    if (a_rend->sort_key < b_rend->sort_key)
+
+    size_t k = 0;
+    size_t c = 0;
+    for (size_t i = 0; i < count; ++i)
     {
-        return -1;
+        if (c == changed_count || (k < keep_count && keys[k] <= changed_keys[c]))
+        {
+            cache->sorted_keys[i] = keys[k];
+            cache->order[i] = order[k++];
+        }
+        else
+        {
+            cache->sorted_keys[i] = changed_keys[c];
+            cache->order[i] = changed_order[c++];
+        }
     }
-    return 0;
+}
+
+bool rpe_rend_manager_sort_renderables(
+    rpe_rend_sort_cache_t* cache,
+    struct RenderableInstance* instances,
+    size_t count,
+    bool force_sort,
+    arena_t* arena)
+{
+    TracyCZoneN(ctx, "RM::SortRenderables", 1);
+
+    assert(cache);
+    assert(count <= cache->capacity);
+
+    bool full_sort = force_sort || count != cache->count;
+    size_t changed_count = 0;
+    if (!full_sort)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t key = instances[i].rend->sort_key;
+            if (key != cache->keys[i])
+            {
+                cache->keys[i] = key;
+                ++changed_count;
+            }
+        }
+        full_sort = changed_count > RPE_REND_MANAGER_INCREMENTAL_SORT_LIMIT;
+    }
+
+    if (full_sort)
+    {
+        uint64_t* tmp_keys = ARENA_MAKE_ARRAY(arena, uint64_t, count, 0);
+        uint32_t* tmp_order = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t key = instances[i].rend->sort_key;
+            assert(key != UINT64_MAX);
+            cache->keys[i] = key;
+            cache->sorted_keys[i] = key;
+            cache->order[i] = i;
+        }
+        radix_sort_keys(cache->sorted_keys, cache->order, count, tmp_keys, tmp_order);
+        cache->count = count;
+    }
+    else if (changed_count > 0)
+    {
+        _rend_sort_incremental(cache, count, arena);
+    }
+
+    // The instances are rebuilt by the caller on each update, so always need reordering.
+    if (count > 0)
+    {
+        struct RenderableInstance* tmp =
+            ARENA_MAKE_ARRAY(arena, struct RenderableInstance, count, 0);
+        memcpy(tmp, instances, sizeof(struct RenderableInstance) * count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            instances[i] = tmp[cache->order[i]];
+        }
+    }
+
+    TracyCZoneEnd(ctx);
+    return full_sort || changed_count > 0;
 }
 
 void rpe_rend_manager_batch_renderables(
     rpe_rend_manager_t* m,
     struct RenderableInstance* instances,
+    uint64_t* sorted_keys,
     size_t count,
     arena_dyn_array_t* batched_renderables)
 {
@@ -427,40 +570,28 @@ void rpe_rend_manager_batch_renderables(
         return;
     }
 
-    QSORT_RS(instances, count, sizeof(struct RenderableInstance), sort_renderables, NULL);
-
-    rpe_renderable_t* rend = instances[0].rend;
-    rpe_batch_renderable_t batch = {
-        .material = rend->material,
-        .first_idx = 0,
-        .count = 1,
-        .scissor = rend->scissor,
-        .viewport = rend->viewport};
-
-    rpe_batch_renderable_t* curr_batch = DYN_ARRAY_APPEND(batched_renderables, &batch);
-    rpe_renderable_t* prev = rend;
-
-    for (size_t i = 1; i < count; ++i)
+    // Only the sorted keys are touched when scanning - the renderable is only read at the start
+    // of each batch. As the sort key also includes the scissor and viewport, changes in these
+    // params (and the index type) will result in a new batch, so these are taken from the first
+    // renderable.
+    rpe_batch_renderable_t* curr_batch = NULL;
+    for (size_t i = 0; i < count; ++i)
     {
-        rend = instances[i].rend;
-
-        if (rend->sort_key == prev->sort_key)
+        if (curr_batch && sorted_keys[i] == sorted_keys[i - 1])
         {
             ++curr_batch->count;
+            continue;
         }
-        else
-        {
-            batch.material = rend->material;
-            // As the sort key also includes the scissor and viewport which means changes in these
-            // params will result in a new batch, we just take the scissor and viewport from the
-            // first renderable.
-            batch.scissor = rend->scissor;
-            batch.viewport = rend->viewport;
-            batch.first_idx = i;
-            batch.count = 1;
-            curr_batch = DYN_ARRAY_APPEND(batched_renderables, &batch);
-        }
-        prev = rend;
+        rpe_renderable_t* rend = instances[i].rend;
+        rpe_batch_renderable_t batch = {
+            .sort_key = sorted_keys[i],
+            .material = rend->material,
+            .first_idx = i,
+            .count = 1,
+            .scissor = rend->scissor,
+            .viewport = rend->viewport,
+            .index_type = rend->key.index_type};
+        curr_batch = DYN_ARRAY_APPEND(batched_renderables, &batch);
     }
 
     TracyCZoneEnd(ctx);
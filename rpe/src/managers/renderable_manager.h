@@ -38,11 +38,14 @@ struct RenderableInstance;
 
 typedef struct Mesh
 {
-    // Note: The offsets here are into the "uber" vertex/index buffer held by the resource cache.
+    // Note: The offsets here are into the "uber" vertex/index buffer pools held by the engine.
     size_t index_count;
     uint32_t index_offset;
     uint32_t vertex_offset;
+    enum IndicesType index_type;
     enum MeshAttributeFlags mesh_flags;
+    rpe_valloc_handle v_handle;
+    rpe_valloc_handle i_handle;
 } rpe_mesh_t;
 
 typedef struct Renderable
@@ -59,22 +62,27 @@ typedef struct Renderable
     // States whether frustum culling should be skipped for this renderable.
     bool perform_cull_test;
 
-    // Used for the material key - batching is dependent on viewport/scissor changes.
+    // Used for the material key - batching is dependent on viewport/scissor changes and the
+    // index buffer the mesh is drawn from.
     struct RenderableKey
     {
         rpe_rect2d_t scissor;
         rpe_viewport_t viewport;
+        enum IndicesType index_type;
     } key;
 
 } rpe_renderable_t;
 
 typedef struct BatchedDraw
 {
+    /// The sort key shared by all renderables in the batch.
+    uint64_t sort_key;
     rpe_material_t* material;
     uint32_t first_idx;
     uint32_t count;
     rpe_rect2d_t scissor;
     rpe_viewport_t viewport;
+    enum IndicesType index_type;
 } rpe_batch_renderable_t;
 
 // clang-format off
@@ -89,6 +97,27 @@ struct IndirectDraw
 };                                              // Total : 40bytes.
 // clang-format on
 
+// If no more than this number of renderables have a new sort key since the last update, they are
+// merged into the previous order rather than carrying out a full radix sort.
+#define RPE_REND_MANAGER_INCREMENTAL_SORT_LIMIT 32
+
+/**
+ The sorted order of a set of renderable instances, kept between updates so that the instances
+ only need a full sort when the set changes.
+ */
+typedef struct RenderableSortCache
+{
+    /// The sort key of each instance, in the order the instances were given.
+    uint64_t* keys;
+    /// The sort keys in sorted order.
+    uint64_t* sorted_keys;
+    /// The sorted order as indices into the instances.
+    uint32_t* order;
+    /// The number of instances sorted by the last update.
+    uint32_t count;
+    uint32_t capacity;
+} rpe_rend_sort_cache_t;
+
 typedef struct RenderableManager
 {
     rpe_engine_t* engine;
@@ -96,6 +125,7 @@ typedef struct RenderableManager
     arena_dyn_array_t materials;
     arena_dyn_array_t meshes;
     arena_dyn_array_t vertex_allocations;
+    arena_dyn_array_t free_valloc_slots;
     rpe_comp_manager_t* comp_manager;
 
 } rpe_rend_manager_t;
@@ -106,9 +136,36 @@ rpe_rend_manager_t* rpe_rend_manager_init(rpe_engine_t* engine, arena_t* arena);
 
 rpe_renderable_t* rpe_rend_manager_get_mesh(rpe_rend_manager_t* m, rpe_object_t* obj);
 
+rpe_rend_sort_cache_t* rpe_rend_sort_cache_init(uint32_t capacity, arena_t* arena);
+
+/**
+ Sort the instances in place by the sort key of their renderable. If the instance count is
+ unchanged, only the keys which differ from the previous update are re-sorted.
+ @param cache The sorted order from the previous update.
+ @param instances The instances to sort - these should be in the same order on each update.
+ @param count The number of instances. Must be no greater than the capacity of the cache.
+ @param force_sort If true, a full sort is carried out - required if the set of instances has
+ changed.
+ @param arena An arena used for temporary allocations.
+ @return true if any sort key has changed, meaning the batches need rebuilding.
+ */
+bool rpe_rend_manager_sort_renderables(
+    rpe_rend_sort_cache_t* cache,
+    struct RenderableInstance* instances,
+    size_t count,
+    bool force_sort,
+    arena_t* arena);
+
+/**
+ Build the draw batches from sorted instances. A new batch is started whenever the sort key
+ changes.
+ @param instances The instances in sorted order.
+ @param sorted_keys The sort key of each instance, in the same order as the instances.
+ */
 void rpe_rend_manager_batch_renderables(
     rpe_rend_manager_t* m,
     struct RenderableInstance* instances,
+    uint64_t* sorted_keys,
     size_t count,
     arena_dyn_array_t* batched_renderables);
 
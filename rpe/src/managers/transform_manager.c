@@ -27,6 +27,8 @@
 #include "rpe/transform_manager.h"
 #include "scene.h"
 
+#include <string.h>
+
 math_mat4f compute_trs(rpe_model_transform_t* transform)
 {
     math_mat4f T = math_mat4f_identity();
@@ -44,12 +46,297 @@ rpe_model_transform_t rpe_model_transform_init()
     return i;
 }
 
-rpe_transform_node_t rpe_transform_node_init()
+void rpe_transform_hierarchy_init(rpe_transform_hierarchy_t* h, uint32_t capacity, arena_t* arena)
+{
+    assert(h);
+    MAKE_DYN_ARRAY(math_mat4f, arena, capacity, &h->local_transforms);
+    MAKE_DYN_ARRAY(math_mat4f, arena, capacity, &h->world_transforms);
+    MAKE_DYN_ARRAY(uint32_t, arena, capacity, &h->parents);
+    MAKE_DYN_ARRAY(uint32_t, arena, capacity, &h->slots);
+    MAKE_DYN_ARRAY(uint8_t, arena, capacity, &h->dirty);
+    MAKE_DYN_ARRAY(uint32_t, arena, capacity, &h->slot_to_pos);
+    MAKE_DYN_ARRAY(uint32_t, arena, capacity, &h->subtree_ends);
+    h->first_dirty = RPE_TRANSFORM_NODE_INVALID;
+}
+
+uint32_t _hierarchy_get_pos(rpe_transform_hierarchy_t* h, uint32_t slot)
+{
+    assert(slot < h->slot_to_pos.size);
+    uint32_t pos = DYN_ARRAY_GET(uint32_t, &h->slot_to_pos, slot);
+    assert(pos != RPE_TRANSFORM_NODE_INVALID);
+    return pos;
+}
+
+void _hierarchy_mark_dirty(rpe_transform_hierarchy_t* h, uint32_t pos)
+{
+    uint8_t dirty = 1;
+    DYN_ARRAY_SET(&h->dirty, pos, &dirty);
+    h->first_dirty = pos < h->first_dirty ? pos : h->first_dirty;
+}
+
+// Extend the subtree of the node at pos, and of its parents, to include positions up to end.
+// The subtree of a parent always contains the subtrees of its children, so the walk stops at the
+// first node which already covers end.
+void _hierarchy_extend_subtree(rpe_transform_hierarchy_t* h, uint32_t pos, uint32_t end)
+{
+    uint32_t* parents = (uint32_t*)h->parents.data;
+    uint32_t* subtree_ends = (uint32_t*)h->subtree_ends.data;
+    while (pos != RPE_TRANSFORM_NODE_INVALID && subtree_ends[pos] < end)
+    {
+        subtree_ends[pos] = end;
+        pos = parents[pos];
+    }
+}
+
+void rpe_transform_hierarchy_add(
+    rpe_transform_hierarchy_t* h, uint32_t slot, math_mat4f* local_transform, uint32_t parent_slot)
+{
+    assert(h);
+    assert(local_transform);
+
+    uint32_t parent_pos = parent_slot != RPE_TRANSFORM_NODE_INVALID
+        ? _hierarchy_get_pos(h, parent_slot)
+        : RPE_TRANSFORM_NODE_INVALID;
+
+    uint32_t pos = h->slots.size;
+    uint32_t subtree_end = pos + 1;
+    uint8_t dirty = 0;
+    DYN_ARRAY_APPEND(&h->local_transforms, local_transform);
+    DYN_ARRAY_APPEND(&h->world_transforms, local_transform);
+    DYN_ARRAY_APPEND(&h->parents, &parent_pos);
+    DYN_ARRAY_APPEND(&h->slots, &slot);
+    DYN_ARRAY_APPEND(&h->dirty, &dirty);
+    DYN_ARRAY_APPEND(&h->subtree_ends, &subtree_end);
+    _hierarchy_extend_subtree(h, parent_pos, subtree_end);
+
+    if (slot >= h->slot_to_pos.size)
+    {
+        uint32_t old_size = h->slot_to_pos.size;
+        dyn_array_resize(&h->slot_to_pos, slot + 1);
+        memset(
+            (uint32_t*)h->slot_to_pos.data + old_size,
+            0xff,
+            sizeof(uint32_t) * (slot + 1 - old_size));
+    }
+    assert(
+        DYN_ARRAY_GET(uint32_t, &h->slot_to_pos, slot) == RPE_TRANSFORM_NODE_INVALID &&
+        "Slot is already in use.");
+    DYN_ARRAY_SET(&h->slot_to_pos, slot, &pos);
+
+    _hierarchy_mark_dirty(h, pos);
+}
+
+void rpe_transform_hierarchy_set_local(
+    rpe_transform_hierarchy_t* h, uint32_t slot, math_mat4f* local_transform)
+{
+    assert(h);
+    assert(local_transform);
+    uint32_t pos = _hierarchy_get_pos(h, slot);
+    DYN_ARRAY_SET(&h->local_transforms, pos, local_transform);
+    _hierarchy_mark_dirty(h, pos);
+}
+
+void rpe_transform_hierarchy_mark_dirty(rpe_transform_hierarchy_t* h, uint32_t slot)
+{
+    assert(h);
+    _hierarchy_mark_dirty(h, _hierarchy_get_pos(h, slot));
+}
+
+// Flag the node at pos and all of its children - the children can only be after the node, and
+// their parents before them, so one pass is required. Only the positions up to the end of the
+// subtree are flagged - returns the number of flags.
+uint32_t _hierarchy_find_subtree(rpe_transform_hierarchy_t* h, uint32_t pos, uint8_t* in_subtree)
+{
+    uint32_t* parents = (uint32_t*)h->parents.data;
+    uint32_t end = DYN_ARRAY_GET(uint32_t, &h->subtree_ends, pos);
+    in_subtree[0] = 1;
+    for (uint32_t i = pos + 1; i < end; ++i)
+    {
+        uint32_t parent = parents[i];
+        in_subtree[i - pos] =
+            parent != RPE_TRANSFORM_NODE_INVALID && parent >= pos && in_subtree[parent - pos];
+    }
+    return end - pos;
+}
+
+void _hierarchy_permute(arena_dyn_array_t* arr, uint32_t start, uint32_t* order, void* tmp)
+{
+    uint32_t count = arr->size - start;
+    uint32_t type_size = arr->type_size;
+    uint8_t* data = (uint8_t*)arr->data + (size_t)start * type_size;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        memcpy(
+            (uint8_t*)tmp + (size_t)i * type_size,
+            data + (size_t)order[i] * type_size,
+            type_size);
+    }
+    memcpy(data, tmp, (size_t)count * type_size);
+}
+
+void rpe_transform_hierarchy_set_parent(
+    rpe_transform_hierarchy_t* h, uint32_t slot, uint32_t parent_slot, arena_t* arena)
+{
+    assert(h);
+    assert(arena);
+    uint32_t pos = _hierarchy_get_pos(h, slot);
+    uint32_t parent_pos = _hierarchy_get_pos(h, parent_slot);
+    assert(pos != parent_pos);
+
+    if (parent_pos < pos)
+    {
+        DYN_ARRAY_SET(&h->parents, pos, &parent_pos);
+        _hierarchy_extend_subtree(h, parent_pos, DYN_ARRAY_GET(uint32_t, &h->subtree_ends, pos));
+        _hierarchy_mark_dirty(h, pos);
+        return;
+    }
+
+    // The scratch allocations are only required until this returns.
+    ptrdiff_t scratch_offset = arena->offset;
+
+    // The new parent is after the node, so move the node and its children after the parent.
+    uint32_t count = h->parents.size - pos;
+    uint8_t* in_subtree = ARENA_MAKE_ZERO_ARRAY(arena, uint8_t, count);
+    uint32_t subtree_count = _hierarchy_find_subtree(h, pos, in_subtree);
+    assert(
+        (parent_pos - pos >= subtree_count || !in_subtree[parent_pos - pos]) &&
+        "The new parent can not be a child of the node.");
+
+    // The nodes which aren't being moved keep their order, followed by the moved nodes - both
+    // groups keep their relative order so parents are still before their children.
+    uint32_t* order = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    uint32_t* new_pos = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    uint32_t idx = 0;
+    for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (in_subtree[i] == pass)
+            {
+                new_pos[i] = pos + idx;
+                order[idx++] = i;
+            }
+        }
+    }
+
+    void* tmp = arena_alloc(arena, sizeof(math_mat4f), _Alignof(math_mat4f), count, 0);
+    _hierarchy_permute(&h->local_transforms, pos, order, tmp);
+    _hierarchy_permute(&h->world_transforms, pos, order, tmp);
+    _hierarchy_permute(&h->parents, pos, order, tmp);
+    _hierarchy_permute(&h->slots, pos, order, tmp);
+    _hierarchy_permute(&h->dirty, pos, order, tmp);
+
+    uint32_t* parents = (uint32_t*)h->parents.data;
+    uint32_t* slots = (uint32_t*)h->slots.data;
+    for (uint32_t i = pos; i < h->parents.size; ++i)
+    {
+        if (parents[i] != RPE_TRANSFORM_NODE_INVALID && parents[i] >= pos)
+        {
+            parents[i] = new_pos[parents[i] - pos];
+        }
+        DYN_ARRAY_SET(&h->slot_to_pos, slots[i], &i);
+    }
+    uint32_t moved_pos = new_pos[0];
+    parents[moved_pos] = new_pos[parent_pos - pos];
+
+    // The subtrees of the moved positions are rebuilt from their children - children are after
+    // their parents, so a reverse pass visits all children before the parent.
+    uint32_t* subtree_ends = (uint32_t*)h->subtree_ends.data;
+    for (uint32_t i = pos; i < h->parents.size; ++i)
+    {
+        subtree_ends[i] = i + 1;
+    }
+    for (uint32_t i = h->parents.size; i-- > pos;)
+    {
+        _hierarchy_extend_subtree(h, parents[i], subtree_ends[i]);
+    }
+
+    // Dirty nodes which weren't moved may now be before the first dirty position.
+    h->first_dirty = pos < h->first_dirty ? pos : h->first_dirty;
+    _hierarchy_mark_dirty(h, moved_pos);
+    arena->offset = scratch_offset;
+}
+
+rpe_transform_slot_range_t rpe_transform_hierarchy_update(
+    rpe_transform_hierarchy_t* h, math_mat4f* out_transforms, uint32_t out_count)
+{
+    assert(h);
+    rpe_transform_slot_range_t range = {.start = UINT32_MAX, .end = 0};
+    if (h->first_dirty >= h->slots.size)
+    {
+        h->first_dirty = RPE_TRANSFORM_NODE_INVALID;
+        return (rpe_transform_slot_range_t){0};
+    }
+
+    math_mat4f* local = (math_mat4f*)h->local_transforms.data;
+    math_mat4f* world = (math_mat4f*)h->world_transforms.data;
+    uint32_t* parents = (uint32_t*)h->parents.data;
+    uint32_t* slots = (uint32_t*)h->slots.data;
+    uint8_t* dirty = (uint8_t*)h->dirty.data;
+
+    // A node is updated if it, or its parent, is dirty. As the parents are updated first, the
+    // dirty flag propagates down the hierarchy in the same pass.
+    uint32_t first = h->first_dirty;
+    for (uint32_t i = first; i < h->slots.size; ++i)
+    {
+        uint32_t parent = parents[i];
+        if (parent != RPE_TRANSFORM_NODE_INVALID)
+        {
+            dirty[i] |= dirty[parent];
+        }
+        if (!dirty[i])
+        {
+            continue;
+        }
+        world[i] = parent != RPE_TRANSFORM_NODE_INVALID ? math_mat4f_mul(world[parent], local[i])
+                                                        : local[i];
+        // Slots beyond the output are updated, but not reported - the range is used to upload
+        // from the output.
+        uint32_t slot = slots[i];
+        if (slot >= out_count)
+        {
+            continue;
+        }
+        if (out_transforms)
+        {
+            out_transforms[slot] = world[i];
+        }
+        range.start = slot < range.start ? slot : range.start;
+        range.end = slot + 1 > range.end ? slot + 1 : range.end;
+    }
+    memset(dirty + first, 0, h->slots.size - first);
+    h->first_dirty = RPE_TRANSFORM_NODE_INVALID;
+    return range.start < range.end ? range : (rpe_transform_slot_range_t){0};
+}
+
+uint32_t rpe_transform_hierarchy_get_parent(rpe_transform_hierarchy_t* h, uint32_t slot)
 {
-    rpe_transform_node_t n = {0};
-    n.world_transform = math_mat4f_identity();
-    n.local_transform = math_mat4f_identity();
-    return n;
+    assert(h);
+    uint32_t parent_pos = DYN_ARRAY_GET(uint32_t, &h->parents, _hierarchy_get_pos(h, slot));
+    return parent_pos != RPE_TRANSFORM_NODE_INVALID
+        ? DYN_ARRAY_GET(uint32_t, &h->slots, parent_pos)
+        : RPE_TRANSFORM_NODE_INVALID;
+}
+
+uint32_t rpe_transform_hierarchy_get_first_child(rpe_transform_hierarchy_t* h, uint32_t slot)
+{
+    assert(h);
+    uint32_t pos = _hierarchy_get_pos(h, slot);
+    uint32_t* parents = (uint32_t*)h->parents.data;
+    for (uint32_t i = pos + 1; i < h->parents.size; ++i)
+    {
+        if (parents[i] == pos)
+        {
+            return DYN_ARRAY_GET(uint32_t, &h->slots, i);
+        }
+    }
+    return RPE_TRANSFORM_NODE_INVALID;
+}
+
+math_mat4f* rpe_transform_hierarchy_get_world(rpe_transform_hierarchy_t* h, uint32_t slot)
+{
+    assert(h);
+    return DYN_ARRAY_GET_PTR(math_mat4f, &h->world_transforms, _hierarchy_get_pos(h, slot));
 }
 
 rpe_transform_manager_t* rpe_transform_manager_init(rpe_engine_t* engine, arena_t* arena)
@@ -57,7 +344,8 @@ rpe_transform_manager_t* rpe_transform_manager_init(rpe_engine_t* engine, arena_
     assert(engine);
 
     rpe_transform_manager_t* m = ARENA_MAKE_ZERO_STRUCT(arena, rpe_transform_manager_t);
-    MAKE_DYN_ARRAY(rpe_transform_node_t, arena, 100, &m->nodes);
+    rpe_transform_hierarchy_init(&m->hierarchy, 100, arena);
+    MAKE_DYN_ARRAY(rpe_object_t, arena, 100, &m->objects);
     MAKE_DYN_ARRAY(rpe_skin_instance_t, arena, 100, &m->skins);
     m->static_transforms = ARENA_MAKE_ARRAY(arena, math_mat4f, RPE_SCENE_MAX_STATIC_MODEL_COUNT, 0);
     m->skinned_transforms = ARENA_MAKE_ARRAY(arena, math_mat4f, RPE_SCENE_MAX_BONE_COUNT, 0);
@@ -80,6 +368,20 @@ rpe_transform_manager_t* rpe_transform_manager_init(rpe_engine_t* engine, arena_
     return m;
 }
 
+uint32_t _transform_manager_get_slot(rpe_transform_manager_t* m, rpe_object_t obj)
+{
+    assert(obj.id != RPE_INVALID_OBJECT);
+    uint64_t idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
+    assert(idx != RPE_INVALID_OBJECT);
+    return (uint32_t)idx;
+}
+
+void _transform_manager_add_obj(rpe_transform_manager_t* m, rpe_object_t obj)
+{
+    uint64_t idx = rpe_comp_manager_add_obj(m->comp_manager, obj);
+    ADD_OBJECT_TO_MANAGER(&m->objects, idx, &obj);
+}
+
 void rpe_transform_manager_add_node(
     rpe_transform_manager_t* m,
     math_mat4f* local_transform,
@@ -87,29 +389,13 @@ void rpe_transform_manager_add_node(
     rpe_object_t* child_obj)
 {
     assert(m);
+    assert(child_obj);
 
-    rpe_transform_node_t child_node = {
-        .local_transform = *local_transform,
-        .world_transform = *local_transform,
-        .parent = parent_obj};
-
-    if (parent_obj)
-    {
-        uint64_t parent_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *parent_obj);
-        rpe_transform_node_t* parent_node =
-            DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, parent_idx);
-        child_node.next = parent_node->first_child;
-        parent_node->first_child = child_obj;
-    }
-
-    // Request a slot for this object.
-    uint64_t idx = rpe_comp_manager_add_obj(m->comp_manager, *child_obj);
-    ADD_OBJECT_TO_MANAGER(&m->nodes, idx, &child_node);
-
-    // Update the model transform.
-    rpe_transform_manager_update_world(m, *child_obj);
-
-    m->is_dirty = true;
+    uint32_t parent_slot =
+        parent_obj ? _transform_manager_get_slot(m, *parent_obj) : RPE_TRANSFORM_NODE_INVALID;
+    _transform_manager_add_obj(m, *child_obj);
+    rpe_transform_hierarchy_add(
+        &m->hierarchy, _transform_manager_get_slot(m, *child_obj), local_transform, parent_slot);
 }
 
 void rpe_transform_manager_add_local_transform(
@@ -123,128 +409,68 @@ void rpe_transform_manager_insert_node(
     rpe_transform_manager_t* m, rpe_object_t* new_obj, rpe_object_t* parent_obj)
 {
     assert(m);
-    assert(new_obj->id != RPE_INVALID_OBJECT);
-    assert(parent_obj->id != RPE_INVALID_OBJECT);
-
-    uint64_t parent_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *parent_obj);
-    rpe_transform_node_t* parent_node =
-        DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, parent_idx);
-
-    uint64_t new_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *new_obj);
-    rpe_transform_node_t* new_node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, new_idx);
-
-    parent_node->first_child = new_obj;
-    new_node->parent = parent_obj;
-    new_node->next = parent_node->first_child;
-}
-
-void update_world_children(rpe_transform_manager_t* m, rpe_object_t* child)
-{
-    while (child)
-    {
-        uint32_t child_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *child);
-        rpe_transform_node_t* child_node =
-            DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, child_idx);
-
-        uint32_t parent_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *child_node->parent);
-        rpe_transform_node_t* parent_node =
-            DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, parent_idx);
-
-        child_node->world_transform =
-            math_mat4f_mul(parent_node->world_transform, child_node->local_transform);
-
-        if (child_node->first_child)
-        {
-            update_world_children(m, child_node->first_child);
-        }
-        child = child_node->next;
-    }
+    assert(new_obj);
+    assert(parent_obj);
+    rpe_transform_hierarchy_set_parent(
+        &m->hierarchy,
+        _transform_manager_get_slot(m, *new_obj),
+        _transform_manager_get_slot(m, *parent_obj),
+        &m->engine->scratch_arena);
 }
 
 void rpe_transform_manager_update_world(rpe_transform_manager_t* m, rpe_object_t obj)
 {
-    uint32_t child_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
-    rpe_transform_node_t* node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, child_idx);
-
-    rpe_object_t* parent = node->parent;
-    if (parent)
-    {
-        uint32_t parent_idx = rpe_comp_manager_get_obj_idx(m->comp_manager, *parent);
-        rpe_transform_node_t* parent_node =
-            DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, parent_idx);
-        node->world_transform = math_mat4f_mul(parent_node->world_transform, node->local_transform);
-    }
-    else
-    {
-        node->world_transform = node->local_transform;
-    }
-    update_world_children(m, node->first_child);
-    m->is_dirty = true;
+    assert(m);
+    rpe_transform_hierarchy_mark_dirty(&m->hierarchy, _transform_manager_get_slot(m, obj));
 }
 
-void copy_child_nodes(
+rpe_object_t rpe_transform_manager_copy(
     rpe_transform_manager_t* tm,
     rpe_obj_manager_t* om,
-    rpe_object_t* child_obj,
     rpe_object_t* parent_obj,
-    rpe_transform_node_t* parent_node,
     arena_dyn_array_t* objects)
 {
-    while (child_obj)
+    assert(tm);
+    assert(parent_obj);
+    rpe_transform_hierarchy_t* h = &tm->hierarchy;
+    arena_t* arena = &tm->engine->scratch_arena;
+    assert(objects->arena != arena && "The scratch arena is rewound before returning.");
+    // The scratch allocations are only required until this returns.
+    ptrdiff_t scratch_offset = arena->offset;
+
+    // Only the subtree is scanned - the copy is appended after it, so never adds to it.
+    uint32_t pos = _hierarchy_get_pos(h, _transform_manager_get_slot(tm, *parent_obj));
+    uint32_t count = DYN_ARRAY_GET(uint32_t, &h->subtree_ends, pos) - pos;
+    uint8_t* in_subtree = ARENA_MAKE_ZERO_ARRAY(arena, uint8_t, count);
+    _hierarchy_find_subtree(h, pos, in_subtree);
+
+    // The nodes are copied in order, so the new parent of each node has already been created.
+    uint32_t* new_slots = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    rpe_object_t new_root_obj = {.id = RPE_INVALID_OBJECT};
+    for (uint32_t i = 0; i < count; ++i)
     {
-        uint32_t child_idx = rpe_comp_manager_get_obj_idx(tm->comp_manager, *child_obj);
-        rpe_transform_node_t* child_node =
-            DYN_ARRAY_GET_PTR(rpe_transform_node_t, &tm->nodes, child_idx);
-
-        rpe_object_t new_child_obj = rpe_obj_manager_create_obj(om);
-        rpe_object_t* new_child_obj_ptr = DYN_ARRAY_APPEND(objects, &new_child_obj);
-        uint32_t new_child_idx = rpe_comp_manager_add_obj(tm->comp_manager, new_child_obj);
-
-        rpe_transform_node_t new_child_node = rpe_transform_node_init();
-        new_child_node.world_transform = child_node->world_transform;
-        new_child_node.local_transform = child_node->local_transform;
-        new_child_node.parent = parent_obj;
-        rpe_transform_node_t* new_child_node_ptr =
-            ADD_OBJECT_TO_MANAGER_UNSAFE(&tm->nodes, new_child_idx, &new_child_node);
-
-        parent_node->first_child = new_child_obj_ptr;
-
-        if (child_node->first_child)
+        if (!in_subtree[i])
+        {
+            continue;
+        }
+        uint32_t src_pos = pos + i;
+        rpe_object_t new_obj = rpe_obj_manager_create_obj(om);
+        DYN_ARRAY_APPEND(objects, &new_obj);
+        _transform_manager_add_obj(tm, new_obj);
+        new_slots[i] = _transform_manager_get_slot(tm, new_obj);
+
+        // The root of the copy has no parent.
+        uint32_t src_parent = DYN_ARRAY_GET(uint32_t, &h->parents, src_pos);
+        uint32_t parent_slot = i > 0 ? new_slots[src_parent - pos] : RPE_TRANSFORM_NODE_INVALID;
+        math_mat4f local = DYN_ARRAY_GET(math_mat4f, &h->local_transforms, src_pos);
+        rpe_transform_hierarchy_add(h, new_slots[i], &local, parent_slot);
+        if (i == 0)
         {
-            copy_child_nodes(
-                tm, om, parent_node->first_child, new_child_obj_ptr, new_child_node_ptr, objects);
+            new_root_obj = new_obj;
         }
-        child_obj = child_node->next;
     }
-}
-
-rpe_object_t rpe_transform_manager_copy(
-    rpe_transform_manager_t* tm,
-    rpe_obj_manager_t* om,
-    rpe_object_t* parent_obj,
-    arena_dyn_array_t* objects)
-{
-    rpe_object_t new_parent_obj = rpe_obj_manager_create_obj(om);
-    rpe_object_t* new_parent_obj_ptr = DYN_ARRAY_APPEND(objects, &new_parent_obj);
-
-    uint32_t new_parent_idx = rpe_comp_manager_add_obj(tm->comp_manager, new_parent_obj);
-
-    uint32_t parent_idx = rpe_comp_manager_get_obj_idx(tm->comp_manager, *parent_obj);
-    rpe_transform_node_t* parent_node =
-        DYN_ARRAY_GET_PTR(rpe_transform_node_t, &tm->nodes, parent_idx);
-
-    rpe_transform_node_t new_parent_node = rpe_transform_node_init();
-    new_parent_node.world_transform = parent_node->world_transform;
-    new_parent_node.local_transform = parent_node->local_transform;
-
-    rpe_transform_node_t* new_parent_node_ptr =
-        ADD_OBJECT_TO_MANAGER_UNSAFE(&tm->nodes, new_parent_idx, &new_parent_node);
-
-    copy_child_nodes(
-        tm, om, parent_node->first_child, new_parent_obj_ptr, new_parent_node_ptr, objects);
-
-    tm->is_dirty = true;
-    return new_parent_obj;
+    arena->offset = scratch_offset;
+    return new_root_obj;
 }
 
 /*void rpe_transform_manager_update_model_transform(
@@ -302,44 +528,29 @@ rpe_object_t rpe_transform_manager_copy(
     }
 }*/
 
-rpe_transform_node_t* rpe_transform_manager_get_node(rpe_transform_manager_t* m, rpe_object_t obj)
+math_mat4f* rpe_transform_manager_get_world(rpe_transform_manager_t* m, rpe_object_t obj)
 {
-    uint64_t idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
-    assert(idx != RPE_INVALID_OBJECT);
-    assert(idx <= m->nodes.size);
-    return DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, idx);
+    assert(m);
+    return rpe_transform_hierarchy_get_world(&m->hierarchy, _transform_manager_get_slot(m, obj));
 }
 
 void rpe_transform_manager_update_ssbo(rpe_transform_manager_t* m)
 {
-    if (!m->is_dirty)
+    assert(m);
+    rpe_transform_slot_range_t range = rpe_transform_hierarchy_update(
+        &m->hierarchy, m->static_transforms, RPE_SCENE_MAX_STATIC_MODEL_COUNT);
+    if (range.start >= range.end)
     {
         return;
     }
 
-    // uint32_t bone_count = 0;
-    for (size_t i = 0; i < m->nodes.size; ++i)
-    {
-        rpe_transform_node_t* node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, i);
-        m->static_transforms[i] = node->world_transform;
-        /*if (p->joint_matrices.size > 0)
-        {
-            assert(bone_count < RPE_SCENE_MAX_BONE_COUNT);
-            // TODO: This needs checking if it actually works.
-            memcpy(
-                m->skinned_transforms + bone_count,
-                p->joint_matrices.data,
-                sizeof(math_mat4f) * p->joint_matrices.size);
-            bone_count += p->joint_matrices.size;
-        }*/
-    }
-
+    // Only the range of transforms which have changed is uploaded.
     vkapi_driver_map_gpu_buffer(
         m->engine->driver,
         m->transform_buffer_handle,
-        m->nodes.size * sizeof(math_mat4f),
-        0,
-        m->static_transforms->data);
+        (range.end - range.start) * sizeof(math_mat4f),
+        range.start * sizeof(math_mat4f),
+        m->static_transforms + range.start);
 
     /*if (bone_count > 0)
     {
@@ -350,34 +561,32 @@ void rpe_transform_manager_update_ssbo(rpe_transform_manager_t* m)
             0,
             m->skinned_transforms->data);
     }*/
-    m->is_dirty = false;
 }
 
 rpe_object_t* rpe_transform_manager_get_parent(rpe_transform_manager_t* m, rpe_object_t obj)
 {
     assert(m);
-    uint64_t idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
-    assert(idx != RPE_INVALID_OBJECT);
-    rpe_transform_node_t* node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, idx);
-    return node->parent;
+    uint32_t parent_slot =
+        rpe_transform_hierarchy_get_parent(&m->hierarchy, _transform_manager_get_slot(m, obj));
+    return parent_slot != RPE_TRANSFORM_NODE_INVALID
+        ? DYN_ARRAY_GET_PTR(rpe_object_t, &m->objects, parent_slot)
+        : NULL;
 }
 
 void rpe_transform_manager_set_transform(
     rpe_transform_manager_t* m, rpe_object_t obj, rpe_model_transform_t* trans)
 {
     assert(m);
-    uint64_t idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
-    assert(idx != RPE_INVALID_OBJECT);
-    rpe_transform_node_t* node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, idx);
-    node->local_transform = compute_trs(trans);
-    rpe_transform_manager_update_world(m, obj);
+    math_mat4f local = compute_trs(trans);
+    rpe_transform_hierarchy_set_local(&m->hierarchy, _transform_manager_get_slot(m, obj), &local);
 }
 
 rpe_object_t* rpe_transform_manager_get_child(rpe_transform_manager_t* m, rpe_object_t obj)
 {
     assert(m);
-    uint64_t idx = rpe_comp_manager_get_obj_idx(m->comp_manager, obj);
-    assert(idx != RPE_INVALID_OBJECT);
-    rpe_transform_node_t* node = DYN_ARRAY_GET_PTR(rpe_transform_node_t, &m->nodes, idx);
-    return node->first_child;
+    uint32_t child_slot = rpe_transform_hierarchy_get_first_child(
+        &m->hierarchy, _transform_manager_get_slot(m, obj));
+    return child_slot != RPE_TRANSFORM_NODE_INVALID
+        ? DYN_ARRAY_GET_PTR(rpe_object_t, &m->objects, child_slot)
+        : NULL;
 }
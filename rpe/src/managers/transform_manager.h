@@ -32,7 +32,6 @@
 #include <vulkan-api/resource_cache.h>
 
 #define RPE_TRANSFORM_MANAGER_MAX_BONE_COUNT 25
-#define RPE_TRANSFORM_MANAGER_MAX_NODE_COUNT 500
 
 typedef struct Engine rpe_engine_t;
 
@@ -45,20 +44,41 @@ typedef struct SkinInstance
     arena_dyn_array_t joint_nodes;
 } rpe_skin_instance_t;
 
-typedef struct TransformNode
+#define RPE_TRANSFORM_NODE_INVALID UINT32_MAX
+
+typedef struct TransformSlotRange
+{
+    uint32_t start;
+    uint32_t end;
+} rpe_transform_slot_range_t;
+
+/**
+ The transform hierarchy, stored as arrays (one per attribute) which are kept sorted so a parent
+ always comes before its children. This allows the world transforms to be updated in a single
+ linear pass without recursion. Each node is identified by its slot - the index of the transform
+ in the GPU buffer - which unlike the position in the arrays, never changes.
+ */
+typedef struct TransformHierarchy
 {
-    /// A flag indicating whether this node contains a mesh
-    /// the mesh is actually stored outside the hierarchy.
-    bool has_mesh;
-    // The transform matrix transformed by the parent matrix.
-    math_mat4f local_transform;
-    // The world transform matrix for this node.
-    math_mat4f world_transform;
-    // Parent of this node. NULL signifies the root.
-    rpe_object_t* parent;
-    rpe_object_t* first_child;
-    rpe_object_t* next;
-} rpe_transform_node_t;
+    /// The local transform of each node (math_mat4f).
+    arena_dyn_array_t local_transforms;
+    /// The local transform multiplied by the world transform of the parent (math_mat4f).
+    arena_dyn_array_t world_transforms;
+    /// The position of the parent node, or RPE_TRANSFORM_NODE_INVALID for a root node (uint32_t).
+    arena_dyn_array_t parents;
+    /// The slot of each node (uint32_t).
+    arena_dyn_array_t slots;
+    /// Whether the local transform has changed since the last update (uint8_t).
+    arena_dyn_array_t dirty;
+    /// Maps a slot to the position of the node in the arrays (uint32_t).
+    arena_dyn_array_t slot_to_pos;
+    /// One past the last position which may hold a child of the node (uint32_t). Children are
+    /// not always contiguous, but are never after this, so searches for the children of a node
+    /// don't need to scan the remainder of the hierarchy.
+    arena_dyn_array_t subtree_ends;
+    /// The position of the first dirty node - the nodes before this don't require updating.
+    uint32_t first_dirty;
+} rpe_transform_hierarchy_t;
 
 typedef struct TransformManager
 {
@@ -69,21 +89,82 @@ typedef struct TransformManager
     buffer_handle_t bone_buffer_handle;
     buffer_handle_t transform_buffer_handle;
 
-    // transform data preserved in the node hierarchical format
-    // referenced by associated Object
-    arena_dyn_array_t nodes;
+    rpe_transform_hierarchy_t hierarchy;
+    // The object associated with each slot.
+    arena_dyn_array_t objects;
 
     // skinned data - inverse bind matrices and bone info
     arena_dyn_array_t skins;
 
     rpe_component_manager_t* comp_manager;
-    bool is_dirty;
 } rpe_transform_manager_t;
 
+void rpe_transform_hierarchy_init(rpe_transform_hierarchy_t* h, uint32_t capacity, arena_t* arena);
+
+/**
+ Add a node to the hierarchy. The node is appended, so the parent is always before it.
+ @param h A pointer to the hierarchy.
+ @param slot The slot of the new node - must not already be in use.
+ @param local_transform The local transform of the node.
+ @param parent_slot The slot of the parent, or RPE_TRANSFORM_NODE_INVALID for a root node.
+ */
+void rpe_transform_hierarchy_add(
+    rpe_transform_hierarchy_t* h, uint32_t slot, math_mat4f* local_transform, uint32_t parent_slot);
+
+void rpe_transform_hierarchy_set_local(
+    rpe_transform_hierarchy_t* h, uint32_t slot, math_mat4f* local_transform);
+
+/**
+ Flag the node for updating - its children are also updated as part of the same pass.
+ */
+void rpe_transform_hierarchy_mark_dirty(rpe_transform_hierarchy_t* h, uint32_t slot);
+
+/**
+ Change the parent of a node. If the new parent is after the node, the node and its children are
+ moved to the end of the arrays (keeping their order) so parents remain before their children.
+ @param h A pointer to the hierarchy.
+ @param slot The slot of the node to move.
+ @param parent_slot The slot of the new parent. Must not be a child of the node.
+ @param arena An arena used for temporary allocations - these are released before returning.
+ */
+void rpe_transform_hierarchy_set_parent(
+    rpe_transform_hierarchy_t* h, uint32_t slot, uint32_t parent_slot, arena_t* arena);
+
+/**
+ Update the world transforms of all dirty nodes and their children.
+ @param h A pointer to the hierarchy.
+ @param out_transforms If not NULL, the updated world transforms are also written here, indexed
+ by slot.
+ @param out_count The number of elements in @sa out_transforms.
+ @returns The range of slots which were updated, clamped to @sa out_count. This is empty if nothing
+ was dirty.
+ */
+rpe_transform_slot_range_t rpe_transform_hierarchy_update(
+    rpe_transform_hierarchy_t* h, math_mat4f* out_transforms, uint32_t out_count);
+
+uint32_t rpe_transform_hierarchy_get_parent(rpe_transform_hierarchy_t* h, uint32_t slot);
+
+/**
+ Find the first child of a node. As children aren't linked, this requires a scan of the nodes
+ after the parent, so should be avoided in hot paths.
+ @returns The slot of the first child, or RPE_TRANSFORM_NODE_INVALID if the node has no children.
+ */
+uint32_t rpe_transform_hierarchy_get_first_child(rpe_transform_hierarchy_t* h, uint32_t slot);
+
+math_mat4f* rpe_transform_hierarchy_get_world(rpe_transform_hierarchy_t* h, uint32_t slot);
+
 rpe_transform_manager_t* rpe_transform_manager_init(rpe_engine_t* engine, arena_t* arena);
 
-rpe_transform_node_t* rpe_transform_manager_get_node(rpe_transform_manager_t* m, rpe_object_t obj);
+/**
+ Get the world transform of an object. This is only valid after
+ @sa rpe_transform_manager_update_ssbo and until the next node is added.
+ */
+math_mat4f* rpe_transform_manager_get_world(rpe_transform_manager_t* m, rpe_object_t obj);
 
+/**
+ Update the world transforms of the dirty nodes and upload the range of transforms which have
+ changed to the GPU.
+ */
 void rpe_transform_manager_update_ssbo(rpe_transform_manager_t* m);
 
 #endif
@@ -23,41 +23,59 @@
 #include "backboard.h"
 
 #include <assert.h>
-#include <utility/hash.h>
 
 rg_backboard_t rg_backboard_init(arena_t* arena)
 {
     rg_backboard_t i;
-    i.backboard =
-        hash_set_create(arena, murmur2_hash_string, sizeof(const char*), sizeof(rg_handle_t));
+    MAKE_DYN_ARRAY(rg_handle_t, arena, 50, &i.handles);
+    MAKE_DYN_ARRAY(intern_id_t, arena, 50, &i.used_ids);
     i.arena = arena;
     return i;
 }
 
-void rg_backboard_add(rg_backboard_t* bb, const char* name, rg_handle_t handle)
+void rg_backboard_add(rg_backboard_t* bb, intern_id_t name, rg_handle_t handle)
 {
     assert(bb);
-    void* res = hash_set_insert(&bb->backboard, (void*)name, &handle);
-    assert(res);
+    assert(name != INTERN_ID_INVALID);
+    assert(rg_handle_is_valid(handle));
+
+    rg_handle_t invalid = rg_handle_init();
+    while (bb->handles.size <= name)
+    {
+        DYN_ARRAY_APPEND(&bb->handles, &invalid);
+    }
+    rg_handle_t* h = DYN_ARRAY_GET_PTR(rg_handle_t, &bb->handles, name);
+    assert(!rg_handle_is_valid(*h) && "An entry with this name already exists.");
+    *h = handle;
+    DYN_ARRAY_APPEND(&bb->used_ids, &name);
 }
 
-rg_handle_t rg_backboard_get(rg_backboard_t* bb, const char* name)
+rg_handle_t rg_backboard_get(rg_backboard_t* bb, intern_id_t name)
 {
     assert(bb);
-    rg_handle_t* h = hash_set_get(&bb->backboard, (void*)name);
-    assert(h);
-    return *h;
+    assert(name < bb->handles.size);
+    rg_handle_t h = DYN_ARRAY_GET(rg_handle_t, &bb->handles, name);
+    assert(rg_handle_is_valid(h));
+    return h;
 }
 
-void rg_backboard_remove(rg_backboard_t* bb, const char* name)
+void rg_backboard_remove(rg_backboard_t* bb, intern_id_t name)
 {
     assert(bb);
-    rg_handle_t* h = hash_set_erase(&bb->backboard, (void*)name);
-    assert(h);
+    assert(name < bb->handles.size);
+    rg_handle_t* h = DYN_ARRAY_GET_PTR(rg_handle_t, &bb->handles, name);
+    assert(rg_handle_is_valid(*h));
+    *h = rg_handle_init();
 }
 
 void rg_backboard_reset(rg_backboard_t* bb)
 {
     assert(bb);
-    hash_set_clear(&bb->backboard);
+    rg_handle_t invalid = rg_handle_init();
+    for (uint32_t i = 0; i < bb->used_ids.size; ++i)
+    {
+        intern_id_t id = DYN_ARRAY_GET(intern_id_t, &bb->used_ids, i);
+        DYN_ARRAY_SET(&bb->handles, id, &invalid);
+    }
+    dyn_array_clear(&bb->used_ids);
 }
@@ -25,23 +25,30 @@
 
 #include "render_graph_handle.h"
 
-#include <utility/hash_set.h>
-#include <utility/string.h>
+#include <utility/arena.h>
+#include <utility/intern.h>
 
+/**
+ Shares resource handles between passes by name. Entries are indexed directly by the interned id
+ of the name, so no hashing is required on add or get.
+ */
 typedef struct BackBoard
 {
-    hash_set_t backboard;
+    /// Resource handles indexed by interned name id - invalid handles denote no entry.
+    arena_dyn_array_t handles;
+    /// The ids which have an entry, so only these need clearing on reset.
+    arena_dyn_array_t used_ids;
     arena_t* arena;
 
 } rg_backboard_t;
 
 rg_backboard_t rg_backboard_init(arena_t* arena);
 
-void rg_backboard_add(rg_backboard_t* bb, const char* name, rg_handle_t handle);
+void rg_backboard_add(rg_backboard_t* bb, intern_id_t name, rg_handle_t handle);
 
-rg_handle_t rg_backboard_get(rg_backboard_t* bb, const char* name);
+rg_handle_t rg_backboard_get(rg_backboard_t* bb, intern_id_t name);
 
-void rg_backboard_remove(rg_backboard_t* bb, const char* name);
+void rg_backboard_remove(rg_backboard_t* bb, intern_id_t name);
 
 void rg_backboard_reset(rg_backboard_t* bb);
 
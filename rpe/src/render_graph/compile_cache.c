@@ -0,0 +1,252 @@
+/* Copyright (c) 2024-2025 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compile_cache.h"
+
+#include "dependency_graph.h"
+#include "render_graph.h"
+#include "render_pass_node.h"
+#include "resources.h"
+
+#include <utility/hash.h>
+
+rg_compile_cache_t* rg_compile_cache_init(arena_t* arena)
+{
+    rg_compile_cache_t* c = ARENA_MAKE_STRUCT(arena, rg_compile_cache_t, ARENA_ZERO_MEMORY);
+    MAKE_DYN_ARRAY(int, arena, 50, &c->ref_counts);
+    MAKE_DYN_ARRAY(uint64_t, arena, 20, &c->pass_order);
+    MAKE_DYN_ARRAY(uint32_t, arena, 21, &c->pass_offsets);
+    MAKE_DYN_ARRAY(rg_handle_t, arena, 50, &c->pass_handles);
+    MAKE_DYN_ARRAY(VkImageUsageFlags, arena, 30, &c->image_usage);
+    MAKE_DYN_ARRAY(rg_cached_pass_info_t, arena, 20, &c->pass_infos);
+    return c;
+}
+
+void rg_compile_cache_hash(uint64_t* hash, const void* data, size_t size)
+{
+    assert(hash);
+    assert(data);
+    *hash = murmur2_hash64(data, size, *hash);
+}
+
+void rg_compile_cache_hash_resource(uint64_t* hash, rg_resource_t* r)
+{
+    assert(r);
+    uint32_t type = r->type;
+    rg_compile_cache_hash(hash, &type, sizeof(uint32_t));
+    if (r->type == RG_RESOURCE_TYPE_NONE)
+    {
+        return;
+    }
+
+    // The descriptor has padding, so is added field by field.
+    rg_texture_resource_t* t = (rg_texture_resource_t*)r;
+    uint32_t tex_key[] = {
+        t->image_usage,
+        t->desc.width,
+        t->desc.height,
+        t->desc.depth,
+        t->desc.mip_levels,
+        t->desc.layers,
+        t->desc.format};
+    rg_compile_cache_hash(hash, tex_key, sizeof(tex_key));
+
+    if (r->type == RG_RESOURCE_TYPE_IMPORTED_RENDER_TARGET)
+    {
+        rg_import_rt_desc_t* desc = &((rg_import_render_target_t*)r)->desc;
+        rg_compile_cache_hash(hash, desc->load_clear_flags, sizeof(desc->load_clear_flags));
+        rg_compile_cache_hash(hash, desc->store_clear_flags, sizeof(desc->store_clear_flags));
+        rg_compile_cache_hash(hash, desc->init_layouts, sizeof(desc->init_layouts));
+        rg_compile_cache_hash(hash, desc->final_layouts, sizeof(desc->final_layouts));
+        rg_compile_cache_hash(hash, &desc->clear_col, sizeof(math_vec4f));
+        uint32_t rt_key[] = {desc->usage, desc->width, desc->height, desc->samples};
+        rg_compile_cache_hash(hash, rt_key, sizeof(rt_key));
+    }
+}
+
+void rg_compile_cache_hash_pass_desc(uint64_t* hash, rg_pass_desc_t* desc)
+{
+    assert(desc);
+    rg_attach_union_t* attach = &desc->attachments;
+    rg_compile_cache_hash(hash, attach->attach_array, sizeof(attach->attach_array));
+    rg_compile_cache_hash(hash, &desc->clear_col, sizeof(math_vec4f));
+    rg_compile_cache_hash(hash, desc->ds_load_clear_flags, sizeof(desc->ds_load_clear_flags));
+    rg_compile_cache_hash(hash, desc->ds_store_clear_flags, sizeof(desc->ds_store_clear_flags));
+    uint32_t key[] = {desc->samples, desc->multi_view_count};
+    rg_compile_cache_hash(hash, key, sizeof(key));
+}
+
+bool rg_compile_cache_is_match(rg_compile_cache_t* c, render_graph_t* rg)
+{
+    assert(c);
+    assert(rg);
+    return c->is_valid && c->hash == rg->setup_hash && c->node_count == rg->dep_graph->nodes.size &&
+        c->edge_count == rg->dep_graph->edges.size && c->resource_count == rg->resources.size;
+}
+
+void rg_compile_cache_store(rg_compile_cache_t* c, render_graph_t* rg)
+{
+    assert(c);
+    assert(rg);
+    rg_dep_graph_t* dg = rg->dep_graph;
+
+    c->hash = rg->setup_hash;
+    c->node_count = dg->nodes.size;
+    c->edge_count = dg->edges.size;
+    c->resource_count = rg->resources.size;
+    c->active_count = rg->active_idx;
+    c->is_valid = true;
+
+    dyn_array_clear(&c->ref_counts);
+    for (size_t i = 0; i < dg->nodes.size; ++i)
+    {
+        rg_node_t* node = DYN_ARRAY_GET(rg_node_t*, &dg->nodes, i);
+        DYN_ARRAY_APPEND(&c->ref_counts, &node->ref_count);
+    }
+
+    dyn_array_clear(&c->pass_order);
+    dyn_array_clear(&c->pass_offsets);
+    dyn_array_clear(&c->pass_handles);
+    dyn_array_clear(&c->pass_infos);
+    for (size_t i = 0; i < rg->pass_nodes.size; ++i)
+    {
+        rg_pass_node_t* node = DYN_ARRAY_GET(rg_pass_node_t*, &rg->pass_nodes, i);
+        DYN_ARRAY_APPEND(&c->pass_order, &node->base.id);
+        if (i >= rg->active_idx)
+        {
+            continue;
+        }
+
+        uint32_t offset = c->pass_handles.size;
+        DYN_ARRAY_APPEND(&c->pass_offsets, &offset);
+        for (size_t j = 0; j < node->resource_handles.size; ++j)
+        {
+            rg_handle_t h = DYN_ARRAY_GET(rg_handle_t, &node->resource_handles, j);
+            DYN_ARRAY_APPEND(&c->pass_handles, &h);
+        }
+
+        if (!node->imported)
+        {
+            rg_render_pass_node_t* rp_node = (rg_render_pass_node_t*)node;
+            for (size_t j = 0; j < rp_node->render_pass_targets.size; ++j)
+            {
+                rg_pass_info_t* info =
+                    DYN_ARRAY_GET_PTR(rg_pass_info_t, &rp_node->render_pass_targets, j);
+                rg_cached_pass_info_t cached = {
+                    .data = info->vkapi_rpass_data, .imported = info->imported};
+                DYN_ARRAY_APPEND(&c->pass_infos, &cached);
+            }
+        }
+    }
+    uint32_t offset = c->pass_handles.size;
+    DYN_ARRAY_APPEND(&c->pass_offsets, &offset);
+
+    dyn_array_clear(&c->image_usage);
+    for (size_t i = 0; i < rg->resources.size; ++i)
+    {
+        rg_texture_resource_t* r = DYN_ARRAY_GET(rg_texture_resource_t*, &rg->resources, i);
+        DYN_ARRAY_APPEND(&c->image_usage, &r->image_usage);
+    }
+}
+
+rg_import_render_target_t*
+_compile_cache_get_import_target(render_graph_t* rg, rg_pass_info_t* info)
+{
+    for (size_t i = 0; i < VKAPI_RENDER_TARGET_MAX_ATTACH_COUNT; ++i)
+    {
+        rg_handle_t attachment = info->desc.attachments.attach_array[i];
+        if (rg_handle_is_valid(attachment))
+        {
+            rg_resource_t* r = rg_get_resource(rg, attachment);
+            if (r->type == RG_RESOURCE_TYPE_IMPORTED_RENDER_TARGET)
+            {
+                return (rg_import_render_target_t*)r;
+            }
+        }
+    }
+    return NULL;
+}
+
+void rg_compile_cache_restore(rg_compile_cache_t* c, render_graph_t* rg)
+{
+    assert(c);
+    assert(rg);
+    assert(rg_compile_cache_is_match(c, rg));
+    rg_dep_graph_t* dg = rg->dep_graph;
+
+    for (size_t i = 0; i < dg->nodes.size; ++i)
+    {
+        rg_node_t* node = DYN_ARRAY_GET(rg_node_t*, &dg->nodes, i);
+        node->ref_count = DYN_ARRAY_GET(int, &c->ref_counts, i);
+    }
+
+    assert(c->pass_order.size == rg->pass_nodes.size);
+    rg->active_idx = c->active_count;
+    size_t info_idx = 0;
+    for (size_t i = 0; i < c->pass_order.size; ++i)
+    {
+        uint64_t id = DYN_ARRAY_GET(uint64_t, &c->pass_order, i);
+        rg_pass_node_t* node = (rg_pass_node_t*)rg_dep_graph_get_node(dg, id);
+        DYN_ARRAY_SET(&rg->pass_nodes, i, &node);
+        if (i >= c->active_count)
+        {
+            continue;
+        }
+
+        node->exec_idx = i;
+        uint32_t start = DYN_ARRAY_GET(uint32_t, &c->pass_offsets, i);
+        uint32_t end = DYN_ARRAY_GET(uint32_t, &c->pass_offsets, i + 1);
+        for (uint32_t j = start; j < end; ++j)
+        {
+            rg_pass_node_add_resource(node, rg, DYN_ARRAY_GET(rg_handle_t, &c->pass_handles, j));
+        }
+
+        if (!node->imported)
+        {
+            rg_render_pass_node_t* rp_node = (rg_render_pass_node_t*)node;
+            for (size_t j = 0; j < rp_node->render_pass_targets.size; ++j)
+            {
+                rg_pass_info_t* info =
+                    DYN_ARRAY_GET_PTR(rg_pass_info_t, &rp_node->render_pass_targets, j);
+                rg_cached_pass_info_t* cached =
+                    DYN_ARRAY_GET_PTR(rg_cached_pass_info_t, &c->pass_infos, info_idx++);
+                info->vkapi_rpass_data = cached->data;
+                info->imported = cached->imported;
+                // The imported render target (i.e. the back-buffer) can change between frames.
+                if (info->imported)
+                {
+                    rg_import_render_target_t* i_target =
+                        _compile_cache_get_import_target(rg, info);
+                    assert(i_target);
+                    info->desc.rt_handle = i_target->rt_handle;
+                }
+            }
+        }
+    }
+    assert(info_idx == c->pass_infos.size);
+
+    for (size_t i = 0; i < rg->resources.size; ++i)
+    {
+        rg_texture_resource_t* r = DYN_ARRAY_GET(rg_texture_resource_t*, &rg->resources, i);
+        r->image_usage = DYN_ARRAY_GET(VkImageUsageFlags, &c->image_usage, i);
+    }
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2024-2025 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __RPE_RG_COMPILE_CACHE_H__
+#define __RPE_RG_COMPILE_CACHE_H__
+
+#include "render_graph_pass.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility/arena.h>
+#include <vulkan-api/renderpass.h>
+
+// Forward declarations.
+typedef struct RenderGraph render_graph_t;
+typedef struct Resource rg_resource_t;
+
+/// Identifies the setup call which data is added to the setup hash of a graph for.
+enum SetupHashOp
+{
+    RG_SETUP_HASH_PASS,
+    RG_SETUP_HASH_PRESENT_PASS,
+    RG_SETUP_HASH_RESOURCE,
+    RG_SETUP_HASH_MOVE,
+    RG_SETUP_HASH_READ,
+    RG_SETUP_HASH_WRITE,
+    RG_SETUP_HASH_RENDER_TARGET,
+    RG_SETUP_HASH_SIDE_EFFECT
+};
+
+typedef struct CompileStats
+{
+    /// The number of calls to @sa rg_compile which compiled the graph.
+    uint64_t compile_count;
+    /// The number of calls to @sa rg_compile which reused the previous compiled graph.
+    uint64_t skip_count;
+} rg_compile_stats_t;
+
+/**
+ The render pass data resolved by @sa rg_render_pass_node_build for a single render target.
+ */
+typedef struct CachedPassInfo
+{
+    vkapi_render_pass_data_t data;
+    bool imported;
+} rg_cached_pass_info_t;
+
+/**
+ The result of compiling a render graph. As the graph is rebuilt each frame, everything is stored
+ as an index into the graph - these are only valid when the next graph has the same structure,
+ which is given by the setup hash of the graph.
+ */
+typedef struct CompileCache
+{
+    /// The setup hash of the graph which the cache was built from.
+    uint64_t hash;
+    size_t node_count;
+    size_t edge_count;
+    size_t resource_count;
+    bool is_valid;
+
+    /// The reference count of each node in the dependency graph after culling.
+    arena_dyn_array_t ref_counts;
+    /// The node ids of the passes in execution order - followed by the culled passes.
+    arena_dyn_array_t pass_order;
+    size_t active_count;
+    /// The resources used by each active pass, in execution order. Those of pass n are
+    /// pass_handles[pass_offsets[n]..pass_offsets[n + 1]].
+    arena_dyn_array_t pass_offsets;
+    arena_dyn_array_t pass_handles;
+    /// The resolved image usage of each resource.
+    arena_dyn_array_t image_usage;
+    /// The render target info of the active render passes, in execution order.
+    arena_dyn_array_t pass_infos;
+
+    rg_compile_stats_t stats;
+} rg_compile_cache_t;
+
+rg_compile_cache_t* rg_compile_cache_init(arena_t* arena);
+
+/**
+ Add data to the setup hash of a graph.
+ @param hash The hash to update.
+ @param data The data to add - this must not contain any padding.
+ @param size The size of the data in bytes.
+ */
+void rg_compile_cache_hash(uint64_t* hash, const void* data, size_t size);
+
+/**
+ Add the type and descriptor of a resource to the setup hash of a graph. Imported handles are not
+ included as these don't change the compiled graph.
+ */
+void rg_compile_cache_hash_resource(uint64_t* hash, rg_resource_t* r);
+
+/**
+ Add a render pass descriptor to the setup hash of a graph.
+ */
+void rg_compile_cache_hash_pass_desc(uint64_t* hash, rg_pass_desc_t* desc);
+
+/**
+ Check whether the cache was built from a graph with the same structure.
+ @param c The compile cache.
+ @param rg The render graph - all passes must be setup.
+ @returns If true, the graph can be compiled with @sa rg_compile_cache_restore.
+ */
+bool rg_compile_cache_is_match(rg_compile_cache_t* c, render_graph_t* rg);
+
+/**
+ Store the result of compiling a graph.
+ @param c The compile cache.
+ @param rg A render graph which has been culled and had its passes built.
+ */
+void rg_compile_cache_store(rg_compile_cache_t* c, render_graph_t* rg);
+
+/**
+ Apply the stored result to a graph - this takes the place of culling and building the passes.
+ @param c The compile cache. @sa rg_compile_cache_is_match must be true for the graph.
+ @param rg The render graph.
+ */
+void rg_compile_cache_restore(rg_compile_cache_t* c, render_graph_t* rg);
+
+#endif
@@ -24,11 +24,13 @@
 
 #include "render_graph/render_pass_node.h"
 
-rg_node_t* rg_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena)
+#include <string.h>
+
+rg_node_t* rg_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena)
 {
     assert(dg);
     rg_node_t* i = ARENA_MAKE_STRUCT(arena, rg_node_t, ARENA_ZERO_MEMORY);
-    i->name = string_init(name, arena);
+    i->name = name;
     i->id = rg_dep_graph_create_id(dg);
     rg_dep_graph_add_node(dg, i);
     return i;
@@ -58,11 +60,23 @@ rg_edge_t* rg_edge_init(rg_dep_graph_t* dg, rg_node_t* from, rg_node_t* to, aren
     return i;
 }
 
+rg_edge_t* rg_edge_iter_next(rg_edge_iter_t* it)
+{
+    assert(it);
+    return it->idx < it->count ? it->edges[it->idx++] : NULL;
+}
+
 rg_dep_graph_t* rg_dep_graph_init(arena_t* arena)
 {
     rg_dep_graph_t* dg = ARENA_MAKE_STRUCT(arena, rg_dep_graph_t, ARENA_ZERO_MEMORY);
     MAKE_DYN_ARRAY(rg_node_t*, arena, 30, &dg->nodes);
     MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &dg->edges);
+    MAKE_DYN_ARRAY(uint32_t, arena, 31, &dg->in_offsets);
+    MAKE_DYN_ARRAY(uint32_t, arena, 31, &dg->out_offsets);
+    MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &dg->in_edges);
+    MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &dg->out_edges);
+    MAKE_DYN_ARRAY(uint32_t, arena, 30, &dg->cull_list);
+    dg->adjacency_dirty = true;
     return dg;
 }
 
@@ -71,6 +85,7 @@ void rg_dep_graph_add_node(rg_dep_graph_t* dg, rg_node_t* node)
     assert(dg);
     assert(node);
     DYN_ARRAY_APPEND(&dg->nodes, &node);
+    dg->adjacency_dirty = true;
 }
 
 size_t rg_dep_graph_create_id(rg_dep_graph_t* dg)
@@ -90,6 +105,7 @@ void rg_dep_graph_add_edge(rg_dep_graph_t* dg, rg_edge_t* edge)
 {
     assert(dg);
     DYN_ARRAY_APPEND(&dg->edges, &edge);
+    dg->adjacency_dirty = true;
 }
 
 bool rg_dep_graph_is_valid_edge(rg_dep_graph_t* dg, rg_edge_t* edge)
@@ -99,73 +115,122 @@ bool rg_dep_graph_is_valid_edge(rg_dep_graph_t* dg, rg_edge_t* edge)
     return !rg_node_is_culled(from) && !rg_node_is_culled(to);
 }
 
-arena_dyn_array_t rg_dep_graph_get_reader_edges(rg_dep_graph_t* dg, rg_node_t* node, arena_t* arena)
+void _dep_graph_build_list(
+    arena_dyn_array_t* offset_arr,
+    arena_dyn_array_t* edge_arr,
+    rg_edge_t** edges,
+    size_t node_count,
+    size_t edge_count,
+    bool use_to_id)
 {
-    assert(dg);
-    assert(node);
+    dyn_array_resize(offset_arr, node_count + 1);
+    dyn_array_resize(edge_arr, edge_count);
+    uint32_t* offsets = offset_arr->data;
+    rg_edge_t** list = edge_arr->data;
+    memset(offsets, 0, sizeof(uint32_t) * (node_count + 1));
+
+    // Count the edges of each node, shifted by one so the prefix sum gives the start of each list.
+    for (size_t i = 0; i < edge_count; ++i)
+    {
+        size_t id = use_to_id ? edges[i]->to_id : edges[i]->from_id;
+        assert(id < node_count);
+        offsets[id + 1]++;
+    }
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
 
-    arena_dyn_array_t out;
-    MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &out);
-    for (size_t i = 0; i < dg->edges.size; ++i)
+    // Each offset is used as the insertion point for its list, which leaves it at the start of the
+    // next list, so shift them back afterwards.
+    for (size_t i = 0; i < edge_count; ++i)
     {
-        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
-        if (edge->to_id == node->id)
-        {
-            DYN_ARRAY_APPEND(&out, &edge);
-        }
+        size_t id = use_to_id ? edges[i]->to_id : edges[i]->from_id;
+        list[offsets[id]++] = edges[i];
     }
-    return out;
+    for (size_t i = node_count; i > 0; --i)
+    {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
 }
 
-arena_dyn_array_t rg_dep_graph_get_writer_edges(rg_dep_graph_t* dg, rg_node_t* node, arena_t* arena)
+void rg_dep_graph_build_adjacency(rg_dep_graph_t* dg)
 {
     assert(dg);
-    assert(node);
-
-    arena_dyn_array_t out;
-    MAKE_DYN_ARRAY(rg_edge_t*, arena, 30, &out);
-    for (size_t i = 0; i < dg->edges.size; ++i)
+    if (!dg->adjacency_dirty)
     {
-        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
-        if (edge->from_id == node->id)
-        {
-            DYN_ARRAY_APPEND(&out, &edge);
-        }
+        return;
     }
-    return out;
+    rg_edge_t** edges = dg->edges.data;
+    _dep_graph_build_list(
+        &dg->in_offsets,
+        &dg->in_edges,
+        edges,
+        dg->nodes.size,
+        dg->edges.size,
+        true);
+    _dep_graph_build_list(
+        &dg->out_offsets,
+        &dg->out_edges,
+        edges,
+        dg->nodes.size,
+        dg->edges.size,
+        false);
+    dg->adjacency_dirty = false;
 }
 
-void rg_dep_graph_cull(rg_dep_graph_t* dg, arena_t* scratch_arena)
+rg_edge_iter_t _dep_graph_get_edges(
+    rg_dep_graph_t* dg, arena_dyn_array_t* offsets, arena_dyn_array_t* edges, rg_node_t* node)
 {
     assert(dg);
+    assert(node);
+    assert(node->id < dg->nodes.size);
+    rg_dep_graph_build_adjacency(dg);
+
+    uint32_t start = DYN_ARRAY_GET(uint32_t, offsets, node->id);
+    uint32_t end = DYN_ARRAY_GET(uint32_t, offsets, node->id + 1);
+    rg_edge_iter_t it = {
+        .edges = (rg_edge_t**)edges->data + start, .count = end - start, .idx = 0};
+    return it;
+}
 
-    // increase the reference count for all nodes that have a writer
-    for (size_t i = 0; i < dg->edges.size; ++i)
-    {
-        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
-        assert(edge->from_id < dg->nodes.size);
-        rg_node_t* node = DYN_ARRAY_GET(rg_node_t*, &dg->nodes, edge->from_id);
-        node->ref_count++;
-    }
+rg_edge_iter_t rg_dep_graph_get_reader_edges(rg_dep_graph_t* dg, rg_node_t* node)
+{
+    return _dep_graph_get_edges(dg, &dg->in_offsets, &dg->in_edges, node);
+}
+
+rg_edge_iter_t rg_dep_graph_get_writer_edges(rg_dep_graph_t* dg, rg_node_t* node)
+{
+    return _dep_graph_get_edges(dg, &dg->out_offsets, &dg->out_edges, node);
+}
+
+void rg_dep_graph_cull(rg_dep_graph_t* dg)
+{
+    assert(dg);
+    rg_dep_graph_build_adjacency(dg);
+    uint32_t* out_offsets = dg->out_offsets.data;
 
-    arena_dyn_array_t nodes_to_cull;
-    MAKE_DYN_ARRAY(rg_node_t*, scratch_arena, 30, &nodes_to_cull);
-    for (size_t i = 0; i < dg->nodes.size; ++i)
+    // Increase the reference count for all nodes that have a writer, and start with the nodes
+    // which have none.
+    dyn_array_clear(&dg->cull_list);
+    for (uint32_t i = 0; i < dg->nodes.size; ++i)
     {
         rg_node_t* node = DYN_ARRAY_GET(rg_node_t*, &dg->nodes, i);
+        node->ref_count += (int)(out_offsets[i + 1] - out_offsets[i]);
         if (!node->ref_count)
         {
-            DYN_ARRAY_APPEND(&nodes_to_cull, &node);
+            DYN_ARRAY_APPEND(&dg->cull_list, &i);
         }
     }
 
-    while (nodes_to_cull.size > 0)
+    while (dg->cull_list.size > 0)
     {
-        rg_node_t* node = DYN_ARRAY_POP_BACK(rg_node_t*, &nodes_to_cull);
-        arena_dyn_array_t reader_edges = rg_dep_graph_get_reader_edges(dg, node, scratch_arena);
-        for (size_t i = 0; i < reader_edges.size; ++i)
+        uint32_t id = DYN_ARRAY_POP_BACK(uint32_t, &dg->cull_list);
+        rg_edge_iter_t it = rg_dep_graph_get_reader_edges(dg, rg_dep_graph_get_node(dg, id));
+        rg_edge_t* edge;
+        while ((edge = rg_edge_iter_next(&it)))
         {
-            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &reader_edges, i);
             // remove any linked nodes that have no reference after the
             // culling of the parent node.
             rg_node_t* child_node = rg_dep_graph_get_node(dg, edge->from_id);
@@ -173,7 +238,8 @@ void rg_dep_graph_cull(rg_dep_graph_t* dg, arena_t* scratch_arena)
             assert(child_node->ref_count >= 0);
             if (!child_node->ref_count)
             {
-                DYN_ARRAY_APPEND(&nodes_to_cull, &child_node);
+                uint32_t child_id = (uint32_t)edge->from_id;
+                DYN_ARRAY_APPEND(&dg->cull_list, &child_id);
             }
         }
     }
@@ -184,4 +250,5 @@ void rg_dep_graph_clear(rg_dep_graph_t* dg)
     assert(dg);
     dyn_array_clear(&dg->nodes);
     dyn_array_clear(&dg->edges);
+    dg->adjacency_dirty = true;
 }
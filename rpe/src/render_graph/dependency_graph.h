@@ -23,11 +23,13 @@
 #ifndef __RPE_RG_DEPENDENCY_GRAPH_H__
 #define __RPE_RG_DEPENDENCY_GRAPH_H__
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <utility/arena.h>
+#include <utility/intern.h>
 #include <utility/string.h>
 
-
 typedef struct Edge
 {
     // the node id that this edge projects from
@@ -39,7 +41,7 @@ typedef struct Edge
 typedef struct Node
 {
     int ref_count;
-    string_t name;
+    intern_id_t name;
     uint64_t id;
 } rg_node_t;
 
@@ -54,9 +56,32 @@ typedef struct DependencyGraph
     // As nodes, edges are not ownded by the dependency graph but the
     // render graph, so be careful with the lifetime of the edge.
     arena_dyn_array_t edges;
+
+    // Compressed adjacency lists, built from the edges. The reader edges of node n are
+    // in_edges[in_offsets[n]..in_offsets[n + 1]] and the writer edges likewise for out_edges.
+    // The arrays are kept between frames, so once grown, rebuilding doesn't allocate.
+    arena_dyn_array_t in_offsets;
+    arena_dyn_array_t out_offsets;
+    arena_dyn_array_t in_edges;
+    arena_dyn_array_t out_edges;
+    // Set when a node or edge is added, so the adjacency lists need rebuilding.
+    bool adjacency_dirty;
+
+    // The nodes waiting to be culled.
+    arena_dyn_array_t cull_list;
 } rg_dep_graph_t;
 
-rg_node_t* rg_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena);
+/**
+ A view of the reader or writer edges of a node.
+ */
+typedef struct EdgeIterator
+{
+    rg_edge_t** edges;
+    uint32_t count;
+    uint32_t idx;
+} rg_edge_iter_t;
+
+rg_node_t* rg_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena);
 
 void rg_node_declare_side_effect(rg_node_t* node);
 
@@ -64,13 +89,39 @@ bool rg_node_is_culled(rg_node_t* node);
 
 rg_edge_t* rg_edge_init(rg_dep_graph_t* dg, rg_node_t* from, rg_node_t* to, arena_t* arena);
 
-rg_dep_graph_t* rg_dep_graph_init(arena_t* arena);
+/**
+ Get the next edge of the iterator.
+ @param it The iterator.
+ @returns The next edge, or NULL once all edges have been visited.
+ */
+rg_edge_t* rg_edge_iter_next(rg_edge_iter_t* it);
 
-arena_dyn_array_t
-rg_dep_graph_get_writer_edges(rg_dep_graph_t* dg, rg_node_t* node, arena_t* arena);
+rg_dep_graph_t* rg_dep_graph_init(arena_t* arena);
 
-arena_dyn_array_t
-rg_dep_graph_get_reader_edges(rg_dep_graph_t* dg, rg_node_t* node, arena_t* arena);
+/**
+ Build the adjacency lists if any nodes or edges have been added since they were last built. This
+ is called by the edge queries, so doesn't usually need calling directly.
+ @param dg The dependency graph.
+ */
+void rg_dep_graph_build_adjacency(rg_dep_graph_t* dg);
+
+/**
+ Get the edges written to by a node - those which project from it.
+ @param dg The dependency graph.
+ @param node The node whose edges to get.
+ @returns An iterator over the edges, in the order they were added. Valid until a node or edge is
+ added to the graph.
+ */
+rg_edge_iter_t rg_dep_graph_get_writer_edges(rg_dep_graph_t* dg, rg_node_t* node);
+
+/**
+ Get the edges read by a node - those which project to it.
+ @param dg The dependency graph.
+ @param node The node whose edges to get.
+ @returns An iterator over the edges, in the order they were added. Valid until a node or edge is
+ added to the graph.
+ */
+rg_edge_iter_t rg_dep_graph_get_reader_edges(rg_dep_graph_t* dg, rg_node_t* node);
 
 bool rg_dep_graph_is_valid_edge(rg_dep_graph_t* dg, rg_edge_t* edge);
 
@@ -82,7 +133,7 @@ void rg_dep_graph_add_node(rg_dep_graph_t* dg, rg_node_t* node);
 
 void rg_dep_graph_add_edge(rg_dep_graph_t* dg, rg_edge_t* edge);
 
-void rg_dep_graph_cull(rg_dep_graph_t* dg, arena_t* scratch_arena);
+void rg_dep_graph_cull(rg_dep_graph_t* dg);
 
 void rg_dep_graph_clear(rg_dep_graph_t* dg);
 
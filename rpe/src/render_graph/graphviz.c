@@ -33,7 +33,7 @@ string_t rg_node_get_graph_viz(rg_node_t* n, arena_t* arena)
     sprintf(
         line_buffer,
         "[label=\"node\\n name: %s id: %i, refCount: %i\", style=filled, fillcolor=green]",
-        n->name.data,
+        intern_get_string(n->name),
         n->id,
         n->ref_count);
     return string_init(line_buffer, arena);
@@ -63,14 +63,14 @@ string_t rg_dep_graph_export_graph_viz(rg_dep_graph_t* dg, arena_t* arena)
     for (size_t i = 0; i < dg->nodes.size; ++i)
     {
         rg_node_t* n = DYN_ARRAY_GET(rg_node_t*, &dg->nodes, i);
-        arena_dyn_array_t writer_edges = rg_dep_graph_get_writer_edges(dg, n, arena);
+        rg_edge_iter_t writer_edges = rg_dep_graph_get_writer_edges(dg, n);
 
         char valid_str_buffer[1024] = "\0";
         char invalid_str_buffer[1024] = "\0";
 
-        for (size_t j = 0; j < writer_edges.size; ++j)
+        rg_edge_t* edge;
+        while ((edge = rg_edge_iter_next(&writer_edges)))
         {
-            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &writer_edges, j);
             rg_node_t* link = rg_dep_graph_get_node(dg, edge->to_id);
             if (rg_dep_graph_is_valid_edge(dg, edge))
             {
@@ -43,18 +43,23 @@ render_graph_t* rg_init(arena_t* arena)
     MAKE_DYN_ARRAY(rg_resource_node_t*, arena, 20, &rg->resource_nodes);
     MAKE_DYN_ARRAY(rg_render_pass_node_t*, arena, 20, &rg->pass_nodes);
     MAKE_DYN_ARRAY(rg_pass_t*, arena, 20, &rg->rg_passes);
+    MAKE_DYN_ARRAY(rg_texture_resource_t*, arena, 20, &rg->transient_textures);
     rg->backboard = rg_backboard_init(arena);
     rg->dep_graph = rg_dep_graph_init(arena);
+    rg->transient_pool = rg_transient_pool_init(arena);
+    rg->compile_cache = rg_compile_cache_init(arena);
     rg->arena = arena;
     return rg;
 }
 
-rg_render_pass_node_t* rg_create_pass_node(render_graph_t* rg, const char* name, rg_pass_t* rg_pass)
+rg_render_pass_node_t* rg_create_pass_node(render_graph_t* rg, intern_id_t name, rg_pass_t* rg_pass)
 {
     assert(rg);
     assert(rg_pass);
     rg_pass->node = rg_render_pass_node_init(rg->dep_graph, name, rg_pass, rg->arena);
     DYN_ARRAY_APPEND(&rg->pass_nodes, &rg_pass->node);
+    uint32_t op = RG_SETUP_HASH_PASS;
+    rg_compile_cache_hash(&rg->setup_hash, &op, sizeof(uint32_t));
     return rg_pass->node;
 }
 
@@ -63,6 +68,8 @@ void rg_add_present_pass(render_graph_t* rg, rg_handle_t handle)
     assert(rg);
     rg_present_pass_node_t* node =
         rg_present_pass_node_init(rg->dep_graph, "PresentPass", rg->arena);
+    uint32_t op = RG_SETUP_HASH_PRESENT_PASS;
+    rg_compile_cache_hash(&rg->setup_hash, &op, sizeof(uint32_t));
     rg_add_read(rg, handle, (rg_pass_node_t*)node, 0);
     rg_node_declare_side_effect((rg_node_t*)node);
     DYN_ARRAY_APPEND(&rg->pass_nodes, &node);
@@ -78,9 +85,13 @@ rg_handle_t rg_add_resource(render_graph_t* rg, rg_resource_t* r, rg_handle_t* p
         .node_idx = rg->resource_nodes.size, .resource_idx = rg->resources.size};
     DYN_ARRAY_APPEND(&rg->resource_slots, &slot);
     rg_resource_node_t* r_node =
-        rg_res_node_init(rg->dep_graph, r->name.data, rg->arena, handle, parent);
+        rg_res_node_init(rg->dep_graph, r->name, rg->arena, handle, parent);
     DYN_ARRAY_APPEND(&rg->resources, &r);
     DYN_ARRAY_APPEND(&rg->resource_nodes, &r_node);
+
+    uint32_t key[] = {RG_SETUP_HASH_RESOURCE, parent ? parent->id : RG_INVALID_HANDLE};
+    rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
+    rg_compile_cache_hash_resource(&rg->setup_hash, r);
     return handle;
 }
 
@@ -98,6 +109,9 @@ rg_handle_t rg_move_resource(render_graph_t* rg, rg_handle_t from, rg_handle_t t
     // Connect the replacement node to the forwarded node.
     rg_res_node_set_alias_res_edge(rg->dep_graph, from_node, to_node, rg->arena);
     from_slot->resource_idx = to_slot->resource_idx;
+
+    uint32_t key[] = {RG_SETUP_HASH_MOVE, from.id, to.id};
+    rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
     return from;
 }
 
@@ -110,7 +124,7 @@ rg_resource_node_t* rg_get_resource_node(render_graph_t* rg, rg_handle_t handle)
 }
 
 rg_handle_t rg_import_render_target(
-    render_graph_t* rg, const char* name, rg_import_rt_desc_t desc, vkapi_rt_handle_t handle)
+    render_graph_t* rg, intern_id_t name, rg_import_rt_desc_t desc, vkapi_rt_handle_t handle)
 {
     rg_texture_desc_t r_desc = {.width = desc.width, .height = desc.height};
     // TODO: What should image usage be here?
@@ -132,6 +146,8 @@ rg_handle_t rg_add_read(
     rg_resource_node_t* node = DYN_ARRAY_GET(rg_resource_node_t*, &rg->resource_nodes, handle.id);
 
     rg_resource_connect_reader(pass_node, rg->dep_graph, node, usage, rg->arena);
+    uint32_t key[] = {RG_SETUP_HASH_READ, handle.id, (uint32_t)pass_node->base.id, usage};
+    rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
     if (rg_resource_is_sub_resource(r))
     {
         // if this is a subresource, it has a write dependency
@@ -155,6 +171,8 @@ rg_handle_t rg_add_write(
     rg_resource_node_t* node = DYN_ARRAY_GET(rg_resource_node_t*, &rg->resource_nodes, handle.id);
 
     rg_resource_connect_writer(pass_node, rg->dep_graph, node, usage, rg->arena);
+    uint32_t key[] = {RG_SETUP_HASH_WRITE, handle.id, (uint32_t)pass_node->base.id, usage};
+    rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
 
     // If it's an imported resource, make sure the pass node its writing to is not culled.
     if (r->imported)
@@ -171,13 +189,9 @@ rg_handle_t rg_add_write(
     return handle;
 }
 
-render_graph_t* rg_compile(render_graph_t* rg)
+void _rg_compile_graph(render_graph_t* rg)
 {
-    TracyCZoneN(ctx, "Rg::Compile", 1);
-
-    assert(rg);
-
-    rg_dep_graph_cull(rg->dep_graph, rg->arena);
+    rg_dep_graph_cull(rg->dep_graph);
 
     size_t tmp_idx = 0;
     rg->active_idx = 0;
@@ -205,22 +219,22 @@ render_graph_t* rg_compile(render_graph_t* rg)
     {
         assert(node_idx < rg->pass_nodes.size);
         rg_pass_node_t* pass_node = DYN_ARRAY_GET(rg_pass_node_t*, &rg->pass_nodes, node_idx);
+        pass_node->exec_idx = node_idx;
 
-        arena_dyn_array_t readers =
-            rg_dep_graph_get_reader_edges(rg->dep_graph, (rg_node_t*)pass_node, rg->arena);
-        for (size_t i = 0; i < readers.size; ++i)
+        rg_edge_t* edge;
+        rg_edge_iter_t readers =
+            rg_dep_graph_get_reader_edges(rg->dep_graph, (rg_node_t*)pass_node);
+        while ((edge = rg_edge_iter_next(&readers)))
         {
-            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &readers, i);
             rg_resource_node_t* r_node =
                 (rg_resource_node_t*)rg_dep_graph_get_node(rg->dep_graph, edge->from_id);
             rg_pass_node_add_resource(pass_node, rg, r_node->resource);
         }
 
-        arena_dyn_array_t writers =
-            rg_dep_graph_get_writer_edges(rg->dep_graph, (rg_node_t*)pass_node, rg->arena);
-        for (size_t i = 0; i < writers.size; ++i)
+        rg_edge_iter_t writers =
+            rg_dep_graph_get_writer_edges(rg->dep_graph, (rg_node_t*)pass_node);
+        while ((edge = rg_edge_iter_next(&writers)))
         {
-            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &writers, i);
             rg_resource_node_t* r_node =
                 (rg_resource_node_t*)rg_dep_graph_get_node(rg->dep_graph, edge->to_id);
             rg_pass_node_add_resource(pass_node, rg, r_node->resource);
@@ -233,6 +247,16 @@ render_graph_t* rg_compile(render_graph_t* rg)
         ++node_idx;
     }
 
+    // Update the usage flags for all resources.
+    for (size_t i = 0; i < rg->resource_nodes.size; ++i)
+    {
+        rg_resource_node_t* node = DYN_ARRAY_GET(rg_resource_node_t*, &rg->resource_nodes, i);
+        rg_res_node_update_res_usage(node, rg, rg->dep_graph);
+    }
+}
+
+void _rg_build_resource_lists(render_graph_t* rg)
+{
     // Bake the resources.
     for (size_t i = 0; i < rg->resources.size; ++i)
     {
@@ -250,12 +274,51 @@ render_graph_t* rg_compile(render_graph_t* rg)
         }
     }
 
-    // Update the usage flags for all resources.
-    for (size_t i = 0; i < rg->resource_nodes.size; ++i)
+    // Gather the transient textures along with their lifetimes (given by the execution index of
+    // the first and last passes) - these are packed into a shared memory block on execution.
+    for (size_t i = 0; i < rg->active_idx; ++i)
     {
-        rg_resource_node_t* node = DYN_ARRAY_GET(rg_resource_node_t*, &rg->resource_nodes, i);
-        rg_res_node_update_res_usage(node, rg, rg->dep_graph);
+        rg_pass_node_t* pass_node = DYN_ARRAY_GET(rg_pass_node_t*, &rg->pass_nodes, i);
+        for (size_t j = 0; j < pass_node->resources_to_bake.size; ++j)
+        {
+            rg_resource_t* r = DYN_ARRAY_GET(rg_resource_t*, &pass_node->resources_to_bake, j);
+            if (r->type == RG_RESOURCE_TYPE_TEXTURE)
+            {
+                DYN_ARRAY_APPEND(&rg->transient_textures, &r);
+            }
+        }
     }
+}
+
+render_graph_t* rg_compile(render_graph_t* rg)
+{
+    TracyCZoneN(ctx, "Rg::Compile", 1);
+
+    assert(rg);
+
+    // Side effects are declared on the nodes, so are added to the setup hash here.
+    for (size_t i = 0; i < rg->dep_graph->nodes.size; ++i)
+    {
+        rg_node_t* node = DYN_ARRAY_GET(rg_node_t*, &rg->dep_graph->nodes, i);
+        uint32_t key[] = {RG_SETUP_HASH_SIDE_EFFECT, (uint32_t)node->ref_count};
+        rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
+    }
+
+    // If the graph is unchanged from the last compile, the culling, execution order, resource
+    // lifetimes and render pass info will all be the same so are reused.
+    rg_compile_cache_t* cache = rg->compile_cache;
+    if (rg_compile_cache_is_match(cache, rg))
+    {
+        rg_compile_cache_restore(cache, rg);
+        ++cache->stats.skip_count;
+    }
+    else
+    {
+        _rg_compile_graph(rg);
+        rg_compile_cache_store(cache, rg);
+        ++cache->stats.compile_count;
+    }
+    _rg_build_resource_lists(rg);
 
     TracyCZoneEnd(ctx);
 
@@ -268,6 +331,8 @@ void rg_execute(render_graph_t* rg, vkapi_driver_t* driver, rpe_engine_t* engine
     assert(driver);
     size_t node_idx = 0;
 
+    rg_transient_pool_begin_frame(rg->transient_pool, driver, &rg->transient_textures, rg->arena);
+
     while (node_idx < rg->active_idx)
     {
         assert(node_idx < rg->pass_nodes.size);
@@ -276,7 +341,7 @@ void rg_execute(render_graph_t* rg, vkapi_driver_t* driver, rpe_engine_t* engine
 
         // Create concrete vulkan resources - these are added to the
         // node during the compile call.
-        rg_pass_node_bake_resource_list((rg_pass_node_t*)pass_node, driver);
+        rg_pass_node_bake_resource_list((rg_pass_node_t*)pass_node, rg->transient_pool, driver);
 
         if (!pass_node->base.imported)
         {
@@ -284,8 +349,10 @@ void rg_execute(render_graph_t* rg, vkapi_driver_t* driver, rpe_engine_t* engine
             rg_render_pass_node_execute(pass_node, rg, driver, engine, &r);
         }
 
-        rg_pass_node_destroy_resource_list((rg_pass_node_t*)pass_node, driver);
+        rg_pass_node_destroy_resource_list((rg_pass_node_t*)pass_node, rg->transient_pool, driver);
     }
+
+    rg_transient_pool_gc(rg->transient_pool, driver);
 }
 
 rg_resource_t* rg_get_resource(render_graph_t* rg, rg_handle_t handle)
@@ -299,7 +366,7 @@ rg_resource_t* rg_get_resource(render_graph_t* rg, rg_handle_t handle)
 
 rg_pass_t* rg_add_pass(
     render_graph_t* rg,
-    const char* name,
+    intern_id_t name,
     setup_func setup,
     execute_func execute,
     size_t data_size,
@@ -317,7 +384,7 @@ void _executor_setup(render_graph_t* rg, rg_pass_node_t* node, void* data, void*
     rg_node_declare_side_effect((rg_node_t*)node);
 }
 
-void rg_add_executor_pass(render_graph_t* rg, const char* name, execute_func execute)
+void rg_add_executor_pass(render_graph_t* rg, intern_id_t name, execute_func execute)
 {
     rg_add_pass(rg, name, _executor_setup, execute, 0, NULL);
 }
@@ -329,8 +396,10 @@ void rg_clear(render_graph_t* rg)
     dyn_array_clear(&rg->resource_slots);
     dyn_array_clear(&rg->resource_nodes);
     dyn_array_clear(&rg->rg_passes);
+    dyn_array_clear(&rg->transient_textures);
     rg_backboard_reset(&rg->backboard);
     rg_dep_graph_clear(rg->dep_graph);
+    rg->setup_hash = 0;
 }
 
 arena_t* rg_get_arena(render_graph_t* rg)
@@ -350,3 +419,15 @@ rg_backboard_t* rg_get_backboard(render_graph_t* rg)
     assert(rg);
     return &rg->backboard;
 }
+
+rg_transient_stats_t rg_get_transient_stats(render_graph_t* rg)
+{
+    assert(rg);
+    return rg->transient_pool->stats;
+}
+
+rg_compile_stats_t rg_get_compile_stats(render_graph_t* rg)
+{
+    assert(rg);
+    return rg->compile_cache->stats;
+}
@@ -24,9 +24,11 @@
 #define __RPE_RG_RENDER_GRAPH_H__
 
 #include "backboard.h"
+#include "compile_cache.h"
 #include "render_graph_handle.h"
 #include "render_graph_pass.h"
 #include "resources.h"
+#include "transient_pool.h"
 
 #include <utility/arena.h>
 #include <vulkan-api/common.h>
@@ -65,6 +67,17 @@ typedef struct RenderGraph
 
     arena_dyn_array_t resource_slots;
 
+    /// Textures which are transient to this frame, in order of first use. Set by the compiler
+    /// and used for lifetime aliasing.
+    arena_dyn_array_t transient_textures;
+    /// Recycles transient textures across frames.
+    rg_transient_pool_t* transient_pool;
+
+    /// A hash of the passes, resources and edges declared since the last call to @sa rg_clear.
+    uint64_t setup_hash;
+    /// The compiled graph from the last frame - reused when the setup hash is unchanged.
+    rg_compile_cache_t* compile_cache;
+
     /// Arena for memory allocations (frame scope).
     arena_t* arena;
     /// Number of active (non-culled) pass nodes set after a call to @sa rg_compile.
@@ -75,7 +88,7 @@ typedef struct RenderGraph
 render_graph_t* rg_init(arena_t* arena);
 
 rg_render_pass_node_t*
-rg_create_pass_node(render_graph_t* rg, const char* name, rg_pass_t* rg_pass);
+rg_create_pass_node(render_graph_t* rg, intern_id_t name, rg_pass_t* rg_pass);
 
 void rg_add_present_pass(render_graph_t* rg, rg_handle_t handle);
 
@@ -88,7 +101,7 @@ rg_resource_t* rg_get_resource(render_graph_t* rg, rg_handle_t handle);
 rg_resource_node_t* rg_get_resource_node(render_graph_t* rg, rg_handle_t handle);
 
 rg_handle_t rg_import_render_target(
-    render_graph_t* rg, const char* name, rg_import_rt_desc_t desc, vkapi_rt_handle_t handle);
+    render_graph_t* rg, intern_id_t name, rg_import_rt_desc_t desc, vkapi_rt_handle_t handle);
 
 rg_handle_t rg_add_read(
     render_graph_t* rg, rg_handle_t handle, rg_pass_node_t* pass_node, VkImageUsageFlags usage);
@@ -102,13 +115,13 @@ void rg_execute(render_graph_t* rg, vkapi_driver_t* driver, rpe_engine_t* engine
 
 rg_pass_t* rg_add_pass(
     render_graph_t* rg,
-    const char* name,
+    intern_id_t name,
     setup_func setup,
     execute_func execute,
     size_t data_size,
     void* local_data);
 
-void rg_add_executor_pass(render_graph_t* rg, const char* name, execute_func execute);
+void rg_add_executor_pass(render_graph_t* rg, intern_id_t name, execute_func execute);
 
 arena_t* rg_get_arena(render_graph_t* rg);
 
@@ -116,6 +129,17 @@ rg_dep_graph_t* rg_get_dep_graph(render_graph_t* rg);
 
 rg_backboard_t* rg_get_backboard(render_graph_t* rg);
 
+/**
+ Texture allocation statistics for the last call to @sa rg_execute.
+ */
+rg_transient_stats_t rg_get_transient_stats(render_graph_t* rg);
+
+/**
+ The number of times the graph has been compiled, and the number of times compiling was skipped
+ as the graph was unchanged from the last call to @sa rg_compile.
+ */
+rg_compile_stats_t rg_get_compile_stats(render_graph_t* rg);
+
 void rg_clear(render_graph_t* rg);
 
 #endif
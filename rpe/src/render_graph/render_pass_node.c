@@ -32,21 +32,21 @@
 #include <string.h>
 #include <utility/maths.h>
 
-rg_pass_info_t rg_pass_info_init(const char* name, arena_t* arena)
+rg_pass_info_t rg_pass_info_init(intern_id_t name)
 {
     rg_pass_info_t i;
     memset(&i, 0, sizeof(rg_pass_info_t));
-    i.name = string_init(name, arena);
+    i.name = name;
     return i;
 }
 
-rg_pass_node_t* rg_pass_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena)
+rg_pass_node_t* rg_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena)
 {
     assert(dg);
     rg_pass_node_t* node = ARENA_MAKE_STRUCT(arena, rg_pass_node_t, ARENA_ZERO_MEMORY);
 
     // Base bode init.
-    node->base.name = string_init(name, arena);
+    node->base.name = name;
     node->base.id = rg_dep_graph_create_id(dg);
     node->base.ref_count = 0;
     rg_dep_graph_add_node(dg, (rg_node_t*)node);
@@ -58,13 +58,13 @@ rg_pass_node_t* rg_pass_node_init(rg_dep_graph_t* dg, const char* name, arena_t*
 }
 
 rg_render_pass_node_t*
-rg_render_pass_node_init(rg_dep_graph_t* dg, const char* name, rg_pass_t* rg_pass, arena_t* arena)
+rg_render_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, rg_pass_t* rg_pass, arena_t* arena)
 {
     rg_render_pass_node_t* node =
         ARENA_MAKE_STRUCT(arena, rg_render_pass_node_t, ARENA_ZERO_MEMORY);
 
     // Base node init.
-    node->base.base.name = string_init(name, arena);
+    node->base.base.name = name;
     node->base.base.id = rg_dep_graph_create_id(dg);
     node->base.base.ref_count = 0;
     node->base.imported = false;
@@ -81,13 +81,13 @@ rg_render_pass_node_init(rg_dep_graph_t* dg, const char* name, rg_pass_t* rg_pas
 }
 
 rg_present_pass_node_t*
-rg_present_pass_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena)
+rg_present_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena)
 {
     rg_present_pass_node_t* node =
         ARENA_MAKE_STRUCT(arena, rg_present_pass_node_t, ARENA_ZERO_MEMORY);
 
     // Base bode init.
-    node->base.base.name = string_init(name, arena);
+    node->base.base.name = name;
     node->base.base.id = rg_dep_graph_create_id(dg);
     node->base.base.ref_count = 0;
     node->base.imported = true;
@@ -180,25 +180,27 @@ void rg_pass_node_add_to_destroy_list(rg_pass_node_t* node, rg_resource_t* r)
     DYN_ARRAY_APPEND(&node->resources_to_destroy, &r);
 }
 
-void rg_pass_node_bake_resource_list(rg_pass_node_t* node, vkapi_driver_t* driver)
+void rg_pass_node_bake_resource_list(
+    rg_pass_node_t* node, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(node);
     assert(driver);
     for (size_t i = 0; i < node->resources_to_bake.size; ++i)
     {
         rg_resource_t* r = DYN_ARRAY_GET(rg_resource_t*, &node->resources_to_bake, i);
-        rg_resource_bake(r, driver);
+        rg_resource_bake(r, pool, driver);
     }
 }
 
-void rg_pass_node_destroy_resource_list(rg_pass_node_t* node, vkapi_driver_t* driver)
+void rg_pass_node_destroy_resource_list(
+    rg_pass_node_t* node, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(node);
     assert(driver);
     for (size_t i = 0; i < node->resources_to_destroy.size; ++i)
     {
         rg_resource_t* r = DYN_ARRAY_GET(rg_resource_t*, &node->resources_to_destroy, i);
-        rg_resource_destroy(r, driver);
+        rg_resource_destroy(r, pool, driver);
     }
 }
 
@@ -214,44 +216,62 @@ void rg_pass_node_add_resource(rg_pass_node_t* node, render_graph_t* rg, rg_hand
 }
 
 rg_handle_t rg_rpass_node_create_rt(
-    rg_render_pass_node_t* node, render_graph_t* rg, const char* name, rg_pass_desc_t desc)
+    rg_render_pass_node_t* node, render_graph_t* rg, intern_id_t name, rg_pass_desc_t desc)
 {
-    rg_pass_info_t info = rg_pass_info_init(name, rg_get_arena(rg));
-
-    arena_dyn_array_t readers =
-        rg_dep_graph_get_reader_edges(rg_get_dep_graph(rg), (rg_node_t*)node, rg_get_arena(rg));
+    rg_pass_info_t info = rg_pass_info_init(name);
 
+    // The writers are the current version of each attachment. The readers are resolved when the
+    // pass is built, once the graph is complete and the adjacency lists only need building once.
     for (size_t i = 0; i < VKAPI_RENDER_TARGET_MAX_ATTACH_COUNT; ++i)
     {
         if (rg_handle_is_valid(desc.attachments.attach_array[i]))
         {
             info.desc = desc;
-
-            // Get any resources that read or write to this pass.
-            rg_handle_t handle = desc.attachments.attach_array[i];
-            for (size_t j = 0; j < readers.size; ++j)
-            {
-                rg_edge_t* r_edge = DYN_ARRAY_GET(rg_edge_t*, &readers, j);
-                rg_resource_node_t* r_node = (rg_resource_node_t*)rg_dep_graph_get_node(
-                    rg_get_dep_graph(rg), r_edge->from_id);
-                assert(r_node);
-                if (r_node->resource.id == handle.id)
-                {
-                    info.readers[i] = r_node;
-                }
-            }
-            info.writers[i] = rg_get_resource_node(rg, handle);
-            if (info.writers[i] == info.readers[i])
-            {
-                info.writers[i] = NULL;
-            }
+            info.writers[i] = rg_get_resource_node(rg, desc.attachments.attach_array[i]);
         }
     }
     rg_handle_t handle = {.id = node->render_pass_targets.size};
     DYN_ARRAY_APPEND(&node->render_pass_targets, &info);
+
+    uint32_t key[] = {RG_SETUP_HASH_RENDER_TARGET, (uint32_t)node->base.base.id};
+    rg_compile_cache_hash(&rg->setup_hash, key, sizeof(key));
+    rg_compile_cache_hash_pass_desc(&rg->setup_hash, &desc);
     return handle;
 }
 
+void _rg_pass_info_resolve_readers(
+    rg_pass_info_t* info, rg_render_pass_node_t* node, render_graph_t* rg)
+{
+    rg_dep_graph_t* dg = rg_get_dep_graph(rg);
+    rg_edge_iter_t readers = rg_dep_graph_get_reader_edges(dg, (rg_node_t*)node);
+
+    for (size_t i = 0; i < VKAPI_RENDER_TARGET_MAX_ATTACH_COUNT; ++i)
+    {
+        rg_handle_t handle = info->desc.attachments.attach_array[i];
+        if (!rg_handle_is_valid(handle))
+        {
+            continue;
+        }
+
+        // The resource node this pass reads the attachment from, if any.
+        info->readers[i] = NULL;
+        for (size_t j = 0; j < readers.count; ++j)
+        {
+            rg_resource_node_t* r_node =
+                (rg_resource_node_t*)rg_dep_graph_get_node(dg, readers.edges[j]->from_id);
+            assert(r_node);
+            if (r_node->resource.id == handle.id)
+            {
+                info->readers[i] = r_node;
+            }
+        }
+        if (info->writers[i] == info->readers[i])
+        {
+            info->writers[i] = NULL;
+        }
+    }
+}
+
 void rg_render_pass_node_build(rg_render_pass_node_t* node, render_graph_t* rg)
 {
     uint32_t min_width = UINT32_MAX;
@@ -262,6 +282,7 @@ void rg_render_pass_node_build(rg_render_pass_node_t* node, render_graph_t* rg)
     for (size_t i = 0; i < node->render_pass_targets.size; ++i)
     {
         rg_pass_info_t* info = DYN_ARRAY_GET_PTR(rg_pass_info_t, &node->render_pass_targets, i);
+        _rg_pass_info_resolve_readers(info, node, rg);
         rg_import_render_target_t* i_target = NULL;
         vkapi_render_pass_data_t* pass_data = &info->vkapi_rpass_data;
 
@@ -296,8 +317,7 @@ void rg_render_pass_node_build(rg_render_pass_node_t* node, render_graph_t* rg)
                     }
                     // if the pass has no writers then we can clear the load op.
                     if (!info->readers[j] ||
-                        !rg_res_node_has_writers(
-                            info->readers[j], rg_get_dep_graph(rg), rg_get_arena(rg)))
+                        !rg_res_node_has_writers(info->readers[j], rg_get_dep_graph(rg)))
                     {
                         pass_data->load_clear_flags[j] =
                             RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
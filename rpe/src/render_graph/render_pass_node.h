@@ -26,6 +26,7 @@
 #include "dependency_graph.h"
 #include "render_graph_handle.h"
 #include "render_graph_pass.h"
+#include "utility/intern.h"
 #include "utility/string.h"
 #include "vulkan-api/renderpass.h"
 
@@ -36,13 +37,14 @@ typedef struct RenderGraphPass rg_pass_t;
 typedef struct VkApiDriver vkapi_driver_t;
 typedef struct RenderGraph render_graph_t;
 typedef struct Resource rg_resource_t;
+typedef struct TransientPool rg_transient_pool_t;
 
 /**
  * @brief All the information required to create a concrete vulkan renderpass
  */
 typedef struct RenderPassInfo
 {
-    string_t name;
+    intern_id_t name;
     rg_resource_node_t* readers[VKAPI_RENDER_TARGET_MAX_ATTACH_COUNT];
     rg_resource_node_t* writers[VKAPI_RENDER_TARGET_MAX_ATTACH_COUNT];
     rg_pass_desc_t desc;
@@ -55,6 +57,8 @@ typedef struct PassNode
 {
     rg_node_t base;
     bool imported;
+    /// The order in which this pass will be executed - set by the compiler.
+    uint32_t exec_idx;
     arena_dyn_array_t resources_to_bake;
     arena_dyn_array_t resources_to_destroy;
     arena_dyn_array_t resource_handles;
@@ -72,28 +76,30 @@ typedef struct PresentPassNode
     rg_pass_node_t base;
 } rg_present_pass_node_t;
 
-rg_pass_info_t rg_pass_info_init(const char* name, arena_t* arena);
+rg_pass_info_t rg_pass_info_init(intern_id_t name);
 
-rg_pass_node_t* rg_pass_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena);
+rg_pass_node_t* rg_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena);
 
 rg_render_pass_node_t*
-rg_render_pass_node_init(rg_dep_graph_t* dg, const char* name, rg_pass_t* rg_pass, arena_t* arena);
+rg_render_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, rg_pass_t* rg_pass, arena_t* arena);
 
 rg_present_pass_node_t*
-rg_present_pass_node_init(rg_dep_graph_t* dg, const char* name, arena_t* arena);
+rg_present_pass_node_init(rg_dep_graph_t* dg, intern_id_t name, arena_t* arena);
 
 void rg_pass_node_add_to_bake_list(rg_pass_node_t* node, rg_resource_t* r);
 
 void rg_pass_node_add_to_destroy_list(rg_pass_node_t* node, rg_resource_t* r);
 
-void rg_pass_node_bake_resource_list(rg_pass_node_t* node, vkapi_driver_t* driver);
+void rg_pass_node_bake_resource_list(
+    rg_pass_node_t* node, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
-void rg_pass_node_destroy_resource_list(rg_pass_node_t* node, vkapi_driver_t* driver);
+void rg_pass_node_destroy_resource_list(
+    rg_pass_node_t* node, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
 void rg_pass_node_add_resource(rg_pass_node_t* node, render_graph_t* rg, rg_handle_t handle);
 
 rg_handle_t rg_rpass_node_create_rt(
-    rg_render_pass_node_t* node, render_graph_t* rg, const char* name, rg_pass_desc_t desc);
+    rg_render_pass_node_t* node, render_graph_t* rg, intern_id_t name, rg_pass_desc_t desc);
 
 void rg_render_pass_node_build(rg_render_pass_node_t* node, render_graph_t* rg);
 
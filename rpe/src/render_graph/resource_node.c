@@ -42,7 +42,7 @@ rg_resource_edge_t* rg_resource_edge_init(
 }
 
 rg_resource_node_t* rg_res_node_init(
-    rg_dep_graph_t* dg, const char* name, arena_t* arena, rg_handle_t res, rg_handle_t* parent)
+    rg_dep_graph_t* dg, intern_id_t name, arena_t* arena, rg_handle_t res, rg_handle_t* parent)
 {
     assert(dg);
     assert(rg_handle_is_valid(res));
@@ -50,7 +50,7 @@ rg_resource_node_t* rg_res_node_init(
     rg_resource_node_t* i = ARENA_MAKE_STRUCT(arena, rg_resource_node_t, ARENA_ZERO_MEMORY);
 
     // Base node init.
-    i->base.name = string_init(name, arena);
+    i->base.name = name;
     i->base.id = rg_dep_graph_create_id(dg);
     i->base.ref_count = 0;
     rg_dep_graph_add_node(dg, (rg_node_t*)i);
@@ -144,11 +144,11 @@ bool rg_res_node_has_readers(rg_resource_node_t* rn)
     return rn->reader_passes.size > 0;
 }
 
-bool rg_res_node_has_writers(rg_resource_node_t* rn, rg_dep_graph_t* dg, arena_t* arena)
+bool rg_res_node_has_writers(rg_resource_node_t* rn, rg_dep_graph_t* dg)
 {
     assert(rn);
     assert(dg);
-    return rg_dep_graph_get_writer_edges(dg, (rg_node_t*)rn, arena).size > 0;
+    return rg_dep_graph_get_writer_edges(dg, (rg_node_t*)rn).count > 0;
 }
 
 void rg_res_node_add_resource_to_bake(rg_resource_node_t* rn, rg_resource_t* r)
@@ -165,25 +165,27 @@ void rg_res_node_add_resource_to_destroy(rg_resource_node_t* rn, rg_resource_t*
     DYN_ARRAY_APPEND(&rn->resources_to_destroy, &r);
 }
 
-void rg_res_node_bake_resources(rg_resource_node_t* rn, vkapi_driver_t* driver)
+void rg_res_node_bake_resources(
+    rg_resource_node_t* rn, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(rn);
     assert(driver);
     for (size_t i = 0; i < rn->resources_to_bake.size; ++i)
     {
         rg_resource_t* r = DYN_ARRAY_GET(rg_resource_t*, &rn->resources_to_bake, i);
-        rg_resource_bake(r, driver);
+        rg_resource_bake(r, pool, driver);
     }
 }
 
-void rg_res_node_destroy_resources(rg_resource_node_t* rn, vkapi_driver_t* driver)
+void rg_res_node_destroy_resources(
+    rg_resource_node_t* rn, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(rn);
     assert(driver);
     for (size_t i = 0; i < rn->resources_to_destroy.size; ++i)
     {
         rg_resource_t* r = DYN_ARRAY_GET(rg_resource_t*, &rn->resources_to_destroy, i);
-        rg_resource_destroy(r, driver);
+        rg_resource_destroy(r, pool, driver);
     }
 }
 
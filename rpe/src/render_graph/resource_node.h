@@ -36,6 +36,7 @@ typedef struct DependencyGraph rg_dep_graph_t;
 typedef struct RenderGraphPass rg_pass_t;
 typedef struct RenderGraph render_graph_t;
 typedef struct VkApiDriver vkapi_driver_t;
+typedef struct TransientPool rg_transient_pool_t;
 
 typedef struct ResourceEdge
 {
@@ -76,7 +77,7 @@ rg_resource_edge_t* rg_resource_edge_init(
     rg_dep_graph_t* dg, rg_node_t* from, rg_node_t* to, VkImageUsageFlags usage, arena_t* arena);
 
 rg_resource_node_t* rg_res_node_init(
-    rg_dep_graph_t* dg, const char* name, arena_t* arena, rg_handle_t res, rg_handle_t* parent);
+    rg_dep_graph_t* dg, intern_id_t name, arena_t* arena, rg_handle_t res, rg_handle_t* parent);
 
 rg_resource_edge_t* rg_res_node_get_writer_edge(rg_resource_node_t* rn, rg_pass_node_t* node);
 
@@ -90,15 +91,17 @@ void rg_res_node_add_resource_to_bake(rg_resource_node_t* rn, rg_resource_t* r);
 
 void rg_res_node_add_resource_to_destroy(rg_resource_node_t* rn, rg_resource_t* r);
 
-void rg_res_node_bake_resources(rg_resource_node_t* rn, vkapi_driver_t* driver);
+void rg_res_node_bake_resources(
+    rg_resource_node_t* rn, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
-void rg_res_node_destroy_resources(rg_resource_node_t* rn, vkapi_driver_t* driver);
+void rg_res_node_destroy_resources(
+    rg_resource_node_t* rn, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
 bool rg_res_node_has_writer_pass(rg_resource_node_t* rn);
 
 bool rg_res_node_has_readers(rg_resource_node_t* rn);
 
-bool rg_res_node_has_writers(rg_resource_node_t* rn, rg_dep_graph_t* dg, arena_t* arena);
+bool rg_res_node_has_writers(rg_resource_node_t* rn, rg_dep_graph_t* dg);
 
 rg_resource_node_t* rg_res_node_get_parent_node(rg_resource_node_t* rn, render_graph_t* rg);
 
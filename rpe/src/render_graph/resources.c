@@ -26,17 +26,15 @@
 #include "render_graph.h"
 #include "render_pass_node.h"
 #include "resource_node.h"
+#include "transient_pool.h"
 
-#include <backend/objects.h>
 #include <utility/string.h>
 #include <vulkan-api/driver.h>
-#include <vulkan-api/resource_cache.h>
-#include <vulkan-api/texture.h>
 
-rg_resource_t* rg_resource_init(const char* name, enum ResourceType type, arena_t* arena)
+rg_resource_t* rg_resource_init(intern_id_t name, enum ResourceType type, arena_t* arena)
 {
     rg_resource_t* i = ARENA_MAKE_STRUCT(arena, rg_resource_t, ARENA_ZERO_MEMORY);
-    i->name = string_init(name, arena);
+    i->name = name;
     i->type = type;
     i->parent = i;
     return i;
@@ -104,10 +102,10 @@ bool rg_resource_is_sub_resource(rg_resource_t* r)
 }
 
 rg_texture_resource_t* rg_tex_resource_init(
-    const char* name, VkImageUsageFlags image_usage, rg_texture_desc_t desc, arena_t* arena)
+    intern_id_t name, VkImageUsageFlags image_usage, rg_texture_desc_t desc, arena_t* arena)
 {
     rg_texture_resource_t* i = ARENA_MAKE_STRUCT(arena, rg_texture_resource_t, ARENA_ZERO_MEMORY);
-    i->base.name = string_init(name, arena);
+    i->base.name = name;
     i->base.type = RG_RESOURCE_TYPE_TEXTURE;
     i->base.parent = (rg_resource_t*)i;
     i->image_usage = image_usage;
@@ -145,20 +143,14 @@ void rg_tex_resource_update_res_usage(
     }
 }
 
-void rg_resource_bake(rg_resource_t* r, vkapi_driver_t* driver)
+void rg_resource_bake(rg_resource_t* r, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(r);
+    assert(pool);
     assert(driver);
     switch (r->type)
     {
         case RG_RESOURCE_TYPE_TEXTURE: {
-            sampler_params_t s_params = {
-                .min = RPE_SAMPLER_FILTER_LINEAR,
-                .mag = RPE_SAMPLER_FILTER_LINEAR,
-                .addr_u = RPE_SAMPLER_ADDR_MODE_CLAMP_TO_EDGE,
-                .addr_v = RPE_SAMPLER_ADDR_MODE_CLAMP_TO_EDGE,
-                .anisotropy = 1.0f};
-
             rg_texture_resource_t* r_tex = (rg_texture_resource_t*)r;
 
             assert(r_tex->desc.format != VK_FORMAT_UNDEFINED);
@@ -166,19 +158,17 @@ void rg_resource_bake(rg_resource_t* r, vkapi_driver_t* driver)
             assert(r_tex->desc.width > 0);
             assert(r_tex->desc.height > 0);
 
-            r_tex->handle = vkapi_res_cache_create_tex2d(
-                driver->res_cache,
-                driver->context,
-                driver->vma_allocator,
-                driver->sampler_cache,
-                r_tex->desc.format,
-                r_tex->desc.width,
-                r_tex->desc.height,
-                r_tex->desc.mip_levels,
-                r_tex->desc.layers,
-                r_tex->desc.layers > 1 ? VKAPI_TEXTURE_2D_ARRAY : VKAPI_TEXTURE_2D,
-                r_tex->image_usage | VK_IMAGE_USAGE_SAMPLED_BIT,
-                &s_params);
+            // Aliased textures are bound at the start of the frame by the pool, but the memory
+            // must be handed over from its previous owner before the first use.
+            if (!r_tex->aliased)
+            {
+                r_tex->handle = rg_transient_pool_acquire(
+                    pool, driver, &r_tex->desc, r_tex->image_usage | VK_IMAGE_USAGE_SAMPLED_BIT);
+            }
+            else
+            {
+                rg_transient_pool_alias_barrier(pool, driver, r_tex);
+            }
             break;
         }
         case RG_RESOURCE_TYPE_IMPORTED:
@@ -188,15 +178,19 @@ void rg_resource_bake(rg_resource_t* r, vkapi_driver_t* driver)
     }
 }
 
-void rg_resource_destroy(rg_resource_t* r, vkapi_driver_t* driver)
+void rg_resource_destroy(rg_resource_t* r, rg_transient_pool_t* pool, vkapi_driver_t* driver)
 {
     assert(r);
+    assert(pool);
     assert(driver);
     switch (r->type)
     {
         case RG_RESOURCE_TYPE_TEXTURE: {
             rg_texture_resource_t* r_tex = (rg_texture_resource_t*)r;
-            vkapi_res_cache_delete_tex2d(driver->res_cache, r_tex->handle);
+            if (!r_tex->aliased)
+            {
+                rg_transient_pool_release(pool, r_tex->handle);
+            }
             break;
         }
         case RG_RESOURCE_TYPE_IMPORTED:
@@ -207,14 +201,14 @@ void rg_resource_destroy(rg_resource_t* r, vkapi_driver_t* driver)
 }
 
 rg_imported_resource_t* rg_import_resource_init(
-    const char* name,
+    intern_id_t name,
     VkImageUsageFlags image_usage,
     rg_texture_desc_t desc,
     texture_handle_t handle,
     arena_t* arena)
 {
     rg_imported_resource_t* i = ARENA_MAKE_STRUCT(arena, rg_imported_resource_t, ARENA_ZERO_MEMORY);
-    i->base.base.name = string_init(name, arena);
+    i->base.base.name = name;
     i->base.base.type = RG_RESOURCE_TYPE_IMPORTED;
     i->base.base.parent = (rg_resource_t*)i;
     i->base.image_usage = image_usage;
@@ -225,7 +219,7 @@ rg_imported_resource_t* rg_import_resource_init(
 }
 
 rg_import_render_target_t* rg_tex_import_rt_init(
-    const char* name,
+    intern_id_t name,
     VkImageUsageFlags image_usage,
     rg_texture_desc_t tex_desc,
     rg_import_rt_desc_t import_desc,
@@ -235,7 +229,7 @@ rg_import_render_target_t* rg_tex_import_rt_init(
     rg_import_render_target_t* i =
         ARENA_MAKE_STRUCT(arena, rg_import_render_target_t, ARENA_ZERO_MEMORY);
     texture_handle_t handle = {.id = UINT32_MAX};
-    i->base.base.base.name = string_init(name, arena);
+    i->base.base.base.name = name;
     i->base.base.base.type = RG_RESOURCE_TYPE_IMPORTED_RENDER_TARGET;
     i->base.base.base.parent = (rg_resource_t*)i;
     i->base.base.image_usage = image_usage;
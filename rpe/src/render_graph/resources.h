@@ -26,6 +26,7 @@
 #include "render_graph_handle.h"
 
 #include <utility/arena.h>
+#include <utility/intern.h>
 #include <utility/maths.h>
 #include <utility/string.h>
 #include <vulkan-api/common.h>
@@ -41,6 +42,7 @@ typedef struct VkApiDriver vkapi_driver_t;
 typedef struct DependencyGraph rg_dep_graph_t;
 typedef struct ResourceEdge rg_resource_edge_t;
 typedef struct RenderGraph render_graph_t;
+typedef struct TransientPool rg_transient_pool_t;
 
 enum ResourceType
 {
@@ -53,7 +55,7 @@ enum ResourceType
 typedef struct Resource
 {
     /// For degugging purposes.
-    string_t name;
+    intern_id_t name;
 
     // ==== set by the compiler =====
     // The number of passes this resource is being used as an input.
@@ -91,6 +93,12 @@ typedef struct TextureResource
     /// Only valid after call to "bake".
     /// Note: this will be invalid if resource is imported.
     texture_handle_t handle;
+    /// Set if the texture is bound to the shared alias block. The handle is then owned by the
+    /// transient pool and is not baked/destroyed by the resource.
+    bool aliased;
+    /// The usage of the other aliased textures which share this texture's memory - its first use
+    /// must wait for these. Zero if the memory isn't shared.
+    VkImageUsageFlags alias_src_usage;
 } rg_texture_resource_t;
 
 // used for imported texture targets
@@ -123,20 +131,20 @@ typedef struct ImportedRenderTarget
     rg_import_rt_desc_t desc;
 } rg_import_render_target_t;
 
-rg_resource_t* rg_resource_init(const char* name, enum ResourceType type, arena_t* arena);
+rg_resource_t* rg_resource_init(intern_id_t name, enum ResourceType type, arena_t* arena);
 
 rg_texture_resource_t* rg_tex_resource_init(
-    const char* name, VkImageUsageFlags image_usage, rg_texture_desc_t desc, arena_t* arena);
+    intern_id_t name, VkImageUsageFlags image_usage, rg_texture_desc_t desc, arena_t* arena);
 
 rg_imported_resource_t* rg_import_resource_init(
-    const char* name,
+    intern_id_t name,
     VkImageUsageFlags image_usage,
     rg_texture_desc_t desc,
     texture_handle_t handle,
     arena_t* arena);
 
 rg_import_render_target_t* rg_tex_import_rt_init(
-    const char* name,
+    intern_id_t name,
     VkImageUsageFlags image_usage,
     rg_texture_desc_t tex_desc,
     rg_import_rt_desc_t import_desc,
@@ -159,9 +167,9 @@ bool rg_resource_connect_reader(
     VkImageUsageFlags usage,
     arena_t* arena);
 
-void rg_resource_bake(rg_resource_t* r, vkapi_driver_t* driver);
+void rg_resource_bake(rg_resource_t* r, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
-void rg_resource_destroy(rg_resource_t* r, vkapi_driver_t* driver);
+void rg_resource_destroy(rg_resource_t* r, rg_transient_pool_t* pool, vkapi_driver_t* driver);
 
 void rg_tex_resource_update_res_usage(
     rg_dep_graph_t* dg,
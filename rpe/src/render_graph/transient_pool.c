@@ -0,0 +1,499 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "transient_pool.h"
+
+#include "render_pass_node.h"
+
+#include <backend/objects.h>
+#include <string.h>
+#include <utility/hash.h>
+#include <vulkan-api/driver.h>
+#include <vulkan-api/texture.h>
+
+// Used for hashing the layout of the alias block. Zero initialised so padding is deterministic.
+struct AliasKey
+{
+    rg_texture_desc_t desc;
+    VkImageUsageFlags usage;
+    uint32_t first_pass;
+    uint32_t last_pass;
+};
+
+static inline uint64_t _align_offset(uint64_t offset, uint64_t alignment)
+{
+    return alignment > 1 ? ((offset + alignment - 1) / alignment) * alignment : offset;
+}
+
+static inline bool _lifetimes_overlap(rg_alias_interval_t* a, rg_alias_interval_t* b)
+{
+    return a->first_pass <= b->last_pass && b->first_pass <= a->last_pass;
+}
+
+uint64_t rg_alias_pack_intervals(rg_alias_interval_t* intervals, size_t count, arena_t* arena)
+{
+    assert(intervals);
+    if (!count)
+    {
+        return 0;
+    }
+
+    // Sort by size, largest first. The interval count is small (one per transient texture) so an
+    // insertion sort is fine here.
+    uint32_t* order = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t j = i;
+        while (j > 0 && intervals[order[j - 1]].size < intervals[i].size)
+        {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    // Indices of the placed intervals, kept in ascending offset order.
+    uint32_t* placed = ARENA_MAKE_ARRAY(arena, uint32_t, count, 0);
+    size_t placed_count = 0;
+    uint64_t total_size = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        rg_alias_interval_t* curr = &intervals[order[i]];
+        uint64_t offset = 0;
+
+        // As the placed intervals are in offset order, the first gap which the interval fits is
+        // the lowest offset available.
+        for (size_t j = 0; j < placed_count; ++j)
+        {
+            rg_alias_interval_t* p = &intervals[placed[j]];
+            if (!_lifetimes_overlap(curr, p))
+            {
+                continue;
+            }
+            if (_align_offset(offset, curr->alignment) + curr->size <= p->offset)
+            {
+                break;
+            }
+            uint64_t end = p->offset + p->size;
+            offset = MAX(offset, end);
+        }
+        curr->offset = _align_offset(offset, curr->alignment);
+
+        size_t insert_idx = placed_count;
+        while (insert_idx > 0 && intervals[placed[insert_idx - 1]].offset > curr->offset)
+        {
+            placed[insert_idx] = placed[insert_idx - 1];
+            --insert_idx;
+        }
+        placed[insert_idx] = order[i];
+        ++placed_count;
+
+        uint64_t end = curr->offset + curr->size;
+        total_size = MAX(total_size, end);
+    }
+    return total_size;
+}
+
+VkImageUsageFlags rg_alias_src_usage(
+    const rg_alias_interval_t* intervals, const VkImageUsageFlags* usages, size_t count, size_t idx)
+{
+    assert(intervals);
+    assert(usages);
+    assert(idx < count);
+
+    const rg_alias_interval_t* curr = &intervals[idx];
+    VkImageUsageFlags usage = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const rg_alias_interval_t* other = &intervals[i];
+        if (i != idx && curr->offset < other->offset + other->size &&
+            other->offset < curr->offset + curr->size)
+        {
+            usage |= usages[i];
+        }
+    }
+    return usage;
+}
+
+rg_transient_pool_t* rg_transient_pool_init(arena_t* arena)
+{
+    rg_transient_pool_t* i = ARENA_MAKE_ZERO_STRUCT(arena, rg_transient_pool_t);
+    MAKE_DYN_ARRAY(rg_transient_tex_t, arena, 30, &i->textures);
+    MAKE_DYN_ARRAY(texture_handle_t, arena, 30, &i->alias_block.handles);
+    MAKE_DYN_ARRAY(VkImageUsageFlags, arena, 30, &i->alias_block.src_usages);
+    i->enable_aliasing = true;
+    return i;
+}
+
+static sampler_params_t _transient_sampler_params(void)
+{
+    sampler_params_t s_params = {
+        .min = RPE_SAMPLER_FILTER_LINEAR,
+        .mag = RPE_SAMPLER_FILTER_LINEAR,
+        .addr_u = RPE_SAMPLER_ADDR_MODE_CLAMP_TO_EDGE,
+        .addr_v = RPE_SAMPLER_ADDR_MODE_CLAMP_TO_EDGE,
+        .anisotropy = 1.0f};
+    return s_params;
+}
+
+static bool _tex_desc_equal(rg_texture_desc_t* a, rg_texture_desc_t* b)
+{
+    // Compared by field as the descriptor contains padding.
+    return a->width == b->width && a->height == b->height && a->depth == b->depth &&
+        a->mip_levels == b->mip_levels && a->layers == b->layers && a->format == b->format;
+}
+
+static void _retire_alias_block(rg_alias_block_t* b, vkapi_driver_t* driver)
+{
+    if (!b->is_valid)
+    {
+        return;
+    }
+    // Deletion is deferred by the resource cache until the GPU has finished with the textures.
+    // The first texture owns the shared allocation, which is freed alongside the other images.
+    for (size_t i = 0; i < b->handles.size; ++i)
+    {
+        texture_handle_t h = DYN_ARRAY_GET(texture_handle_t, &b->handles, i);
+        vkapi_res_cache_delete_tex2d(driver->res_cache, h);
+    }
+    dyn_array_clear(&b->handles);
+    dyn_array_clear(&b->src_usages);
+    b->is_valid = false;
+}
+
+static void _alias_resources(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, arena_dyn_array_t* resources, arena_t* arena)
+{
+    size_t count = resources->size;
+    rg_alias_block_t* b = &p->alias_block;
+
+    struct AliasKey* keys = ARENA_MAKE_ARRAY(arena, struct AliasKey, count, ARENA_ZERO_MEMORY);
+    for (size_t i = 0; i < count; ++i)
+    {
+        rg_texture_resource_t* r = DYN_ARRAY_GET(rg_texture_resource_t*, resources, i);
+        assert(r->base.first_pass_node && r->base.last_pass_node);
+        keys[i].desc.width = r->desc.width;
+        keys[i].desc.height = r->desc.height;
+        keys[i].desc.depth = r->desc.depth;
+        keys[i].desc.mip_levels = r->desc.mip_levels;
+        keys[i].desc.layers = r->desc.layers;
+        keys[i].desc.format = r->desc.format;
+        keys[i].usage = r->image_usage | VK_IMAGE_USAGE_SAMPLED_BIT;
+        keys[i].first_pass = r->base.first_pass_node->exec_idx;
+        keys[i].last_pass = r->base.last_pass_node->exec_idx;
+    }
+    uint32_t layout_hash = murmur2_hash(keys, count * sizeof(struct AliasKey), 0);
+
+    // The graph is usually identical between frames, so the block from the last frame is reused.
+    if (b->is_valid && b->layout_hash == layout_hash && b->handles.size == count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            rg_texture_resource_t* r = DYN_ARRAY_GET(rg_texture_resource_t*, resources, i);
+            r->handle = DYN_ARRAY_GET(texture_handle_t, &b->handles, i);
+            r->alias_src_usage = DYN_ARRAY_GET(VkImageUsageFlags, &b->src_usages, i);
+            r->aliased = true;
+        }
+        p->stats.allocations_avoided += count;
+        p->stats.bytes_saved += b->resource_size;
+        return;
+    }
+
+    _retire_alias_block(b, driver);
+
+    vkapi_texture_t* textures = ARENA_MAKE_ARRAY(arena, vkapi_texture_t, count, 0);
+    rg_alias_interval_t* intervals =
+        ARENA_MAKE_ARRAY(arena, rg_alias_interval_t, count, ARENA_ZERO_MEMORY);
+    VkImageUsageFlags* usages = ARENA_MAKE_ARRAY(arena, VkImageUsageFlags, count, 0);
+    VkMemoryRequirements block_reqs = {.memoryTypeBits = UINT32_MAX, .alignment = 1};
+    uint64_t resource_size = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        rg_texture_desc_t* desc = &keys[i].desc;
+        textures[i] = vkapi_texture_init(
+            desc->width,
+            desc->height,
+            desc->mip_levels,
+            desc->layers,
+            desc->layers > 1 ? VKAPI_TEXTURE_2D_ARRAY : VKAPI_TEXTURE_2D,
+            desc->format);
+        VkMemoryRequirements reqs =
+            vkapi_texture_create_unbound_image(driver->context, &textures[i], keys[i].usage);
+
+        intervals[i].size = reqs.size;
+        intervals[i].alignment = reqs.alignment;
+        intervals[i].first_pass = keys[i].first_pass;
+        intervals[i].last_pass = keys[i].last_pass;
+        usages[i] = keys[i].usage;
+
+        block_reqs.memoryTypeBits &= reqs.memoryTypeBits;
+        block_reqs.alignment = MAX(block_reqs.alignment, reqs.alignment);
+        resource_size += reqs.size;
+    }
+
+    VmaAllocation alloc = VK_NULL_HANDLE;
+    VkResult res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    // Not all images may share a memory type (depth formats for instance on some devices) in
+    // which case these resources fall back to the pool.
+    if (block_reqs.memoryTypeBits)
+    {
+        block_reqs.size = rg_alias_pack_intervals(intervals, count, arena);
+
+        VmaAllocationCreateInfo alloc_ci = {0};
+        alloc_ci.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        alloc_ci.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        alloc_ci.priority = 1.0f;
+        res = vmaAllocateMemory(driver->vma_allocator, &block_reqs, &alloc_ci, &alloc, NULL);
+    }
+    if (res != VK_SUCCESS)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            vkapi_texture_destroy(driver->context, driver->vma_allocator, &textures[i]);
+        }
+        // No point in trying again each frame.
+        log_warn("Unable to create the render graph alias block - aliasing is disabled.");
+        p->enable_aliasing = false;
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        rg_texture_resource_t* r = DYN_ARRAY_GET(rg_texture_resource_t*, resources, i);
+        sampler_params_t s_params = _transient_sampler_params();
+        vkapi_texture_create_aliased_2d(
+            driver->context,
+            driver->vma_allocator,
+            driver->sampler_cache,
+            &textures[i],
+            alloc,
+            intervals[i].offset,
+            keys[i].usage,
+            &s_params);
+        if (i == 0)
+        {
+            textures[i].vma_alloc = alloc;
+        }
+        r->handle = vkapi_res_cache_push_tex2d(driver->res_cache, &textures[i]);
+        r->alias_src_usage = rg_alias_src_usage(intervals, usages, count, i);
+        r->aliased = true;
+        DYN_ARRAY_APPEND(&b->handles, &r->handle);
+        DYN_ARRAY_APPEND(&b->src_usages, &r->alias_src_usage);
+    }
+
+    b->layout_hash = layout_hash;
+    b->block_size = block_reqs.size;
+    b->resource_size = resource_size;
+    b->is_valid = true;
+
+    p->stats.allocation_count += 1;
+    p->stats.allocations_avoided += count - 1;
+    p->stats.bytes_saved += resource_size - block_reqs.size;
+}
+
+void rg_transient_pool_begin_frame(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, arena_dyn_array_t* resources, arena_t* arena)
+{
+    assert(p);
+    assert(driver);
+    assert(resources);
+
+    p->current_frame++;
+    memset(&p->stats, 0, sizeof(rg_transient_stats_t));
+
+    // Aliasing a single resource gives no benefit - use the pool.
+    if (p->enable_aliasing && resources->size > 1)
+    {
+        _alias_resources(p, driver, resources, arena);
+    }
+    else
+    {
+        _retire_alias_block(&p->alias_block, driver);
+    }
+}
+
+// The stages and writes of any use of an image with the given usage.
+static void _alias_usage_scope(
+    VkImageUsageFlags usage, VkPipelineStageFlags* out_stages, VkAccessFlags* out_access)
+{
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags access = 0;
+    if (usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+    {
+        stages |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        access |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    }
+    if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+    {
+        stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    }
+    if (usage & VK_IMAGE_USAGE_STORAGE_BIT)
+    {
+        stages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        access |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    // Reads only need an execution dependency so that they complete before the memory is reused.
+    if (usage & (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT))
+    {
+        stages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+    if (usage & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+    {
+        stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+        access |= usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+    }
+    *out_stages = stages ? stages : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    *out_access = access;
+}
+
+void rg_transient_pool_alias_barrier(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, rg_texture_resource_t* r)
+{
+    assert(p);
+    assert(driver);
+    assert(r);
+    if (!r->aliased || !r->alias_src_usage)
+    {
+        return;
+    }
+
+    VkPipelineStageFlags src_stages;
+    VkAccessFlags src_access;
+    _alias_usage_scope(r->alias_src_usage, &src_stages, &src_access);
+
+    // Transient textures are first used by the pass which writes them.
+    VkImageLayout layout;
+    VkPipelineStageFlags dst_stages;
+    VkAccessFlags dst_access;
+    if (r->image_usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+    {
+        layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        dst_stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dst_access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    }
+    else if (r->image_usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+    {
+        layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        dst_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dst_access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    }
+    else
+    {
+        layout = VK_IMAGE_LAYOUT_GENERAL;
+        dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dst_access = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    }
+
+    vkapi_driver_discard_image_barrier(
+        driver, r->handle, src_stages, src_access, layout, dst_stages, dst_access);
+    p->stats.alias_barrier_count++;
+}
+
+texture_handle_t rg_transient_pool_acquire(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, rg_texture_desc_t* desc, VkImageUsageFlags usage)
+{
+    assert(p);
+    assert(driver);
+    assert(desc);
+
+    for (size_t i = 0; i < p->textures.size; ++i)
+    {
+        rg_transient_tex_t* t = DYN_ARRAY_GET_PTR(rg_transient_tex_t, &p->textures, i);
+        if (!t->in_use && t->usage == usage && _tex_desc_equal(&t->desc, desc))
+        {
+            t->in_use = true;
+            t->last_used_frame = p->current_frame;
+            p->stats.allocations_avoided++;
+            p->stats.bytes_saved += t->size;
+            return t->handle;
+        }
+    }
+
+    sampler_params_t s_params = _transient_sampler_params();
+    rg_transient_tex_t t = {
+        .desc = *desc, .usage = usage, .last_used_frame = p->current_frame, .in_use = true};
+    t.handle = vkapi_res_cache_create_tex2d(
+        driver->res_cache,
+        driver->context,
+        driver->vma_allocator,
+        driver->sampler_cache,
+        desc->format,
+        desc->width,
+        desc->height,
+        desc->mip_levels,
+        desc->layers,
+        desc->layers > 1 ? VKAPI_TEXTURE_2D_ARRAY : VKAPI_TEXTURE_2D,
+        usage,
+        &s_params);
+
+    vkapi_texture_t* tex = vkapi_res_cache_get_tex2d(driver->res_cache, t.handle);
+    VmaAllocationInfo alloc_info;
+    vmaGetAllocationInfo(driver->vma_allocator, tex->vma_alloc, &alloc_info);
+    t.size = alloc_info.size;
+
+    DYN_ARRAY_APPEND(&p->textures, &t);
+    p->stats.allocation_count++;
+    return t.handle;
+}
+
+void rg_transient_pool_release(rg_transient_pool_t* p, texture_handle_t handle)
+{
+    assert(p);
+    for (size_t i = 0; i < p->textures.size; ++i)
+    {
+        rg_transient_tex_t* t = DYN_ARRAY_GET_PTR(rg_transient_tex_t, &p->textures, i);
+        if (t->handle.id == handle.id)
+        {
+            assert(t->in_use);
+            t->in_use = false;
+            t->last_used_frame = p->current_frame;
+            return;
+        }
+    }
+    assert(false && "Texture handle not found in transient pool.");
+}
+
+void rg_transient_pool_gc(rg_transient_pool_t* p, vkapi_driver_t* driver)
+{
+    assert(p);
+    assert(driver);
+    uint32_t curr_count = 0;
+    for (size_t i = 0; i < p->textures.size; ++i)
+    {
+        rg_transient_tex_t* t = DYN_ARRAY_GET_PTR(rg_transient_tex_t, &p->textures, i);
+        if (!t->in_use && t->last_used_frame + RG_TRANSIENT_POOL_MAX_IDLE_FRAMES < p->current_frame)
+        {
+            vkapi_res_cache_delete_tex2d(driver->res_cache, t->handle);
+        }
+        else
+        {
+            DYN_ARRAY_SET(&p->textures, curr_count++, t);
+        }
+    }
+    dyn_array_shrink(&p->textures, curr_count);
+}
@@ -0,0 +1,172 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __RPE_RG_TRANSIENT_POOL_H__
+#define __RPE_RG_TRANSIENT_POOL_H__
+
+#include "resources.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utility/arena.h>
+#include <vulkan-api/common.h>
+#include <vulkan-api/resource_cache.h>
+
+// The number of frames a pooled texture can remain unused before it is destroyed.
+#define RG_TRANSIENT_POOL_MAX_IDLE_FRAMES 10
+
+// Forward declarations.
+typedef struct VkApiDriver vkapi_driver_t;
+
+/**
+ A resource to be placed in a shared memory block. The lifetime is given as the
+ (inclusive) range of pass execution indices which reference the resource.
+ */
+typedef struct AliasInterval
+{
+    uint64_t size;
+    uint64_t alignment;
+    uint32_t first_pass;
+    uint32_t last_pass;
+    /// Set by @sa rg_alias_pack_intervals.
+    uint64_t offset;
+} rg_alias_interval_t;
+
+typedef struct TransientStats
+{
+    /// The number of new device memory allocations made this frame.
+    uint32_t allocation_count;
+    /// The number of textures which were satisfied without a new allocation.
+    uint32_t allocations_avoided;
+    /// The number of bytes which were not allocated this frame due to recycling/aliasing.
+    uint64_t bytes_saved;
+    /// The number of barriers issued to hand aliased memory over to a new texture.
+    uint32_t alias_barrier_count;
+} rg_transient_stats_t;
+
+typedef struct TransientTexture
+{
+    rg_texture_desc_t desc;
+    VkImageUsageFlags usage;
+    texture_handle_t handle;
+    /// The size of the backing allocation in bytes.
+    uint64_t size;
+    uint64_t last_used_frame;
+    bool in_use;
+} rg_transient_tex_t;
+
+typedef struct AliasBlock
+{
+    /// A hash of the descriptors and lifetimes which the block was packed for.
+    uint32_t layout_hash;
+    /// Handles of the textures bound to this block - in the order of the alias list.
+    arena_dyn_array_t handles;
+    /// The usage which each texture must wait on before its first use - see
+    /// @sa rg_alias_src_usage. In the order of the alias list.
+    arena_dyn_array_t src_usages;
+    /// Size of the shared allocation.
+    uint64_t block_size;
+    /// The sum of the memory requirements of all the textures bound to this block.
+    uint64_t resource_size;
+    bool is_valid;
+} rg_alias_block_t;
+
+typedef struct TransientPool
+{
+    /// Textures which have been created by the pool - in use or awaiting reuse.
+    arena_dyn_array_t textures;
+    /// The block which all aliased textures are bound to.
+    rg_alias_block_t alias_block;
+
+    rg_transient_stats_t stats;
+    uint64_t current_frame;
+    bool enable_aliasing;
+} rg_transient_pool_t;
+
+/**
+ Place the intervals within a single memory block, so that resources with overlapping lifetimes
+ never overlap in memory. A greedy approach is used - resources are placed largest first at the
+ lowest offset which fits.
+ @param intervals The resources to place. The offset of each will be set on return.
+ @param count The number of intervals.
+ @param arena An arena allocator used for temporary allocations.
+ @return The total size of the memory block required to hold all the intervals.
+ */
+uint64_t rg_alias_pack_intervals(rg_alias_interval_t* intervals, size_t count, arena_t* arena);
+
+/**
+ Find the usage which the first use of an interval must wait on. The block is reused between
+ frames, so every other interval sharing its memory was used before it - either earlier in this
+ frame, or during the previous frame.
+ @param intervals The intervals, with their offsets set by @sa rg_alias_pack_intervals.
+ @param usages The image usage of each interval.
+ @param count The number of intervals.
+ @param idx The index of the interval.
+ @return The combined usage of the intervals which share its memory, or zero if none do.
+ */
+VkImageUsageFlags rg_alias_src_usage(
+    const rg_alias_interval_t* intervals,
+    const VkImageUsageFlags* usages,
+    size_t count,
+    size_t idx);
+
+rg_transient_pool_t* rg_transient_pool_init(arena_t* arena);
+
+/**
+ Begin a new frame. If aliasing is enabled, the textures in @sa resources are bound to the shared
+ alias block - this is only recreated if the layout of the resources differs from the last frame.
+ @param resources A list of @sa rg_texture_resource_t which are transient for this frame.
+ @param arena An arena used for temporary allocations (frame scope).
+ */
+void rg_transient_pool_begin_frame(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, arena_dyn_array_t* resources, arena_t* arena);
+
+/**
+ Hand the memory of an aliased texture over from the textures which previously occupied it. The
+ contents are discarded and the texture is transitioned for its first use. Must be called before
+ the first pass which uses the texture is executed.
+ */
+void rg_transient_pool_alias_barrier(
+    rg_transient_pool_t* p, vkapi_driver_t* driver, rg_texture_resource_t* r);
+
+/**
+ Retrieve a texture which matches the descriptor and usage from the pool, creating a new
+ texture if none are available.
+ */
+texture_handle_t rg_transient_pool_acquire(
+    rg_transient_pool_t* p,
+    vkapi_driver_t* driver,
+    rg_texture_desc_t* desc,
+    VkImageUsageFlags usage);
+
+/**
+ Return a texture to the pool. The texture will be available to any subsequent call to
+ @sa rg_transient_pool_acquire.
+ */
+void rg_transient_pool_release(rg_transient_pool_t* p, texture_handle_t handle);
+
+/**
+ Destroy any pooled textures which have not been used for @sa RG_TRANSIENT_POOL_MAX_IDLE_FRAMES.
+ */
+void rg_transient_pool_gc(rg_transient_pool_t* p, vkapi_driver_t* driver);
+
+#endif
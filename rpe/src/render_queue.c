@@ -28,13 +28,13 @@
 #include <utility/sort.h>
 #include <vulkan-api/driver.h>
 
-rpe_render_queue_t* rpe_render_queue_init(arena_t* arena)
+rpe_render_queue_t* rpe_render_queue_init(job_queue_t* jq, arena_t* arena)
 {
     rpe_render_queue_t* q = ARENA_MAKE_ZERO_STRUCT(arena, rpe_render_queue_t);
-    q->gbuffer_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_GBUFFER_SIZE, arena);
-    q->depth_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_DEPTH_SIZE, arena);
-    q->lighting_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_LIGHTING_SIZE, arena);
-    q->post_process_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_POST_PROCESS_SIZE, arena);
+    q->gbuffer_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_GBUFFER_SIZE, jq, arena);
+    q->depth_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_DEPTH_SIZE, jq, arena);
+    q->lighting_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_LIGHTING_SIZE, jq, arena);
+    q->post_process_bucket = rpe_command_bucket_init(RPE_RENDER_QUEUE_POST_PROCESS_SIZE, jq, arena);
     return q;
 }
 
@@ -48,25 +48,38 @@ void rpe_render_queue_submit_all(rpe_render_queue_t* q, vkapi_driver_t* driver)
     rpe_command_bucket_submit(q->post_process_bucket, driver);
 }
 
-void rpe_render_queue_submit_one(
-    rpe_render_queue_t* q, vkapi_driver_t* driver, enum QueueBucketType type)
+rpe_cmd_bucket_t* rpe_render_queue_get_bucket(rpe_render_queue_t* q, enum QueueBucketType type)
 {
     assert(q);
     switch (type)
     {
         case RPE_RENDER_QUEUE_GBUFFER:
-            rpe_command_bucket_submit(q->gbuffer_bucket, driver);
-            break;
+            return q->gbuffer_bucket;
         case RPE_RENDER_QUEUE_DEPTH:
-            rpe_command_bucket_submit(q->depth_bucket, driver);
-            break;
+            return q->depth_bucket;
         case RPE_RENDER_QUEUE_LIGHTING:
-            rpe_command_bucket_submit(q->lighting_bucket, driver);
-            break;
+            return q->lighting_bucket;
         case RPE_RENDER_QUEUE_POST_PROCESS:
-            rpe_command_bucket_submit(q->post_process_bucket, driver);
-            break;
+            return q->post_process_bucket;
     }
+    return NULL;
+}
+
+void rpe_render_queue_submit_one(
+    rpe_render_queue_t* q, vkapi_driver_t* driver, enum QueueBucketType type)
+{
+    rpe_command_bucket_submit(rpe_render_queue_get_bucket(q, type), driver);
+}
+
+void rpe_render_queue_submit_one_mt(
+    rpe_render_queue_t* q,
+    vkapi_driver_t* driver,
+    enum QueueBucketType type,
+    job_queue_t* jq,
+    rpe_cmd_recorder_t* rec,
+    arena_t* arena)
+{
+    rpe_command_bucket_submit_mt(rpe_render_queue_get_bucket(q, type), driver, jq, rec, arena);
 }
 
 void rpe_render_queue_clear(rpe_render_queue_t* q)
@@ -23,10 +23,11 @@
 #ifndef __RPE_RENDER_QUEUE_H__
 #define __RPE_RENDER_QUEUE_H__
 
-#define RPE_RENDER_QUEUE_GBUFFER_SIZE 2048
-#define RPE_RENDER_QUEUE_DEPTH_SIZE 2048
-#define RPE_RENDER_QUEUE_LIGHTING_SIZE 2048
-#define RPE_RENDER_QUEUE_POST_PROCESS_SIZE 2048
+// The memory reserved for the packets of each bucket, in bytes.
+#define RPE_RENDER_QUEUE_GBUFFER_SIZE (1 << 24)
+#define RPE_RENDER_QUEUE_DEPTH_SIZE (1 << 24)
+#define RPE_RENDER_QUEUE_LIGHTING_SIZE (1 << 21)
+#define RPE_RENDER_QUEUE_POST_PROCESS_SIZE (1 << 21)
 #define RPE_RENDER_QUEUE_MAX_VIEW_LAYER_COUNT 0x10
 
 #define VIEW_LAYER_BIT_SHIFT 56
@@ -39,6 +40,8 @@
 typedef struct CommandBucket rpe_cmd_bucket_t;
 typedef struct VkApiDriver vkapi_driver_t;
 typedef struct Arena arena_t;
+typedef struct JobQueue job_queue_t;
+typedef struct CommandRecorder rpe_cmd_recorder_t;
 
 enum QueueBucketType
 {
@@ -77,12 +80,31 @@ typedef struct RenderQueue
     rpe_cmd_bucket_t* post_process_bucket;
 } rpe_render_queue_t;
 
-rpe_render_queue_t* rpe_render_queue_init(arena_t* arena);
+/**
+ Create the render queue buckets.
+ @param jq The job queue whose threads are able to add packets to the buckets. May be NULL if
+ packets are only added from a single thread.
+ */
+rpe_render_queue_t* rpe_render_queue_init(job_queue_t* jq, arena_t* arena);
 
 void rpe_render_queue_submit_all(rpe_render_queue_t* q, vkapi_driver_t* driver);
 void rpe_render_queue_submit_one(
     rpe_render_queue_t* q, vkapi_driver_t* driver, enum QueueBucketType type);
 
+/**
+ Submit a bucket by recording it in parallel on the job queue workers - see
+ @sa rpe_command_bucket_submit_mt.
+ */
+void rpe_render_queue_submit_one_mt(
+    rpe_render_queue_t* q,
+    vkapi_driver_t* driver,
+    enum QueueBucketType type,
+    job_queue_t* jq,
+    rpe_cmd_recorder_t* rec,
+    arena_t* arena);
+
+rpe_cmd_bucket_t* rpe_render_queue_get_bucket(rpe_render_queue_t* q, enum QueueBucketType type);
+
 void rpe_render_queue_clear(rpe_render_queue_t* q);
 
 uint64_t rpe_render_queue_create_sort_key(material_sort_key_t key, enum SortKeyType type);
@@ -267,7 +267,7 @@ void rpe_renderer_render_single_indexed(
     rpe_renderer_begin_renderpass(rdr, rt, multi_view_count);
 
     vkapi_driver_bind_vertex_buffer(driver, vertex_buffer, 0);
-    vkapi_driver_bind_index_buffer(driver, index_buffer);
+    vkapi_driver_bind_index_buffer(driver, index_buffer, VK_INDEX_TYPE_UINT32);
     vkapi_driver_bind_gfx_pipeline(driver, bundle, true);
 
     if (pb_entries)
@@ -338,7 +338,8 @@ void rpe_renderer_render(rpe_renderer_t* rdr, rpe_scene_t* scene, bool clear_swa
     desc.clear_col.a = 1.0f;
 
     rg_handle_t bb_handle =
-        rg_import_render_target(rdr->rg, "BackBuffer", desc, rdr->rt_handles[driver->image_index]);
+        rg_import_render_target(
+            rdr->rg, INTERN_LITERAL("BackBuffer"), desc, rdr->rt_handles[driver->image_index]);
     VkFormat depth_format = vkapi_driver_get_supported_depth_format(rdr->engine->driver);
 
     input_handle = rpe_colour_pass_render(rdr->rg, scene, settings.gbuffer_dims, depth_format);
@@ -346,10 +347,8 @@ void rpe_renderer_render(rpe_renderer_t* rdr, rpe_scene_t* scene, bool clear_swa
     // Render the shadow maps - cascade and point/spot maps (once added).
     if (draw_shadows)
     {
-        // Check the csm projections have complete, and upload.
-        rpe_shadow_manager_sync_update(engine->shadow_manager, engine);
-        rpe_shadow_manager_upload_projections(engine->shadow_manager, engine, scene);
-        // And issue the shadow rendering commands.
+        // The csm projections have been computed and uploaded as part of the scene update, so
+        // just issue the shadow rendering commands.
         rpe_shadow_pass_render(
             engine->shadow_manager, rdr->rg, scene, settings.shadow.cascade_dims, depth_format);
     }
@@ -36,6 +36,7 @@
 #include "render_queue.h"
 #include "shadow_manager.h"
 #include "skybox.h"
+#include "vertex_buffer.h"
 
 #include <tracy/TracyC.h>
 #include <utility/job_queue.h>
@@ -50,6 +51,7 @@ rpe_scene_t* rpe_scene_init(rpe_engine_t* engine, arena_t* arena)
                                                      : RPE_SCENE_SHADOW_STATUS_DISABLED;
     i->draw_data = ARENA_MAKE_ARRAY(arena, struct DrawData, RPE_SCENE_MAX_STATIC_MODEL_COUNT, 0);
     MAKE_DYN_ARRAY(rpe_object_t, arena, 100, &i->objects);
+    i->sort_cache = rpe_rend_sort_cache_init(RPE_SCENE_MAX_STATIC_MODEL_COUNT, arena);
 
     // Setup the camera UBO and model SSBOs.
     i->draw_data_handle = vkapi_res_cache_create_ssbo(
@@ -119,7 +121,7 @@ rpe_scene_t* rpe_scene_init(rpe_engine_t* engine, arena_t* arena)
     // Total draw counts for both colour pass and shadow. This is only used in the compute shader.
     i->total_draw_handle = rpe_compute_bind_ssbo_gpu_only(i->cull_compute, driver, 8, 2, 0);
 
-    i->render_queue = rpe_render_queue_init(arena);
+    i->render_queue = rpe_render_queue_init(engine->job_queue, arena);
     i->rend_extents =
         ARENA_MAKE_ZERO_ARRAY(arena, rpe_rend_extents_t, RPE_SCENE_MAX_STATIC_MODEL_COUNT);
 
@@ -137,6 +139,38 @@ rpe_scene_t* rpe_scene_init(rpe_engine_t* engine, arena_t* arena)
     return i;
 }
 
+rpe_aabox_t _scene_instance_world_box(struct RenderableInstance* instance)
+{
+    math_mat4f model_world = *instance->world_transform;
+    rpe_aabox_t box = {.min = instance->rend->box.min, .max = instance->rend->box.max};
+    return rpe_aabox_calc_rigid_transform(
+        &box, math_mat4f_to_rotation_matrix(model_world), math_mat4f_translation_vec(model_world));
+}
+
+rpe_frustum_boxes_t _scene_alloc_boxes(size_t count, arena_t* arena)
+{
+    rpe_frustum_boxes_t b = {
+        .center_x = ARENA_MAKE_ARRAY(arena, float, count, 0),
+        .center_y = ARENA_MAKE_ARRAY(arena, float, count, 0),
+        .center_z = ARENA_MAKE_ARRAY(arena, float, count, 0),
+        .extent_x = ARENA_MAKE_ARRAY(arena, float, count, 0),
+        .extent_y = ARENA_MAKE_ARRAY(arena, float, count, 0),
+        .extent_z = ARENA_MAKE_ARRAY(arena, float, count, 0)};
+    return b;
+}
+
+rpe_cmd_packet_t* _scene_append_index_bind(
+    rpe_cmd_bucket_t* bucket, rpe_cmd_packet_t* pkt, rpe_engine_t* engine, enum IndicesType type)
+{
+    rpe_cmd_packet_t* ib_pkt = rpe_command_bucket_append_command(
+        bucket, pkt, 0, sizeof(struct IndexBufferBindCommand), rpe_cmd_dispatch_index_buffer_bind);
+    struct IndexBufferBindCommand* ib_cmd = ib_pkt->cmds;
+    rpe_vertex_pool_t* pool = &engine->vbuffer->pools[rpe_vertex_buffer_index_pool(type)];
+    ib_cmd->handle = pool->buffer;
+    ib_cmd->type = type == RPE_RENDERABLE_INDICES_U16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    return ib_pkt;
+}
+
 bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
 {
     TracyCZoneN(ctx, "Scene::Update", 1);
@@ -155,11 +189,24 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
 
     rpe_render_queue_clear(scene->render_queue);
 
+    // Upload any modified vertex/index data - this may recreate the pool buffers if they have
+    // grown, so must be done before the buffer handles are recorded into the draw commands.
+    rpe_vertex_buffer_upload_to_gpu(engine->vbuffer, driver);
+
     rpe_light_manager_update(engine->light_manager, scene, scene->curr_camera);
+
+    // All jobs for the scene update - shadow projections, model extents, indirect draws and their
+    // uploads - form one dependency graph under this parent, which is waited upon once.
+    job_t* parent = job_queue_create_parent_job(engine->job_queue);
     if (draw_shadows)
     {
         rpe_shadow_manager_update_projections(
-            engine->shadow_manager, scene->curr_camera, scene, engine, engine->light_manager);
+            engine->shadow_manager,
+            scene->curr_camera,
+            scene,
+            engine,
+            engine->light_manager,
+            parent);
     }
 
     // Prepare the camera frustum - update the camera matrices before constructing the frustum.
@@ -179,21 +226,52 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
         if (rpe_comp_manager_has_obj(rm->comp_manager, *obj))
         {
             rpe_renderable_t* r = rpe_rend_manager_get_mesh(rm, obj);
-            rpe_transform_node_t* transform = rpe_transform_manager_get_node(tm, r->transform_obj);
-            struct RenderableInstance instance = {.rend = r, .transform = transform};
+            struct RenderableInstance instance = {
+                .rend = r,
+                .world_transform = rpe_transform_manager_get_world(tm, r->transform_obj)};
             DYN_ARRAY_APPEND(&renderables, &instance);
         }
         // TODO: Check for lights here.
     }
 
-    if (scene->is_dirty)
+    if (scene->cpu_culling && renderables.size > 0)
+    {
+        size_t count = renderables.size;
+        size_t block_count = (count + RPE_SCENE_CULL_BLOCK_SIZE - 1) / RPE_SCENE_CULL_BLOCK_SIZE;
+        struct CullEntry cull_entry = {
+            .frustum = &frustum,
+            .instances = renderables.data,
+            .count = count,
+            .boxes = _scene_alloc_boxes(count, &engine->frame_arena),
+            .visible = ARENA_MAKE_ARRAY(&engine->frame_arena, uint32_t, count, 0),
+            .block_counts = ARENA_MAKE_ARRAY(&engine->frame_arena, uint32_t, block_count, 0)};
+
+        // The visible renderables are needed before sorting, so the cull is waited upon here
+        // rather than being part of the update graph.
+        job_t* cull_parent = job_queue_create_parent_job(engine->job_queue);
+        rpe_scene_cull_instances(&cull_entry, engine, cull_parent);
+        job_queue_run_and_wait(engine->job_queue, cull_parent);
+        renderables.size = rpe_scene_gather_visible(&cull_entry);
+    }
+
+    // The batches only need rebuilding if a sort key has changed, though the instances are
+    // always reordered to match the batches.
+    if (rpe_rend_manager_sort_renderables(
+            scene->sort_cache,
+            renderables.data,
+            renderables.size,
+            scene->is_dirty,
+            &engine->frame_arena))
     {
         rpe_rend_manager_batch_renderables(
-            rm, renderables.data, renderables.size, &scene->batched_draw_cache);
-        scene->is_dirty = false;
+            rm,
+            renderables.data,
+            scene->sort_cache->sorted_keys,
+            renderables.size,
+            &scene->batched_draw_cache);
     }
+    scene->is_dirty = false;
 
-    job_t* parent = job_queue_create_parent_job(engine->job_queue);
     struct UploadExtentsEntry entry = {
         .scene = scene,
         .engine = engine,
@@ -201,11 +279,27 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
         .tm = tm,
         .instances = renderables.data,
         .count = renderables.size};
-    struct SplitConfig cfg = {.max_split = 12, .min_count = 32};
-    rpe_scene_compute_model_extents(&entry, parent, &cfg);
+    // The extents are only required by the cull compute shader - not needed if already culled.
+    if (!scene->cpu_culling)
+    {
+        // Chunk boundaries on cache lines so workers don't write to the same line of extents.
+        struct ChunkConfig cfg = {.min_chunk_size = 32, .item_size = sizeof(rpe_rend_extents_t)};
+        rpe_scene_compute_model_extents(&entry, parent, &cfg);
+    }
 
-    arena_dyn_array_t indirect_draws;
-    MAKE_DYN_ARRAY(struct IndirectDraw, &engine->frame_arena, 100, &indirect_draws);
+    // Update renderable objects.
+    arena_dyn_array_t* batched_draws = &scene->batched_draw_cache;
+
+    struct IndirectDrawEntry draw_entry = {
+        .scene = scene,
+        .engine = engine,
+        .tm = tm,
+        .instances = renderables.data,
+        .count = renderables.size,
+        .batched_draws = batched_draws,
+        .draws =
+            ARENA_MAKE_ZERO_ARRAY(&engine->frame_arena, struct IndirectDraw, renderables.size)};
+    rpe_scene_build_indirect_draws(&draw_entry, parent);
 
     vkapi_cmdbuffer_t* cmds = vkapi_driver_get_compute_cmds(driver);
 
@@ -215,43 +309,19 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
     vkapi_driver_acquire_buffer_barrier(
         driver, cmds, scene->draw_count_handle, VKAPI_BARRIER_INDIRECT_CMD_READ_TO_COMPUTE);
 
-    // Update renderable objects.
-    arena_dyn_array_t* batched_draws = &scene->batched_draw_cache;
-
+    // The draw commands only depend on the batch, so can be recorded whilst the graph is running.
     for (size_t i = 0; i < batched_draws->size; ++i)
     {
         rpe_batch_renderable_t* batch = DYN_ARRAY_GET_PTR(rpe_batch_renderable_t, batched_draws, i);
-        for (size_t j = batch->first_idx; j < batch->first_idx + batch->count; ++j)
-        {
-            struct RenderableInstance* instance =
-                DYN_ARRAY_GET_PTR(struct RenderableInstance, &renderables, j);
-            rpe_renderable_t* rend = instance->rend;
-
-            struct IndirectDraw draw = {0};
-            draw.indirect_cmd.firstIndex = rend->mesh_data->index_offset;
-            draw.indirect_cmd.indexCount = rend->mesh_data->index_count;
-            draw.indirect_cmd.vertexOffset = (int32_t)rend->mesh_data->vertex_offset;
-            draw.object_id = rpe_comp_manager_get_obj_idx(tm->comp_manager, rend->transform_obj);
-            draw.batch_id = i;
-            draw.shadow_caster = rend->material->shadow_caster;
-            draw.perform_cull_test = rend->perform_cull_test;
-            DYN_ARRAY_APPEND(&indirect_draws, &draw);
-
-            // The draw data is the per-material instance - different texture samplers can be
-            // used without having to re-bind descriptors as we are using bindless samplers.
-            scene->draw_data[j] = rend->material->material_draw_data;
-            // These specialisation constants are set by the scene.
-            rend->material->material_consts.has_lighting = !scene->skip_lighting_pass;
-        }
 
         {
             // ==================== Colour GBuffer =========================
             // 1. Bind the graphics pipeline (along with descriptor sets).
             rpe_cmd_packet_t* pkt0 = rpe_command_bucket_add_command(
                 scene->render_queue->gbuffer_bucket,
+                batch->sort_key,
                 0,
                 sizeof(struct PipelineBindCommand),
-                &engine->frame_arena,
                 rpe_cmd_dispatch_pline_bind);
             struct PipelineBindCommand* pl_cmd = pkt0->cmds;
             pl_cmd->bundle = batch->material->program_bundle;
@@ -265,7 +335,6 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
                     nxt_pkt,
                     0,
                     sizeof(struct ScissorCommand),
-                    &engine->frame_arena,
                     rpe_cmd_dispatch_scissor_cmd);
                 struct ScissorCommand* sc_cmd = pkt1->cmds;
                 sc_cmd->scissor = batch->scissor;
@@ -280,20 +349,22 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
                     nxt_pkt,
                     0,
                     sizeof(struct ViewportCommand),
-                    &engine->frame_arena,
                     rpe_cmd_dispatch_viewport_cmd);
                 struct ViewportCommand* vp_cmd = pkt2->cmds;
                 vp_cmd->vp = batch->viewport;
                 nxt_pkt = pkt2;
             }
 
-            // 4. The actual indirect draw (indexed) command.
+            // 4. Bind the index buffer matching the width of the batch indices.
+            nxt_pkt = _scene_append_index_bind(
+                scene->render_queue->gbuffer_bucket, nxt_pkt, engine, batch->index_type);
+
+            // 5. The actual indirect draw (indexed) command.
             rpe_cmd_packet_t* pkt3 = rpe_command_bucket_append_command(
                 scene->render_queue->gbuffer_bucket,
                 nxt_pkt,
                 0,
                 sizeof(struct DrawIndirectIndexCommand),
-                &engine->frame_arena,
                 rpe_cmd_dispatch_draw_indirect_indexed);
             struct DrawIndirectIndexCommand* cmd = pkt3->cmds;
             cmd->stride = sizeof(struct IndirectDraw);
@@ -308,19 +379,20 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
         {
             rpe_cmd_packet_t* pkt0 = rpe_command_bucket_add_command(
                 scene->render_queue->depth_bucket,
+                batch->sort_key,
                 0,
                 sizeof(struct PipelineBindCommand),
-                &engine->frame_arena,
                 rpe_cmd_dispatch_pline_bind);
             struct PipelineBindCommand* pl_cmd = pkt0->cmds;
             pl_cmd->bundle = sm->csm_bundle;
 
+            rpe_cmd_packet_t* ib_pkt = _scene_append_index_bind(
+                scene->render_queue->depth_bucket, pkt0, engine, batch->index_type);
             rpe_cmd_packet_t* pkt1 = rpe_command_bucket_append_command(
                 scene->render_queue->depth_bucket,
-                pkt0,
+                ib_pkt,
                 0,
                 sizeof(struct DrawIndirectIndexCommand),
-                &engine->frame_arena,
                 rpe_cmd_dispatch_draw_indirect_indexed);
             struct DrawIndirectIndexCommand* cmd = pkt1->cmds;
             cmd->stride = sizeof(struct IndirectDraw);
@@ -331,13 +403,6 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
         }
     }
 
-    vkapi_driver_map_gpu_buffer(
-        driver,
-        scene->mesh_data_handle,
-        renderables.size * sizeof(struct IndirectDraw),
-        0,
-        indirect_draws.data);
-
     // Update the camera and scene UBO.
     rpe_camera_ubo_t cam_ubo = rpe_camera_update_ubo(scene->curr_camera, &frustum);
     vkapi_driver_map_gpu_buffer(driver, scene->camera_ubo, sizeof(rpe_camera_ubo_t), 0, &cam_ubo);
@@ -352,27 +417,19 @@ bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine)
     vkapi_driver_clear_gpu_buffer(driver, cmds, scene->shadow_draw_count_handle);
     vkapi_driver_clear_gpu_buffer(driver, cmds, scene->total_draw_handle);
 
-    // Ensure the model extent jobs are complete and data uploaded to the device before executing
+    // Ensure the update graph is complete and all data uploaded to the device before executing
     // the compute.
-    rpe_scene_sync_and_upload_extents(scene, engine, renderables.size, parent);
+    rpe_scene_sync_update(engine, parent);
 
     // Update the renderable extents buffer on the GPU and dispatch the culling compute shader.
     vkapi_driver_dispatch_compute(
-        driver, scene->cull_compute->bundle, scene->objects.size / 128 + 1, 1, 1);
+        driver, scene->cull_compute->bundle, renderables.size / 128 + 1, 1, 1);
 
     vkapi_driver_release_buffer_barrier(
         driver, cmds, scene->indirect_draw_handle, VKAPI_BARRIER_INDIRECT_CMD_READ_TO_COMPUTE);
     vkapi_driver_release_buffer_barrier(
         engine->driver, cmds, scene->draw_count_handle, VKAPI_BARRIER_INDIRECT_CMD_READ_TO_COMPUTE);
 
-    // Update GPU SSBO draw data buffer.
-    vkapi_driver_map_gpu_buffer(
-        driver,
-        scene->draw_data_handle,
-        renderables.size * sizeof(struct DrawData),
-        0,
-        scene->draw_data);
-
     TracyCZoneEnd(ctx);
 
     return true;
@@ -398,47 +455,188 @@ void rpe_scene_compute_model_extents_runner(uint32_t start, uint32_t count, void
         }
 
         rpe_rend_extents_t* t = &entry->scene->rend_extents[i];
-        math_mat4f model_world = instance.transform->world_transform;
-
-        rpe_aabox_t box = {.min = rend->box.min, .max = rend->box.max};
-        rpe_aabox_t world_box = rpe_aabox_calc_rigid_transform(
-            &box,
-            math_mat4f_to_rotation_matrix(model_world),
-            math_mat4f_translation_vec(model_world));
+        rpe_aabox_t world_box = _scene_instance_world_box(&instance);
         t->extent = math_vec4f_init_vec3(rpe_aabox_get_half_extent(&world_box), 0.0f);
         t->center = math_vec4f_init_vec3(rpe_aabox_get_center(&world_box), 0.0f);
     }
 }
 
+void rpe_scene_upload_extents_runner(void* data)
+{
+    assert(data);
+    struct UploadExtentsEntry* entry = (struct UploadExtentsEntry*)data;
+    vkapi_driver_map_gpu_buffer(
+        entry->engine->driver,
+        entry->scene->extents_buffer,
+        entry->count * sizeof(rpe_rend_extents_t),
+        0,
+        entry->scene->rend_extents);
+}
+
 void rpe_scene_compute_model_extents(
-    struct UploadExtentsEntry* entry, job_t* parent, struct SplitConfig* cfg)
+    struct UploadExtentsEntry* entry, job_t* parent, struct ChunkConfig* cfg)
 {
-    size_t count = entry->count;
-    job_t* job = parallel_for(
-        entry->engine->job_queue,
+    job_queue_t* jq = entry->engine->job_queue;
+
+    // The upload is only scheduled once all chunks of extents have been computed.
+    job_t* job = parallel_for_chunked(
+        jq,
         parent,
         0,
-        count,
+        entry->count,
         rpe_scene_compute_model_extents_runner,
         entry,
         cfg,
         &entry->engine->scratch_arena);
-    job_queue_run_job(entry->engine->job_queue, job);
+    job_t* upload_job =
+        job_queue_create_continuation(jq, job, rpe_scene_upload_extents_runner, entry, parent);
+    job_queue_run_job(jq, job);
+    job_queue_run_job(jq, upload_job);
 }
 
-void rpe_scene_sync_and_upload_extents(
-    rpe_scene_t* scene, rpe_engine_t* engine, size_t renderable_count, job_t* parent)
+void rpe_scene_build_indirect_draws_runner(void* data)
 {
-    // Ensure all model extent jobs have finished running before uploading.
-    job_queue_run_and_wait(engine->job_queue, parent);
-    arena_reset(&engine->scratch_arena);
+    assert(data);
+    struct IndirectDrawEntry* entry = (struct IndirectDrawEntry*)data;
+    rpe_scene_t* scene = entry->scene;
+    rpe_transform_manager_t* tm = entry->tm;
+    arena_dyn_array_t* batched_draws = entry->batched_draws;
 
+    for (size_t i = 0; i < batched_draws->size; ++i)
+    {
+        rpe_batch_renderable_t* batch = DYN_ARRAY_GET_PTR(rpe_batch_renderable_t, batched_draws, i);
+        for (size_t j = batch->first_idx; j < batch->first_idx + batch->count; ++j)
+        {
+            assert(j < entry->count);
+            rpe_renderable_t* rend = entry->instances[j].rend;
+
+            struct IndirectDraw* draw = &entry->draws[j];
+            draw->indirect_cmd.firstIndex = rend->mesh_data->index_offset;
+            draw->indirect_cmd.indexCount = rend->mesh_data->index_count;
+            draw->indirect_cmd.vertexOffset = (int32_t)rend->mesh_data->vertex_offset;
+            draw->object_id = rpe_comp_manager_get_obj_idx(tm->comp_manager, rend->transform_obj);
+            draw->batch_id = i;
+            draw->shadow_caster = rend->material->shadow_caster;
+            // Instances culled on the CPU are already known to be visible.
+            draw->perform_cull_test = rend->perform_cull_test && !scene->cpu_culling;
+
+            // The draw data is the per-material instance - different texture samplers can be
+            // used without having to re-bind descriptors as we are using bindless samplers.
+            scene->draw_data[j] = rend->material->material_draw_data;
+            // These specialisation constants are set by the scene.
+            rend->material->material_consts.has_lighting = !scene->skip_lighting_pass;
+        }
+    }
+}
+
+void rpe_scene_upload_draws_runner(void* data)
+{
+    assert(data);
+    struct IndirectDrawEntry* entry = (struct IndirectDrawEntry*)data;
+    vkapi_driver_t* driver = entry->engine->driver;
+
+    vkapi_driver_map_gpu_buffer(
+        driver,
+        entry->scene->mesh_data_handle,
+        entry->count * sizeof(struct IndirectDraw),
+        0,
+        entry->draws);
+
+    // Update GPU SSBO draw data buffer.
     vkapi_driver_map_gpu_buffer(
-        engine->driver,
-        scene->extents_buffer,
-        renderable_count * sizeof(rpe_rend_extents_t),
+        driver,
+        entry->scene->draw_data_handle,
+        entry->count * sizeof(struct DrawData),
         0,
-        scene->rend_extents);
+        entry->scene->draw_data);
+}
+
+void rpe_scene_build_indirect_draws(struct IndirectDrawEntry* entry, job_t* parent)
+{
+    job_queue_t* jq = entry->engine->job_queue;
+    job_t* build_job =
+        job_queue_create_job(jq, rpe_scene_build_indirect_draws_runner, entry, parent);
+    job_t* upload_job =
+        job_queue_create_continuation(jq, build_job, rpe_scene_upload_draws_runner, entry, parent);
+    job_queue_run_job(jq, build_job);
+    job_queue_run_job(jq, upload_job);
+}
+
+void rpe_scene_cull_runner(uint32_t start, uint32_t count, void* data)
+{
+    assert(data);
+    struct CullEntry* entry = (struct CullEntry*)data;
+    rpe_frustum_boxes_t* b = &entry->boxes;
+    uint8_t results[RPE_SCENE_CULL_BLOCK_SIZE];
+
+    for (uint32_t block = start; block < start + count; ++block)
+    {
+        size_t first = (size_t)block * RPE_SCENE_CULL_BLOCK_SIZE;
+        size_t block_size = entry->count - first < RPE_SCENE_CULL_BLOCK_SIZE
+            ? entry->count - first
+            : RPE_SCENE_CULL_BLOCK_SIZE;
+
+        for (size_t i = first; i < first + block_size; ++i)
+        {
+            rpe_aabox_t world_box = _scene_instance_world_box(&entry->instances[i]);
+            math_vec3f center = rpe_aabox_get_center(&world_box);
+            math_vec3f extent = rpe_aabox_get_half_extent(&world_box);
+            b->center_x[i] = center.x;
+            b->center_y[i] = center.y;
+            b->center_z[i] = center.z;
+            b->extent_x[i] = extent.x;
+            b->extent_y[i] = extent.y;
+            b->extent_z[i] = extent.z;
+        }
+
+        rpe_frustum_cull_boxes(entry->frustum, b, first, block_size, results);
+        for (size_t i = 0; i < block_size; ++i)
+        {
+            results[i] |= !entry->instances[first + i].rend->perform_cull_test;
+        }
+        entry->block_counts[block] = (uint32_t)rpe_frustum_compact_visible(
+            results, block_size, (uint32_t)first, entry->visible + first);
+    }
+}
+
+void rpe_scene_cull_instances(struct CullEntry* entry, rpe_engine_t* engine, job_t* parent)
+{
+    job_queue_t* jq = engine->job_queue;
+    uint32_t block_count =
+        (uint32_t)((entry->count + RPE_SCENE_CULL_BLOCK_SIZE - 1) / RPE_SCENE_CULL_BLOCK_SIZE);
+
+    // Each item is a block of renderables, so a chunk may be a single block.
+    struct ChunkConfig cfg = {.min_chunk_size = 1};
+    job_t* job = parallel_for_chunked(
+        jq, parent, 0, block_count, rpe_scene_cull_runner, entry, &cfg, &engine->scratch_arena);
+    job_queue_run_job(jq, job);
+}
+
+size_t rpe_scene_gather_visible(struct CullEntry* entry)
+{
+    assert(entry);
+    uint32_t block_count =
+        (uint32_t)((entry->count + RPE_SCENE_CULL_BLOCK_SIZE - 1) / RPE_SCENE_CULL_BLOCK_SIZE);
+
+    // The visible indices are ascending, so the instances can be moved forward in place.
+    size_t visible_count = 0;
+    for (uint32_t block = 0; block < block_count; ++block)
+    {
+        uint32_t* visible = entry->visible + (size_t)block * RPE_SCENE_CULL_BLOCK_SIZE;
+        for (uint32_t i = 0; i < entry->block_counts[block]; ++i)
+        {
+            entry->instances[visible_count++] = entry->instances[visible[i]];
+        }
+    }
+    return visible_count;
+}
+
+void rpe_scene_sync_update(rpe_engine_t* engine, job_t* parent)
+{
+    // Wait for the whole update graph to complete before releasing the job data.
+    job_queue_run_and_wait(engine->job_queue, parent);
+    arena_reset(&engine->scratch_arena);
+    job_queue_reset_thread_arenas(engine->job_queue);
 }
 
 /** Public functions **/
@@ -507,3 +705,9 @@ void rpe_scene_skip_lighting_pass(rpe_scene_t* scene)
     assert(scene);
     scene->skip_lighting_pass = true;
 }
+
+void rpe_scene_set_cpu_culling(rpe_scene_t* scene, bool enabled)
+{
+    assert(scene);
+    scene->cpu_culling = enabled;
+}
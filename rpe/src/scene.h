@@ -23,6 +23,7 @@
 #ifndef __SCENE_PRIV_H__
 #define __SCENE_PRIV_H__
 
+#include "frustum.h"
 #include "rpe/aabox.h"
 #include "rpe/scene.h"
 #include "shadow_manager.h"
@@ -38,6 +39,9 @@
 #define RPE_SCENE_SKIN_SSBO_BINDING 0
 #define RPE_SCENE_TRANSFORM_SSBO_BINDING 1
 #define RPE_SCENE_DRAW_DATA_SSBO_BINDING 2
+// The number of renderables culled by each CPU culling job. Each job compacts its visible
+// renderables into its own range, so the results are in the same order as the input.
+#define RPE_SCENE_CULL_BLOCK_SIZE 1024
 
 typedef struct Renderable rpe_renderable_t;
 typedef struct Engine rpe_engine_t;
@@ -49,10 +53,11 @@ typedef struct RenderableManager rpe_rend_manager_t;
 typedef struct TransformManager rpe_transform_manager_t;
 typedef struct Ibl ibl_t;
 typedef struct Skybox rpe_skybox_t;
-typedef struct TransformNode rpe_transform_node_t;
-struct SplitConfig;
+typedef struct RenderableSortCache rpe_rend_sort_cache_t;
+struct ChunkConfig;
 
 struct DrawData;
+struct IndirectDraw;
 
 typedef struct RenderableExtents
 {
@@ -63,7 +68,7 @@ typedef struct RenderableExtents
 typedef struct RenderableInstance
 {
     rpe_renderable_t* rend;
-    rpe_transform_node_t* transform;
+    math_mat4f* world_transform;
 };
 
 typedef struct SceneUbo
@@ -77,6 +82,9 @@ typedef struct Scene
     rpe_render_queue_t* render_queue;
     arena_dyn_array_t objects;
     arena_dyn_array_t batched_draw_cache;
+    // The sorted order of the renderables from the last update.
+    rpe_rend_sort_cache_t* sort_cache;
+    // Set when objects are added or removed, forcing a full sort of the renderables.
     bool is_dirty;
 
     // Used on the fragment shader - data from each material instance.
@@ -118,6 +126,9 @@ typedef struct Scene
     // Scene specific options.
     enum ShadowStatus shadow_status;
     bool skip_lighting_pass;
+    // If set, renderables are culled on the CPU before the draws are built, rather than by the
+    // cull compute shader.
+    bool cpu_culling;
 
     // Per-scene shadow info
     float cascade_offsets[RPE_SHADOW_MANAGER_MAX_CASCADE_COUNT];
@@ -135,14 +146,55 @@ struct UploadExtentsEntry
     size_t count;
 };
 
+struct IndirectDrawEntry
+{
+    rpe_scene_t* scene;
+    rpe_engine_t* engine;
+    rpe_transform_manager_t* tm;
+    struct RenderableInstance* instances;
+    size_t count;
+    arena_dyn_array_t* batched_draws;
+    /// Indirect draws, one per renderable instance, which are uploaded to the device.
+    struct IndirectDraw* draws;
+};
+
+struct CullEntry
+{
+    rpe_frustum_t* frustum;
+    struct RenderableInstance* instances;
+    size_t count;
+    /// The world-space boxes of the instances.
+    rpe_frustum_boxes_t boxes;
+    /// The indices of the visible instances - each block writes from its first instance index.
+    uint32_t* visible;
+    /// The number of visible instances in each block.
+    uint32_t* block_counts;
+};
+
 rpe_scene_t* rpe_scene_init(rpe_engine_t* engine, arena_t* arena);
 
 bool rpe_scene_update(rpe_scene_t* scene, rpe_engine_t* engine);
 
+void rpe_scene_compute_model_extents_runner(uint32_t start, uint32_t count, void* data);
+
+// Adds jobs to the parent which compute the world extents of each model and upload them once
+// complete.
 void rpe_scene_compute_model_extents(
-    struct UploadExtentsEntry* entry, job_t* parent, struct SplitConfig* cfg);
+    struct UploadExtentsEntry* entry, job_t* parent, struct ChunkConfig* cfg);
+
+// Adds jobs to the parent which build the indirect draw and draw data for each batched renderable
+// and upload them once complete.
+void rpe_scene_build_indirect_draws(struct IndirectDrawEntry* entry, job_t* parent);
+
+// Adds jobs to the parent which test each instance against the frustum and compact the indices
+// of those visible.
+void rpe_scene_cull_instances(struct CullEntry* entry, rpe_engine_t* engine, job_t* parent);
+
+// Once the cull jobs have completed, move the visible instances to the front of the instance
+// array, in their original order. Returns the number of visible instances.
+size_t rpe_scene_gather_visible(struct CullEntry* entry);
 
-void rpe_scene_sync_and_upload_extents(
-    rpe_scene_t* scene, rpe_engine_t* engine, size_t renderable_count, job_t* parent);
+// Wait for all jobs added to the update parent to complete.
+void rpe_scene_sync_update(rpe_engine_t* engine, job_t* parent);
 
 #endif
\ No newline at end of file
@@ -42,17 +42,16 @@ rpe_shadow_manager_t* rpe_shadow_manager_init(rpe_engine_t* engine, struct Shado
 
     vkapi_driver_t* driver = engine->driver;
 
-    sm->csm_shaders[RPE_BACKEND_SHADER_STAGE_VERTEX] = program_cache_from_spirv(
+    shader_compile_request_t csm_requests[2] = {
+        {.filename = "shadow.vert.spv", .stage = RPE_BACKEND_SHADER_STAGE_VERTEX},
+        {.filename = "shadow.frag.spv", .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT}};
+    program_cache_compile_batch(
         driver->prog_manager,
         driver->context,
-        "shadow.vert.spv",
-        RPE_BACKEND_SHADER_STAGE_VERTEX,
-        arena);
-    sm->csm_shaders[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = program_cache_from_spirv(
-        driver->prog_manager,
-        driver->context,
-        "shadow.frag.spv",
-        RPE_BACKEND_SHADER_STAGE_FRAGMENT,
+        engine->job_queue,
+        csm_requests,
+        2,
+        sm->csm_shaders,
         arena);
 
     if ((!vkapi_is_valid_shader_handle(sm->csm_shaders[RPE_BACKEND_SHADER_STAGE_VERTEX]) ||
@@ -118,17 +117,17 @@ rpe_shadow_manager_t* rpe_shadow_manager_init(rpe_engine_t* engine, struct Shado
 
     if (settings.enable_debug_cascade)
     {
-        sm->csm_debug_shaders[RPE_BACKEND_SHADER_STAGE_VERTEX] = program_cache_from_spirv(
+        shader_compile_request_t debug_requests[2] = {
+            {.filename = "fullscreen_quad.vert.spv", .stage = RPE_BACKEND_SHADER_STAGE_VERTEX},
+            {.filename = "shadow_cascade_debug.frag.spv",
+             .stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT}};
+        program_cache_compile_batch(
             driver->prog_manager,
             driver->context,
-            "fullscreen_quad.vert.spv",
-            RPE_BACKEND_SHADER_STAGE_VERTEX,
-            &engine->perm_arena);
-        sm->csm_debug_shaders[RPE_BACKEND_SHADER_STAGE_FRAGMENT] = program_cache_from_spirv(
-            driver->prog_manager,
-            driver->context,
-            "shadow_cascade_debug.frag.spv",
-            RPE_BACKEND_SHADER_STAGE_FRAGMENT,
+            engine->job_queue,
+            debug_requests,
+            2,
+            sm->csm_debug_shaders,
             &engine->perm_arena);
 
         sm->csm_debug_bundle = program_cache_create_program_bundle(driver->prog_manager, arena);
@@ -287,15 +286,30 @@ void update_projections_runner(void* data)
         (camera->n + scene->cascade_offsets[idx] * clip_range) * -1.0f;
 }
 
+void upload_projections_runner(void* data)
+{
+    assert(data);
+    struct UploadProjectionsEntry* entry = (struct UploadProjectionsEntry*)data;
+    rpe_shadow_manager_upload_projections(entry->sm, entry->engine, entry->scene);
+}
+
 void rpe_shadow_manager_update_projections(
     rpe_shadow_manager_t* sm,
     rpe_camera_t* camera,
     rpe_scene_t* scene,
     rpe_engine_t* engine,
-    rpe_light_manager_t* lm)
+    rpe_light_manager_t* lm,
+    job_t* parent)
 {
+    assert(parent);
     job_queue_t* jq = engine->job_queue;
-    sm->parent_job = job_queue_create_parent_job(engine->job_queue);
+
+    // The upload is scheduled once all cascades have been updated.
+    sm->upload_entry.sm = sm;
+    sm->upload_entry.engine = engine;
+    sm->upload_entry.scene = scene;
+    job_t* upload_job =
+        job_queue_create_job(jq, upload_projections_runner, &sm->upload_entry, parent);
 
     for (int i = 0; i < sm->settings.cascade_count; ++i)
     {
@@ -306,14 +320,11 @@ void rpe_shadow_manager_update_projections(
         entry->idx = i;
         entry->dir_light = rpe_light_manager_get_dir_light_params(lm);
 
-        entry->job = job_queue_create_job(jq, update_projections_runner, entry, sm->parent_job);
+        entry->job = job_queue_create_job(jq, update_projections_runner, entry, parent);
+        job_queue_add_dependency(jq, entry->job, upload_job);
         job_queue_run_job(jq, sm->job_entries[i].job);
     }
-}
-
-void rpe_shadow_manager_sync_update(rpe_shadow_manager_t* m, rpe_engine_t* engine)
-{
-    job_queue_run_and_wait(engine->job_queue, m->parent_job);
+    job_queue_run_job(jq, upload_job);
 }
 
 void rpe_shadow_manager_upload_projections(
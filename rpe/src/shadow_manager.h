@@ -56,6 +56,16 @@ struct JobEntry
     int idx;
 };
 
+/**
+ Entry data for the projection upload job.
+ */
+struct UploadProjectionsEntry
+{
+    rpe_shadow_manager_t* sm;
+    rpe_engine_t* engine;
+    rpe_scene_t* scene;
+};
+
 typedef struct ShadowMap
 {
     struct CascadeInfo
@@ -78,21 +88,22 @@ typedef struct ShadowManager
     shader_handle_t csm_shaders[2];
     shader_handle_t csm_debug_shaders[2];
     buffer_handle_t cascade_ubo;
-    job_t* parent_job;
     struct JobEntry job_entries[RPE_SHADOW_MANAGER_MAX_CASCADE_COUNT];
+    struct UploadProjectionsEntry upload_entry;
 } rpe_shadow_manager_t;
 
 rpe_shadow_manager_t* rpe_shadow_manager_init(rpe_engine_t* engine, struct ShadowSettings settings);
 
+// Creates a job per cascade to update the projections, followed by a job which uploads the
+// projections once all cascades are complete. All jobs are children of the specified parent, so
+// waiting on the parent ensures the projections have been uploaded.
 void rpe_shadow_manager_update_projections(
     rpe_shadow_manager_t* m,
     rpe_camera_t* camera,
     rpe_scene_t* scene,
     rpe_engine_t* engine,
-    rpe_light_manager_t* lm);
-
-// Check that the projection update jobs have finished running.
-void rpe_shadow_manager_sync_update(rpe_shadow_manager_t* m, rpe_engine_t* engine);
+    rpe_light_manager_t* lm,
+    job_t* parent);
 
 // Make sure this is called after updating the projections (see above).
 void rpe_shadow_manager_upload_projections(
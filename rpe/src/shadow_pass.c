@@ -22,6 +22,7 @@
 
 #include "shadow_pass.h"
 
+#include "commands.h"
 #include "engine.h"
 #include "render_graph/render_graph.h"
 #include "render_graph/render_pass_node.h"
@@ -53,18 +54,22 @@ void setup_shadow_pass(render_graph_t* rg, rg_pass_node_t* node, void* data, voi
     d->depth = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "ShadowDepth", VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("ShadowDepth"),
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
     d->depth = rg_add_write(rg, d->depth, node, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
-    rg_backboard_add(bb, "CascadeShadowDepth", d->depth);
+    rg_backboard_add(bb, INTERN_LITERAL("CascadeShadowDepth"), d->depth);
 
     rg_pass_desc_t desc = rg_pass_desc_init();
     desc.attachments.attach.depth = d->depth;
     desc.multi_view_count = local_d->cascade_count;
     desc.ds_load_clear_flags[0] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
     desc.ds_store_clear_flags[0] = RPE_BACKEND_RENDERPASS_STORE_CLEAR_FLAG_STORE;
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "ShadowPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("ShadowPass"), desc);
 
     // Only a single writer declared so add side effect otherwise this pass will be culled.
     rg_node_declare_side_effect((rg_node_t*)node);
@@ -80,19 +85,38 @@ void execute_shadow_pass(
     rg_resource_info_t info = rg_res_get_render_pass_info(res, d->rt);
 
     vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
-    vkapi_driver_begin_rpass(driver, cmd_buffer->instance, &info.data, &info.handle);
-
-    // Bind the uber vertex/index buffers - only one bind call required as all draw calls offset
-    // into this buffer.
-    // NOTE: The vertex data is currently uploaded in the colour pass so the shadow pass must be
-    // called after. If multi threaded rendering is added, this will need changing.
-    vkapi_driver_bind_vertex_buffer(driver, engine->vbuffer->vertex_buffer, 0);
-    vkapi_driver_bind_vertex_buffer(driver, engine->curr_scene->shadow_model_draw_data_handle, 1);
-    vkapi_driver_bind_index_buffer(driver, engine->vbuffer->index_buffer);
-
     rpe_scene_t* scene = d->scene;
     assert(scene);
-    rpe_render_queue_submit_one(scene->render_queue, driver, RPE_RENDER_QUEUE_DEPTH);
+
+    // Bind the uber vertex buffer - only one bind call required as all draw calls offset into
+    // this buffer. The index buffer depends on the index width so is bound by each batch.
+    // NOTE: The vertex data is uploaded during the scene update.
+    buffer_handle_t vertex_buffers[2] = {
+        engine->vbuffer->pools[RPE_VERTEX_POOL_VERTEX].buffer,
+        engine->curr_scene->shadow_model_draw_data_handle};
+    if (engine->settings.parallel_draw_recording)
+    {
+        vkapi_driver_begin_rpass_secondary(driver, cmd_buffer->instance, &info.data, &info.handle);
+        rpe_cmd_secondary_data_t rec_data = {
+            .primary = cmd_buffer->instance,
+            .vertex_buffers = {vertex_buffers[0], vertex_buffers[1]},
+            .vertex_buffer_count = 2};
+        rpe_cmd_recorder_t rec = rpe_cmd_secondary_recorder_init(&rec_data);
+        rpe_render_queue_submit_one_mt(
+            scene->render_queue,
+            driver,
+            RPE_RENDER_QUEUE_DEPTH,
+            engine->job_queue,
+            &rec,
+            &engine->frame_arena);
+    }
+    else
+    {
+        vkapi_driver_begin_rpass(driver, cmd_buffer->instance, &info.data, &info.handle);
+        vkapi_driver_bind_vertex_buffer(driver, vertex_buffers[0], 0);
+        vkapi_driver_bind_vertex_buffer(driver, vertex_buffers[1], 1);
+        rpe_render_queue_submit_one(scene->render_queue, driver, RPE_RENDER_QUEUE_DEPTH);
+    }
 
     vkapi_driver_end_rpass(cmd_buffer->instance);
 }
@@ -116,7 +140,7 @@ rg_handle_t rpe_shadow_pass_render(
         .scene = scene};
     rg_pass_t* p = rg_add_pass(
         rg,
-        "ShadowPass",
+        INTERN_LITERAL("ShadowPass"),
         setup_shadow_pass,
         execute_shadow_pass,
         sizeof(struct ShadowPassData),
@@ -131,8 +155,8 @@ void setup_cascade_debug_pass(
     struct CascadeDebugLocalData* local_d = (struct CascadeDebugLocalData*)local_data;
     struct CascadeDebugPassData* d = (struct CascadeDebugPassData*)data;
     rg_backboard_t* bb = rg_get_backboard(rg);
-    rg_handle_t cascade_map = rg_backboard_get(bb, "CascadeShadowDepth");
-    rg_handle_t light_colour = rg_backboard_get(bb, "light");
+    rg_handle_t cascade_map = rg_backboard_get(bb, INTERN_LITERAL("CascadeShadowDepth"));
+    rg_handle_t light_colour = rg_backboard_get(bb, INTERN_LITERAL("light"));
 
     rg_texture_desc_t t_desc = {
         .width = local_d->width,
@@ -145,7 +169,10 @@ void setup_cascade_debug_pass(
     d->colour = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "ShadowCascadeDebug", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("ShadowCascadeDebug"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
     d->colour = rg_add_write(rg, d->colour, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
     d->cascade_map = rg_add_read(rg, cascade_map, node, VK_IMAGE_USAGE_SAMPLED_BIT);
@@ -155,7 +182,8 @@ void setup_cascade_debug_pass(
     desc.attachments.attach.colour[0] = d->colour;
     desc.ds_load_clear_flags[0] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
     desc.ds_store_clear_flags[0] = RPE_BACKEND_RENDERPASS_STORE_CLEAR_FLAG_STORE;
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "CascadeDebugPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("CascadeDebugPass"), desc);
 
     rg_node_declare_side_effect((rg_node_t*)node);
     d->prog_bundle = local_d->prog_bundle;
@@ -195,7 +223,7 @@ rg_handle_t rpe_cascade_shadow_debug_render(
         .prog_bundle = sm->csm_debug_bundle, .width = width, .height = height};
     rg_pass_t* p = rg_add_pass(
         rg,
-        "CascadeDebugPass",
+        INTERN_LITERAL("CascadeDebugPass"),
         setup_cascade_debug_pass,
         execute_cascade_debug_pass,
         sizeof(struct CascadeDebugPassData),
@@ -66,7 +66,8 @@ rpe_skybox_t* rpe_skybox_init(rpe_engine_t* engine, arena_t* arena)
 
     rpe_rend_manager_t* rm = rpe_engine_get_rend_manager(engine);
     rpe_valloc_handle v_handle = rpe_rend_manager_alloc_vertex_buffer(rm, 8);
-    rpe_valloc_handle i_handle = rpe_rend_manager_alloc_index_buffer(rm, 36);
+    rpe_valloc_handle i_handle =
+        rpe_rend_manager_alloc_index_buffer(rm, 36, RPE_RENDERABLE_INDICES_U32);
     skybox->cube_mesh = rpe_rend_manager_create_mesh_interleaved(
         engine->rend_manager,
         v_handle,
@@ -24,103 +24,254 @@
 
 #include <string.h>
 #include <utility/arena.h>
-#include <vulkan-api/buffer.h>
 #include <vulkan-api/driver.h>
 
-rpe_vertex_buffer_t* rpe_vertex_buffer_init(vkapi_driver_t* driver, arena_t* arena)
+void rpe_vertex_pool_init(
+    rpe_vertex_pool_t* p, uint32_t element_size, uint32_t page_size, arena_t* arena)
 {
-    rpe_vertex_buffer_t* i = ARENA_MAKE_ZERO_STRUCT(arena, rpe_vertex_buffer_t);
+    assert(p);
+    assert(element_size > 0);
+    assert(page_size > 0);
+    memset(p, 0, sizeof(rpe_vertex_pool_t));
+    p->element_size = element_size;
+    p->page_size = page_size;
+    offset_alloc_init(&p->allocator, page_size, arena);
+    dyn_array_init(arena, page_size, element_size, _Alignof(float), &p->data);
+    dyn_array_resize(&p->data, page_size);
+    MAKE_DYN_ARRAY(rpe_vertex_pending_free_t, arena, 50, &p->pending_frees);
+    vkapi_invalidate_buffer_handle(&p->buffer);
+}
 
-    i->vertex_data =
-        ARENA_MAKE_ARRAY(arena, rpe_vertex_t, RPE_VERTEX_GPU_BUFFER_SIZE, ARENA_ZERO_MEMORY);
-    i->index_data = ARENA_MAKE_ARRAY(arena, uint32_t, RPE_INDEX_GPU_BUFFER_SIZE, ARENA_ZERO_MEMORY);
+rpe_vertex_alloc_info_t rpe_vertex_pool_alloc(rpe_vertex_pool_t* p, uint32_t count)
+{
+    assert(p);
+    assert(count > 0);
+    offset_alloc_t alloc = offset_alloc_allocate(&p->allocator, count);
+    if (alloc.offset == OFFSET_ALLOC_INVALID)
+    {
+        // Grow by at least the current size, so the number of times the GPU buffer is recreated
+        // stays small.
+        uint32_t capacity = p->allocator.capacity;
+        uint32_t grow_size = count > capacity ? count : capacity;
+        uint32_t new_capacity =
+            (capacity + grow_size + p->page_size - 1) / p->page_size * p->page_size;
+        offset_alloc_grow(&p->allocator, new_capacity);
+        dyn_array_resize(&p->data, new_capacity);
+        alloc = offset_alloc_allocate(&p->allocator, count);
+        assert(alloc.offset != OFFSET_ALLOC_INVALID);
+    }
+    rpe_vertex_alloc_info_t info = {.offset = alloc.offset, .size = count, .node = alloc.node};
+    uint32_t end = alloc.offset + count;
+    p->used_extent = end > p->used_extent ? end : p->used_extent;
+    return info;
+}
 
-    i->vertex_buffer = vkapi_res_cache_create_vertex_buffer(
-        driver->res_cache, driver, RPE_VERTEX_GPU_BUFFER_SIZE * sizeof(rpe_vertex_t));
-    i->index_buffer = vkapi_res_cache_create_index_buffer(
-        driver->res_cache, driver, RPE_INDEX_GPU_BUFFER_SIZE * sizeof(uint32_t));
+void rpe_vertex_pool_free(
+    rpe_vertex_pool_t* p, rpe_vertex_alloc_info_t* info, uint64_t current_frame)
+{
+    assert(p);
+    assert(info);
+    assert(info->node != OFFSET_ALLOC_INVALID);
+    // Frames in flight may still be reading from the range, so it can't be reused yet.
+    rpe_vertex_pending_free_t pending = {
+        .alloc = {.offset = info->offset, .node = info->node}, .freed_frame = current_frame};
+    DYN_ARRAY_APPEND(&p->pending_frees, &pending);
+    info->node = OFFSET_ALLOC_INVALID;
+}
 
-    return i;
+void rpe_vertex_pool_gc(rpe_vertex_pool_t* p, uint64_t current_frame)
+{
+    assert(p);
+    // Iterate in reverse so removing an entry doesn't skip the next.
+    for (int64_t i = (int64_t)p->pending_frees.size - 1; i >= 0; --i)
+    {
+        rpe_vertex_pending_free_t* pending =
+            DYN_ARRAY_GET_PTR(rpe_vertex_pending_free_t, &p->pending_frees, i);
+        if (pending->freed_frame + VKAPI_MAX_COMMAND_BUFFER_SIZE < current_frame)
+        {
+            offset_alloc_free(&p->allocator, pending->alloc);
+            DYN_ARRAY_REMOVE(&p->pending_frees, i);
+        }
+    }
 }
 
-void rpe_vertex_buffer_copy_vert_data(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, rpe_vertex_t* data)
+void rpe_vertex_pool_write(
+    rpe_vertex_pool_t* p, rpe_vertex_alloc_info_t* info, const void* data, uint32_t count)
 {
+    assert(p);
+    assert(info);
     assert(data);
-    assert(alloc_info.size > 0);
-    assert(alloc_info.memory_ptr);
-    memcpy(alloc_info.memory_ptr, data, alloc_info.size * sizeof(rpe_vertex_t));
-    vb->is_dirty = true;
+    assert(info->node != OFFSET_ALLOC_INVALID);
+    assert(count <= info->size);
+    if (!count)
+    {
+        return;
+    }
+    uint8_t* dst = (uint8_t*)p->data.data + (size_t)info->offset * p->element_size;
+    memcpy(dst, data, (size_t)count * p->element_size);
+    rpe_vertex_pool_mark_dirty(p, info->offset, info->offset + count);
 }
 
-rpe_vertex_alloc_info_t rpe_vertex_buffer_alloc_vertex_buffer(rpe_vertex_buffer_t* vb, size_t size)
+void rpe_vertex_pool_mark_dirty(rpe_vertex_pool_t* p, uint32_t start, uint32_t end)
 {
-    assert(vb);
-    assert(vb->curr_vertex_size + size < RPE_VERTEX_GPU_BUFFER_SIZE);
-    rpe_vertex_alloc_info_t i;
-    i.memory_ptr = (uint8_t*)(vb->vertex_data + vb->curr_vertex_size);
-    i.offset = vb->curr_vertex_size;
-    i.size = size;
-    vb->curr_vertex_size += size;
-    return i;
+    assert(p);
+    assert(start < end);
+    rpe_vertex_dirty_range_t* ranges = p->dirty_ranges;
+
+    // Find the first range which overlaps or touches the new range.
+    uint32_t first = 0;
+    while (first < p->dirty_count && ranges[first].end < start)
+    {
+        ++first;
+    }
+    uint32_t last = first;
+    while (last < p->dirty_count && ranges[last].start <= end)
+    {
+        start = ranges[last].start < start ? ranges[last].start : start;
+        end = ranges[last].end > end ? ranges[last].end : end;
+        ++last;
+    }
+
+    if (last > first)
+    {
+        // Replace all the ranges which were merged with the combined range.
+        ranges[first] = (rpe_vertex_dirty_range_t){.start = start, .end = end};
+        memmove(
+            &ranges[first + 1],
+            &ranges[last],
+            sizeof(rpe_vertex_dirty_range_t) * (p->dirty_count - last));
+        p->dirty_count -= last - first - 1;
+        return;
+    }
+
+    if (p->dirty_count == RPE_VERTEX_POOL_MAX_DIRTY_RANGES)
+    {
+        // No room for another range, so extend whichever neighbour is closest. This uploads the
+        // elements in the gap as well, but keeps the upload count bounded.
+        bool use_prev = first == p->dirty_count ||
+            (first > 0 && start - ranges[first - 1].end <= ranges[first].start - end);
+        if (use_prev)
+        {
+            ranges[first - 1].end = end;
+        }
+        else
+        {
+            ranges[first].start = start;
+        }
+        return;
+    }
+
+    memmove(
+        &ranges[first + 1],
+        &ranges[first],
+        sizeof(rpe_vertex_dirty_range_t) * (p->dirty_count - first));
+    ranges[first] = (rpe_vertex_dirty_range_t){.start = start, .end = end};
+    ++p->dirty_count;
 }
 
-rpe_vertex_alloc_info_t rpe_vertex_buffer_alloc_index_buffer(rpe_vertex_buffer_t* vb, size_t size)
+void _vertex_pool_upload(rpe_vertex_pool_t* p, enum VertexPoolType type, vkapi_driver_t* driver)
 {
-    assert(vb);
-    assert(vb->curr_index_size + size < RPE_INDEX_GPU_BUFFER_SIZE);
-    rpe_vertex_alloc_info_t i;
-    i.memory_ptr = (uint8_t*)(vb->index_data + vb->curr_index_size);
-    i.offset = vb->curr_index_size;
-    i.size = size;
-    vb->curr_index_size += size;
+    uint32_t capacity = p->allocator.capacity;
+    if (p->buffer_capacity < capacity)
+    {
+        // The pool has grown - the old buffer may still be in use by the GPU so its destruction
+        // is deferred. Everything allocated so far needs uploading to the new buffer.
+        if (vkapi_buffer_handle_is_valid(p->buffer))
+        {
+            vkapi_res_cache_delete_buffer(driver->res_cache, p->buffer);
+        }
+        VkDeviceSize size = (VkDeviceSize)capacity * p->element_size;
+        p->buffer = type == RPE_VERTEX_POOL_VERTEX
+            ? vkapi_res_cache_create_vertex_buffer(driver->res_cache, driver, size)
+            : vkapi_res_cache_create_index_buffer(driver->res_cache, driver, size);
+        p->buffer_capacity = capacity;
+        p->dirty_count = 0;
+        if (p->used_extent)
+        {
+            rpe_vertex_pool_mark_dirty(p, 0, p->used_extent);
+        }
+    }
+
+    for (uint32_t i = 0; i < p->dirty_count; ++i)
+    {
+        rpe_vertex_dirty_range_t* r = &p->dirty_ranges[i];
+        size_t offset = (size_t)r->start * p->element_size;
+        size_t size = (size_t)(r->end - r->start) * p->element_size;
+        void* data = (uint8_t*)p->data.data + offset;
+        if (type == RPE_VERTEX_POOL_VERTEX)
+        {
+            vkapi_driver_upload_vertex_data(driver, p->buffer, data, size, offset);
+        }
+        else
+        {
+            vkapi_driver_upload_index_data(driver, p->buffer, data, size, offset);
+        }
+    }
+    p->dirty_count = 0;
+}
+
+rpe_vertex_buffer_t* rpe_vertex_buffer_init(vkapi_driver_t* driver, arena_t* arena)
+{
+    rpe_vertex_buffer_t* i = ARENA_MAKE_ZERO_STRUCT(arena, rpe_vertex_buffer_t);
+    rpe_vertex_pool_init(
+        &i->pools[RPE_VERTEX_POOL_VERTEX],
+        sizeof(rpe_vertex_t),
+        RPE_VERTEX_GPU_BUFFER_PAGE_SIZE,
+        arena);
+    rpe_vertex_pool_init(
+        &i->pools[RPE_VERTEX_POOL_INDEX_U16],
+        sizeof(uint16_t),
+        RPE_INDEX_GPU_BUFFER_PAGE_SIZE,
+        arena);
+    rpe_vertex_pool_init(
+        &i->pools[RPE_VERTEX_POOL_INDEX_U32],
+        sizeof(uint32_t),
+        RPE_INDEX_GPU_BUFFER_PAGE_SIZE,
+        arena);
+
+    // Create the GPU buffers up front so the handles are valid before anything is allocated.
+    rpe_vertex_buffer_upload_to_gpu(i, driver);
     return i;
 }
 
-void rpe_vertex_buffer_copy_index_data_u32(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, const int32_t* data)
+enum VertexPoolType rpe_vertex_buffer_index_pool(enum IndicesType type)
 {
-    assert(data);
-    assert(alloc_info.memory_ptr);
-    assert(alloc_info.size > 0);
-    memcpy(alloc_info.memory_ptr, data, alloc_info.size * sizeof(uint32_t));
-    vb->is_dirty = true;
+    return type == RPE_RENDERABLE_INDICES_U16 ? RPE_VERTEX_POOL_INDEX_U16
+                                              : RPE_VERTEX_POOL_INDEX_U32;
 }
 
-void rpe_vertex_buffer_copy_index_data_u16(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, const int16_t* data)
+rpe_vertex_alloc_info_t
+rpe_vertex_buffer_alloc(rpe_vertex_buffer_t* vb, enum VertexPoolType pool, uint32_t count)
 {
-    assert(data);
-    assert(alloc_info.memory_ptr);
-    assert(alloc_info.size > 0);
+    assert(vb);
+    assert(pool < RPE_VERTEX_POOL_COUNT);
+    rpe_vertex_alloc_info_t info = rpe_vertex_pool_alloc(&vb->pools[pool], count);
+    info.pool = pool;
+    return info;
+}
 
-    // Currently we convert 16-bit integers to 32-bit.
-    // FIXME: Add 16bit support to Vulkan backend.
-    uint32_t* ptr = (uint32_t*)alloc_info.memory_ptr;
-    for (size_t i = 0; i < alloc_info.size; ++i, ptr++)
-    {
-        int32_t val = (int32_t)data[i];
-        memcpy(ptr, &val, sizeof(int32_t));
-    }
+void rpe_vertex_buffer_free(
+    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t* info, uint64_t current_frame)
+{
+    assert(vb);
+    assert(info);
+    rpe_vertex_pool_free(&vb->pools[info->pool], info, current_frame);
+}
 
-    vb->is_dirty = true;
+void rpe_vertex_buffer_copy_data(
+    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t* info, const void* data, uint32_t count)
+{
+    assert(vb);
+    assert(info);
+    rpe_vertex_pool_write(&vb->pools[info->pool], info, data, count);
 }
 
 void rpe_vertex_buffer_upload_to_gpu(rpe_vertex_buffer_t* vb, vkapi_driver_t* driver)
 {
     assert(vb);
-    if (!vb->is_dirty)
+    for (uint32_t i = 0; i < RPE_VERTEX_POOL_COUNT; ++i)
     {
-        return;
+        rpe_vertex_pool_gc(&vb->pools[i], driver->current_frame);
+        _vertex_pool_upload(&vb->pools[i], i, driver);
     }
-
-    vkapi_driver_map_gpu_vertex(
-        driver,
-        vb->vertex_buffer,
-        vb->vertex_data,
-        vb->curr_vertex_size * sizeof(rpe_vertex_t),
-        vb->index_buffer,
-        vb->index_data,
-        vb->curr_index_size * sizeof(uint32_t));
-    vb->is_dirty = false;
-}
\ No newline at end of file
+}
@@ -28,55 +28,142 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <utility/offset_allocator.h>
 #include <vulkan-api/resource_cache.h>
 
-#define RPE_VERTEX_GPU_BUFFER_SIZE (1 << 15)
-#define RPE_INDEX_GPU_BUFFER_SIZE (1 << 15)
+// The pools grow in pages of this many elements - this is also the initial size of each pool.
+#define RPE_VERTEX_GPU_BUFFER_PAGE_SIZE (1 << 15)
+#define RPE_INDEX_GPU_BUFFER_PAGE_SIZE (1 << 16)
+// If more ranges than this are modified before an upload, the closest ranges are merged.
+#define RPE_VERTEX_POOL_MAX_DIRTY_RANGES 32
 
-typedef struct VkApiStageInstance vkapi_staging_instance_t;
-typedef struct VkApiBuffer vkapi_buffer_t;
+typedef struct VkApiDriver vkapi_driver_t;
+
+enum VertexPoolType
+{
+    RPE_VERTEX_POOL_VERTEX,
+    RPE_VERTEX_POOL_INDEX_U16,
+    RPE_VERTEX_POOL_INDEX_U32,
+    RPE_VERTEX_POOL_COUNT
+};
 
 typedef struct VertexAllocInfo
 {
+    /// The offset into the pool (as a count of elements).
     uint32_t offset;
-    uint8_t* memory_ptr;
+    /// The number of elements allocated.
     uint32_t size;
+    /// The allocator node - OFFSET_ALLOC_INVALID once the range has been freed.
+    uint32_t node;
+    enum VertexPoolType pool;
 } rpe_vertex_alloc_info_t;
 
+typedef struct VertexPendingFree
+{
+    offset_alloc_t alloc;
+    /// The frame the range was freed on.
+    uint64_t freed_frame;
+} rpe_vertex_pending_free_t;
+
+typedef struct VertexDirtyRange
+{
+    uint32_t start;
+    uint32_t end;
+} rpe_vertex_dirty_range_t;
+
+/**
+ A sub-allocated region of one of the "uber" buffers. All meshes share the same GPU buffer, which
+ is recreated at the new size when the pool grows.
+ */
+typedef struct VertexPool
+{
+    offset_allocator_t allocator;
+    /// The host copy of the buffer contents which the GPU buffer is updated from.
+    arena_dyn_array_t data;
+    uint32_t element_size;
+    uint32_t page_size;
+    /// The end of the furthest range which has been allocated - only this much of the pool needs
+    /// uploading when the GPU buffer is recreated.
+    uint32_t used_extent;
+
+    /// The ranges modified since the last upload, in offset order and never overlapping.
+    rpe_vertex_dirty_range_t dirty_ranges[RPE_VERTEX_POOL_MAX_DIRTY_RANGES];
+    uint32_t dirty_count;
+
+    /// Freed ranges which may still be read by frames in flight - these are returned to the
+    /// allocator once the frame they were freed on has completed.
+    arena_dyn_array_t pending_frees;
+
+    buffer_handle_t buffer;
+    /// The size of the GPU buffer (as a count of elements).
+    uint32_t buffer_capacity;
+} rpe_vertex_pool_t;
+
 typedef struct VertexBuffer
 {
-    // Size of vertex and index buffers (as a count of elements).
-    uint32_t curr_vertex_size;
-    uint32_t curr_index_size;
+    rpe_vertex_pool_t pools[RPE_VERTEX_POOL_COUNT];
+} rpe_vertex_buffer_t;
 
-    // GPU buffers - uploaded to via a staging buffer.
-    buffer_handle_t vertex_buffer;
-    buffer_handle_t index_buffer;
+void rpe_vertex_pool_init(
+    rpe_vertex_pool_t* p, uint32_t element_size, uint32_t page_size, arena_t* arena);
 
-    // Host vertex and indices data.
-    rpe_vertex_t* vertex_data;
-    uint32_t* index_data;
+/**
+ Allocate a range from the pool. If there is no free range large enough, the pool is grown by
+ whole pages - at least doubling in size.
+ @param p A pointer to the pool.
+ @param count The number of elements to allocate.
+ @returns The allocated range.
+ */
+rpe_vertex_alloc_info_t rpe_vertex_pool_alloc(rpe_vertex_pool_t* p, uint32_t count);
+
+/**
+ Free an allocated range. The range isn't available for reuse until @sa rpe_vertex_pool_gc is
+ called once all frames which may be reading from it have completed.
+ @param p A pointer to the pool.
+ @param info The allocated range - invalidated on return.
+ @param current_frame The frame which is currently being recorded.
+ */
+void rpe_vertex_pool_free(
+    rpe_vertex_pool_t* p, rpe_vertex_alloc_info_t* info, uint64_t current_frame);
 
-    // Any changes to the buffer are signalled by this flag - will lead to a GPU upload.
-    bool is_dirty;
+/**
+ Return the freed ranges which are no longer in use by the GPU to the allocator.
+ */
+void rpe_vertex_pool_gc(rpe_vertex_pool_t* p, uint64_t current_frame);
+
+/**
+ Copy elements into the host copy of an allocated range and mark them for upload.
+ @param p A pointer to the pool.
+ @param info The allocated range to copy into.
+ @param data The elements to copy.
+ @param count The number of elements to copy. Must be no greater than the allocated size.
+ */
+void rpe_vertex_pool_write(
+    rpe_vertex_pool_t* p, rpe_vertex_alloc_info_t* info, const void* data, uint32_t count);
 
-} rpe_vertex_buffer_t;
+/**
+ Mark the elements [start, end) as requiring an upload.
+ */
+void rpe_vertex_pool_mark_dirty(rpe_vertex_pool_t* p, uint32_t start, uint32_t end);
 
 rpe_vertex_buffer_t* rpe_vertex_buffer_init(vkapi_driver_t* driver, arena_t* arena);
 
-void rpe_vertex_buffer_copy_vert_data(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, rpe_vertex_t* data);
+enum VertexPoolType rpe_vertex_buffer_index_pool(enum IndicesType type);
 
-void rpe_vertex_buffer_copy_index_data_u32(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, const int32_t* data);
+rpe_vertex_alloc_info_t
+rpe_vertex_buffer_alloc(rpe_vertex_buffer_t* vb, enum VertexPoolType pool, uint32_t count);
 
-void rpe_vertex_buffer_copy_index_data_u16(
-    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t alloc_info, const int16_t* data);
+void rpe_vertex_buffer_free(
+    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t* info, uint64_t current_frame);
 
-rpe_vertex_alloc_info_t rpe_vertex_buffer_alloc_vertex_buffer(rpe_vertex_buffer_t* vb, size_t size);
-
-rpe_vertex_alloc_info_t rpe_vertex_buffer_alloc_index_buffer(rpe_vertex_buffer_t* vb, size_t size);
+void rpe_vertex_buffer_copy_data(
+    rpe_vertex_buffer_t* vb, rpe_vertex_alloc_info_t* info, const void* data, uint32_t count);
 
+/**
+ Upload all modified ranges to the GPU, recreating the buffer of any pool which has grown. This
+ must be called before any commands referencing the buffers are recorded, as the buffer handles
+ may change. Freed ranges which are no longer in use are also made available for reuse.
+ */
 void rpe_vertex_buffer_upload_to_gpu(rpe_vertex_buffer_t* vb, vkapi_driver_t* driver);
 
-#endif
\ No newline at end of file
+#endif
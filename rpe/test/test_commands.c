@@ -1,8 +1,13 @@
 #include "vk_setup.h"
 
 #include <commands.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <unity_fixture.h>
+#include <utility/arena.h>
+#include <utility/compiler.h>
+#include <utility/job_queue.h>
+#include <utility/parallel_for.h>
 
 int bucket_test_val1 = 0;
 
@@ -38,20 +43,20 @@ void testBucketFunc2(vkapi_driver_t* driver, void* data)
 TEST(CommandsGroup, BasicCommands_Test)
 {
     arena_t* arena = setup_arena(1 << 20);
-    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(10, arena);
+    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(1 << 18, NULL, arena);
     TEST_ASSERT_NOT_NULL(bucket);
     rpe_cmd_packet_t* pkt0 = rpe_command_bucket_add_command(
-        bucket, 0, sizeof(struct BucketTestCommand1), arena, testBucketFunc1);
+        bucket, 0, 0, sizeof(struct BucketTestCommand1), testBucketFunc1);
     struct BucketTestCommand1* cmd = pkt0->cmds;
     cmd->add_val = 5;
 
     rpe_cmd_packet_t* pkt1 = rpe_command_bucket_append_command(
-        bucket, pkt0, 0, sizeof(struct BucketTestCommand1), arena, testBucketFunc1);
+        bucket, pkt0, 0, sizeof(struct BucketTestCommand1), testBucketFunc1);
     struct BucketTestCommand1* cmd1 = pkt1->cmds;
     cmd1->add_val = 10;
 
     rpe_cmd_packet_t* pkt2 = rpe_command_bucket_append_command(
-        bucket, pkt1, sizeof(int), sizeof(struct BucketTestCommand2), arena, testBucketFunc2);
+        bucket, pkt1, sizeof(int), sizeof(struct BucketTestCommand2), testBucketFunc2);
     struct BucketTestCommand2* cmd2 = pkt2->cmds;
     cmd2->data = pkt2->data;
     int val = 2;
@@ -60,4 +65,304 @@ TEST(CommandsGroup, BasicCommands_Test)
     rpe_command_bucket_submit(bucket, NULL);
 
     TEST_ASSERT_EQUAL_UINT(30, bucket_test_val1);
-}
\ No newline at end of file
+
+    arena_release(arena);
+    free(arena);
+}
+
+#define MOCK_MAX_PACKET_COUNT 8192
+
+// A command buffer recorded by the mock recorder - the ids of the packets dispatched into it.
+struct MockCmdBuffer
+{
+    uint32_t ids[MOCK_MAX_PACKET_COUNT];
+    uint32_t count;
+};
+
+struct MockRecorder
+{
+    struct MockCmdBuffer cmd_buffers[RPE_CMD_BUCKET_MAX_RANGE_COUNT];
+    atomic_uint begin_count;
+    atomic_uint end_count;
+    uint32_t execute_count;
+    // The packet ids in the order the command buffers were executed.
+    uint32_t executed_ids[MOCK_MAX_PACKET_COUNT];
+    uint32_t executed_id_count;
+    uint32_t executed_cmd_count;
+};
+
+struct MockPacketCommand
+{
+    uint32_t id;
+};
+
+static RPE_THREAD_LOCAL struct MockCmdBuffer* tls_mock_cmds = NULL;
+static atomic_uint mock_unrecorded_count;
+
+void mock_dispatch(vkapi_driver_t* driver, void* data)
+{
+    struct MockPacketCommand* cmd = (struct MockPacketCommand*)data;
+    if (!tls_mock_cmds)
+    {
+        atomic_fetch_add(&mock_unrecorded_count, 1);
+        return;
+    }
+    tls_mock_cmds->ids[tls_mock_cmds->count++] = cmd->id;
+}
+
+VkCommandBuffer mock_begin(vkapi_driver_t* driver, uint32_t worker_idx, void* data)
+{
+    struct MockRecorder* r = (struct MockRecorder*)data;
+    uint32_t idx = atomic_fetch_add(&r->begin_count, 1);
+    struct MockCmdBuffer* cmds = &r->cmd_buffers[idx];
+    cmds->count = 0;
+    tls_mock_cmds = cmds;
+    return (VkCommandBuffer)cmds;
+}
+
+void mock_end(vkapi_driver_t* driver, VkCommandBuffer cmds, void* data)
+{
+    struct MockRecorder* r = (struct MockRecorder*)data;
+    if (tls_mock_cmds == (struct MockCmdBuffer*)cmds)
+    {
+        atomic_fetch_add(&r->end_count, 1);
+    }
+    tls_mock_cmds = NULL;
+}
+
+void mock_execute(vkapi_driver_t* driver, VkCommandBuffer* cmds, uint32_t count, void* data)
+{
+    struct MockRecorder* r = (struct MockRecorder*)data;
+    r->execute_count++;
+    r->executed_cmd_count += count;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        struct MockCmdBuffer* c = (struct MockCmdBuffer*)cmds[i];
+        memcpy(r->executed_ids + r->executed_id_count, c->ids, c->count * sizeof(uint32_t));
+        r->executed_id_count += c->count;
+    }
+}
+
+// Appended to @p prev if not NULL, otherwise added as a top-level packet with @p key.
+static rpe_cmd_packet_t*
+add_mock_packet(rpe_cmd_bucket_t* bucket, rpe_cmd_packet_t* prev, uint64_t key, uint32_t id)
+{
+    size_t size = sizeof(struct MockPacketCommand);
+    rpe_cmd_packet_t* pkt = NULL;
+    if (prev)
+    {
+        pkt = rpe_command_bucket_append_command(bucket, prev, 0, size, mock_dispatch);
+    }
+    else
+    {
+        pkt = rpe_command_bucket_add_command(bucket, key, 0, size, mock_dispatch);
+    }
+    ((struct MockPacketCommand*)pkt->cmds)->id = id;
+    return pkt;
+}
+
+// Each top-level packet has between zero and two packets appended to it. Returns the total number
+// of packets.
+static uint32_t add_mock_packets(rpe_cmd_bucket_t* bucket, uint32_t count)
+{
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rpe_cmd_packet_t* pkt = add_mock_packet(bucket, NULL, i, id++);
+        for (uint32_t j = 0; j < i % 3; ++j)
+        {
+            pkt = add_mock_packet(bucket, pkt, 0, id++);
+        }
+    }
+    return id;
+}
+
+// Submits the bucket on the calling thread, returning the ids in the order they were dispatched.
+static struct MockCmdBuffer* submit_mock_packets(rpe_cmd_bucket_t* bucket, arena_t* arena)
+{
+    struct MockCmdBuffer* cmds = ARENA_MAKE_ZERO_STRUCT(arena, struct MockCmdBuffer);
+    tls_mock_cmds = cmds;
+    rpe_command_bucket_submit(bucket, NULL);
+    tls_mock_cmds = NULL;
+    return cmds;
+}
+
+TEST(CommandsGroup, BucketSort_Test)
+{
+    arena_t* arena = setup_arena(1 << 22);
+    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(1 << 20, NULL, arena);
+
+    // Packets are submitted in key order, with appended packets following their parent. Packets
+    // with the same key keep the order they were added in.
+    uint64_t keys[] = {UINT64_MAX, 5, 0x100000000, 5, 0};
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        rpe_cmd_packet_t* pkt = add_mock_packet(bucket, NULL, keys[i], i * 10);
+        add_mock_packet(bucket, pkt, 0, i * 10 + 1);
+    }
+    struct MockCmdBuffer* cmds = submit_mock_packets(bucket, arena);
+    uint32_t expected[] = {40, 41, 10, 11, 30, 31, 20, 21, 0, 1};
+    TEST_ASSERT_EQUAL_UINT(10, cmds->count);
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(expected[i], cmds->ids[i]);
+    }
+
+    // The bucket is no longer limited to a fixed number of packets.
+    rpe_command_bucket_reset(bucket);
+    TEST_ASSERT_EQUAL_UINT(0, submit_mock_packets(bucket, arena)->count);
+    for (uint32_t i = 0; i < MOCK_MAX_PACKET_COUNT; ++i)
+    {
+        add_mock_packet(bucket, NULL, MOCK_MAX_PACKET_COUNT - i - 1, i);
+    }
+    cmds = submit_mock_packets(bucket, arena);
+    TEST_ASSERT_EQUAL_UINT(MOCK_MAX_PACKET_COUNT, cmds->count);
+    for (uint32_t i = 0; i < MOCK_MAX_PACKET_COUNT; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(MOCK_MAX_PACKET_COUNT - i - 1, cmds->ids[i]);
+    }
+
+    arena_release(arena);
+    free(arena);
+}
+
+void mock_write_packets(uint32_t start, uint32_t count, void* data)
+{
+    rpe_cmd_bucket_t* bucket = (rpe_cmd_bucket_t*)data;
+    for (uint32_t i = start; i < start + count; ++i)
+    {
+        rpe_cmd_packet_t* pkt = add_mock_packet(bucket, NULL, i, i * 2);
+        add_mock_packet(bucket, pkt, 0, i * 2 + 1);
+    }
+}
+
+TEST(CommandsGroup, BucketMtWrite_Test)
+{
+    arena_t* arena = setup_arena(1 << 25);
+    job_queue_t* jq = job_queue_init(arena, 4);
+    job_queue_adopt_thread(jq);
+
+    // Each worker writes to its own stream, and the streams are merged in key order.
+    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(1 << 22, jq, arena);
+    uint32_t count = MOCK_MAX_PACKET_COUNT / 2;
+    for (uint32_t iter = 0; iter < 2; ++iter)
+    {
+        struct ChunkConfig cfg = {.min_chunk_size = 64};
+        job_t* job =
+            parallel_for_chunked(jq, NULL, 0, count, mock_write_packets, bucket, &cfg, arena);
+        job_queue_run_and_wait(jq, job);
+
+        uint32_t stream_total = 0;
+        for (uint32_t i = 0; i < RPE_CMD_BUCKET_MAX_STREAM_COUNT; ++i)
+        {
+            stream_total += bucket->streams[i].count;
+        }
+        TEST_ASSERT_EQUAL_UINT(count, stream_total);
+
+        struct MockCmdBuffer* cmds = submit_mock_packets(bucket, arena);
+        TEST_ASSERT_EQUAL_UINT(count * 2, cmds->count);
+        for (uint32_t i = 0; i < count * 2; ++i)
+        {
+            TEST_ASSERT_EQUAL_UINT(i, cmds->ids[i]);
+        }
+        rpe_command_bucket_reset(bucket);
+    }
+
+    job_queue_destroy(jq);
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(CommandsGroup, BucketSplit_Test)
+{
+    arena_t* arena = setup_arena(1 << 20);
+    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(1 << 18, NULL, arena);
+    rpe_cmd_range_t ranges[8];
+
+    rpe_command_bucket_sort(bucket);
+    TEST_ASSERT_EQUAL_UINT(0, rpe_command_bucket_split(bucket, 8, 1, ranges));
+
+    add_mock_packets(bucket, 100);
+    rpe_command_bucket_sort(bucket);
+
+    // Limited by the minimum range size - the remainder is spread over the first ranges.
+    uint32_t count = rpe_command_bucket_split(bucket, 8, 32, ranges);
+    TEST_ASSERT_EQUAL_UINT(3, count);
+    TEST_ASSERT_EQUAL_UINT(0, ranges[0].start);
+    TEST_ASSERT_EQUAL_UINT(34, ranges[0].end);
+    TEST_ASSERT_EQUAL_UINT(34, ranges[1].start);
+    TEST_ASSERT_EQUAL_UINT(67, ranges[1].end);
+    TEST_ASSERT_EQUAL_UINT(67, ranges[2].start);
+    TEST_ASSERT_EQUAL_UINT(100, ranges[2].end);
+
+    // Limited by the range count.
+    count = rpe_command_bucket_split(bucket, 8, 1, ranges);
+    TEST_ASSERT_EQUAL_UINT(8, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t size = ranges[i].end - ranges[i].start;
+        TEST_ASSERT(size == 12 || size == 13);
+        TEST_ASSERT_EQUAL_UINT(i == 0 ? 0 : ranges[i - 1].end, ranges[i].start);
+    }
+    TEST_ASSERT_EQUAL_UINT(100, ranges[7].end);
+
+    // Too few packets to split.
+    count = rpe_command_bucket_split(bucket, 8, 200, ranges);
+    TEST_ASSERT_EQUAL_UINT(1, count);
+    TEST_ASSERT_EQUAL_UINT(0, ranges[0].start);
+    TEST_ASSERT_EQUAL_UINT(100, ranges[0].end);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(CommandsGroup, BucketSubmitMt_Test)
+{
+    arena_t* arena = setup_arena(1 << 25);
+    job_queue_t* jq = job_queue_init(arena, 4);
+    job_queue_adopt_thread(jq);
+
+    struct MockRecorder* r = ARENA_MAKE_ZERO_STRUCT(arena, struct MockRecorder);
+    rpe_cmd_recorder_t rec = {
+        .begin = mock_begin, .end = mock_end, .execute = mock_execute, .user_data = r};
+    atomic_store(&mock_unrecorded_count, 0);
+
+    rpe_cmd_bucket_t* bucket = rpe_command_bucket_init(1 << 20, jq, arena);
+    uint32_t packet_count = add_mock_packets(bucket, 1000);
+    rpe_command_bucket_submit_mt(bucket, NULL, jq, &rec, arena);
+
+    // Each range is recorded into its own command buffer, and the command buffers are executed
+    // in bucket order, so the packets are executed in the same order as a serial submit.
+    TEST_ASSERT_EQUAL_UINT(0, atomic_load(&mock_unrecorded_count));
+    TEST_ASSERT_EQUAL_UINT(1, r->execute_count);
+    TEST_ASSERT(r->executed_cmd_count > 1);
+    TEST_ASSERT_EQUAL_UINT(r->executed_cmd_count, atomic_load(&r->begin_count));
+    TEST_ASSERT_EQUAL_UINT(r->executed_cmd_count, atomic_load(&r->end_count));
+    TEST_ASSERT_EQUAL_UINT(packet_count, r->executed_id_count);
+    for (uint32_t i = 0; i < packet_count; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(i, r->executed_ids[i]);
+    }
+
+    // A small bucket is recorded into a single command buffer.
+    memset(r, 0, sizeof(struct MockRecorder));
+    rpe_command_bucket_reset(bucket);
+    packet_count = add_mock_packets(bucket, RPE_CMD_BUCKET_MIN_PACKETS_PER_RANGE - 1);
+    rpe_command_bucket_submit_mt(bucket, NULL, jq, &rec, arena);
+    TEST_ASSERT_EQUAL_UINT(1, r->executed_cmd_count);
+    TEST_ASSERT_EQUAL_UINT(packet_count, r->executed_id_count);
+    for (uint32_t i = 0; i < packet_count; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(i, r->executed_ids[i]);
+    }
+
+    // Nothing is executed for an empty bucket.
+    memset(r, 0, sizeof(struct MockRecorder));
+    rpe_command_bucket_reset(bucket);
+    rpe_command_bucket_submit_mt(bucket, NULL, jq, &rec, arena);
+    TEST_ASSERT_EQUAL_UINT(0, r->execute_count);
+
+    job_queue_destroy(jq);
+    arena_release(arena);
+    free(arena);
+}
@@ -0,0 +1,141 @@
+#include "vk_setup.h"
+
+#include <render_graph/dependency_graph.h>
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <utility/random.h>
+
+#define TEST_DEP_GRAPH_NODE_COUNT 500
+
+TEST_GROUP(DependencyGraphGroup);
+
+TEST_SETUP(DependencyGraphGroup) {}
+
+TEST_TEAR_DOWN(DependencyGraphGroup) {}
+
+// The culling as it was before the adjacency lists - the readers of each culled node are found by
+// scanning all edges.
+static void reference_cull(rg_dep_graph_t* dg, int* ref_counts)
+{
+    for (size_t i = 0; i < dg->edges.size; ++i)
+    {
+        rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
+        ref_counts[edge->from_id]++;
+    }
+
+    uint32_t cull_list[TEST_DEP_GRAPH_NODE_COUNT];
+    uint32_t cull_count = 0;
+    for (uint32_t i = 0; i < dg->nodes.size; ++i)
+    {
+        if (!ref_counts[i])
+        {
+            cull_list[cull_count++] = i;
+        }
+    }
+
+    while (cull_count > 0)
+    {
+        uint32_t id = cull_list[--cull_count];
+        for (size_t i = 0; i < dg->edges.size; ++i)
+        {
+            rg_edge_t* edge = DYN_ARRAY_GET(rg_edge_t*, &dg->edges, i);
+            if (edge->to_id == id && --ref_counts[edge->from_id] == 0)
+            {
+                cull_list[cull_count++] = (uint32_t)edge->from_id;
+            }
+        }
+    }
+}
+
+TEST(DependencyGraphGroup, DepGraph_AdjacencyTests)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rg_dep_graph_t* dg = rg_dep_graph_init(arena);
+    rg_node_t* n1 = rg_node_init(dg, INTERN_LITERAL("node1"), arena);
+    rg_node_t* n2 = rg_node_init(dg, INTERN_LITERAL("node2"), arena);
+    rg_node_t* n3 = rg_node_init(dg, INTERN_LITERAL("node3"), arena);
+    rg_edge_t* e1 = rg_edge_init(dg, n1, n2, arena);
+    rg_edge_t* e2 = rg_edge_init(dg, n1, n3, arena);
+    rg_edge_t* e3 = rg_edge_init(dg, n2, n3, arena);
+
+    rg_edge_iter_t it = rg_dep_graph_get_writer_edges(dg, n1);
+    TEST_ASSERT_EQUAL_UINT(2, it.count);
+    TEST_ASSERT_EQUAL_PTR(e1, rg_edge_iter_next(&it));
+    TEST_ASSERT_EQUAL_PTR(e2, rg_edge_iter_next(&it));
+    TEST_ASSERT_NULL(rg_edge_iter_next(&it));
+
+    it = rg_dep_graph_get_reader_edges(dg, n3);
+    TEST_ASSERT_EQUAL_UINT(2, it.count);
+    TEST_ASSERT_EQUAL_PTR(e2, rg_edge_iter_next(&it));
+    TEST_ASSERT_EQUAL_PTR(e3, rg_edge_iter_next(&it));
+    TEST_ASSERT_EQUAL_UINT(0, rg_dep_graph_get_reader_edges(dg, n1).count);
+    TEST_ASSERT_EQUAL_UINT(0, rg_dep_graph_get_writer_edges(dg, n3).count);
+
+    // Adding to the graph rebuilds the lists on the next query.
+    rg_node_t* n4 = rg_node_init(dg, INTERN_LITERAL("node4"), arena);
+    rg_edge_t* e4 = rg_edge_init(dg, n4, n1, arena);
+    TEST_ASSERT_TRUE(dg->adjacency_dirty);
+    it = rg_dep_graph_get_reader_edges(dg, n1);
+    TEST_ASSERT_EQUAL_UINT(1, it.count);
+    TEST_ASSERT_EQUAL_PTR(e4, rg_edge_iter_next(&it));
+    TEST_ASSERT_FALSE(dg->adjacency_dirty);
+
+    // The lists are rebuilt from the start after clearing.
+    rg_dep_graph_clear(dg);
+    n1 = rg_node_init(dg, INTERN_LITERAL("node1"), arena);
+    TEST_ASSERT_EQUAL_UINT(0, rg_dep_graph_get_writer_edges(dg, n1).count);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(DependencyGraphGroup, DepGraph_CullMatchesReferenceTests)
+{
+    arena_t* arena = setup_arena(1 << 22);
+    xoro_rand_t r = xoro_rand_init(0xff, 0x1234);
+
+    for (uint32_t run = 0; run < 5; ++run)
+    {
+        rg_dep_graph_t* dg = rg_dep_graph_init(arena);
+        int ref_counts[TEST_DEP_GRAPH_NODE_COUNT] = {0};
+        for (uint32_t i = 0; i < TEST_DEP_GRAPH_NODE_COUNT; ++i)
+        {
+            rg_node_t* n = rg_node_init(dg, INTERN_LITERAL("node"), arena);
+            // A few side effects, as with the imported resources and present pass.
+            if (xoro_rand_next(&r) % 20 == 0)
+            {
+                rg_node_declare_side_effect(n);
+                ref_counts[i] = n->ref_count;
+            }
+        }
+
+        // Edges only go from earlier to later nodes, as passes and resources are added in order.
+        for (uint32_t i = 0; i < TEST_DEP_GRAPH_NODE_COUNT - 1; ++i)
+        {
+            uint32_t edge_count = (uint32_t)(xoro_rand_next(&r) % 4);
+            for (uint32_t j = 0; j < edge_count; ++j)
+            {
+                uint32_t to = i + 1 + (uint32_t)(xoro_rand_next(&r) % 8);
+                to = to < TEST_DEP_GRAPH_NODE_COUNT ? to : TEST_DEP_GRAPH_NODE_COUNT - 1;
+                rg_edge_init(
+                    dg, rg_dep_graph_get_node(dg, i), rg_dep_graph_get_node(dg, to), arena);
+            }
+        }
+
+        reference_cull(dg, ref_counts);
+        rg_dep_graph_cull(dg);
+
+        uint32_t culled_count = 0;
+        for (uint32_t i = 0; i < TEST_DEP_GRAPH_NODE_COUNT; ++i)
+        {
+            rg_node_t* n = rg_dep_graph_get_node(dg, i);
+            TEST_ASSERT_EQUAL_INT(ref_counts[i], n->ref_count);
+            culled_count += rg_node_is_culled(n);
+        }
+        TEST_ASSERT(culled_count > 0 && culled_count < TEST_DEP_GRAPH_NODE_COUNT);
+    }
+
+    arena_release(arena);
+    free(arena);
+}
@@ -0,0 +1,162 @@
+#include <frustum.h>
+#include <unity_fixture.h>
+#include <utility/maths.h>
+#include <utility/random.h>
+
+#include <stdlib.h>
+
+#define TEST_FRUSTUM_BOX_COUNT 1001
+
+TEST_GROUP(FrustumGroup);
+
+TEST_SETUP(FrustumGroup) {}
+
+TEST_TEAR_DOWN(FrustumGroup) {}
+
+static float rand_range(xoro_rand_t* r, float min, float max)
+{
+    float t = (float)(xoro_rand_next(r) >> 40) / (float)(1 << 24);
+    return min + t * (max - min);
+}
+
+// A camera at z = 5 looking down the negative z axis.
+static math_mat4f camera_view_proj()
+{
+    math_mat4f proj = math_mat4f_perspective(90.0f, 1.0f, 0.1f, 100.0f);
+    math_mat4f view = math_mat4f_lookat(
+        math_vec3f_init(0.0f, 0.0f, 0.0f),
+        math_vec3f_init(0.0f, 0.0f, 5.0f),
+        math_vec3f_init(0.0f, 1.0f, 0.0f));
+    return math_mat4f_mul(proj, view);
+}
+
+TEST(FrustumGroup, Frustum_CameraTests)
+{
+    math_mat4f vp = camera_view_proj();
+    rpe_frustum_t frustum = {0};
+    rpe_frustum_projection(&frustum, &vp);
+
+    math_vec3f centers[6] = {
+        // In front of the camera.
+        {0.0f, 0.0f, -50.0f},
+        // Straddling the near plane.
+        {0.0f, 0.0f, 4.95f},
+        // Straddling the far plane.
+        {0.0f, 0.0f, -95.0f},
+        // Behind the camera.
+        {0.0f, 0.0f, 10.0f},
+        // Beyond the far plane.
+        {0.0f, 0.0f, -200.0f},
+        // In front of the camera, but to the side of the view.
+        {30.0f, 0.0f, -45.0f}};
+    math_vec3f extents[6];
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        extents[i] = math_vec3f_init(0.5f, 0.5f, 0.5f);
+    }
+    uint8_t expected[6] = {1, 1, 1, 0, 0, 0};
+
+    uint8_t results[6];
+    rpe_frustum_check_intersection(&frustum, centers, extents, 6, results);
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(expected[i], results[i]);
+    }
+
+    TEST_ASSERT_TRUE(rpe_frustum_check_sphere_intersect(&frustum, &centers[0], 0.5f));
+    TEST_ASSERT_FALSE(rpe_frustum_check_sphere_intersect(&frustum, &centers[3], 0.5f));
+}
+
+TEST(FrustumGroup, Frustum_CullBoxesTests)
+{
+    math_mat4f vp = camera_view_proj();
+    rpe_frustum_t frustum = {0};
+    rpe_frustum_projection(&frustum, &vp);
+
+    xoro_rand_t r = xoro_rand_init(0xff, 0x1234);
+    math_vec3f centers[TEST_FRUSTUM_BOX_COUNT];
+    math_vec3f extents[TEST_FRUSTUM_BOX_COUNT];
+    float soa[6][TEST_FRUSTUM_BOX_COUNT];
+    for (uint32_t i = 0; i < TEST_FRUSTUM_BOX_COUNT; ++i)
+    {
+        centers[i] = math_vec3f_init(
+            rand_range(&r, -120.0f, 120.0f),
+            rand_range(&r, -120.0f, 120.0f),
+            rand_range(&r, -120.0f, 20.0f));
+        extents[i] = math_vec3f_init(
+            rand_range(&r, 0.0f, 5.0f), rand_range(&r, 0.0f, 5.0f), rand_range(&r, 0.0f, 5.0f));
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            soa[j][i] = centers[i].data[j];
+            soa[j + 3][i] = extents[i].data[j];
+        }
+    }
+    rpe_frustum_boxes_t boxes = {
+        .center_x = soa[0],
+        .center_y = soa[1],
+        .center_z = soa[2],
+        .extent_x = soa[3],
+        .extent_y = soa[4],
+        .extent_z = soa[5]};
+
+    uint8_t expected[TEST_FRUSTUM_BOX_COUNT];
+    rpe_frustum_check_intersection(&frustum, centers, extents, TEST_FRUSTUM_BOX_COUNT, expected);
+
+    // Start part way in so that the vector loads are unaligned, with a scalar remainder.
+    uint32_t start = 3;
+    uint32_t count = TEST_FRUSTUM_BOX_COUNT - start;
+    uint8_t results[TEST_FRUSTUM_BOX_COUNT];
+    rpe_frustum_cull_boxes(&frustum, &boxes, start, count, results);
+
+    uint32_t expected_count = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT(expected[start + i], results[i]);
+        expected_count += expected[start + i];
+    }
+    // Ensure the test covers both outcomes.
+    TEST_ASSERT(expected_count > 0 && expected_count < count);
+
+    uint32_t visible[TEST_FRUSTUM_BOX_COUNT];
+    size_t visible_count = rpe_frustum_compact_visible(results, count, start, visible);
+    TEST_ASSERT_EQUAL_UINT(expected_count, visible_count);
+    uint32_t idx = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (results[i])
+        {
+            TEST_ASSERT_EQUAL_UINT(start + i, visible[idx++]);
+        }
+    }
+}
+
+TEST(FrustumGroup, Frustum_SphereTests)
+{
+    math_mat4f vp = camera_view_proj();
+    rpe_frustum_t frustum = {0};
+    rpe_frustum_projection(&frustum, &vp);
+
+    math_vec3f center = math_vec3f_init(0.0f, 0.0f, -5.0f);
+    TEST_ASSERT_TRUE(rpe_frustum_check_sphere_intersect(&frustum, &center, 1.0f));
+    center = math_vec3f_init(200.0f, 0.0f, -5.0f);
+    TEST_ASSERT_FALSE(rpe_frustum_check_sphere_intersect(&frustum, &center, 1.0f));
+    // The center is outside of a side plane, but the radius overlaps it.
+    center = math_vec3f_init(6.0f, 0.0f, -5.0f);
+    TEST_ASSERT_FALSE(rpe_frustum_check_sphere_intersect(&frustum, &center, 1.0f));
+    TEST_ASSERT_TRUE(rpe_frustum_check_sphere_intersect(&frustum, &center, 5.0f));
+
+    // A point agrees with a box of zero extent.
+    xoro_rand_t r = xoro_rand_init(0xff, 0x1234);
+    math_vec3f zero = math_vec3f_init(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        center = math_vec3f_init(
+            rand_range(&r, -120.0f, 120.0f),
+            rand_range(&r, -120.0f, 120.0f),
+            rand_range(&r, -120.0f, 20.0f));
+        uint8_t box_result = 0;
+        rpe_frustum_check_intersection(&frustum, &center, &zero, 1, &box_result);
+        bool sphere_result = rpe_frustum_check_sphere_intersect(&frustum, &center, 0.0f);
+        TEST_ASSERT_EQUAL_UINT(box_result, sphere_result);
+    }
+}
@@ -14,6 +14,54 @@ TEST_GROUP_RUNNER(RenderGraphGroup)
 TEST_GROUP_RUNNER(CommandsGroup)
 {
     RUN_TEST_CASE(CommandsGroup, BasicCommands_Test)
+    RUN_TEST_CASE(CommandsGroup, BucketSort_Test)
+    RUN_TEST_CASE(CommandsGroup, BucketMtWrite_Test)
+    RUN_TEST_CASE(CommandsGroup, BucketSplit_Test)
+    RUN_TEST_CASE(CommandsGroup, BucketSubmitMt_Test)
+}
+
+TEST_GROUP_RUNNER(TransientPoolGroup)
+{
+    RUN_TEST_CASE(TransientPoolGroup, PackIntervals_NoOverlap)
+    RUN_TEST_CASE(TransientPoolGroup, PackIntervals_AllOverlap)
+    RUN_TEST_CASE(TransientPoolGroup, PackIntervals_Mixed)
+    RUN_TEST_CASE(TransientPoolGroup, AliasSrcUsage)
+}
+
+TEST_GROUP_RUNNER(RenderableSortGroup)
+{
+    RUN_TEST_CASE(RenderableSortGroup, SortAndBatch_Test)
+}
+
+TEST_GROUP_RUNNER(VertexBufferGroup)
+{
+    RUN_TEST_CASE(VertexBufferGroup, VertexPool_AllocTests)
+    RUN_TEST_CASE(VertexBufferGroup, VertexPool_DirtyRangeTests)
+}
+
+TEST_GROUP_RUNNER(TransformHierarchyGroup)
+{
+    RUN_TEST_CASE(TransformHierarchyGroup, TransformHierarchy_UpdateTests)
+    RUN_TEST_CASE(TransformHierarchyGroup, TransformHierarchy_ReparentTests)
+}
+
+TEST_GROUP_RUNNER(FrustumGroup)
+{
+    RUN_TEST_CASE(FrustumGroup, Frustum_CameraTests)
+    RUN_TEST_CASE(FrustumGroup, Frustum_CullBoxesTests)
+    RUN_TEST_CASE(FrustumGroup, Frustum_SphereTests)
+}
+
+TEST_GROUP_RUNNER(DependencyGraphGroup)
+{
+    RUN_TEST_CASE(DependencyGraphGroup, DepGraph_AdjacencyTests)
+    RUN_TEST_CASE(DependencyGraphGroup, DepGraph_CullMatchesReferenceTests)
+}
+
+TEST_GROUP_RUNNER(RenderGraphCacheGroup)
+{
+    RUN_TEST_CASE(RenderGraphCacheGroup, RenderGraphCache_SkipTests)
+    RUN_TEST_CASE(RenderGraphCacheGroup, RenderGraphCache_InvalidateTests)
 }
 
 TEST_GROUP_RUNNER(VisibilityGroup)
@@ -35,6 +83,13 @@ TEST_GROUP_RUNNER(EngineGroup)
 static void run_all_tests(void)
 {
     RUN_TEST_GROUP(CommandsGroup)
+    RUN_TEST_GROUP(TransientPoolGroup)
+    RUN_TEST_GROUP(RenderableSortGroup)
+    RUN_TEST_GROUP(VertexBufferGroup)
+    RUN_TEST_GROUP(TransformHierarchyGroup)
+    RUN_TEST_GROUP(FrustumGroup)
+    RUN_TEST_GROUP(DependencyGraphGroup)
+    RUN_TEST_GROUP(RenderGraphCacheGroup)
 #if RPE_BUILD_GPU_TESTS
     RUN_TEST_GROUP(RenderGraphGroup)
     RUN_TEST_GROUP(VisibilityGroup)
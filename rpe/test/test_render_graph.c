@@ -22,15 +22,15 @@ TEST(RenderGraphGroup, RenderGraph_DepGraph_Tests1)
     arena_t* arena = setup_arena(1 << 20);
 
     rg_dep_graph_t* dg = rg_dep_graph_init(arena);
-    rg_node_t* n1 = rg_node_init(dg, "node1", arena);
-    rg_node_t* n2 = rg_node_init(dg, "node2", arena);
-    rg_node_t* n3 = rg_node_init(dg, "node3", arena);
+    rg_node_t* n1 = rg_node_init(dg, INTERN_LITERAL("node1"), arena);
+    rg_node_t* n2 = rg_node_init(dg, INTERN_LITERAL("node2"), arena);
+    rg_node_t* n3 = rg_node_init(dg, INTERN_LITERAL("node3"), arena);
     rg_node_declare_side_effect(n3);
 
     rg_edge_init(dg, n1, n2, arena);
     rg_edge_init(dg, n2, n3, arena);
 
-    rg_dep_graph_cull(dg, arena);
+    rg_dep_graph_cull(dg);
 
     TEST_ASSERT_FALSE(rg_node_is_culled(n1));
     TEST_ASSERT_FALSE(rg_node_is_culled(n2));
@@ -46,14 +46,14 @@ TEST(RenderGraphGroup, RenderGraph_DepGraph_Tests2)
     arena_t* arena = setup_arena(1 << 20);
 
     rg_dep_graph_t* dg = rg_dep_graph_init(arena);
-    rg_node_t* n1 = rg_node_init(dg, "node1", arena);
-    rg_node_t* n2 = rg_node_init(dg, "node2", arena);
-    rg_node_t* n3 = rg_node_init(dg, "node3", arena);
-    rg_node_t* n4 = rg_node_init(dg, "node4", arena);
-    rg_node_t* n5 = rg_node_init(dg, "node5", arena);
-    rg_node_t* n6 = rg_node_init(dg, "node6", arena);
-    rg_node_t* n7 = rg_node_init(dg, "node7", arena);
-    rg_node_t* n8 = rg_node_init(dg, "node8", arena);
+    rg_node_t* n1 = rg_node_init(dg, INTERN_LITERAL("node1"), arena);
+    rg_node_t* n2 = rg_node_init(dg, INTERN_LITERAL("node2"), arena);
+    rg_node_t* n3 = rg_node_init(dg, INTERN_LITERAL("node3"), arena);
+    rg_node_t* n4 = rg_node_init(dg, INTERN_LITERAL("node4"), arena);
+    rg_node_t* n5 = rg_node_init(dg, INTERN_LITERAL("node5"), arena);
+    rg_node_t* n6 = rg_node_init(dg, INTERN_LITERAL("node6"), arena);
+    rg_node_t* n7 = rg_node_init(dg, INTERN_LITERAL("node7"), arena);
+    rg_node_t* n8 = rg_node_init(dg, INTERN_LITERAL("node8"), arena);
     rg_node_declare_side_effect(n6);
 
     rg_edge_init(dg, n1, n2, arena);
@@ -64,7 +64,7 @@ TEST(RenderGraphGroup, RenderGraph_DepGraph_Tests2)
     rg_edge_init(dg, n5, n6, arena);
     rg_edge_init(dg, n2, n8, arena);
 
-    rg_dep_graph_cull(dg, arena);
+    rg_dep_graph_cull(dg);
 
     TEST_ASSERT_FALSE(rg_node_is_culled(n1));
     TEST_ASSERT_TRUE(rg_node_is_culled(n2));
@@ -102,7 +102,7 @@ void setup1(render_graph_t* rg, rg_pass_node_t* node, void* data, void* local_da
         .layers = 1,
         .depth = 1};
     rg_texture_resource_t* r = rg_tex_resource_init(
-        "InputTex", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, desc, rg_get_arena(rg));
+        INTERN_LITERAL("InputTex"), VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, desc, rg_get_arena(rg));
     d->rw = rg_add_resource(rg, (rg_resource_t*)r, NULL);
     d->rw = rg_add_write(rg, d->rw, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
     // rg_add_read(rg, d->rw, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
@@ -115,7 +115,8 @@ TEST(RenderGraphGroup, RenderGraph_Tests1)
 
     render_graph_t* rg = rg_init(arena);
     rpe_engine_t* eng = NULL;
-    rg_pass_t* p = rg_add_pass(rg, "Pass1", setup1, NULL, sizeof(struct DataRW), NULL);
+    rg_pass_t* p = rg_add_pass(
+        rg, INTERN_LITERAL("Pass1"), setup1, NULL, sizeof(struct DataRW), NULL);
     TEST_ASSERT_TRUE(p);
     rg_compile(rg);
     TEST_ASSERT_TRUE(rg_node_is_culled((rg_node_t*)p->node));
@@ -142,13 +143,17 @@ void setup_basic(render_graph_t* rg, rg_pass_node_t* node, void* data, void* loc
         .layers = 1,
         .depth = 1};
     rg_texture_resource_t* r = rg_tex_resource_init(
-        "DepthImage", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg));
+        INTERN_LITERAL("DepthImage"),
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        t_desc,
+        rg_get_arena(rg));
     d->depth = rg_add_resource(rg, (rg_resource_t*)r, NULL);
     d->depth = rg_add_write(rg, d->depth, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 
     rg_pass_desc_t desc = rg_pass_desc_init();
     desc.attachments.attach.depth = d->depth;
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "DepthPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("DepthPass"), desc);
     rg_node_declare_side_effect((rg_node_t*)node);
 }
 
@@ -169,8 +174,8 @@ TEST(RenderGraphGroup, RenderGraph_TestsBasic)
     vkapi_driver_t* driver = setup_driver();
 
     render_graph_t* rg = rg_init(arena);
-    rg_pass_t* p =
-        rg_add_pass(rg, "Pass1", setup_basic, execute_basic, sizeof(struct DataBasic), NULL);
+    rg_pass_t* p = rg_add_pass(
+        rg, INTERN_LITERAL("Pass1"), setup_basic, execute_basic, sizeof(struct DataBasic), NULL);
     TEST_ASSERT_TRUE(p);
     rg_compile(rg);
     TEST_ASSERT_FALSE(rg_node_is_culled((rg_node_t*)p->node));
@@ -201,42 +206,57 @@ void setup_gbuffer_test(render_graph_t* rg, rg_pass_node_t* node, void* data, vo
     d->colour = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Colour", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Colour"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->pos = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Position", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Position"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->normal = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Normal", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Normal"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16_SFLOAT;
     d->pbr = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "PBR", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("PBR"), VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_R16G16B16A16_SFLOAT;
     d->emissive = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Emissive", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Emissive"),
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     t_desc.format = VK_FORMAT_D24_UNORM_S8_UINT;
     d->depth = rg_add_resource(
         rg,
         (rg_resource_t*)rg_tex_resource_init(
-            "Depth", VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, t_desc, rg_get_arena(rg)),
+            INTERN_LITERAL("Depth"),
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            t_desc,
+            rg_get_arena(rg)),
         NULL);
 
     d->colour = rg_add_write(rg, d->colour, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
@@ -256,17 +276,18 @@ void setup_gbuffer_test(render_graph_t* rg, rg_pass_node_t* node, void* data, vo
     desc.ds_load_clear_flags[0] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
     desc.ds_load_clear_flags[1] = RPE_BACKEND_RENDERPASS_LOAD_CLEAR_FLAG_CLEAR;
 
-    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, "GBufferPass", desc);
+    d->rt = rg_rpass_node_create_rt(
+        (rg_render_pass_node_t*)node, rg, INTERN_LITERAL("GBufferPass"), desc);
     rg_node_declare_side_effect(node);
 
     rg_backboard_t* bb = rg_get_backboard(rg);
 
-    rg_backboard_add(bb, "colour", d->colour);
-    rg_backboard_add(bb, "position", d->pos);
-    rg_backboard_add(bb, "normal", d->normal);
-    rg_backboard_add(bb, "emissive", d->emissive);
-    rg_backboard_add(bb, "pbr", d->pbr);
-    rg_backboard_add(bb, "gbufferDepth", d->depth);
+    rg_backboard_add(bb, INTERN_LITERAL("colour"), d->colour);
+    rg_backboard_add(bb, INTERN_LITERAL("position"), d->pos);
+    rg_backboard_add(bb, INTERN_LITERAL("normal"), d->normal);
+    rg_backboard_add(bb, INTERN_LITERAL("emissive"), d->emissive);
+    rg_backboard_add(bb, INTERN_LITERAL("pbr"), d->pbr);
+    rg_backboard_add(bb, INTERN_LITERAL("gbufferDepth"), d->depth);
 }
 
 void execute_gbuffer_test(
@@ -300,7 +321,12 @@ TEST(RenderGraphGroup, RenderGraph_TestsGBuffer)
     render_graph_t* rg = rg_init(arena);
     rpe_engine_t* eng = NULL;
     rg_pass_t* p = rg_add_pass(
-        rg, "Pass1", setup_gbuffer_test, execute_gbuffer_test, sizeof(struct DataGBuffer), NULL);
+        rg,
+        INTERN_LITERAL("Pass1"),
+        setup_gbuffer_test,
+        execute_gbuffer_test,
+        sizeof(struct DataGBuffer),
+        NULL);
     TEST_ASSERT_TRUE(p);
     rg_compile(rg);
     TEST_ASSERT_FALSE(rg_node_is_culled((rg_node_t*)p->node));
@@ -351,11 +377,17 @@ TEST(RenderGraphGroup, RenderGraph_TestsGBuffer_PresentPass)
 
     render_graph_t* rg = rg_init(arena);
     rg_pass_t* p = rg_add_pass(
-        rg, "Pass1", setup_gbuffer_test, execute_gbuffer_present, sizeof(struct DataGBuffer), NULL);
+        rg,
+        INTERN_LITERAL("Pass1"),
+        setup_gbuffer_test,
+        execute_gbuffer_present,
+        sizeof(struct DataGBuffer),
+        NULL);
     TEST_ASSERT_TRUE(p);
 
     struct DataGBuffer* d = (struct DataGBuffer*)p->data;
-    rg_handle_t backbuffer_handle = rg_import_render_target(rg, "BackBuffer", i_desc, pp_handle);
+    rg_handle_t backbuffer_handle = rg_import_render_target(
+        rg, INTERN_LITERAL("BackBuffer"), i_desc, pp_handle);
     rg_move_resource(rg, d->colour, backbuffer_handle);
     rg_add_present_pass(rg, backbuffer_handle);
 
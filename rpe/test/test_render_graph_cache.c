@@ -0,0 +1,194 @@
+#include "vk_setup.h"
+
+#include <render_graph/backboard.h>
+#include <render_graph/dependency_graph.h>
+#include <render_graph/render_graph.h>
+#include <render_graph/render_pass_node.h>
+#include <unity_fixture.h>
+#include <utility/arena.h>
+
+TEST_GROUP(RenderGraphCacheGroup);
+
+TEST_SETUP(RenderGraphCacheGroup) {}
+
+TEST_TEAR_DOWN(RenderGraphCacheGroup) {}
+
+struct CacheGraphDesc
+{
+    uint32_t width;
+    VkImageUsageFlags read_usage;
+    bool keep_unused;
+};
+
+struct CachePassData
+{
+    rg_handle_t tex;
+    rg_handle_t rt;
+};
+
+static rg_handle_t add_colour_target(render_graph_t* rg, intern_id_t name, uint32_t width)
+{
+    rg_texture_desc_t desc = {
+        .width = width,
+        .height = 100,
+        .mip_levels = 1,
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .layers = 1,
+        .depth = 1};
+    rg_texture_resource_t* r =
+        rg_tex_resource_init(name, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, desc, rg_get_arena(rg));
+    return rg_add_resource(rg, (rg_resource_t*)r, NULL);
+}
+
+static void write_colour_target(
+    render_graph_t* rg, rg_pass_node_t* node, struct CachePassData* d, intern_id_t name)
+{
+    d->tex = rg_add_write(rg, d->tex, node, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+    rg_pass_desc_t desc = rg_pass_desc_init();
+    desc.attachments.attach.colour[0] = d->tex;
+    d->rt = rg_rpass_node_create_rt((rg_render_pass_node_t*)node, rg, name, desc);
+}
+
+void setup_cache_gbuffer(render_graph_t* rg, rg_pass_node_t* node, void* data, void* local_data)
+{
+    struct CachePassData* d = (struct CachePassData*)data;
+    struct CacheGraphDesc* graph_desc = (struct CacheGraphDesc*)local_data;
+    d->tex = add_colour_target(rg, INTERN_LITERAL("Colour"), graph_desc->width);
+    write_colour_target(rg, node, d, INTERN_LITERAL("GBufferPass"));
+    rg_backboard_add(rg_get_backboard(rg), INTERN_LITERAL("colour"), d->tex);
+}
+
+void setup_cache_light(render_graph_t* rg, rg_pass_node_t* node, void* data, void* local_data)
+{
+    struct CachePassData* d = (struct CachePassData*)data;
+    struct CacheGraphDesc* graph_desc = (struct CacheGraphDesc*)local_data;
+    rg_handle_t colour = rg_backboard_get(rg_get_backboard(rg), INTERN_LITERAL("colour"));
+    rg_add_read(rg, colour, node, graph_desc->read_usage);
+    d->tex = add_colour_target(rg, INTERN_LITERAL("Light"), 100);
+    write_colour_target(rg, node, d, INTERN_LITERAL("LightPass"));
+    rg_node_declare_side_effect((rg_node_t*)node);
+}
+
+void setup_cache_unused(render_graph_t* rg, rg_pass_node_t* node, void* data, void* local_data)
+{
+    struct CachePassData* d = (struct CachePassData*)data;
+    struct CacheGraphDesc* graph_desc = (struct CacheGraphDesc*)local_data;
+    d->tex = add_colour_target(rg, INTERN_LITERAL("Unused"), 100);
+    write_colour_target(rg, node, d, INTERN_LITERAL("UnusedPass"));
+    if (graph_desc->keep_unused)
+    {
+        rg_node_declare_side_effect((rg_node_t*)node);
+    }
+}
+
+struct CacheGraph
+{
+    rg_pass_t* gbuffer;
+    rg_pass_t* light;
+    rg_pass_t* unused;
+};
+
+static struct CacheGraph build_cache_graph(render_graph_t* rg, struct CacheGraphDesc* desc)
+{
+    rg_clear(rg);
+    struct CacheGraph g;
+    g.unused = rg_add_pass(
+        rg, INTERN_LITERAL("Unused"), setup_cache_unused, NULL, sizeof(struct CachePassData), desc);
+    g.gbuffer = rg_add_pass(
+        rg,
+        INTERN_LITERAL("GBuffer"),
+        setup_cache_gbuffer,
+        NULL,
+        sizeof(struct CachePassData),
+        desc);
+    g.light = rg_add_pass(
+        rg, INTERN_LITERAL("Light"), setup_cache_light, NULL, sizeof(struct CachePassData), desc);
+    rg_compile(rg);
+    return g;
+}
+
+static void assert_compiled_graph(render_graph_t* rg, struct CacheGraph* g, uint32_t width)
+{
+    TEST_ASSERT_TRUE(rg_node_is_culled((rg_node_t*)g->unused->node));
+    TEST_ASSERT_FALSE(rg_node_is_culled((rg_node_t*)g->gbuffer->node));
+    TEST_ASSERT_FALSE(rg_node_is_culled((rg_node_t*)g->light->node));
+
+    TEST_ASSERT_EQUAL_UINT(2, rg->active_idx);
+    TEST_ASSERT(DYN_ARRAY_GET(rg_render_pass_node_t*, &rg->pass_nodes, 0) == g->gbuffer->node);
+    TEST_ASSERT(DYN_ARRAY_GET(rg_render_pass_node_t*, &rg->pass_nodes, 1) == g->light->node);
+    TEST_ASSERT_EQUAL_UINT(1, g->light->node->base.exec_idx);
+
+    // The colour texture is used from the gbuffer pass through to the lighting pass.
+    struct CachePassData* d = (struct CachePassData*)g->gbuffer->data;
+    rg_texture_resource_t* colour = (rg_texture_resource_t*)rg_get_resource(rg, d->tex);
+    TEST_ASSERT(colour->base.first_pass_node == (rg_pass_node_t*)g->gbuffer->node);
+    TEST_ASSERT(colour->base.last_pass_node == (rg_pass_node_t*)g->light->node);
+    TEST_ASSERT(colour->image_usage & VK_IMAGE_USAGE_SAMPLED_BIT);
+    TEST_ASSERT_EQUAL_UINT(2, rg->transient_textures.size);
+
+    rg_pass_info_t info = rg_render_pass_node_get_rt_info(g->gbuffer->node, d->rt);
+    TEST_ASSERT_EQUAL_UINT(width, info.vkapi_rpass_data.width);
+    TEST_ASSERT_EQUAL(
+        RPE_BACKEND_RENDERPASS_STORE_CLEAR_FLAG_STORE, info.vkapi_rpass_data.store_clear_flags[0]);
+}
+
+TEST(RenderGraphCacheGroup, RenderGraphCache_SkipTests)
+{
+    arena_t* arena = setup_arena(1 << 22);
+    render_graph_t* rg = rg_init(arena);
+
+    struct CacheGraphDesc desc = {.width = 100, .read_usage = VK_IMAGE_USAGE_SAMPLED_BIT};
+    struct CacheGraph g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(1, rg_get_compile_stats(rg).compile_count);
+    TEST_ASSERT_EQUAL_UINT(0, rg_get_compile_stats(rg).skip_count);
+    assert_compiled_graph(rg, &g, 100);
+
+    // The same graph - the compiled graph is reused, giving the same result.
+    g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(1, rg_get_compile_stats(rg).compile_count);
+    TEST_ASSERT_EQUAL_UINT(1, rg_get_compile_stats(rg).skip_count);
+    assert_compiled_graph(rg, &g, 100);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(RenderGraphCacheGroup, RenderGraphCache_InvalidateTests)
+{
+    arena_t* arena = setup_arena(1 << 22);
+    render_graph_t* rg = rg_init(arena);
+
+    struct CacheGraphDesc desc = {.width = 100, .read_usage = VK_IMAGE_USAGE_SAMPLED_BIT};
+    build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(1, rg_get_compile_stats(rg).compile_count);
+
+    // A changed edge.
+    desc.read_usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    struct CacheGraph g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(2, rg_get_compile_stats(rg).compile_count);
+    TEST_ASSERT_EQUAL_UINT(0, rg_get_compile_stats(rg).skip_count);
+    struct CachePassData* d = (struct CachePassData*)g.gbuffer->data;
+    rg_texture_resource_t* colour = (rg_texture_resource_t*)rg_get_resource(rg, d->tex);
+    TEST_ASSERT(colour->image_usage & VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+
+    // A changed resource descriptor.
+    desc.width = 200;
+    g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(3, rg_get_compile_stats(rg).compile_count);
+    assert_compiled_graph(rg, &g, 200);
+
+    g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(3, rg_get_compile_stats(rg).compile_count);
+    TEST_ASSERT_EQUAL_UINT(1, rg_get_compile_stats(rg).skip_count);
+    assert_compiled_graph(rg, &g, 200);
+
+    // A changed side effect - the unused pass is no longer culled.
+    desc.keep_unused = true;
+    g = build_cache_graph(rg, &desc);
+    TEST_ASSERT_EQUAL_UINT(4, rg_get_compile_stats(rg).compile_count);
+    TEST_ASSERT_FALSE(rg_node_is_culled((rg_node_t*)g.unused->node));
+    TEST_ASSERT_EQUAL_UINT(3, rg->active_idx);
+
+    arena_release(arena);
+    free(arena);
+}
@@ -0,0 +1,107 @@
+#include "vk_setup.h"
+
+#include <managers/renderable_manager.h>
+#include <scene.h>
+#include <unity_fixture.h>
+
+TEST_GROUP(RenderableSortGroup);
+
+TEST_SETUP(RenderableSortGroup) {}
+
+TEST_TEAR_DOWN(RenderableSortGroup) {}
+
+#define SORT_TEST_COUNT 500
+
+static bool instances_sorted(rpe_rend_sort_cache_t* cache, struct RenderableInstance* instances)
+{
+    for (size_t i = 0; i < SORT_TEST_COUNT; ++i)
+    {
+        if (instances[i].rend->sort_key != cache->sorted_keys[i])
+        {
+            return false;
+        }
+        if (i > 0 && cache->sorted_keys[i - 1] > cache->sorted_keys[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void reset_instances(
+    struct RenderableInstance* instances, rpe_renderable_t* rends, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        instances[i].rend = &rends[i];
+        instances[i].world_transform = NULL;
+    }
+}
+
+TEST(RenderableSortGroup, SortAndBatch_Test)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rpe_renderable_t rends[SORT_TEST_COUNT] = {0};
+    struct RenderableInstance instances[SORT_TEST_COUNT];
+    for (size_t i = 0; i < SORT_TEST_COUNT; ++i)
+    {
+        // Ten unique keys in reverse order.
+        rends[i].sort_key = 10 - (i % 10);
+    }
+
+    rpe_rend_sort_cache_t* cache = rpe_rend_sort_cache_init(SORT_TEST_COUNT, arena);
+    reset_instances(instances, rends, SORT_TEST_COUNT);
+    TEST_ASSERT_TRUE(
+        rpe_rend_manager_sort_renderables(cache, instances, SORT_TEST_COUNT, true, arena));
+    TEST_ASSERT_TRUE(instances_sorted(cache, instances));
+    // The sort is stable.
+    TEST_ASSERT_EQUAL_PTR(&rends[9], instances[0].rend);
+    TEST_ASSERT_EQUAL_PTR(&rends[19], instances[1].rend);
+
+    rpe_rend_manager_t rm = {0};
+    arena_dyn_array_t batches;
+    MAKE_DYN_ARRAY(rpe_batch_renderable_t, arena, 10, &batches);
+    rpe_rend_manager_batch_renderables(
+        &rm, instances, cache->sorted_keys, SORT_TEST_COUNT, &batches);
+    TEST_ASSERT_EQUAL_UINT(10, batches.size);
+    for (size_t i = 0; i < batches.size; ++i)
+    {
+        rpe_batch_renderable_t* batch = DYN_ARRAY_GET_PTR(rpe_batch_renderable_t, &batches, i);
+        TEST_ASSERT_EQUAL_UINT(i * 50, batch->first_idx);
+        TEST_ASSERT_EQUAL_UINT(50, batch->count);
+    }
+
+    // No keys have changed - the batches don't need rebuilding but the instances are reordered.
+    reset_instances(instances, rends, SORT_TEST_COUNT);
+    TEST_ASSERT_FALSE(
+        rpe_rend_manager_sort_renderables(cache, instances, SORT_TEST_COUNT, false, arena));
+    TEST_ASSERT_TRUE(instances_sorted(cache, instances));
+
+    // A few keys have changed - these are merged into the previous order.
+    rends[0].sort_key = 0;
+    rends[5].sort_key = 100;
+    rends[6].sort_key = 5;
+    reset_instances(instances, rends, SORT_TEST_COUNT);
+    TEST_ASSERT_TRUE(
+        rpe_rend_manager_sort_renderables(cache, instances, SORT_TEST_COUNT, false, arena));
+    TEST_ASSERT_TRUE(instances_sorted(cache, instances));
+    TEST_ASSERT_EQUAL_PTR(&rends[0], instances[0].rend);
+    TEST_ASSERT_EQUAL_PTR(&rends[5], instances[SORT_TEST_COUNT - 1].rend);
+    rpe_rend_manager_batch_renderables(
+        &rm, instances, cache->sorted_keys, SORT_TEST_COUNT, &batches);
+    TEST_ASSERT_EQUAL_UINT(12, batches.size);
+
+    // Too many keys have changed for the incremental sort.
+    for (size_t i = 0; i < SORT_TEST_COUNT; ++i)
+    {
+        rends[i].sort_key = i % 3;
+    }
+    reset_instances(instances, rends, SORT_TEST_COUNT);
+    TEST_ASSERT_TRUE(
+        rpe_rend_manager_sort_renderables(cache, instances, SORT_TEST_COUNT, false, arena));
+    TEST_ASSERT_TRUE(instances_sorted(cache, instances));
+
+    arena_release(arena);
+    free(arena);
+}
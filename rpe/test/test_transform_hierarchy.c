@@ -0,0 +1,146 @@
+#include "vk_setup.h"
+
+#include <managers/transform_manager.h>
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <utility/maths.h>
+
+TEST_GROUP(TransformHierarchyGroup);
+
+TEST_SETUP(TransformHierarchyGroup) {}
+
+TEST_TEAR_DOWN(TransformHierarchyGroup) {}
+
+static math_mat4f make_translation(float x, float y, float z)
+{
+    math_mat4f m = math_mat4f_identity();
+    math_mat4f_translate(math_vec3f_init(x, y, z), &m);
+    return m;
+}
+
+static void assert_translation(math_mat4f m, float x, float y, float z)
+{
+    math_vec3f t = math_mat4f_translation_vec(m);
+    TEST_ASSERT_EQUAL_FLOAT(x, t.x);
+    TEST_ASSERT_EQUAL_FLOAT(y, t.y);
+    TEST_ASSERT_EQUAL_FLOAT(z, t.z);
+}
+
+static void assert_parents_sorted(rpe_transform_hierarchy_t* h)
+{
+    for (uint32_t i = 0; i < h->parents.size; ++i)
+    {
+        uint32_t parent = DYN_ARRAY_GET(uint32_t, &h->parents, i);
+        TEST_ASSERT(parent == RPE_TRANSFORM_NODE_INVALID || parent < i);
+        uint32_t slot = DYN_ARRAY_GET(uint32_t, &h->slots, i);
+        TEST_ASSERT_EQUAL_UINT(i, DYN_ARRAY_GET(uint32_t, &h->slot_to_pos, slot));
+    }
+}
+
+TEST(TransformHierarchyGroup, TransformHierarchy_UpdateTests)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rpe_transform_hierarchy_t h;
+    rpe_transform_hierarchy_init(&h, 10, arena);
+
+    // Slots: 0 = root, 1 = child of 0, 2 = child of 1, 3 = a second root.
+    math_mat4f t0 = make_translation(1.0f, 0.0f, 0.0f);
+    math_mat4f t1 = make_translation(0.0f, 2.0f, 0.0f);
+    math_mat4f t2 = make_translation(0.0f, 0.0f, 3.0f);
+    math_mat4f t3 = make_translation(5.0f, 0.0f, 0.0f);
+    rpe_transform_hierarchy_add(&h, 0, &t0, RPE_TRANSFORM_NODE_INVALID);
+    rpe_transform_hierarchy_add(&h, 1, &t1, 0);
+    rpe_transform_hierarchy_add(&h, 2, &t2, 1);
+    rpe_transform_hierarchy_add(&h, 3, &t3, RPE_TRANSFORM_NODE_INVALID);
+
+    math_mat4f out[4];
+    rpe_transform_slot_range_t range = rpe_transform_hierarchy_update(&h, out, 4);
+    TEST_ASSERT_EQUAL_UINT(0, range.start);
+    TEST_ASSERT_EQUAL_UINT(4, range.end);
+    assert_translation(*rpe_transform_hierarchy_get_world(&h, 2), 1.0f, 2.0f, 3.0f);
+    assert_translation(out[2], 1.0f, 2.0f, 3.0f);
+    assert_translation(out[3], 5.0f, 0.0f, 0.0f);
+
+    // Nothing has changed, so nothing is updated.
+    range = rpe_transform_hierarchy_update(&h, out, 4);
+    TEST_ASSERT_EQUAL_UINT(range.start, range.end);
+
+    // Only the changed node and its children are updated.
+    t1 = make_translation(0.0f, 4.0f, 0.0f);
+    rpe_transform_hierarchy_set_local(&h, 1, &t1);
+    range = rpe_transform_hierarchy_update(&h, out, 4);
+    TEST_ASSERT_EQUAL_UINT(1, range.start);
+    TEST_ASSERT_EQUAL_UINT(3, range.end);
+    assert_translation(out[2], 1.0f, 4.0f, 3.0f);
+
+    // Slots beyond the output are updated, but the range doesn't extend past the output.
+    rpe_transform_hierarchy_set_local(&h, 1, &t1);
+    range = rpe_transform_hierarchy_update(&h, out, 2);
+    TEST_ASSERT_EQUAL_UINT(1, range.start);
+    TEST_ASSERT_EQUAL_UINT(2, range.end);
+    assert_translation(*rpe_transform_hierarchy_get_world(&h, 2), 1.0f, 4.0f, 3.0f);
+
+    TEST_ASSERT_EQUAL_UINT(1, rpe_transform_hierarchy_get_parent(&h, 2));
+    TEST_ASSERT_EQUAL_UINT(RPE_TRANSFORM_NODE_INVALID, rpe_transform_hierarchy_get_parent(&h, 0));
+    TEST_ASSERT_EQUAL_UINT(1, rpe_transform_hierarchy_get_first_child(&h, 0));
+    TEST_ASSERT_EQUAL_UINT(
+        RPE_TRANSFORM_NODE_INVALID, rpe_transform_hierarchy_get_first_child(&h, 3));
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(TransformHierarchyGroup, TransformHierarchy_ReparentTests)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rpe_transform_hierarchy_t h;
+    rpe_transform_hierarchy_init(&h, 2, arena);
+
+    math_mat4f t0 = make_translation(1.0f, 0.0f, 0.0f);
+    math_mat4f t1 = make_translation(0.0f, 2.0f, 0.0f);
+    math_mat4f t2 = make_translation(0.0f, 0.0f, 3.0f);
+    math_mat4f t3 = make_translation(5.0f, 0.0f, 0.0f);
+    math_mat4f t4 = make_translation(0.0f, 0.0f, 7.0f);
+    rpe_transform_hierarchy_add(&h, 0, &t0, RPE_TRANSFORM_NODE_INVALID);
+    rpe_transform_hierarchy_add(&h, 1, &t1, 0);
+    rpe_transform_hierarchy_add(&h, 3, &t3, RPE_TRANSFORM_NODE_INVALID);
+    rpe_transform_hierarchy_add(&h, 2, &t2, 1);
+    rpe_transform_hierarchy_add(&h, 4, &t4, 3);
+    rpe_transform_hierarchy_update(&h, NULL, 0);
+
+    // Slot 3 is between the children of slot 0, but outside of its subtree.
+    TEST_ASSERT_EQUAL_UINT(4, DYN_ARRAY_GET(uint32_t, &h.subtree_ends, 0));
+    TEST_ASSERT_EQUAL_UINT(5, DYN_ARRAY_GET(uint32_t, &h.subtree_ends, 2));
+
+    // Moving a subtree under a node which is before it only changes the parent.
+    rpe_transform_hierarchy_set_parent(&h, 4, 1, arena);
+    assert_parents_sorted(&h);
+    TEST_ASSERT_EQUAL_UINT(5, DYN_ARRAY_GET(uint32_t, &h.subtree_ends, 0));
+    rpe_transform_hierarchy_update(&h, NULL, 0);
+    assert_translation(*rpe_transform_hierarchy_get_world(&h, 4), 1.0f, 2.0f, 7.0f);
+
+    // The new parent is after the subtree (slots 0, 1, 2 and 4), so the subtree is moved.
+    ptrdiff_t arena_offset = arena->offset;
+    rpe_transform_hierarchy_set_parent(&h, 0, 3, arena);
+    TEST_ASSERT_EQUAL_UINT(arena_offset, arena->offset);
+    assert_parents_sorted(&h);
+    TEST_ASSERT_EQUAL_UINT(0, DYN_ARRAY_GET(uint32_t, &h.slot_to_pos, 3));
+    TEST_ASSERT_EQUAL_UINT(3, rpe_transform_hierarchy_get_parent(&h, 0));
+    TEST_ASSERT_EQUAL_UINT(0, rpe_transform_hierarchy_get_first_child(&h, 3));
+    TEST_ASSERT_EQUAL_UINT(1, rpe_transform_hierarchy_get_parent(&h, 2));
+    TEST_ASSERT_EQUAL_UINT(1, rpe_transform_hierarchy_get_parent(&h, 4));
+    TEST_ASSERT_EQUAL_UINT(5, DYN_ARRAY_GET(uint32_t, &h.subtree_ends, 0));
+    TEST_ASSERT_EQUAL_UINT(4, DYN_ARRAY_GET(uint32_t, &h.subtree_ends, 3));
+
+    math_mat4f out[5];
+    rpe_transform_slot_range_t range = rpe_transform_hierarchy_update(&h, out, 5);
+    TEST_ASSERT_EQUAL_UINT(0, range.start);
+    TEST_ASSERT_EQUAL_UINT(5, range.end);
+    assert_translation(out[2], 6.0f, 2.0f, 3.0f);
+    assert_translation(out[4], 6.0f, 2.0f, 7.0f);
+
+    arena_release(arena);
+    free(arena);
+}
@@ -0,0 +1,140 @@
+#include "vk_setup.h"
+
+#include <render_graph/transient_pool.h>
+#include <unity_fixture.h>
+
+TEST_GROUP(TransientPoolGroup);
+
+TEST_SETUP(TransientPoolGroup) {}
+
+TEST_TEAR_DOWN(TransientPoolGroup) {}
+
+static bool intervals_valid(rg_alias_interval_t* intervals, size_t count, uint64_t total_size)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        rg_alias_interval_t* a = &intervals[i];
+        if (a->offset % a->alignment != 0 || a->offset + a->size > total_size)
+        {
+            return false;
+        }
+        for (size_t j = i + 1; j < count; ++j)
+        {
+            rg_alias_interval_t* b = &intervals[j];
+            bool lifetime_overlap = a->first_pass <= b->last_pass && b->first_pass <= a->last_pass;
+            bool mem_overlap = a->offset < b->offset + b->size && b->offset < a->offset + a->size;
+            if (lifetime_overlap && mem_overlap)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(TransientPoolGroup, PackIntervals_NoOverlap)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    // Sequential lifetimes - all resources can share the same memory.
+    rg_alias_interval_t intervals[] = {
+        {.size = 1024, .alignment = 256, .first_pass = 0, .last_pass = 1},
+        {.size = 1024, .alignment = 256, .first_pass = 2, .last_pass = 3},
+        {.size = 512, .alignment = 256, .first_pass = 4, .last_pass = 4}};
+
+    uint64_t total = rg_alias_pack_intervals(intervals, 3, arena);
+    TEST_ASSERT_EQUAL_UINT64(1024, total);
+    TEST_ASSERT_EQUAL_UINT64(0, intervals[0].offset);
+    TEST_ASSERT_EQUAL_UINT64(0, intervals[1].offset);
+    TEST_ASSERT_EQUAL_UINT64(0, intervals[2].offset);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(TransientPoolGroup, PackIntervals_AllOverlap)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    // All lifetimes overlap so no memory can be shared.
+    rg_alias_interval_t intervals[] = {
+        {.size = 1000, .alignment = 256, .first_pass = 0, .last_pass = 3},
+        {.size = 2048, .alignment = 256, .first_pass = 1, .last_pass = 2},
+        {.size = 512, .alignment = 512, .first_pass = 2, .last_pass = 4}};
+
+    uint64_t total = rg_alias_pack_intervals(intervals, 3, arena);
+    TEST_ASSERT_TRUE(intervals_valid(intervals, 3, total));
+    // Largest is placed first.
+    TEST_ASSERT_EQUAL_UINT64(0, intervals[1].offset);
+    TEST_ASSERT_EQUAL_UINT64(2048, intervals[0].offset);
+    // Offset of 3048 is aligned up to 3072.
+    TEST_ASSERT_EQUAL_UINT64(3072, intervals[2].offset);
+    TEST_ASSERT_EQUAL_UINT64(3584, total);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(TransientPoolGroup, PackIntervals_Mixed)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    // A typical deferred frame: gbuffer targets live until the lighting pass, the shadow map
+    // until the lighting pass, and the lighting output until the final pass.
+    rg_alias_interval_t intervals[] = {
+        {.size = 4096, .alignment = 1024, .first_pass = 0, .last_pass = 2},
+        {.size = 4096, .alignment = 1024, .first_pass = 0, .last_pass = 2},
+        {.size = 2048, .alignment = 1024, .first_pass = 1, .last_pass = 2},
+        {.size = 4096, .alignment = 1024, .first_pass = 2, .last_pass = 3},
+        {.size = 8192, .alignment = 1024, .first_pass = 3, .last_pass = 4},
+        {.size = 1024, .alignment = 1024, .first_pass = 4, .last_pass = 5}};
+    const size_t count = sizeof(intervals) / sizeof(rg_alias_interval_t);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += intervals[i].size;
+    }
+
+    uint64_t total = rg_alias_pack_intervals(intervals, count, arena);
+    TEST_ASSERT_TRUE(intervals_valid(intervals, count, total));
+    TEST_ASSERT_TRUE(total < sum);
+    // The peak working set is at pass 2 (4096 * 3 + 2048).
+    TEST_ASSERT_TRUE(total >= 14336);
+
+    // An empty list requires no memory.
+    TEST_ASSERT_EQUAL_UINT64(0, rg_alias_pack_intervals(intervals, 0, arena));
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(TransientPoolGroup, AliasSrcUsage)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    // A depth target and a colour target with disjoint lifetimes share memory, while a storage
+    // image alive throughout has memory of its own.
+    rg_alias_interval_t intervals[] = {
+        {.size = 1024, .alignment = 256, .first_pass = 0, .last_pass = 1},
+        {.size = 1024, .alignment = 256, .first_pass = 2, .last_pass = 3},
+        {.size = 512, .alignment = 256, .first_pass = 0, .last_pass = 3}};
+    VkImageUsageFlags usages[] = {
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        VK_IMAGE_USAGE_STORAGE_BIT};
+
+    uint64_t total = rg_alias_pack_intervals(intervals, 3, arena);
+    TEST_ASSERT_TRUE(intervals_valid(intervals, 3, total));
+    TEST_ASSERT_EQUAL_UINT64(intervals[0].offset, intervals[1].offset);
+
+    // The colour target must wait on the depth target earlier in the frame, and the depth target
+    // on the colour target from the previous frame.
+    TEST_ASSERT_EQUAL_UINT(usages[0], rg_alias_src_usage(intervals, usages, 3, 1));
+    TEST_ASSERT_EQUAL_UINT(usages[1], rg_alias_src_usage(intervals, usages, 3, 0));
+    // Unshared memory needs no hand over.
+    TEST_ASSERT_EQUAL_UINT(0, rg_alias_src_usage(intervals, usages, 3, 2));
+
+    arena_release(arena);
+    free(arena);
+}
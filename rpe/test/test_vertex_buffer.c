@@ -0,0 +1,121 @@
+#include "vk_setup.h"
+
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <vertex_buffer.h>
+
+TEST_GROUP(VertexBufferGroup);
+
+TEST_SETUP(VertexBufferGroup) {}
+
+TEST_TEAR_DOWN(VertexBufferGroup) {}
+
+TEST(VertexBufferGroup, VertexPool_AllocTests)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rpe_vertex_pool_t p;
+    rpe_vertex_pool_init(&p, sizeof(uint32_t), 1024, arena);
+    TEST_ASSERT_EQUAL_UINT(1024, p.allocator.capacity);
+
+    rpe_vertex_alloc_info_t a0 = rpe_vertex_pool_alloc(&p, 100);
+    rpe_vertex_alloc_info_t a1 = rpe_vertex_pool_alloc(&p, 200);
+    TEST_ASSERT_EQUAL_UINT(0, a0.offset);
+    TEST_ASSERT_EQUAL_UINT(100, a1.offset);
+    TEST_ASSERT_EQUAL_UINT(300, p.used_extent);
+
+    // A freed range isn't reused while frames in flight may still be reading from it.
+    rpe_vertex_pool_free(&p, &a0, 10);
+    TEST_ASSERT_EQUAL_UINT(OFFSET_ALLOC_INVALID, a0.node);
+    rpe_vertex_pool_gc(&p, 10 + VKAPI_MAX_COMMAND_BUFFER_SIZE);
+    rpe_vertex_alloc_info_t a2 = rpe_vertex_pool_alloc(&p, 50);
+    TEST_ASSERT_EQUAL_UINT(300, a2.offset);
+    TEST_ASSERT_EQUAL_UINT(350, p.used_extent);
+    rpe_vertex_pool_free(&p, &a2, 10 + VKAPI_MAX_COMMAND_BUFFER_SIZE);
+
+    // Once those frames have completed, the freed range is reused rather than allocating past
+    // the end.
+    rpe_vertex_pool_gc(&p, 10 + VKAPI_MAX_COMMAND_BUFFER_SIZE + 1);
+    TEST_ASSERT_EQUAL_UINT(1, p.pending_frees.size);
+    a2 = rpe_vertex_pool_alloc(&p, 50);
+    TEST_ASSERT_EQUAL_UINT(0, a2.offset);
+    TEST_ASSERT_EQUAL_UINT(350, p.used_extent);
+
+    // The pool grows by whole pages, at least doubling in size.
+    rpe_vertex_alloc_info_t a3 = rpe_vertex_pool_alloc(&p, 1000);
+    TEST_ASSERT_EQUAL_UINT(2048, p.allocator.capacity);
+    TEST_ASSERT(p.data.size >= 2048);
+    TEST_ASSERT_EQUAL_UINT(a3.offset + 1000, p.used_extent);
+
+    rpe_vertex_alloc_info_t a4 = rpe_vertex_pool_alloc(&p, 5000);
+    TEST_ASSERT_EQUAL_UINT(7168, p.allocator.capacity);
+    TEST_ASSERT(a4.offset + a4.size <= p.allocator.capacity);
+
+    // Data written to a range is copied into the host copy at the range offset.
+    uint32_t data[50];
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        data[i] = i + 10;
+    }
+    rpe_vertex_pool_write(&p, &a2, data, 50);
+    uint32_t* pool_data = (uint32_t*)p.data.data;
+    TEST_ASSERT_EQUAL_UINT(10, pool_data[a2.offset]);
+    TEST_ASSERT_EQUAL_UINT(59, pool_data[a2.offset + 49]);
+    TEST_ASSERT_EQUAL_UINT(1, p.dirty_count);
+    TEST_ASSERT_EQUAL_UINT(0, p.dirty_ranges[0].start);
+    TEST_ASSERT_EQUAL_UINT(50, p.dirty_ranges[0].end);
+
+    arena_release(arena);
+    free(arena);
+}
+
+TEST(VertexBufferGroup, VertexPool_DirtyRangeTests)
+{
+    arena_t* arena = setup_arena(1 << 20);
+
+    rpe_vertex_pool_t p;
+    rpe_vertex_pool_init(&p, sizeof(uint16_t), 4096, arena);
+
+    rpe_vertex_pool_mark_dirty(&p, 100, 200);
+    rpe_vertex_pool_mark_dirty(&p, 0, 10);
+    rpe_vertex_pool_mark_dirty(&p, 300, 400);
+    TEST_ASSERT_EQUAL_UINT(3, p.dirty_count);
+    TEST_ASSERT_EQUAL_UINT(0, p.dirty_ranges[0].start);
+    TEST_ASSERT_EQUAL_UINT(100, p.dirty_ranges[1].start);
+    TEST_ASSERT_EQUAL_UINT(300, p.dirty_ranges[2].start);
+
+    // Touching ranges are merged.
+    rpe_vertex_pool_mark_dirty(&p, 10, 20);
+    TEST_ASSERT_EQUAL_UINT(3, p.dirty_count);
+    TEST_ASSERT_EQUAL_UINT(20, p.dirty_ranges[0].end);
+
+    // A range overlapping several is merged into one.
+    rpe_vertex_pool_mark_dirty(&p, 150, 350);
+    TEST_ASSERT_EQUAL_UINT(2, p.dirty_count);
+    TEST_ASSERT_EQUAL_UINT(100, p.dirty_ranges[1].start);
+    TEST_ASSERT_EQUAL_UINT(400, p.dirty_ranges[1].end);
+
+    // Once the range limit is reached, the closest range is extended instead.
+    p.dirty_count = 0;
+    for (uint32_t i = 0; i < RPE_VERTEX_POOL_MAX_DIRTY_RANGES; ++i)
+    {
+        rpe_vertex_pool_mark_dirty(&p, i * 100, i * 100 + 10);
+    }
+    TEST_ASSERT_EQUAL_UINT(RPE_VERTEX_POOL_MAX_DIRTY_RANGES, p.dirty_count);
+    rpe_vertex_pool_mark_dirty(&p, 515, 520);
+    TEST_ASSERT_EQUAL_UINT(RPE_VERTEX_POOL_MAX_DIRTY_RANGES, p.dirty_count);
+    TEST_ASSERT_EQUAL_UINT(500, p.dirty_ranges[5].start);
+    TEST_ASSERT_EQUAL_UINT(520, p.dirty_ranges[5].end);
+    rpe_vertex_pool_mark_dirty(&p, 595, 598);
+    TEST_ASSERT_EQUAL_UINT(595, p.dirty_ranges[6].start);
+    TEST_ASSERT_EQUAL_UINT(610, p.dirty_ranges[6].end);
+
+    // The ranges remain in order and never overlap.
+    for (uint32_t i = 1; i < p.dirty_count; ++i)
+    {
+        TEST_ASSERT(p.dirty_ranges[i - 1].end < p.dirty_ranges[i].start);
+    }
+
+    arena_release(arena);
+    free(arena);
+}
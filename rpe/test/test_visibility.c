@@ -46,7 +46,8 @@ TEST(VisibilityGroup, VisCompute_Test)
     arena_t* arena = setup_arena(1 << 20);
     vkapi_driver_t* driver = setup_driver();
 
-    math_mat4f proj = math_mat4f_frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f);
+    // A camera at the origin, with the side planes at 45 degrees to the view direction.
+    math_mat4f proj = math_mat4f_perspective(180.0f, 1.0f, 1.0f, 100.0f);
     rpe_frustum_t frustum = {0};
     rpe_frustum_projection(&frustum, &proj);
 
@@ -0,0 +1,190 @@
+#include <backend/enums.h>
+#include <log.h>
+#include <stdio.h>
+#include <string.h>
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/filesystem.h>
+#include <utility/job_queue.h>
+#include <vulkan-api/shader.h>
+
+// CPU-only - compiles and reflects every shader in the shader directory without a device.
+
+#define BM_MAX_SHADER_COUNT 64
+#define BM_MAX_INCLUDE_DEPTH 8
+
+struct ShaderSources
+{
+    const char* codes[BM_MAX_SHADER_COUNT];
+    enum ShaderStage stages[BM_MAX_SHADER_COUNT];
+    uint32_t count;
+    arena_t arena;
+};
+
+static struct ShaderSources sources;
+
+// glslang is used without an include callback, so includes are inlined here before compiling.
+string_t _bm_load_source(const char* path, int depth, arena_t* arena)
+{
+    string_t out = string_init("", arena);
+    fs_buffer_t* buffer = fs_load_file_into_memory(path, arena);
+    if (!buffer || depth > BM_MAX_INCLUDE_DEPTH)
+    {
+        return out;
+    }
+    string_t path_str = string_init(path, arena);
+    string_t dir = fs_remove_filename(&path_str, arena);
+
+    char* line = fs_get_buffer(buffer);
+    while (line && *line)
+    {
+        char* next = strchr(line, '\n');
+        if (next)
+        {
+            *next++ = '\0';
+        }
+        const char* inc_directive = "#include \"";
+        if (strncmp(line, inc_directive, strlen(inc_directive)) == 0)
+        {
+            char* name = line + strlen(inc_directive);
+            char* end = strchr(name, '"');
+            if (end)
+            {
+                *end = '\0';
+            }
+            string_t inc_path = string_append3(&dir, "/", name, arena);
+            string_t inc_src = _bm_load_source(inc_path.data, depth + 1, arena);
+            out = string_append(&out, inc_src.data, arena);
+        }
+        else
+        {
+            out = string_append3(&out, line, "\n", arena);
+        }
+        line = next;
+    }
+    return out;
+}
+
+bool _bm_stage_from_filename(const char* filename, enum ShaderStage* stage)
+{
+    const char* ext = strrchr(filename, '.');
+    if (!ext)
+    {
+        return false;
+    }
+    if (strcmp(ext, ".vert") == 0)
+    {
+        *stage = RPE_BACKEND_SHADER_STAGE_VERTEX;
+    }
+    else if (strcmp(ext, ".frag") == 0)
+    {
+        *stage = RPE_BACKEND_SHADER_STAGE_FRAGMENT;
+    }
+    else if (strcmp(ext, ".comp") == 0)
+    {
+        *stage = RPE_BACKEND_SHADER_STAGE_COMPUTE;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void _bm_load_sources()
+{
+    if (sources.count)
+    {
+        return;
+    }
+    int res = arena_new(1 << 24, &sources.arena);
+    assert(res == ARENA_SUCCESS);
+
+    // A comma separated list of the shader filenames, generated by CMake.
+    string_t files = string_init(RPE_BENCHMARK_SHADER_FILES, &sources.arena);
+    uint32_t file_count;
+    string_t** filenames = string_split(&files, ',', &file_count, &sources.arena);
+    for (uint32_t i = 0; i < file_count && sources.count < BM_MAX_SHADER_COUNT; ++i)
+    {
+        enum ShaderStage stage;
+        if (!_bm_stage_from_filename(filenames[i]->data, &stage))
+        {
+            continue;
+        }
+        string_t dir = string_init(RPE_BENCHMARK_SHADER_SOURCE_DIRECTORY, &sources.arena);
+        string_t path = string_append3(&dir, "/", filenames[i]->data, &sources.arena);
+        string_t src = _bm_load_source(path.data, 0, &sources.arena);
+        if (!src.len)
+        {
+            continue;
+        }
+        sources.codes[sources.count] = src.data;
+        sources.stages[sources.count++] = stage;
+    }
+}
+
+void _bm_compile_all(bm_run_state_t* state, uint32_t worker_count)
+{
+    log_set_quiet(true);
+    _bm_load_sources();
+
+    arena_t arena;
+    int res = arena_new(1 << 26, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    shader_compiler_process_init();
+    shader_compiler_pool_t* pool = ARENA_MAKE_ZERO_STRUCT(&arena, shader_compiler_pool_t);
+    job_queue_t* jq = NULL;
+    if (worker_count)
+    {
+        jq = job_queue_init(&arena, worker_count);
+        job_queue_adopt_thread(jq);
+    }
+
+    arena_t frame_arena;
+    res = arena_new(1 << 24, &frame_arena);
+    assert(res == ARENA_SUCCESS);
+
+    while (bm_state_set_running(state))
+    {
+        shader_t* shaders[BM_MAX_SHADER_COUNT];
+        spirv_binary_t bins[BM_MAX_SHADER_COUNT];
+        for (uint32_t i = 0; i < sources.count; ++i)
+        {
+            shaders[i] = shader_init(sources.stages[i], &frame_arena);
+        }
+        shader_compile_batch(pool, jq, shaders, sources.codes, sources.count, bins, &frame_arena);
+        for (uint32_t i = 0; i < sources.count; ++i)
+        {
+            BM_DONT_OPTIMISE(bins[i].words);
+            free(bins[i].words);
+        }
+        arena_reset(&frame_arena);
+    }
+
+    if (jq)
+    {
+        job_queue_destroy(jq);
+    }
+    shader_compiler_pool_destroy(pool);
+    shader_compiler_process_shutdown();
+    arena_release(&frame_arena);
+    arena_release(&arena);
+}
+
+void BM_shader_compile_serial(bm_run_state_t* state) { _bm_compile_all(state, 0); }
+
+// The argument is the number of worker threads - the calling thread also runs jobs.
+void BM_shader_compile_parallel(bm_run_state_t* state)
+{
+    _bm_compile_all(state, (uint32_t)state->arg);
+}
+
+void BM_shader_compile_parallel_wide(bm_run_state_t* state)
+{
+    _bm_compile_all(state, (uint32_t)state->arg);
+}
+
+BENCHMARK_ARG1(BM_shader_compile_serial, 1)
+BENCHMARK_ARG3(BM_shader_compile_parallel, 1, 2, 4)
+BENCHMARK_ARG2(BM_shader_compile_parallel_wide, 8, 16)
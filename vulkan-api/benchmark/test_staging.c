@@ -0,0 +1,113 @@
+#include <utility/arena.h>
+#include <utility/benchmark.h>
+#include <utility/random.h>
+#include <vulkan-api/commands.h>
+#include <vulkan-api/staging_ring.h>
+
+// CPU-only - compares the cost of finding staging space with the ring against the first-fit
+// search of the previous staging pool. Buffer creation isn't included, so this favours the old
+// pool.
+
+#define BM_STAGING_FRAME_COUNT 16
+#define BM_STAGING_RING_SIZE (64 * 1024 * 1024)
+#define BM_STAGING_MAX_UPLOAD_SIZE (64 * 1024)
+
+typedef struct BmStage
+{
+    uint64_t size;
+    uint64_t frame_last_used;
+} bm_stage_t;
+
+// A copy of the search and gc of the previous staging pool, minus the Vulkan calls.
+typedef struct BmFirstFitPool
+{
+    arena_dyn_array_t free_stages;
+    arena_dyn_array_t in_use_stages;
+} bm_first_fit_pool_t;
+
+uint64_t _bm_first_fit_get(bm_first_fit_pool_t* p, uint64_t size, uint64_t frame)
+{
+    for (uint32_t i = 0; i < p->free_stages.size; ++i)
+    {
+        bm_stage_t stage = DYN_ARRAY_GET(bm_stage_t, &p->free_stages, i);
+        if (stage.size >= size)
+        {
+            DYN_ARRAY_REMOVE(&p->free_stages, i);
+            stage.frame_last_used = frame;
+            DYN_ARRAY_APPEND(&p->in_use_stages, &stage);
+            return stage.size;
+        }
+    }
+    bm_stage_t stage = {.size = size, .frame_last_used = frame};
+    DYN_ARRAY_APPEND(&p->in_use_stages, &stage);
+    return size;
+}
+
+void _bm_first_fit_gc(bm_first_fit_pool_t* p, uint64_t frame)
+{
+    for (uint32_t i = 0; i < p->in_use_stages.size; ++i)
+    {
+        bm_stage_t* stage = DYN_ARRAY_GET_PTR(bm_stage_t, &p->in_use_stages, i);
+        if (stage->frame_last_used + VKAPI_MAX_COMMAND_BUFFER_SIZE < frame)
+        {
+            DYN_ARRAY_APPEND(&p->free_stages, stage);
+            DYN_ARRAY_REMOVE(&p->in_use_stages, i);
+        }
+    }
+}
+
+// The argument is the number of uploads per frame.
+void BM_staging_first_fit(bm_run_state_t* state)
+{
+    arena_t arena;
+    int res = arena_new(1 << 26, &arena);
+    assert(res == ARENA_SUCCESS);
+
+    while (bm_state_set_running(state))
+    {
+        bm_first_fit_pool_t p;
+        MAKE_DYN_ARRAY(bm_stage_t, &arena, 50, &p.free_stages);
+        MAKE_DYN_ARRAY(bm_stage_t, &arena, 50, &p.in_use_stages);
+        xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+
+        for (uint64_t frame = 0; frame < BM_STAGING_FRAME_COUNT; ++frame)
+        {
+            for (int64_t i = 0; i < state->arg; ++i)
+            {
+                uint64_t size = 1 + xoro_rand_next(&rand) % BM_STAGING_MAX_UPLOAD_SIZE;
+                uint64_t out = _bm_first_fit_get(&p, size, frame);
+                BM_DONT_OPTIMISE(out);
+            }
+            _bm_first_fit_gc(&p, frame);
+        }
+        arena_reset(&arena);
+    }
+    arena_release(&arena);
+}
+
+void BM_staging_ring(bm_run_state_t* state)
+{
+    while (bm_state_set_running(state))
+    {
+        vkapi_staging_ring_t r;
+        vkapi_staging_ring_init(&r, BM_STAGING_RING_SIZE);
+        xoro_rand_t rand = xoro_rand_init(0xff, 0x1234);
+
+        for (uint64_t frame = 0; frame < BM_STAGING_FRAME_COUNT; ++frame)
+        {
+            for (int64_t i = 0; i < state->arg; ++i)
+            {
+                uint64_t size = 1 + xoro_rand_next(&rand) % BM_STAGING_MAX_UPLOAD_SIZE;
+                uint64_t offset = vkapi_staging_ring_alloc(&r, size, 16, frame);
+                BM_DONT_OPTIMISE(offset);
+            }
+            if (frame > VKAPI_MAX_COMMAND_BUFFER_SIZE)
+            {
+                vkapi_staging_ring_retire(&r, frame - VKAPI_MAX_COMMAND_BUFFER_SIZE - 1);
+            }
+        }
+    }
+}
+
+BENCHMARK_ARG3(BM_staging_first_fit, 16, 128, 1024)
+BENCHMARK_ARG3(BM_staging_ring, 16, 128, 1024)
@@ -93,95 +93,16 @@ void vkapi_map_and_copy_to_gpu(
     VkBufferUsageFlags usage,
     void* data)
 {
-    vkapi_staging_instance_t* stage =
-        vkapi_staging_get(driver->staging_pool, driver->vma_allocator, size);
+    vkapi_staging_instance_t stage = vkapi_staging_get(
+        driver->staging_pool, driver->vma_allocator, size, VKAPI_STAGING_DEFAULT_ALIGNMENT);
 
-    void* mapped;
-    vmaMapMemory(driver->vma_allocator, stage->mem, &mapped);
-    assert(mapped);
-    memcpy(mapped, data, size);
-    vmaUnmapMemory(driver->vma_allocator, stage->mem);
-    vmaFlushAllocation(driver->vma_allocator, stage->mem, offset, size);
+    memcpy(stage.mapped, data, size);
+    vmaFlushAllocation(driver->vma_allocator, stage.mem, stage.offset, size);
 
-    vkapi_copy_staged_to_gpu(driver, size, stage, dst_buffer, offset, offset, usage);
-}
-
-void vkapi_copy_staged_to_gpu(
-    vkapi_driver_t* driver,
-    VkDeviceSize size,
-    vkapi_staging_instance_t* stage,
-    vkapi_buffer_t* dst_buffer,
-    uint32_t src_offset,
-    uint32_t dst_offset,
-    VkBufferUsageFlags usage)
-{
-    // copy from the staging area to the allocated GPU memory
-    vkapi_commands_t* cmds = driver->commands;
-    vkapi_cmdbuffer_t* cmd = vkapi_commands_get_cmdbuffer(driver->context, cmds);
-
-    VkBufferCopy copy_region = {.dstOffset = dst_offset, .srcOffset = src_offset, .size = size};
-    vkCmdCopyBuffer(cmd->instance, stage->buffer, dst_buffer->buffer, 1, &copy_region);
-
-    VkBufferMemoryBarrier mem_barrier = {0};
-    mem_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    mem_barrier.buffer = stage->buffer;
-    mem_barrier.size = VK_WHOLE_SIZE;
-
-    // ensure that the copy finishes before the next frames draw call
-    if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT || usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
-    {
-        mem_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        mem_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT |
-            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
-
-        vkCmdPipelineBarrier(
-            cmd->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-            0,
-            0,
-            VK_NULL_HANDLE,
-            1,
-            &mem_barrier,
-            0,
-            VK_NULL_HANDLE);
-    }
-    else if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-    {
-        mem_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        mem_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
-
-        vkCmdPipelineBarrier(
-            cmd->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            0,
-            0,
-            VK_NULL_HANDLE,
-            1,
-            &mem_barrier,
-            0,
-            VK_NULL_HANDLE);
-    }
-    else if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
-    {
-        mem_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        mem_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-
-        vkCmdPipelineBarrier(
-            cmd->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-            0,
-            0,
-            VK_NULL_HANDLE,
-            1,
-            &mem_barrier,
-            0,
-            VK_NULL_HANDLE);
-    }
+    // The copy is recorded along with all other uploads for the frame when the commands are
+    // flushed.
+    vkapi_upload_batch_add_buffer(
+        &driver->uploads, stage.buffer, dst_buffer->buffer, stage.offset, offset, size, usage);
 }
 
 void vkapi_buffer_download_to_host(
@@ -211,7 +132,7 @@ void vkapi_buffer_download_to_host(
         0,
         VK_NULL_HANDLE);
 
-    vkapi_commands_flush(driver->context, driver->compute_commands);
+    vkapi_driver_flush_compute_cmds(driver);
     VK_CHECK_RESULT(vkWaitForFences(driver->context->device, 1, &cmd->fence, VK_TRUE, UINT64_MAX))
     memcpy(host_buffer, buffer->alloc_info.pMappedData, data_size);
 }
@@ -227,7 +148,7 @@ void vkapi_buffer_upload_vertex_data(
     vkapi_driver_t* driver,
     void* data,
     VkDeviceSize data_size,
-    uint32_t buffer_offset)
+    VkDeviceSize buffer_offset)
 {
     assert(dst_buffer);
     assert(driver);
@@ -242,7 +163,7 @@ void vkapi_buffer_upload_index_data(
     vkapi_driver_t* driver,
     void* data,
     VkDeviceSize data_size,
-    uint32_t buffer_offset)
+    VkDeviceSize buffer_offset)
 {
     assert(dst_buffer);
     assert(driver);
@@ -69,15 +69,6 @@ void vkapi_map_and_copy_to_gpu(
     VkBufferUsageFlags usage,
     void* data);
 
-void vkapi_copy_staged_to_gpu(
-    vkapi_driver_t* driver,
-    VkDeviceSize size,
-    vkapi_staging_instance_t* stage,
-    vkapi_buffer_t* dst_buffer,
-    uint32_t src_offset,
-    uint32_t dst_offset,
-    VkBufferUsageFlags usage);
-
 void vkapi_buffer_download_to_host(
     vkapi_buffer_t* buffer, vkapi_driver_t* driver, void* host_buffer, size_t data_size);
 
@@ -88,13 +79,13 @@ void vkapi_buffer_upload_vertex_data(
     vkapi_driver_t* driver,
     void* data,
     VkDeviceSize data_size,
-    uint32_t buffer_offset);
+    VkDeviceSize buffer_offset);
 
 void vkapi_buffer_upload_index_data(
     vkapi_buffer_t* dst_buffer,
     vkapi_driver_t* driver,
     void* data,
     VkDeviceSize data_size,
-    uint32_t buffer_offset);
+    VkDeviceSize buffer_offset);
 
 #endif
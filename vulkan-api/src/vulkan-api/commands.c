@@ -234,3 +234,100 @@ void vkapi_commands_set_ext_wait_signal(vkapi_commands_t* commands, VkSemaphore
     assert(commands->ext_signal_count < VKAPI_COMMANDS_MAX_EXTERNAL_SIGNAL_COUNT);
     commands->ext_signals[commands->ext_signal_count++] = s;
 }
+
+vkapi_secondary_cmds_t* vkapi_secondary_cmds_init(
+    vkapi_context_t* context, uint32_t queue_index, uint32_t worker_count, arena_t* arena)
+{
+    assert(context);
+    assert(worker_count > 0 && worker_count <= VKAPI_COMMANDS_MAX_WORKER_COUNT);
+
+    vkapi_secondary_cmds_t* s = ARENA_MAKE_ZERO_STRUCT(arena, vkapi_secondary_cmds_t);
+    s->worker_count = worker_count;
+
+    VkCommandPoolCreateInfo create_info = {0};
+    create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    create_info.queueFamilyIndex = queue_index;
+    create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    for (uint32_t frame = 0; frame < VKAPI_COMMANDS_SECONDARY_FRAMES; ++frame)
+    {
+        for (uint32_t i = 0; i < worker_count; ++i)
+        {
+            VK_CHECK_RESULT(vkCreateCommandPool(
+                context->device, &create_info, VK_NULL_HANDLE, &s->pools[frame][i].instance));
+        }
+    }
+    return s;
+}
+
+void vkapi_secondary_cmds_destroy(vkapi_context_t* context, vkapi_secondary_cmds_t* s)
+{
+    assert(s);
+    // Destroying the pool frees all command buffers allocated from it.
+    for (uint32_t frame = 0; frame < VKAPI_COMMANDS_SECONDARY_FRAMES; ++frame)
+    {
+        for (uint32_t i = 0; i < s->worker_count; ++i)
+        {
+            vkDestroyCommandPool(context->device, s->pools[frame][i].instance, VK_NULL_HANDLE);
+        }
+    }
+}
+
+void vkapi_secondary_cmds_begin_frame(
+    vkapi_context_t* context, vkapi_secondary_cmds_t* s, uint64_t frame)
+{
+    assert(s);
+    s->frame_idx = frame % VKAPI_COMMANDS_SECONDARY_FRAMES;
+    for (uint32_t i = 0; i < s->worker_count; ++i)
+    {
+        vkapi_secondary_pool_t* pool = &s->pools[s->frame_idx][i];
+        if (pool->used_count)
+        {
+            VK_CHECK_RESULT(vkResetCommandPool(context->device, pool->instance, 0));
+            pool->used_count = 0;
+        }
+    }
+}
+
+VkCommandBuffer vkapi_secondary_cmds_begin(
+    vkapi_context_t* context,
+    vkapi_secondary_cmds_t* s,
+    uint32_t worker_idx,
+    const VkCommandBufferInheritanceInfo* inherit_info)
+{
+    assert(s);
+    assert(inherit_info);
+    assert(worker_idx < s->worker_count);
+
+    vkapi_secondary_pool_t* pool = &s->pools[s->frame_idx][worker_idx];
+    assert(
+        pool->used_count < VKAPI_COMMANDS_MAX_SECONDARY_PER_POOL &&
+        "Secondary command buffer limit for this frame reached.");
+
+    // Command buffers are kept after the pool is reset, so are only allocated when the most
+    // buffers recorded in a frame by this worker has increased.
+    if (pool->used_count == pool->alloc_count)
+    {
+        VkCommandBufferAllocateInfo alloc_info = {0};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = pool->instance;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        alloc_info.commandBufferCount = 1;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(
+            context->device, &alloc_info, &pool->cmd_buffers[pool->alloc_count++]));
+    }
+    VkCommandBuffer cmds = pool->cmd_buffers[pool->used_count++];
+
+    VkCommandBufferBeginInfo begin_info = {0};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = inherit_info;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(cmds, &begin_info));
+    return cmds;
+}
+
+void vkapi_secondary_cmds_end(VkCommandBuffer cmds)
+{
+    assert(cmds);
+    VK_CHECK_RESULT(vkEndCommandBuffer(cmds));
+}
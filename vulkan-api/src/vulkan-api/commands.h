@@ -33,6 +33,13 @@
 // from the frame graph.
 #define VKAPI_MAX_COMMAND_BUFFER_SIZE 5
 #define VKAPI_COMMANDS_MAX_EXTERNAL_SIGNAL_COUNT 3
+/// The maximum number of threads which can record secondary command buffers.
+#define VKAPI_COMMANDS_MAX_WORKER_COUNT 32
+/// The number of secondary command buffers a worker can record each frame.
+#define VKAPI_COMMANDS_MAX_SECONDARY_PER_POOL 128
+/// Each frame records into its own set of pools, which are only reset once the GPU has finished
+/// with them - one more than the primary command buffers which can be in flight.
+#define VKAPI_COMMANDS_SECONDARY_FRAMES (VKAPI_MAX_COMMAND_BUFFER_SIZE + 1)
 
 // forward declarations
 typedef struct VkApiContext vkapi_context_t;
@@ -45,6 +52,29 @@ typedef struct CmdBuffer
 
 } vkapi_cmdbuffer_t;
 
+typedef struct SecondaryCmdPool
+{
+    VkCommandPool instance;
+    VkCommandBuffer cmd_buffers[VKAPI_COMMANDS_MAX_SECONDARY_PER_POOL];
+    /// The number of command buffers allocated from the pool - these are reused each frame.
+    uint32_t alloc_count;
+    /// The number of command buffers recorded this frame.
+    uint32_t used_count;
+} vkapi_secondary_pool_t;
+
+/**
+ Secondary command buffers recorded in parallel. Command pools can only be used by a single
+ thread at a time, so each worker has its own pool for each frame in flight. The pools are reset
+ wholesale at the start of the frame rather than freeing individual command buffers.
+ */
+typedef struct SecondaryCommands
+{
+    vkapi_secondary_pool_t pools[VKAPI_COMMANDS_SECONDARY_FRAMES][VKAPI_COMMANDS_MAX_WORKER_COUNT];
+    uint32_t worker_count;
+    /// The index of the pools being recorded into this frame.
+    uint32_t frame_idx;
+} vkapi_secondary_cmds_t;
+
 vkapi_commands_t* vkapi_commands_init(
     vkapi_context_t* context, uint32_t queue_index, VkQueue cmd_queue, arena_t* arena);
 
@@ -61,4 +91,31 @@ VkSemaphore vkapi_commands_get_finished_signal(vkapi_commands_t* commands);
 
 void vkapi_commands_set_ext_wait_signal(vkapi_commands_t* commands, VkSemaphore s);
 
+vkapi_secondary_cmds_t* vkapi_secondary_cmds_init(
+    vkapi_context_t* context, uint32_t queue_index, uint32_t worker_count, arena_t* arena);
+
+void vkapi_secondary_cmds_destroy(vkapi_context_t* context, vkapi_secondary_cmds_t* s);
+
+/**
+ Reset the pools for the frame. The pools were last used @sa VKAPI_COMMANDS_SECONDARY_FRAMES
+ frames ago, so the command buffers recorded from them are no longer in use by the GPU.
+ @param frame The current frame count.
+ */
+void vkapi_secondary_cmds_begin_frame(
+    vkapi_context_t* context, vkapi_secondary_cmds_t* s, uint64_t frame);
+
+/**
+ Begin recording a secondary command buffer which continues a render pass. Must only be called
+ from the thread which owns @p worker_idx.
+ @param inherit_info The render pass and framebuffer the command buffer will be executed within.
+ @returns A command buffer in the recording state.
+ */
+VkCommandBuffer vkapi_secondary_cmds_begin(
+    vkapi_context_t* context,
+    vkapi_secondary_cmds_t* s,
+    uint32_t worker_idx,
+    const VkCommandBufferInheritanceInfo* inherit_info);
+
+void vkapi_secondary_cmds_end(VkCommandBuffer cmds);
+
 #endif
\ No newline at end of file
@@ -137,6 +137,7 @@ vkapi_context_t* vkapi_context_init(arena_t* perm_arena)
     new_context->extensions.has_external_capabilities = false;
     new_context->extensions.has_multi_view = false;
     new_context->extensions.has_physical_dev_props2 = false;
+    new_context->extensions.has_pipeline_creation_feedback = false;
 
     new_context->instance = VK_NULL_HANDLE;
     new_context->physical = VK_NULL_HANDLE;
@@ -589,6 +590,13 @@ int vkapi_context_prepare_device(
     {
         req_extensions[ext_count++] = VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
     }
+    // Used to report whether pipelines were created from the pipeline cache.
+    if (vkapi_find_ext_props(
+            VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME, dev_ext_prop_arr, dev_ext_prop_count))
+    {
+        req_extensions[ext_count++] = VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+        context->extensions.has_pipeline_creation_feedback = true;
+    }
 
     VkDeviceCreateInfo create_info = {0};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -57,6 +57,7 @@ typedef struct VkApiContext
         bool has_external_capabilities;
         bool has_debug_utils;
         bool has_multi_view;
+        bool has_pipeline_creation_feedback;
     } extensions;
 
     VkInstance instance;
@@ -0,0 +1,204 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "descriptor_allocator.h"
+
+#include <string.h>
+
+void vkapi_desc_alloc_init(
+    vkapi_desc_allocator_t* a, vkapi_desc_pool_funcs_t* funcs, void* user_data, arena_t* arena)
+{
+    assert(a);
+    assert(funcs);
+    assert(funcs->create_pool && funcs->reset_pool && funcs->destroy_pool);
+    assert(funcs->allocate_sets);
+    memset(a, 0, sizeof(vkapi_desc_allocator_t));
+    a->funcs = *funcs;
+    a->user_data = user_data;
+    a->current_pool = UINT32_MAX;
+    MAKE_DYN_ARRAY(vkapi_desc_pool_t, arena, 10, &a->pools);
+    a->set_cache = HASH_MAP_CREATE(uint64_t, vkapi_desc_alloc_entry_t, arena);
+}
+
+void _desc_alloc_reset_pool(vkapi_desc_allocator_t* a, uint32_t pool_idx)
+{
+    vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, pool_idx);
+    a->funcs.reset_pool(a->user_data, p->instance);
+    p->state = VKAPI_DESC_POOL_FREE;
+    p->set_count = 0;
+    p->generation++;
+    a->stats.pool_reset_count++;
+
+    // Remove the cached sets from this pool - the generation check would catch these but they
+    // would otherwise remain in the cache until the same contents are requested.
+    hash_map_iterator_t it = hash_map_iter_create(&a->set_cache);
+    for (;;)
+    {
+        vkapi_desc_alloc_entry_t* e = hash_map_iter_next(&it);
+        if (!e)
+        {
+            break;
+        }
+        if (e->pool_idx == pool_idx)
+        {
+            hash_map_iter_erase(&it);
+        }
+    }
+}
+
+void _desc_alloc_close_current(vkapi_desc_allocator_t* a, enum DescriptorPoolState state)
+{
+    if (a->current_pool == UINT32_MAX)
+    {
+        return;
+    }
+    vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, a->current_pool);
+    p->state = state;
+    a->current_pool = UINT32_MAX;
+}
+
+uint32_t _desc_alloc_open_pool(vkapi_desc_allocator_t* a)
+{
+    // Reuse a reset pool if one is available, otherwise create a new one.
+    uint32_t idx = UINT32_MAX;
+    for (uint32_t i = 0; i < a->pools.size; ++i)
+    {
+        vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, i);
+        if (p->state == VKAPI_DESC_POOL_FREE)
+        {
+            idx = i;
+            break;
+        }
+    }
+    if (idx == UINT32_MAX)
+    {
+        vkapi_desc_pool_t new_pool = {.instance = a->funcs.create_pool(a->user_data)};
+        assert(new_pool.instance);
+        idx = a->pools.size;
+        DYN_ARRAY_APPEND(&a->pools, &new_pool);
+    }
+
+    vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, idx);
+    p->state = VKAPI_DESC_POOL_OPEN;
+    p->open_frame = a->current_frame;
+    p->last_used_frame = a->current_frame;
+    a->current_pool = idx;
+    return idx;
+}
+
+void vkapi_desc_alloc_begin_frame(vkapi_desc_allocator_t* a, uint64_t current_frame)
+{
+    assert(a);
+    a->current_frame = current_frame;
+    a->last_frame_stats = a->stats;
+    memset(&a->stats, 0, sizeof(vkapi_desc_alloc_stats_t));
+
+    for (uint32_t i = 0; i < a->pools.size; ++i)
+    {
+        vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, i);
+        if (p->state == VKAPI_DESC_POOL_FREE)
+        {
+            continue;
+        }
+        if (p->state != VKAPI_DESC_POOL_RETIRED &&
+            p->open_frame + VKAPI_DESC_ALLOC_MAX_POOL_AGE <= current_frame)
+        {
+            if (i == a->current_pool)
+            {
+                a->current_pool = UINT32_MAX;
+            }
+            p->state = VKAPI_DESC_POOL_RETIRED;
+        }
+        if (p->state == VKAPI_DESC_POOL_RETIRED &&
+            p->last_used_frame + VKAPI_DESC_ALLOC_FRAMES_IN_FLIGHT < current_frame)
+        {
+            _desc_alloc_reset_pool(a, i);
+        }
+    }
+}
+
+bool vkapi_desc_alloc_get(
+    vkapi_desc_allocator_t* a, uint64_t content_hash, void* params, VkDescriptorSet* out_sets)
+{
+    assert(a);
+    assert(out_sets);
+    a->stats.lookup_count++;
+
+    vkapi_desc_alloc_entry_t* e = HASH_MAP_GET(&a->set_cache, &content_hash);
+    if (e)
+    {
+        vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, e->pool_idx);
+        if (p->generation == e->pool_generation && p->state != VKAPI_DESC_POOL_RETIRED)
+        {
+            p->last_used_frame = a->current_frame;
+            memcpy(out_sets, e->desc_sets, sizeof(e->desc_sets));
+            a->stats.hit_count++;
+            return true;
+        }
+    }
+
+    // Allocate from the open pool. If the pool is out of space, it's closed and another pool is
+    // opened - the sets in the old pool can still be reused.
+    vkapi_desc_alloc_entry_t new_entry = {0};
+    for (int attempt = 0;; ++attempt)
+    {
+        uint32_t idx =
+            a->current_pool == UINT32_MAX ? _desc_alloc_open_pool(a) : a->current_pool;
+        vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, idx);
+        if (p->set_count < VKAPI_DESC_ALLOC_POOL_SET_COUNT &&
+            a->funcs.allocate_sets(a->user_data, p->instance, params, new_entry.desc_sets))
+        {
+            p->set_count++;
+            p->last_used_frame = a->current_frame;
+            new_entry.pool_idx = idx;
+            new_entry.pool_generation = p->generation;
+            break;
+        }
+        // A newly opened pool should always have space.
+        assert(attempt == 0 && "Unable to allocate descriptor sets from a new pool.");
+        _desc_alloc_close_current(a, VKAPI_DESC_POOL_FULL);
+    }
+
+    HASH_MAP_SET(&a->set_cache, &content_hash, &new_entry);
+    memcpy(out_sets, new_entry.desc_sets, sizeof(new_entry.desc_sets));
+    a->stats.write_count++;
+    return false;
+}
+
+float vkapi_desc_alloc_hit_rate(vkapi_desc_alloc_stats_t* stats)
+{
+    assert(stats);
+    return stats->lookup_count ? (float)stats->hit_count / (float)stats->lookup_count : 0.0f;
+}
+
+void vkapi_desc_alloc_destroy(vkapi_desc_allocator_t* a)
+{
+    assert(a);
+    for (uint32_t i = 0; i < a->pools.size; ++i)
+    {
+        vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a->pools, i);
+        a->funcs.destroy_pool(a->user_data, p->instance);
+    }
+    dyn_array_clear(&a->pools);
+    hash_map_clear(&a->set_cache);
+    a->current_pool = UINT32_MAX;
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_DESCRIPTOR_ALLOCATOR_H__
+#define __VKAPI_DESCRIPTOR_ALLOCATOR_H__
+
+#include "commands.h"
+#include "common.h"
+#include "descriptor_cache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utility/arena.h>
+#include <utility/hash_map.h>
+
+/// The number of set groups (one set per layout) which can be allocated from a single pool.
+#define VKAPI_DESC_ALLOC_POOL_SET_COUNT 512
+/// The number of frames a pool is used for, after which its sets are no longer reused and it is
+/// reset once the GPU has finished with it. This bounds how long a hot set can keep a pool alive.
+#define VKAPI_DESC_ALLOC_MAX_POOL_AGE 8
+/// The number of frames before a pool's sets are no longer in use by the GPU.
+#define VKAPI_DESC_ALLOC_FRAMES_IN_FLIGHT VKAPI_MAX_COMMAND_BUFFER_SIZE
+
+/**
+ The device calls made by the allocator. These are separated out so the allocation and reuse policy
+ can be tested without a device.
+ */
+typedef struct DescriptorPoolFuncs
+{
+    VkDescriptorPool (*create_pool)(void* user_data);
+    void (*reset_pool)(void* user_data, VkDescriptorPool pool);
+    void (*destroy_pool)(void* user_data, VkDescriptorPool pool);
+    /**
+     Allocate a set for each layout from the pool.
+     @param params Passed through from @sa vkapi_desc_alloc_get.
+     @return false if the pool doesn't have enough space remaining.
+     */
+    bool (*allocate_sets)(
+        void* user_data, VkDescriptorPool pool, void* params, VkDescriptorSet* out_sets);
+} vkapi_desc_pool_funcs_t;
+
+enum DescriptorPoolState
+{
+    VKAPI_DESC_POOL_FREE,
+    /// The pool sets are allocated from.
+    VKAPI_DESC_POOL_OPEN,
+    /// No more sets can be allocated, but the existing sets can be reused.
+    VKAPI_DESC_POOL_FULL,
+    /// The pool sets are no longer reused - waiting for the GPU to finish with them.
+    VKAPI_DESC_POOL_RETIRED
+};
+
+typedef struct DescriptorPoolInfo
+{
+    VkDescriptorPool instance;
+    enum DescriptorPoolState state;
+    uint32_t set_count;
+    /// Incremented each time the pool is reset, which invalidates all cached sets from the pool.
+    uint32_t generation;
+    uint64_t open_frame;
+    uint64_t last_used_frame;
+} vkapi_desc_pool_t;
+
+typedef struct DescriptorAllocEntry
+{
+    VkDescriptorSet desc_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    uint32_t pool_idx;
+    uint32_t pool_generation;
+} vkapi_desc_alloc_entry_t;
+
+typedef struct DescriptorAllocStats
+{
+    uint32_t lookup_count;
+    /// Lookups which reused a set with identical contents.
+    uint32_t hit_count;
+    /// Set groups allocated which the caller must write.
+    uint32_t write_count;
+    uint32_t pool_reset_count;
+} vkapi_desc_alloc_stats_t;
+
+/**
+ A linear descriptor set allocator. Sets are allocated from a pool for a number of frames, and are
+ never freed individually - instead the pool is reset wholesale once it has retired and the
+ frames using it have completed. Reset pools are reused, so the pools form a ring.
+ Sets are cached by a hash of their contents, so identical bindings within a frame or across
+ frames reuse the same set rather than allocating and writing a new one.
+ */
+typedef struct DescriptorAllocator
+{
+    vkapi_desc_pool_funcs_t funcs;
+    void* user_data;
+    arena_dyn_array_t pools;
+    /// Index of the open pool, or UINT32_MAX if no pool is open.
+    uint32_t current_pool;
+    /// Content hash -> vkapi_desc_alloc_entry_t.
+    hash_map_t set_cache;
+    uint64_t current_frame;
+    /// Counts for the current frame.
+    vkapi_desc_alloc_stats_t stats;
+    /// Counts for the last completed frame.
+    vkapi_desc_alloc_stats_t last_frame_stats;
+} vkapi_desc_allocator_t;
+
+void vkapi_desc_alloc_init(
+    vkapi_desc_allocator_t* a, vkapi_desc_pool_funcs_t* funcs, void* user_data, arena_t* arena);
+
+/**
+ Retire pools which have reached their age and reset those which are no longer in use.
+ */
+void vkapi_desc_alloc_begin_frame(vkapi_desc_allocator_t* a, uint64_t current_frame);
+
+/**
+ Get a set group for the given contents.
+ @param content_hash A hash of everything written to the sets, including their layouts.
+ @param params Passed to the allocate_sets function if new sets are required.
+ @param out_sets Filled with a set for each layout.
+ @return true if existing sets with the same contents were found. Otherwise new sets were
+ allocated which must be written by the caller.
+ */
+bool vkapi_desc_alloc_get(
+    vkapi_desc_allocator_t* a, uint64_t content_hash, void* params, VkDescriptorSet* out_sets);
+
+/**
+ @return The ratio of lookups which reused an existing set, or zero if there were no lookups.
+ */
+float vkapi_desc_alloc_hit_rate(vkapi_desc_alloc_stats_t* stats);
+
+void vkapi_desc_alloc_destroy(vkapi_desc_allocator_t* a);
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "descriptor_cache.h"
 
+#include "descriptor_allocator.h"
 #include "driver.h"
 #include "pipeline_cache.h"
 #include "program_manager.h"
@@ -31,16 +32,108 @@
 #include <string.h>
 #include <utility/hash.h>
 
+// The number of sets using bindless samplers that can be allocated from a single pool.
+#define VKAPI_DESC_CACHE_MAX_BINDLESS_SETS_PER_POOL 4
+
+VkDescriptorPool _desc_cache_create_pool(void* user_data)
+{
+    vkapi_desc_cache_t* c = user_data;
+    VkDescriptorPoolSize pools[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+
+    uint32_t set_count = VKAPI_DESC_ALLOC_POOL_SET_COUNT;
+    pools[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pools[0].descriptorCount = set_count * VKAPI_PIPELINE_MAX_UBO_BIND_COUNT;
+    pools[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    pools[1].descriptorCount = set_count * VKAPI_PIPELINE_MAX_DYNAMIC_UBO_BIND_COUNT;
+    // Bindless sets take a large number of samplers, so only a few of these are allowed per pool -
+    // the allocator opens a new pool when exhausted.
+    pools[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pools[2].descriptorCount =
+        VKAPI_PIPELINE_MAX_SAMPLER_BINDLESS_COUNT * VKAPI_DESC_CACHE_MAX_BINDLESS_SETS_PER_POOL +
+        set_count * VKAPI_PIPELINE_MAX_SAMPLER_BIND_COUNT;
+    pools[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pools[3].descriptorCount = set_count * VKAPI_PIPELINE_MAX_SSBO_BIND_COUNT;
+    pools[4].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pools[4].descriptorCount = set_count * VKAPI_PIPELINE_MAX_STORAGE_IMAGE_BOUND_COUNT;
+
+    // Sets are never freed individually - the whole pool is reset.
+    VkDescriptorPoolCreateInfo ci = {0};
+    ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    ci.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    ci.maxSets = set_count * VKAPI_PIPELINE_MAX_DESC_SET_COUNT;
+    ci.poolSizeCount = VKAPI_PIPELINE_MAX_DESC_SET_COUNT;
+    ci.pPoolSizes = pools;
+
+    VkDescriptorPool pool;
+    VK_CHECK_RESULT(vkCreateDescriptorPool(c->driver->context->device, &ci, VK_NULL_HANDLE, &pool))
+    return pool;
+}
+
+void _desc_cache_reset_pool(void* user_data, VkDescriptorPool pool)
+{
+    vkapi_desc_cache_t* c = user_data;
+    VK_CHECK_RESULT(vkResetDescriptorPool(c->driver->context->device, pool, 0))
+}
+
+void _desc_cache_destroy_pool(void* user_data, VkDescriptorPool pool)
+{
+    vkapi_desc_cache_t* c = user_data;
+    vkDestroyDescriptorPool(c->driver->context->device, pool, VK_NULL_HANDLE);
+}
+
+bool _desc_cache_allocate_sets(
+    void* user_data, VkDescriptorPool pool, void* params, VkDescriptorSet* out_sets)
+{
+    vkapi_desc_cache_t* c = user_data;
+    shader_prog_bundle_t* bundle = params;
+
+    // Needed for the bindless samplers - we specify the number of samplers now which will
+    // be all those held by the resource cache.
+    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT ext_info = {0};
+    uint32_t variable_count = VKAPI_PIPELINE_MAX_SAMPLER_BINDLESS_COUNT;
+
+    // Create a descriptor set for each layout.
+    VkDescriptorSetAllocateInfo ai = {0};
+    ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    ai.descriptorPool = pool;
+
+    for (int i = 0; i < VKAPI_PIPELINE_MAX_DESC_SET_COUNT; ++i)
+    {
+        ai.pNext = VK_NULL_HANDLE;
+        ai.pSetLayouts = &bundle->desc_layouts[i];
+        ai.descriptorSetCount = 1;
+        if (i == VKAPI_PIPELINE_SAMPLER_SET_VALUE && !bundle->use_bound_samplers &&
+            bundle->desc_binding_counts[VKAPI_PIPELINE_SAMPLER_SET_VALUE] > 0)
+        {
+            ext_info.sType =
+                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
+            ext_info.descriptorSetCount = 1;
+            ext_info.pDescriptorCounts = &variable_count;
+            ai.pNext = &ext_info;
+        }
+        VkResult res = vkAllocateDescriptorSets(c->driver->context->device, &ai, &out_sets[i]);
+        if (res == VK_ERROR_OUT_OF_POOL_MEMORY || res == VK_ERROR_FRAGMENTED_POOL)
+        {
+            // Any sets already allocated are reclaimed when the pool is reset.
+            return false;
+        }
+        VK_CHECK_RESULT(res)
+    }
+    return true;
+}
+
 vkapi_desc_cache_t* vkapi_desc_cache_init(vkapi_driver_t* driver, arena_t* arena)
 {
     vkapi_desc_cache_t* c = ARENA_MAKE_ZERO_STRUCT(arena, vkapi_desc_cache_t);
     c->driver = driver;
-    c->current_desc_pool_size = 1000;
 
-    vkapi_desc_cache_create_pool(c);
-    c->descriptor_sets = HASH_SET_CREATE(desc_key_t, vkapi_desc_set_t, arena);
-    MAKE_DYN_ARRAY(vkapi_desc_set_t, arena, 100, &c->desc_sets_for_deletion);
-    MAKE_DYN_ARRAY(VkDescriptorPool, arena, 100, &c->desc_pools_for_deletion);
+    vkapi_desc_pool_funcs_t funcs = {
+        .create_pool = _desc_cache_create_pool,
+        .reset_pool = _desc_cache_reset_pool,
+        .destroy_pool = _desc_cache_destroy_pool,
+        .allocate_sets = _desc_cache_allocate_sets};
+    c->allocator = ARENA_MAKE_STRUCT(arena, vkapi_desc_allocator_t, ARENA_ZERO_MEMORY);
+    vkapi_desc_alloc_init(c->allocator, &funcs, c, arena);
 
     return c;
 }
@@ -63,28 +156,38 @@ void vkapi_desc_cache_bind_descriptors(
     VkPipelineBindPoint bind_point,
     bool force_rebind)
 {
+    // The key hash is computed once and used for both the redundancy check and the cache lookup.
+    // A texture slot may be reused by a recreated texture with the same handles, and bindless
+    // samplers reference all the textures held by the resource cache, so the texture generation
+    // is part of the key.
+    uint32_t tex_generation = c->driver->res_cache->tex_generation;
+    uint64_t key_hash = murmur2_hash64(&c->desc_requires, sizeof(desc_key_t), tex_generation);
+    if (key_hash == HASH_NULL || key_hash == HASH_DELETED)
+    {
+        key_hash = 1;
+    }
+    // Sets must be rebound if the layout or bind point changes, even if the sets are the same.
+    uint64_t bind_hash = murmur2_hash64(&layout, sizeof(VkPipelineLayout), key_hash ^ bind_point);
+    bind_hash = bind_hash ? bind_hash : 1;
+
     // Check if the required descriptor set is already bound. If so, nothing to
     // do here.
-    if (vkapi_desc_cache_compare_desc_keys(&c->desc_requires, &c->bound_desc) && !force_rebind)
+    if (!vkapi_pl_state_requires_desc_bind(&c->driver->pl_state, bind_hash, force_rebind))
     {
-        vkapi_desc_set_t* s = HASH_SET_GET(&c->descriptor_sets, &c->bound_desc);
-        s->frame_last_used = c->driver->current_frame;
         vkapi_desc_cache_reset_keys(c);
         return;
     }
 
-    vkapi_desc_set_t* s = HASH_SET_GET(&c->descriptor_sets, &c->desc_requires);
-    if (s)
-    {
-        s->frame_last_used = c->driver->current_frame;
-    }
-    else
+    // The sets are cached by their contents, which includes the layouts they were allocated with.
+    uint64_t content_hash = murmur2_hash64(
+        bundle->desc_layouts,
+        sizeof(VkDescriptorSetLayout) * VKAPI_PIPELINE_MAX_DESC_SET_COUNT,
+        key_hash);
+
+    VkDescriptorSet desc_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    if (!vkapi_desc_alloc_get(c->allocator, content_hash, bundle, desc_sets))
     {
-        // Create a new descriptor set if no cached set matches the requirements.
-        vkapi_desc_set_t new_set = vkapi_desc_cache_create_desc_sets(c, bundle);
-        new_set.frame_last_used = c->driver->current_frame;
-        s = HASH_SET_INSERT(&c->descriptor_sets, &c->desc_requires, &new_set);
-        assert(s);
+        vkapi_desc_cache_write_desc_sets(c, bundle, desc_sets);
     }
 
     vkCmdBindDescriptorSets(
@@ -93,11 +196,11 @@ void vkapi_desc_cache_bind_descriptors(
         layout,
         0,
         VKAPI_PIPELINE_MAX_DESC_SET_COUNT,
-        s->desc_sets,
+        desc_sets,
         0,
         VK_NULL_HANDLE);
 
-    c->bound_desc = c->desc_requires;
+    vkapi_pl_state_set_desc_bound(&c->driver->pl_state, bind_hash);
     vkapi_desc_cache_reset_keys(c);
 }
 
@@ -148,50 +251,12 @@ void vkapi_desc_cache_bind_ssbo(
     c->desc_requires.ssbo_buffer_sizes[bind_value] = size;
 }
 
-vkapi_desc_set_t
-vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* bundle)
+void vkapi_desc_cache_write_desc_sets(
+    vkapi_desc_cache_t* c, shader_prog_bundle_t* bundle, VkDescriptorSet* desc_sets)
 {
     assert(c);
     assert(bundle);
-
-    vkapi_desc_set_t ds = {0};
-    memcpy(
-        ds.layout,
-        bundle->desc_layouts,
-        sizeof(VkDescriptorSetLayout) * VKAPI_PIPELINE_MAX_DESC_SET_COUNT);
-
-    if (c->descriptor_sets.size * VKAPI_PIPELINE_MAX_DESC_SET_COUNT > c->current_desc_pool_size)
-    {
-        vkapi_desc_cache_increase_pool_capacity(c);
-    }
-
-    // Needed for the bindless samplers - we specify the number of samplers now which will
-    // be all those held by the resource cache.
-    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT ext_info = {0};
-    uint32_t variable_count = VKAPI_PIPELINE_MAX_SAMPLER_BINDLESS_COUNT;
-
-    // Create a descriptor set for each layout.
-    VkDescriptorSetAllocateInfo ai = {0};
-    ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    ai.descriptorPool = c->descriptor_pool;
-
-    for (int i = 0; i < VKAPI_PIPELINE_MAX_DESC_SET_COUNT; ++i)
-    {
-        ai.pNext = VK_NULL_HANDLE;
-        ai.pSetLayouts = &ds.layout[i];
-        ai.descriptorSetCount = 1;
-        if (i == VKAPI_PIPELINE_SAMPLER_SET_VALUE && !bundle->use_bound_samplers &&
-            bundle->desc_binding_counts[VKAPI_PIPELINE_SAMPLER_SET_VALUE] > 0)
-        {
-            ext_info.sType =
-                VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
-            ext_info.descriptorSetCount = 1;
-            ext_info.pDescriptorCounts = &variable_count;
-            ai.pNext = &ext_info;
-        }
-        VK_CHECK_RESULT(
-            vkAllocateDescriptorSets(c->driver->context->device, &ai, &ds.desc_sets[i]));
-    }
+    assert(desc_sets);
 
     // Update the descriptor sets for each type (buffer, sampler, attachment).
     VkWriteDescriptorSet write_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT * 6] = {};
@@ -215,7 +280,7 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
 
             VkWriteDescriptorSet* ws = &write_sets[write_set_count++];
             ws->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            ws->dstSet = ds.desc_sets[VKAPI_PIPELINE_UBO_SET_VALUE];
+            ws->dstSet = desc_sets[VKAPI_PIPELINE_UBO_SET_VALUE];
             ws->pBufferInfo = bi;
             ws->descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             ws->dstBinding = bind;
@@ -234,7 +299,7 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
 
             VkWriteDescriptorSet* ws = &write_sets[write_set_count++];
             ws->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            ws->dstSet = ds.desc_sets[VKAPI_PIPELINE_SSBO_SET_VALUE];
+            ws->dstSet = desc_sets[VKAPI_PIPELINE_SSBO_SET_VALUE];
             ws->pBufferInfo = bi;
             ws->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
             ws->dstBinding = bind;
@@ -259,7 +324,7 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
 
                     VkWriteDescriptorSet* ws = &write_sets[write_set_count++];
                     ws->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                    ws->dstSet = ds.desc_sets[VKAPI_PIPELINE_SAMPLER_SET_VALUE];
+                    ws->dstSet = desc_sets[VKAPI_PIPELINE_SAMPLER_SET_VALUE];
                     ws->pImageInfo = ii;
                     ws->descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
                     ws->dstBinding = bind;
@@ -294,7 +359,7 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
             {
                 VkWriteDescriptorSet* ws = &write_sets[write_set_count++];
                 ws->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                ws->dstSet = ds.desc_sets[VKAPI_PIPELINE_SAMPLER_SET_VALUE];
+                ws->dstSet = desc_sets[VKAPI_PIPELINE_SAMPLER_SET_VALUE];
                 ws->pImageInfo = ii;
                 ws->descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
                 // There is a mandatory bind value of zero for bindless textures.
@@ -316,7 +381,7 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
 
             VkWriteDescriptorSet* ws = &write_sets[write_set_count++];
             ws->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            ws->dstSet = ds.desc_sets[VKAPI_PIPELINE_STORAGE_IMAGE_SET_VALUE];
+            ws->dstSet = desc_sets[VKAPI_PIPELINE_STORAGE_IMAGE_SET_VALUE];
             ws->pImageInfo = ii;
             ws->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
             ws->dstBinding = bind;
@@ -328,58 +393,6 @@ vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* b
         c->driver->context->device, write_set_count, write_sets, 0, VK_NULL_HANDLE);
 
     arena_reset(&c->driver->_scratch_arena);
-    return ds;
-}
-
-void vkapi_desc_cache_create_pool(vkapi_desc_cache_t* c)
-{
-    VkDescriptorPoolSize pools[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
-
-    pools[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    pools[0].descriptorCount = c->current_desc_pool_size * VKAPI_PIPELINE_MAX_UBO_BIND_COUNT;
-    pools[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    pools[1].descriptorCount =
-        c->current_desc_pool_size * VKAPI_PIPELINE_MAX_DYNAMIC_UBO_BIND_COUNT;
-    // We over allocate by quite a margin if using bond samplers.
-    pools[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    pools[2].descriptorCount = VKAPI_PIPELINE_MAX_SAMPLER_BINDLESS_COUNT;
-    pools[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    pools[3].descriptorCount = c->current_desc_pool_size * VKAPI_PIPELINE_MAX_SSBO_BIND_COUNT;
-    pools[4].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    pools[4].descriptorCount =
-        c->current_desc_pool_size * VKAPI_PIPELINE_MAX_STORAGE_IMAGE_BOUND_COUNT;
-
-    VkDescriptorPoolCreateInfo ci = {0};
-    ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    ci.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT |
-        VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    ci.maxSets = c->current_desc_pool_size * VKAPI_PIPELINE_MAX_DESC_SET_COUNT;
-    ci.poolSizeCount = VKAPI_PIPELINE_MAX_DESC_SET_COUNT;
-    ci.pPoolSizes = pools;
-    VK_CHECK_RESULT(vkCreateDescriptorPool(
-        c->driver->context->device, &ci, VK_NULL_HANDLE, &c->descriptor_pool))
-}
-
-void vkapi_desc_cache_increase_pool_capacity(vkapi_desc_cache_t* c)
-{
-    assert(c);
-    DYN_ARRAY_APPEND(&c->desc_pools_for_deletion, &c->descriptor_pool);
-
-    // Schedule all descriptor sets associated with this pool for deletion as well.
-    hash_set_iterator_t it = hash_set_iter_create(&c->descriptor_sets);
-    for (;;)
-    {
-        vkapi_desc_set_t* set = hash_set_iter_next(&it);
-        if (!set)
-        {
-            break;
-        }
-        DYN_ARRAY_APPEND(&c->desc_sets_for_deletion, set);
-    }
-    hash_set_clear(&c->descriptor_sets);
-
-    c->current_desc_pool_size *= 2;
-    vkapi_desc_cache_create_pool(c);
 }
 
 void vkapi_desc_cache_create_pl_layouts(vkapi_driver_t* driver, shader_prog_bundle_t* bundle)
@@ -416,84 +429,15 @@ void vkapi_desc_cache_create_pl_layouts(vkapi_driver_t* driver, shader_prog_bund
     }
 }
 
-void vkapi_desc_cache_gc(vkapi_desc_cache_t* c, uint64_t current_frame)
+void vkapi_desc_cache_begin_frame(vkapi_desc_cache_t* c, uint64_t current_frame)
 {
     assert(c);
-
-    // Destroy any descriptor sets that have reached there lifetime after their last
-    // use.
-    // TODO: we really should be deleting the pipeline layout associated with
-    // these sets too.
-    hash_set_iterator_t it = hash_set_iter_create(&c->descriptor_sets);
-    for (;;)
-    {
-        vkapi_desc_set_t* set = hash_set_iter_next(&it);
-        if (!set)
-        {
-            break;
-        }
-
-        uint64_t collection_frame = set->frame_last_used + VKAPI_PIPELINE_LIFETIME_FRAME_COUNT;
-        if (collection_frame < current_frame)
-        {
-            for (int i = 0; i < VKAPI_PIPELINE_MAX_DESC_SET_COUNT; ++i)
-            {
-                if (set->layout[i])
-                {
-                    // TODO: we cant destroy the set layouts as they are used
-                    // by pipelinelayouts and doing so results in a crash
-                    // So need to add a ref to the pipeline layout when creating
-                    // the desc sets and delete everything.
-                    // context_.device().destroy(info.layout[i]);
-                }
-            }
-            vkFreeDescriptorSets(
-                c->driver->context->device,
-                c->descriptor_pool,
-                VKAPI_PIPELINE_MAX_DESC_SET_COUNT,
-                set->desc_sets);
-            it = hash_set_iter_erase(&it);
-        }
-    }
-
-    // remove stale sets and pools
-    if (c->desc_sets_for_deletion.size)
-    {
-        vkapi_desc_set_t* set = DYN_ARRAY_GET_PTR(vkapi_desc_set_t, &c->desc_sets_for_deletion, 0);
-        uint64_t collection_frame = set->frame_last_used + VKAPI_PIPELINE_LIFETIME_FRAME_COUNT;
-        if (collection_frame < current_frame)
-        {
-            for (size_t i = 0; i < c->desc_pools_for_deletion.size; ++i)
-            {
-                VkDescriptorPool pool =
-                    DYN_ARRAY_GET(VkDescriptorPool, &c->desc_pools_for_deletion, i);
-                vkDestroyDescriptorPool(c->driver->context->device, pool, VK_NULL_HANDLE);
-            }
-        }
-    }
+    vkapi_desc_alloc_begin_frame(c->allocator, current_frame);
 }
 
 void vkapi_desc_cache_destroy(vkapi_desc_cache_t* c)
 {
     assert(c);
-
-    // Destroy all descriptor sets and layouts associated with this cache.
-    hash_set_iterator_t it = hash_set_iter_create(&c->descriptor_sets);
-    for (;;)
-    {
-        vkapi_desc_set_t* set = hash_set_iter_next(&it);
-        if (!set)
-        {
-            break;
-        }
-        vkFreeDescriptorSets(
-            c->driver->context->device,
-            c->descriptor_pool,
-            VKAPI_PIPELINE_MAX_DESC_SET_COUNT,
-            set->desc_sets);
-    }
-    hash_set_clear(&c->descriptor_sets);
-
-    // Destroy the descriptor pool.
-    vkDestroyDescriptorPool(c->driver->context->device, c->descriptor_pool, VK_NULL_HANDLE);
+    // Destroying the pools frees all sets allocated from them.
+    vkapi_desc_alloc_destroy(c->allocator);
 }
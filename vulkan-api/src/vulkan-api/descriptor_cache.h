@@ -68,34 +68,15 @@ typedef struct DescriptorKey
     struct DescriptorImage storage_images[VKAPI_PIPELINE_MAX_STORAGE_IMAGE_BOUND_COUNT];
 } desc_key_t;
 
-typedef struct DescriptorSetInfo
-{
-    VkDescriptorSetLayout layout[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
-    VkDescriptorSet desc_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
-    uint64_t frame_last_used;
-} vkapi_desc_set_t;
+typedef struct DescriptorAllocator vkapi_desc_allocator_t;
 
 typedef struct DescriptorCache
 {
     vkapi_driver_t* driver;
-    hash_set_t descriptor_sets;
     desc_key_t desc_requires;
-    /// current bound descriptor
-    desc_key_t bound_desc;
-    /// the main descriptor pool
-    VkDescriptorPool descriptor_pool;
-    uint32_t current_desc_pool_size;
-
-    /// A pool of descriptor sets for each descriptor type.
-    /// Reference to these sets are also stored in the cache - so
-    /// the cached descriptor sets must be cleared if destroying the
-    /// the sets stored in this pool.
-    VkDescriptorSet desc_set_pool[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
-
-    // containers for storing pools and sets that are
-    // waiting to be destroyed once they reach their lifetime.
-    arena_dyn_array_t desc_pools_for_deletion;
-    arena_dyn_array_t desc_sets_for_deletion;
+    /// Descriptor sets are allocated linearly from a ring of pools and reused based on their
+    /// contents.
+    vkapi_desc_allocator_t* allocator;
 
 } vkapi_desc_cache_t;
 
@@ -118,14 +99,10 @@ void vkapi_desc_cache_bind_ubo_dynamic(
 void vkapi_desc_cache_bind_ssbo(
     vkapi_desc_cache_t* c, uint8_t bind_value, VkBuffer buffer, uint32_t size);
 
-vkapi_desc_set_t
-vkapi_desc_cache_create_desc_sets(vkapi_desc_cache_t* c, shader_prog_bundle_t* bundle);
-
-void vkapi_desc_cache_create_pool(vkapi_desc_cache_t* c);
-
-void vkapi_desc_cache_increase_pool_capacity(vkapi_desc_cache_t* c);
+void vkapi_desc_cache_write_desc_sets(
+    vkapi_desc_cache_t* c, shader_prog_bundle_t* bundle, VkDescriptorSet* desc_sets);
 
-void vkapi_desc_cache_gc(vkapi_desc_cache_t* c, uint64_t current_frame);
+void vkapi_desc_cache_begin_frame(vkapi_desc_cache_t* c, uint64_t current_frame);
 void vkapi_desc_cache_destroy(vkapi_desc_cache_t* c);
 
 void vkapi_desc_cache_create_pl_layouts(vkapi_driver_t* driver, shader_prog_bundle_t* bundle);
@@ -35,6 +35,10 @@
 #include <string.h>
 #include <utility/maths.h>
 
+// The secondary command buffer being recorded on this thread, if any. Draw state and draw calls
+// are recorded into this rather than the graphics primary.
+static RPE_THREAD_LOCAL VkCommandBuffer tls_secondary_cmds = VK_NULL_HANDLE;
+
 vkapi_driver_t* vkapi_driver_init(const char** instance_ext, uint32_t ext_count, int* error_code)
 {
     // RENDERDOC_CREATE_API_INSTANCE
@@ -93,6 +97,11 @@ int vkapi_driver_create_device(vkapi_driver_t* driver, VkSurfaceKHR surface)
         driver->context->queue_info.compute,
         driver->context->compute_queue,
         &driver->_perm_arena);
+    driver->transfer_commands = vkapi_commands_init(
+        driver->context,
+        driver->context->queue_info.graphics,
+        driver->context->graphics_queue,
+        &driver->_perm_arena);
 
     // set up the memory allocator
     VmaVulkanFunctions vk_funcs = {0};
@@ -115,9 +124,18 @@ int vkapi_driver_create_device(vkapi_driver_t* driver, VkSurfaceKHR surface)
         driver->context->device, &sp_create_info, VK_NULL_HANDLE, &driver->image_ready_signal))
 
     // The staging pool is needed by some of the other caches so init first.
-    driver->staging_pool = vkapi_staging_init(&driver->_perm_arena);
+    driver->staging_pool =
+        vkapi_staging_init(driver->context, driver->vma_allocator, &driver->_perm_arena);
+    vkapi_upload_batch_init(&driver->uploads, &driver->_perm_arena);
     driver->prog_manager = program_cache_init(&driver->_perm_arena);
     driver->framebuffer_cache = vkapi_fb_cache_init(&driver->_perm_arena);
+    // The cache data can be many MB so is loaded into the perm arena rather than scratch.
+    vkapi_pl_disk_cache_init(
+        &driver->pl_disk_cache,
+        driver->context,
+        VKAPI_PL_DISK_CACHE_DEFAULT_PATH,
+        &driver->_perm_arena);
+    vkapi_pl_state_init(&driver->pl_state);
     driver->pline_cache = vkapi_pline_cache_init(&driver->_perm_arena, driver);
     driver->desc_cache = vkapi_desc_cache_init(driver, &driver->_perm_arena);
     driver->sampler_cache = vkapi_sampler_cache_init(&driver->_perm_arena);
@@ -132,9 +150,24 @@ void vkapi_driver_shutdown(vkapi_driver_t* driver, VkSurfaceKHR surface)
     // destroying all other Vulkan objects.
     vkapi_commands_destroy(driver->context, driver->commands);
     vkapi_commands_destroy(driver->context, driver->compute_commands);
+    vkapi_commands_destroy(driver->context, driver->transfer_commands);
+    if (driver->secondary_cmds)
+    {
+        vkapi_secondary_cmds_destroy(driver->context, driver->secondary_cmds);
+        mutex_destroy(&driver->record_mutex);
+    }
 
     vkapi_fb_cache_destroy(driver->framebuffer_cache, driver);
     vkapi_pline_cache_destroy(driver->pline_cache);
+    if (!vkapi_pl_disk_cache_save(
+            &driver->pl_disk_cache,
+            driver->context,
+            VKAPI_PL_DISK_CACHE_DEFAULT_PATH,
+            &driver->_perm_arena))
+    {
+        log_warn("Unable to write the pipeline cache to disk.");
+    }
+    vkapi_pl_disk_cache_destroy(&driver->pl_disk_cache, driver->context);
     vkapi_desc_cache_destroy(driver->desc_cache);
     vkapi_res_cache_destroy(driver->res_cache, driver);
     vkapi_sampler_cache_destroy(driver->sampler_cache, driver);
@@ -228,6 +261,7 @@ void vkapi_driver_map_gpu_texture(
     vkapi_texture_map(
         driver->context,
         driver->staging_pool,
+        &driver->uploads,
         driver->commands,
         driver->vma_allocator,
         tex,
@@ -238,20 +272,20 @@ void vkapi_driver_map_gpu_texture(
         generate_mipmaps);
 }
 
-void vkapi_driver_map_gpu_vertex(
-    vkapi_driver_t* driver,
-    buffer_handle_t vertex_handle,
-    void* vertices,
-    uint32_t vertex_sz,
-    buffer_handle_t index_handle,
-    void* indices,
-    uint32_t indices_sz)
+void vkapi_driver_upload_vertex_data(
+    vkapi_driver_t* driver, buffer_handle_t h, void* vertices, size_t size, size_t offset)
 {
-    vkapi_buffer_t* vert_buffer = vkapi_res_cache_get_buffer(driver->res_cache, vertex_handle);
-    vkapi_buffer_t* index_buffer = vkapi_res_cache_get_buffer(driver->res_cache, index_handle);
+    assert(driver);
+    vkapi_buffer_t* buffer = vkapi_res_cache_get_buffer(driver->res_cache, h);
+    vkapi_buffer_upload_vertex_data(buffer, driver, vertices, size, offset);
+}
 
-    vkapi_buffer_upload_vertex_data(vert_buffer, driver, vertices, vertex_sz, 0);
-    vkapi_buffer_upload_index_data(index_buffer, driver, indices, indices_sz, 0);
+void vkapi_driver_upload_index_data(
+    vkapi_driver_t* driver, buffer_handle_t h, void* indices, size_t size, size_t offset)
+{
+    assert(driver);
+    vkapi_buffer_t* buffer = vkapi_res_cache_get_buffer(driver->res_cache, h);
+    vkapi_buffer_upload_index_data(buffer, driver, indices, size, offset);
 }
 
 bool vkapi_driver_begin_frame(vkapi_driver_t* driver, vkapi_swapchain_t* sc)
@@ -304,15 +338,53 @@ void vkapi_driver_end_frame(vkapi_driver_t* driver, vkapi_swapchain_t* sc)
 
     // Destroy any resources that have reached their use by date.
     vkapi_driver_gc(driver);
+    vkapi_pl_state_end_frame(&driver->pl_state);
+    vkapi_upload_batch_end_frame(&driver->uploads);
 
     driver->current_frame++;
+    // Descriptor pools which are no longer in use by the GPU can now be reset.
+    vkapi_desc_cache_begin_frame(driver->desc_cache, driver->current_frame);
+    if (driver->secondary_cmds)
+    {
+        vkapi_secondary_cmds_begin_frame(
+            driver->context, driver->secondary_cmds, driver->current_frame);
+    }
 }
 
-void vkapi_driver_begin_rpass(
+VkCommandBuffer _vkapi_driver_get_record_cmds(vkapi_driver_t* driver)
+{
+    if (tls_secondary_cmds)
+    {
+        return tls_secondary_cmds;
+    }
+    return vkapi_commands_get_cmdbuffer(driver->context, driver->commands)->instance;
+}
+
+void _vkapi_driver_set_full_viewport(VkCommandBuffer cmds, uint32_t width, uint32_t height)
+{
+    VkViewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = (float)width,
+        .height = (float)height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f};
+    vkCmdSetViewport(cmds, 0, 1, &viewport);
+
+    VkRect2D scissor = {
+        .offset.x = 0,
+        .offset.y = 0,
+        .extent.width = (int32_t)width,
+        .extent.height = (int32_t)height};
+    vkCmdSetScissor(cmds, 0, 1, &scissor);
+}
+
+void _vkapi_driver_begin_rpass(
     vkapi_driver_t* driver,
     VkCommandBuffer cmds,
     vkapi_render_pass_data_t* data,
-    vkapi_rt_handle_t* rt_handle)
+    vkapi_rt_handle_t* rt_handle,
+    VkSubpassContents contents)
 {
     assert(driver);
     assert(rt_handle->id < driver->render_targets.size);
@@ -424,24 +496,18 @@ void vkapi_driver_begin_rpass(
     bi.renderArea = extents;
     bi.clearValueCount = attach_count;
     bi.pClearValues = clear_values;
-    vkCmdBeginRenderPass(cmds, &bi, VK_SUBPASS_CONTENTS_INLINE);
-
-    // Viewport and scissor can be overwritten later by the user.
-    VkViewport viewport = {
-        .x = 0.0f,
-        .y = 0.0f,
-        .width = (float)fbo->width,
-        .height = (float)fbo->height,
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f};
-    vkCmdSetViewport(cmds, 0, 1, &viewport);
+    vkCmdBeginRenderPass(cmds, &bi, contents);
 
-    VkRect2D scissor = {
-        .offset.x = 0,
-        .offset.y = 0,
-        .extent.width = (int32_t)fbo->width,
-        .extent.height = (int32_t)fbo->height};
-    vkCmdSetScissor(cmds, 0, 1, &scissor);
+    // Viewport and scissor can be overwritten later by the user. Secondary command buffers don't
+    // inherit dynamic state, so these are set when each begins instead.
+    if (contents == VK_SUBPASS_CONTENTS_INLINE)
+    {
+        _vkapi_driver_set_full_viewport(cmds, fbo->width, fbo->height);
+    }
+    driver->secondary_rpass.rpass = rpass->instance;
+    driver->secondary_rpass.fbo = fbo->instance;
+    driver->secondary_rpass.extent.width = fbo->width;
+    driver->secondary_rpass.extent.height = fbo->height;
 
     // bind the renderpass to the pipeline
     vkapi_pline_cache_bind_rpass(driver->pline_cache, rpass->instance);
@@ -450,28 +516,113 @@ void vkapi_driver_begin_rpass(
     arena_reset(&driver->_scratch_arena);
 }
 
+void vkapi_driver_begin_rpass(
+    vkapi_driver_t* driver,
+    VkCommandBuffer cmds,
+    vkapi_render_pass_data_t* data,
+    vkapi_rt_handle_t* rt_handle)
+{
+    _vkapi_driver_begin_rpass(driver, cmds, data, rt_handle, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void vkapi_driver_begin_rpass_secondary(
+    vkapi_driver_t* driver,
+    VkCommandBuffer cmds,
+    vkapi_render_pass_data_t* data,
+    vkapi_rt_handle_t* rt_handle)
+{
+    assert(driver->secondary_cmds && "Secondary commands have not been initialised.");
+    _vkapi_driver_begin_rpass(
+        driver, cmds, data, rt_handle, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+}
+
 void vkapi_driver_end_rpass(VkCommandBuffer cmds) { vkCmdEndRenderPass(cmds); }
 
+void vkapi_driver_init_secondary_cmds(vkapi_driver_t* driver, uint32_t worker_count)
+{
+    assert(driver);
+    assert(!driver->secondary_cmds);
+    driver->secondary_cmds = vkapi_secondary_cmds_init(
+        driver->context, driver->context->queue_info.graphics, worker_count, &driver->_perm_arena);
+    vkapi_secondary_cmds_begin_frame(
+        driver->context, driver->secondary_cmds, driver->current_frame);
+    bool res = mutex_init(&driver->record_mutex);
+    assert(res);
+}
+
+VkCommandBuffer vkapi_driver_begin_secondary(vkapi_driver_t* driver, uint32_t worker_idx)
+{
+    assert(driver);
+    assert(driver->secondary_cmds && "Secondary commands have not been initialised.");
+    assert(!tls_secondary_cmds && "A secondary command buffer is already being recorded.");
+
+    VkCommandBufferInheritanceInfo inherit_info = {0};
+    inherit_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inherit_info.renderPass = driver->secondary_rpass.rpass;
+    inherit_info.subpass = 0;
+    inherit_info.framebuffer = driver->secondary_rpass.fbo;
+    VkCommandBuffer cmds = vkapi_secondary_cmds_begin(
+        driver->context, driver->secondary_cmds, worker_idx, &inherit_info);
+
+    _vkapi_driver_set_full_viewport(
+        cmds, driver->secondary_rpass.extent.width, driver->secondary_rpass.extent.height);
+    tls_secondary_cmds = cmds;
+    return cmds;
+}
+
+void vkapi_driver_end_secondary(vkapi_driver_t* driver, VkCommandBuffer cmds)
+{
+    assert(driver);
+    assert(tls_secondary_cmds == cmds && "Command buffer wasn't begun on this thread.");
+    vkapi_secondary_cmds_end(cmds);
+    tls_secondary_cmds = VK_NULL_HANDLE;
+}
+
+void vkapi_driver_execute_secondary(
+    vkapi_driver_t* driver, VkCommandBuffer primary, VkCommandBuffer* cmds, uint32_t count)
+{
+    assert(driver);
+    assert(cmds);
+    if (!count)
+    {
+        return;
+    }
+    vkCmdExecuteCommands(primary, count, cmds);
+    // The state bound to the primary is undefined after executing secondary command buffers.
+    vkapi_pl_state_invalidate(&driver->pl_state);
+}
+
 void vkapi_driver_bind_vertex_buffer(
     vkapi_driver_t* driver, buffer_handle_t vb_handle, uint32_t binding)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     vkapi_buffer_t* vb = vkapi_res_cache_get_buffer(driver->res_cache, vb_handle);
     VkDeviceSize offset[1] = {0};
-    vkCmdBindVertexBuffers(cmd_buffer->instance, binding, 1, &vb->buffer, offset);
+    vkCmdBindVertexBuffers(cmds, binding, 1, &vb->buffer, offset);
 }
 
-void vkapi_driver_bind_index_buffer(vkapi_driver_t* driver, buffer_handle_t ib_handle)
+void vkapi_driver_bind_index_buffer(
+    vkapi_driver_t* driver, buffer_handle_t ib_handle, VkIndexType index_type)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     vkapi_buffer_t* ib = vkapi_res_cache_get_buffer(driver->res_cache, ib_handle);
-    vkCmdBindIndexBuffer(cmd_buffer->instance, ib->buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(cmds, ib->buffer, 0, index_type);
 }
 
 void vkapi_driver_bind_gfx_pipeline(
     vkapi_driver_t* driver, shader_prog_bundle_t* bundle, bool force_rebind)
 {
-    vkapi_cmdbuffer_t* cmds = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
+
+    // The caches are shared by all threads recording secondary command buffers, and the bound
+    // state is only tracked for the primary, so binds into a secondary are serialised and forced.
+    bool is_secondary = tls_secondary_cmds != VK_NULL_HANDLE;
+    if (is_secondary)
+    {
+        mutex_lock(&driver->record_mutex);
+        force_rebind = true;
+    }
+
     vkapi_pl_layout_t* pl_layout = vkapi_pline_cache_get_pl_layout(driver->pline_cache, bundle);
 
     bool bound_samplers = false;
@@ -518,7 +669,7 @@ void vkapi_driver_bind_gfx_pipeline(
 
     vkapi_desc_cache_bind_descriptors(
         driver->desc_cache,
-        cmds->instance,
+        cmds,
         bundle,
         pl_layout->instance,
         VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -568,19 +719,32 @@ void vkapi_driver_bind_gfx_pipeline(
 
     vkapi_pline_cache_bind_gfx_pl_layout(driver->pline_cache, pl_layout->instance);
     vkapi_pline_cache_bind_graphics_pline(
-        driver->pline_cache, cmds->instance, bundle->spec_const_params, force_rebind);
+        driver->pline_cache, cmds, bundle->spec_const_params, force_rebind);
+
+    if (is_secondary)
+    {
+        mutex_unlock(&driver->record_mutex);
+    }
 }
 
 void vkapi_driver_set_scissor(vkapi_driver_t* driver, VkRect2D scissor)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
-    vkCmdSetScissor(cmd_buffer->instance, 0, 1, &scissor);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
+    vkCmdSetScissor(cmds, 0, 1, &scissor);
+}
+
+void vkapi_driver_reset_viewport(vkapi_driver_t* driver)
+{
+    _vkapi_driver_set_full_viewport(
+        _vkapi_driver_get_record_cmds(driver),
+        driver->secondary_rpass.extent.width,
+        driver->secondary_rpass.extent.height);
 }
 
 void vkapi_driver_set_viewport(vkapi_driver_t* driver, VkViewport vp)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
-    vkCmdSetViewport(cmd_buffer->instance, 0, 1, &vp);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
+    vkCmdSetViewport(cmds, 0, 1, &vp);
 }
 
 void vkapi_driver_set_push_constant(
@@ -588,25 +752,33 @@ void vkapi_driver_set_push_constant(
 {
     assert(driver);
     assert(data);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     VkPipelineLayout l = driver->pline_cache->bound_graphics_pline.pl_layout;
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    if (tls_secondary_cmds)
+    {
+        // The bound pipeline may have since been changed by another thread, so use the layout
+        // of the bundle instead.
+        mutex_lock(&driver->record_mutex);
+        l = vkapi_pline_cache_get_pl_layout(driver->pline_cache, bundle)->instance;
+        mutex_unlock(&driver->record_mutex);
+    }
     size_t size = bundle->push_blocks[stage].range;
     assert(size > 0);
-    vkCmdPushConstants(cmd_buffer->instance, l, bundle->push_blocks[stage].stage, 0, size, data);
+    vkCmdPushConstants(cmds, l, bundle->push_blocks[stage].stage, 0, size, data);
 }
 
 void vkapi_driver_draw(vkapi_driver_t* driver, uint32_t vert_count, int32_t vertex_offset)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
-    vkCmdDraw(cmd_buffer->instance, vert_count, 1, vertex_offset, 0);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
+    vkCmdDraw(cmds, vert_count, 1, vertex_offset, 0);
 }
 
 void vkapi_driver_draw_indexed(
     vkapi_driver_t* driver, uint32_t index_count, int32_t vertex_offset, int32_t index_offset)
 {
     assert(driver);
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
-    vkCmdDrawIndexed(cmd_buffer->instance, index_count, 1, index_offset, vertex_offset, 0);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
+    vkCmdDrawIndexed(cmds, index_count, 1, index_offset, vertex_offset, 0);
 }
 
 void vkapi_driver_draw_indirect_indexed(
@@ -618,11 +790,11 @@ void vkapi_driver_draw_indirect_indexed(
     uint32_t stride)
 {
     assert(driver);
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     vkapi_buffer_t* ic_buffer = vkapi_res_cache_get_buffer(driver->res_cache, indirect_cmd_buffer);
     vkapi_buffer_t* count_buffer = vkapi_res_cache_get_buffer(driver->res_cache, cmd_count_buffer);
     vkCmdDrawIndexedIndirectCount(
-        cmd_buffer->instance,
+        cmds,
         ic_buffer->buffer,
         offset,
         count_buffer->buffer,
@@ -634,13 +806,13 @@ void vkapi_driver_draw_indirect_indexed(
 void vkapi_driver_begin_cond_render(
     vkapi_driver_t* driver, buffer_handle_t cond_buffer, int32_t offset)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     vkapi_buffer_t* buffer = vkapi_res_cache_get_buffer(driver->res_cache, cond_buffer);
     VkConditionalRenderingBeginInfoEXT bi = {0};
     bi.sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT;
     bi.buffer = buffer->buffer;
     bi.offset = offset;
-    vkCmdBeginConditionalRenderingEXT(cmd_buffer->instance, &bi);
+    vkCmdBeginConditionalRenderingEXT(cmds, &bi);
 }
 
 void vkapi_driver_dispatch_compute(
@@ -742,9 +914,9 @@ void vkapi_driver_dispatch_compute(
 
 void vkapi_driver_draw_quad(vkapi_driver_t* driver, shader_prog_bundle_t* bundle)
 {
-    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    VkCommandBuffer cmds = _vkapi_driver_get_record_cmds(driver);
     vkapi_driver_bind_gfx_pipeline(driver, bundle, false);
-    vkCmdDraw(cmd_buffer->instance, 3, 1, 0, 0);
+    vkCmdDraw(cmds, 3, 1, 0, 0);
 }
 
 void vkapi_driver_generate_mipmaps(
@@ -777,6 +949,49 @@ void vkapi_driver_transition_image(
         texture, old_layout, new_layout, cmds->instance, old_flags, new_flags, mip_levels);
 }
 
+void vkapi_driver_discard_image_barrier(
+    vkapi_driver_t* driver,
+    texture_handle_t h,
+    VkPipelineStageFlags src_stage,
+    VkAccessFlags src_access,
+    VkImageLayout new_layout,
+    VkPipelineStageFlags dst_stage,
+    VkAccessFlags dst_access)
+{
+    assert(driver);
+    vkapi_cmdbuffer_t* cmd_buffer = vkapi_commands_get_cmdbuffer(driver->context, driver->commands);
+    vkapi_texture_t* texture = vkapi_res_cache_get_tex2d(driver->res_cache, h);
+
+    // The old layout is undefined as the memory held a different image, so the contents are
+    // discarded.
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = src_access,
+        .dstAccessMask = dst_access,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = new_layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = texture->image,
+        .subresourceRange = {
+            .aspectMask = vkapi_texture_aspect_flags(texture->info.format),
+            .baseMipLevel = 0,
+            .levelCount = VK_REMAINING_MIP_LEVELS,
+            .baseArrayLayer = 0,
+            .layerCount = VK_REMAINING_ARRAY_LAYERS}};
+    vkCmdPipelineBarrier(
+        cmd_buffer->instance,
+        src_stage,
+        dst_stage,
+        0,
+        0,
+        VK_NULL_HANDLE,
+        0,
+        VK_NULL_HANDLE,
+        1,
+        &barrier);
+}
+
 void vkapi_driver_apply_global_barrier(
     vkapi_driver_t* driver,
     VkPipelineStageFlags src_stage,
@@ -941,13 +1156,134 @@ void vkapi_driver_clear_gpu_buffer(
 void vkapi_driver_flush_gfx_cmds(vkapi_driver_t* driver)
 {
     assert(driver);
+    vkapi_driver_flush_uploads(driver, driver->commands);
     vkapi_commands_flush(driver->context, driver->commands);
+    // Bound state doesn't carry over to the next command buffer.
+    vkapi_pl_state_invalidate(&driver->pl_state);
+}
+
+void vkapi_driver_flush_uploads(vkapi_driver_t* driver, vkapi_commands_t* wait_cmds)
+{
+    assert(driver);
+    assert(wait_cmds);
+
+    vkapi_upload_batch_t* b = &driver->uploads;
+    if (vkapi_upload_batch_is_empty(b))
+    {
+        return;
+    }
+    arena_t* scratch = &driver->_scratch_arena;
+    vkapi_cmdbuffer_t* cmd =
+        vkapi_commands_get_cmdbuffer(driver->context, driver->transfer_commands);
+
+    // Transition all images ready for the copy with one barrier.
+    uint32_t image_count = b->image_copies.size;
+    VkImageMemoryBarrier* image_barriers =
+        ARENA_MAKE_ZERO_ARRAY(scratch, VkImageMemoryBarrier, image_count);
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        vkapi_upload_image_copy_t* c =
+            DYN_ARRAY_GET_PTR(vkapi_upload_image_copy_t, &b->image_copies, i);
+        VkImageMemoryBarrier* barrier = &image_barriers[i];
+        barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier->image = c->image;
+        barrier->oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier->newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier->dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier->subresourceRange.aspectMask = c->aspect;
+        barrier->subresourceRange.levelCount = c->mip_levels;
+        barrier->subresourceRange.layerCount = c->layer_count;
+    }
+    if (image_count)
+    {
+        vkCmdPipelineBarrier(
+            cmd->instance,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0,
+            VK_NULL_HANDLE,
+            0,
+            VK_NULL_HANDLE,
+            image_count,
+            image_barriers);
+        b->stats.barrier_count++;
+    }
+
+    for (uint32_t i = 0; i < image_count; ++i)
+    {
+        vkapi_upload_image_copy_t* c =
+            DYN_ARRAY_GET_PTR(vkapi_upload_image_copy_t, &b->image_copies, i);
+        vkCmdCopyBufferToImage(
+            cmd->instance,
+            c->src,
+            c->image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            c->region_count,
+            DYN_ARRAY_GET_PTR(VkBufferImageCopy, &b->image_regions, c->region_start));
+        b->stats.copy_cmd_count++;
+
+        VkImageMemoryBarrier* barrier = &image_barriers[i];
+        barrier->oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier->newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier->dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    vkapi_upload_buffer_cmd_t* buffer_cmds;
+    uint32_t buffer_cmd_count = vkapi_upload_batch_build_buffer_cmds(b, scratch, &buffer_cmds);
+    VkBufferMemoryBarrier* buffer_barriers =
+        ARENA_MAKE_ZERO_ARRAY(scratch, VkBufferMemoryBarrier, buffer_cmd_count);
+    VkPipelineStageFlags dst_stages = image_count ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : 0;
+    for (uint32_t i = 0; i < buffer_cmd_count; ++i)
+    {
+        vkapi_upload_buffer_cmd_t* c = &buffer_cmds[i];
+        vkCmdCopyBuffer(cmd->instance, c->src, c->dst, c->region_count, c->regions);
+        b->stats.copy_cmd_count++;
+
+        VkPipelineStageFlags stages;
+        VkBufferMemoryBarrier* barrier = &buffer_barriers[i];
+        barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier->buffer = c->dst;
+        barrier->size = VK_WHOLE_SIZE;
+        barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkapi_upload_batch_dst_access(c->usage, &barrier->dstAccessMask, &stages);
+        dst_stages |= stages;
+    }
+
+    // A single barrier makes all uploads visible to the commands which follow.
+    vkCmdPipelineBarrier(
+        cmd->instance,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        dst_stages,
+        0,
+        0,
+        VK_NULL_HANDLE,
+        buffer_cmd_count,
+        buffer_barriers,
+        image_count,
+        image_barriers);
+    b->stats.barrier_count++;
+
+    vkapi_commands_flush(driver->context, driver->transfer_commands);
+    vkapi_commands_set_ext_wait_signal(
+        wait_cmds, vkapi_commands_get_finished_signal(driver->transfer_commands));
+    b->stats.submission_count++;
+
+    vkapi_upload_batch_clear(b);
+    arena_reset(scratch);
 }
 
 void vkapi_driver_flush_compute_cmds(vkapi_driver_t* driver)
 {
     assert(driver);
+    vkapi_driver_flush_uploads(driver, driver->compute_commands);
     vkapi_commands_flush(driver->context, driver->compute_commands);
+    vkapi_pl_state_invalidate(&driver->pl_state);
 }
 
 vkapi_cmdbuffer_t* vkapi_driver_get_compute_cmds(vkapi_driver_t* driver)
@@ -965,8 +1301,31 @@ vkapi_cmdbuffer_t* vkapi_driver_get_gfx_cmds(vkapi_driver_t* driver)
 void vkapi_driver_gc(vkapi_driver_t* driver)
 {
     vkapi_pline_cache_gc(driver->pline_cache, driver->current_frame);
-    vkapi_desc_cache_gc(driver->desc_cache, driver->current_frame);
     vkapi_res_cache_gc(driver->res_cache, driver);
     vkapi_staging_gc(driver->staging_pool, driver->vma_allocator, driver->current_frame);
     vkapi_fb_cache_gc(driver->framebuffer_cache, driver, driver->current_frame);
 }
+
+vkapi_pl_bind_stats_t vkapi_driver_get_bind_stats(vkapi_driver_t* driver)
+{
+    assert(driver);
+    return driver->pl_state.last_frame_stats;
+}
+
+vkapi_desc_alloc_stats_t vkapi_driver_get_desc_alloc_stats(vkapi_driver_t* driver)
+{
+    assert(driver);
+    return driver->desc_cache->allocator->last_frame_stats;
+}
+
+vkapi_upload_stats_t vkapi_driver_get_upload_stats(vkapi_driver_t* driver)
+{
+    assert(driver);
+    return driver->uploads.last_frame_stats;
+}
+
+vkapi_pl_disk_cache_stats_t vkapi_driver_get_pl_disk_cache_stats(vkapi_driver_t* driver)
+{
+    assert(driver);
+    return vkapi_pl_disk_cache_get_stats(&driver->pl_disk_cache);
+}
@@ -26,9 +26,15 @@
 #include "commands.h"
 #include "common.h"
 #include "context.h"
+#include "descriptor_allocator.h"
+#include "pipeline_disk_cache.h"
+#include "pipeline_state.h"
 #include "renderpass.h"
 #include "resource_cache.h"
 #include "staging_pool.h"
+#include "upload_batch.h"
+
+#include <utility/thread.h>
 
 #define VKAPI_DRIVER_MAX_DRAW_COUNT 500
 
@@ -63,12 +69,29 @@ typedef struct VkApiDriver
     uint32_t image_index;
 
     vkapi_staging_pool_t* staging_pool;
+    /// Uploads waiting to be recorded on the transfer commands.
+    vkapi_upload_batch_t uploads;
 
     // Graphic queue commands.
     vkapi_commands_t* commands;
     // Compute queue commands (if the graphics and compute queue are the same, committed commands
     // will be in the same queue).
     vkapi_commands_t* compute_commands;
+    // Upload commands - submitted to the graphics queue ahead of the graphics and compute commands.
+    vkapi_commands_t* transfer_commands;
+    /// Per-worker pools for recording render pass contents in parallel. NULL until
+    /// @sa vkapi_driver_init_secondary_cmds is called.
+    vkapi_secondary_cmds_t* secondary_cmds;
+    /// Guards the pipeline and descriptor caches whilst secondary command buffers are recorded.
+    mutex_t record_mutex;
+    /// The current render pass and the framebuffer which secondary command buffers are recorded
+    /// for - set by @sa vkapi_driver_begin_rpass.
+    struct SecondaryRenderPass
+    {
+        VkRenderPass rpass;
+        VkFramebuffer fbo;
+        VkExtent2D extent;
+    } secondary_rpass;
 
     /* ** Internal use only ** */
     /// Permanent arena space for the lifetime of this driver.
@@ -84,8 +107,12 @@ typedef struct VkApiDriver
 
     vkapi_fb_cache_t* framebuffer_cache;
     vkapi_pipeline_cache_t* pline_cache;
+    /// The Vulkan pipeline cache used by all pipelines, persisted between runs.
+    vkapi_pl_disk_cache_t pl_disk_cache;
     vkapi_desc_cache_t* desc_cache;
     vkapi_sampler_cache_t* sampler_cache;
+    /// Tracks the pipeline and descriptor state bound to the current command buffer.
+    vkapi_pl_state_tracker_t pl_state;
 
     uint64_t current_frame;
 
@@ -118,9 +145,44 @@ void vkapi_driver_begin_rpass(
     vkapi_rt_handle_t* rt_handle);
 void vkapi_driver_end_rpass(VkCommandBuffer cmds);
 
+/**
+ Create the command pools used to record secondary command buffers.
+ @param worker_count The number of threads which will record secondary command buffers - each is
+ identified by an index less than this count.
+ */
+void vkapi_driver_init_secondary_cmds(vkapi_driver_t* driver, uint32_t worker_count);
+
+/**
+ Begin a render pass whose contents will be recorded into secondary command buffers. Only
+ @sa vkapi_driver_execute_secondary can be called on the primary until the pass is ended.
+ */
+void vkapi_driver_begin_rpass_secondary(
+    vkapi_driver_t* driver,
+    VkCommandBuffer cmds,
+    vkapi_render_pass_data_t* data,
+    vkapi_rt_handle_t* rt_handle);
+
+/**
+ Begin recording a secondary command buffer for the current secondary render pass. Until
+ @sa vkapi_driver_end_secondary is called, all draw state and draw calls made on the calling
+ thread are recorded into the returned command buffer.
+ @param worker_idx The index of the calling thread. No two threads can use the same index at the
+ same time.
+ */
+VkCommandBuffer vkapi_driver_begin_secondary(vkapi_driver_t* driver, uint32_t worker_idx);
+
+void vkapi_driver_end_secondary(vkapi_driver_t* driver, VkCommandBuffer cmds);
+
+/**
+ Execute recorded secondary command buffers, in the order given, within the current render pass.
+ */
+void vkapi_driver_execute_secondary(
+    vkapi_driver_t* driver, VkCommandBuffer primary, VkCommandBuffer* cmds, uint32_t count);
+
 void vkapi_driver_bind_vertex_buffer(
     vkapi_driver_t* driver, buffer_handle_t vb_handle, uint32_t binding);
-void vkapi_driver_bind_index_buffer(vkapi_driver_t* driver, buffer_handle_t ib_handle);
+void vkapi_driver_bind_index_buffer(
+    vkapi_driver_t* driver, buffer_handle_t ib_handle, VkIndexType index_type);
 
 void vkapi_driver_bind_gfx_pipeline(
     vkapi_driver_t* driver, shader_prog_bundle_t* bundle, bool force_rebind);
@@ -136,14 +198,11 @@ void vkapi_driver_map_gpu_texture(
     size_t* offsets,
     bool generate_mipmaps);
 
-void vkapi_driver_map_gpu_vertex(
-    vkapi_driver_t* driver,
-    buffer_handle_t vertex_handle,
-    void* vertices,
-    uint32_t vertex_sz,
-    buffer_handle_t index_handle,
-    void* indices,
-    uint32_t indices_sz);
+void vkapi_driver_upload_vertex_data(
+    vkapi_driver_t* driver, buffer_handle_t h, void* vertices, size_t size, size_t offset);
+
+void vkapi_driver_upload_index_data(
+    vkapi_driver_t* driver, buffer_handle_t h, void* indices, size_t size, size_t offset);
 
 // The pipeline layout must be bound either by a call to vkapi_driver_bind_gfx_pipeline or some
 // other means before calling this function.
@@ -153,6 +212,12 @@ void vkapi_driver_set_push_constant(
 void vkapi_driver_set_scissor(vkapi_driver_t* driver, VkRect2D scissor);
 void vkapi_driver_set_viewport(vkapi_driver_t* driver, VkViewport vp);
 
+/**
+ Reset the viewport and scissor to cover the whole of the current render pass.
+ @param driver A pointer to the driver.
+ */
+void vkapi_driver_reset_viewport(vkapi_driver_t* driver);
+
 void vkapi_driver_draw(vkapi_driver_t* driver, uint32_t vert_count, int32_t vertex_offset);
 
 void vkapi_driver_draw_indexed(
@@ -188,6 +253,27 @@ void vkapi_driver_transition_image(
     VkImageLayout new_layout,
     uint32_t mip_levels);
 
+/**
+ Discard the contents of an image and make it available for its first use, once prior commands
+ have reached the specified stages. Used when an image takes over memory previously occupied by
+ another (aliased) image.
+ @param driver A pointer to the driver.
+ @param h The texture handle.
+ @param src_stage The stages of the previous use of the memory which must complete first.
+ @param src_access The writes made by the previous use of the memory.
+ @param new_layout The layout of the image for its first use.
+ @param dst_stage The stages of the first use.
+ @param dst_access The access of the first use.
+ */
+void vkapi_driver_discard_image_barrier(
+    vkapi_driver_t* driver,
+    texture_handle_t h,
+    VkPipelineStageFlags src_stage,
+    VkAccessFlags src_access,
+    VkImageLayout new_layout,
+    VkPipelineStageFlags dst_stage,
+    VkAccessFlags dst_access);
+
 void vkapi_driver_apply_global_barrier(
     vkapi_driver_t* driver,
     VkPipelineStageFlags src_stage,
@@ -201,6 +287,12 @@ void vkapi_driver_acquire_buffer_barrier(
 void vkapi_driver_release_buffer_barrier(
     vkapi_driver_t* driver, vkapi_cmdbuffer_t*, buffer_handle_t handle, enum BarrierType type);
 
+/**
+ Record all uploads for the frame on the transfer commands and submit.
+ @param wait_cmds The commands which will wait on the uploads completing.
+ */
+void vkapi_driver_flush_uploads(vkapi_driver_t* driver, vkapi_commands_t* wait_cmds);
+
 void vkapi_driver_flush_compute_cmds(vkapi_driver_t* driver);
 void vkapi_driver_flush_gfx_cmds(vkapi_driver_t* driver);
 vkapi_cmdbuffer_t* vkapi_driver_get_compute_cmds(vkapi_driver_t* driver);
@@ -211,4 +303,25 @@ void vkapi_driver_generate_mipmaps(
 
 void vkapi_driver_gc(vkapi_driver_t* driver);
 
+/**
+ @return The pipeline and descriptor set bind counts for the last completed frame, including the
+ number of binds which were skipped as the state was unchanged.
+ */
+vkapi_pl_bind_stats_t vkapi_driver_get_bind_stats(vkapi_driver_t* driver);
+
+/**
+ @return The descriptor set lookup, reuse and write counts for the last completed frame.
+ */
+vkapi_desc_alloc_stats_t vkapi_driver_get_desc_alloc_stats(vkapi_driver_t* driver);
+
+/**
+ @return The upload, copy, barrier and submission counts for the last completed frame.
+ */
+vkapi_upload_stats_t vkapi_driver_get_upload_stats(vkapi_driver_t* driver);
+
+/**
+ @return The pipeline disk cache load status and the warm/cold pipeline counts for this run.
+ */
+vkapi_pl_disk_cache_stats_t vkapi_driver_get_pl_disk_cache_stats(vkapi_driver_t* driver);
+
 #endif
\ No newline at end of file
@@ -24,13 +24,19 @@
 
 #include "context.h"
 #include "pipeline_cache.h"
+#include "pipeline_disk_cache.h"
 #include "program_manager.h"
 #include "renderpass.h"
 #include "shader.h"
 
 vkapi_graphics_pl_t vkapi_graph_pl_create(
-    vkapi_context_t* context, const graphics_pl_key_t* key, struct SpecConstParams* spec_consts)
+    vkapi_context_t* context,
+    vkapi_pl_disk_cache_t* disk_cache,
+    const graphics_pl_key_t* key,
+    struct SpecConstParams* spec_consts)
 {
+    assert(disk_cache);
+
     vkapi_graphics_pl_t pl = {0};
 
     // Sort the vertex attribute descriptors so only ones that are used
@@ -178,23 +184,39 @@ vkapi_graphics_pl_t vkapi_graph_pl_create(
     ci.layout = key->pl_layout;
     ci.renderPass = key->render_pass;
 
+    VkPipelineCreationFeedbackEXT feedback = {0};
+    VkPipelineCreationFeedbackCreateInfoEXT feedback_ci = {0};
+    feedback_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    feedback_ci.pPipelineCreationFeedback = &feedback;
+    ci.pNext = disk_cache->has_feedback ? &feedback_ci : VK_NULL_HANDLE;
+
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(
-        context->device, VK_NULL_HANDLE, 1, &ci, VK_NULL_HANDLE, &pl.instance));
+        context->device, disk_cache->instance, 1, &ci, VK_NULL_HANDLE, &pl.instance));
+    vkapi_pl_disk_cache_record(disk_cache, disk_cache->has_feedback ? &feedback : NULL);
 
     return pl;
 }
 
-vkapi_compute_pl_t vkapi_compute_pl_create(vkapi_context_t* context, compute_pl_key_t* key)
+vkapi_compute_pl_t vkapi_compute_pl_create(
+    vkapi_context_t* context, vkapi_pl_disk_cache_t* disk_cache, compute_pl_key_t* key)
 {
+    assert(disk_cache);
     assert(key);
     assert(key->pl_layout);
 
+    VkPipelineCreationFeedbackEXT feedback = {0};
+    VkPipelineCreationFeedbackCreateInfoEXT feedback_ci = {0};
+    feedback_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    feedback_ci.pPipelineCreationFeedback = &feedback;
+
     vkapi_compute_pl_t pl = {0};
     VkComputePipelineCreateInfo ci = {0};
     ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    ci.pNext = disk_cache->has_feedback ? &feedback_ci : VK_NULL_HANDLE;
     ci.layout = key->pl_layout;
     ci.stage = key->shader;
     VK_CHECK_RESULT(vkCreateComputePipelines(
-        context->device, VK_NULL_HANDLE, 1, &ci, VK_NULL_HANDLE, &pl.instance));
+        context->device, disk_cache->instance, 1, &ci, VK_NULL_HANDLE, &pl.instance));
+    vkapi_pl_disk_cache_record(disk_cache, disk_cache->has_feedback ? &feedback : NULL);
     return pl;
 }
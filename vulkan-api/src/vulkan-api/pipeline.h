@@ -41,6 +41,7 @@ typedef struct GraphicsPipeline vkapi_graphics_pl_t;
 typedef struct ComputePipeline vkapi_compute_pl_t;
 typedef struct GraphicsPipelineKey graphics_pl_key_t;
 typedef struct ComputePipelineKey compute_pl_key_t;
+typedef struct PipelineDiskCache vkapi_pl_disk_cache_t;
 struct SpecConstParams;
 
 typedef struct GraphicsPipeline
@@ -63,17 +64,23 @@ typedef struct ComputePipeline
 /**
  Create a Vulkan graphics pipeline.
  @param context A Vulkan context.
+ @param disk_cache The Vulkan pipeline cache the pipeline is created with.
  @param layout A pipeline layout associated with this graphics pipeline.
  @param key A pipeline cache key, used for caching the pipeline in the map.
  */
 vkapi_graphics_pl_t vkapi_graph_pl_create(
-    vkapi_context_t* context, const graphics_pl_key_t* key, struct SpecConstParams* spec_consts);
+    vkapi_context_t* context,
+    vkapi_pl_disk_cache_t* disk_cache,
+    const graphics_pl_key_t* key,
+    struct SpecConstParams* spec_consts);
 
 /**
  Create a Vulkan compute pipeline.
  @param [out] pipeline The new compute pipeline instance. NULL if initialisation fails.
  @param context A Vulkan context.
+ @param disk_cache The Vulkan pipeline cache the pipeline is created with.
  @param key A pipeline cache key.
  @param layout A pipeline layout associated with this compute pipeline.
  */
-vkapi_compute_pl_t vkapi_compute_pl_create(vkapi_context_t* context, compute_pl_key_t* key);
\ No newline at end of file
+vkapi_compute_pl_t vkapi_compute_pl_create(
+    vkapi_context_t* context, vkapi_pl_disk_cache_t* disk_cache, compute_pl_key_t* key);
\ No newline at end of file
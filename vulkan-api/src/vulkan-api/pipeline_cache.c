@@ -77,6 +77,72 @@ vkapi_pipeline_cache_t* vkapi_pline_cache_init(arena_t* arena, vkapi_driver_t* d
     return c;
 }
 
+void _pline_cache_set_state(
+    vkapi_pipeline_cache_t* c,
+    void* dst,
+    const void* src,
+    size_t size,
+    enum PipelineStateBlock block)
+{
+    if (memcmp(dst, src, size) != 0)
+    {
+        memcpy(dst, src, size);
+        vkapi_pl_state_mark_dirty(&c->driver->pl_state, block);
+    }
+}
+
+uint64_t vkapi_pline_cache_hash_block(graphics_pl_key_t* k, enum PipelineStateBlock block)
+{
+    assert(k);
+    // Blocks are seeded with their index so identical bytes in different blocks hash differently.
+    uint64_t h = block;
+    switch (block)
+    {
+        case VKAPI_PL_STATE_RASTER:
+            h = murmur2_hash64(&k->raster_state, sizeof(k->raster_state), h);
+            h = murmur2_hash64(&k->tesse_vert_count, sizeof(k->tesse_vert_count), h);
+            break;
+        case VKAPI_PL_STATE_DEPTH_STENCIL:
+            h = murmur2_hash64(&k->depth_stencil_block, sizeof(k->depth_stencil_block), h);
+            break;
+        case VKAPI_PL_STATE_BLEND:
+            h = murmur2_hash64(&k->blend_factor_block, sizeof(k->blend_factor_block), h);
+            break;
+        case VKAPI_PL_STATE_VERTEX_INPUT:
+            h = murmur2_hash64(k->vert_attr_descs, sizeof(k->vert_attr_descs), h);
+            h = murmur2_hash64(k->vert_bind_descs, sizeof(k->vert_bind_descs), h);
+            break;
+        case VKAPI_PL_STATE_SHADERS:
+            h = murmur2_hash64(&k->pl_layout, sizeof(k->pl_layout), h);
+            h = murmur2_hash64(k->shaders, sizeof(k->shaders), h);
+            h = murmur2_hash64(k->spec_map_entries, sizeof(k->spec_map_entries), h);
+            h = murmur2_hash64(k->spec_map_entry_count, sizeof(k->spec_map_entry_count), h);
+            h = murmur2_hash64(k->spec_data_hash, sizeof(k->spec_data_hash), h);
+            break;
+        case VKAPI_PL_STATE_RENDER_PASS:
+            h = murmur2_hash64(&k->render_pass, sizeof(k->render_pass), h);
+            h = murmur2_hash64(&k->colour_attach_count, sizeof(k->colour_attach_count), h);
+            break;
+        default:
+            assert(false && "Invalid pipeline state block.");
+    }
+    return h;
+}
+
+void vkapi_pline_cache_update_state_hash(vkapi_pipeline_cache_t* c)
+{
+    assert(c);
+    vkapi_pl_state_tracker_t* t = &c->driver->pl_state;
+    for (uint32_t i = 0; i < VKAPI_PL_STATE_BLOCK_COUNT && t->dirty_blocks; ++i)
+    {
+        if (vkapi_pl_state_is_block_dirty(t, i))
+        {
+            vkapi_pl_state_set_block_hash(
+                t, i, vkapi_pline_cache_hash_block(&c->graphics_pline_requires, i));
+        }
+    }
+}
+
 bool vkapi_pline_cache_compare_graphic_keys(graphics_pl_key_t* lhs, graphics_pl_key_t* rhs)
 {
     return memcmp(lhs, rhs, sizeof(graphics_pl_key_t)) == 0; // NOLINT
@@ -95,24 +161,29 @@ void vkapi_pline_cache_bind_graphics_pline(
 {
     assert(c);
 
-    // Set the renderpass separate from the key - that's because the key is cleared on each bind
-    // call, but when re-using the same renderpass for different draw-calls but rebinding pipeline,
-    // as the renderpass is set via being_rpass, it will be cleared with no way of getting the
-    // previous renderpass.
+    // The renderpass is set separately from the key via begin_rpass, once for all the draws in
+    // the pass, so is copied into the key here.
     assert(c->rpass_state.instance && "[PipelineCahce] No render pass has been declared.");
-    c->graphics_pline_requires.render_pass = c->rpass_state.instance;
-    c->graphics_pline_requires.colour_attach_count = c->rpass_state.colour_attach_count;
-
-    // Check if the required pipeline is already bound. If so, nothing to do
-    // here.
-    if (vkapi_pline_cache_compare_graphic_keys(
-            &c->graphics_pline_requires, &c->bound_graphics_pline) &&
-        !force_rebind)
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.render_pass,
+        &c->rpass_state.instance,
+        sizeof(VkRenderPass),
+        VKAPI_PL_STATE_RENDER_PASS);
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.colour_attach_count,
+        &c->rpass_state.colour_attach_count,
+        sizeof(uint32_t),
+        VKAPI_PL_STATE_RENDER_PASS);
+
+    // Check if the required pipeline is already bound. If so, nothing to do here - only the
+    // blocks which have changed since the last bind are rehashed to determine this.
+    vkapi_pline_cache_update_state_hash(c);
+    if (!vkapi_pl_state_requires_bind(&c->driver->pl_state, force_rebind))
     {
-        vkapi_graphics_pl_t* pl = HASH_SET_GET(&c->gfx_pipelines, &c->bound_graphics_pline);
-        assert(pl);
-        pl->last_used_frame_stamp = c->driver->current_frame;
-        c->graphics_pline_requires = vkapi_graphics_pline_key_init();
+        assert(c->bound_gfx_pl);
+        c->bound_gfx_pl->last_used_frame_stamp = c->driver->current_frame;
         return;
     }
 
@@ -121,8 +192,9 @@ void vkapi_pline_cache_bind_graphics_pline(
     pl->last_used_frame_stamp = c->driver->current_frame;
     vkCmdBindPipeline(cmds, VK_PIPELINE_BIND_POINT_GRAPHICS, pl->instance);
 
+    c->bound_gfx_pl = pl;
     c->bound_graphics_pline = c->graphics_pline_requires;
-    c->graphics_pline_requires = vkapi_graphics_pline_key_init();
+    vkapi_pl_state_set_bound(&c->driver->pl_state);
 }
 
 vkapi_graphics_pl_t* vkapi_pline_cache_find_or_create_gfx_pline(
@@ -130,15 +202,19 @@ vkapi_graphics_pl_t* vkapi_pline_cache_find_or_create_gfx_pline(
 {
     assert(c);
     assert(c->graphics_pline_requires.pl_layout);
-    vkapi_graphics_pl_t* pl = HASH_SET_GET(&c->gfx_pipelines, &c->graphics_pline_requires);
+    assert(!c->driver->pl_state.dirty_blocks);
+
+    // Keyed by the state hash, which is built from the block hashes, so the full key isn't hashed.
+    uint64_t hash = c->driver->pl_state.state_hash;
+    vkapi_graphics_pl_t* pl = hash_set_get_with_hash(&c->gfx_pipelines, hash);
     if (pl)
     {
         return pl;
     }
 
-    vkapi_graphics_pl_t new_pl =
-        vkapi_graph_pl_create(c->driver->context, &c->graphics_pline_requires, spec_consts);
-    return HASH_SET_INSERT(&c->gfx_pipelines, &c->graphics_pline_requires, &new_pl);
+    vkapi_graphics_pl_t new_pl = vkapi_graph_pl_create(
+        c->driver->context, &c->driver->pl_disk_cache, &c->graphics_pline_requires, spec_consts);
+    return hash_set_insert_with_hash(&c->gfx_pipelines, hash, &new_pl);
 }
 
 void vkapi_pline_cache_bind_compute_pipeline(vkapi_pipeline_cache_t* c, VkCommandBuffer cmd_buffer)
@@ -160,15 +236,18 @@ vkapi_compute_pl_t* vkapi_pline_cache_find_or_create_compute_pline(vkapi_pipelin
     {
         return pl;
     }
-    vkapi_compute_pl_t new_pl =
-        vkapi_compute_pl_create(c->driver->context, &c->compute_pline_requires);
+    vkapi_compute_pl_t new_pl = vkapi_compute_pl_create(
+        c->driver->context, &c->driver->pl_disk_cache, &c->compute_pline_requires);
     return HASH_SET_INSERT(&c->compute_pipelines, &c->compute_pline_requires, &new_pl);
 }
 
 void vkapi_pline_cache_bind_gfx_shader_modules(vkapi_pipeline_cache_t* c, shader_prog_bundle_t* b)
 {
-    shader_bundle_get_shader_stage_create_info_all(
-        b, c->driver, c->graphics_pline_requires.shaders);
+    // Unused stages must be cleared as the state persists between binds.
+    VkPipelineShaderStageCreateInfo shaders[RPE_BACKEND_SHADER_STAGE_MAX_COUNT] = {0};
+    shader_bundle_get_shader_stage_create_info_all(b, c->driver, shaders);
+    _pline_cache_set_state(
+        c, c->graphics_pline_requires.shaders, shaders, sizeof(shaders), VKAPI_PL_STATE_SHADERS);
 }
 
 void vkapi_pline_cache_bind_compute_shader_modules(
@@ -188,7 +267,12 @@ void vkapi_pline_cache_bind_rpass(vkapi_pipeline_cache_t* c, VkRenderPass rpass)
 void vkapi_pline_cache_bind_gfx_pl_layout(vkapi_pipeline_cache_t* c, VkPipelineLayout layout)
 {
     assert(c);
-    c->graphics_pline_requires.pl_layout = layout;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.pl_layout,
+        &layout,
+        sizeof(VkPipelineLayout),
+        VKAPI_PL_STATE_SHADERS);
 }
 
 void vkapi_pline_cache_bind_compute_pl_layout(vkapi_pipeline_cache_t* c, VkPipelineLayout layout)
@@ -200,62 +284,117 @@ void vkapi_pline_cache_bind_compute_pl_layout(vkapi_pipeline_cache_t* c, VkPipel
 void vkapi_pline_cache_bind_cull_mode(vkapi_pipeline_cache_t* c, VkCullModeFlagBits cullmode)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.cull_mode = cullmode;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.cull_mode,
+        &cullmode,
+        sizeof(VkCullModeFlagBits),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_polygon_mode(vkapi_pipeline_cache_t* c, VkPolygonMode polymode)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.polygon_mode = polymode;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.polygon_mode,
+        &polymode,
+        sizeof(VkPolygonMode),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_front_face(vkapi_pipeline_cache_t* c, VkFrontFace face)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.front_face = face;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.front_face,
+        &face,
+        sizeof(VkFrontFace),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_topology(vkapi_pipeline_cache_t* c, VkPrimitiveTopology topo)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.topology = topo;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.topology,
+        &topo,
+        sizeof(VkPrimitiveTopology),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_prim_restart(vkapi_pipeline_cache_t* c, bool state)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.prim_restart = state;
+    VkBool32 value = state;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.prim_restart,
+        &value,
+        sizeof(VkBool32),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_depth_stencil_block(
     vkapi_pipeline_cache_t* c, struct DepthStencilBlock* ds)
 {
     assert(c);
-    c->graphics_pline_requires.depth_stencil_block = *ds;
+    assert(ds);
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.depth_stencil_block,
+        ds,
+        sizeof(struct DepthStencilBlock),
+        VKAPI_PL_STATE_DEPTH_STENCIL);
 }
 
 void vkapi_pline_cache_bind_depth_test_enable(vkapi_pipeline_cache_t* c, bool state)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.depth_test_enable = state;
+    VkBool32 value = state;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.depth_test_enable,
+        &value,
+        sizeof(VkBool32),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_depth_write_enable(vkapi_pipeline_cache_t* c, bool state)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.depth_write_enable = state;
+    VkBool32 value = state;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.depth_write_enable,
+        &value,
+        sizeof(VkBool32),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_depth_compare_op(vkapi_pipeline_cache_t* c, VkCompareOp op)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.depth_compare_op = op;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.depth_compare_op,
+        &op,
+        sizeof(VkCompareOp),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_depth_clamp(vkapi_pipeline_cache_t* c, bool state)
 {
     assert(c);
-    c->graphics_pline_requires.raster_state.depth_clamp_enable = state;
+    VkBool32 value = state;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.raster_state.depth_clamp_enable,
+        &value,
+        sizeof(VkBool32),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_colour_attach_count(vkapi_pipeline_cache_t* c, uint32_t count)
@@ -267,34 +406,58 @@ void vkapi_pline_cache_bind_colour_attach_count(vkapi_pipeline_cache_t* c, uint3
 void vkapi_pline_cache_bind_tess_vert_count(vkapi_pipeline_cache_t* c, size_t count)
 {
     assert(c);
-    c->graphics_pline_requires.tesse_vert_count = count;
+    uint32_t value = count;
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.tesse_vert_count,
+        &value,
+        sizeof(uint32_t),
+        VKAPI_PL_STATE_RASTER);
 }
 
 void vkapi_pline_cache_bind_blend_factor_block(
     vkapi_pipeline_cache_t* c, struct BlendFactorBlock* state)
 {
     assert(c);
-    c->graphics_pline_requires.blend_factor_block = *state;
+    assert(state);
+    _pline_cache_set_state(
+        c,
+        &c->graphics_pline_requires.blend_factor_block,
+        state,
+        sizeof(struct BlendFactorBlock),
+        VKAPI_PL_STATE_BLEND);
 }
 
 void vkapi_pline_cache_bind_spec_constants(vkapi_pipeline_cache_t* c, shader_prog_bundle_t* b)
 {
     assert(c);
     assert(b);
+    graphics_pl_key_t* k = &c->graphics_pline_requires;
+
+    // Stages without constants are cleared as the state persists between binds.
+    VkSpecializationMapEntry entries[RPE_BACKEND_SHADER_STAGE_MAX_COUNT]
+                                    [VKAPI_PIPELINE_MAX_SPECIALIZATION_COUNT] = {0};
+    uint32_t entry_counts[RPE_BACKEND_SHADER_STAGE_MAX_COUNT] = {0};
+    uint32_t data_hashes[RPE_BACKEND_SHADER_STAGE_MAX_COUNT] = {0};
     for (int i = 0; i < RPE_BACKEND_SHADER_STAGE_MAX_COUNT; ++i)
     {
         if (b->spec_const_params[i].entry_count > 0)
         {
             memcpy(
-                c->graphics_pline_requires.spec_map_entries[i],
+                entries[i],
                 b->spec_const_params[i].entries,
                 sizeof(VkSpecializationMapEntry) * b->spec_const_params[i].entry_count);
-            c->graphics_pline_requires.spec_map_entry_count[i] =
-                b->spec_const_params[i].entry_count;
-            c->graphics_pline_requires.spec_data_hash[i] =
+            entry_counts[i] = b->spec_const_params[i].entry_count;
+            data_hashes[i] =
                 murmur2_hash(b->spec_const_params[i].data, b->spec_const_params[i].data_size, 0);
         }
     }
+    _pline_cache_set_state(
+        c, k->spec_map_entries, entries, sizeof(entries), VKAPI_PL_STATE_SHADERS);
+    _pline_cache_set_state(
+        c, k->spec_map_entry_count, entry_counts, sizeof(entry_counts), VKAPI_PL_STATE_SHADERS);
+    _pline_cache_set_state(
+        c, k->spec_data_hash, data_hashes, sizeof(data_hashes), VKAPI_PL_STATE_SHADERS);
 }
 
 void vkapi_pline_cache_bind_vertex_input(
@@ -305,14 +468,18 @@ void vkapi_pline_cache_bind_vertex_input(
     assert(c);
     assert(vert_attr_descs);
     assert(vert_bind_descs);
-    memcpy(
+    _pline_cache_set_state(
+        c,
         c->graphics_pline_requires.vert_attr_descs,
         vert_attr_descs,
-        sizeof(VkVertexInputAttributeDescription) * VKAPI_PIPELINE_MAX_VERTEX_ATTR_COUNT);
-    memcpy(
+        sizeof(VkVertexInputAttributeDescription) * VKAPI_PIPELINE_MAX_VERTEX_ATTR_COUNT,
+        VKAPI_PL_STATE_VERTEX_INPUT);
+    _pline_cache_set_state(
+        c,
         c->graphics_pline_requires.vert_bind_descs,
         vert_bind_descs,
-        sizeof(VkVertexInputBindingDescription) * VKAPI_PIPELINE_MAX_INPUT_BIND_COUNT);
+        sizeof(VkVertexInputBindingDescription) * VKAPI_PIPELINE_MAX_INPUT_BIND_COUNT,
+        VKAPI_PL_STATE_VERTEX_INPUT);
 }
 
 vkapi_pl_layout_t*
@@ -24,6 +24,7 @@
 #include "common.h"
 #include "descriptor_cache.h"
 #include "pipeline.h"
+#include "pipeline_state.h"
 
 #include <utility/hash_set.h>
 
@@ -129,8 +130,11 @@ typedef struct PipelineCache
     /// current bound pipeline.
     graphics_pl_key_t bound_graphics_pline;
     compute_pl_key_t bound_compute_pline;
+    /// Only valid when the driver's pipeline state tracker has a bound pipeline.
+    vkapi_graphics_pl_t* bound_gfx_pl;
 
-    /// the requirements of the current descriptor and pipelines
+    /// the requirements of the current descriptor and pipelines. The graphics requirements persist
+    /// between binds, with changes tracked per block by the driver's pipeline state tracker.
     graphics_pl_key_t graphics_pline_requires;
     compute_pl_key_t compute_pline_requires;
 
@@ -146,9 +150,23 @@ void vkapi_pline_cache_bind_graphics_pline(
     struct SpecConstParams* spec_consts,
     bool force_rebind);
 
+/**
+ Find a graphics pipeline matching the current state, creating a new one if required. The state
+ hash must be up to date - see @sa vkapi_pline_cache_update_state_hash.
+ */
 vkapi_graphics_pl_t* vkapi_pline_cache_find_or_create_gfx_pline(
     vkapi_pipeline_cache_t* c, struct SpecConstParams* spec_consts);
 
+/**
+ Compute the hash of a single block of the graphics pipeline key.
+ */
+uint64_t vkapi_pline_cache_hash_block(graphics_pl_key_t* key, enum PipelineStateBlock block);
+
+/**
+ Rehash the blocks of the required graphics state which have been marked as dirty.
+ */
+void vkapi_pline_cache_update_state_hash(vkapi_pipeline_cache_t* c);
+
 void vkapi_pline_cache_bind_compute_pipeline(vkapi_pipeline_cache_t* c, VkCommandBuffer cmd_buffer);
 
 vkapi_compute_pl_t* vkapi_pline_cache_find_or_create_compute_pline(vkapi_pipeline_cache_t* c);
@@ -0,0 +1,253 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pipeline_disk_cache.h"
+
+#include "context.h"
+
+#include <string.h>
+#include <utility/arena.h>
+#include <utility/filesystem.h>
+#include <utility/hash.h>
+
+enum PipelineDiskCacheStatus vkapi_pl_disk_cache_validate(
+    const void* blob, size_t size, const VkPhysicalDeviceProperties* props)
+{
+    assert(blob);
+    assert(props);
+
+    if (size < sizeof(vkapi_pl_disk_cache_header_t))
+    {
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+    vkapi_pl_disk_cache_header_t header;
+    memcpy(&header, blob, sizeof(vkapi_pl_disk_cache_header_t));
+    if (header.magic != VKAPI_PL_DISK_CACHE_MAGIC)
+    {
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+    // A cache written by a different version of this layout isn't corrupt, just unusable.
+    if (header.version != VKAPI_PL_DISK_CACHE_VERSION)
+    {
+        return VKAPI_PL_DISK_CACHE_MISMATCH;
+    }
+    if (header.vendor_id != props->vendorID || header.device_id != props->deviceID ||
+        header.driver_version != props->driverVersion ||
+        memcmp(header.uuid, props->pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        return VKAPI_PL_DISK_CACHE_MISMATCH;
+    }
+
+    const uint8_t* data = (const uint8_t*)blob + sizeof(vkapi_pl_disk_cache_header_t);
+    if (header.data_size != size - sizeof(vkapi_pl_disk_cache_header_t) ||
+        header.data_size < sizeof(VkPipelineCacheHeaderVersionOne) ||
+        murmur2_hash((void*)data, (uint32_t)header.data_size, 0) != header.data_hash)
+    {
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+
+    // The Vulkan header should agree with ours - if not, the data can't be trusted.
+    VkPipelineCacheHeaderVersionOne vk_header;
+    memcpy(&vk_header, data, sizeof(VkPipelineCacheHeaderVersionOne));
+    if (vk_header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        vk_header.headerSize < sizeof(VkPipelineCacheHeaderVersionOne) ||
+        vk_header.vendorID != props->vendorID || vk_header.deviceID != props->deviceID ||
+        memcmp(vk_header.pipelineCacheUUID, props->pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+    return VKAPI_PL_DISK_CACHE_VALID;
+}
+
+enum PipelineDiskCacheStatus vkapi_pl_disk_cache_read_blob(
+    const char* path,
+    const VkPhysicalDeviceProperties* props,
+    arena_t* arena,
+    void** out_blob,
+    size_t* out_size)
+{
+    assert(path);
+    assert(out_blob);
+    assert(out_size);
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+    {
+        return VKAPI_PL_DISK_CACHE_MISSING;
+    }
+    size_t size = fs_get_file_size(fp);
+    if (size < sizeof(vkapi_pl_disk_cache_header_t))
+    {
+        fclose(fp);
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+    uint8_t* blob = ARENA_MAKE_ARRAY(arena, uint8_t, size, 0);
+    size_t read_size = fread(blob, 1, size, fp);
+    fclose(fp);
+    if (read_size != size)
+    {
+        return VKAPI_PL_DISK_CACHE_CORRUPT;
+    }
+
+    enum PipelineDiskCacheStatus status = vkapi_pl_disk_cache_validate(blob, size, props);
+    if (status == VKAPI_PL_DISK_CACHE_VALID)
+    {
+        *out_blob = blob;
+        *out_size = size;
+    }
+    return status;
+}
+
+bool vkapi_pl_disk_cache_write_blob(
+    const char* path,
+    const VkPhysicalDeviceProperties* props,
+    const void* data,
+    size_t data_size,
+    uint32_t pipeline_count,
+    arena_t* arena)
+{
+    assert(path);
+    assert(props);
+    assert(data);
+
+    vkapi_pl_disk_cache_header_t header = {
+        .magic = VKAPI_PL_DISK_CACHE_MAGIC,
+        .version = VKAPI_PL_DISK_CACHE_VERSION,
+        .vendor_id = props->vendorID,
+        .device_id = props->deviceID,
+        .driver_version = props->driverVersion,
+        .pipeline_count = pipeline_count,
+        .data_size = data_size,
+        .data_hash = murmur2_hash((void*)data, (uint32_t)data_size, 0)};
+    memcpy(header.uuid, props->pipelineCacheUUID, VK_UUID_SIZE);
+
+    size_t size = sizeof(vkapi_pl_disk_cache_header_t) + data_size;
+    uint8_t* blob = ARENA_MAKE_ARRAY(arena, uint8_t, size, 0);
+    memcpy(blob, &header, sizeof(vkapi_pl_disk_cache_header_t));
+    memcpy(blob + sizeof(vkapi_pl_disk_cache_header_t), data, data_size);
+    return fs_write_file_atomic(path, blob, size);
+}
+
+void vkapi_pl_disk_cache_init(
+    vkapi_pl_disk_cache_t* c, vkapi_context_t* context, const char* path, arena_t* arena)
+{
+    assert(c);
+    assert(context);
+
+    memset(c, 0, sizeof(vkapi_pl_disk_cache_t));
+    c->has_feedback = context->extensions.has_pipeline_creation_feedback;
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(context->physical, &props);
+
+    void* blob = NULL;
+    size_t blob_size = 0;
+    c->load_status = vkapi_pl_disk_cache_read_blob(path, &props, arena, &blob, &blob_size);
+
+    VkPipelineCacheCreateInfo ci = {0};
+    ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    if (c->load_status == VKAPI_PL_DISK_CACHE_VALID)
+    {
+        vkapi_pl_disk_cache_header_t* header = blob;
+        ci.initialDataSize = header->data_size;
+        ci.pInitialData = (uint8_t*)blob + sizeof(vkapi_pl_disk_cache_header_t);
+        c->loaded_pipeline_count = header->pipeline_count;
+    }
+    VK_CHECK_RESULT(vkCreatePipelineCache(context->device, &ci, VK_NULL_HANDLE, &c->instance));
+
+    switch (c->load_status)
+    {
+        case VKAPI_PL_DISK_CACHE_VALID:
+            log_info(
+                "Pipeline cache: loaded %zu bytes (%u pipelines) from %s",
+                ci.initialDataSize,
+                c->loaded_pipeline_count,
+                path);
+            break;
+        case VKAPI_PL_DISK_CACHE_MISSING:
+            log_info("Pipeline cache: no cache found at %s - starting cold.", path);
+            break;
+        case VKAPI_PL_DISK_CACHE_CORRUPT:
+            log_warn("Pipeline cache: %s is corrupt - starting cold.", path);
+            break;
+        case VKAPI_PL_DISK_CACHE_MISMATCH:
+            log_info("Pipeline cache: %s is for a different device/driver - starting cold.", path);
+            break;
+    }
+}
+
+void vkapi_pl_disk_cache_record(vkapi_pl_disk_cache_t* c, VkPipelineCreationFeedbackEXT* feedback)
+{
+    assert(c);
+    bool hit = feedback && (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) &&
+        (feedback->flags &
+         VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT);
+    atomic_fetch_add(hit ? &c->warm_count : &c->cold_count, 1);
+}
+
+vkapi_pl_disk_cache_stats_t vkapi_pl_disk_cache_get_stats(vkapi_pl_disk_cache_t* c)
+{
+    assert(c);
+    vkapi_pl_disk_cache_stats_t stats = {
+        .load_status = c->load_status,
+        .loaded_pipeline_count = c->loaded_pipeline_count,
+        .warm_count = atomic_load(&c->warm_count),
+        .cold_count = atomic_load(&c->cold_count),
+        .has_feedback = c->has_feedback};
+    return stats;
+}
+
+bool vkapi_pl_disk_cache_save(
+    vkapi_pl_disk_cache_t* c, vkapi_context_t* context, const char* path, arena_t* arena)
+{
+    assert(c);
+    assert(context);
+
+    vkapi_pl_disk_cache_stats_t stats = vkapi_pl_disk_cache_get_stats(c);
+    uint32_t pipeline_count = stats.warm_count + stats.cold_count;
+    log_info(
+        "Pipeline cache: %u pipelines created this run - %u warm, %u cold%s.",
+        pipeline_count,
+        stats.warm_count,
+        stats.cold_count,
+        stats.has_feedback ? "" : " (creation feedback not supported)");
+
+    size_t data_size = 0;
+    VK_CHECK_RESULT(vkGetPipelineCacheData(context->device, c->instance, &data_size, NULL));
+    if (!data_size)
+    {
+        return false;
+    }
+    void* data = ARENA_MAKE_ARRAY(arena, uint8_t, data_size, 0);
+    VK_CHECK_RESULT(vkGetPipelineCacheData(context->device, c->instance, &data_size, data));
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(context->physical, &props);
+    return vkapi_pl_disk_cache_write_blob(
+        path, &props, data, data_size, pipeline_count, arena);
+}
+
+void vkapi_pl_disk_cache_destroy(vkapi_pl_disk_cache_t* c, vkapi_context_t* context)
+{
+    assert(c);
+    vkDestroyPipelineCache(context->device, c->instance, VK_NULL_HANDLE);
+}
@@ -0,0 +1,177 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_PIPELINE_DISK_CACHE_H__
+#define __VKAPI_PIPELINE_DISK_CACHE_H__
+
+#include "common.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VKAPI_PL_DISK_CACHE_MAGIC 0x43504552 // "REPC"
+#define VKAPI_PL_DISK_CACHE_VERSION 1
+#define VKAPI_PL_DISK_CACHE_DEFAULT_PATH "pipeline_cache.bin"
+
+typedef struct VkApiContext vkapi_context_t;
+typedef struct Arena arena_t;
+
+enum PipelineDiskCacheStatus
+{
+    VKAPI_PL_DISK_CACHE_VALID,
+    /// No cache file exists - i.e. the first run.
+    VKAPI_PL_DISK_CACHE_MISSING,
+    /// The file is truncated or the contents don't match the hash.
+    VKAPI_PL_DISK_CACHE_CORRUPT,
+    /// The cache was written by a different device or driver.
+    VKAPI_PL_DISK_CACHE_MISMATCH
+};
+
+/**
+ Header written ahead of the Vulkan pipeline cache data. The Vulkan data has its own header, but
+ this adds the driver version, which the pipeline cache UUID isn't guaranteed to reflect, and a
+ hash of the data to detect corrupted files - not all drivers validate the cache data they are
+ given.
+ */
+typedef struct PipelineDiskCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t uuid[VK_UUID_SIZE];
+    /// The number of pipelines created by the run which wrote this cache.
+    uint32_t pipeline_count;
+    uint64_t data_size;
+    uint32_t data_hash;
+    uint32_t padding;
+} vkapi_pl_disk_cache_header_t;
+
+/**
+ How effective the cache loaded from disk has been for this run so far.
+ */
+typedef struct PipelineDiskCacheStats
+{
+    enum PipelineDiskCacheStatus load_status;
+    /// The pipeline count stated by the loaded cache - zero unless the load status is valid.
+    uint32_t loaded_pipeline_count;
+    /// Pipelines the driver reports were created from the cache.
+    uint32_t warm_count;
+    /// Pipelines which weren't in the cache, or all pipelines if feedback isn't supported.
+    uint32_t cold_count;
+    bool has_feedback;
+} vkapi_pl_disk_cache_stats_t;
+
+/**
+ A Vulkan pipeline cache which is persisted to disk between runs, used when creating all graphics
+ and compute pipelines.
+ */
+typedef struct PipelineDiskCache
+{
+    VkPipelineCache instance;
+
+    enum PipelineDiskCacheStatus load_status;
+    /// The pipeline count stated by the loaded cache.
+    uint32_t loaded_pipeline_count;
+
+    /// A pipeline is warm if the driver reports it was created from the cache. Only valid if
+    /// pipeline creation feedback is supported, otherwise all pipelines are counted as cold.
+    atomic_uint warm_count;
+    atomic_uint cold_count;
+    bool has_feedback;
+} vkapi_pl_disk_cache_t;
+
+/**
+ Check a cache blob loaded from disk is valid for the specified device.
+ @param blob The blob, header followed by the Vulkan pipeline cache data.
+ @param size The size of the blob in bytes.
+ @param props The properties of the device the cache will be used with.
+ @return The status of the blob. Only if valid should the data be passed to Vulkan.
+ */
+enum PipelineDiskCacheStatus vkapi_pl_disk_cache_validate(
+    const void* blob, size_t size, const VkPhysicalDeviceProperties* props);
+
+/**
+ Load a cache blob from disk and validate it.
+ @param path The path of the cache file.
+ @param props The properties of the device the cache will be used with.
+ @param arena The arena the blob is allocated from.
+ @param [out] out_blob The blob - only set if the blob is valid.
+ @param [out] out_size The size of the blob in bytes.
+ @return The status of the blob.
+ */
+enum PipelineDiskCacheStatus vkapi_pl_disk_cache_read_blob(
+    const char* path,
+    const VkPhysicalDeviceProperties* props,
+    arena_t* arena,
+    void** out_blob,
+    size_t* out_size);
+
+/**
+ Write Vulkan pipeline cache data to disk, prefixed by the header. The file is replaced atomically.
+ @param path The path of the cache file.
+ @param props The properties of the device the data was created by.
+ @param data The Vulkan pipeline cache data.
+ @param data_size The size of the data in bytes.
+ @param pipeline_count The number of pipelines created by this run.
+ @param arena The arena used to assemble the blob.
+ @return true if the file was written successfully.
+ */
+bool vkapi_pl_disk_cache_write_blob(
+    const char* path,
+    const VkPhysicalDeviceProperties* props,
+    const void* data,
+    size_t data_size,
+    uint32_t pipeline_count,
+    arena_t* arena);
+
+/**
+ Create the Vulkan pipeline cache, seeded with the cache file if it is valid for this device. A
+ missing, corrupt or mismatched file results in an empty (cold) cache.
+ */
+void vkapi_pl_disk_cache_init(
+    vkapi_pl_disk_cache_t* c, vkapi_context_t* context, const char* path, arena_t* arena);
+
+/**
+ Record the creation of a pipeline.
+ @param feedback The pipeline creation feedback, or NULL if not supported.
+ */
+void vkapi_pl_disk_cache_record(vkapi_pl_disk_cache_t* c, VkPipelineCreationFeedbackEXT* feedback);
+
+/**
+ @return The load status and the warm/cold pipeline counts since the cache was initialised. Safe to
+ call while pipelines are being created.
+ */
+vkapi_pl_disk_cache_stats_t vkapi_pl_disk_cache_get_stats(vkapi_pl_disk_cache_t* c);
+
+/**
+ Write the cache to disk.
+ @return true if the file was written successfully.
+ */
+bool vkapi_pl_disk_cache_save(
+    vkapi_pl_disk_cache_t* c, vkapi_context_t* context, const char* path, arena_t* arena);
+
+void vkapi_pl_disk_cache_destroy(vkapi_pl_disk_cache_t* c, vkapi_context_t* context);
+
+#endif
@@ -0,0 +1,120 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pipeline_state.h"
+
+#include <assert.h>
+#include <string.h>
+#include <utility/hash.h>
+#include <utility/hash_set.h>
+
+void vkapi_pl_state_init(vkapi_pl_state_tracker_t* t)
+{
+    assert(t);
+    memset(t, 0, sizeof(vkapi_pl_state_tracker_t));
+    t->dirty_blocks = VKAPI_PL_STATE_ALL_DIRTY;
+}
+
+void vkapi_pl_state_mark_dirty(vkapi_pl_state_tracker_t* t, enum PipelineStateBlock block)
+{
+    assert(t);
+    assert(block < VKAPI_PL_STATE_BLOCK_COUNT);
+    t->dirty_blocks |= 1u << block;
+}
+
+void vkapi_pl_state_set_block_hash(
+    vkapi_pl_state_tracker_t* t, enum PipelineStateBlock block, uint64_t hash)
+{
+    assert(t);
+    assert(block < VKAPI_PL_STATE_BLOCK_COUNT);
+    t->block_hashes[block] = hash;
+    t->dirty_blocks &= ~(1u << block);
+    if (t->dirty_blocks)
+    {
+        return;
+    }
+
+    uint64_t state_hash = murmur2_hash64(t->block_hashes, sizeof(t->block_hashes), 0);
+    // The state hash is used as the pipeline hash set key, which reserves these values.
+    if (state_hash == HASH_NULL || state_hash == HASH_DELETED)
+    {
+        state_hash = 1;
+    }
+    t->state_hash = state_hash;
+}
+
+bool vkapi_pl_state_requires_bind(vkapi_pl_state_tracker_t* t, bool force_rebind)
+{
+    assert(t);
+    assert(!t->dirty_blocks && "All dirty blocks must be rehashed before binding.");
+    // A block may be dirtied and then set back to its previous value, so the combined hash is
+    // compared rather than relying on the dirty bits alone.
+    if (!force_rebind && t->bound_state_hash == t->state_hash)
+    {
+        t->stats.redundant_pl_bind_count++;
+        return false;
+    }
+    return true;
+}
+
+void vkapi_pl_state_set_bound(vkapi_pl_state_tracker_t* t)
+{
+    assert(t);
+    assert(!t->dirty_blocks);
+    t->bound_state_hash = t->state_hash;
+    t->stats.pl_bind_count++;
+}
+
+bool vkapi_pl_state_requires_desc_bind(
+    vkapi_pl_state_tracker_t* t, uint64_t desc_hash, bool force_rebind)
+{
+    assert(t);
+    assert(desc_hash);
+    if (!force_rebind && t->bound_desc_hash == desc_hash)
+    {
+        t->stats.redundant_desc_bind_count++;
+        return false;
+    }
+    return true;
+}
+
+void vkapi_pl_state_set_desc_bound(vkapi_pl_state_tracker_t* t, uint64_t desc_hash)
+{
+    assert(t);
+    t->bound_desc_hash = desc_hash;
+    t->stats.desc_bind_count++;
+}
+
+void vkapi_pl_state_invalidate(vkapi_pl_state_tracker_t* t)
+{
+    assert(t);
+    t->bound_state_hash = 0;
+    t->bound_desc_hash = 0;
+}
+
+void vkapi_pl_state_end_frame(vkapi_pl_state_tracker_t* t)
+{
+    assert(t);
+    t->last_frame_stats = t->stats;
+    memset(&t->stats, 0, sizeof(vkapi_pl_bind_stats_t));
+    vkapi_pl_state_invalidate(t);
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_PIPELINE_STATE_H__
+#define __VKAPI_PIPELINE_STATE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ The sub-blocks which make up the graphics pipeline key. Each block is hashed separately, so a
+ state change only requires the block it belongs to to be rehashed.
+ */
+enum PipelineStateBlock
+{
+    /// Rasterisation, depth and primitive state.
+    VKAPI_PL_STATE_RASTER,
+    VKAPI_PL_STATE_DEPTH_STENCIL,
+    VKAPI_PL_STATE_BLEND,
+    VKAPI_PL_STATE_VERTEX_INPUT,
+    /// Shader stages, specialisation constants and the pipeline layout.
+    VKAPI_PL_STATE_SHADERS,
+    /// The render pass and colour attachment count.
+    VKAPI_PL_STATE_RENDER_PASS,
+    VKAPI_PL_STATE_BLOCK_COUNT
+};
+
+#define VKAPI_PL_STATE_ALL_DIRTY ((1u << VKAPI_PL_STATE_BLOCK_COUNT) - 1)
+
+typedef struct PipelineBindStats
+{
+    uint32_t pl_bind_count;
+    /// Pipeline binds skipped as the state was unchanged since the previous bind.
+    uint32_t redundant_pl_bind_count;
+    uint32_t desc_bind_count;
+    /// Descriptor set binds skipped as the sets and layout were unchanged.
+    uint32_t redundant_desc_bind_count;
+} vkapi_pl_bind_stats_t;
+
+/**
+ Tracks which blocks of the graphics pipeline state have changed since the pipeline was last
+ bound. Setters mark a block dirty only when its value changes, and only the dirty blocks are
+ rehashed before a bind. The block hashes are combined into the pipeline key hash, so the whole
+ key is never hashed or compared. This holds no Vulkan state.
+ */
+typedef struct PipelineStateTracker
+{
+    uint64_t block_hashes[VKAPI_PL_STATE_BLOCK_COUNT];
+    uint32_t dirty_blocks;
+    /// The combined hash of all blocks - only valid when no blocks are dirty.
+    uint64_t state_hash;
+    /// The state hash of the pipeline bound to the command buffer, or zero if none is bound.
+    uint64_t bound_state_hash;
+    /// The hash of the bound descriptor sets and their layout, or zero if none are bound.
+    uint64_t bound_desc_hash;
+    /// Counts for the current frame.
+    vkapi_pl_bind_stats_t stats;
+    /// Counts for the last completed frame.
+    vkapi_pl_bind_stats_t last_frame_stats;
+} vkapi_pl_state_tracker_t;
+
+void vkapi_pl_state_init(vkapi_pl_state_tracker_t* t);
+
+void vkapi_pl_state_mark_dirty(vkapi_pl_state_tracker_t* t, enum PipelineStateBlock block);
+
+static inline bool
+vkapi_pl_state_is_block_dirty(vkapi_pl_state_tracker_t* t, enum PipelineStateBlock block)
+{
+    return t->dirty_blocks & (1u << block);
+}
+
+/**
+ Set the hash of a block, clearing its dirty bit. Once all blocks are clean the state hash is
+ recomputed from the block hashes.
+ */
+void vkapi_pl_state_set_block_hash(
+    vkapi_pl_state_tracker_t* t, enum PipelineStateBlock block, uint64_t hash);
+
+/**
+ Check whether a pipeline bind is required. All dirty blocks must have been rehashed via @sa
+ vkapi_pl_state_set_block_hash before calling this. A skipped bind is counted as redundant.
+ @param force_rebind If true, a bind is always required.
+ @return true if the state differs from the bound pipeline, in which case the caller should bind
+ the pipeline and call @sa vkapi_pl_state_set_bound.
+ */
+bool vkapi_pl_state_requires_bind(vkapi_pl_state_tracker_t* t, bool force_rebind);
+
+void vkapi_pl_state_set_bound(vkapi_pl_state_tracker_t* t);
+
+/**
+ Check whether the descriptor sets need binding. A skipped bind is counted as redundant.
+ @param desc_hash A hash of the descriptor key, pipeline layout and bind point.
+ @return true if the caller should bind the sets and call @sa vkapi_pl_state_set_desc_bound.
+ */
+bool vkapi_pl_state_requires_desc_bind(
+    vkapi_pl_state_tracker_t* t, uint64_t desc_hash, bool force_rebind);
+
+void vkapi_pl_state_set_desc_bound(vkapi_pl_state_tracker_t* t, uint64_t desc_hash);
+
+/**
+ Forget the bound pipeline and descriptor sets - called when the command buffer is no longer the
+ one they were bound to, or the pipeline may have been destroyed.
+ */
+void vkapi_pl_state_invalidate(vkapi_pl_state_tracker_t* t);
+
+/**
+ Move the current counts to @sa last_frame_stats and reset them for the next frame.
+ */
+void vkapi_pl_state_end_frame(vkapi_pl_state_tracker_t* t);
+
+#endif
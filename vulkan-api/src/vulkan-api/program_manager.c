@@ -29,6 +29,7 @@
 #include "shader.h"
 
 #include <assert.h>
+#include <string.h>
 #include <utility/filesystem.h>
 #include <utility/hash.h>
 
@@ -315,9 +316,33 @@ program_cache_t* program_cache_init(arena_t* arena)
     program_cache_t* out = ARENA_MAKE_STRUCT(arena, program_cache_t, ARENA_ZERO_MEMORY);
     MAKE_DYN_ARRAY(shader_prog_bundle_t, arena, 50, &out->program_bundles);
     MAKE_DYN_ARRAY(shader_t, arena, 50, &out->shaders);
+    shader_compiler_process_init();
+    vkapi_shader_cache_init(
+        &out->shader_cache,
+        VKAPI_SHADER_CACHE_DEFAULT_PATH,
+        VKAPI_SHADER_CACHE_DEFAULT_MAX_SIZE,
+        arena);
     return out;
 }
 
+spirv_binary_t _program_cache_load_spirv(
+    program_cache_t* c, shader_t* shader, const char* filename, arena_t* arena)
+{
+    spirv_binary_t bin = shader_load_spirv(filename, arena);
+    if (!bin.words)
+    {
+        return bin;
+    }
+    // Only the reflection is cached for pre-compiled shaders.
+    uint64_t key = vkapi_shader_cache_spirv_key(&bin, shader->stage);
+    if (!vkapi_shader_cache_get(&c->shader_cache, key, NULL, &shader->resource_binding, arena))
+    {
+        shader_reflect_spirv(shader, bin.words, bin.size, arena);
+        vkapi_shader_cache_insert(&c->shader_cache, key, NULL, &shader->resource_binding);
+    }
+    return bin;
+}
+
 shader_handle_t program_cache_compile_shader(
     program_cache_t* c,
     vkapi_context_t* context,
@@ -327,13 +352,21 @@ shader_handle_t program_cache_compile_shader(
 {
     shader_handle_t h;
     shader_t* shader = shader_init(stage, arena);
-    spirv_binary_t bin = shader_compile(shader, shader_code, "", arena);
-    if (!bin.words)
+
+    spirv_binary_t bin = {0};
+    uint64_t key = shader_code ? vkapi_shader_cache_glsl_key(shader_code, stage) : 0;
+    if (!shader_code ||
+        !vkapi_shader_cache_get(&c->shader_cache, key, &bin, &shader->resource_binding, arena))
     {
-        h.id = UINT32_MAX;
-        return h;
+        bin = shader_compile(shader, shader_code, "", arena);
+        if (!bin.words)
+        {
+            h.id = UINT32_MAX;
+            return h;
+        }
+        shader_reflect_spirv(shader, bin.words, bin.size, arena);
+        vkapi_shader_cache_insert(&c->shader_cache, key, &bin, &shader->resource_binding);
     }
-    shader_reflect_spirv(shader, bin.words, bin.size, arena);
     shader_create_vk_module(shader, context, bin);
 
     h.id = c->shaders.size;
@@ -341,6 +374,131 @@ shader_handle_t program_cache_compile_shader(
     return h;
 }
 
+void program_cache_compile_batch(
+    program_cache_t* c,
+    vkapi_context_t* context,
+    job_queue_t* jq,
+    const shader_compile_request_t* requests,
+    uint32_t count,
+    shader_handle_t* out_handles,
+    arena_t* arena)
+{
+    assert(c);
+    assert(requests);
+    assert(out_handles);
+
+    shader_t** shaders = ARENA_MAKE_ARRAY(arena, shader_t*, count + 1, 0);
+    spirv_binary_t* bins = ARENA_MAKE_ZERO_ARRAY(arena, spirv_binary_t, count + 1);
+    uint64_t* keys = ARENA_MAKE_ARRAY(arena, uint64_t, count + 1, 0);
+    bool* is_cached = ARENA_MAKE_ZERO_ARRAY(arena, bool, count + 1);
+    // The index of an earlier identical request, whose handle is shared.
+    uint32_t* dup_of = ARENA_MAKE_ARRAY(arena, uint32_t, count + 1, 0);
+
+    // Misses are gathered so only those are dispatched to the job queue - GLSL misses are
+    // compiled and reflected, pre-compiled SPIR-V misses are only reflected.
+    uint32_t miss_count = 0;
+    uint32_t* miss_indices = ARENA_MAKE_ARRAY(arena, uint32_t, count + 1, 0);
+    shader_t** miss_shaders = ARENA_MAKE_ARRAY(arena, shader_t*, count + 1, 0);
+    const char** miss_codes = ARENA_MAKE_ARRAY(arena, const char*, count + 1, 0);
+    spirv_binary_t* miss_bins = ARENA_MAKE_ZERO_ARRAY(arena, spirv_binary_t, count + 1);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const shader_compile_request_t* req = &requests[i];
+        dup_of[i] = UINT32_MAX;
+        shaders[i] = shader_init(req->stage, arena);
+        if (!req->filename && !req->shader_code)
+        {
+            log_error("There is no shader code to process!");
+            continue;
+        }
+
+        if (req->filename)
+        {
+            for (uint32_t j = 0; j < i && dup_of[i] == UINT32_MAX; ++j)
+            {
+                if (requests[j].filename && requests[j].stage == req->stage &&
+                    strcmp(requests[j].filename, req->filename) == 0)
+                {
+                    dup_of[i] = j;
+                }
+            }
+            if (dup_of[i] != UINT32_MAX)
+            {
+                continue;
+            }
+            bins[i] = shader_load_spirv(req->filename, arena);
+            if (!bins[i].words)
+            {
+                continue;
+            }
+            keys[i] = vkapi_shader_cache_spirv_key(&bins[i], req->stage);
+            // Only the reflection is cached for pre-compiled shaders.
+            is_cached[i] = vkapi_shader_cache_get(
+                &c->shader_cache, keys[i], NULL, &shaders[i]->resource_binding, arena);
+        }
+        else
+        {
+            // The stage is part of the key, so equal keys are identical requests.
+            keys[i] = vkapi_shader_cache_glsl_key(req->shader_code, req->stage);
+            for (uint32_t j = 0; j < i && dup_of[i] == UINT32_MAX; ++j)
+            {
+                if (!requests[j].filename && requests[j].shader_code && keys[j] == keys[i])
+                {
+                    dup_of[i] = j;
+                }
+            }
+            if (dup_of[i] != UINT32_MAX)
+            {
+                continue;
+            }
+            is_cached[i] = vkapi_shader_cache_get(
+                &c->shader_cache, keys[i], &bins[i], &shaders[i]->resource_binding, arena);
+        }
+
+        if (!is_cached[i])
+        {
+            miss_indices[miss_count] = i;
+            miss_shaders[miss_count] = shaders[i];
+            miss_codes[miss_count] = req->shader_code;
+            miss_bins[miss_count++] = bins[i];
+        }
+    }
+
+    shader_compile_batch(
+        &c->compiler_pool, jq, miss_shaders, miss_codes, miss_count, miss_bins, arena);
+    for (uint32_t i = 0; i < miss_count; ++i)
+    {
+        bins[miss_indices[i]] = miss_bins[i];
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Earlier requests are always resolved first, so a duplicate can take their handle.
+        if (dup_of[i] != UINT32_MAX)
+        {
+            out_handles[i] = out_handles[dup_of[i]];
+            continue;
+        }
+        if (!bins[i].words)
+        {
+            vkapi_invalidate_shader_handle(&out_handles[i]);
+            continue;
+        }
+        if (!is_cached[i])
+        {
+            vkapi_shader_cache_insert(
+                &c->shader_cache,
+                keys[i],
+                requests[i].filename ? NULL : &bins[i],
+                &shaders[i]->resource_binding);
+        }
+        shader_create_vk_module(shaders[i], context, bins[i]);
+        out_handles[i].id = c->shaders.size;
+        DYN_ARRAY_APPEND(&c->shaders, shaders[i]);
+    }
+}
+
 shader_handle_t program_cache_from_spirv(
     program_cache_t* c,
     vkapi_context_t* context,
@@ -350,13 +508,12 @@ shader_handle_t program_cache_from_spirv(
 {
     shader_handle_t h;
     shader_t* shader = shader_init(stage, arena);
-    spirv_binary_t bin = shader_load_spirv(filename, arena);
+    spirv_binary_t bin = _program_cache_load_spirv(c, shader, filename, arena);
     if (!bin.words)
     {
         h.id = UINT32_MAX;
         return h;
     }
-    shader_reflect_spirv(shader, bin.words, bin.size, arena);
     shader_create_vk_module(shader, context, bin);
 
     h.id = c->shaders.size;
@@ -373,6 +530,15 @@ shader_prog_bundle_t* program_cache_create_program_bundle(program_cache_t* c, ar
 
 void program_cache_destroy(program_cache_t* c, vkapi_driver_t* driver)
 {
+    if (!vkapi_shader_cache_save(
+            &c->shader_cache, VKAPI_SHADER_CACHE_DEFAULT_PATH, &driver->_perm_arena))
+    {
+        log_warn("Unable to write the shader cache to disk.");
+    }
+    vkapi_shader_cache_destroy(&c->shader_cache);
+    shader_compiler_pool_destroy(&c->compiler_pool);
+    shader_compiler_process_shutdown();
+
     for (size_t i = 0; i < c->shaders.size; ++i)
     {
         shader_t* s = DYN_ARRAY_GET_PTR(shader_t, &c->shaders, i);
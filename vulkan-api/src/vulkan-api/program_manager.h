@@ -27,6 +27,7 @@
 #include "descriptor_cache.h"
 #include "driver.h"
 #include "pipeline.h"
+#include "shader_cache.h"
 
 #include <utility/arena.h>
 #include <utility/hash_set.h>
@@ -166,6 +167,11 @@ typedef struct ProgramCache
     // into a complete shader program.
     arena_dyn_array_t shaders;
 
+    /// Compiled SPIR-V and reflection results persisted between runs.
+    vkapi_shader_cache_t shader_cache;
+
+    shader_compiler_pool_t compiler_pool;
+
 } program_cache_t;
 
 /* Shader bundle functions */
@@ -229,6 +235,39 @@ shader_handle_t program_cache_compile_shader(
     enum ShaderStage stage,
     arena_t* arena);
 
+typedef struct ShaderCompileRequest
+{
+    /// GLSL source - ignored if a SPIR-V filename is set.
+    const char* shader_code;
+    /// A pre-compiled SPIR-V file, relative to the shader directory. Only the reflection is
+    /// generated for these, so no compile job is required.
+    const char* filename;
+    enum ShaderStage stage;
+} shader_compile_request_t;
+
+/**
+ Compile a batch of shaders. Each GLSL shader which isn't in the shader cache is compiled as a job
+ on the queue, as is the reflection of each SPIR-V shader which isn't. Handles are assigned in
+ request order regardless of the order the jobs complete, and identical requests within the batch
+ are only processed once and share a handle.
+ @param c The program cache.
+ @param context A Vulkan context.
+ @param jq The job queue - the calling thread must be adopted. If NULL, shaders are compiled
+ serially.
+ @param requests The shaders to compile.
+ @param count The number of requests.
+ @param [out] out_handles The handle for each request - invalid if compilation failed.
+ @param arena An arena allocator.
+ */
+void program_cache_compile_batch(
+    program_cache_t* c,
+    vkapi_context_t* context,
+    job_queue_t* jq,
+    const shader_compile_request_t* requests,
+    uint32_t count,
+    shader_handle_t* out_handles,
+    arena_t* arena);
+
 shader_handle_t program_cache_from_spirv(
     program_cache_t* c,
     vkapi_context_t* context,
@@ -51,6 +51,7 @@ vkapi_res_cache_t* vkapi_res_cache_init(vkapi_driver_t* driver, arena_t* arena)
     MAKE_DYN_ARRAY(vkapi_texture_t, arena, 100, &i->textures);
     MAKE_DYN_ARRAY(vkapi_buffer_t, arena, 20, &i->buffers);
     MAKE_DYN_ARRAY(vkapi_texture_t, arena, 50, &i->textures_gc);
+    MAKE_DYN_ARRAY(vkapi_buffer_t, arena, 20, &i->buffers_gc);
     MAKE_DYN_ARRAY(texture_handle_t, arena, 20, &i->free_tex_slots);
     MAKE_DYN_ARRAY(buffer_handle_t, arena, 100, &i->free_buffer_slots);
     // Four slots are reserved for special swapchain textures.
@@ -110,18 +111,26 @@ texture_handle_t vkapi_res_cache_create_tex2d(
     uint32_t levels =
         mip_levels == 0xffff ? (uint32_t)floorf(log2f((float)MAX(width, height)) + 1) : mip_levels;
     vkapi_texture_t t = vkapi_texture_init(width, height, levels, array_count, type, format);
-    texture_handle_t handle = {.id = cache->textures.size};
     vkapi_texture_create_2d(context, vma, sampler_cache, &t, usage_flags, sampler_params);
+    return vkapi_res_cache_push_tex2d(cache, &t);
+}
+
+texture_handle_t vkapi_res_cache_push_tex2d(vkapi_res_cache_t* cache, vkapi_texture_t* tex)
+{
+    assert(cache);
+    assert(tex);
+    texture_handle_t handle = {.id = cache->textures.size};
     if (cache->free_tex_slots.size > 0)
     {
         handle = DYN_ARRAY_POP_BACK(texture_handle_t, &cache->free_tex_slots);
         assert(handle.id >= VKAPI_RES_CACHE_MAX_RESERVED_COUNT);
-        DYN_ARRAY_SET(&cache->textures, handle.id, &t);
+        DYN_ARRAY_SET(&cache->textures, handle.id, tex);
     }
     else
     {
-        DYN_ARRAY_APPEND(&cache->textures, &t);
+        DYN_ARRAY_APPEND(&cache->textures, tex);
     }
+    ++cache->tex_generation;
     return handle;
 }
 
@@ -210,6 +219,19 @@ void vkapi_res_cache_delete_tex2d(vkapi_res_cache_t* cache, texture_handle_t han
     DYN_ARRAY_APPEND(&cache->textures_gc, t);
     DYN_ARRAY_APPEND(&cache->free_tex_slots, &handle);
     t->is_valid = false;
+    ++cache->tex_generation;
+}
+
+void vkapi_res_cache_delete_buffer(vkapi_res_cache_t* cache, buffer_handle_t handle)
+{
+    assert(cache);
+    assert(vkapi_buffer_handle_is_valid(handle));
+    assert(handle.id < cache->buffers.size);
+
+    vkapi_buffer_t* b = DYN_ARRAY_GET_PTR(vkapi_buffer_t, &cache->buffers, handle.id);
+    b->frames_until_gc = VKAPI_MAX_COMMAND_BUFFER_SIZE;
+    DYN_ARRAY_APPEND(&cache->buffers_gc, b);
+    DYN_ARRAY_APPEND(&cache->free_buffer_slots, &handle);
 }
 
 void vkapi_res_cache_gc(vkapi_res_cache_t* c, vkapi_driver_t* driver)
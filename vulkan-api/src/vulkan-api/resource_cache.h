@@ -62,6 +62,10 @@ typedef struct VkApiResourceCache
 
     arena_dyn_array_t textures_gc;
     arena_dyn_array_t buffers_gc;
+
+    /// Incremented whenever a texture is added or removed, so descriptor sets which reference a
+    /// recreated texture, or all textures with bindless samplers, are invalidated.
+    uint32_t tex_generation;
 } vkapi_res_cache_t;
 
 bool vkapi_tex_handle_is_valid(texture_handle_t handle);
@@ -85,6 +89,12 @@ texture_handle_t vkapi_res_cache_create_tex2d(
     VkImageUsageFlags usage_flags,
     sampler_params_t* sampler_params);
 
+/**
+ Add a texture which has already been created to the cache. The cache takes ownership of the
+ texture and will destroy it upon calling @sa vkapi_res_cache_delete_tex2d.
+ */
+texture_handle_t vkapi_res_cache_push_tex2d(vkapi_res_cache_t* cache, vkapi_texture_t* tex);
+
 texture_handle_t vkapi_res_push_reserved_tex2d(
     vkapi_res_cache_t* cache,
     vkapi_context_t* context,
@@ -118,6 +128,12 @@ vkapi_buffer_t* vkapi_res_cache_get_buffer(vkapi_res_cache_t* cache, buffer_hand
 
 void vkapi_res_cache_delete_tex2d(vkapi_res_cache_t* cache, texture_handle_t handle);
 
+/**
+ Delete a buffer. As the buffer may still be in use by the GPU, it is not destroyed until
+ VKAPI_MAX_COMMAND_BUFFER_SIZE frames have passed. The handle slot can be reused straight away.
+ */
+void vkapi_res_cache_delete_buffer(vkapi_res_cache_t* cache, buffer_handle_t handle);
+
 void vkapi_res_cache_gc(vkapi_res_cache_t* c, vkapi_driver_t* driver);
 void vkapi_res_cache_destroy(vkapi_res_cache_t* c, vkapi_driver_t* driver);
 
@@ -169,8 +169,15 @@ glslang_stage_t shader_to_glslang_type(enum ShaderStage stage)
     return result;
 }
 
+void shader_compiler_process_init() { glslang_initialize_process(); }
+
+void shader_compiler_process_shutdown() { glslang_finalize_process(); }
+
 spirv_binary_t shader_compiler_compile(
-    glslang_stage_t stage, const char* shader_src, const char* filename, arena_t* arena)
+    glslang_stage_t stage,
+    const char* shader_src,
+    const char* filename,
+    const glslang_resource_t* resource)
 {
     const glslang_input_t input = {
         .language = GLSLANG_SOURCE_GLSL,
@@ -185,9 +192,7 @@ spirv_binary_t shader_compiler_compile(
         .force_default_version_and_profile = false,
         .forward_compatible = false,
         .messages = GLSLANG_MSG_DEFAULT_BIT,
-        .resource = glslang_create_resource(arena)};
-
-    glslang_initialize_process();
+        .resource = resource};
 
     glslang_shader_t* shader = glslang_shader_create(&input);
 
@@ -470,10 +475,125 @@ shader_compile(shader_t* shader, const char* shader_code, const char* filename,
     }
     // Compile into bytecode ready for wrapping.
     bin = shader_compiler_compile(
-        shader_to_glslang_type(shader->stage), shader_code, filename, arena);
+        shader_to_glslang_type(shader->stage),
+        shader_code,
+        filename,
+        glslang_create_resource(arena));
     return bin;
 }
 
+struct ShaderCompileJobArgs
+{
+    shader_compiler_pool_t* pool;
+    job_queue_t* jq;
+    shader_t* shader;
+    const char* shader_code;
+    spirv_binary_t* out_bin;
+};
+
+void _shader_compile_job(void* data)
+{
+    struct ShaderCompileJobArgs* args = data;
+    uint32_t idx =
+        args->jq ? job_queue_get_thread_index(args->jq) : VKAPI_SHADER_MAX_COMPILER_COUNT - 1;
+    shader_compiler_t* compiler = &args->pool->compilers[idx];
+    if (!compiler->resource)
+    {
+        int res = arena_new(VKAPI_SHADER_COMPILER_ARENA_SIZE, &compiler->arena);
+        assert(res == ARENA_SUCCESS);
+        compiler->resource = glslang_create_resource(&compiler->arena);
+    }
+
+    // Pre-compiled shaders are passed with their SPIR-V and no source, so only need reflecting.
+    if (args->shader_code)
+    {
+        *args->out_bin = shader_compiler_compile(
+            shader_to_glslang_type(args->shader->stage), args->shader_code, "", compiler->resource);
+    }
+    if (args->out_bin->words)
+    {
+        shader_reflect_spirv(
+            args->shader, args->out_bin->words, args->out_bin->size, &compiler->arena);
+    }
+}
+
+void shader_compile_batch(
+    shader_compiler_pool_t* pool,
+    job_queue_t* jq,
+    shader_t** shaders,
+    const char** shader_codes,
+    uint32_t count,
+    spirv_binary_t* out_bins,
+    arena_t* arena)
+{
+    assert(pool);
+    assert(shaders);
+    assert(shader_codes);
+    assert(out_bins);
+
+    struct ShaderCompileJobArgs* args =
+        ARENA_MAKE_ARRAY(arena, struct ShaderCompileJobArgs, count + 1, 0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        args[i] = (struct ShaderCompileJobArgs){
+            .pool = pool,
+            .jq = jq,
+            .shader = shaders[i],
+            .shader_code = shader_codes[i],
+            .out_bin = &out_bins[i]};
+    }
+
+    if (jq)
+    {
+        job_t* parent = job_queue_create_parent_job(jq);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            job_queue_run_job(jq, job_queue_create_job(jq, _shader_compile_job, &args[i], parent));
+        }
+        job_queue_run_and_wait(jq, parent);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            _shader_compile_job(&args[i]);
+        }
+    }
+
+    // The reflection names were allocated from the compiler arenas - copy to the caller's arena
+    // so the compiler arenas can be reset.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        shader_binding_t* b = &shaders[i]->resource_binding;
+        for (uint32_t j = 0; j < b->desc_layout_count; ++j)
+        {
+            b->desc_layouts[j].name = string_copy(&b->desc_layouts[j].name, arena);
+        }
+    }
+    for (uint32_t i = 0; i < VKAPI_SHADER_MAX_COMPILER_COUNT; ++i)
+    {
+        shader_compiler_t* compiler = &pool->compilers[i];
+        if (compiler->resource)
+        {
+            arena_reset(&compiler->arena);
+            compiler->resource = glslang_create_resource(&compiler->arena);
+        }
+    }
+}
+
+void shader_compiler_pool_destroy(shader_compiler_pool_t* pool)
+{
+    assert(pool);
+    for (uint32_t i = 0; i < VKAPI_SHADER_MAX_COMPILER_COUNT; ++i)
+    {
+        if (pool->compilers[i].resource)
+        {
+            arena_release(&pool->compilers[i].arena);
+            pool->compilers[i].resource = NULL;
+        }
+    }
+}
+
 void shader_create_vk_module(shader_t* shader, vkapi_context_t* context, spirv_binary_t bin)
 {
     assert(shader);
@@ -736,3 +856,169 @@ void shader_reflect_spirv(shader_t* shader, uint32_t* spirv, uint32_t word_count
 
     spvc_context_destroy(context);
 }
+
+void _shader_write(uint8_t* out, size_t* offset, const void* src, size_t size)
+{
+    if (out)
+    {
+        memcpy(out + *offset, src, size);
+    }
+    *offset += size;
+}
+
+void _shader_write_u32(uint8_t* out, size_t* offset, uint32_t value)
+{
+    _shader_write(out, offset, &value, sizeof(uint32_t));
+}
+
+void _shader_write_attrs(uint8_t* out, size_t* offset, const shader_attr_t* attrs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        _shader_write_u32(out, offset, attrs[i].location);
+        _shader_write_u32(out, offset, attrs[i].stride);
+        _shader_write_u32(out, offset, (uint32_t)attrs[i].format);
+    }
+}
+
+size_t shader_binding_serialise(const shader_binding_t* binding, uint8_t* out)
+{
+    assert(binding);
+    size_t offset = 0;
+
+    _shader_write_u32(out, &offset, binding->stage_input_count);
+    _shader_write_u32(out, &offset, binding->stage_output_count);
+    _shader_write_u32(out, &offset, binding->desc_layout_count);
+    _shader_write_u32(out, &offset, binding->spec_const_count);
+    uint64_t push_block_size = binding->push_block_size;
+    _shader_write(out, &offset, &push_block_size, sizeof(uint64_t));
+
+    _shader_write_attrs(out, &offset, binding->stage_inputs, binding->stage_input_count);
+    _shader_write_attrs(out, &offset, binding->stage_outputs, binding->stage_output_count);
+
+    for (uint32_t i = 0; i < binding->desc_layout_count; ++i)
+    {
+        const shader_desc_layout_t* l = &binding->desc_layouts[i];
+        uint64_t range = l->range;
+        uint8_t bindless = l->bindless_sampler;
+        _shader_write_u32(out, &offset, l->binding);
+        _shader_write_u32(out, &offset, l->set);
+        _shader_write(out, &offset, &range, sizeof(uint64_t));
+        _shader_write_u32(out, &offset, (uint32_t)l->type);
+        _shader_write_u32(out, &offset, (uint32_t)l->stage);
+        _shader_write(out, &offset, &bindless, sizeof(uint8_t));
+        _shader_write_u32(out, &offset, l->name.len);
+        _shader_write(out, &offset, l->name.data, l->name.len);
+    }
+
+    for (uint32_t i = 0; i < binding->spec_const_count; ++i)
+    {
+        _shader_write_u32(out, &offset, binding->spec_consts[i].id);
+        _shader_write_u32(out, &offset, binding->spec_consts[i].size);
+        _shader_write_u32(out, &offset, binding->spec_consts[i].offset);
+    }
+    return offset;
+}
+
+bool _shader_read(const uint8_t* data, size_t size, size_t* offset, void* dst, size_t dst_size)
+{
+    if (*offset + dst_size > size)
+    {
+        return false;
+    }
+    memcpy(dst, data + *offset, dst_size);
+    *offset += dst_size;
+    return true;
+}
+
+bool _shader_read_attrs(
+    const uint8_t* data, size_t size, size_t* offset, shader_attr_t* attrs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t format;
+        if (!_shader_read(data, size, offset, &attrs[i].location, sizeof(uint32_t)) ||
+            !_shader_read(data, size, offset, &attrs[i].stride, sizeof(uint32_t)) ||
+            !_shader_read(data, size, offset, &format, sizeof(uint32_t)))
+        {
+            return false;
+        }
+        attrs[i].format = (VkFormat)format;
+    }
+    return true;
+}
+
+bool shader_binding_deserialise(
+    shader_binding_t* binding, const uint8_t* data, size_t size, arena_t* arena)
+{
+    assert(binding);
+    assert(data);
+    memset(binding, 0, sizeof(shader_binding_t));
+    size_t offset = 0;
+
+    uint64_t push_block_size;
+    if (!_shader_read(data, size, &offset, &binding->stage_input_count, sizeof(uint32_t)) ||
+        !_shader_read(data, size, &offset, &binding->stage_output_count, sizeof(uint32_t)) ||
+        !_shader_read(data, size, &offset, &binding->desc_layout_count, sizeof(uint32_t)) ||
+        !_shader_read(data, size, &offset, &binding->spec_const_count, sizeof(uint32_t)) ||
+        !_shader_read(data, size, &offset, &push_block_size, sizeof(uint64_t)))
+    {
+        return false;
+    }
+    if (binding->stage_input_count > VKAPI_SHADER_MAX_STAGE_INPUTS ||
+        binding->stage_output_count > VKAPI_SHADER_MAX_STAGE_OUTPUTS ||
+        binding->desc_layout_count > VKAPI_SHADER_MAX_DESC_LAYOUTS ||
+        binding->spec_const_count > VKAPI_PIPELINE_MAX_SPECIALIZATION_COUNT)
+    {
+        return false;
+    }
+    binding->push_block_size = push_block_size;
+
+    if (!_shader_read_attrs(
+            data, size, &offset, binding->stage_inputs, binding->stage_input_count) ||
+        !_shader_read_attrs(
+            data, size, &offset, binding->stage_outputs, binding->stage_output_count))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < binding->desc_layout_count; ++i)
+    {
+        shader_desc_layout_t* l = &binding->desc_layouts[i];
+        uint64_t range;
+        uint32_t type, stage, name_len;
+        uint8_t bindless;
+        if (!_shader_read(data, size, &offset, &l->binding, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &l->set, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &range, sizeof(uint64_t)) ||
+            !_shader_read(data, size, &offset, &type, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &stage, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &bindless, sizeof(uint8_t)) ||
+            !_shader_read(data, size, &offset, &name_len, sizeof(uint32_t)) ||
+            offset + name_len > size)
+        {
+            return false;
+        }
+        l->range = range;
+        l->type = (VkDescriptorType)type;
+        l->stage = (VkShaderStageFlags)stage;
+        l->bindless_sampler = bindless;
+        l->name.len = name_len;
+        l->name.data = ARENA_MAKE_ARRAY(arena, char, name_len + 1, 0);
+        memcpy(l->name.data, data + offset, name_len);
+        l->name.data[name_len] = '\0';
+        offset += name_len;
+    }
+
+    for (uint32_t i = 0; i < binding->spec_const_count; ++i)
+    {
+        struct SpecializationConst* sc = &binding->spec_consts[i];
+        if (!_shader_read(data, size, &offset, &sc->id, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &sc->size, sizeof(uint32_t)) ||
+            !_shader_read(data, size, &offset, &sc->offset, sizeof(uint32_t)))
+        {
+            return false;
+        }
+    }
+    return offset == size;
+}
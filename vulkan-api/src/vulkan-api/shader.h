@@ -28,17 +28,23 @@
 #include "pipeline.h"
 
 #include <utility/arena.h>
+#include <utility/job_queue.h>
 #include <utility/string.h>
 
 #define VKAPI_SHADER_MAX_STAGE_INPUTS 15
 #define VKAPI_SHADER_MAX_STAGE_OUTPUTS 15
 #define VKAPI_SHADER_MAX_DESC_LAYOUTS 50
+/// The size of the arena each compiler uses for the glslang resources and reflection names.
+#define VKAPI_SHADER_COMPILER_ARENA_SIZE (1 << 20)
+/// A compiler per job queue thread, plus one for compiling without a job queue.
+#define VKAPI_SHADER_MAX_COMPILER_COUNT (JOB_QUEUE_MAX_THREAD_COUNT + 1)
 
 extern const size_t sizeof_shader_t;
 
 // Forward declarations.
 typedef struct VkApiContext vkapi_context_t;
 typedef struct Shader shader_t;
+typedef struct glslang_resource_s glslang_resource_t;
 
 typedef struct Attribute
 {
@@ -102,6 +108,34 @@ typedef struct Shader
     VkPipelineShaderStageCreateInfo create_info;
 } shader_t;
 
+/**
+ The state required to compile a shader, owned by a single thread so shaders can be compiled in
+ parallel without locking.
+ */
+typedef struct ShaderCompiler
+{
+    glslang_resource_t* resource;
+    /// Scratch space for compiling - reset after each batch.
+    arena_t arena;
+} shader_compiler_t;
+
+typedef struct ShaderCompilerPool
+{
+    /// Compilers are created on first use by the thread which owns them. Indexed by the job queue
+    /// thread index, with the last used when there is no job queue.
+    shader_compiler_t compilers[VKAPI_SHADER_MAX_COMPILER_COUNT];
+} shader_compiler_pool_t;
+
+/**
+ Initialise glslang for this process. Must be called before any shaders are compiled, and is
+ balanced by a call to @sa shader_compiler_process_shutdown.
+ */
+void shader_compiler_process_init();
+
+void shader_compiler_process_shutdown();
+
+void shader_compiler_pool_destroy(shader_compiler_pool_t* pool);
+
 /**
  Initialise a shader for a given stage.
  @param stage The stage the shader will represent.
@@ -123,6 +157,30 @@ spirv_binary_t shader_load_spirv(const char* filename, arena_t* arena);
 spirv_binary_t
 shader_compile(shader_t* shader, const char* shader_code, const char* filename, arena_t* arena);
 
+/**
+ Compile and reflect a batch of shaders, with each shader compiled as a job on the queue. The
+ results are written to the slot of each shader, so are independent of the order in which the jobs
+ complete.
+ @param pool The compilers used by each thread.
+ @param jq The job queue. If NULL, the shaders are compiled serially on the calling thread. The
+ calling thread must be adopted by the queue.
+ @param shaders An array of shaders, initialised with their stage. Reflection results are written
+ to these.
+ @param shader_codes The source code for each shader. A NULL source marks a pre-compiled shader,
+ whose SPIR-V must already be set in @sa out_bins - these are only reflected.
+ @param count The number of shaders to compile.
+ @param [in,out] out_bins The SPIR-V of each shader. The words are NULL if compilation failed.
+ @param arena An arena allocator - reflection names are allocated from this.
+ */
+void shader_compile_batch(
+    shader_compiler_pool_t* pool,
+    job_queue_t* jq,
+    shader_t** shaders,
+    const char** shader_codes,
+    uint32_t count,
+    spirv_binary_t* out_bins,
+    arena_t* arena);
+
 void shader_create_vk_module(shader_t* shader, vkapi_context_t* context, spirv_binary_t bin);
 
 string_t shader_stage_to_string(enum ShaderStage stage, arena_t* arena);
@@ -143,5 +201,25 @@ VkShaderStageFlagBits shader_vk_stage_flag(enum ShaderStage stage);
  */
 void shader_reflect_spirv(shader_t* shader, uint32_t* spirv, uint32_t word_count, arena_t* arena);
 
+/**
+ Serialise the reflected bindings of a shader into a flat, pointer-free format so they can be
+ stored on disk. The output is deterministic - identical bindings give identical bytes.
+ @param binding The bindings to serialise.
+ @param out The buffer to write to. If NULL, only the required size is returned.
+ @return The size of the serialised bindings in bytes.
+ */
+size_t shader_binding_serialise(const shader_binding_t* binding, uint8_t* out);
+
+/**
+ Restore bindings serialised by @sa shader_binding_serialise.
+ @param [out] binding The restored bindings.
+ @param data The serialised bindings.
+ @param size The size of the serialised data in bytes.
+ @param arena An arena allocator used for the descriptor names.
+ @return false if the data is truncated or the counts are out of range.
+ */
+bool shader_binding_deserialise(
+    shader_binding_t* binding, const uint8_t* data, size_t size, arena_t* arena);
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,332 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "shader_cache.h"
+
+#include <glslang/build_info.h>
+#include <log.h>
+#include <spirv_cross_c.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utility/hash.h>
+
+uint64_t _shader_cache_seed(enum ShaderStage stage, bool is_spirv)
+{
+    const uint32_t versions[] = {
+        VKAPI_SHADER_CACHE_VERSION,
+        GLSLANG_VERSION_MAJOR,
+        GLSLANG_VERSION_MINOR,
+        GLSLANG_VERSION_PATCH,
+        SPVC_C_API_VERSION_MAJOR,
+        SPVC_C_API_VERSION_MINOR,
+        SPVC_C_API_VERSION_PATCH,
+        (uint32_t)stage,
+        (uint32_t)is_spirv};
+    return murmur2_hash64(versions, sizeof(versions), 0);
+}
+
+uint64_t vkapi_shader_cache_glsl_key(const char* source, enum ShaderStage stage)
+{
+    assert(source);
+    // Include the terminator so an empty source still has a valid length to hash.
+    return murmur2_hash64(source, strlen(source) + 1, _shader_cache_seed(stage, false));
+}
+
+uint64_t vkapi_shader_cache_spirv_key(const spirv_binary_t* bin, enum ShaderStage stage)
+{
+    assert(bin && bin->words);
+    return murmur2_hash64(
+        bin->words, bin->size * sizeof(uint32_t), _shader_cache_seed(stage, true));
+}
+
+size_t _shader_cache_payload_size(const vkapi_shader_cache_entry_t* e)
+{
+    return e->spirv_word_count * sizeof(uint32_t) + e->reflection_size;
+}
+
+bool _shader_cache_load(vkapi_shader_cache_t* c)
+{
+    const uint8_t* data = c->file.data;
+    size_t size = c->file.size;
+
+    if (size < sizeof(vkapi_shader_cache_header_t))
+    {
+        return false;
+    }
+    vkapi_shader_cache_header_t header;
+    memcpy(&header, data, sizeof(vkapi_shader_cache_header_t));
+    if (header.magic != VKAPI_SHADER_CACHE_MAGIC || header.version != VKAPI_SHADER_CACHE_VERSION)
+    {
+        return false;
+    }
+    size_t table_end = sizeof(vkapi_shader_cache_header_t) +
+        (size_t)header.entry_count * sizeof(vkapi_shader_cache_entry_t);
+    if (table_end > size)
+    {
+        return false;
+    }
+
+    const vkapi_shader_cache_entry_t* entries =
+        (const vkapi_shader_cache_entry_t*)(data + sizeof(vkapi_shader_cache_header_t));
+    for (uint32_t i = 0; i < header.entry_count; ++i)
+    {
+        const vkapi_shader_cache_entry_t* e = &entries[i];
+        size_t payload_size = _shader_cache_payload_size(e);
+        // The payload hash is only checked when the entry is used - this just guarantees the
+        // entry can't point outside of the file.
+        if (e->offset < table_end || e->offset % sizeof(uint64_t) != 0 || e->offset > size ||
+            payload_size > size - e->offset || !payload_size)
+        {
+            return false;
+        }
+        vkapi_shader_cache_item_t item = {.entry = *e, .payload = data + e->offset};
+        uint32_t idx = c->items.size;
+        DYN_ARRAY_APPEND(&c->items, &item);
+        HASH_MAP_SET(&c->key_map, &item.entry.key, &idx);
+    }
+    c->generation = header.generation + 1;
+    return true;
+}
+
+void vkapi_shader_cache_init(
+    vkapi_shader_cache_t* c, const char* path, size_t max_size, arena_t* arena)
+{
+    assert(c);
+    assert(path);
+
+    memset(c, 0, sizeof(vkapi_shader_cache_t));
+    c->arena = arena;
+    c->max_size = max_size;
+    c->generation = 1;
+    MAKE_DYN_ARRAY(vkapi_shader_cache_item_t, arena, 100, &c->items);
+    c->key_map = HASH_MAP_CREATE(uint64_t, uint32_t, arena);
+
+    if (!fs_map_file(path, &c->file))
+    {
+        log_info("Shader cache: no cache found at %s.", path);
+        return;
+    }
+    if (!_shader_cache_load(c))
+    {
+        log_warn("Shader cache: %s is invalid and will be replaced.", path);
+        fs_unmap_file(&c->file);
+        dyn_array_clear(&c->items);
+        hash_map_clear(&c->key_map);
+        c->generation = 1;
+        return;
+    }
+    log_info("Shader cache: mapped %u entries from %s.", c->items.size, path);
+}
+
+void _shader_cache_remove(vkapi_shader_cache_t* c, uint64_t key)
+{
+    log_warn("Shader cache: entry %llx is corrupt - discarding.", (unsigned long long)key);
+    HASH_MAP_ERASE(&c->key_map, &key);
+    ++c->misses;
+}
+
+bool vkapi_shader_cache_get(
+    vkapi_shader_cache_t* c,
+    uint64_t key,
+    spirv_binary_t* bin,
+    shader_binding_t* binding,
+    arena_t* arena)
+{
+    assert(c);
+    assert(binding);
+
+    uint32_t* idx = HASH_MAP_GET(&c->key_map, &key);
+    if (!idx)
+    {
+        ++c->misses;
+        return false;
+    }
+    vkapi_shader_cache_item_t* item = DYN_ARRAY_GET_PTR(vkapi_shader_cache_item_t, &c->items, *idx);
+    const vkapi_shader_cache_entry_t* e = &item->entry;
+    size_t spirv_size = e->spirv_word_count * sizeof(uint32_t);
+
+    if (!item->verified)
+    {
+        if (murmur2_hash64(item->payload, _shader_cache_payload_size(e), 0) != e->payload_hash)
+        {
+            _shader_cache_remove(c, key);
+            return false;
+        }
+        item->verified = true;
+    }
+    if ((bin && !e->spirv_word_count) ||
+        !shader_binding_deserialise(binding, item->payload + spirv_size, e->reflection_size, arena))
+    {
+        _shader_cache_remove(c, key);
+        return false;
+    }
+    if (bin)
+    {
+        // Payloads are 8-byte aligned so the words can be used in place.
+        bin->words = (uint32_t*)item->payload;
+        bin->size = e->spirv_word_count;
+    }
+    item->entry.last_used = c->generation;
+    ++c->hits;
+    return true;
+}
+
+void vkapi_shader_cache_insert(
+    vkapi_shader_cache_t* c,
+    uint64_t key,
+    const spirv_binary_t* bin,
+    const shader_binding_t* binding)
+{
+    assert(c);
+    assert(binding);
+
+    vkapi_shader_cache_item_t item = {0};
+    item.entry.key = key;
+    item.entry.spirv_word_count = bin ? bin->size : 0;
+    item.entry.reflection_size = shader_binding_serialise(binding, NULL);
+    item.entry.last_used = c->generation;
+    item.verified = true;
+
+    size_t spirv_size = item.entry.spirv_word_count * sizeof(uint32_t);
+    size_t payload_size = _shader_cache_payload_size(&item.entry);
+    uint8_t* payload = (uint8_t*)ARENA_MAKE_ARRAY(
+        c->arena, uint64_t, (payload_size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    if (spirv_size)
+    {
+        memcpy(payload, bin->words, spirv_size);
+    }
+    shader_binding_serialise(binding, payload + spirv_size);
+    item.entry.payload_hash = murmur2_hash64(payload, payload_size, 0);
+    item.payload = payload;
+
+    uint32_t* idx = HASH_MAP_GET(&c->key_map, &key);
+    if (idx)
+    {
+        DYN_ARRAY_SET(&c->items, *idx, &item);
+        return;
+    }
+    uint32_t new_idx = c->items.size;
+    DYN_ARRAY_APPEND(&c->items, &item);
+    HASH_MAP_INSERT(&c->key_map, &key, &new_idx);
+}
+
+int _shader_cache_compare_lru(const void* a, const void* b)
+{
+    const vkapi_shader_cache_item_t* item_a = *(const vkapi_shader_cache_item_t**)a;
+    const vkapi_shader_cache_item_t* item_b = *(const vkapi_shader_cache_item_t**)b;
+    // Most recently used first.
+    if (item_a->entry.last_used > item_b->entry.last_used)
+    {
+        return -1;
+    }
+    if (item_a->entry.last_used < item_b->entry.last_used)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+size_t _shader_cache_align(size_t size)
+{
+    return (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+bool vkapi_shader_cache_save(vkapi_shader_cache_t* c, const char* path, arena_t* arena)
+{
+    assert(c);
+    assert(path);
+
+    // Gather the live entries - discarded entries are no longer referenced by the key map.
+    vkapi_shader_cache_item_t** items =
+        ARENA_MAKE_ARRAY(arena, vkapi_shader_cache_item_t*, c->items.size + 1, 0);
+    uint32_t item_count = 0;
+    for (uint32_t i = 0; i < c->items.size; ++i)
+    {
+        vkapi_shader_cache_item_t* item =
+            DYN_ARRAY_GET_PTR(vkapi_shader_cache_item_t, &c->items, i);
+        uint32_t* idx = HASH_MAP_GET(&c->key_map, &item->entry.key);
+        if (idx && *idx == i)
+        {
+            items[item_count++] = item;
+        }
+    }
+    qsort(items, item_count, sizeof(vkapi_shader_cache_item_t*), _shader_cache_compare_lru);
+
+    // Keep the most recently used entries which fit within the size limit.
+    size_t total_size = sizeof(vkapi_shader_cache_header_t);
+    uint32_t keep_count = 0;
+    for (; keep_count < item_count; ++keep_count)
+    {
+        size_t item_size = sizeof(vkapi_shader_cache_entry_t) +
+            _shader_cache_align(_shader_cache_payload_size(&items[keep_count]->entry));
+        if (total_size + item_size > c->max_size)
+        {
+            break;
+        }
+        total_size += item_size;
+    }
+
+    uint8_t* blob = (uint8_t*)ARENA_MAKE_ZERO_ARRAY(
+        arena, uint64_t, _shader_cache_align(total_size) / sizeof(uint64_t));
+    vkapi_shader_cache_header_t header = {
+        .magic = VKAPI_SHADER_CACHE_MAGIC,
+        .version = VKAPI_SHADER_CACHE_VERSION,
+        .generation = c->generation,
+        .entry_count = keep_count};
+    memcpy(blob, &header, sizeof(vkapi_shader_cache_header_t));
+
+    vkapi_shader_cache_entry_t* entries =
+        (vkapi_shader_cache_entry_t*)(blob + sizeof(vkapi_shader_cache_header_t));
+    size_t offset = sizeof(vkapi_shader_cache_header_t) +
+        keep_count * sizeof(vkapi_shader_cache_entry_t);
+    for (uint32_t i = 0; i < keep_count; ++i)
+    {
+        vkapi_shader_cache_entry_t* e = &entries[i];
+        *e = items[i]->entry;
+        e->offset = offset;
+        memcpy(blob + offset, items[i]->payload, _shader_cache_payload_size(e));
+        offset += _shader_cache_align(_shader_cache_payload_size(e));
+    }
+    assert(offset == total_size);
+
+    log_info(
+        "Shader cache: %u hits, %u misses. Writing %u entries (%zu bytes), %u evicted.",
+        c->hits,
+        c->misses,
+        keep_count,
+        total_size,
+        item_count - keep_count);
+
+    // The mapped payloads have been copied, and the mapping must be released before the file can
+    // be replaced on some platforms - the cache is empty from this point.
+    fs_unmap_file(&c->file);
+    dyn_array_clear(&c->items);
+    hash_map_clear(&c->key_map);
+
+    return fs_write_file_atomic(path, blob, total_size);
+}
+
+void vkapi_shader_cache_destroy(vkapi_shader_cache_t* c)
+{
+    assert(c);
+    fs_unmap_file(&c->file);
+}
@@ -0,0 +1,160 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_SHADER_CACHE_H__
+#define __VKAPI_SHADER_CACHE_H__
+
+#include "backend/enums.h"
+#include "shader.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utility/arena.h>
+#include <utility/filesystem.h>
+#include <utility/hash_map.h>
+
+#define VKAPI_SHADER_CACHE_MAGIC 0x43535052 // "RPSC"
+#define VKAPI_SHADER_CACHE_VERSION 1
+#define VKAPI_SHADER_CACHE_DEFAULT_PATH "shader_cache.bin"
+/// The maximum size of the cache file - the least recently used entries are evicted when saving.
+#define VKAPI_SHADER_CACHE_DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct ShaderCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    /// Incremented on each run which saves the cache - used to age entries.
+    uint32_t generation;
+    uint32_t entry_count;
+} vkapi_shader_cache_header_t;
+
+/**
+ An entry in the cache file. The entries directly follow the header, and each points to its
+ payload - the SPIR-V words followed by the serialised reflection data.
+ */
+typedef struct ShaderCacheEntry
+{
+    uint64_t key;
+    /// Offset of the payload from the start of the file.
+    uint64_t offset;
+    uint64_t payload_hash;
+    /// Zero if the SPIR-V isn't stored (i.e. it was loaded from a file).
+    uint32_t spirv_word_count;
+    uint32_t reflection_size;
+    /// The generation in which this entry was last used.
+    uint32_t last_used;
+    uint32_t padding;
+} vkapi_shader_cache_entry_t;
+
+typedef struct ShaderCacheItem
+{
+    vkapi_shader_cache_entry_t entry;
+    /// Either points into the mapped file or to an entry added during this run.
+    const uint8_t* payload;
+    bool verified;
+} vkapi_shader_cache_item_t;
+
+/**
+ A content-addressed cache of compiled SPIR-V and the result of its reflection, persisted between
+ runs so neither the GLSL compiler nor SPIR-V reflection is required when a shader is unchanged.
+ The cache file is memory mapped on init so only the entries used are read from disk.
+ */
+typedef struct ShaderCache
+{
+    fs_mapped_file_t file;
+    /// vkapi_shader_cache_item_t
+    arena_dyn_array_t items;
+    /// Key: uint64_t key, value: uint32_t index into @sa items.
+    hash_map_t key_map;
+    uint32_t generation;
+    size_t max_size;
+    uint32_t hits;
+    uint32_t misses;
+    arena_t* arena;
+} vkapi_shader_cache_t;
+
+/**
+ Generate the key for GLSL source code. Besides the source, which includes any defines, the key
+ includes the shader stage and the compiler/reflection versions so any update invalidates the
+ entries created by an older version.
+ */
+uint64_t vkapi_shader_cache_glsl_key(const char* source, enum ShaderStage stage);
+
+/**
+ Generate the key for a pre-compiled SPIR-V binary - only the reflection result is cached.
+ */
+uint64_t vkapi_shader_cache_spirv_key(const spirv_binary_t* bin, enum ShaderStage stage);
+
+/**
+ Initialise the cache, mapping the cache file if present. A file which doesn't match the expected
+ format is ignored and will be overwritten on saving.
+ @param c The cache to initialise.
+ @param path The path of the cache file.
+ @param max_size The maximum size of the cache file in bytes.
+ @param arena An arena used for the lifetime of the cache.
+ */
+void vkapi_shader_cache_init(
+    vkapi_shader_cache_t* c, const char* path, size_t max_size, arena_t* arena);
+
+/**
+ Look up a cache entry.
+ @param c The shader cache.
+ @param key The key generated by one of the key functions.
+ @param [out] bin The cached SPIR-V. Points into the cache, so is only valid until the cache is
+ saved or destroyed. Can be NULL if only the reflection is required.
+ @param [out] binding The cached reflection result.
+ @param arena An arena allocator used for the reflection names.
+ @return true if the entry exists and is valid.
+ */
+bool vkapi_shader_cache_get(
+    vkapi_shader_cache_t* c,
+    uint64_t key,
+    spirv_binary_t* bin,
+    shader_binding_t* binding,
+    arena_t* arena);
+
+/**
+ Add an entry to the cache, replacing any existing entry with the same key.
+ @param c The shader cache.
+ @param key The key generated by one of the key functions.
+ @param bin The SPIR-V to cache. Can be NULL if only the reflection should be cached.
+ @param binding The reflection result to cache.
+ */
+void vkapi_shader_cache_insert(
+    vkapi_shader_cache_t* c,
+    uint64_t key,
+    const spirv_binary_t* bin,
+    const shader_binding_t* binding);
+
+/**
+ Write the cache to disk, evicting the least recently used entries which don't fit into the size
+ limit. The file is replaced atomically.
+ @param c The shader cache.
+ @param path The path of the cache file.
+ @param arena An arena used to assemble the file.
+ @return true if the file was written successfully.
+ */
+bool vkapi_shader_cache_save(vkapi_shader_cache_t* c, const char* path, arena_t* arena);
+
+void vkapi_shader_cache_destroy(vkapi_shader_cache_t* c);
+
+#endif
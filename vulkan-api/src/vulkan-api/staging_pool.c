@@ -3,9 +3,11 @@
 #include "driver.h"
 
 #include <assert.h>
+#include <string.h>
 #include <utility/array_utility.h>
 
-vkapi_staging_instance_t _vkapi_staging_create(VmaAllocator vma_alloc, VkDeviceSize size)
+vkapi_staging_instance_t
+_vkapi_staging_create(VmaAllocator vma_alloc, VkDeviceSize size, VmaAllocationCreateFlags flags)
 {
     assert(size > 0);
 
@@ -21,103 +23,119 @@ vkapi_staging_instance_t _vkapi_staging_create(VmaAllocator vma_alloc, VkDeviceS
     // cpu staging pool
     VmaAllocationCreateInfo create_info = {0};
     create_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    create_info.flags = flags;
+    VmaAllocationInfo alloc_info;
     VMA_CHECK_RESULT(vmaCreateBuffer(
-        vma_alloc,
-        &bufferInfo,
-        &create_info,
-        &instance.buffer,
-        &instance.mem,
-        &instance.alloc_info));
+        vma_alloc, &bufferInfo, &create_info, &instance.buffer, &instance.mem, &alloc_info));
+    instance.mapped = alloc_info.pMappedData;
 
     return instance;
 }
 
-vkapi_staging_pool_t* vkapi_staging_init(arena_t* perm_arena)
+vkapi_staging_pool_t*
+vkapi_staging_init(vkapi_context_t* context, VmaAllocator vma_alloc, arena_t* perm_arena)
 {
     vkapi_staging_pool_t* instance = ARENA_MAKE_ZERO_STRUCT(perm_arena, vkapi_staging_pool_t);
-    MAKE_DYN_ARRAY(vkapi_staging_instance_t, perm_arena, 50, &instance->free_stages);
+    instance->context = context;
     MAKE_DYN_ARRAY(vkapi_staging_instance_t, perm_arena, 50, &instance->in_use_stages);
+
+    // The ring is mapped for its lifetime rather than mapping for each upload.
+    vkapi_staging_instance_t ring =
+        _vkapi_staging_create(vma_alloc, VKAPI_STAGING_RING_SIZE, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    assert(ring.mapped);
+    instance->ring_buffer = ring.buffer;
+    instance->ring_mem = ring.mem;
+    instance->ring_mapped = ring.mapped;
+    vkapi_staging_ring_init(&instance->ring, VKAPI_STAGING_RING_SIZE);
     return instance;
 }
 
-vkapi_staging_instance_t*
-vkapi_staging_get(vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc, VkDeviceSize req_size)
+vkapi_staging_instance_t vkapi_staging_get(
+    vkapi_staging_pool_t* staging_pool,
+    VmaAllocator vma_alloc,
+    VkDeviceSize req_size,
+    VkDeviceSize alignment)
 {
     assert(staging_pool);
     assert(req_size > 0);
 
-    // Check for a free staging space that is equal or greater than the required
-    // size.
-    for (uint32_t i = 0; i < staging_pool->free_stages.size; ++i)
+    vkapi_staging_ring_t* ring = &staging_pool->ring;
+    uint64_t offset = VKAPI_STAGING_RING_INVALID_OFFSET;
+    if (req_size <= VKAPI_STAGING_MAX_RING_ALLOC_SIZE)
     {
-        vkapi_staging_instance_t instance =
-            DYN_ARRAY_GET(vkapi_staging_instance_t, &staging_pool->free_stages, i);
-        if (instance.size >= req_size)
+        offset = vkapi_staging_ring_alloc(ring, req_size, alignment, staging_pool->current_frame);
+        if (offset == VKAPI_STAGING_RING_INVALID_OFFSET && staging_pool->current_frame > 0)
         {
-            DYN_ARRAY_REMOVE(&staging_pool->free_stages, i);
-            instance.frame_last_used = staging_pool->current_frame;
-            return DYN_ARRAY_APPEND(&staging_pool->in_use_stages, &instance);
+            // The ring is full of uploads from frames which may still be in flight. All previous
+            // frames have been submitted, so wait for them to complete and reclaim their space.
+            VK_CHECK_RESULT(vkDeviceWaitIdle(staging_pool->context->device))
+            vkapi_staging_ring_retire(ring, staging_pool->current_frame - 1);
+            offset =
+                vkapi_staging_ring_alloc(ring, req_size, alignment, staging_pool->current_frame);
+            staging_pool->stats.stall_count++;
         }
     }
 
-    vkapi_staging_instance_t new_instance = _vkapi_staging_create(vma_alloc, req_size);
+    if (offset != VKAPI_STAGING_RING_INVALID_OFFSET)
+    {
+        vkapi_staging_instance_t instance = {
+            .buffer = staging_pool->ring_buffer,
+            .offset = offset,
+            .size = req_size,
+            .mem = staging_pool->ring_mem,
+            .mapped = staging_pool->ring_mapped + offset,
+            .frame_last_used = staging_pool->current_frame};
+        return instance;
+    }
+
+    // Either too large for the ring or the current frame has filled it.
+    vkapi_staging_instance_t new_instance =
+        _vkapi_staging_create(vma_alloc, req_size, VMA_ALLOCATION_CREATE_MAPPED_BIT);
     new_instance.frame_last_used = staging_pool->current_frame;
-    return DYN_ARRAY_APPEND(&staging_pool->in_use_stages, &new_instance);
+    DYN_ARRAY_APPEND(&staging_pool->in_use_stages, &new_instance);
+    staging_pool->stats.dedicated_count++;
+    return new_instance;
 }
 
 void vkapi_staging_gc(
     vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc, uint64_t current_frame)
 {
-    if (staging_pool->current_frame < VKAPI_MAX_COMMAND_BUFFER_SIZE)
-    {
-        ++current_frame;
-        return;
-    }
+    assert(staging_pool);
 
-    for (uint32_t i = 0; i < staging_pool->free_stages.size; ++i)
+    // Reclaim the space used by frames which have definitely been executed.
+    if (current_frame > VKAPI_MAX_COMMAND_BUFFER_SIZE)
     {
-        vkapi_staging_instance_t* stage =
-            DYN_ARRAY_GET_PTR(vkapi_staging_instance_t, &staging_pool->free_stages, i);
-        uint64_t collect_frame = stage->frame_last_used + VKAPI_MAX_COMMAND_BUFFER_SIZE;
-        if (collect_frame < current_frame)
-        {
-            vmaDestroyBuffer(vma_alloc, stage->buffer, stage->mem);
-            DYN_ARRAY_REMOVE(&staging_pool->free_stages, i);
-        }
-    }
+        uint64_t completed_frame = current_frame - VKAPI_MAX_COMMAND_BUFFER_SIZE - 1;
+        vkapi_staging_ring_retire(&staging_pool->ring, completed_frame);
 
-    // In use buffers that have definitely been executed on cmd bufefrs are moved to the free stage
-    // container for re-use.
-    for (uint32_t i = 0; i < staging_pool->in_use_stages.size; ++i)
-    {
-        vkapi_staging_instance_t* stage =
-            DYN_ARRAY_GET_PTR(vkapi_staging_instance_t, &staging_pool->in_use_stages, i);
-        uint64_t collect_frame = stage->frame_last_used + VKAPI_MAX_COMMAND_BUFFER_SIZE;
-        if (collect_frame < current_frame)
+        // Iterate in reverse so removing an entry doesn't skip the next.
+        for (int64_t i = (int64_t)staging_pool->in_use_stages.size - 1; i >= 0; --i)
         {
-            DYN_ARRAY_APPEND(&staging_pool->free_stages, stage);
-            DYN_ARRAY_REMOVE(&staging_pool->in_use_stages, i);
+            vkapi_staging_instance_t* stage =
+                DYN_ARRAY_GET_PTR(vkapi_staging_instance_t, &staging_pool->in_use_stages, i);
+            if (stage->frame_last_used <= completed_frame)
+            {
+                vmaDestroyBuffer(vma_alloc, stage->buffer, stage->mem);
+                DYN_ARRAY_REMOVE(&staging_pool->in_use_stages, i);
+            }
         }
     }
-    ++current_frame;
+
+    // Called at the end of the frame, so following uploads belong to the next frame.
+    staging_pool->current_frame = current_frame + 1;
+    staging_pool->last_frame_stats = staging_pool->stats;
+    memset(&staging_pool->stats, 0, sizeof(vkapi_staging_stats_t));
 }
 
 void vkapi_staging_destroy(vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc)
 {
-    for (uint32_t i = 0; i < staging_pool->free_stages.size; ++i)
-    {
-        vkapi_staging_instance_t instance =
-            DYN_ARRAY_GET(vkapi_staging_instance_t, &staging_pool->free_stages, i);
-        vmaDestroyBuffer(vma_alloc, instance.buffer, instance.mem);
-    }
-
     for (uint32_t i = 0; i < staging_pool->in_use_stages.size; ++i)
     {
         vkapi_staging_instance_t instance =
             DYN_ARRAY_GET(vkapi_staging_instance_t, &staging_pool->in_use_stages, i);
         vmaDestroyBuffer(vma_alloc, instance.buffer, instance.mem);
     }
-
-    dyn_array_clear(&staging_pool->free_stages);
     dyn_array_clear(&staging_pool->in_use_stages);
+
+    vmaDestroyBuffer(vma_alloc, staging_pool->ring_buffer, staging_pool->ring_mem);
 }
@@ -24,42 +24,83 @@
 #define __VKAPI_STAGING_POOL_H__
 
 #include "common.h"
+#include "staging_ring.h"
 
 #include <utility/arena.h>
 
+/// The size of the persistently mapped staging ring.
+#define VKAPI_STAGING_RING_SIZE (64 * 1024 * 1024)
+/// Uploads larger than this are given a dedicated buffer so they don't monopolise the ring.
+#define VKAPI_STAGING_MAX_RING_ALLOC_SIZE (VKAPI_STAGING_RING_SIZE / 4)
+/// The default alignment of ring allocations - suitable for buffer copies and most image formats.
+#define VKAPI_STAGING_DEFAULT_ALIGNMENT 16
+
 // Forward declarations.
 typedef struct VkApiContext vkapi_context_t;
 
 typedef struct VkApiStageInstance
 {
     VkBuffer buffer;
+    /// The offset into the buffer of the staging space.
+    VkDeviceSize offset;
     VkDeviceSize size;
     VmaAllocation mem;
-    VmaAllocationInfo alloc_info;
+    /// Host pointer to the staging space - already offset.
+    void* mapped;
     uint64_t frame_last_used;
 } vkapi_staging_instance_t;
 
+typedef struct VkApiStagingStats
+{
+    /// Uploads which were too large for the ring.
+    uint32_t dedicated_count;
+    /// The number of times the ring was full and the CPU waited for the GPU to catch up.
+    uint32_t stall_count;
+} vkapi_staging_stats_t;
+
 /**
- A simplistic staging pool for CPU-only stages. Used when copying to and from
- GPU only memory.
+ Staging memory for CPU to GPU uploads. Uploads are sub-allocated from a single persistently
+ mapped ring buffer and the space is reclaimed once the frame using it has completed. Uploads which
+ are too large for the ring are given their own buffer, which is destroyed after use.
  */
 typedef struct VkApiStagingPool
 {
-    // a list of free stages and their size
-    arena_dyn_array_t free_stages;
+    vkapi_context_t* context;
+    vkapi_staging_ring_t ring;
+    VkBuffer ring_buffer;
+    VmaAllocation ring_mem;
+    uint8_t* ring_mapped;
+
+    /// Dedicated buffers for oversized uploads waiting to be destroyed.
     arena_dyn_array_t in_use_stages;
     uint64_t current_frame;
+    /// Counts for the current frame.
+    vkapi_staging_stats_t stats;
+    /// Counts for the last completed frame.
+    vkapi_staging_stats_t last_frame_stats;
 
 } vkapi_staging_pool_t;
 
-vkapi_staging_pool_t* vkapi_staging_init(arena_t* perm_arena);
+vkapi_staging_pool_t*
+vkapi_staging_init(vkapi_context_t* context, VmaAllocator vma_alloc, arena_t* perm_arena);
 
-vkapi_staging_instance_t* vkapi_staging_get(
-    vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc, VkDeviceSize req_size);
+/**
+ Get staging space for an upload. The space is valid for the current frame only.
+ @param alignment The required alignment of the offset into the staging buffer.
+ */
+vkapi_staging_instance_t vkapi_staging_get(
+    vkapi_staging_pool_t* staging_pool,
+    VmaAllocator vma_alloc,
+    VkDeviceSize req_size,
+    VkDeviceSize alignment);
 
+/**
+ Release the staging space of completed frames and advance to the next frame. The current counts
+ are moved to @sa last_frame_stats and reset.
+ */
 void vkapi_staging_gc(
     vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc, uint64_t current_frame);
 
 void vkapi_staging_destroy(vkapi_staging_pool_t* staging_pool, VmaAllocator vma_alloc);
 
-#endif
\ No newline at end of file
+#endif
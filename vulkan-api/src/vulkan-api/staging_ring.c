@@ -0,0 +1,123 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "staging_ring.h"
+
+#include <assert.h>
+#include <string.h>
+
+void vkapi_staging_ring_init(vkapi_staging_ring_t* r, uint64_t capacity)
+{
+    assert(r);
+    assert(capacity > 0);
+    memset(r, 0, sizeof(vkapi_staging_ring_t));
+    r->capacity = capacity;
+}
+
+vkapi_staging_ring_region_t* _staging_ring_frame_region(vkapi_staging_ring_t* r, uint64_t frame)
+{
+    if (r->region_count)
+    {
+        uint32_t last = (r->region_start + r->region_count - 1) % VKAPI_STAGING_RING_MAX_REGIONS;
+        vkapi_staging_ring_region_t* region = &r->regions[last];
+        assert(region->frame <= frame);
+        if (region->frame == frame)
+        {
+            return region;
+        }
+    }
+    if (r->region_count == VKAPI_STAGING_RING_MAX_REGIONS)
+    {
+        return NULL;
+    }
+    uint32_t idx = (r->region_start + r->region_count++) % VKAPI_STAGING_RING_MAX_REGIONS;
+    vkapi_staging_ring_region_t* region = &r->regions[idx];
+    region->size = 0;
+    region->end = r->head;
+    region->frame = frame;
+    return region;
+}
+
+uint64_t vkapi_staging_ring_alloc(
+    vkapi_staging_ring_t* r, uint64_t size, uint64_t alignment, uint64_t frame)
+{
+    assert(r);
+    assert(size > 0);
+    assert(alignment > 0);
+
+    if (!r->used)
+    {
+        // Nothing in flight, so start from the beginning to reduce wrapping.
+        r->head = 0;
+        r->tail = 0;
+    }
+
+    uint64_t offset = (r->head + alignment - 1) / alignment * alignment;
+    if (r->head >= r->tail && r->used < r->capacity)
+    {
+        // The free space is from the head to the end of the ring, and from the start to the tail.
+        if (offset + size > r->capacity)
+        {
+            offset = 0;
+            if (size > r->tail)
+            {
+                return VKAPI_STAGING_RING_INVALID_OFFSET;
+            }
+        }
+    }
+    else if (offset + size > r->tail || r->used == r->capacity)
+    {
+        return VKAPI_STAGING_RING_INVALID_OFFSET;
+    }
+
+    vkapi_staging_ring_region_t* region = _staging_ring_frame_region(r, frame);
+    if (!region)
+    {
+        return VKAPI_STAGING_RING_INVALID_OFFSET;
+    }
+
+    // Any space skipped over when wrapping is owned by the region until it is retired.
+    uint64_t consumed = offset >= r->head ? offset + size - r->head : r->capacity - r->head + size;
+    r->head = offset + size;
+    r->used += consumed;
+    region->size += consumed;
+    region->end = r->head;
+    return offset;
+}
+
+void vkapi_staging_ring_retire(vkapi_staging_ring_t* r, uint64_t completed_frame)
+{
+    assert(r);
+    while (r->region_count)
+    {
+        vkapi_staging_ring_region_t* region = &r->regions[r->region_start];
+        if (region->frame > completed_frame)
+        {
+            break;
+        }
+        assert(r->used >= region->size);
+        r->used -= region->size;
+        r->tail = region->end;
+        r->region_start = (r->region_start + 1) % VKAPI_STAGING_RING_MAX_REGIONS;
+        --r->region_count;
+    }
+}
@@ -0,0 +1,83 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_STAGING_RING_H__
+#define __VKAPI_STAGING_RING_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// The maximum number of frames which can have allocations waiting to be retired. Allocations
+/// within a frame are merged into one region, so this only needs to exceed the frames in flight.
+#define VKAPI_STAGING_RING_MAX_REGIONS 16
+/// Returned by @sa vkapi_staging_ring_alloc when the ring has no space.
+#define VKAPI_STAGING_RING_INVALID_OFFSET UINT64_MAX
+
+typedef struct StagingRingRegion
+{
+    /// The number of bytes consumed by the frame, including alignment padding and any space
+    /// skipped when wrapping.
+    uint64_t size;
+    /// The offset one past the last byte of the region.
+    uint64_t end;
+    uint64_t frame;
+} vkapi_staging_ring_region_t;
+
+/**
+ Linear sub-allocation from a fixed size ring. Allocations are tagged with the frame they were
+ made in and the space is only reclaimed, in order, once that frame has been retired. This module
+ only tracks offsets - it owns no memory so can be used with any buffer.
+ */
+typedef struct StagingRing
+{
+    uint64_t capacity;
+    /// Offset of the next allocation.
+    uint64_t head;
+    /// Offset of the oldest allocation still in use.
+    uint64_t tail;
+    /// Bytes in use between the tail and head.
+    uint64_t used;
+    vkapi_staging_ring_region_t regions[VKAPI_STAGING_RING_MAX_REGIONS];
+    uint32_t region_start;
+    uint32_t region_count;
+} vkapi_staging_ring_t;
+
+void vkapi_staging_ring_init(vkapi_staging_ring_t* r, uint64_t capacity);
+
+/**
+ Allocate space from the ring.
+ @param alignment Doesn't need to be a power of two, as image copies require the offset to be a
+ multiple of the texel size.
+ @param frame The frame the space will be used in - this must not be less than previous
+ allocations.
+ @return The offset of the allocation, or VKAPI_STAGING_RING_INVALID_OFFSET if there isn't a
+ contiguous range of the required size available.
+ */
+uint64_t vkapi_staging_ring_alloc(
+    vkapi_staging_ring_t* r, uint64_t size, uint64_t alignment, uint64_t frame);
+
+/**
+ Reclaim the space used by all frames up to and including the specified frame.
+ */
+void vkapi_staging_ring_retire(vkapi_staging_ring_t* r, uint64_t completed_frame);
+
+#endif
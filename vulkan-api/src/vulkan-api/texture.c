@@ -229,31 +229,38 @@ void vkapi_texture_destroy(vkapi_context_t* context, VmaAllocator vma, vkapi_tex
     vkDestroyImage(context->device, texture->image, VK_NULL_HANDLE);
 }
 
-void vkapi_texture_create_image(
-    VmaAllocator vma, vkapi_texture_t* texture, VkImageUsageFlags usage_flags)
+void vkapi_texture_fill_image_info(
+    vkapi_texture_t* texture, VkImageUsageFlags usage_flags, VkImageCreateInfo* image_info)
 {
     assert(texture->info.format != VK_FORMAT_UNDEFINED);
 
-    VkImageCreateInfo image_info = {0};
-    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    image_info.imageType = VK_IMAGE_TYPE_2D; // TODO: support 3d images
-    image_info.format = texture->info.format;
-    image_info.extent.width = texture->info.width;
-    image_info.extent.height = texture->info.height;
-    image_info.extent.depth = 1;
-    image_info.mipLevels = texture->info.mip_levels;
-    image_info.arrayLayers = compute_array_layers(texture->info.type, texture->info.array_count);
-    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
-    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | usage_flags;
-    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    memset(image_info, 0, sizeof(VkImageCreateInfo));
+    image_info->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info->imageType = VK_IMAGE_TYPE_2D; // TODO: support 3d images
+    image_info->format = texture->info.format;
+    image_info->extent.width = texture->info.width;
+    image_info->extent.height = texture->info.height;
+    image_info->extent.depth = 1;
+    image_info->mipLevels = texture->info.mip_levels;
+    image_info->arrayLayers = compute_array_layers(texture->info.type, texture->info.array_count);
+    image_info->samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info->tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info->usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | usage_flags;
+    image_info->sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
     if (texture->info.type == VKAPI_TEXTURE_2D_CUBE ||
         texture->info.type == VKAPI_TEXTURE_2D_CUBE_ARRAY)
     {
-        image_info.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+        image_info->flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
     }
+}
+
+void vkapi_texture_create_image(
+    VmaAllocator vma, vkapi_texture_t* texture, VkImageUsageFlags usage_flags)
+{
+    VkImageCreateInfo image_info;
+    vkapi_texture_fill_image_info(texture, usage_flags, &image_info);
 
     VmaAllocationCreateInfo alloc_ci = {0};
     alloc_ci.usage = VMA_MEMORY_USAGE_AUTO;
@@ -264,6 +271,18 @@ void vkapi_texture_create_image(
         vmaCreateImage(vma, &image_info, &alloc_ci, &texture->image, &texture->vma_alloc, NULL))
 }
 
+VkMemoryRequirements vkapi_texture_create_unbound_image(
+    vkapi_context_t* context, vkapi_texture_t* texture, VkImageUsageFlags usage_flags)
+{
+    VkImageCreateInfo image_info;
+    vkapi_texture_fill_image_info(texture, usage_flags, &image_info);
+    VK_CHECK_RESULT(vkCreateImage(context->device, &image_info, VK_NULL_HANDLE, &texture->image))
+
+    VkMemoryRequirements reqs;
+    vkGetImageMemoryRequirements(context->device, texture->image, &reqs);
+    return reqs;
+}
+
 VkImageView vkapi_texture_create_image_view(
     vkapi_context_t* context, vkapi_texture_t* texture, uint32_t mip_level, uint32_t mip_count)
 {
@@ -317,19 +336,13 @@ void vkapi_texture_update_sampler(
     tex->sampler = *vkapi_sampler_cache_create(sc, sampler_params, context);
 }
 
-void vkapi_texture_create_2d(
+void vkapi_texture_create_views(
     vkapi_context_t* context,
-    VmaAllocator vma,
     vkapi_sampler_cache_t* sc,
     vkapi_texture_t* texture,
     VkImageUsageFlags usage_flags,
     sampler_params_t* sampler_params)
 {
-    assert(sampler_params);
-
-    // create an empty image
-    vkapi_texture_create_image(vma, texture, usage_flags);
-
     // First image view declares all mip levels for this image.
     texture->image_views[0] =
         vkapi_texture_create_image_view(context, texture, 0, texture->info.mip_levels);
@@ -351,9 +364,44 @@ void vkapi_texture_create_2d(
     vkapi_texture_update_sampler(context, sc, texture, sampler_params);
 }
 
+void vkapi_texture_create_2d(
+    vkapi_context_t* context,
+    VmaAllocator vma,
+    vkapi_sampler_cache_t* sc,
+    vkapi_texture_t* texture,
+    VkImageUsageFlags usage_flags,
+    sampler_params_t* sampler_params)
+{
+    assert(sampler_params);
+
+    // create an empty image
+    vkapi_texture_create_image(vma, texture, usage_flags);
+    vkapi_texture_create_views(context, sc, texture, usage_flags, sampler_params);
+}
+
+void vkapi_texture_create_aliased_2d(
+    vkapi_context_t* context,
+    VmaAllocator vma,
+    vkapi_sampler_cache_t* sc,
+    vkapi_texture_t* texture,
+    VmaAllocation alloc,
+    VkDeviceSize offset,
+    VkImageUsageFlags usage_flags,
+    sampler_params_t* sampler_params)
+{
+    assert(sampler_params);
+    assert(texture->image != VK_NULL_HANDLE);
+
+    // The allocation is owned by the caller, so the texture doesn't hold a reference to it.
+    VMA_CHECK_RESULT(vmaBindImageMemory2(vma, alloc, offset, texture->image, NULL))
+    texture->vma_alloc = VK_NULL_HANDLE;
+    vkapi_texture_create_views(context, sc, texture, usage_flags, sampler_params);
+}
+
 void vkapi_texture_map(
     vkapi_context_t* context,
     vkapi_staging_pool_t* staging_pool,
+    vkapi_upload_batch_t* uploads,
     vkapi_commands_t* commands,
     VmaAllocator vma_alloc,
     vkapi_texture_t* texture,
@@ -363,19 +411,21 @@ void vkapi_texture_map(
     arena_t* scratch_arena,
     bool generate_mipmaps)
 {
-    vkapi_staging_instance_t* stage = vkapi_staging_get(staging_pool, vma_alloc, data_size);
-
-    void* mapped;
-    vmaMapMemory(vma_alloc, stage->mem, &mapped);
-    assert(mapped);
-    memcpy(mapped, data, data_size);
-    vmaUnmapMemory(vma_alloc, stage->mem);
-    vmaFlushAllocation(vma_alloc, stage->mem, 0, data_size);
-
-    VkBufferImageCopy* copy_buffers;
-    uint32_t copy_size;
+    // Image copies require the buffer offset to be a multiple of the texel size. Block compressed
+    // formats aren't sized here, but the default alignment is a multiple of their block size.
+    uint32_t comp_size = vkapi_texture_format_comp_size(texture->info.format);
+    uint32_t byte_size = vkapi_texture_format_byte_size(texture->info.format);
+    VkDeviceSize alignment = VKAPI_STAGING_DEFAULT_ALIGNMENT;
+    if (comp_size != UINT32_MAX && byte_size != UINT32_MAX &&
+        VKAPI_STAGING_DEFAULT_ALIGNMENT % (comp_size * byte_size) != 0)
+    {
+        alignment *= comp_size * byte_size;
+    }
+    vkapi_staging_instance_t stage =
+        vkapi_staging_get(staging_pool, vma_alloc, data_size, alignment);
 
-    vkapi_cmdbuffer_t* cmds = vkapi_commands_get_cmdbuffer(context, commands);
+    memcpy(stage.mapped, data, data_size);
+    vmaFlushAllocation(vma_alloc, stage.mem, stage.offset, data_size);
 
     if (!generate_mipmaps)
     {
@@ -399,14 +449,16 @@ void vkapi_texture_map(
         }
 
         // Create the info required for the copy.
-        copy_size = array_count * texture->info.mip_levels;
-        copy_buffers = ARENA_MAKE_ZERO_ARRAY(scratch_arena, VkBufferImageCopy, copy_size);
+        uint32_t copy_size = array_count * texture->info.mip_levels;
+        VkBufferImageCopy* copy_buffers =
+            ARENA_MAKE_ZERO_ARRAY(scratch_arena, VkBufferImageCopy, copy_size);
         for (uint32_t face = 0; face < array_count; ++face)
         {
             for (uint32_t level = 0; level < texture->info.mip_levels; ++level)
             {
                 size_t idx = face * texture->info.mip_levels + level;
-                copy_buffers[idx].bufferOffset = offsets[face * texture->info.mip_levels + level];
+                copy_buffers[idx].bufferOffset =
+                    stage.offset + offsets[face * texture->info.mip_levels + level];
                 copy_buffers[idx].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
                 copy_buffers[idx].imageSubresource.mipLevel = level;
                 copy_buffers[idx].imageSubresource.layerCount = 1;
@@ -416,77 +468,66 @@ void vkapi_texture_map(
                 copy_buffers[idx].imageExtent.depth = 1;
             }
         }
-        // Transition all mips to for dst transfer - this is required as the last step in copying is
-        // then to transition all mips ready for shader read. Not having the levels in the correct
-        // layout leads to validation warnings.
-        vkapi_texture_image_multi_transition(
-            texture,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            cmds->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            texture->info.mip_levels);
-    }
-    else
-    {
-        copy_buffers = ARENA_MAKE_ZERO_ARRAY(scratch_arena, VkBufferImageCopy, 1);
-        copy_size = 1;
-
-        // If generating a mipmap chain, only copy the first image - the rest will be blitted.
-        copy_buffers[0].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy_buffers[0].imageSubresource.mipLevel = 0;
-        copy_buffers[0].imageSubresource.layerCount = 1;
-        copy_buffers[0].imageSubresource.baseArrayLayer = 0;
-        copy_buffers[0].imageExtent.width = texture->info.width;
-        copy_buffers[0].imageExtent.height = texture->info.height;
-        copy_buffers[0].imageExtent.depth = 1;
 
-        vkapi_texture_image_transition(
-            texture,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            cmds->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            0);
+        // The copy, along with the transitions of all mips to transfer dst and then to shader read,
+        // is recorded with all other uploads for the frame.
+        vkapi_upload_batch_add_image(
+            uploads,
+            stage.buffer,
+            texture->image,
+            vkapi_texture_aspect_flags(texture->info.format),
+            array_count,
+            texture->info.mip_levels,
+            copy_buffers,
+            copy_size);
+        texture->image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        arena_reset(scratch_arena);
+        return;
     }
 
+    // If generating a mipmap chain, only copy the first image - the rest will be blitted. The blits
+    // depend on the copy so these aren't batched.
+    vkapi_cmdbuffer_t* cmds = vkapi_commands_get_cmdbuffer(context, commands);
+
+    VkBufferImageCopy copy_buffer = {0};
+    copy_buffer.bufferOffset = stage.offset;
+    copy_buffer.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy_buffer.imageSubresource.mipLevel = 0;
+    copy_buffer.imageSubresource.layerCount = 1;
+    copy_buffer.imageSubresource.baseArrayLayer = 0;
+    copy_buffer.imageExtent.width = texture->info.width;
+    copy_buffer.imageExtent.height = texture->info.height;
+    copy_buffer.imageExtent.depth = 1;
+
+    vkapi_texture_image_transition(
+        texture,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        cmds->instance,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0);
+
     vkCmdCopyBufferToImage(
         cmds->instance,
-        stage->buffer,
+        stage.buffer,
         texture->image,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        copy_size,
-        copy_buffers);
+        1,
+        &copy_buffer);
 
-    if (generate_mipmaps)
-    {
-        // Only the first level is transitioned, the other mip levels will be transitioned during
-        // blitting.
-        vkapi_texture_image_transition(
-            texture,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            cmds->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0);
+    // Only the first level is transitioned, the other mip levels will be transitioned during
+    // blitting.
+    vkapi_texture_image_transition(
+        texture,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        cmds->instance,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0);
 
-        vkapi_texture_gen_mipmaps(texture, context, commands, texture->info.mip_levels);
-    }
-    else
-    {
-        // Transition all mip levels ready for reads by the shader pipeline.
-        vkapi_texture_image_multi_transition(
-            texture,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            cmds->instance,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            texture->info.mip_levels);
-    }
+    vkapi_texture_gen_mipmaps(texture, context, commands, texture->info.mip_levels);
     arena_reset(scratch_arena);
 }
 
@@ -33,6 +33,7 @@ typedef struct VkApiDriver vkapi_driver_t;
 typedef struct Arena arena_t;
 typedef struct Commands vkapi_commands_t;
 typedef struct VkApiStagingPool vkapi_staging_pool_t;
+typedef struct UploadBatch vkapi_upload_batch_t;
 typedef struct TextureSamplerParams sampler_params_t;
 typedef struct SamplerCache vkapi_sampler_cache_t;
 
@@ -93,6 +94,14 @@ uint32_t vkapi_texture_format_comp_size(VkFormat format);
 void vkapi_texture_create_image(
     VmaAllocator vma, vkapi_texture_t* texture, VkImageUsageFlags usage_flags);
 
+/**
+ Create an image without any backing memory. Used for aliasing multiple images within a
+ single allocation.
+ @return The memory requirements of the image which must be satisfied when binding.
+ */
+VkMemoryRequirements vkapi_texture_create_unbound_image(
+    vkapi_context_t* context, vkapi_texture_t* texture, VkImageUsageFlags usage_flags);
+
 VkImageView vkapi_texture_create_image_view(
     vkapi_context_t* context, vkapi_texture_t* texture, uint32_t mip_level, uint32_t mip_count);
 
@@ -104,9 +113,25 @@ void vkapi_texture_create_2d(
     VkImageUsageFlags usage_flags,
     sampler_params_t* sampler_params);
 
+/**
+ Bind an image created with @sa vkapi_texture_create_unbound_image to a region of an
+ existing allocation and create the image views and sampler.
+ Note: The texture does not take ownership of the allocation.
+ */
+void vkapi_texture_create_aliased_2d(
+    vkapi_context_t* context,
+    VmaAllocator vma,
+    vkapi_sampler_cache_t* sc,
+    vkapi_texture_t* texture,
+    VmaAllocation alloc,
+    VkDeviceSize offset,
+    VkImageUsageFlags usage_flags,
+    sampler_params_t* sampler_params);
+
 void vkapi_texture_map(
     vkapi_context_t* context,
     vkapi_staging_pool_t* staging_pool,
+    vkapi_upload_batch_t* uploads,
     vkapi_commands_t* commands,
     VmaAllocator vma_alloc,
     vkapi_texture_t* texture,
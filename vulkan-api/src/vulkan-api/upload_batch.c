@@ -0,0 +1,269 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "upload_batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void vkapi_upload_batch_init(vkapi_upload_batch_t* b, arena_t* arena)
+{
+    assert(b);
+    memset(b, 0, sizeof(vkapi_upload_batch_t));
+    MAKE_DYN_ARRAY(vkapi_upload_buffer_copy_t, arena, 100, &b->buffer_copies);
+    MAKE_DYN_ARRAY(vkapi_upload_image_copy_t, arena, 20, &b->image_copies);
+    MAKE_DYN_ARRAY(VkBufferImageCopy, arena, 100, &b->image_regions);
+}
+
+void vkapi_upload_batch_add_buffer(
+    vkapi_upload_batch_t* b,
+    VkBuffer src,
+    VkBuffer dst,
+    VkDeviceSize src_offset,
+    VkDeviceSize dst_offset,
+    VkDeviceSize size,
+    VkBufferUsageFlags usage)
+{
+    assert(b);
+    assert(src && dst);
+    assert(size > 0);
+
+    // Remove the parts of earlier copies which this copy overwrites, so the pending regions never
+    // overlap and can be recorded in any order.
+    VkDeviceSize start = dst_offset;
+    VkDeviceSize end = dst_offset + size;
+    for (uint32_t i = 0; i < b->buffer_copies.size;)
+    {
+        vkapi_upload_buffer_copy_t* c =
+            DYN_ARRAY_GET_PTR(vkapi_upload_buffer_copy_t, &b->buffer_copies, i);
+        VkDeviceSize c_start = c->region.dstOffset;
+        VkDeviceSize c_end = c->region.dstOffset + c->region.size;
+        if (c->dst != dst || c_end <= start || c_start >= end)
+        {
+            ++i;
+            continue;
+        }
+
+        if (c_start >= start && c_end <= end)
+        {
+            // Completely overwritten - the order of the pending copies doesn't matter, so replace
+            // with the last copy.
+            vkapi_upload_buffer_copy_t last =
+                DYN_ARRAY_POP_BACK(vkapi_upload_buffer_copy_t, &b->buffer_copies);
+            if (i < b->buffer_copies.size)
+            {
+                DYN_ARRAY_SET(&b->buffer_copies, i, &last);
+            }
+            continue;
+        }
+        if (c_start < start && c_end > end)
+        {
+            // Overwritten in the middle, so split in two.
+            vkapi_upload_buffer_copy_t tail = *c;
+            tail.region.srcOffset += end - c_start;
+            tail.region.dstOffset = end;
+            tail.region.size = c_end - end;
+            c->region.size = start - c_start;
+            DYN_ARRAY_APPEND(&b->buffer_copies, &tail);
+        }
+        else if (c_start < start)
+        {
+            c->region.size = start - c_start;
+        }
+        else
+        {
+            VkDeviceSize delta = end - c_start;
+            c->region.srcOffset += delta;
+            c->region.dstOffset += delta;
+            c->region.size -= delta;
+        }
+        ++i;
+    }
+
+    vkapi_upload_buffer_copy_t copy = {
+        .src = src,
+        .dst = dst,
+        .usage = usage,
+        .region = {.srcOffset = src_offset, .dstOffset = dst_offset, .size = size}};
+    DYN_ARRAY_APPEND(&b->buffer_copies, &copy);
+    b->stats.upload_count++;
+}
+
+void vkapi_upload_batch_add_image(
+    vkapi_upload_batch_t* b,
+    VkBuffer src,
+    VkImage image,
+    VkImageAspectFlags aspect,
+    uint32_t layer_count,
+    uint32_t mip_levels,
+    VkBufferImageCopy* regions,
+    uint32_t region_count)
+{
+    assert(b);
+    assert(src && image);
+    assert(regions && region_count > 0);
+
+    vkapi_upload_image_copy_t copy = {
+        .src = src,
+        .image = image,
+        .aspect = aspect,
+        .layer_count = layer_count,
+        .mip_levels = mip_levels,
+        .region_start = b->image_regions.size,
+        .region_count = region_count};
+    for (uint32_t i = 0; i < region_count; ++i)
+    {
+        DYN_ARRAY_APPEND(&b->image_regions, &regions[i]);
+    }
+    DYN_ARRAY_APPEND(&b->image_copies, &copy);
+    b->stats.upload_count++;
+}
+
+bool vkapi_upload_batch_is_empty(vkapi_upload_batch_t* b)
+{
+    assert(b);
+    return !b->buffer_copies.size && !b->image_copies.size;
+}
+
+int _upload_batch_compare_copies(const void* lhs, const void* rhs)
+{
+    const vkapi_upload_buffer_copy_t* a = lhs;
+    const vkapi_upload_buffer_copy_t* b = rhs;
+    if (a->dst != b->dst)
+    {
+        return (uintptr_t)a->dst < (uintptr_t)b->dst ? -1 : 1;
+    }
+    if (a->src != b->src)
+    {
+        return (uintptr_t)a->src < (uintptr_t)b->src ? -1 : 1;
+    }
+    if (a->region.dstOffset != b->region.dstOffset)
+    {
+        return a->region.dstOffset < b->region.dstOffset ? -1 : 1;
+    }
+    return 0;
+}
+
+uint32_t vkapi_upload_batch_build_buffer_cmds(
+    vkapi_upload_batch_t* b, arena_t* arena, vkapi_upload_buffer_cmd_t** out_cmds)
+{
+    assert(b);
+    assert(out_cmds);
+
+    uint32_t copy_count = b->buffer_copies.size;
+    if (!copy_count)
+    {
+        *out_cmds = NULL;
+        return 0;
+    }
+
+    vkapi_upload_buffer_copy_t* copies = b->buffer_copies.data;
+    qsort(copies, copy_count, sizeof(vkapi_upload_buffer_copy_t), _upload_batch_compare_copies);
+
+    vkapi_upload_buffer_cmd_t* cmds =
+        ARENA_MAKE_ZERO_ARRAY(arena, vkapi_upload_buffer_cmd_t, copy_count);
+    VkBufferCopy* regions = ARENA_MAKE_ARRAY(arena, VkBufferCopy, copy_count, 0);
+    uint32_t cmd_count = 0;
+    uint32_t region_count = 0;
+
+    for (uint32_t i = 0; i < copy_count; ++i)
+    {
+        vkapi_upload_buffer_copy_t* c = &copies[i];
+        vkapi_upload_buffer_cmd_t* cmd = cmd_count ? &cmds[cmd_count - 1] : NULL;
+        if (!cmd || cmd->dst != c->dst || cmd->src != c->src)
+        {
+            cmd = &cmds[cmd_count++];
+            cmd->src = c->src;
+            cmd->dst = c->dst;
+            cmd->regions = &regions[region_count];
+        }
+        cmd->usage |= c->usage;
+
+        // Uploads are packed into the staging memory in the order they are made, so consecutive
+        // uploads to a buffer are usually adjacent in both.
+        VkBufferCopy* prev = cmd->region_count ? &cmd->regions[cmd->region_count - 1] : NULL;
+        if (prev && prev->dstOffset + prev->size == c->region.dstOffset &&
+            prev->srcOffset + prev->size == c->region.srcOffset)
+        {
+            prev->size += c->region.size;
+            b->stats.merged_region_count++;
+            continue;
+        }
+        regions[region_count++] = c->region;
+        cmd->region_count++;
+    }
+
+    *out_cmds = cmds;
+    return cmd_count;
+}
+
+void vkapi_upload_batch_dst_access(
+    VkBufferUsageFlags usage, VkAccessFlags* access, VkPipelineStageFlags* stages)
+{
+    assert(access);
+    assert(stages);
+    *access = 0;
+    *stages = 0;
+    if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+    {
+        *access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        *stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+    {
+        *access |= VK_ACCESS_UNIFORM_READ_BIT;
+        *stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+    if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+    {
+        *access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        *stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    }
+    if (usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+    {
+        *access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        *stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    }
+    if (!*stages)
+    {
+        // Unknown usage, so make the upload visible to everything.
+        *access = VK_ACCESS_MEMORY_READ_BIT;
+        *stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+}
+
+void vkapi_upload_batch_clear(vkapi_upload_batch_t* b)
+{
+    assert(b);
+    dyn_array_clear(&b->buffer_copies);
+    dyn_array_clear(&b->image_copies);
+    dyn_array_clear(&b->image_regions);
+}
+
+void vkapi_upload_batch_end_frame(vkapi_upload_batch_t* b)
+{
+    assert(b);
+    b->last_frame_stats = b->stats;
+    memset(&b->stats, 0, sizeof(vkapi_upload_stats_t));
+}
@@ -0,0 +1,150 @@
+/* Copyright (c) 2024 Garry Whitehead
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __VKAPI_UPLOAD_BATCH_H__
+#define __VKAPI_UPLOAD_BATCH_H__
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <utility/arena.h>
+
+typedef struct UploadBufferCopy
+{
+    VkBuffer src;
+    VkBuffer dst;
+    VkBufferUsageFlags usage;
+    VkBufferCopy region;
+} vkapi_upload_buffer_copy_t;
+
+typedef struct UploadImageCopy
+{
+    VkBuffer src;
+    VkImage image;
+    VkImageAspectFlags aspect;
+    uint32_t layer_count;
+    uint32_t mip_levels;
+    /// Index into the batch image regions.
+    uint32_t region_start;
+    uint32_t region_count;
+} vkapi_upload_image_copy_t;
+
+/**
+ The copies to a single destination buffer, recorded with one vkCmdCopyBuffer. Uploads usually
+ share the staging ring, but those given a dedicated staging buffer require their own command.
+ */
+typedef struct UploadBufferCmd
+{
+    VkBuffer src;
+    VkBuffer dst;
+    /// The usage of all uploads to this buffer, for the barrier.
+    VkBufferUsageFlags usage;
+    VkBufferCopy* regions;
+    uint32_t region_count;
+} vkapi_upload_buffer_cmd_t;
+
+typedef struct UploadStats
+{
+    /// Buffer and image copies requested.
+    uint32_t upload_count;
+    /// vkCmdCopyBuffer and vkCmdCopyBufferToImage calls recorded.
+    uint32_t copy_cmd_count;
+    /// Buffer regions removed by merging with an adjacent region.
+    uint32_t merged_region_count;
+    uint32_t barrier_count;
+    uint32_t submission_count;
+} vkapi_upload_stats_t;
+
+/**
+ Accumulates the uploads for a frame so they can be recorded together on the transfer command
+ buffer. Buffer copies are merged where both the staging and destination ranges are adjacent, so
+ each destination requires one copy command. All copies share one barrier before and one after.
+ */
+typedef struct UploadBatch
+{
+    /// vkapi_upload_buffer_copy_t.
+    arena_dyn_array_t buffer_copies;
+    /// vkapi_upload_image_copy_t.
+    arena_dyn_array_t image_copies;
+    /// VkBufferImageCopy regions for all image copies.
+    arena_dyn_array_t image_regions;
+    /// Counts for the current frame.
+    vkapi_upload_stats_t stats;
+    /// Counts for the last completed frame.
+    vkapi_upload_stats_t last_frame_stats;
+} vkapi_upload_batch_t;
+
+void vkapi_upload_batch_init(vkapi_upload_batch_t* b, arena_t* arena);
+
+/**
+ Add a buffer copy from staging memory. Any part of an earlier pending copy to the same destination
+ range is superseded by this copy.
+ */
+void vkapi_upload_batch_add_buffer(
+    vkapi_upload_batch_t* b,
+    VkBuffer src,
+    VkBuffer dst,
+    VkDeviceSize src_offset,
+    VkDeviceSize dst_offset,
+    VkDeviceSize size,
+    VkBufferUsageFlags usage);
+
+/**
+ Add a copy of all regions of an image from staging memory. The image will be transitioned to a
+ shader read layout once copied.
+ */
+void vkapi_upload_batch_add_image(
+    vkapi_upload_batch_t* b,
+    VkBuffer src,
+    VkImage image,
+    VkImageAspectFlags aspect,
+    uint32_t layer_count,
+    uint32_t mip_levels,
+    VkBufferImageCopy* regions,
+    uint32_t region_count);
+
+bool vkapi_upload_batch_is_empty(vkapi_upload_batch_t* b);
+
+/**
+ Sort and merge the pending buffer copies into one command per destination buffer.
+ @param arena The arena the commands and their regions are allocated from.
+ @param out_cmds Set to the array of commands.
+ @return The number of commands.
+ */
+uint32_t vkapi_upload_batch_build_buffer_cmds(
+    vkapi_upload_batch_t* b, arena_t* arena, vkapi_upload_buffer_cmd_t** out_cmds);
+
+/**
+ Get the access and pipeline stages which read a buffer after an upload, based on its usage.
+ */
+void vkapi_upload_batch_dst_access(
+    VkBufferUsageFlags usage, VkAccessFlags* access, VkPipelineStageFlags* stages);
+
+/**
+ Remove all pending copies once they have been recorded.
+ */
+void vkapi_upload_batch_clear(vkapi_upload_batch_t* b);
+
+void vkapi_upload_batch_end_frame(vkapi_upload_batch_t* b);
+
+#endif
@@ -0,0 +1,211 @@
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <vulkan-api/descriptor_allocator.h>
+
+TEST_GROUP(DescriptorAllocatorGroup);
+
+TEST_SETUP(DescriptorAllocatorGroup) {}
+
+TEST_TEAR_DOWN(DescriptorAllocatorGroup) {}
+
+// A fake device which hands out handles rather than creating any Vulkan objects.
+typedef struct FakeDevice
+{
+    uint32_t pool_create_count;
+    uint32_t pool_reset_count;
+    uint32_t pool_destroy_count;
+    uint64_t next_handle;
+    // Allocations from this pool report the pool is out of memory.
+    VkDescriptorPool full_pool;
+} fake_device_t;
+
+static VkDescriptorPool fake_create_pool(void* user_data)
+{
+    fake_device_t* d = user_data;
+    d->pool_create_count++;
+    return (VkDescriptorPool)(uintptr_t)++d->next_handle;
+}
+
+static void fake_reset_pool(void* user_data, VkDescriptorPool pool)
+{
+    fake_device_t* d = user_data;
+    d->pool_reset_count++;
+}
+
+static void fake_destroy_pool(void* user_data, VkDescriptorPool pool)
+{
+    fake_device_t* d = user_data;
+    d->pool_destroy_count++;
+}
+
+static bool
+fake_allocate_sets(void* user_data, VkDescriptorPool pool, void* params, VkDescriptorSet* out_sets)
+{
+    fake_device_t* d = user_data;
+    if (pool == d->full_pool)
+    {
+        return false;
+    }
+    for (int i = 0; i < VKAPI_PIPELINE_MAX_DESC_SET_COUNT; ++i)
+    {
+        out_sets[i] = (VkDescriptorSet)(uintptr_t)++d->next_handle;
+    }
+    return true;
+}
+
+static void init_allocator(vkapi_desc_allocator_t* a, fake_device_t* d, arena_t* arena)
+{
+    *d = (fake_device_t){0};
+    vkapi_desc_pool_funcs_t funcs = {
+        .create_pool = fake_create_pool,
+        .reset_pool = fake_reset_pool,
+        .destroy_pool = fake_destroy_pool,
+        .allocate_sets = fake_allocate_sets};
+    vkapi_desc_alloc_init(a, &funcs, d, arena);
+}
+
+TEST(DescriptorAllocatorGroup, DescriptorAllocator_ReuseTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    fake_device_t d;
+    vkapi_desc_allocator_t a;
+    init_allocator(&a, &d, &arena);
+    vkapi_desc_alloc_begin_frame(&a, 0);
+
+    VkDescriptorSet sets_a[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    VkDescriptorSet sets_b[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    VkDescriptorSet sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets_a));
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x20, NULL, sets_b));
+    TEST_ASSERT(sets_a[0] != sets_b[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, d.pool_create_count);
+
+    // Same contents within the frame.
+    TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    TEST_ASSERT_EQUAL_MEMORY(sets_a, sets, sizeof(sets));
+    TEST_ASSERT_EQUAL_UINT32(3, a.stats.lookup_count);
+    TEST_ASSERT_EQUAL_UINT32(1, a.stats.hit_count);
+    TEST_ASSERT_EQUAL_UINT32(2, a.stats.write_count);
+
+    // And in the following frames.
+    for (uint64_t frame = 1; frame < 4; ++frame)
+    {
+        vkapi_desc_alloc_begin_frame(&a, frame);
+        TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+        TEST_ASSERT_EQUAL_MEMORY(sets_a, sets, sizeof(sets));
+        TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x20, NULL, sets));
+        TEST_ASSERT_EQUAL_MEMORY(sets_b, sets, sizeof(sets));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, a.stats.write_count);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, vkapi_desc_alloc_hit_rate(&a.stats));
+
+    vkapi_desc_alloc_begin_frame(&a, 4);
+    TEST_ASSERT_EQUAL_UINT32(2, a.last_frame_stats.hit_count);
+    TEST_ASSERT_EQUAL_UINT32(0, a.stats.lookup_count);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, vkapi_desc_alloc_hit_rate(&a.stats));
+    TEST_ASSERT_EQUAL_UINT32(1, d.pool_create_count);
+    TEST_ASSERT_EQUAL_UINT32(0, d.pool_reset_count);
+
+    vkapi_desc_alloc_destroy(&a);
+    TEST_ASSERT_EQUAL_UINT32(1, d.pool_destroy_count);
+    arena_release(&arena);
+}
+
+TEST(DescriptorAllocatorGroup, DescriptorAllocator_PoolResetTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    fake_device_t d;
+    vkapi_desc_allocator_t a;
+    init_allocator(&a, &d, &arena);
+
+    VkDescriptorSet first_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    VkDescriptorSet sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    uint64_t frame = 0;
+    vkapi_desc_alloc_begin_frame(&a, frame);
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x10, NULL, first_sets));
+
+    // Once the pool reaches its age, the sets are no longer reused and a new pool is opened.
+    for (; frame < VKAPI_DESC_ALLOC_MAX_POOL_AGE; ++frame)
+    {
+        vkapi_desc_alloc_begin_frame(&a, frame);
+        TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    }
+    uint64_t open_frame = frame;
+    vkapi_desc_alloc_begin_frame(&a, frame);
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    TEST_ASSERT(sets[0] != first_sets[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, d.pool_create_count);
+    TEST_ASSERT_EQUAL_UINT32(0, d.pool_reset_count);
+
+    // The retired pool is reset once the frames using it have completed.
+    uint64_t last_used_frame = frame - 1;
+    for (++frame; frame <= last_used_frame + VKAPI_DESC_ALLOC_FRAMES_IN_FLIGHT; ++frame)
+    {
+        vkapi_desc_alloc_begin_frame(&a, frame);
+        TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+        TEST_ASSERT_EQUAL_UINT32(0, d.pool_reset_count);
+    }
+    vkapi_desc_alloc_begin_frame(&a, frame);
+    TEST_ASSERT_EQUAL_UINT32(1, d.pool_reset_count);
+    TEST_ASSERT_EQUAL_UINT32(1, a.stats.pool_reset_count);
+
+    // The reset pool is reused rather than creating a new one when the current pool retires.
+    for (++frame; frame < open_frame + VKAPI_DESC_ALLOC_MAX_POOL_AGE; ++frame)
+    {
+        vkapi_desc_alloc_begin_frame(&a, frame);
+        TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    }
+    vkapi_desc_alloc_begin_frame(&a, frame);
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    TEST_ASSERT_EQUAL_UINT32(2, d.pool_create_count);
+
+    vkapi_desc_alloc_destroy(&a);
+    TEST_ASSERT_EQUAL_UINT32(2, d.pool_destroy_count);
+    arena_release(&arena);
+}
+
+TEST(DescriptorAllocatorGroup, DescriptorAllocator_PoolFullTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    fake_device_t d;
+    vkapi_desc_allocator_t a;
+    init_allocator(&a, &d, &arena);
+    vkapi_desc_alloc_begin_frame(&a, 0);
+
+    VkDescriptorSet first_sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    VkDescriptorSet sets[VKAPI_PIPELINE_MAX_DESC_SET_COUNT];
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x10, NULL, first_sets));
+
+    // Fill the first pool up to the allocator limit.
+    for (uint64_t i = 1; i < VKAPI_DESC_ALLOC_POOL_SET_COUNT; ++i)
+    {
+        TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x100 + i, NULL, sets));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, d.pool_create_count);
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x20, NULL, sets));
+    TEST_ASSERT_EQUAL_UINT32(2, d.pool_create_count);
+
+    // The device reports the pool is out of memory before the limit is reached.
+    vkapi_desc_pool_t* p = DYN_ARRAY_GET_PTR(vkapi_desc_pool_t, &a.pools, a.current_pool);
+    d.full_pool = p->instance;
+    TEST_ASSERT_FALSE(vkapi_desc_alloc_get(&a, 0x30, NULL, sets));
+    TEST_ASSERT_EQUAL_UINT32(3, d.pool_create_count);
+    TEST_ASSERT_EQUAL_UINT32(VKAPI_DESC_POOL_FULL, p->state);
+
+    // Sets in the full pools can still be reused.
+    TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x10, NULL, sets));
+    TEST_ASSERT_EQUAL_MEMORY(first_sets, sets, sizeof(sets));
+    TEST_ASSERT_TRUE(vkapi_desc_alloc_get(&a, 0x20, NULL, sets));
+
+    vkapi_desc_alloc_destroy(&a);
+    arena_release(&arena);
+}
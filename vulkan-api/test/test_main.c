@@ -10,6 +10,13 @@ TEST_GROUP_RUNNER(ProgramManagerGroup)
 TEST_GROUP_RUNNER(ShaderGroup)
 {
     RUN_TEST_CASE(ShaderGroup, Shader_CompilerTests)
+    RUN_TEST_CASE(ShaderGroup, Shader_BatchCompileTests)
+}
+
+TEST_GROUP_RUNNER(ShaderCacheGroup)
+{
+    RUN_TEST_CASE(ShaderCacheGroup, ShaderCache_ReflectionTests)
+    RUN_TEST_CASE(ShaderCacheGroup, ShaderCache_EvictionTests)
 }
 
 TEST_GROUP_RUNNER(CacheGroup)
@@ -17,11 +24,54 @@ TEST_GROUP_RUNNER(CacheGroup)
     RUN_TEST_CASE(CacheGroup, KeyCompare_Test)
 }
 
+TEST_GROUP_RUNNER(PipelineDiskCacheGroup)
+{
+    RUN_TEST_CASE(PipelineDiskCacheGroup, Validate_Tests)
+    RUN_TEST_CASE(PipelineDiskCacheGroup, ReadWrite_Tests)
+    RUN_TEST_CASE(PipelineDiskCacheGroup, Stats_Tests)
+}
+
+TEST_GROUP_RUNNER(PipelineStateGroup)
+{
+    RUN_TEST_CASE(PipelineStateGroup, PipelineState_TrackerTests)
+    RUN_TEST_CASE(PipelineStateGroup, PipelineState_BlockHashTests)
+    RUN_TEST_CASE(PipelineStateGroup, PipelineState_CacheDirtyTests)
+}
+
+TEST_GROUP_RUNNER(DescriptorAllocatorGroup)
+{
+    RUN_TEST_CASE(DescriptorAllocatorGroup, DescriptorAllocator_ReuseTests)
+    RUN_TEST_CASE(DescriptorAllocatorGroup, DescriptorAllocator_PoolResetTests)
+    RUN_TEST_CASE(DescriptorAllocatorGroup, DescriptorAllocator_PoolFullTests)
+}
+
+TEST_GROUP_RUNNER(StagingRingGroup)
+{
+    RUN_TEST_CASE(StagingRingGroup, StagingRing_AllocTests)
+    RUN_TEST_CASE(StagingRingGroup, StagingRing_WrapTests)
+    RUN_TEST_CASE(StagingRingGroup, StagingRing_RegionLimitTests)
+}
+
+TEST_GROUP_RUNNER(UploadBatchGroup)
+{
+    RUN_TEST_CASE(UploadBatchGroup, UploadBatch_MergeTests)
+    RUN_TEST_CASE(UploadBatchGroup, UploadBatch_OverlapTests)
+    RUN_TEST_CASE(UploadBatchGroup, UploadBatch_StagingSourceTests)
+}
+
 static void run_all_tests()
 {
+    RUN_TEST_GROUP(CacheGroup)
+    RUN_TEST_GROUP(PipelineStateGroup)
+    RUN_TEST_GROUP(PipelineDiskCacheGroup)
+    RUN_TEST_GROUP(ShaderCacheGroup)
+    RUN_TEST_GROUP(DescriptorAllocatorGroup)
+    RUN_TEST_GROUP(StagingRingGroup)
+    RUN_TEST_GROUP(UploadBatchGroup)
+#if RPE_BUILD_GPU_TESTS
     RUN_TEST_GROUP(ProgramManagerGroup)
     RUN_TEST_GROUP(ShaderGroup)
-    RUN_TEST_GROUP(CacheGroup)
+#endif
 }
 
 // clang-format on
@@ -0,0 +1,187 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <utility/hash.h>
+#include <vulkan-api/pipeline_disk_cache.h>
+
+TEST_GROUP(PipelineDiskCacheGroup);
+
+TEST_SETUP(PipelineDiskCacheGroup) {}
+
+TEST_TEAR_DOWN(PipelineDiskCacheGroup) {}
+
+// A fake device and the Vulkan pipeline cache data it would produce - no device is required.
+static void create_fake_data(VkPhysicalDeviceProperties* props, uint8_t* data, size_t data_size)
+{
+    memset(props, 0, sizeof(VkPhysicalDeviceProperties));
+    props->vendorID = 0x10DE;
+    props->deviceID = 0x2204;
+    props->driverVersion = 1234;
+    for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+    {
+        props->pipelineCacheUUID[i] = (uint8_t)i;
+    }
+
+    VkPipelineCacheHeaderVersionOne vk_header = {0};
+    vk_header.headerSize = sizeof(VkPipelineCacheHeaderVersionOne);
+    vk_header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+    vk_header.vendorID = props->vendorID;
+    vk_header.deviceID = props->deviceID;
+    memcpy(vk_header.pipelineCacheUUID, props->pipelineCacheUUID, VK_UUID_SIZE);
+    memcpy(data, &vk_header, sizeof(VkPipelineCacheHeaderVersionOne));
+    for (size_t i = sizeof(VkPipelineCacheHeaderVersionOne); i < data_size; ++i)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+}
+
+static uint8_t* create_fake_blob(
+    const VkPhysicalDeviceProperties* props, const uint8_t* data, size_t data_size, size_t* size)
+{
+    vkapi_pl_disk_cache_header_t header = {
+        .magic = VKAPI_PL_DISK_CACHE_MAGIC,
+        .version = VKAPI_PL_DISK_CACHE_VERSION,
+        .vendor_id = props->vendorID,
+        .device_id = props->deviceID,
+        .driver_version = props->driverVersion,
+        .pipeline_count = 10,
+        .data_size = data_size,
+        .data_hash = murmur2_hash((void*)data, (uint32_t)data_size, 0)};
+    memcpy(header.uuid, props->pipelineCacheUUID, VK_UUID_SIZE);
+
+    *size = sizeof(vkapi_pl_disk_cache_header_t) + data_size;
+    uint8_t* blob = malloc(*size);
+    memcpy(blob, &header, sizeof(vkapi_pl_disk_cache_header_t));
+    memcpy(blob + sizeof(vkapi_pl_disk_cache_header_t), data, data_size);
+    return blob;
+}
+
+TEST(PipelineDiskCacheGroup, Validate_Tests)
+{
+    VkPhysicalDeviceProperties props;
+    uint8_t data[256];
+    create_fake_data(&props, data, sizeof(data));
+
+    size_t size;
+    uint8_t* blob = create_fake_blob(&props, data, sizeof(data), &size);
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, size, &props) == VKAPI_PL_DISK_CACHE_VALID);
+
+    // Truncated files.
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, 8, &props) == VKAPI_PL_DISK_CACHE_CORRUPT);
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_validate(blob, size - 1, &props) == VKAPI_PL_DISK_CACHE_CORRUPT);
+
+    // A flipped bit in the data.
+    blob[size - 1] ^= 0x1;
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, size, &props) == VKAPI_PL_DISK_CACHE_CORRUPT);
+    blob[size - 1] ^= 0x1;
+
+    // Not a cache file.
+    blob[0] ^= 0xff;
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, size, &props) == VKAPI_PL_DISK_CACHE_CORRUPT);
+    blob[0] ^= 0xff;
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, size, &props) == VKAPI_PL_DISK_CACHE_VALID);
+
+    // A different device or driver.
+    VkPhysicalDeviceProperties other_props = props;
+    other_props.driverVersion = 1235;
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_validate(blob, size, &other_props) == VKAPI_PL_DISK_CACHE_MISMATCH);
+    other_props = props;
+    other_props.vendorID = 0x1002;
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_validate(blob, size, &other_props) == VKAPI_PL_DISK_CACHE_MISMATCH);
+    other_props = props;
+    other_props.pipelineCacheUUID[5] = 0xff;
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_validate(blob, size, &other_props) == VKAPI_PL_DISK_CACHE_MISMATCH);
+    free(blob);
+
+    // Our header is valid but the Vulkan header disagrees.
+    data[offsetof(VkPipelineCacheHeaderVersionOne, deviceID)] ^= 0xff;
+    blob = create_fake_blob(&props, data, sizeof(data), &size);
+    TEST_ASSERT(vkapi_pl_disk_cache_validate(blob, size, &props) == VKAPI_PL_DISK_CACHE_CORRUPT);
+    free(blob);
+}
+
+TEST(PipelineDiskCacheGroup, ReadWrite_Tests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    const char* path = "test_pipeline_cache.bin";
+    remove(path);
+
+    VkPhysicalDeviceProperties props;
+    uint8_t data[512];
+    create_fake_data(&props, data, sizeof(data));
+
+    void* blob = NULL;
+    size_t size = 0;
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_read_blob(path, &props, &arena, &blob, &size) ==
+        VKAPI_PL_DISK_CACHE_MISSING);
+
+    TEST_ASSERT(vkapi_pl_disk_cache_write_blob(path, &props, data, sizeof(data), 20, &arena));
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_read_blob(path, &props, &arena, &blob, &size) ==
+        VKAPI_PL_DISK_CACHE_VALID);
+    TEST_ASSERT(size == sizeof(vkapi_pl_disk_cache_header_t) + sizeof(data));
+    vkapi_pl_disk_cache_header_t* header = blob;
+    TEST_ASSERT(header->pipeline_count == 20);
+    uint8_t* blob_data = (uint8_t*)blob + sizeof(vkapi_pl_disk_cache_header_t);
+    TEST_ASSERT(memcmp(blob_data, data, sizeof(data)) == 0);
+
+    // Overwriting replaces the previous cache.
+    TEST_ASSERT(vkapi_pl_disk_cache_write_blob(path, &props, data, 128, 5, &arena));
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_read_blob(path, &props, &arena, &blob, &size) ==
+        VKAPI_PL_DISK_CACHE_VALID);
+    TEST_ASSERT(size == sizeof(vkapi_pl_disk_cache_header_t) + 128);
+
+    // A partially written file is treated as corrupt.
+    FILE* fp = fopen(path, "wb");
+    TEST_ASSERT(fp);
+    fwrite(data, 1, 16, fp);
+    fclose(fp);
+    TEST_ASSERT(
+        vkapi_pl_disk_cache_read_blob(path, &props, &arena, &blob, &size) ==
+        VKAPI_PL_DISK_CACHE_CORRUPT);
+
+    remove(path);
+    arena_release(&arena);
+}
+
+TEST(PipelineDiskCacheGroup, Stats_Tests)
+{
+    vkapi_pl_disk_cache_t c;
+    memset(&c, 0, sizeof(vkapi_pl_disk_cache_t));
+    c.load_status = VKAPI_PL_DISK_CACHE_VALID;
+    c.loaded_pipeline_count = 3;
+    c.has_feedback = true;
+
+    VkPipelineCreationFeedbackEXT hit = {
+        .flags = VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT |
+            VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT};
+    VkPipelineCreationFeedbackEXT miss = {.flags = VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT};
+    // The hit bit is ignored unless the feedback is valid.
+    VkPipelineCreationFeedbackEXT invalid = {
+        .flags = VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT};
+
+    vkapi_pl_disk_cache_record(&c, &hit);
+    vkapi_pl_disk_cache_record(&c, &hit);
+    vkapi_pl_disk_cache_record(&c, &miss);
+    vkapi_pl_disk_cache_record(&c, &invalid);
+    vkapi_pl_disk_cache_record(&c, NULL);
+
+    vkapi_pl_disk_cache_stats_t stats = vkapi_pl_disk_cache_get_stats(&c);
+    TEST_ASSERT(stats.load_status == VKAPI_PL_DISK_CACHE_VALID);
+    TEST_ASSERT_EQUAL_UINT(3, stats.loaded_pipeline_count);
+    TEST_ASSERT_EQUAL_UINT(2, stats.warm_count);
+    TEST_ASSERT_EQUAL_UINT(3, stats.cold_count);
+    TEST_ASSERT_TRUE(stats.has_feedback);
+}
@@ -0,0 +1,146 @@
+#include <string.h>
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <vulkan-api/driver.h>
+#include <vulkan-api/pipeline_cache.h>
+#include <vulkan-api/pipeline_state.h>
+
+TEST_GROUP(PipelineStateGroup);
+
+TEST_SETUP(PipelineStateGroup) {}
+
+TEST_TEAR_DOWN(PipelineStateGroup) {}
+
+static void set_all_block_hashes(vkapi_pl_state_tracker_t* t, uint64_t base)
+{
+    for (uint32_t i = 0; i < VKAPI_PL_STATE_BLOCK_COUNT; ++i)
+    {
+        vkapi_pl_state_set_block_hash(t, i, base + i);
+    }
+}
+
+TEST(PipelineStateGroup, PipelineState_TrackerTests)
+{
+    vkapi_pl_state_tracker_t t;
+    vkapi_pl_state_init(&t);
+    TEST_ASSERT_EQUAL_UINT32(VKAPI_PL_STATE_ALL_DIRTY, t.dirty_blocks);
+
+    set_all_block_hashes(&t, 100);
+    TEST_ASSERT_EQUAL_UINT32(0, t.dirty_blocks);
+    TEST_ASSERT(t.state_hash != 0);
+
+    // Nothing bound yet.
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_bind(&t, false));
+    vkapi_pl_state_set_bound(&t);
+    TEST_ASSERT_FALSE(vkapi_pl_state_requires_bind(&t, false));
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_bind(&t, true));
+
+    // A block marked dirty but set back to the same value doesn't need a bind.
+    vkapi_pl_state_mark_dirty(&t, VKAPI_PL_STATE_BLEND);
+    TEST_ASSERT_TRUE(vkapi_pl_state_is_block_dirty(&t, VKAPI_PL_STATE_BLEND));
+    TEST_ASSERT_FALSE(vkapi_pl_state_is_block_dirty(&t, VKAPI_PL_STATE_RASTER));
+    vkapi_pl_state_set_block_hash(&t, VKAPI_PL_STATE_BLEND, 100 + VKAPI_PL_STATE_BLEND);
+    TEST_ASSERT_FALSE(vkapi_pl_state_requires_bind(&t, false));
+
+    vkapi_pl_state_mark_dirty(&t, VKAPI_PL_STATE_BLEND);
+    vkapi_pl_state_set_block_hash(&t, VKAPI_PL_STATE_BLEND, 5000);
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_bind(&t, false));
+    vkapi_pl_state_set_bound(&t);
+
+    vkapi_pl_state_set_block_hash(&t, VKAPI_PL_STATE_BLEND, 100 + VKAPI_PL_STATE_BLEND);
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_bind(&t, false));
+    vkapi_pl_state_set_bound(&t);
+
+    // Descriptor sets.
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_desc_bind(&t, 0x1234, false));
+    vkapi_pl_state_set_desc_bound(&t, 0x1234);
+    TEST_ASSERT_FALSE(vkapi_pl_state_requires_desc_bind(&t, 0x1234, false));
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_desc_bind(&t, 0x1234, true));
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_desc_bind(&t, 0x5678, false));
+
+    // Nothing is bound to a new command buffer.
+    vkapi_pl_state_invalidate(&t);
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_bind(&t, false));
+    TEST_ASSERT_TRUE(vkapi_pl_state_requires_desc_bind(&t, 0x1234, false));
+
+    TEST_ASSERT_EQUAL_UINT32(3, t.stats.pl_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(2, t.stats.redundant_pl_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(1, t.stats.desc_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(1, t.stats.redundant_desc_bind_count);
+
+    vkapi_pl_state_end_frame(&t);
+    TEST_ASSERT_EQUAL_UINT32(3, t.last_frame_stats.pl_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(2, t.last_frame_stats.redundant_pl_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(0, t.stats.pl_bind_count);
+    TEST_ASSERT_EQUAL_UINT32(0, t.stats.redundant_desc_bind_count);
+}
+
+TEST(PipelineStateGroup, PipelineState_BlockHashTests)
+{
+    graphics_pl_key_t key = {0};
+    uint64_t hashes[VKAPI_PL_STATE_BLOCK_COUNT];
+    for (uint32_t i = 0; i < VKAPI_PL_STATE_BLOCK_COUNT; ++i)
+    {
+        hashes[i] = vkapi_pline_cache_hash_block(&key, i);
+    }
+    // Identical (zeroed) blocks still hash differently.
+    TEST_ASSERT(hashes[VKAPI_PL_STATE_DEPTH_STENCIL] != hashes[VKAPI_PL_STATE_BLEND]);
+
+    // Changing a field only changes the hash of the block it belongs to.
+    key.raster_state.cull_mode = VK_CULL_MODE_FRONT_BIT;
+    key.tesse_vert_count = 3;
+    key.blend_factor_block.blend_enable = VK_TRUE;
+    for (uint32_t i = 0; i < VKAPI_PL_STATE_BLOCK_COUNT; ++i)
+    {
+        uint64_t h = vkapi_pline_cache_hash_block(&key, i);
+        if (i == VKAPI_PL_STATE_RASTER || i == VKAPI_PL_STATE_BLEND)
+        {
+            TEST_ASSERT(h != hashes[i]);
+        }
+        else
+        {
+            TEST_ASSERT(h == hashes[i]);
+        }
+    }
+}
+
+TEST(PipelineStateGroup, PipelineState_CacheDirtyTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    // No device is needed to track the state - only the bind itself uses Vulkan.
+    vkapi_driver_t* driver = ARENA_MAKE_ZERO_STRUCT(&arena, vkapi_driver_t);
+    vkapi_pl_state_init(&driver->pl_state);
+    vkapi_pipeline_cache_t* c = vkapi_pline_cache_init(&arena, driver);
+    vkapi_pline_cache_update_state_hash(c);
+    vkapi_pl_state_tracker_t* t = &driver->pl_state;
+    TEST_ASSERT_EQUAL_UINT32(0, t->dirty_blocks);
+    uint64_t state_hash = t->state_hash;
+
+    // Setting a value which is already set doesn't dirty the block.
+    vkapi_pline_cache_bind_cull_mode(c, c->graphics_pline_requires.raster_state.cull_mode);
+    vkapi_pline_cache_bind_depth_test_enable(c, false);
+    TEST_ASSERT_EQUAL_UINT32(0, t->dirty_blocks);
+
+    vkapi_pline_cache_bind_depth_test_enable(c, true);
+    struct DepthStencilBlock ds = c->graphics_pline_requires.depth_stencil_block;
+    ds.stencil_test_enable = VK_TRUE;
+    vkapi_pline_cache_bind_depth_stencil_block(c, &ds);
+    TEST_ASSERT_EQUAL_UINT32(
+        (1u << VKAPI_PL_STATE_RASTER) | (1u << VKAPI_PL_STATE_DEPTH_STENCIL), t->dirty_blocks);
+
+    vkapi_pline_cache_update_state_hash(c);
+    TEST_ASSERT_EQUAL_UINT32(0, t->dirty_blocks);
+    TEST_ASSERT(t->state_hash != state_hash);
+
+    // Reverting the state gives the original hash.
+    vkapi_pline_cache_bind_depth_test_enable(c, false);
+    ds.stencil_test_enable = VK_FALSE;
+    vkapi_pline_cache_bind_depth_stencil_block(c, &ds);
+    vkapi_pline_cache_update_state_hash(c);
+    TEST_ASSERT(t->state_hash == state_hash);
+
+    arena_release(&arena);
+}
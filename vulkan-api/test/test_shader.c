@@ -107,3 +107,104 @@ TEST(ShaderGroup, Shader_CompilerTests)
 
     vkapi_driver_shutdown(driver, VK_NULL_HANDLE);
 }
+
+TEST(ShaderGroup, Shader_BatchCompileTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 22, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+    shader_compiler_process_init();
+
+    const char* vert_code = "#version 460\n"
+                            "layout(location = 0) in vec3 inPos;\n"
+                            "layout(location = 0) out vec3 outPos;\n"
+                            "layout(binding = 0) uniform Buffer { mat4 mvp; } ubo;\n"
+                            "void main()\n"
+                            "{\n"
+                            "outPos = inPos;\n"
+                            "gl_Position = ubo.mvp * vec4(inPos, 1.0);\n"
+                            "}\n";
+    const char* frag_code = "#version 460\n"
+                            "layout(location = 0) in vec3 inPos;\n"
+                            "layout(location = 0) out vec4 outColour;\n"
+                            "layout(binding = 1, set = 3) uniform sampler2D texSampler;\n"
+                            "void main()\n"
+                            "{\n"
+                            "outColour = texture(texSampler, inPos.xy);\n"
+                            "}\n";
+    const char* invalid_code = "#version 460\nvoid main() { undefined_func(); }\n";
+
+    const uint32_t count = 16;
+    const char* codes[16];
+    shader_t* serial_shaders[16];
+    shader_t* batch_shaders[16];
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        bool is_vert = i % 2 == 0;
+        codes[i] = i == 5 ? invalid_code : is_vert ? vert_code : frag_code;
+        enum ShaderStage stage =
+            is_vert ? RPE_BACKEND_SHADER_STAGE_VERTEX : RPE_BACKEND_SHADER_STAGE_FRAGMENT;
+        serial_shaders[i] = shader_init(stage, &arena);
+        batch_shaders[i] = shader_init(stage, &arena);
+    }
+
+    shader_compiler_pool_t* pool = ARENA_MAKE_ZERO_STRUCT(&arena, shader_compiler_pool_t);
+    spirv_binary_t serial_bins[16];
+    spirv_binary_t batch_bins[16];
+    shader_compile_batch(pool, NULL, serial_shaders, codes, count, serial_bins, &arena);
+
+    job_queue_t* jq = job_queue_init(&arena, 4);
+    job_queue_adopt_thread(jq);
+    shader_compile_batch(pool, jq, batch_shaders, codes, count, batch_bins, &arena);
+
+    // Compiling in parallel must give the same results, in the same order, as serially.
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i == 5)
+        {
+            TEST_ASSERT_NULL(serial_bins[i].words);
+            TEST_ASSERT_NULL(batch_bins[i].words);
+            continue;
+        }
+        TEST_ASSERT_NOT_NULL(batch_bins[i].words);
+        TEST_ASSERT_EQUAL_UINT(serial_bins[i].size, batch_bins[i].size);
+        TEST_ASSERT(
+            memcmp(
+                serial_bins[i].words,
+                batch_bins[i].words,
+                serial_bins[i].size * sizeof(uint32_t)) == 0);
+
+        shader_binding_t* a = &serial_shaders[i]->resource_binding;
+        shader_binding_t* b = &batch_shaders[i]->resource_binding;
+        size_t size = shader_binding_serialise(a, NULL);
+        TEST_ASSERT_EQUAL_UINT(size, shader_binding_serialise(b, NULL));
+        uint8_t* a_data = ARENA_MAKE_ARRAY(&arena, uint8_t, size, 0);
+        uint8_t* b_data = ARENA_MAKE_ARRAY(&arena, uint8_t, size, 0);
+        shader_binding_serialise(a, a_data);
+        shader_binding_serialise(b, b_data);
+        TEST_ASSERT(memcmp(a_data, b_data, size) == 0);
+    }
+    TEST_ASSERT_EQUAL_UINT(1, batch_shaders[0]->resource_binding.desc_layout_count);
+    TEST_ASSERT(batch_shaders[0]->resource_binding.desc_layouts[0].name.len > 0);
+
+    // Pre-compiled SPIR-V is passed without source and is only reflected.
+    const char* no_codes[2] = {NULL, NULL};
+    shader_t* spirv_shaders[2] = {
+        shader_init(RPE_BACKEND_SHADER_STAGE_VERTEX, &arena),
+        shader_init(RPE_BACKEND_SHADER_STAGE_FRAGMENT, &arena)};
+    spirv_binary_t spirv_bins[2] = {serial_bins[0], serial_bins[1]};
+    shader_compile_batch(pool, jq, spirv_shaders, no_codes, 2, spirv_bins, &arena);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        TEST_ASSERT(spirv_bins[i].words == serial_bins[i].words);
+        shader_binding_t* a = &serial_shaders[i]->resource_binding;
+        shader_binding_t* b = &spirv_shaders[i]->resource_binding;
+        TEST_ASSERT_EQUAL_UINT(a->desc_layout_count, b->desc_layout_count);
+        TEST_ASSERT_EQUAL_UINT(a->stage_input_count, b->stage_input_count);
+    }
+
+    job_queue_destroy(jq);
+    shader_compiler_pool_destroy(pool);
+    shader_compiler_process_shutdown();
+    arena_release(&arena);
+}
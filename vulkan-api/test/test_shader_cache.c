@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity_fixture.h>
+#include <vulkan-api/shader.h>
+#include <vulkan-api/shader_cache.h>
+
+TEST_GROUP(ShaderCacheGroup);
+
+TEST_SETUP(ShaderCacheGroup) {}
+
+TEST_TEAR_DOWN(ShaderCacheGroup) {}
+
+static const char* cache_path = "test_shader_cache.bin";
+
+TEST(ShaderCacheGroup, ShaderCache_ReflectionTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 22, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+    remove(cache_path);
+    shader_compiler_process_init();
+
+    const char* shader_code = "#version 460\n"
+                              "\n"
+                              "layout(location = 0) in vec3 inPos;\n"
+                              "layout(location = 1) in vec2 inUv;\n"
+                              "layout(location = 0) out vec2 outUv;\n"
+                              "layout(constant_id = 0) const int LightTypePoint = 0;\n"
+                              "\n"
+                              "layout(binding = 0) uniform Buffer {\n"
+                              "    mat4 mvp;\n"
+                              "} ubo;\n"
+                              "layout(binding = 1, set = 3) uniform sampler2D texSampler;\n"
+                              "layout(push_constant) uniform PushBlock { vec4 colour; } push;\n"
+                              "void main()\n"
+                              "{\n"
+                              "outUv = inUv;\n"
+                              "gl_Position = ubo.mvp * vec4(inPos, 1.0);\n"
+                              "}\n";
+
+    shader_t* shader = shader_init(RPE_BACKEND_SHADER_STAGE_VERTEX, &arena);
+    spirv_binary_t bin = shader_compile(shader, shader_code, "test_path", &arena);
+    TEST_ASSERT(bin.words);
+    shader_reflect_spirv(shader, bin.words, bin.size, &arena);
+
+    size_t fresh_size = shader_binding_serialise(&shader->resource_binding, NULL);
+    uint8_t* fresh = ARENA_MAKE_ARRAY(&arena, uint8_t, fresh_size, 0);
+    shader_binding_serialise(&shader->resource_binding, fresh);
+
+    // The key depends on both the source and stage.
+    uint64_t key = vkapi_shader_cache_glsl_key(shader_code, RPE_BACKEND_SHADER_STAGE_VERTEX);
+    TEST_ASSERT(key != vkapi_shader_cache_glsl_key(shader_code, RPE_BACKEND_SHADER_STAGE_FRAGMENT));
+    TEST_ASSERT(
+        key != vkapi_shader_cache_glsl_key("#version 460\n", RPE_BACKEND_SHADER_STAGE_VERTEX));
+
+    vkapi_shader_cache_t cache;
+    vkapi_shader_cache_init(&cache, cache_path, VKAPI_SHADER_CACHE_DEFAULT_MAX_SIZE, &arena);
+    shader_binding_t binding;
+    TEST_ASSERT_FALSE(vkapi_shader_cache_get(&cache, key, &bin, &binding, &arena));
+    vkapi_shader_cache_insert(&cache, key, &bin, &shader->resource_binding);
+    TEST_ASSERT(vkapi_shader_cache_save(&cache, cache_path, &arena));
+    vkapi_shader_cache_destroy(&cache);
+
+    // A new run - the result is loaded from disk.
+    vkapi_shader_cache_init(&cache, cache_path, VKAPI_SHADER_CACHE_DEFAULT_MAX_SIZE, &arena);
+    spirv_binary_t cached_bin;
+    TEST_ASSERT(vkapi_shader_cache_get(&cache, key, &cached_bin, &binding, &arena));
+    TEST_ASSERT_EQUAL_UINT(1, cache.hits);
+    TEST_ASSERT_EQUAL_UINT(0, cache.misses);
+    TEST_ASSERT_EQUAL_UINT(bin.size, cached_bin.size);
+    TEST_ASSERT(memcmp(bin.words, cached_bin.words, bin.size * sizeof(uint32_t)) == 0);
+
+    // The cached reflection must be identical to a fresh reflection.
+    TEST_ASSERT_EQUAL_UINT(fresh_size, shader_binding_serialise(&binding, NULL));
+    uint8_t* cached = ARENA_MAKE_ARRAY(&arena, uint8_t, fresh_size, 0);
+    shader_binding_serialise(&binding, cached);
+    TEST_ASSERT(memcmp(fresh, cached, fresh_size) == 0);
+    TEST_ASSERT_EQUAL_UINT(1, binding.stage_output_count);
+    TEST_ASSERT_EQUAL_UINT(2, binding.stage_input_count);
+    TEST_ASSERT_EQUAL_UINT(2, binding.desc_layout_count);
+    TEST_ASSERT_EQUAL_UINT(1, binding.spec_const_count);
+    TEST_ASSERT_EQUAL_UINT(16, binding.push_block_size);
+    for (uint32_t i = 0; i < binding.desc_layout_count; ++i)
+    {
+        TEST_ASSERT(string_cmp(
+            &binding.desc_layouts[i].name, &shader->resource_binding.desc_layouts[i].name));
+    }
+    vkapi_shader_cache_destroy(&cache);
+
+    shader_compiler_process_shutdown();
+    remove(cache_path);
+    arena_release(&arena);
+}
+
+TEST(ShaderCacheGroup, ShaderCache_EvictionTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 22, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+    remove(cache_path);
+
+    shader_binding_t binding = {0};
+    binding.stage_input_count = 1;
+    binding.stage_inputs[0].location = 2;
+    binding.stage_inputs[0].format = VK_FORMAT_R32G32_SFLOAT;
+    binding.push_block_size = 64;
+
+    uint32_t words[256];
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        words[i] = i;
+    }
+    spirv_binary_t bin = {.words = words, .size = 256};
+
+    vkapi_shader_cache_t cache;
+    vkapi_shader_cache_init(&cache, cache_path, VKAPI_SHADER_CACHE_DEFAULT_MAX_SIZE, &arena);
+    for (uint64_t key = 1; key <= 3; ++key)
+    {
+        vkapi_shader_cache_insert(&cache, key, &bin, &binding);
+    }
+    TEST_ASSERT(vkapi_shader_cache_save(&cache, cache_path, &arena));
+    vkapi_shader_cache_destroy(&cache);
+
+    // Only allow room for two entries - the least recently used are evicted.
+    size_t payload_size = bin.size * sizeof(uint32_t) + shader_binding_serialise(&binding, NULL);
+    size_t entry_size = sizeof(vkapi_shader_cache_entry_t) + ((payload_size + 7) & ~7);
+    size_t max_size = sizeof(vkapi_shader_cache_header_t) + 2 * entry_size;
+    vkapi_shader_cache_init(&cache, cache_path, max_size, &arena);
+    TEST_ASSERT_EQUAL_UINT(3, cache.items.size);
+    shader_binding_t out_binding;
+    TEST_ASSERT(vkapi_shader_cache_get(&cache, 1, NULL, &out_binding, &arena));
+    vkapi_shader_cache_insert(&cache, 4, &bin, &binding);
+    TEST_ASSERT(vkapi_shader_cache_save(&cache, cache_path, &arena));
+    vkapi_shader_cache_destroy(&cache);
+
+    vkapi_shader_cache_init(&cache, cache_path, max_size, &arena);
+    TEST_ASSERT_EQUAL_UINT(2, cache.items.size);
+    TEST_ASSERT(vkapi_shader_cache_get(&cache, 1, NULL, &out_binding, &arena));
+    TEST_ASSERT(vkapi_shader_cache_get(&cache, 4, NULL, &out_binding, &arena));
+    TEST_ASSERT_FALSE(vkapi_shader_cache_get(&cache, 2, NULL, &out_binding, &arena));
+    TEST_ASSERT_FALSE(vkapi_shader_cache_get(&cache, 3, NULL, &out_binding, &arena));
+    TEST_ASSERT_EQUAL_UINT(2, cache.hits);
+    TEST_ASSERT_EQUAL_UINT(2, cache.misses);
+    vkapi_shader_cache_destroy(&cache);
+
+    // A corrupt payload is only detected when used, and is then treated as a miss.
+    FILE* fp = fopen(cache_path, "r+b");
+    TEST_ASSERT(fp);
+    // Skip the alignment padding of the last payload.
+    long padding = entry_size - sizeof(vkapi_shader_cache_entry_t) - payload_size;
+    fseek(fp, -(padding + 1), SEEK_END);
+    fputc(0xff, fp);
+    fclose(fp);
+    vkapi_shader_cache_init(&cache, cache_path, max_size, &arena);
+    bool hit1 = vkapi_shader_cache_get(&cache, 1, NULL, &out_binding, &arena);
+    bool hit4 = vkapi_shader_cache_get(&cache, 4, NULL, &out_binding, &arena);
+    TEST_ASSERT(hit1 != hit4);
+    vkapi_shader_cache_destroy(&cache);
+
+    // A truncated file is ignored.
+    fp = fopen(cache_path, "wb");
+    TEST_ASSERT(fp);
+    fwrite(words, 1, 12, fp);
+    fclose(fp);
+    vkapi_shader_cache_init(&cache, cache_path, max_size, &arena);
+    TEST_ASSERT_EQUAL_UINT(0, cache.items.size);
+    vkapi_shader_cache_destroy(&cache);
+
+    remove(cache_path);
+    arena_release(&arena);
+}
@@ -0,0 +1,103 @@
+#include <unity_fixture.h>
+#include <vulkan-api/staging_ring.h>
+
+TEST_GROUP(StagingRingGroup);
+
+TEST_SETUP(StagingRingGroup) {}
+
+TEST_TEAR_DOWN(StagingRingGroup) {}
+
+TEST(StagingRingGroup, StagingRing_AllocTests)
+{
+    vkapi_staging_ring_t r;
+    vkapi_staging_ring_init(&r, 1024);
+
+    TEST_ASSERT_EQUAL_UINT64(0, vkapi_staging_ring_alloc(&r, 100, 16, 0));
+    TEST_ASSERT_EQUAL_UINT64(112, vkapi_staging_ring_alloc(&r, 100, 16, 0));
+    // Alignment doesn't need to be a power of two.
+    TEST_ASSERT_EQUAL_UINT64(216, vkapi_staging_ring_alloc(&r, 12, 12, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, r.region_count);
+    TEST_ASSERT_EQUAL_UINT64(228, r.used);
+
+    TEST_ASSERT_EQUAL_UINT64(228, vkapi_staging_ring_alloc(&r, 700, 4, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, r.region_count);
+
+    // Larger than the remaining space.
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET, vkapi_staging_ring_alloc(&r, 200, 4, 1));
+    TEST_ASSERT_EQUAL_UINT64(928, r.used);
+
+    // Retiring a frame also retires all earlier frames.
+    vkapi_staging_ring_retire(&r, 2);
+    TEST_ASSERT_EQUAL_UINT64(0, r.used);
+    TEST_ASSERT_EQUAL_UINT32(0, r.region_count);
+
+    // The ring is empty, so allocations begin from the start again.
+    TEST_ASSERT_EQUAL_UINT64(0, vkapi_staging_ring_alloc(&r, 1024, 4, 3));
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET, vkapi_staging_ring_alloc(&r, 1, 1, 3));
+}
+
+TEST(StagingRingGroup, StagingRing_WrapTests)
+{
+    vkapi_staging_ring_t r;
+    vkapi_staging_ring_init(&r, 1000);
+
+    TEST_ASSERT_EQUAL_UINT64(0, vkapi_staging_ring_alloc(&r, 400, 1, 0));
+    TEST_ASSERT_EQUAL_UINT64(400, vkapi_staging_ring_alloc(&r, 400, 1, 1));
+
+    // Wrapping requires the first frame to have been retired.
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET, vkapi_staging_ring_alloc(&r, 300, 1, 2));
+    vkapi_staging_ring_retire(&r, 0);
+    TEST_ASSERT_EQUAL_UINT64(400, r.tail);
+
+    // The 200 bytes at the end of the ring are skipped and owned by this frame.
+    TEST_ASSERT_EQUAL_UINT64(0, vkapi_staging_ring_alloc(&r, 300, 1, 2));
+    TEST_ASSERT_EQUAL_UINT64(900, r.used);
+    TEST_ASSERT_EQUAL_UINT64(300, r.head);
+
+    // The space between the head and the tail can still be used.
+    TEST_ASSERT_EQUAL_UINT64(300, vkapi_staging_ring_alloc(&r, 100, 1, 2));
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET, vkapi_staging_ring_alloc(&r, 1, 1, 2));
+
+    vkapi_staging_ring_retire(&r, 1);
+    TEST_ASSERT_EQUAL_UINT64(800, r.tail);
+    TEST_ASSERT_EQUAL_UINT64(600, r.used);
+    TEST_ASSERT_EQUAL_UINT64(400, vkapi_staging_ring_alloc(&r, 400, 1, 3));
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET, vkapi_staging_ring_alloc(&r, 1, 1, 3));
+
+    vkapi_staging_ring_retire(&r, 2);
+    TEST_ASSERT_EQUAL_UINT64(400, r.used);
+    TEST_ASSERT_EQUAL_UINT64(800, vkapi_staging_ring_alloc(&r, 200, 1, 4));
+    TEST_ASSERT_EQUAL_UINT64(0, vkapi_staging_ring_alloc(&r, 400, 1, 4));
+    TEST_ASSERT_EQUAL_UINT64(1000, r.used);
+
+    vkapi_staging_ring_retire(&r, 4);
+    TEST_ASSERT_EQUAL_UINT64(0, r.used);
+    TEST_ASSERT_EQUAL_UINT32(0, r.region_count);
+}
+
+TEST(StagingRingGroup, StagingRing_RegionLimitTests)
+{
+    vkapi_staging_ring_t r;
+    vkapi_staging_ring_init(&r, 1 << 20);
+
+    // Each frame takes a region, and no more frames can be tracked until some are retired.
+    for (uint64_t frame = 0; frame < VKAPI_STAGING_RING_MAX_REGIONS; ++frame)
+    {
+        uint64_t offset = vkapi_staging_ring_alloc(&r, 16, 16, frame);
+        TEST_ASSERT(offset != VKAPI_STAGING_RING_INVALID_OFFSET);
+    }
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_INVALID_OFFSET,
+        vkapi_staging_ring_alloc(&r, 16, 16, VKAPI_STAGING_RING_MAX_REGIONS));
+
+    vkapi_staging_ring_retire(&r, 0);
+    TEST_ASSERT_EQUAL_UINT64(
+        VKAPI_STAGING_RING_MAX_REGIONS * 16,
+        vkapi_staging_ring_alloc(&r, 16, 16, VKAPI_STAGING_RING_MAX_REGIONS));
+    TEST_ASSERT_EQUAL_UINT32(VKAPI_STAGING_RING_MAX_REGIONS, r.region_count);
+}
@@ -0,0 +1,150 @@
+#include <unity_fixture.h>
+#include <utility/arena.h>
+#include <vulkan-api/upload_batch.h>
+
+TEST_GROUP(UploadBatchGroup);
+
+TEST_SETUP(UploadBatchGroup) {}
+
+TEST_TEAR_DOWN(UploadBatchGroup) {}
+
+// Handles are never dereferenced, so any unique value will do.
+#define TEST_STAGING_BUFFER ((VkBuffer)(uintptr_t)0x10)
+#define TEST_DEDICATED_BUFFER ((VkBuffer)(uintptr_t)0x20)
+#define TEST_VERTEX_BUFFER ((VkBuffer)(uintptr_t)0x100)
+#define TEST_INDEX_BUFFER ((VkBuffer)(uintptr_t)0x200)
+
+static void
+assert_region(VkBufferCopy* r, VkDeviceSize src_offset, VkDeviceSize dst_offset, VkDeviceSize size)
+{
+    TEST_ASSERT_EQUAL_UINT64(src_offset, r->srcOffset);
+    TEST_ASSERT_EQUAL_UINT64(dst_offset, r->dstOffset);
+    TEST_ASSERT_EQUAL_UINT64(size, r->size);
+}
+
+TEST(UploadBatchGroup, UploadBatch_MergeTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    vkapi_upload_batch_t b;
+    vkapi_upload_batch_init(&b, &arena);
+    TEST_ASSERT_TRUE(vkapi_upload_batch_is_empty(&b));
+
+    // Interleaved uploads to two buffers, packed into the staging memory in order.
+    VkBuffer staging = TEST_STAGING_BUFFER;
+    VkBufferUsageFlags vert_usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    VkBufferUsageFlags index_usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 0, 0, 64, vert_usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 64, 64, 64, vert_usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_INDEX_BUFFER, 128, 0, 32, index_usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 160, 128, 64, vert_usage);
+    // Adjacent in the destination but not in the staging memory.
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_INDEX_BUFFER, 256, 32, 32, index_usage);
+    // Added out of order.
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_INDEX_BUFFER, 96, 64, 32, index_usage);
+    TEST_ASSERT_FALSE(vkapi_upload_batch_is_empty(&b));
+    TEST_ASSERT_EQUAL_UINT32(6, b.stats.upload_count);
+
+    vkapi_upload_buffer_cmd_t* cmds;
+    uint32_t cmd_count = vkapi_upload_batch_build_buffer_cmds(&b, &arena, &cmds);
+    TEST_ASSERT_EQUAL_UINT32(2, cmd_count);
+    TEST_ASSERT_EQUAL_UINT32(1, b.stats.merged_region_count);
+
+    vkapi_upload_buffer_cmd_t* vert = cmds[0].dst == TEST_VERTEX_BUFFER ? &cmds[0] : &cmds[1];
+    vkapi_upload_buffer_cmd_t* index = cmds[0].dst == TEST_INDEX_BUFFER ? &cmds[0] : &cmds[1];
+    TEST_ASSERT(vert != index);
+
+    // The first two vertex uploads are merged, the third isn't contiguous in the staging memory.
+    TEST_ASSERT_EQUAL_UINT32(vert_usage, vert->usage);
+    TEST_ASSERT_EQUAL_UINT32(2, vert->region_count);
+    assert_region(&vert->regions[0], 0, 0, 128);
+    assert_region(&vert->regions[1], 160, 128, 64);
+
+    TEST_ASSERT_EQUAL_UINT32(index_usage, index->usage);
+    TEST_ASSERT_EQUAL_UINT32(3, index->region_count);
+    assert_region(&index->regions[0], 128, 0, 32);
+    assert_region(&index->regions[1], 256, 32, 32);
+    assert_region(&index->regions[2], 96, 64, 32);
+
+    vkapi_upload_batch_clear(&b);
+    TEST_ASSERT_TRUE(vkapi_upload_batch_is_empty(&b));
+    TEST_ASSERT_EQUAL_UINT32(0, vkapi_upload_batch_build_buffer_cmds(&b, &arena, &cmds));
+
+    vkapi_upload_batch_end_frame(&b);
+    TEST_ASSERT_EQUAL_UINT32(6, b.last_frame_stats.upload_count);
+    TEST_ASSERT_EQUAL_UINT32(0, b.stats.upload_count);
+
+    arena_release(&arena);
+}
+
+TEST(UploadBatchGroup, UploadBatch_OverlapTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    vkapi_upload_batch_t b;
+    vkapi_upload_batch_init(&b, &arena);
+    VkBuffer staging = TEST_STAGING_BUFFER;
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    // Later uploads overwrite the middle, the start and the end of the first, and all of the
+    // second.
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 0, 0, 100, usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 100, 200, 50, usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 1000, 40, 20, usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 2000, 0, 10, usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 3000, 90, 20, usage);
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_VERTEX_BUFFER, 4000, 190, 100, usage);
+    // A different buffer isn't affected.
+    vkapi_upload_batch_add_buffer(&b, staging, TEST_INDEX_BUFFER, 5000, 0, 100, usage);
+
+    vkapi_upload_buffer_cmd_t* cmds;
+    uint32_t cmd_count = vkapi_upload_batch_build_buffer_cmds(&b, &arena, &cmds);
+    TEST_ASSERT_EQUAL_UINT32(2, cmd_count);
+    vkapi_upload_buffer_cmd_t* vert = cmds[0].dst == TEST_VERTEX_BUFFER ? &cmds[0] : &cmds[1];
+
+    // The remaining regions are in destination order and never overlap.
+    TEST_ASSERT_EQUAL_UINT32(6, vert->region_count);
+    assert_region(&vert->regions[0], 2000, 0, 10);
+    assert_region(&vert->regions[1], 10, 10, 30);
+    assert_region(&vert->regions[2], 1000, 40, 20);
+    assert_region(&vert->regions[3], 60, 60, 30);
+    assert_region(&vert->regions[4], 3000, 90, 20);
+    assert_region(&vert->regions[5], 4000, 190, 100);
+
+    arena_release(&arena);
+}
+
+TEST(UploadBatchGroup, UploadBatch_StagingSourceTests)
+{
+    arena_t arena;
+    int res = arena_new(1 << 20, &arena);
+    TEST_ASSERT(ARENA_SUCCESS == res);
+
+    vkapi_upload_batch_t b;
+    vkapi_upload_batch_init(&b, &arena);
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+    // An upload with a dedicated staging buffer needs its own copy command.
+    vkapi_upload_batch_add_buffer(&b, TEST_STAGING_BUFFER, TEST_VERTEX_BUFFER, 0, 0, 64, usage);
+    vkapi_upload_batch_add_buffer(&b, TEST_DEDICATED_BUFFER, TEST_VERTEX_BUFFER, 0, 64, 64, usage);
+    vkapi_upload_batch_add_buffer(&b, TEST_STAGING_BUFFER, TEST_VERTEX_BUFFER, 64, 128, 64, usage);
+
+    vkapi_upload_buffer_cmd_t* cmds;
+    uint32_t cmd_count = vkapi_upload_batch_build_buffer_cmds(&b, &arena, &cmds);
+    TEST_ASSERT_EQUAL_UINT32(2, cmd_count);
+    uint32_t region_count = cmds[0].region_count + cmds[1].region_count;
+    TEST_ASSERT_EQUAL_UINT32(3, region_count);
+    TEST_ASSERT_EQUAL_UINT32(0, b.stats.merged_region_count);
+
+    VkAccessFlags access;
+    VkPipelineStageFlags stages;
+    vkapi_upload_batch_dst_access(cmds[0].usage, &access, &stages);
+    TEST_ASSERT_EQUAL_UINT32(VK_ACCESS_UNIFORM_READ_BIT, access);
+    TEST_ASSERT(stages & VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+
+    arena_release(&arena);
+}